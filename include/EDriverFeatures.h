@@ -142,6 +142,10 @@ namespace video
 		//! Support for filtering across different faces of the cubemap
 		EVDF_TEXTURE_CUBEMAP_SEAMLESS,
 
+		//! Support for drawing many instances of a mesh buffer with one call
+		/** See IVideoDriver::drawMeshBufferInstanced() for the shader inputs. */
+		EVDF_INSTANCING,
+
 		//! Only used for counting the elements of this enum
 		EVDF_COUNT
 	};
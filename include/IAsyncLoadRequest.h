@@ -0,0 +1,101 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_ASYNC_LOAD_REQUEST_H_INCLUDED__
+#define __I_ASYNC_LOAD_REQUEST_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "path.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IAnimatedMesh;
+} // end namespace scene
+namespace video
+{
+	class ITexture;
+} // end namespace video
+
+//! States of an asynchronous load request
+enum E_ASYNC_LOAD_STATE
+{
+	//! The request is waiting for the loader thread or for being finished
+	EALS_LOADING = 0,
+
+	//! The resource was loaded and is ready to use
+	EALS_DONE,
+
+	//! The resource could not be loaded
+	EALS_FAILED
+};
+
+//! A resource loaded in the background by an IAsyncLoader
+/** Loading is split into two steps. load() runs on the loader thread and
+does the file access and decoding. finish() runs on the thread which draws,
+during IAsyncLoader::finishRequests(), and creates everything which needs the
+video driver or changes caches shared with the application.
+Requests for meshes and textures are created with
+scene::ISceneManager::createMeshLoadRequest() and
+video::IVideoDriver::createTextureLoadRequest(), own requests can be added to
+the loader with IAsyncLoader::addRequest(). */
+class IAsyncLoadRequest : public virtual IReferenceCounted
+{
+public:
+
+	//! Constructor
+	IAsyncLoadRequest() : State(EALS_LOADING) {}
+
+	//! Get the state of the request
+	/** The state only changes while the loader finishes requests, so it
+	does not change unexpectedly on the thread which draws. */
+	E_ASYNC_LOAD_STATE getState() const
+	{
+		return State;
+	}
+
+	//! Set the state of the request, called by the loader after finish()
+	void setState(E_ASYNC_LOAD_STATE state)
+	{
+		State = state;
+	}
+
+	//! Get the name of the loaded resource
+	virtual const io::path& getName() const = 0;
+
+	//! Get the loaded mesh
+	/** \return The mesh once the request is done, 0 for requests which
+	do not load meshes. This pointer should not be dropped. */
+	virtual scene::IAnimatedMesh* getMesh() const
+	{
+		return 0;
+	}
+
+	//! Get the loaded texture
+	/** \return The texture once the request is done, 0 for requests which
+	do not load textures. This pointer should not be dropped. */
+	virtual video::ITexture* getTexture() const
+	{
+		return 0;
+	}
+
+	//! Loads the resource, called on the loader thread
+	/** Loaders of meshes and images are locked while this runs.
+	\return False if loading failed, finish() is not called then. */
+	virtual bool load() = 0;
+
+	//! Finishes the resource, called on the thread which draws
+	/** \return True if the resource is ready to use. */
+	virtual bool finish() = 0;
+
+protected:
+
+	E_ASYNC_LOAD_STATE State;
+};
+
+} // end namespace irr
+
+#endif
+
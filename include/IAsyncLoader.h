@@ -0,0 +1,77 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_ASYNC_LOADER_H_INCLUDED__
+#define __I_ASYNC_LOADER_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "IAsyncLoadRequest.h"
+
+namespace irr
+{
+
+//! Loads resources on a background thread
+/** The loader belongs to the video driver, see
+video::IVideoDriver::getAsyncLoader(). Its thread is started with the first
+request. Requests are loaded one after another in the order they were added
+and finished on the thread which draws, either by finishRequests() or within
+the time budget in video::IVideoDriver::beginScene().
+
+Mesh and image loaders are not thread safe, so they never run at the same
+time. Loading a mesh or texture synchronously while the loader thread is busy
+waits until it is done with the current request. Mesh loaders running on the
+loader thread can still get textures from the video driver, the textures are
+created on the thread which draws. The COLLADA loader, which creates a whole
+scene, builds it apart from the scene and adds its nodes and meshes on the
+thread which draws as well. Other loaders which add scene nodes or change the
+mesh cache themselves must not be used asynchronously. */
+class IAsyncLoader : public virtual IReferenceCounted
+{
+public:
+
+	//! Adds a request to be loaded on the loader thread
+	/** The loader grabs the request until it is finished. */
+	virtual void addRequest(IAsyncLoadRequest* request) = 0;
+
+	//! Finishes loaded requests on the calling thread
+	/** Call this only from the thread which draws. At least one loaded
+	request is finished, if there is one.
+	\param timeBudget Milliseconds after which no more requests are started
+	to finish.
+	\return Number of requests which are still not finished. */
+	virtual u32 finishRequests(u32 timeBudget) = 0;
+
+	//! Waits until all requests are loaded and finishes them
+	/** Call this only from the thread which draws. */
+	virtual void finishAllRequests() = 0;
+
+	//! Get the number of requests which are not finished yet
+	virtual u32 getRequestCount() const = 0;
+
+	//! Set the milliseconds per frame spent in finishing requests
+	/** Used by video::IVideoDriver::beginScene(). The default is 2 ms,
+	0 disables finishing requests in beginScene(). */
+	virtual void setFrameBudget(u32 milliseconds) = 0;
+
+	//! Get the milliseconds per frame spent in finishing requests
+	virtual u32 getFrameBudget() const = 0;
+
+	//! Locks the mesh and image loaders
+	/** The lock can be taken several times by the same thread and has to
+	be unlocked as often. Needed for own code using the loaders of the
+	engine while requests are loading. The file system needs no lock, it
+	can be used on any thread. */
+	virtual void lock() = 0;
+
+	//! Unlocks the mesh and image loaders
+	virtual void unlock() = 0;
+
+	//! Returns true if called on the loader thread
+	virtual bool isLoaderThread() const = 0;
+};
+
+} // end namespace irr
+
+#endif
+
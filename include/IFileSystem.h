@@ -28,7 +28,11 @@ class IAttributes;
 //! The FileSystem manages files and archives and provides access to them.
 /** It manages where files are, so that modules which use the the IO do not
 need to know where every file is located. A file could be in a .zip-Archive or
-as file on disk, using the IFileSystem makes no difference to this. */
+as file on disk, using the IFileSystem makes no difference to this.
+
+The file system can be used by several threads at once. Files opened from
+archives can be read on any thread, also while other files of the same
+archive are read. Changing the working directory affects all threads. */
 class IFileSystem : public virtual IReferenceCounted
 {
 public:
@@ -17,6 +17,18 @@ namespace irr
 namespace video
 {
 
+//! Filters for creating mip map levels on the CPU
+enum E_MIP_MAP_FILTER
+{
+	//! Average of 2x2 pixels
+	EMMF_BOX = 0,
+
+	//! Kaiser windowed sinc over 8x8 pixels
+	/** Keeps the levels sharper than the box filter, for a few times its
+	cost. */
+	EMMF_KAISER
+};
+
 //! Interface for software image data.
 /** Image loaders create these images from files. IVideoDrivers convert
 these images into their (hardware) textures.
@@ -283,6 +295,25 @@ public:
 	//! fills the surface with given color
 	virtual void fill(const SColor &color) =0;
 
+	//! Filters this image into the next smaller mip map level
+	/** Target formats other than the one of this image are converted.
+	Large images are filtered on several threads.
+	\param target Image of half the size of this image on each side,
+	rounded down but at least 1.
+	\param filter Filter kernel.
+	\param sRGB Filter the colors in linear space, for images storing sRGB
+	colors. Alpha is always filtered as it is. */
+	virtual void copyToMipMap(IImage* target, E_MIP_MAP_FILTER filter=EMMF_BOX, bool sRGB=false) =0;
+
+	//! Creates all mip map levels below this image
+	/** The levels are filtered from each other down to 1x1 and set as mip
+	map data, which the video drivers use instead of generating the levels
+	themselves.
+	\param filter Filter kernel.
+	\param sRGB Filter the colors in linear space, for images storing sRGB
+	colors. */
+	virtual void createMipMaps(E_MIP_MAP_FILTER filter=EMMF_BOX, bool sRGB=false) =0;
+
 	//! Inform whether the image is compressed
 	_IRR_DEPRECATED_ bool isCompressed() const
 	{
@@ -0,0 +1,81 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class IMesh;
+
+
+//! A scene node displaying many instances of a static mesh
+/** All instances share the mesh and the materials of the node, but each
+has its own transformation and color. The instances are drawn with
+IVideoDriver::drawMeshBufferInstanced(), one call per mesh buffer. The
+node is culled as a whole, with a bounding box around all instances. */
+class IInstancedMeshSceneNode : public ISceneNode
+{
+public:
+
+	//! Constructor
+	/** Use setMesh() to set the mesh to display, and addInstance() to
+	place copies of it. */
+	IInstancedMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: ISceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Sets a new mesh to display
+	/** \param mesh Mesh to display. */
+	virtual void setMesh(IMesh* mesh) = 0;
+
+	//! Get the currently defined mesh for display.
+	/** \return Pointer to mesh which is displayed by this node. */
+	virtual IMesh* getMesh(void) = 0;
+
+	//! Adds an instance of the mesh
+	/** \param transform Transformation of the instance, relative to the node.
+	\param color Color the vertex colors of the instance are multiplied with.
+	\return Index of the new instance. */
+	virtual u32 addInstance(const core::matrix4& transform,
+		video::SColor color=video::SColor(255,255,255,255)) = 0;
+
+	//! Changes an instance
+	/** \param index Index of the instance.
+	\param transform Transformation of the instance, relative to the node.
+	\param color Color the vertex colors of the instance are multiplied with. */
+	virtual void setInstance(u32 index, const core::matrix4& transform,
+		video::SColor color=video::SColor(255,255,255,255)) = 0;
+
+	//! Removes an instance
+	/** The last instance takes the index of the removed one.
+	\param index Index of the instance. */
+	virtual void removeInstance(u32 index) = 0;
+
+	//! Removes all instances
+	virtual void removeAllInstances() = 0;
+
+	//! Get the number of instances
+	virtual u32 getInstanceCount() const = 0;
+
+	//! Get the transformation of an instance, relative to the node
+	virtual const core::matrix4& getInstanceTransform(u32 index) const = 0;
+
+	//! Get the color of an instance
+	virtual video::SColor getInstanceColor(u32 index) const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
+
@@ -83,7 +83,7 @@ private:
     u32 GroupIndex;
 	core::stringw Name;
 
-	s32 StartStopCounter; // 0 means stopped > 0 means it runs.
+	u32 StartStopCounter; // 0 means stopped > 0 means it runs.
     u32 CountCalls;
     u32 LongestTime;
     u32 TimeSum;
@@ -102,7 +102,7 @@ class IProfiler
 {
 public:
 	//! Constructor. You could use this to create a new profiler, but usually getProfiler() is used to access the global instance.
-    IProfiler()	: Timer(0), NextAutoId(INT_MAX)
+    IProfiler()	: Timer(0), Tracing(false), NextAutoId(INT_MAX)
 	{}
 
 	virtual ~IProfiler()
@@ -171,6 +171,10 @@ public:
 	//! Start profile-timing for the given id
 	/** This increases an internal run-counter for the given id. It will profile as long as that counter is > 0.
 	NOTE: you have to add the id first with one of the ::add functions
+	start and stop can be called by several threads at once, they only use atomic operations and never lock.
+	The counter is shared, so an id running in several threads is timed from the first start until the last
+	stop. All other functions, like adding ids or resetting and printing the data, must not be called while
+	other threads run profiled code.
 	*/
 	inline void start(s32 id);
 
@@ -205,15 +209,64 @@ public:
 	\param groupIndex_	*/
     virtual void printGroup(core::stringw &result, u32 groupIndex, bool suppressUncalled) const = 0;
 
+	//! Start recording a timeline of all start and stop calls
+	/** Each start and stop call of an added id is recorded with a timestamp in microseconds
+	and the thread which made it. Events are kept in a ring buffer, so only the newest
+	events are kept and recording never allocates. When not tracing the only cost in
+	start/stop is checking a flag. Starting again clears all recorded events.
+	The ids of the engine itself are only used when it was compiled with _IRR_COMPILE_WITH_PROFILING_.
+	\param maxEvents Size of the ring buffer. Rounded up to a power of two. */
+	virtual void startTrace(u32 maxEvents=65536) = 0;
+
+	//! Stop recording the timeline. Recorded events are kept until the next startTrace.
+	virtual void stopTrace() = 0;
+
+	//! Check if the timeline is currently recorded
+	bool isTracing() const
+	{
+		return Tracing;
+	}
+
+	//! Return the number of events in the ring buffer
+	virtual u32 getTraceEventCount() const = 0;
+
+	//! Write the recorded timeline in the Chrome trace event format (JSON)
+	/** The result can be loaded in chrome://tracing or other trace viewers. Names and
+	groups of the ids are used as event names and categories. Stop events for which the
+	start event was already overwritten in the ring buffer are left out.
+	Should not be called while other threads are running profiled code.
+	\param result Receives the result string. */
+	virtual void printTrace(core::stringc &result) const = 0;
+
 protected:
 
     inline u32 addGroup(const core::stringw &name);
 
+	//! Record a start (begin=true) or stop event for the timeline
+	virtual void addTraceEvent(s32 id, bool begin) = 0;
+
+	//! Atomically add to a value of the profile data, returns the new value
+	virtual u32 atomicAdd(u32& value, u32 add) = 0;
+
+	//! Atomically replace a value of the profile data if it still is the expected one
+	/** eturn true when the value was replaced */
+	virtual bool atomicCompareAndSwap(u32& value, u32 expected, u32 newValue) = 0;
+
+	//! Add a finished call to profile data, called by stop
+	inline void addCallTime(SProfileData& data, u32 diffTime);
+
+	//! Get the index of the profile data for an id, -1 when it does not exist
+	s32 getDataIndexById(s32 id) const
+	{
+		return ProfileDatas.binary_search(SProfileData(id));
+	}
+
 	// I would prefer using os::Timer, but os.h is not in the public interface so far.
 	// Timer must be initialized by the implementation.
     ITimer * Timer;
 	core::array<SProfileData> ProfileDatas;
     core::array<SProfileData> ProfileGroups;
+	bool Tracing;
 
 private:
     s32 NextAutoId;	// for giving out id's automatically
@@ -283,9 +336,11 @@ void IProfiler::start(s32 id)
 	s32 idx = ProfileDatas.binary_search(SProfileData(id));
 	if ( idx >= 0 && Timer )
 	{
-		++ProfileDatas[idx].StartStopCounter;
-		if (ProfileDatas[idx].StartStopCounter == 1 )
-			ProfileDatas[idx].LastTimeStarted = Timer->getRealTime();
+		if ( Tracing )
+			addTraceEvent(id, true);
+		SProfileData &data = ProfileDatas[idx];
+		if ( atomicAdd(data.StartStopCounter, 1) == 1 )
+			data.LastTimeStarted = Timer->getRealTime();
 	}
 }
 
@@ -297,35 +352,45 @@ void IProfiler::stop(s32 id)
 		s32 idx = ProfileDatas.binary_search(SProfileData(id));
 		if ( idx >= 0 )
 		{
+			if ( Tracing )
+				addTraceEvent(id, false);
 			SProfileData &data = ProfileDatas[idx];
-			--ProfileDatas[idx].StartStopCounter;
-			if ( data.LastTimeStarted != 0 && ProfileDatas[idx].StartStopCounter == 0)
-			{
-				// update data for this id
-				++data.CountCalls;
-				u32 diffTime = timeNow - data.LastTimeStarted;
-				data.TimeSum += diffTime;
-				if ( diffTime > data.LongestTime )
-					data.LongestTime = diffTime;
-				data.LastTimeStarted = 0;
-
-				// update data of it's group
-				SProfileData & group = ProfileGroups[data.GroupIndex];
-				++group.CountCalls;
-				group.TimeSum += diffTime;
-				if ( diffTime > group.LongestTime )
-					group.LongestTime = diffTime;
-				group.LastTimeStarted = 0;
-			}
-			else if ( ProfileDatas[idx].StartStopCounter < 0 )
+			for (;;)
 			{
-				// ignore additional stop calls
-				ProfileDatas[idx].StartStopCounter = 0;
+				const u32 counter = atomicAdd(data.StartStopCounter, 0);
+				if ( counter == 0 )
+					break;	// ignore additional stop calls
+
+				// the start time is valid while the counter is 1, the thread which
+				// started the id set it before it could stop again. A new start after
+				// the counter got 0 sets its own start time.
+				const u32 started = data.LastTimeStarted;
+				if ( atomicCompareAndSwap(data.StartStopCounter, counter, counter-1) )
+				{
+					if ( counter == 1 && started != 0 )
+					{
+						// update data for this id and of it's group
+						const u32 diffTime = timeNow - started;
+						addCallTime(data, diffTime);
+						addCallTime(ProfileGroups[data.GroupIndex], diffTime);
+					}
+					break;
+				}
 			}
 		}
 	}
 }
 
+void IProfiler::addCallTime(SProfileData& data, u32 diffTime)
+{
+	atomicAdd(data.CountCalls, 1);
+	atomicAdd(data.TimeSum, diffTime);
+
+	u32 longest = data.LongestTime;
+	while ( diffTime > longest && !atomicCompareAndSwap(data.LongestTime, longest, diffTime) )
+		longest = data.LongestTime;
+}
+
 s32 IProfiler::add(const core::stringw &name, const core::stringw &groupName)
 {
 	u32 index;
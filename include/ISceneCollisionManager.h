@@ -10,6 +10,8 @@
 #include "triangle3d.h"
 #include "position2d.h"
 #include "line3d.h"
+#include "aabbox3d.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -205,6 +207,23 @@ namespace scene
 		virtual ISceneNode* getSceneNodeFromCameraBB(const ICameraSceneNode* camera,
 			s32 idBitMask=0, bool bNoDebugObjects = false) = 0;
 
+		//! Collects the scene nodes whose bounding box intersects a box.
+		/** The bounding box of each scene node is transformed into world
+		space before it is tested. Like for getSceneNodeFromRayBB(), only
+		visible nodes below visible parents are found, and nodes with an
+		empty bounding box are ignored.
+		\param box Box in world space.
+		\param outNodes Receives the nodes, in no particular order.
+		\param idBitMask Only scene nodes with an id which matches at
+		least one of the bits contained in this mask will be tested.
+		However, if this parameter is 0, then all nodes are checked.
+		\param bNoDebugObjects: Doesn't take debug objects into account when true. These
+		are scene nodes with IsDebugObject() = true.
+		\param root If different from 0, the search is limited to the children of this node. */
+		virtual void getSceneNodesFromBox(const core::aabbox3d<f32>& box,
+			core::array<ISceneNode*>& outNodes, s32 idBitMask=0,
+			bool bNoDebugObjects=false, ISceneNode* root=0) = 0;
+
 
 		//! Perform a ray/box and ray/triangle collision check on a hierarchy of scene nodes.
 		/** This checks all scene nodes under the specified one, first by ray/bounding
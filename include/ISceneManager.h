@@ -25,6 +25,7 @@ namespace irr
 {
 	struct SKeyMap;
 	struct SEvent;
+	class IAsyncLoadRequest;
 
 namespace io
 {
@@ -101,6 +102,7 @@ namespace scene
 	class IBillboardTextSceneNode;
 	class ICameraSceneNode;
 	class IDummyTransformationSceneNode;
+	class IInstancedMeshSceneNode;
 	class ILightManager;
 	class ILightSceneNode;
 	class IMesh;
@@ -395,6 +397,21 @@ namespace scene
 		IReferenceCounted::drop() for more information. */
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) = 0;
 
+		//! Loads a mesh in the background
+		/** The file is read and the mesh created on the loader thread of
+		the video driver, see IVideoDriver::getAsyncLoader(). The mesh
+		is added to the mesh cache on the thread which draws when the
+		request is finished. Meshes already in the cache are returned by
+		a request which is done at once. Works like getMesh() otherwise.
+		\param filename Filename of the mesh to load.
+		\param alternativeCacheName Name of the mesh in the cache,
+		the filename if empty.
+		\return The request, which is always returned, check its state
+		for the result. This pointer should be dropped. See
+		IReferenceCounted::drop() for more information. */
+		virtual IAsyncLoadRequest* createMeshLoadRequest(const io::path& filename,
+			const io::path& alternativeCacheName=io::path("")) = 0;
+
 		//! Get interface to the mesh cache which is shared between all existing scene managers.
 		/** With this interface, it is possible to manually add new loaded
 		meshes (if ISceneManager::getMesh() is not sufficient), to remove them and to iterate
@@ -510,6 +527,24 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) = 0;
 
+		//! Adds a scene node for rendering many instances of a static mesh.
+		/** Use IInstancedMeshSceneNode::addInstance() to place the copies.
+		\param mesh: Pointer to the loaded static mesh to be displayed.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\param alsoAddIfMeshPointerZero: Add the scene node even if a 0 pointer is passed.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) = 0;
+
 		//! Adds a scene node for rendering a animated water surface mesh.
 		/** Looks really good when the Material type EMT_TRANSPARENT_REFLECTION
 		is used.
@@ -1120,6 +1155,37 @@ namespace scene
 		virtual u32 registerNodeForRendering(ISceneNode* node,
 			E_SCENE_NODE_RENDER_PASS pass = ESNRP_AUTOMATIC) = 0;
 
+		//! Registers a single solid mesh buffer of a node for rendering.
+		/** Like registerNodeForRendering() this should only be used by scene
+		nodes in their ISceneNode::OnRegisterSceneNode() call. The buffer is
+		drawn by the scene manager in the solid pass, with the absolute
+		transformation of the node and without calling the node's render().
+		All solid buffers and nodes of a frame are sorted by their material,
+		so material changes are minimized over the whole scene.
+		No culling is done here, use isCulled() on the node before.
+		\param node: Node owning the mesh buffer.
+		\param buffer: Mesh buffer to draw.
+		\param material: Material to draw the buffer with. It has to stay
+		valid until drawAll() is finished.
+		\return 1 if the buffer will be rendered. */
+		virtual u32 registerMeshBufferForRendering(ISceneNode* node,
+			IMeshBuffer* buffer, const video::SMaterial& material) = 0;
+
+		//! Get the number of material changes avoided in the last solid pass.
+		/** Counts the solid mesh buffers drawn by drawAll() which could use the
+		material of the buffer before without setting it again. */
+		virtual u32 getMaterialChangesAvoided() const = 0;
+
+		//! Registers a mesh scene node for static batching.
+		/** Only has an effect if the parameter STATIC_MESH_BATCHING is set.
+		Called by mesh scene nodes in OnRegisterSceneNode(). Nodes which are
+		registered with an unchanged transformation for a few frames get their
+		solid buffers merged into batches.
+		\param node: Mesh scene node to batch.
+		\return 1 if the solid buffers of the node are already drawn by a
+		batch, the node then must not register them itself. */
+		virtual u32 registerMeshForStaticBatching(IMeshSceneNode* node) = 0;
+
 		//! Clear all nodes which are currently registered for rendering
 		/** Usually you don't have to care about this as drawAll will clear nodes
 		after rendering them. But sometimes you might have to manully reset this.
@@ -1354,6 +1420,38 @@ namespace scene
 		virtual ITriangleSelector* createOctreeTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
 			ISceneNode* node, s32 minimalPolysPerNode=32) = 0;
 
+		//! Creates a Triangle Selector, optimized by a bounding volume hierarchy.
+		/** Like the octree selector, but the triangles are sorted into a
+		hierarchy of boxes split by the surface area heuristic. It answers
+		ITriangleSelector::getCollisionPoint(), ITriangleSelector::getLineHits()
+		and ITriangleSelector::visitTriangles() by traversing the hierarchy,
+		so ISceneCollisionManager::getCollisionPoint() and the collision
+		response of ISceneCollisionManager::getCollisionResultPosition() don't
+		need to copy and test all triangles near the line or the box.
+		The mesh is expected not to change after the selector is created.
+		\param mesh: Mesh of which the triangles are taken.
+		\param node: Scene node of which visibility and transformation is used.
+		\param maximalPolysPerLeaf: A box with no more polygons than this is
+		not split any further.
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(IMesh* mesh,
+			ISceneNode* node, s32 maximalPolysPerLeaf=4) = 0;
+
+		//! Creates a Triangle Selector for a single meshbuffer, optimized by a bounding volume hierarchy.
+		/** See createBVHTriangleSelector() for a mesh.
+		\param meshBuffer: Meshbuffer of which the triangles are taken.
+		\param materialIndex: Setting this value allows the triangle selector to return the material index
+		\param node: Scene node of which visibility and transformation is used.
+		\param maximalPolysPerLeaf: A box with no more polygons than this is
+		not split any further.
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
+			ISceneNode* node, s32 maximalPolysPerLeaf=4) = 0;
+
 		//! //! Creates a Triangle Selector, optimized by an octree.
 		/** \deprecated Use createOctreeTriangleSelector instead. This method may be removed by Irrlicht 1.9. */
 		_IRR_DEPRECATED_ ITriangleSelector* createOctTreeTriangleSelector(IMesh* mesh,
@@ -49,8 +49,9 @@ namespace scene
 		virtual s32 getJointNumber(const c8* name) const = 0;
 
 		//! Use animation from another mesh
-		/** The animation is linked (not copied) based on joint names
-		so make sure they are unique.
+		/** The animation keys are copied based on joint names
+		so make sure they are unique. Changes to the other mesh after
+		this call are not used.
 		\return True if all joints in this mesh were
 		matched up (empty names will not be matched, and it's case
 		sensitive). Unmatched joints will not be animated. */
@@ -90,13 +91,6 @@ namespace scene
 
 			//! Weight Strength/Percentage (0-1)
 			f32 strength;
-
-		private:
-			//! Internal members used by CSkinnedMesh
-			friend class CSkinnedMesh;
-			bool *Moved;
-			core::vector3df StaticPos;
-			core::vector3df StaticNormal;
 		};
 
 
@@ -142,12 +136,15 @@ namespace scene
 			core::array<u32> AttachedMeshes;
 
 			//! Animation keys causing translation change
+			/** Freed by finalize(), use ISkinnedMesh::getJointKeys() to read the keys then. */
 			core::array<SPositionKey> PositionKeys;
 
 			//! Animation keys causing scale change
+			/** Freed by finalize(), use ISkinnedMesh::getJointKeys() to read the keys then. */
 			core::array<SScaleKey> ScaleKeys;
 
 			//! Animation keys causing rotation change
+			/** Freed by finalize(), use ISkinnedMesh::getJointKeys() to read the keys then. */
 			core::array<SRotationKey> RotationKeys;
 
 			//! Skin weights
@@ -190,8 +187,23 @@ namespace scene
 		virtual const core::array<SJoint*>& getAllJoints() const = 0;
 
 		//! loaders should call this after populating the mesh
+		/** The animation keys of the joints are packed for sampling then
+		and the key arrays of the joints are freed. Keys added later are
+		only animated after calling finalize again, which keeps the packed
+		keys of all key arrays which are still empty. */
 		virtual void finalize() = 0;
 
+		//! Gets the animation keys of a joint
+		/** Returns the keys of the key arrays of the joint, or the keys
+		packed by finalize() when the arrays are empty. Packed rotations
+		have a precision of 16 bit per component.
+		\param joint Joint of this mesh.
+		\param positionKeys Receives the position keys.
+		\param scaleKeys Receives the scale keys.
+		\param rotationKeys Receives the rotation keys. */
+		virtual void getJointKeys(const SJoint *joint, core::array<SPositionKey> &positionKeys,
+			core::array<SScaleKey> &scaleKeys, core::array<SRotationKey> &rotationKeys) const = 0;
+
 		//! Adds a new meshbuffer to the mesh, access it as last one
 		virtual SSkinMeshBuffer* addMeshBuffer() = 0;
 
@@ -10,6 +10,7 @@
 #include "dimension2d.h"
 #include "EDriverTypes.h"
 #include "path.h"
+#include "irrArray.h"
 #include "matrix4.h"
 
 namespace irr
@@ -45,7 +46,8 @@ enum E_TEXTURE_CREATION_FLAG
 	chooses the format in which the texture was stored on disk.
 	When using this flag, it does not make sense to use the flags
 	ETCF_ALWAYS_16_BIT, ETCF_ALWAYS_32_BIT, or ETCF_OPTIMIZED_FOR_SPEED at
-	the same time. */
+	the same time. Burning's Video also filters the mip map levels it
+	creates with EMMF_KAISER. */
 	ETCF_OPTIMIZED_FOR_QUALITY = 0x00000004,
 
 	/** Lets the driver decide in which format the textures are created and
@@ -156,7 +158,8 @@ public:
 
 	//! constructor
 	ITexture(const io::path& name, E_TEXTURE_TYPE type) : NamedPath(name), DriverType(EDT_NULL), OriginalColorFormat(ECF_UNKNOWN),
-		ColorFormat(ECF_UNKNOWN), Pitch(0), HasMipMaps(false), IsRenderTarget(false), Source(ETS_UNKNOWN), Type(type)
+		ColorFormat(ECF_UNKNOWN), Pitch(0), HasMipMaps(false), IsRenderTarget(false), Source(ETS_UNKNOWN), Type(type),
+		LastUsedFrame(0), Evicted(false), LockedForWriting(false)
 	{
 	}
 
@@ -286,8 +289,78 @@ public:
 	//! Returns the type of texture
 	E_TEXTURE_TYPE getType() const { return Type; }
 
+	//! Get the number of the last frame in which the driver used the texture
+	/** The frames are counted by IVideoDriver::endScene(). */
+	u32 getLastUsedFrame() const { return LastUsedFrame; }
+
+	//! Used internally by the video drivers to track the usage of the texture.
+	void updateLastUsedFrame(u32 frame) { LastUsedFrame = frame; }
+
+	//! Check whether the texture budget of the driver released the pixel data
+	/** See IVideoDriver::setTextureMemoryBudget(). An evicted texture
+	stays valid and is loaded again when the driver uses it the next time,
+	lock() fails until then. */
+	bool isEvicted() const { return Evicted; }
+
+	//! Get the memory used by the pixel data of the texture
+	/** Calculated from the size and color format, including the mip map
+	levels and all cubemap faces.
+	\return Size in bytes, 0 for evicted textures. */
+	u32 getMemorySize() const
+	{
+		if (Evicted)
+			return 0;
+
+		u32 size = 0;
+		core::dimension2d<u32> levelSize(Size);
+		for (;;)
+		{
+			size += IImage::getDataSizeFromFormat(ColorFormat, levelSize.Width, levelSize.Height);
+			if (!HasMipMaps || (levelSize.Width == 1 && levelSize.Height == 1))
+				break;
+			levelSize.Width = core::max_(levelSize.Width >> 1, 1u);
+			levelSize.Height = core::max_(levelSize.Height >> 1, 1u);
+		}
+
+		return (Type == ETT_CUBEMAP) ? size * 6 : size;
+	}
+
+	//! Releases the pixel data of the texture.
+	/** Used internally by the texture budget of the video driver. Does
+	nothing for textures which can not be evicted. Textures which were locked
+	for writing are never evicted, reloading them would lose the changes.
+	\return True if the texture is evicted. */
+	bool evict()
+	{
+		if (!Evicted && !IsRenderTarget && !LockedForWriting)
+			Evicted = evictData();
+		return Evicted;
+	}
+
+	//! Creates the pixel data of an evicted texture again
+	/** Used internally by the texture budget of the video driver.
+	\param images The images the texture was created from.
+	\return True if the texture is not evicted anymore. */
+	bool restore(const core::array<IImage*>& images)
+	{
+		if (Evicted && images.size())
+		{
+			// cleared first, drivers may bind the texture while uploading
+			Evicted = false;
+			Evicted = !restoreData(images);
+		}
+		return !Evicted;
+	}
+
 protected:
 
+	//! Releases the pixel data of the texture.
+	/** \return False if the texture can not be evicted by the driver. */
+	virtual bool evictData() { return false; }
+
+	//! Creates the pixel data of the texture again from the images it was created from.
+	virtual bool restoreData(const core::array<IImage*>& images) { return false; }
+
 	//! Helper function, helps to get the desired texture creation format from the flags.
 	/** \return Either ETCF_ALWAYS_32_BIT, ETCF_ALWAYS_16_BIT,
 	ETCF_OPTIMIZED_FOR_QUALITY, or ETCF_OPTIMIZED_FOR_SPEED. */
@@ -315,6 +388,11 @@ protected:
 	bool IsRenderTarget;
 	E_TEXTURE_SOURCE Source;
 	E_TEXTURE_TYPE Type;
+	u32 LastUsedFrame;
+	bool Evicted;
+
+	//! set by the drivers in lock() unless the mode is ETLM_READ_ONLY
+	bool LockedForWriting;
 };
 
 
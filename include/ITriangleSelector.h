@@ -62,6 +62,23 @@ struct SCollisionTriangleRange
 	irr::u32 MaterialIndex;
 };
 
+//! Interface to receive triangles one at a time from ITriangleSelector::visitTriangles
+class ITriangleCallback
+{
+public:
+
+	//! Destructor
+	virtual ~ITriangleCallback() {}
+
+	//! Called for each triangle which may lie within the box
+	/** \param triangle The triangle, transformed like the triangles returned
+	by ITriangleSelector::getTriangles.
+	\param info Selector, scene node, meshbuffer and material of the triangle.
+	RangeStart and RangeSize are not used.
+	\return False to stop getting more triangles, true otherwise. */
+	virtual bool onTriangle(const core::triangle3df& triangle, const SCollisionTriangleRange& info) = 0;
+};
+
 //! Interface to return triangles with specific properties.
 /** Every ISceneNode may have a triangle selector, available with
 ISceneNode::getTriangleSelector() or ISceneManager::createTriangleSelector.
@@ -162,6 +179,65 @@ public:
 		const core::matrix4* transform=0, bool useNodeTransform=true,
 		irr::core::array<SCollisionTriangleRange>* outTriangleInfo=0) const = 0;
 
+	//! Check if the selector finds triangles by traversing a hierarchy.
+	/** Such selectors, like the ones created by
+	ISceneManager::createBVHTriangleSelector(), answer getCollisionPoint(),
+	getLineHits() and visitTriangles() without copying their triangles
+	into an array first. ISceneCollisionManager uses them when this
+	returns true. Other selectors do nothing in those methods.
+	\return True if the selector supports those methods. */
+	virtual bool hasHierarchy() const { return false; }
+
+	//! Finds the triangle which a line hits first.
+	/** Only supported when hasHierarchy() returns true. The triangles are
+	tested like in ISceneCollisionManager::getCollisionPoint().
+	\param line Line with which collisions are tested, in world space.
+	\param outIntersection Receives the hit position nearest to the
+	line start.
+	\param outTriangle Receives the hit triangle, in world space.
+	\param outTriangleInfo When a pointer is passed, it receives the
+	selector, scene node, meshbuffer and material of the hit triangle.
+	\return True if a triangle was hit, false otherwise. */
+	virtual bool getCollisionPoint(const core::line3d<f32>& line,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle,
+		SCollisionTriangleRange* outTriangleInfo=0) const
+	{
+		return false;
+	}
+
+	//! Checks for many lines at once whether they hit a triangle.
+	/** Meant for line of sight checks, which only need to know if
+	anything is in between. Only supported when hasHierarchy() returns
+	true. Large batches are checked on several threads.
+	\param lines Array of lines to check, in world space.
+	\param lineCount Number of lines.
+	\param outHits Array of lineCount elements. Each element is set to
+	true if its line hits a triangle, to false otherwise.
+	\return Number of lines which hit a triangle. */
+	virtual u32 getLineHits(const core::line3d<f32>* lines, u32 lineCount,
+		bool* outHits) const
+	{
+		return 0;
+	}
+
+	//! Passes the triangles which may lie within a box to a callback.
+	/** Like the getTriangles() method with a box, but without an array
+	for the triangles. Only supported when hasHierarchy() returns true.
+	\param callback Receives the triangles.
+	\param box Only triangles which may be in this axis aligned
+	bounding box are passed.
+	\param transform Pointer to matrix for transforming the triangles
+	before they are passed.
+	\param useNodeTransform When the selector has a node then transform
+	the triangles by that node's transformation matrix.
+	\return False if the callback stopped it, true otherwise. */
+	virtual bool visitTriangles(ITriangleCallback& callback,
+		const core::aabbox3d<f32>& box, const core::matrix4* transform=0,
+		bool useNodeTransform=true) const
+	{
+		return true;
+	}
+
 	//! Get number of TriangleSelectors that are part of this one
 	/** Only useful for MetaTriangleSelector, others return 1
 	*/
@@ -19,6 +19,8 @@
 #include "EDriverFeatures.h"
 #include "SExposedVideoData.h"
 #include "SOverrideMaterial.h"
+#include "SFrameStats.h"
+#include "IAsyncLoader.h"
 
 namespace irr
 {
@@ -417,6 +419,29 @@ namespace video
 		0 or another texture first. */
 		virtual void removeAllTextures() =0;
 
+		//! Set the memory budget for the textures loaded from files
+		/** When all textures use more memory than the budget at the end
+		of a frame, endScene() releases the pixel data of the least
+		recently used textures which were loaded from files with
+		getTexture(), until the textures fit into the budget again.
+		Textures used in the finished frame are kept. The evicted
+		textures stay valid and are loaded again from their files when
+		the driver uses them the next time, or when getTexture() returns
+		them. Burning's Video and the OpenGL drivers evict textures, the
+		null driver only accounts for them.
+		\param bytes Budget in bytes, 0 disables it, which is the default. */
+		virtual void setTextureMemoryBudget(u64 bytes) =0;
+
+		//! Get the memory budget for the textures loaded from files
+		/** \return Budget in bytes, 0 if disabled. */
+		virtual u64 getTextureMemoryBudget() const =0;
+
+		//! Get the memory used by the pixel data of all textures
+		/** Includes the render target textures and the textures which
+		were not loaded from files. See ITexture::getMemorySize().
+		\return Memory used in bytes. */
+		virtual u64 getTextureMemoryUsed() const =0;
+
 		//! Remove hardware buffer
 		virtual void removeHardwareBuffer(const scene::IMeshBuffer* mb) =0;
 
@@ -1000,6 +1025,24 @@ namespace video
 		/** \param mb Buffer to draw */
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) =0;
 
+		//! Draws many instances of a mesh buffer
+		/** Each instance is drawn with its own world transformation and
+		color, using the current material. If the driver supports
+		EVDF_INSTANCING and the current material is a GLSL shader with an
+		attribute mat4 inInstanceWorld, all instances are drawn with a
+		single call. The world transformation is then set to identity, and
+		the shader has to apply inInstanceWorld itself. The color is passed
+		in the optional attribute vec4 inInstanceColor. Otherwise the driver
+		draws the instances one after the other, which sets the world
+		transformation, and multiplies the vertex colors with the colors.
+		\param mb Buffer to draw.
+		\param transforms World transformations, one per instance.
+		\param colors Colors, one per instance. May be 0 for white.
+		\param instanceCount Number of instances. */
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const core::matrix4* transforms, const SColor* colors,
+			u32 instanceCount) =0;
+
 		//! Draws normals of a mesh buffer
 		/** \param mb Buffer to draw the normals of
 		\param length length scale factor of the normals
@@ -1064,6 +1107,52 @@ namespace video
 		\return Amount of primitives drawn in the last frame. */
 		virtual u32 getPrimitiveCountDrawn( u32 mode =0 ) const =0;
 
+		//! Get the statistics of the frame currently drawn
+		/** The counters are reset by beginScene(). Scene managers and
+		custom renderers can add their own counts.
+		\return Statistics of the current frame. */
+		virtual SFrameStats& getFrameStats() =0;
+
+		//! Get the statistics of a finished frame
+		/** \param framesAgo 0 for the frame finished by the last
+		endScene(), up to getFrameStatsHistoryCount()-1 for older ones.
+		\return Statistics of the frame, or all zero for frames which
+		are not in the history. */
+		virtual const SFrameStats& getFrameStatsHistory(u32 framesAgo=0) const =0;
+
+		//! Get the number of frames in the statistics history
+		virtual u32 getFrameStatsHistoryCount() const =0;
+
+		//! Set the number of finished frames kept in the statistics history
+		/** Clears the history. The default size is 128 frames.
+		\param frames Number of frames, 0 disables the history. */
+		virtual void setFrameStatsHistorySize(u32 frames) =0;
+
+		//! Writes the statistics history as comma separated values
+		/** The first line holds the names of the counters, followed by
+		one line per frame from the oldest to the newest one.
+		\param file File to write to.
+		\return True if successful. */
+		virtual bool writeFrameStatsHistory(io::IWriteFile* file) const =0;
+
+		//! Get the loader for loading resources in the background
+		/** Loaded requests are finished in beginScene(), within the
+		frame budget of the loader.
+		\return Pointer to the loader. This pointer should not be
+		dropped. See IReferenceCounted::drop() for more information. */
+		virtual IAsyncLoader* getAsyncLoader() =0;
+
+		//! Loads a texture in the background
+		/** The file is read and decoded on the loader thread, the
+		texture is created on the thread which draws when the request is
+		finished. Textures already loaded are returned by a request
+		which is done at once. Works like getTexture() otherwise.
+		\param filename Filename of the texture to be loaded.
+		\return The request, which is always returned, check its state
+		for the result. This pointer should be dropped. See
+		IReferenceCounted::drop() for more information. */
+		virtual IAsyncLoadRequest* createTextureLoadRequest(const io::path& filename) =0;
+
 		//! Deletes all dynamic lights which were previously added with addDynamicLight().
 		virtual void deleteAllDynamicLights() =0;
 
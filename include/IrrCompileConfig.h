@@ -128,12 +128,35 @@
 //! Enable profiling information in the engine
 /** NOTE: The profiler itself always exists and can be used by applications.
 This define is about the engine creating profile data
-while it runs and enabling it will slow down the engine. */
+while it runs and enabling it will slow down the engine.
+It is disabled by default, so the timeline of IProfiler::startTrace() then
+only shows the ids added by the application, not those of the scene manager,
+the gui or the mesh and texture loading. */
 //#define _IRR_COMPILE_WITH_PROFILING_
 #ifdef NO_IRR_COMPILE_WITH_PROFILING_
 #undef _IRR_COMPILE_WITH_PROFILING_
 #endif
 
+//! Define _IRR_COMPILE_WITH_MAPPED_FILES_ to map files from disk into memory instead of reading them
+/** Uncompressed files in archives are then read from the mapping without copies.
+Only available with the POSIX API, other systems always read files with fread. */
+#if defined(_IRR_POSIX_API_)
+#define _IRR_COMPILE_WITH_MAPPED_FILES_
+#endif
+#ifdef NO_IRR_COMPILE_WITH_MAPPED_FILES_
+#undef _IRR_COMPILE_WITH_MAPPED_FILES_
+#endif
+
+//! Define _IRR_COMPILE_WITH_SSE2_ to compile SSE2 and SSSE3 versions of image operations, software skinning and Burning's Video spans
+/** They are only used if the processor supports them, else the plain C++
+versions are used. Only available on x86 and x86-64. */
+#if (defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)) && !defined(_IRR_XBOX_PLATFORM_)
+#define _IRR_COMPILE_WITH_SSE2_
+#endif
+#ifdef NO_IRR_COMPILE_WITH_SSE2_
+#undef _IRR_COMPILE_WITH_SSE2_
+#endif
+
 //! Define _IRR_COMPILE_WITH_DIRECT3D_9_ to compile the Irrlicht engine with DIRECT3D9.
 /** If you only want to use the software device or opengl you can disable those defines.
 This switch is mostly disabled because people do not get the g++ compiler compile
@@ -0,0 +1,100 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_FRAME_STATS_H_INCLUDED__
+#define __S_FRAME_STATS_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Rendering statistics of one frame
+/** The video driver resets the counters in beginScene() and adds the finished
+frame to its history in endScene(). The scene manager adds the counters of its
+traversal while drawing. All counters are also available in release builds.
+Counters a driver can not measure stay 0. */
+struct SFrameStats
+{
+	SFrameStats()
+		: FrameTime(0), RenderTime(0),
+		NodesVisited(0), NodesCulledByOcclusionQuery(0), NodesCulledByBox(0),
+		NodesCulledByFrustumSphere(0), NodesCulledByFrustumBox(0),
+		NodesDrawnSolid(0), NodesDrawnTransparent(0), NodesDrawnTransparentEffect(0),
+		DrawCalls(0), PrimitivesDrawn(0), MaterialChanges(0), TextureBinds(0),
+		TexturesEvicted(0), TexturesReloaded(0),
+		VerticesTransformed(0), TrianglesRasterized(0), PixelsShaded(0)
+	{
+	}
+
+	//! Microseconds between the end of the previous frame and the end of this one
+	u32 FrameTime;
+
+	//! Microseconds between beginScene() and endScene()
+	u32 RenderTime;
+
+	//! Number of registrations of scene nodes for rendering
+	/** A node registering for several render passes is counted once per pass.
+	Nodes checking ISceneManager::isCulled() while registering, like mesh
+	scene nodes handing their buffers to the scene manager, are counted for
+	the check. */
+	u32 NodesVisited;
+
+	//! Registrations rejected by the culling methods of E_CULLING_TYPE
+	/** Each rejection is counted for the first method which culled the node,
+	in the order the scene manager checks them. */
+	u32 NodesCulledByOcclusionQuery;
+	u32 NodesCulledByBox;
+	u32 NodesCulledByFrustumSphere;
+	u32 NodesCulledByFrustumBox;
+
+	//! Entries in the render lists drawn by the scene manager
+	/** Solid entries include mesh buffers registered directly by nodes. */
+	u32 NodesDrawnSolid;
+	u32 NodesDrawnTransparent;
+	u32 NodesDrawnTransparentEffect;
+
+	//! Calls of drawVertexPrimitiveList and draw2DVertexPrimitiveList
+	u32 DrawCalls;
+
+	//! Primitives drawn, the same as IVideoDriver::getPrimitiveCountDrawn()
+	u32 PrimitivesDrawn;
+
+	//! Number of times the driver had to apply a different material
+	u32 MaterialChanges;
+
+	//! Number of times a texture was bound to a texture stage
+	u32 TextureBinds;
+
+	//! Textures evicted by the texture memory budget at the end of the frame
+	/** See IVideoDriver::setTextureMemoryBudget(). */
+	u32 TexturesEvicted;
+
+	//! Evicted textures loaded again from their files because they were used
+	u32 TexturesReloaded;
+
+	//! Vertices sent through the vertex transformation
+	/** Hardware drivers count all vertices of the drawn buffers. Burning's
+	Video only transforms the vertices used by the indices, once per miss of
+	its vertex cache. */
+	u32 VerticesTransformed;
+
+	//! Triangles handed to the rasterizer after clipping and backface culling
+	/** Only counted by Burning's Video. */
+	u32 TrianglesRasterized;
+
+	//! Pixels of the scanlines run through the pixel shaders
+	/** Only counted by Burning's Video. Pixels rejected by the coarse depth
+	buffer are not included, pixels failing the depth test are. */
+	u32 PixelsShaded;
+};
+
+
+} // end namespace video
+} // end namespace irr
+
+#endif
+
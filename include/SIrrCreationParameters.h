@@ -47,6 +47,7 @@ namespace irr
 			DisplayAdapter(0),
 			DriverMultithreaded(false),
 			UsePerformanceTimer(true),
+			RasterizerThreads(1),
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION)
 		{
 		}
@@ -79,6 +80,7 @@ namespace irr
 			DriverMultithreaded = other.DriverMultithreaded;
 			DisplayAdapter = other.DisplayAdapter;
 			UsePerformanceTimer = other.UsePerformanceTimer;
+			RasterizerThreads = other.RasterizerThreads;
 			return *this;
 		}
 
@@ -288,6 +290,14 @@ namespace irr
 		*/
 		bool UsePerformanceTimer;
 
+		//! Number of threads used by the software rasterizer.
+		/** Burning's Video splits the render target into horizontal
+		tiles which are rasterized in parallel by this many threads. The
+		output is identical to the single threaded rasterizer.
+		0 uses one thread per processor. Default: 1.
+		So far only supported by EDT_BURNINGSVIDEO. */
+		u32 RasterizerThreads;
+
 		//! Don't use or change this parameter.
 		/** Always set it to IRRLICHT_SDK_VERSION, which is done by default.
 		This is needed for sdk version checks. */
@@ -137,6 +137,19 @@ namespace scene
 	const c8* const OBJ_LOADER_IGNORE_MATERIAL_FILES = "OBJ_IgnoreMaterialFiles";
 
 
+	//! Name of the parameter for parsing large .obj files on several threads.
+	/** The value is the number of threads, 0 or 1 parses on the calling
+	thread only. Files are split into chunks of whole lines, which are
+	parsed in parallel and merged in file order, so the mesh is the same
+	for any number of threads.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::OBJ_LOADER_THREADS, 4);
+	\endcode
+	**/
+	const c8* const OBJ_LOADER_THREADS = "OBJ_LoaderThreads";
+
+
 	//! Flag to ignore the b3d file's mipmapping flag
 	/** Instead Irrlicht's texture creation flag is used. Use it like this:
 	\code
@@ -174,6 +187,57 @@ namespace scene
 	**/
 	const c8* const DEBUG_NORMAL_COLOR = "DEBUG_Normal_Color";
 
+	//! Name of the parameter for animating and registering scene nodes on several threads.
+	/** The value is the number of threads, 0 or 1 keeps the single threaded
+	traversal. ISceneManager::drawAll() then calls OnAnimate() and
+	OnRegisterSceneNode() of the children of the root node in parallel, each
+	child with its whole subtree on one thread. The render lists of all
+	threads are merged in the order of the single threaded traversal. The
+	subtree holding the active camera is animated on the calling thread
+	after all others, as camera animators read input devices.
+	Only enable it if nodes and animators of different subtrees do not share
+	mutable state, e.g. MD2 or MD3 meshes used by several nodes. Skinned
+	meshes may be shared, their nodes animate into poses of their own and the
+	pose cache of the mesh is locked. The collision manager can be used by
+	animators of several subtrees at once, but triangle selectors of animated
+	mesh nodes and bounding box selectors update their triangles when they
+	are queried, so they must not be shared that way.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::PARALLEL_SCENE_TRAVERSAL, 4);
+	\endcode
+	**/
+	const c8* const PARALLEL_SCENE_TRAVERSAL = "Parallel_Scene_Traversal";
+
+	//! Name of the parameter for merging static mesh scene nodes into batches.
+	/** The value is the edge length of the grid cells the batches are built
+	for, 0 disables batching. The solid buffers of mesh scene nodes which did
+	not move for a few frames are transformed into world space and appended to
+	large buffers, one set per grid cell and material. Cells are culled as a
+	whole. A cell is rebuilt when one of its nodes moves, changes its mesh or
+	materials, or is removed from the scene.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::STATIC_MESH_BATCHING, 500.f);
+	\endcode
+	**/
+	const c8* const STATIC_MESH_BATCHING = "Static_Mesh_Batching";
+
+	//! Name of the parameter for keeping the bounds of all scene nodes in a tree.
+	/** ISceneManager::drawAll() then keeps the world space bounding boxes of
+	all scene nodes in a dynamic bounding volume tree. Nodes are only
+	reinserted when their absolute transformation or bounding box changed.
+	The EAC_BOX culling test, and the picking and box queries of
+	ISceneCollisionManager, use the tree instead of visiting all nodes.
+	Those queries use the bounds from the last call of drawAll(), so nodes
+	which were added or moved since then may not be found.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::SCENE_NODE_TREE, true);
+	\endcode
+	**/
+	const c8* const SCENE_NODE_TREE = "Scene_Node_Tree";
+
 
 } // end namespace scene
 } // end namespace irr
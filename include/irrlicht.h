@@ -58,6 +58,8 @@
 #include "IAnimatedMeshMD2.h"
 #include "IAnimatedMeshMD3.h"
 #include "IAnimatedMeshSceneNode.h"
+#include "IAsyncLoader.h"
+#include "IAsyncLoadRequest.h"
 #include "IAttributeExchangingObject.h"
 #include "IAttributes.h"
 #include "IBillboardSceneNode.h"
@@ -104,6 +106,7 @@
 #include "IImageLoader.h"
 #include "IImageWriter.h"
 #include "IIndexBuffer.h"
+#include "IInstancedMeshSceneNode.h"
 #include "ILightSceneNode.h"
 #include "ILogger.h"
 #include "IMaterialRenderer.h"
@@ -115,6 +118,7 @@
 #include "IMeshManipulator.h"
 #include "IMeshSceneNode.h"
 #include "IMeshWriter.h"
+#include "IMemoryReadFile.h"
 #include "IOctreeSceneNode.h"
 #include "IColladaMeshWriter.h"
 #include "IMetaTriangleSelector.h"
@@ -175,6 +179,7 @@
 #include "SceneParameters.h"
 #include "SColor.h"
 #include "SExposedVideoData.h"
+#include "SFrameStats.h"
 #include "SIrrCreationParameters.h"
 #include "SKeyMap.h"
 #include "SLight.h"
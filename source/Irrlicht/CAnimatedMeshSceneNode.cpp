@@ -41,7 +41,8 @@ CAnimatedMeshSceneNode::CAnimatedMeshSceneNode(IAnimatedMesh* mesh,
 	TransitionTime(0), Transiting(0.f), TransitingBlend(0.f),
 	JointMode(EJUOR_NONE), JointsUsed(false),
 	Looping(true), ReadOnlyMaterials(false), RenderFromIdentity(false),
-	LoopCallBack(0), PassCount(0), Shadow(0), MD3Special(0)
+	LoopCallBack(0), PassCount(0), Shadow(0), ShadowFollowsMesh(false),
+	SkinnedPose(0), MD3Special(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CAnimatedMeshSceneNode");
@@ -57,6 +58,9 @@ CAnimatedMeshSceneNode::~CAnimatedMeshSceneNode()
 	if (MD3Special)
 		MD3Special->drop();
 
+	if (SkinnedPose)
+		SkinnedPose->drop();
+
 	if (Mesh)
 		Mesh->drop();
 
@@ -203,22 +207,26 @@ IMesh * CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 		return 0;
 #else
 
-		// As multiple scene nodes may be sharing the same skinned mesh, we have to
-		// re-animate it every frame to ensure that this node gets the mesh that it needs.
+		// As multiple scene nodes may be sharing the same skinned mesh, each node
+		// animates and skins into its own pose and the mesh itself is never changed.
+		// Nodes at the same frame get the same pose from the pose cache of the mesh.
 
 		CSkinnedMesh* skinnedMesh = reinterpret_cast<CSkinnedMesh*>(Mesh);
 
-		if (JointMode == EJUOR_CONTROL)//write to mesh
-			skinnedMesh->transferJointsToMesh(JointChildSceneNodes);
-		else
-			skinnedMesh->animateMesh(getFrameNr(), 1.0f);
+		if (JointMode == EJUOR_CONTROL)//write to pose
+		{
+			SkinnedPose = skinnedMesh->getUniquePose(SkinnedPose);
+			skinnedMesh->transferJointsToPose(*SkinnedPose, JointChildSceneNodes);
 
-		// Update the skinned mesh for the current joint transforms.
-		skinnedMesh->skinMesh();
+			// Update the skinned mesh buffers for the current joint transforms.
+			skinnedMesh->skinPose(*SkinnedPose);
+		}
+		else
+			SkinnedPose = skinnedMesh->getPose(getFrameNr(), SkinnedPose);
 
-		if (JointMode == EJUOR_READ)//read from mesh
+		if (JointMode == EJUOR_READ)//read from pose
 		{
-			skinnedMesh->recoverJointsFromMesh(JointChildSceneNodes);
+			skinnedMesh->recoverJointsFromPose(*SkinnedPose, JointChildSceneNodes);
 
 			//---slow---
 			for (u32 n=0;n<JointChildSceneNodes.size();++n)
@@ -228,13 +236,7 @@ IMesh * CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 				}
 		}
 
-		if(JointMode == EJUOR_CONTROL)
-		{
-			// For meshes other than EJUOR_CONTROL, this is done by calling animateMesh()
-			skinnedMesh->updateBoundingBox();
-		}
-
-		return skinnedMesh;
+		return SkinnedPose;
 #endif
 	}
 }
@@ -295,7 +297,11 @@ void CAnimatedMeshSceneNode::render()
 	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
 
 	if (Shadow && PassCount==1)
+	{
+		if (ShadowFollowsMesh && m)
+			Shadow->setShadowMesh(m);
 		Shadow->updateShadowVolumes();
+	}
 
 	// for debug purposes only:
 
@@ -401,22 +407,25 @@ void CAnimatedMeshSceneNode::render()
 		// show skeleton
 		if (DebugDataVisible & scene::EDS_SKELETON)
 		{
-			if (Mesh->getMeshType() == EAMT_SKINNED)
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+			if (Mesh->getMeshType() == EAMT_SKINNED && SkinnedPose)
 			{
 				// draw skeleton
 
-				for (u32 g=0; g < ((ISkinnedMesh*)Mesh)->getAllJoints().size(); ++g)
-				{
-					ISkinnedMesh::SJoint *joint=((ISkinnedMesh*)Mesh)->getAllJoints()[g];
+				const CSkinnedMesh* skinnedMesh = reinterpret_cast<CSkinnedMesh*>(Mesh);
 
-					for (u32 n=0;n<joint->Children.size();++n)
+				for (u32 g=0; g < SkinnedPose->Joints.size(); ++g)
+				{
+					const s32 parent = skinnedMesh->getJointParent(g);
+					if (parent >= 0)
 					{
-						driver->draw3DLine(joint->GlobalAnimatedMatrix.getTranslation(),
-								joint->Children[n]->GlobalAnimatedMatrix.getTranslation(),
+						driver->draw3DLine(SkinnedPose->Joints[parent].GlobalMatrix.getTranslation(),
+								SkinnedPose->Joints[g].GlobalMatrix.getTranslation(),
 								video::SColor(255,51,66,255));
 					}
 				}
 			}
+#endif
 
 			// show tag for quake3 models
 			if (Mesh->getMeshType() == EAMT_MD3)
@@ -564,6 +573,7 @@ IShadowVolumeSceneNode* CAnimatedMeshSceneNode::addShadowVolumeSceneNode(
 	if (!SceneManager->getVideoDriver()->queryFeature(video::EVDF_STENCIL_BUFFER))
 		return 0;
 
+	ShadowFollowsMesh = (shadowMesh == 0);
 	if (!shadowMesh)
 		shadowMesh = Mesh; // if null is given, use the mesh of node
 
@@ -834,12 +844,19 @@ void CAnimatedMeshSceneNode::setMesh(IAnimatedMesh* mesh)
 
 		// grab the mesh (it's non-null!)
 		Mesh->grab();
+
+		if (SkinnedPose)
+		{
+			SkinnedPose->drop();
+			SkinnedPose = 0;
+		}
 	}
 
 	// get materials and bounding box
 	Box = Mesh->getBoundingBox();
 
-	IMesh* m = Mesh->getMesh(0,0);
+	// skinned meshes are shared and not animated here, their buffers have the materials
+	IMesh* m = (Mesh->getMeshType() == EAMT_SKINNED) ? Mesh : Mesh->getMesh(0,0);
 	if (m)
 	{
 		Materials.clear();
@@ -956,9 +973,15 @@ void CAnimatedMeshSceneNode::animateJoints(bool CalculateAbsolutePositions)
 
 		CSkinnedMesh* skinnedMesh=reinterpret_cast<CSkinnedMesh*>(Mesh);
 
-		skinnedMesh->transferOnlyJointsHintsToMesh( JointChildSceneNodes );
-		skinnedMesh->animateMesh(frame, 1.0f);
-		skinnedMesh->recoverJointsFromMesh( JointChildSceneNodes);
+		if (JointMode == EJUOR_CONTROL)
+		{
+			// the joints will be transferred back to the pose, so keep it unshared
+			SkinnedPose = skinnedMesh->getUniquePose(SkinnedPose);
+			skinnedMesh->animatePose(*SkinnedPose, frame, 1.0f);
+		}
+		else
+			SkinnedPose = skinnedMesh->getPose(frame, SkinnedPose);
+		skinnedMesh->recoverJointsFromPose(*SkinnedPose, JointChildSceneNodes);
 
 		//-----------------------------------------
 		//		Transition
@@ -1042,7 +1065,8 @@ void CAnimatedMeshSceneNode::checkJoints()
 
 		//Create joints for SkinnedMesh
 		((CSkinnedMesh*)Mesh)->addJoints(JointChildSceneNodes, this, SceneManager);
-		((CSkinnedMesh*)Mesh)->recoverJointsFromMesh(JointChildSceneNodes);
+		SkinnedPose = ((CSkinnedMesh*)Mesh)->getPose(getFrameNr(), SkinnedPose);
+		((CSkinnedMesh*)Mesh)->recoverJointsFromPose(*SkinnedPose, JointChildSceneNodes);
 
 		JointsUsed=true;
 		JointMode=EJUOR_READ;
@@ -1118,6 +1142,10 @@ ISceneNode* CAnimatedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager*
 	newNode->Shadow = Shadow;
 	if (newNode->Shadow)
 		newNode->Shadow->grab();
+	newNode->ShadowFollowsMesh = ShadowFollowsMesh;
+	newNode->SkinnedPose = SkinnedPose;
+	if (newNode->SkinnedPose)
+		newNode->SkinnedPose->grab();
 	newNode->JointChildSceneNodes = JointChildSceneNodes;
 	newNode->PretransitingSave = PretransitingSave;
 	newNode->RenderFromIdentity = RenderFromIdentity;
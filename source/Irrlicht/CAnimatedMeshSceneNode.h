@@ -16,6 +16,7 @@ namespace irr
 namespace scene
 {
 	class IDummyTransformationSceneNode;
+	struct SSkinnedMeshPose;
 
 	class CAnimatedMeshSceneNode : public IAnimatedMeshSceneNode
 	{
@@ -196,6 +197,10 @@ namespace scene
 		s32 PassCount;
 
 		IShadowVolumeSceneNode* Shadow;
+		bool ShadowFollowsMesh; // shadow volume of the mesh of the current frame
+
+		// Joints and skinned mesh buffers of this node for skinned meshes
+		SSkinnedMeshPose* SkinnedPose;
 
 		core::array<IBoneSceneNode* > JointChildSceneNodes;
 		core::array<core::matrix4> PretransitingSave;
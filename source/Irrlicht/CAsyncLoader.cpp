@@ -0,0 +1,390 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CAsyncLoader.h"
+#include "os.h"
+
+#if defined(_IRR_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <pthread.h>
+#endif
+
+#if defined(_MSC_VER)
+	#define _IRR_THREAD_LOCAL __declspec(thread)
+#else
+	#define _IRR_THREAD_LOCAL __thread
+#endif
+
+namespace irr
+{
+
+// loader which runs on the calling thread
+static _IRR_THREAD_LOCAL const CAsyncLoader* CurrentLoader = 0;
+
+#if defined(_IRR_WINDOWS_API_)
+
+struct CAsyncLoader::SThreadData
+{
+	CRITICAL_SECTION Lock;
+	CONDITION_VARIABLE Changed;
+	HANDLE Thread;
+};
+
+static DWORD WINAPI asyncLoaderFun(void* p)
+{
+	((CAsyncLoader*) p)->workerLoop();
+	return 0;
+}
+
+#else
+
+struct CAsyncLoader::SThreadData
+{
+	pthread_mutex_t Lock;
+	pthread_cond_t Changed;
+	pthread_t Thread;
+};
+
+static void* asyncLoaderFun(void* p)
+{
+	((CAsyncLoader*) p)->workerLoop();
+	return 0;
+}
+
+#endif
+
+
+//! constructor
+CAsyncLoader::CAsyncLoader()
+: RequestCount(0), FrameBudget(2), LockedByLoader(false), LockDepth(0),
+	Started(false), Quit(false), Data(new SThreadData)
+{
+	#ifdef _DEBUG
+	setDebugName("CAsyncLoader");
+	#endif
+
+#if defined(_IRR_WINDOWS_API_)
+	InitializeCriticalSection(&Data->Lock);
+	InitializeConditionVariable(&Data->Changed);
+#else
+	pthread_mutex_init(&Data->Lock, 0);
+	pthread_cond_init(&Data->Changed, 0);
+#endif
+}
+
+
+//! destructor, finishes all requests and stops the thread
+CAsyncLoader::~CAsyncLoader()
+{
+	finishAllRequests();
+
+	if (Started)
+	{
+		lockData();
+		Quit = true;
+		wakeAll();
+		unlockData();
+
+#if defined(_IRR_WINDOWS_API_)
+		WaitForSingleObject(Data->Thread, INFINITE);
+		CloseHandle(Data->Thread);
+#else
+		pthread_join(Data->Thread, 0);
+#endif
+	}
+
+#if defined(_IRR_WINDOWS_API_)
+	DeleteCriticalSection(&Data->Lock);
+#else
+	pthread_cond_destroy(&Data->Changed);
+	pthread_mutex_destroy(&Data->Lock);
+#endif
+
+	delete Data;
+}
+
+
+void CAsyncLoader::lockData() const
+{
+#if defined(_IRR_WINDOWS_API_)
+	EnterCriticalSection(&Data->Lock);
+#else
+	pthread_mutex_lock(&Data->Lock);
+#endif
+}
+
+
+void CAsyncLoader::unlockData() const
+{
+#if defined(_IRR_WINDOWS_API_)
+	LeaveCriticalSection(&Data->Lock);
+#else
+	pthread_mutex_unlock(&Data->Lock);
+#endif
+}
+
+
+//! waits for a change, called with the data locked
+void CAsyncLoader::wait()
+{
+#if defined(_IRR_WINDOWS_API_)
+	SleepConditionVariableCS(&Data->Changed, &Data->Lock, INFINITE);
+#else
+	pthread_cond_wait(&Data->Changed, &Data->Lock);
+#endif
+}
+
+
+//! wakes all waiting threads, called with the data locked
+void CAsyncLoader::wakeAll()
+{
+#if defined(_IRR_WINDOWS_API_)
+	WakeAllConditionVariable(&Data->Changed);
+#else
+	pthread_cond_broadcast(&Data->Changed);
+#endif
+}
+
+
+//! Adds a request to be loaded on the loader thread
+void CAsyncLoader::addRequest(IAsyncLoadRequest* request)
+{
+	if (!request)
+		return;
+
+	request->grab();
+	request->setState(EALS_LOADING);
+
+	SRequest r;
+	r.Request = request;
+
+	lockData();
+	if (!Started)
+	{
+#if defined(_IRR_WINDOWS_API_)
+		DWORD id;
+		Data->Thread = CreateThread(0, 0, asyncLoaderFun, this, 0, &id);
+		Started = (0 != Data->Thread);
+#else
+		Started = (0 == pthread_create(&Data->Thread, 0, asyncLoaderFun, this));
+#endif
+	}
+	++RequestCount;
+
+	if (Started)
+	{
+		Queue.push_back(r);
+		wakeAll();
+		unlockData();
+	}
+	else
+	{
+		// no thread, load at once
+		unlockData();
+		lock();
+		r.Loaded = request->load();
+		unlock();
+
+		lockData();
+		Loaded.push_back(r);
+		unlockData();
+	}
+}
+
+
+//! finishes the requests of the loader thread, called with the data locked
+bool CAsyncLoader::finishWaitingRequests()
+{
+	if (Waiting.empty())
+		return false;
+
+	while (!Waiting.empty())
+	{
+		SRequest r = Waiting[0];
+		Waiting.erase(0);
+		unlockData();
+
+		r.Request->finish();
+
+		lockData();
+		*r.Finished = true;
+		wakeAll();
+	}
+
+	return true;
+}
+
+
+//! finishes the oldest loaded request, called with the data locked
+bool CAsyncLoader::finishLoadedRequest()
+{
+	if (Loaded.empty())
+		return false;
+
+	SRequest r = Loaded[0];
+	Loaded.erase(0);
+	unlockData();
+
+	if (r.Loaded && r.Request->finish())
+		r.Request->setState(EALS_DONE);
+	else
+		r.Request->setState(EALS_FAILED);
+	r.Request->drop();
+
+	lockData();
+	--RequestCount;
+	return true;
+}
+
+
+//! Finishes loaded requests on the calling thread
+u32 CAsyncLoader::finishRequests(u32 timeBudget)
+{
+	const u32 start = os::Timer::getRealTime();
+
+	lockData();
+	finishWaitingRequests();
+	if (finishLoadedRequest())
+	{
+		while (os::Timer::getRealTime() - start < timeBudget && finishLoadedRequest())
+			finishWaitingRequests();
+	}
+	const u32 count = RequestCount;
+	unlockData();
+
+	return count;
+}
+
+
+//! Waits until all requests are loaded and finishes them
+void CAsyncLoader::finishAllRequests()
+{
+	lockData();
+	while (RequestCount)
+	{
+		const bool waiting = finishWaitingRequests();
+		if (!finishLoadedRequest() && !waiting)
+			wait();
+	}
+	unlockData();
+}
+
+
+//! Get the number of requests which are not finished yet
+u32 CAsyncLoader::getRequestCount() const
+{
+	lockData();
+	const u32 count = RequestCount;
+	unlockData();
+	return count;
+}
+
+
+//! Set the milliseconds per frame spent in finishing requests
+void CAsyncLoader::setFrameBudget(u32 milliseconds)
+{
+	FrameBudget = milliseconds;
+}
+
+
+//! Get the milliseconds per frame spent in finishing requests
+u32 CAsyncLoader::getFrameBudget() const
+{
+	return FrameBudget;
+}
+
+
+//! Locks the mesh and image loaders
+void CAsyncLoader::lock()
+{
+	const bool loader = isLoaderThread();
+
+	lockData();
+	while (LockDepth && LockedByLoader != loader)
+	{
+		// the loader thread might wait for this thread to finish a request
+		if (loader || !finishWaitingRequests())
+			wait();
+	}
+	LockedByLoader = loader;
+	++LockDepth;
+	unlockData();
+}
+
+
+//! Unlocks the mesh and image loaders
+void CAsyncLoader::unlock()
+{
+	lockData();
+	_IRR_DEBUG_BREAK_IF(0 == LockDepth || LockedByLoader != isLoaderThread());
+	if (0 == --LockDepth)
+		wakeAll();
+	unlockData();
+}
+
+
+//! Returns true if called on the loader thread
+bool CAsyncLoader::isLoaderThread() const
+{
+	return CurrentLoader == this;
+}
+
+
+//! Finishes a request on the thread which draws and waits for it
+void CAsyncLoader::finishOnDrawingThread(IAsyncLoadRequest* request)
+{
+	if (!isLoaderThread())
+	{
+		request->finish();
+		return;
+	}
+
+	bool finished = false;
+	SRequest r;
+	r.Request = request;
+	r.Finished = &finished;
+
+	lockData();
+	Waiting.push_back(r);
+	wakeAll();
+	while (!finished)
+		wait();
+	unlockData();
+}
+
+
+//! internal loader thread loop
+void CAsyncLoader::workerLoop()
+{
+	CurrentLoader = this;
+
+	lockData();
+	while (1)
+	{
+		while (!Quit && Queue.empty())
+			wait();
+
+		if (Quit)
+			break;
+
+		SRequest r = Queue[0];
+		Queue.erase(0);
+		unlockData();
+
+		lock();
+		r.Loaded = r.Request->load();
+		unlock();
+
+		lockData();
+		Loaded.push_back(r);
+		wakeAll();
+	}
+	unlockData();
+}
+
+
+} // end namespace irr
+
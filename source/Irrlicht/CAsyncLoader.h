@@ -0,0 +1,105 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_ASYNC_LOADER_H_INCLUDED__
+#define __C_ASYNC_LOADER_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "IAsyncLoader.h"
+#include "irrArray.h"
+
+namespace irr
+{
+
+//! Loads requests on one background thread
+class CAsyncLoader : public IAsyncLoader
+{
+public:
+
+	//! constructor, the thread is started with the first request
+	CAsyncLoader();
+
+	//! destructor, finishes all requests and stops the thread
+	virtual ~CAsyncLoader();
+
+	//! Adds a request to be loaded on the loader thread
+	virtual void addRequest(IAsyncLoadRequest* request) _IRR_OVERRIDE_;
+
+	//! Finishes loaded requests on the calling thread
+	virtual u32 finishRequests(u32 timeBudget) _IRR_OVERRIDE_;
+
+	//! Waits until all requests are loaded and finishes them
+	virtual void finishAllRequests() _IRR_OVERRIDE_;
+
+	//! Get the number of requests which are not finished yet
+	virtual u32 getRequestCount() const _IRR_OVERRIDE_;
+
+	//! Set the milliseconds per frame spent in finishing requests
+	virtual void setFrameBudget(u32 milliseconds) _IRR_OVERRIDE_;
+
+	//! Get the milliseconds per frame spent in finishing requests
+	virtual u32 getFrameBudget() const _IRR_OVERRIDE_;
+
+	//! Locks the mesh and image loaders
+	virtual void lock() _IRR_OVERRIDE_;
+
+	//! Unlocks the mesh and image loaders
+	virtual void unlock() _IRR_OVERRIDE_;
+
+	//! Returns true if called on the loader thread
+	virtual bool isLoaderThread() const _IRR_OVERRIDE_;
+
+	//! Finishes a request on the thread which draws and waits for it
+	/** For the loader thread, when a loader needs the video driver.
+	The thread which draws finishes these requests in finishRequests()
+	and while it waits for the loader lock. */
+	void finishOnDrawingThread(IAsyncLoadRequest* request);
+
+	//! internal loader thread loop, do not call
+	void workerLoop();
+
+private:
+
+	struct SRequest
+	{
+		SRequest() : Request(0), Loaded(false), Finished(0) {}
+
+		IAsyncLoadRequest* Request;
+		bool Loaded;
+		bool* Finished;
+	};
+
+	//! finishes the requests of the loader thread, called with the data locked
+	bool finishWaitingRequests();
+
+	//! finishes the oldest loaded request, called with the data locked
+	bool finishLoadedRequest();
+
+	void lockData() const;
+	void unlockData() const;
+	void wait();
+	void wakeAll();
+
+	core::array<SRequest> Queue;
+	core::array<SRequest> Loaded;
+	core::array<SRequest> Waiting;
+
+	u32 RequestCount;
+	u32 FrameBudget;
+
+	//! owner and depth of the loader lock
+	bool LockedByLoader;
+	u32 LockDepth;
+
+	bool Started;
+	bool Quit;
+
+	struct SThreadData;
+	SThreadData* Data;
+};
+
+} // end namespace irr
+
+#endif
+
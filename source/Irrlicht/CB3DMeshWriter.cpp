@@ -468,21 +468,26 @@ void CB3DMeshWriter::writeJointChunk(io::IWriteFile* file, ISkinnedMesh* mesh ,
     }
     // ---------------------------
 
-    // Animation keys
-    if (joint->PositionKeys.size())
+    // Animation keys, the key arrays of the joints are empty after finalize
+    core::array<ISkinnedMesh::SPositionKey> positionKeys;
+    core::array<ISkinnedMesh::SScaleKey> scaleKeys;
+    core::array<ISkinnedMesh::SRotationKey> rotationKeys;
+    mesh->getJointKeys(joint, positionKeys, scaleKeys, rotationKeys);
+
+    if (positionKeys.size())
     {
         write(file, "KEYS", 4);
-        u32 keysSize = 4 * joint->PositionKeys.size() * 4; // X, Y and Z pos + frame
+        u32 keysSize = 4 * positionKeys.size() * 4; // X, Y and Z pos + frame
         keysSize += 4;  // Flag to define the type of the key
         write(file, &keysSize, 4);
 
         u32 flag = 1; // 1 = flag for position keys
         write(file, &flag, 4);
 
-        for (u32 i = 0; i < joint->PositionKeys.size(); i++)
+        for (u32 i = 0; i < positionKeys.size(); i++)
         {
-            const s32 frame = static_cast<s32>(joint->PositionKeys[i].frame);
-            const core::vector3df pos = joint->PositionKeys[i].position;
+            const s32 frame = static_cast<s32>(positionKeys[i].frame);
+            const core::vector3df pos = positionKeys[i].position;
 
             write (file, &frame, 4);
 
@@ -492,20 +497,20 @@ void CB3DMeshWriter::writeJointChunk(io::IWriteFile* file, ISkinnedMesh* mesh ,
 
         }
     }
-    if (joint->RotationKeys.size())
+    if (rotationKeys.size())
     {
         write(file, "KEYS", 4);
-        u32 keysSize = 4 * joint->RotationKeys.size() * 5; // W, X, Y and Z rot + frame
+        u32 keysSize = 4 * rotationKeys.size() * 5; // W, X, Y and Z rot + frame
         keysSize += 4; // Flag
         write(file, &keysSize, 4);
 
         u32 flag = 4;
         write(file, &flag, 4);
 
-        for (u32 i = 0; i < joint->RotationKeys.size(); i++)
+        for (u32 i = 0; i < rotationKeys.size(); i++)
         {
-            const s32 frame = static_cast<s32>(joint->RotationKeys[i].frame);
-            const core::quaternion rot = joint->RotationKeys[i].rotation;
+            const s32 frame = static_cast<s32>(rotationKeys[i].frame);
+            const core::quaternion rot = rotationKeys[i].rotation;
 
             write (file, &frame, 4);
 
@@ -515,20 +520,20 @@ void CB3DMeshWriter::writeJointChunk(io::IWriteFile* file, ISkinnedMesh* mesh ,
             write (file, &rot.Z, 4);
         }
     }
-    if (joint->ScaleKeys.size())
+    if (scaleKeys.size())
     {
         write(file, "KEYS", 4);
-        u32 keysSize = 4 * joint->ScaleKeys.size() * 4; // X, Y and Z scale + frame
+        u32 keysSize = 4 * scaleKeys.size() * 4; // X, Y and Z scale + frame
         keysSize += 4; // Flag
         write(file, &keysSize, 4);
 
         u32 flag = 2;
         write(file, &flag, 4);
 
-        for (u32 i = 0; i < joint->ScaleKeys.size(); i++)
+        for (u32 i = 0; i < scaleKeys.size(); i++)
         {
-            const s32 frame = static_cast<s32>(joint->ScaleKeys[i].frame);
-            const core::vector3df scale = joint->ScaleKeys[i].scale;
+            const s32 frame = static_cast<s32>(scaleKeys[i].frame);
+            const core::vector3df scale = scaleKeys[i].scale;
 
             write (file, &frame, 4);
 
@@ -562,27 +567,33 @@ u32 CB3DMeshWriter::getJointChunkSize(const ISkinnedMesh* mesh, ISkinnedMesh::SJ
     u32 boneSize = joint->Weights.size() * 8; // vertex_id + weight = 8 bits per weight block
     boneSize += 8; // declaration + size of he BONE chunk
 
+    // the key arrays of the joints are empty after finalize
+    core::array<ISkinnedMesh::SPositionKey> positionKeys;
+    core::array<ISkinnedMesh::SScaleKey> scaleKeys;
+    core::array<ISkinnedMesh::SRotationKey> rotationKeys;
+    mesh->getJointKeys(joint, positionKeys, scaleKeys, rotationKeys);
+
     u32 keysSize = 0;
-    if (joint->PositionKeys.size() != 0)
+    if (positionKeys.size() != 0)
     {
         keysSize += 8; // KEYS + chunk size
         keysSize += 4; // flags
 
-        keysSize += (joint->PositionKeys.size() * 16);
+        keysSize += (positionKeys.size() * 16);
     }
-    if (joint->RotationKeys.size() != 0)
+    if (rotationKeys.size() != 0)
     {
         keysSize += 8; // KEYS + chunk size
         keysSize += 4; // flags
 
-        keysSize += (joint->RotationKeys.size() * 20);
+        keysSize += (rotationKeys.size() * 20);
     }
-    if (joint->ScaleKeys.size() != 0)
+    if (scaleKeys.size() != 0)
     {
         keysSize += 8; // KEYS + chunk size
         keysSize += 4; // flags
 
-        keysSize += (joint->ScaleKeys.size() * 16);
+        keysSize += (scaleKeys.size() * 16);
     }
 
     chunkSize += boneSize;
@@ -0,0 +1,742 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBVHTriangleSelector.h"
+#include "ISceneNode.h"
+#include "CThreadPool.h"
+
+#include "os.h"
+
+namespace irr
+{
+namespace scene
+{
+
+// Number of bins in which the surface area heuristic tries splits per axis
+static const u32 BVH_BINS = 16;
+
+// Deeper nodes are not split, the traversal stacks have room for this
+static const u32 BVH_MAX_DEPTH = 60;
+static const u32 BVH_STACK_SIZE = 64;
+
+// Cost of visiting a node, relative to testing one triangle
+static const f32 BVH_TRAVERSAL_COST = 1.f;
+
+// Relative tolerance for lines touching boxes after being transformed
+static const f32 BVH_TOLERANCE = 0.0001f;
+
+// Number of lines checked by one part of a getLineHits job
+static const u32 LINE_HITS_BAND = 64;
+
+namespace
+{
+	inline f32 getAxis(const core::vector3df& v, u32 axis)
+	{
+		return axis == 0 ? v.X : (axis == 1 ? v.Y : v.Z);
+	}
+
+	inline f32 getInverse(f32 v)
+	{
+		// a tiny value instead of 0, so no slab test gets 0*inf
+		if (core::iszero(v, 1e-20f))
+			v = v < 0.f ? -1e-20f : 1e-20f;
+		return 1.f / v;
+	}
+
+	//! returns true if a line touches a box before maxT, outT is where it enters it
+	/** The line is given by its start and the inverse of its vector, t is
+	the fraction of the line vector. */
+	inline bool intersectsLine(const core::aabbox3df& box, const core::vector3df& start,
+		const core::vector3df& invVector, f32 maxT, f32& outT)
+	{
+		f32 t0 = (box.MinEdge.X - start.X) * invVector.X;
+		f32 t1 = (box.MaxEdge.X - start.X) * invVector.X;
+		f32 tNear = core::min_(t0, t1);
+		f32 tFar = core::max_(t0, t1);
+
+		t0 = (box.MinEdge.Y - start.Y) * invVector.Y;
+		t1 = (box.MaxEdge.Y - start.Y) * invVector.Y;
+		tNear = core::max_(tNear, core::min_(t0, t1));
+		tFar = core::min_(tFar, core::max_(t0, t1));
+
+		t0 = (box.MinEdge.Z - start.Z) * invVector.Z;
+		t1 = (box.MaxEdge.Z - start.Z) * invVector.Z;
+		tNear = core::max_(tNear, core::min_(t0, t1));
+		tFar = core::min_(tFar, core::max_(t0, t1));
+
+		outT = tNear;
+		return tNear <= tFar && tNear <= maxT && tFar >= -BVH_TOLERANCE;
+	}
+
+	//! writes the visited triangles into an array until it is full
+	struct SArrayCallback : public ITriangleCallback
+	{
+		virtual bool onTriangle(const core::triangle3df& triangle, const SCollisionTriangleRange& info) _IRR_OVERRIDE_
+		{
+			Triangles[Written++] = triangle;
+			return Written < Size;
+		}
+
+		core::triangle3df* Triangles;
+		s32 Size;
+		s32 Written;
+	};
+}
+
+
+//! constructor
+CBVHTriangleSelector::CBVHTriangleSelector(const IMesh* mesh,
+		ISceneNode* node, s32 maximalPolysPerLeaf)
+	: CTriangleSelector(mesh, node, false)
+	, MaximalPolysPerLeaf(core::max_(maximalPolysPerLeaf, 1))
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	build();
+}
+
+
+CBVHTriangleSelector::CBVHTriangleSelector(const IMeshBuffer* meshBuffer, irr::u32 materialIndex,
+		ISceneNode* node, s32 maximalPolysPerLeaf)
+	: CTriangleSelector(meshBuffer, materialIndex, node)
+	, MaximalPolysPerLeaf(core::max_(maximalPolysPerLeaf, 1))
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	build();
+}
+
+
+void CBVHTriangleSelector::build()
+{
+	if (Triangles.empty())
+		return;
+
+	const u32 start = os::Timer::getRealTime();
+
+	core::array<core::vector3df> centers(Triangles.size());
+	for (u32 i=0; i<Triangles.size(); ++i)
+	{
+		const core::triangle3df& tri = Triangles[i];
+		centers.push_back((tri.pointA + tri.pointB + tri.pointC) / 3.f);
+	}
+
+	Nodes.reallocate(2 * Triangles.size() / MaximalPolysPerLeaf + 1);
+	buildNode(centers, 0, Triangles.size(), 0);
+	Nodes.reallocate(Nodes.size(), true);
+
+	c8 tmp[256];
+	sprintf(tmp, "Needed %ums to create BVHTriangleSelector.(%u nodes, %u polys)",
+		os::Timer::getRealTime() - start, Nodes.size(), Triangles.size());
+	os::Printer::log(tmp, ELL_INFORMATION);
+}
+
+
+u32 CBVHTriangleSelector::buildNode(core::array<core::vector3df>& centers,
+		u32 start, u32 count, u32 depth)
+{
+	const u32 index = Nodes.size();
+	Nodes.push_back(SNode());
+
+	const u32 end = start + count;
+	core::aabbox3df box(Triangles[start].pointA);
+	core::aabbox3df centerBox(centers[start]);
+	for (u32 i=start; i<end; ++i)
+	{
+		box.addInternalPoint(Triangles[i].pointA);
+		box.addInternalPoint(Triangles[i].pointB);
+		box.addInternalPoint(Triangles[i].pointC);
+		centerBox.addInternalPoint(centers[i]);
+	}
+
+	// a little larger, so lines along its faces still touch it when they
+	// are transformed into the space of the triangles
+	const f32 size = core::max_(box.MinEdge.getLength(), box.MaxEdge.getLength(), 1.f);
+	Nodes[index].Box.MinEdge = box.MinEdge - core::vector3df(size * BVH_TOLERANCE);
+	Nodes[index].Box.MaxEdge = box.MaxEdge + core::vector3df(size * BVH_TOLERANCE);
+	Nodes[index].Start = start;
+	Nodes[index].Count = count;
+
+	if ((s32)count <= MaximalPolysPerLeaf || depth >= BVH_MAX_DEPTH)
+		return index;
+
+	// find the cheapest split by the surface area heuristic, a split
+	// has to be cheaper than testing all triangles of the node
+	const f32 area = box.getArea();
+	f32 bestCost = count * area;
+	s32 bestAxis = -1;
+	u32 bestBin = 0;
+	f32 bestMin = 0.f;
+	f32 bestScale = 0.f;
+
+	u32 binCount[BVH_BINS];
+	core::aabbox3df binBox[BVH_BINS];
+	u32 rightCount[BVH_BINS];
+	f32 rightArea[BVH_BINS];
+
+	for (u32 axis=0; axis<3; ++axis)
+	{
+		const f32 axisMin = getAxis(centerBox.MinEdge, axis);
+		const f32 axisExtent = getAxis(centerBox.MaxEdge, axis) - axisMin;
+		if (axisExtent <= 0.f)
+			continue;
+		const f32 scale = BVH_BINS * 0.9999f / axisExtent;
+
+		u32 b;
+		for (b=0; b<BVH_BINS; ++b)
+			binCount[b] = 0;
+
+		for (u32 i=start; i<end; ++i)
+		{
+			b = core::min_((u32)((getAxis(centers[i], axis) - axisMin) * scale), BVH_BINS - 1);
+			if (!binCount[b])
+				binBox[b].reset(Triangles[i].pointA);
+			else
+				binBox[b].addInternalPoint(Triangles[i].pointA);
+			binBox[b].addInternalPoint(Triangles[i].pointB);
+			binBox[b].addInternalPoint(Triangles[i].pointC);
+			++binCount[b];
+		}
+
+		// triangles and area right of each bin border
+		core::aabbox3df side;
+		u32 n = 0;
+		for (b=BVH_BINS-1; b>0; --b)
+		{
+			if (binCount[b])
+			{
+				if (!n)
+					side = binBox[b];
+				else
+					side.addInternalBox(binBox[b]);
+				n += binCount[b];
+			}
+			rightCount[b] = n;
+			rightArea[b] = n ? side.getArea() : 0.f;
+		}
+
+		// split at each border, left of it are the bins before b
+		n = 0;
+		for (b=1; b<BVH_BINS; ++b)
+		{
+			if (binCount[b-1])
+			{
+				if (!n)
+					side = binBox[b-1];
+				else
+					side.addInternalBox(binBox[b-1]);
+				n += binCount[b-1];
+			}
+			if (!n || !rightCount[b])
+				continue;
+
+			const f32 cost = BVH_TRAVERSAL_COST * area + n * side.getArea() + rightCount[b] * rightArea[b];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = b;
+				bestMin = axisMin;
+				bestScale = scale;
+			}
+		}
+	}
+
+	if (bestAxis < 0)
+		return index;
+
+	// sort the triangles left of the split to the front
+	u32 i = start;
+	u32 j = end;
+	while (i < j)
+	{
+		const u32 b = core::min_((u32)((getAxis(centers[i], bestAxis) - bestMin) * bestScale), BVH_BINS - 1);
+		if (b < bestBin)
+			++i;
+		else
+		{
+			--j;
+			core::swap(Triangles[i], Triangles[j]);
+			core::swap(centers[i], centers[j]);
+		}
+	}
+
+	buildNode(centers, start, i - start, depth + 1);
+	const u32 second = buildNode(centers, i, end - i, depth + 1);
+
+	Nodes[index].Start = second;
+	Nodes[index].Count = 0;
+	return index;
+}
+
+
+void CBVHTriangleSelector::getTransformation(STransformation& transformation) const
+{
+	if (SceneNode)
+	{
+		transformation.World = SceneNode->getAbsoluteTransformation();
+		transformation.Identity = transformation.World.isIdentity();
+		transformation.Invertible = transformation.World.getInverse(transformation.Inverse);
+	}
+	else
+	{
+		transformation.World.makeIdentity();
+		transformation.Inverse.makeIdentity();
+		transformation.Identity = true;
+		transformation.Invertible = true;
+	}
+}
+
+
+bool CBVHTriangleSelector::findHit(const core::line3d<f32>& line,
+		const STransformation& transformation, bool anyHit,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle) const
+{
+	if (Nodes.empty())
+		return false;
+
+	// triangles are tested like in CSceneCollisionManager::getCollisionPoint
+	const core::vector3df linevect = line.getVector().normalize();
+	const f32 raylength = line.getLengthSQ();
+	core::aabbox3df lineBox(line.start);
+	lineBox.addInternalPoint(line.end);
+
+	// the line in the space of the triangles, a fraction of the line
+	// is the same there as in world space
+	core::vector3df start(line.start);
+	core::vector3df end(line.end);
+	if (!transformation.Identity)
+	{
+		transformation.Inverse.transformVect(start, line.start);
+		transformation.Inverse.transformVect(end, line.end);
+	}
+	const core::vector3df vector = end - start;
+	const core::vector3df invVector(getInverse(vector.X), getInverse(vector.Y), getInverse(vector.Z));
+
+	// without an inverse transformation, all nodes are visited
+	const bool useBoxes = transformation.Invertible;
+
+	f32 maxT = 1.f + BVH_TOLERANCE;
+	f32 nearest = FLT_MAX;
+	bool found = false;
+
+	u32 stack[BVH_STACK_SIZE];
+	f32 stackT[BVH_STACK_SIZE];
+	u32 top = 0;
+	u32 index = 0;
+	f32 t0, t1;
+
+	if (useBoxes && !intersectsLine(Nodes[0].Box, start, invVector, maxT, t0))
+		return false;
+
+	core::triangle3df triangle;
+	core::vector3df intersection;
+
+	for (;;)
+	{
+		const SNode& node = Nodes[index];
+		if (node.Count)
+		{
+			const u32 last = node.Start + node.Count;
+			for (u32 i=node.Start; i<last; ++i)
+			{
+				if (transformation.Identity)
+					triangle = Triangles[i];
+				else
+				{
+					transformation.World.transformVect(triangle.pointA, Triangles[i].pointA);
+					transformation.World.transformVect(triangle.pointB, Triangles[i].pointB);
+					transformation.World.transformVect(triangle.pointC, Triangles[i].pointC);
+				}
+
+				if (triangle.isTotalOutsideBox(lineBox))
+					continue;
+
+				if (triangle.getIntersectionWithLine(line.start, linevect, intersection))
+				{
+					const f32 tmp = intersection.getDistanceFromSQ(line.start);
+					const f32 tmp2 = intersection.getDistanceFromSQ(line.end);
+
+					if (tmp < raylength && tmp2 < raylength && tmp < nearest)
+					{
+						nearest = tmp;
+						outTriangle = triangle;
+						outIntersection = intersection;
+						found = true;
+
+						if (anyHit)
+							return true;
+
+						// boxes behind the hit can't contain a nearer one
+						maxT = sqrtf(nearest / raylength) * (1.f + BVH_TOLERANCE) + BVH_TOLERANCE;
+					}
+				}
+			}
+		}
+		else if (useBoxes)
+		{
+			const bool hit0 = intersectsLine(Nodes[index+1].Box, start, invVector, maxT, t0);
+			const bool hit1 = intersectsLine(Nodes[node.Start].Box, start, invVector, maxT, t1);
+
+			// nearer child first
+			if (hit0 && hit1)
+			{
+				if (t1 < t0)
+				{
+					stack[top] = index + 1;
+					stackT[top++] = t0;
+					index = node.Start;
+				}
+				else
+				{
+					stack[top] = node.Start;
+					stackT[top++] = t1;
+					++index;
+				}
+				continue;
+			}
+			if (hit0)
+			{
+				++index;
+				continue;
+			}
+			if (hit1)
+			{
+				index = node.Start;
+				continue;
+			}
+		}
+		else
+		{
+			stack[top] = node.Start;
+			stackT[top++] = 0.f;
+			++index;
+			continue;
+		}
+
+		// next node, unless it's behind the nearest hit found meanwhile
+		do
+		{
+			if (!top)
+				return found;
+			--top;
+		} while (stackT[top] > maxT);
+		index = stack[top];
+	}
+}
+
+
+//! Finds the triangle which a line hits first.
+bool CBVHTriangleSelector::getCollisionPoint(const core::line3d<f32>& line,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle,
+		SCollisionTriangleRange* outTriangleInfo) const
+{
+	STransformation transformation;
+	getTransformation(transformation);
+
+	if (!findHit(line, transformation, false, outIntersection, outTriangle))
+		return false;
+
+	if (outTriangleInfo)
+	{
+		outTriangleInfo->RangeStart = 0;
+		outTriangleInfo->RangeSize = 1;
+		outTriangleInfo->Selector = const_cast<CBVHTriangleSelector*>(this);
+		outTriangleInfo->SceneNode = SceneNode;
+		outTriangleInfo->MeshBuffer = MeshBuffer;
+		outTriangleInfo->MaterialIndex = MaterialIndex;
+	}
+	return true;
+}
+
+
+//! checks bands of the lines of a getLineHits call
+struct CBVHTriangleSelector::SLineHitsJob : public IThreadJob
+{
+	virtual void runPart(u32 part, u32 thread) _IRR_OVERRIDE_
+	{
+		const u32 start = part * LINE_HITS_BAND;
+		const u32 end = core::min_(LineCount, start + LINE_HITS_BAND);
+
+		core::vector3df intersection;
+		core::triangle3df triangle;
+		u32 hits = 0;
+		for (u32 i=start; i<end; ++i)
+		{
+			Hits[i] = Selector->findHit(Lines[i], Transformation, true, intersection, triangle);
+			if (Hits[i])
+				++hits;
+		}
+		PartHits[part] = hits;
+	}
+
+	const CBVHTriangleSelector* Selector;
+	STransformation Transformation;
+	const core::line3d<f32>* Lines;
+	u32 LineCount;
+	bool* Hits;
+	core::array<u32> PartHits;
+};
+
+
+//! Checks for many lines at once whether they hit a triangle.
+u32 CBVHTriangleSelector::getLineHits(const core::line3d<f32>* lines, u32 lineCount,
+		bool* outHits) const
+{
+	if (!lineCount)
+		return 0;
+
+	SLineHitsJob job;
+	job.Selector = this;
+	getTransformation(job.Transformation);
+	job.Lines = lines;
+	job.LineCount = lineCount;
+	job.Hits = outHits;
+
+	const u32 parts = (lineCount + LINE_HITS_BAND - 1) / LINE_HITS_BAND;
+	job.PartHits.set_used(parts);
+	CThreadPool::runShared(&job, parts);
+
+	u32 hits = 0;
+	for (u32 i=0; i<parts; ++i)
+		hits += job.PartHits[i];
+	return hits;
+}
+
+
+//! Passes the triangles which may lie within a box to a callback.
+bool CBVHTriangleSelector::visitTriangles(ITriangleCallback& callback,
+		const core::aabbox3d<f32>& box, const core::matrix4* transform,
+		bool useNodeTransform) const
+{
+	core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+	core::aabbox3d<f32> invbox = box;
+
+	// without an inverse transformation, all triangles are passed
+	bool useBoxes = true;
+	if (SceneNode && useNodeTransform)
+	{
+		if ( SceneNode->getAbsoluteTransformation().getInverse(mat) )
+			mat.transformBoxEx(invbox);
+		else
+			useBoxes = false;
+	}
+
+	if (transform)
+		mat = *transform;
+	else
+		mat.makeIdentity();
+
+	if (SceneNode && useNodeTransform)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	if (Nodes.empty() || (useBoxes && !invbox.intersectsWithBox(Nodes[0].Box)))
+		return true;
+
+	SCollisionTriangleRange info;
+	info.Selector = const_cast<CBVHTriangleSelector*>(this);
+	info.SceneNode = SceneNode;
+	info.MeshBuffer = MeshBuffer;
+	info.MaterialIndex = MaterialIndex;
+
+	u32 stack[BVH_STACK_SIZE];
+	u32 top = 0;
+	u32 index = 0;
+	core::triangle3df triangle;
+
+	for (;;)
+	{
+		const SNode& node = Nodes[index];
+		if (node.Count)
+		{
+			const u32 last = node.Start + node.Count;
+			for (u32 i=node.Start; i<last; ++i)
+			{
+				const core::triangle3df& srcTri = Triangles[i];
+				// This isn't an accurate test, but it's fast, and the
+				// API contract doesn't guarantee complete accuracy.
+				if (useBoxes && srcTri.isTotalOutsideBox(invbox))
+					continue;
+
+				mat.transformVect(triangle.pointA, srcTri.pointA);
+				mat.transformVect(triangle.pointB, srcTri.pointB);
+				mat.transformVect(triangle.pointC, srcTri.pointC);
+
+				if (!callback.onTriangle(triangle, info))
+					return false;
+			}
+		}
+		else
+		{
+			const bool hit0 = !useBoxes || invbox.intersectsWithBox(Nodes[index+1].Box);
+			const bool hit1 = !useBoxes || invbox.intersectsWithBox(Nodes[node.Start].Box);
+			if (hit0)
+			{
+				if (hit1)
+					stack[top++] = node.Start;
+				++index;
+				continue;
+			}
+			if (hit1)
+			{
+				index = node.Start;
+				continue;
+			}
+		}
+
+		if (!top)
+			return true;
+		index = stack[--top];
+	}
+}
+
+
+//! Gets all triangles which lie within a specific bounding box.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles,
+					s32 arraySize, s32& outTriangleCount,
+					const core::aabbox3d<f32>& box,
+					const core::matrix4* transform, bool useNodeTransform,
+					irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const
+{
+	SArrayCallback callback;
+	callback.Triangles = triangles;
+	callback.Size = arraySize;
+	callback.Written = 0;
+
+	if (arraySize > 0)
+		visitTriangles(callback, box, transform, useNodeTransform);
+
+	if ( outTriangleInfo )
+	{
+		SCollisionTriangleRange triRange;
+		triRange.RangeSize = callback.Written;
+		triRange.Selector = const_cast<CBVHTriangleSelector*>(this);
+		triRange.SceneNode = SceneNode;
+		triRange.MeshBuffer = MeshBuffer;
+		triRange.MaterialIndex = MaterialIndex;
+		outTriangleInfo->push_back(triRange);
+	}
+
+	outTriangleCount = callback.Written;
+}
+
+
+//! Gets all triangles which have or may have contact with a 3d line.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const core::line3d<f32>& line,
+		const core::matrix4* transform, bool useNodeTransform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const
+{
+	core::matrix4 mat ( core::matrix4::EM4CONST_NOTHING );
+
+	core::vector3df vectStartInv ( line.start ), vectEndInv ( line.end );
+	if (SceneNode && useNodeTransform)
+	{
+		if ( !SceneNode->getAbsoluteTransformation().getInverse(mat) )
+			// TODO: case not handled well, we can only return all triangles
+			return CTriangleSelector::getTriangles(triangles, arraySize, outTriangleCount, transform, useNodeTransform, outTriangleInfo);
+		mat.transformVect(vectStartInv, line.start);
+		mat.transformVect(vectEndInv, line.end);
+	}
+	core::line3d<f32> invline(vectStartInv, vectEndInv);
+
+	mat.makeIdentity();
+
+	if (transform)
+		mat = (*transform);
+
+	if (SceneNode && useNodeTransform)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	s32 trianglesWritten = 0;
+
+	if (!Nodes.empty() && arraySize > 0)
+		getTrianglesFromBVH(invline, trianglesWritten, arraySize, mat, triangles);
+
+	if ( outTriangleInfo )
+	{
+		SCollisionTriangleRange triRange;
+		triRange.RangeSize = trianglesWritten;
+		triRange.Selector = const_cast<CBVHTriangleSelector*>(this);
+		triRange.SceneNode = SceneNode;
+		triRange.MeshBuffer = MeshBuffer;
+		triRange.MaterialIndex = MaterialIndex;
+		outTriangleInfo->push_back(triRange);
+	}
+
+	outTriangleCount = trianglesWritten;
+}
+
+
+void CBVHTriangleSelector::getTrianglesFromBVH(const core::line3d<f32>& line,
+		s32& trianglesWritten, s32 maximumSize, const core::matrix4& transform,
+		core::triangle3df* triangles) const
+{
+	const core::vector3df vector = line.getVector();
+	const core::vector3df invVector(getInverse(vector.X), getInverse(vector.Y), getInverse(vector.Z));
+	const f32 maxT = 1.f + BVH_TOLERANCE;
+	const bool identity = transform.isIdentity();
+
+	u32 stack[BVH_STACK_SIZE];
+	u32 top = 0;
+	u32 index = 0;
+	f32 t;
+
+	if (!intersectsLine(Nodes[0].Box, line.start, invVector, maxT, t))
+		return;
+
+	for (;;)
+	{
+		const SNode& node = Nodes[index];
+		if (node.Count)
+		{
+			const u32 last = node.Start + node.Count;
+			for (u32 i=node.Start; i<last; ++i)
+			{
+				core::triangle3df& dstTri = triangles[trianglesWritten];
+				if (identity)
+					dstTri = Triangles[i];
+				else
+				{
+					transform.transformVect(dstTri.pointA, Triangles[i].pointA);
+					transform.transformVect(dstTri.pointB, Triangles[i].pointB);
+					transform.transformVect(dstTri.pointC, Triangles[i].pointC);
+				}
+
+				// Halt when the out array is full.
+				if (++trianglesWritten == maximumSize)
+					return;
+			}
+		}
+		else
+		{
+			const bool hit0 = intersectsLine(Nodes[index+1].Box, line.start, invVector, maxT, t);
+			const bool hit1 = intersectsLine(Nodes[node.Start].Box, line.start, invVector, maxT, t);
+			if (hit0)
+			{
+				if (hit1)
+					stack[top++] = node.Start;
+				++index;
+				continue;
+			}
+			if (hit1)
+			{
+				index = node.Start;
+				continue;
+			}
+		}
+
+		if (!top)
+			return;
+		index = stack[--top];
+	}
+}
+
+
+} // end namespace scene
+} // end namespace irr
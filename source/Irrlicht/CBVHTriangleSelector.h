@@ -0,0 +1,108 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BVH_TRIANGLE_SELECTOR_H_INCLUDED__
+#define __C_BVH_TRIANGLE_SELECTOR_H_INCLUDED__
+
+#include "CTriangleSelector.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class ISceneNode;
+
+//! Triangle selector optimized by a bounding volume hierarchy
+/** The triangles are sorted in place so each leaf of the hierarchy owns
+a range of them. The nodes are stored depth first in a single array. */
+class CBVHTriangleSelector : public CTriangleSelector
+{
+public:
+
+	//! Constructs a selector based on a mesh
+	CBVHTriangleSelector(const IMesh* mesh, ISceneNode* node, s32 maximalPolysPerLeaf);
+
+	//! Constructs a selector based on a meshbuffer
+	CBVHTriangleSelector(const IMeshBuffer* meshBuffer, irr::u32 materialIndex, ISceneNode* node, s32 maximalPolysPerLeaf);
+
+	//! Gets all triangles which lie within a specific bounding box.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize, s32& outTriangleCount,
+		const core::aabbox3d<f32>& box, const core::matrix4* transform, bool useNodeTransform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const _IRR_OVERRIDE_;
+
+	//! Gets all triangles which have or may have contact with a 3d line.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const core::line3d<f32>& line,
+		const core::matrix4* transform, bool useNodeTransform,
+		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const _IRR_OVERRIDE_;
+
+	//! Check if the selector finds triangles by traversing a hierarchy.
+	virtual bool hasHierarchy() const _IRR_OVERRIDE_ { return true; }
+
+	//! Finds the triangle which a line hits first.
+	virtual bool getCollisionPoint(const core::line3d<f32>& line,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle,
+		SCollisionTriangleRange* outTriangleInfo) const _IRR_OVERRIDE_;
+
+	//! Checks for many lines at once whether they hit a triangle.
+	virtual u32 getLineHits(const core::line3d<f32>* lines, u32 lineCount,
+		bool* outHits) const _IRR_OVERRIDE_;
+
+	//! Passes the triangles which may lie within a box to a callback.
+	virtual bool visitTriangles(ITriangleCallback& callback,
+		const core::aabbox3d<f32>& box, const core::matrix4* transform,
+		bool useNodeTransform) const _IRR_OVERRIDE_;
+
+private:
+
+	//! Node of the hierarchy
+	/** The first child of an inner node directly follows it, Start is the
+	index of the second child. For a leaf, Start is the index of its first
+	triangle. */
+	struct SNode
+	{
+		core::aabbox3df Box;
+		u32 Start;
+		u32 Count; // number of triangles, 0 for inner nodes
+	};
+
+	//! Transformation between the space of the triangles and world space
+	struct STransformation
+	{
+		core::matrix4 World;
+		core::matrix4 Inverse;
+		bool Identity;
+		bool Invertible;
+	};
+
+	struct SLineHitsJob;
+
+	//! Creates the hierarchy and sorts the triangles into it
+	void build();
+
+	//! Creates the node for a range of triangles and returns its index
+	u32 buildNode(core::array<core::vector3df>& centers, u32 start, u32 count, u32 depth);
+
+	//! Gets the transformation to world space of the node of this selector
+	void getTransformation(STransformation& transformation) const;
+
+	//! Finds the triangle hit first by a line in world space, or any hit triangle
+	bool findHit(const core::line3d<f32>& line, const STransformation& transformation,
+		bool anyHit, core::vector3df& outIntersection, core::triangle3df& outTriangle) const;
+
+	//! Gets the triangles of all nodes which a line in the space of the triangles touches
+	void getTrianglesFromBVH(const core::line3d<f32>& line, s32& trianglesWritten,
+		s32 maximumSize, const core::matrix4& transform,
+		core::triangle3df* triangles) const;
+
+	core::array<SNode> Nodes;
+	s32 MaximalPolysPerLeaf;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
@@ -6,6 +6,12 @@
 #define _C_BLIT_H_INCLUDED_
 
 #include "SoftwareDriver2_helper.h"
+#include "CColorConverter.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+#endif
 
 namespace irr
 {
@@ -33,7 +39,10 @@ namespace irr
 		float x_stretch;
 		float y_stretch;
 
-		SBlitJob() : stretch(false) {}
+		// the cpu supports the SSE2 versions of the blitters
+		bool useSSE2;
+
+		SBlitJob() : stretch(false), useSSE2(false) {}
 	};
 
 	// Bitfields Cohen Sutherland
@@ -205,6 +214,290 @@ inline u32 PixelLerp32(const u32 source, const u32 value)
 	return srcRB | srcXG;
 }
 
+/*!
+	Pixel = c0 * ( 1 - f ) + c1 * f, all four channels
+	f [0;256]
+*/
+inline u32 PixelLerp32_4(const u32 c0, const u32 c1, const u32 f)
+{
+	const u32 rb = ( ( c0 & 0x00FF00FF ) * ( 256 - f ) + ( c1 & 0x00FF00FF ) * f ) >> 8;
+	const u32 ag = ( ( c0 >> 8 ) & 0x00FF00FF ) * ( 256 - f ) + ( ( c1 >> 8 ) & 0x00FF00FF ) * f;
+
+	return ( rb & 0x00FF00FF ) | ( ag & 0xFF00FF00 );
+}
+
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+/*
+	SSE2 versions of the per pixel blitters. They work on blocks of 4 or 8
+	pixels and return how many they did, the scalar loops do the rest. The
+	results have the same bits as the scalar code. They are used if
+	SBlitJob::useSSE2 is set.
+*/
+
+/*
+	channel wise ( d * ( 256 - a ) + s * a ) >> 8 of four pixels, which is
+	what PixelBlend32 computes in two channels at once. a [0;256] is repeated
+	in both 16 bit halves of the lane of its pixel.
+*/
+static inline __m128i blitLerp32_SSE2(const __m128i d, const __m128i s, const __m128i a)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(256);
+	const __m128i aLo = _mm_unpacklo_epi32(a, a);
+	const __m128i aHi = _mm_unpackhi_epi32(a, a);
+
+	const __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(one, aLo)),
+		_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), aLo));
+	const __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(one, aHi)),
+		_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), aHi));
+
+	return _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+}
+
+//! extractAlpha of four pixels, repeated in both 16 bit halves
+static inline __m128i blitAlpha_SSE2(const __m128i c)
+{
+	const __m128i a = _mm_srli_epi32(c, 24);
+	const __m128i a256 = _mm_add_epi32(a, _mm_srli_epi32(a, 7));
+	return _mm_or_si128(a256, _mm_slli_epi32(a256, 16));
+}
+
+//! d where s is fully transparent, else b
+static inline __m128i blitKeepTransparent_SSE2(const __m128i d, const __m128i s, const __m128i b)
+{
+	const __m128i keep = _mm_cmpeq_epi32(_mm_and_si128(s, _mm_set1_epi32(0xFF000000)), _mm_setzero_si128());
+	return _mm_or_si128(_mm_and_si128(keep, d), _mm_andnot_si128(keep, b));
+}
+
+//! PixelBlend32 of four pixels
+static inline __m128i blitBlend32_SSE2(const __m128i d, const __m128i s)
+{
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	const __m128i c = blitLerp32_SSE2(d, s, blitAlpha_SSE2(s));
+	return blitKeepTransparent_SSE2(d, s, _mm_or_si128(_mm_andnot_si128(alphaMask, c), _mm_and_si128(s, alphaMask)));
+}
+
+//! PixelCombine32 of four pixels
+static inline __m128i blitCombine32_SSE2(const __m128i d, const __m128i s)
+{
+	const __m128i a = blitAlpha_SSE2(s);
+	const __m128i c = blitLerp32_SSE2(d, s, a);
+
+	// alpha = sa + ( da * ( 256 - a ) ) >> 8, the product fits in 16 bit
+	const __m128i inv = _mm_sub_epi32(_mm_set1_epi32(256), _mm_srli_epi32(a, 16));
+	const __m128i alpha = _mm_add_epi32(_mm_srli_epi32(s, 24),
+		_mm_srli_epi32(_mm_mullo_epi16(_mm_srli_epi32(d, 24), inv), 8));
+
+	return blitKeepTransparent_SSE2(d, s,
+		_mm_or_si128(_mm_and_si128(c, _mm_set1_epi32(0x00FFFFFF)), _mm_slli_epi32(alpha, 24)));
+}
+
+//! the channels of a color unpacked to 16 bit, twice
+static inline __m128i blitUnpackColor_SSE2(const u32 color)
+{
+	return _mm_unpacklo_epi8(_mm_set1_epi32(color), _mm_setzero_si128());
+}
+
+//! PixelMul32_2 of four pixels with an unpacked color
+static inline __m128i blitMul32_SSE2(const __m128i s, const __m128i color)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), color), 8);
+	const __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), color), 8);
+	return _mm_packus_epi16(lo, hi);
+}
+
+//! A8R8G8B8toA1R5G5B5 of four pixels, in the lower 16 bit of the lanes
+static inline __m128i blitToA1R5G5B5_SSE2(const __m128i c)
+{
+	const __m128i a = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x80000000)), 16);
+	const __m128i r = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00F80000)), 9);
+	const __m128i g = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0000F800)), 6);
+	const __m128i b = _mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x000000F8)), 3);
+	return _mm_or_si128(_mm_or_si128(a, r), _mm_or_si128(g, b));
+}
+
+//! packs the lower 16 bit of the lanes of two vectors
+static inline __m128i blitPack32to16_SSE2(const __m128i a, const __m128i b)
+{
+	// sign extension keeps the signed saturation of packs from changing the bits
+	return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+		_mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+}
+
+//! PixelBlend32 of four source pixels into dst
+static inline void blitTextureBlend32Block_SSE2(const __m128i s, u32* dst)
+{
+	// fully opaque or transparent blocks are common in gui images
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	const __m128i a = _mm_and_si128(s, alphaMask);
+	if (0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi32(a, alphaMask)))
+		_mm_storeu_si128((__m128i*)dst, s);
+	else if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi32(a, _mm_setzero_si128())))
+		_mm_storeu_si128((__m128i*)dst, blitBlend32_SSE2(_mm_loadu_si128((const __m128i*)dst), s));
+}
+
+//! dst = PixelBlend32 ( dst, src )
+static u32 blitTextureBlend32_SSE2(const u32* src, u32* dst, const u32 count)
+{
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4)
+		blitTextureBlend32Block_SSE2(_mm_loadu_si128((const __m128i*)(src + i)), dst + i);
+	return i;
+}
+
+//! dst = PixelBlend32 ( dst, src[(u32)(dx*wscale)] )
+static u32 blitTextureBlend32Stretch_SSE2(const u32* src, u32* dst, const u32 count, const float wscale)
+{
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i s = _mm_set_epi32(src[(u32)((i+3)*wscale)], src[(u32)((i+2)*wscale)],
+			src[(u32)((i+1)*wscale)], src[(u32)(i*wscale)]);
+		blitTextureBlend32Block_SSE2(s, dst + i);
+	}
+	return i;
+}
+
+//! dst = PixelBlend32 ( dst, PixelMul32_2 ( src, argb ) )
+static u32 blitTextureBlendColor32_SSE2(const u32* src, u32* dst, const u32 count, const u32 argb)
+{
+	const __m128i color = blitUnpackColor_SSE2(argb);
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i s = blitMul32_SSE2(_mm_loadu_si128((const __m128i*)(src + i)), color);
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		_mm_storeu_si128((__m128i*)(dst + i), blitBlend32_SSE2(d, s));
+	}
+	return i;
+}
+
+//! dst = PixelCombine32 ( dst, PixelMul32_2 ( src, argb ) )
+static u32 blitTextureCombineColor32_SSE2(const u32* src, u32* dst, const u32 count, const u32 argb)
+{
+	const __m128i color = blitUnpackColor_SSE2(argb);
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i s = blitMul32_SSE2(_mm_loadu_si128((const __m128i*)(src + i)), color);
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		_mm_storeu_si128((__m128i*)(dst + i), blitCombine32_SSE2(d, s));
+	}
+	return i;
+}
+
+//! dst = ( argb & 0xFF000000 ) | PixelBlend32 ( dst, argb, extractAlpha ( argb ) )
+static u32 blitColorAlpha32_SSE2(u32* dst, const u32 count, const u32 argb)
+{
+	const __m128i s = _mm_set1_epi32(argb);
+	const __m128i a = blitAlpha_SSE2(s);
+	const __m128i alpha = _mm_set1_epi32(argb & 0xFF000000);
+	const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i c = blitLerp32_SSE2(_mm_loadu_si128((const __m128i*)(dst + i)), s, a);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(c, colorMask), alpha));
+	}
+	return i;
+}
+
+//! dst = A8R8G8B8toA1R5G5B5 of the pre-multiplied src
+static u32 blitTextureCopy32to16_SSE2(const u32* src, u16* dst, const u32 count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	u32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i s0 = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i s1 = _mm_loadu_si128((const __m128i*)(src + i + 4));
+		const __m128i p0 = blitLerp32_SSE2(zero, _mm_or_si128(s0, alphaMask), blitAlpha_SSE2(s0));
+		const __m128i p1 = blitLerp32_SSE2(zero, _mm_or_si128(s1, alphaMask), blitAlpha_SSE2(s1));
+		_mm_storeu_si128((__m128i*)(dst + i), blitPack32to16_SSE2(blitToA1R5G5B5_SSE2(p0), blitToA1R5G5B5_SSE2(p1)));
+	}
+	return i;
+}
+
+//! dst = PixelBlend16 ( dst, src )
+static u32 blitTextureBlend16_SSE2(const u16* src, u16* dst, const u32 count)
+{
+	const __m128i color = _mm_set1_epi16(0x7FFF);
+	u32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		const __m128i mask = _mm_add_epi16(_mm_srli_epi16(s, 15), color);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(d, mask), _mm_andnot_si128(mask, s)));
+	}
+	return i;
+}
+
+//! dst = PixelMul16_2 ( src, color ) where src has alpha
+static u32 blitTextureBlendColor16_SSE2(const u16* src, u16* dst, const u32 count, const u16 color)
+{
+	const __m128i mask = _mm_set1_epi16(0x1F);
+	const __m128i r = _mm_set1_epi16((color >> 10) & 0x1F);
+	const __m128i g = _mm_set1_epi16((color >> 5) & 0x1F);
+	const __m128i b = _mm_set1_epi16(color & 0x1F);
+	const __m128i a = _mm_set1_epi16((s16)(color & 0x8000));
+	u32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		const __m128i sr = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(s, 10), mask), r), 5);
+		const __m128i sg = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(s, 5), mask), g), 5);
+		const __m128i sb = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(s, mask), b), 5);
+		const __m128i c = _mm_or_si128(_mm_or_si128(_mm_and_si128(s, a), _mm_slli_epi16(sr, 10)),
+			_mm_or_si128(_mm_slli_epi16(sg, 5), sb));
+		const __m128i visible = _mm_srai_epi16(s, 15);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(visible, c), _mm_andnot_si128(visible, d)));
+	}
+	return i;
+}
+
+//! dst = 0x8000 | PixelBlend16 ( dst, color, alpha ), alpha [0;32]
+static u32 blitColorAlpha16_SSE2(u16* dst, const u32 count, const u16 color, const u16 alpha)
+{
+	// channel wise ( d * ( 32 - alpha ) + s * alpha ) >> 5, as PixelBlend16 computes it
+	const __m128i mask = _mm_set1_epi16(0x1F);
+	const __m128i inv = _mm_set1_epi16(32 - alpha);
+	const __m128i r = _mm_set1_epi16(((color >> 10) & 0x1F) * alpha);
+	const __m128i g = _mm_set1_epi16(((color >> 5) & 0x1F) * alpha);
+	const __m128i b = _mm_set1_epi16((color & 0x1F) * alpha);
+	const __m128i a = _mm_set1_epi16((s16)0x8000);
+	u32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		const __m128i dr = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(d, 10), mask), inv), r), 5);
+		const __m128i dg = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(d, 5), mask), inv), g), 5);
+		const __m128i db = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(d, mask), inv), b), 5);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_or_si128(a, _mm_slli_epi16(dr, 10)),
+			_mm_or_si128(_mm_slli_epi16(dg, 5), db)));
+	}
+	return i;
+}
+
+//! dst = PixelLerp32_4 ( src0, src1, f )
+static u32 blitLerpRows32_SSE2(const u32* src0, const u32* src1, u32* dst, const u32 count, const u32 f)
+{
+	const __m128i a = _mm_set1_epi32(f | f << 16);
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i s0 = _mm_loadu_si128((const __m128i*)(src0 + i));
+		const __m128i s1 = _mm_loadu_si128((const __m128i*)(src1 + i));
+		_mm_storeu_si128((__m128i*)(dst + i), blitLerp32_SSE2(s0, s1, a));
+	}
+	return i;
+}
+#endif
+
 
 /*
 */
@@ -538,7 +831,12 @@ static void executeBlit_TextureCopy_32_to_16( const SBlitJob * job )
 	{
 		for ( u32 dy = 0; dy != h; ++dy )
 		{
-			for ( u32 dx = 0; dx != w; ++dx )
+			u32 dx = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			if ( job->useSSE2 )
+				dx = blitTextureCopy32to16_SSE2( src, dst, w );
+#endif
+			for ( ; dx != w; ++dx )
 			{
 				//16 bit Blitter depends on pre-multiplied color
 				const u32 s = PixelLerp32( src[dx] | 0xFF000000, extractAlpha( src[dx] ) );
@@ -627,10 +925,7 @@ static void executeBlit_TextureCopy_16_to_32( const SBlitJob * job )
 	{
 		for ( u32 dy = 0; dy != h; ++dy )
 		{
-			for ( u32 dx = 0; dx != w; ++dx )
-			{
-				dst[dx] = video::A1R5G5B5toA8R8G8B8( src[dx] );
-			}
+			video::CColorConverter::convert_A1R5G5B5toA8R8G8B8( src, w, dst );
 
 			src = (u16*) ( (u8*) (src) + job->srcPitch );
 			dst = (u32*) ( (u8*) (dst) + job->dstPitch );
@@ -717,13 +1012,7 @@ static void executeBlit_TextureCopy_24_to_32( const SBlitJob * job )
 	{
 		for ( s32 dy = 0; dy != job->height; ++dy )
 		{
-			const u8* s = src;
-
-			for ( s32 dx = 0; dx != job->width; ++dx )
-			{
-				dst[dx] = 0xFF000000 | s[0] << 16 | s[1] << 8 | s[2];
-				s += 3;
-			}
+			video::CColorConverter::convert_R8G8B8toA8R8G8B8( src, job->width, dst );
 
 			src = src + job->srcPitch;
 			dst = (u32*) ( (u8*) (dst) + job->dstPitch );
@@ -763,13 +1052,7 @@ static void executeBlit_TextureCopy_32_to_24( const SBlitJob * job )
 	{
 		for ( u32 dy = 0; dy != h; ++dy )
 		{
-			for ( u32 dx = 0; dx != w; ++dx )
-			{
-				u8 * writeTo = &dst[dx * 3];
-				*writeTo++ = (src[dx] >> 16)& 0xFF;
-				*writeTo++ = (src[dx] >> 8) & 0xFF;
-				*writeTo++ = src[dx] & 0xFF;
-			}
+			video::CColorConverter::convert_A8R8G8B8toR8G8B8( src, w, dst );
 
 			src = (u32*) ( (u8*) (src) + job->srcPitch );
 			dst += job->dstPitch;
@@ -816,7 +1099,12 @@ static void executeBlit_TextureBlend_16_to_16( const SBlitJob * job )
 		const u32 off = core::if_c_a_else_b(w&1, w-1, 0);
 		for (u32 dy = 0; dy != h; ++dy )
 		{
-			for (u32 dx = 0; dx != rdx; ++dx )
+			u32 dx = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			if ( job->useSSE2 )
+				dx = blitTextureBlend16_SSE2( (const u16*) src, (u16*) dst, rdx * 2 ) / 2;
+#endif
+			for ( ; dx != rdx; ++dx )
 			{
 				dst[dx] = PixelBlend16_simd( dst[dx], src[dx] );
 			}
@@ -850,7 +1138,12 @@ static void executeBlit_TextureBlend_32_to_32( const SBlitJob * job )
 			const u32 src_y = (u32)(dy*hscale);
 			src = (u32*) ( (u8*) (job->src) + job->srcPitch*src_y );
 
-			for ( u32 dx = 0; dx < w; ++dx )
+			u32 dx = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			if ( job->useSSE2 )
+				dx = blitTextureBlend32Stretch_SSE2( src, dst, w, wscale );
+#endif
+			for ( ; dx < w; ++dx )
 			{
 				const u32 src_x = (u32)(dx*wscale);
 				dst[dx] = PixelBlend32( dst[dx], src[src_x] );
@@ -863,7 +1156,12 @@ static void executeBlit_TextureBlend_32_to_32( const SBlitJob * job )
 	{
 		for ( u32 dy = 0; dy != h; ++dy )
 		{
-			for ( u32 dx = 0; dx != w; ++dx )
+			u32 dx = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			if ( job->useSSE2 )
+				dx = blitTextureBlend32_SSE2( src, dst, w );
+#endif
+			for ( ; dx != w; ++dx )
 			{
 				dst[dx] = PixelBlend32( dst[dx], src[dx] );
 			}
@@ -883,7 +1181,12 @@ static void executeBlit_TextureBlendColor_16_to_16( const SBlitJob * job )
 	u16 blend = video::A8R8G8B8toA1R5G5B5 ( job->argb );
 	for ( s32 dy = 0; dy != job->height; ++dy )
 	{
-		for ( s32 dx = 0; dx != job->width; ++dx )
+		s32 dx = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		if ( job->useSSE2 )
+			dx = blitTextureBlendColor16_SSE2( src, dst, job->width, blend );
+#endif
+		for ( ; dx != job->width; ++dx )
 		{
 			if ( 0 == (src[dx] & 0x8000) )
 				continue;
@@ -905,7 +1208,12 @@ static void executeBlit_TextureBlendColor_32_to_32( const SBlitJob * job )
 
 	for ( s32 dy = 0; dy != job->height; ++dy )
 	{
-		for ( s32 dx = 0; dx != job->width; ++dx )
+		s32 dx = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		if ( job->useSSE2 )
+			dx = blitTextureBlendColor32_SSE2( src, dst, job->width, job->argb );
+#endif
+		for ( ; dx != job->width; ++dx )
 		{
 			dst[dx] = PixelBlend32( dst[dx], PixelMul32_2( src[dx], job->argb ) );
 		}
@@ -954,7 +1262,12 @@ static void executeBlit_ColorAlpha_16_to_16( const SBlitJob * job )
 
 	for ( s32 dy = 0; dy != job->height; ++dy )
 	{
-		for ( s32 dx = 0; dx != job->width; ++dx )
+		s32 dx = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		if ( job->useSSE2 )
+			dx = blitColorAlpha16_SSE2( dst, job->width, (u16) src, alpha );
+#endif
+		for ( ; dx != job->width; ++dx )
 		{
 			dst[dx] = 0x8000 | PixelBlend16( dst[dx], src, alpha );
 		}
@@ -973,7 +1286,12 @@ static void executeBlit_ColorAlpha_32_to_32( const SBlitJob * job )
 
 	for ( s32 dy = 0; dy != job->height; ++dy )
 	{
-		for ( s32 dx = 0; dx != job->width; ++dx )
+		s32 dx = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		if ( job->useSSE2 )
+			dx = blitColorAlpha32_SSE2( dst, job->width, job->argb );
+#endif
+		for ( ; dx != job->width; ++dx )
 		{
 			dst[dx] = (job->argb & 0xFF000000 ) | PixelBlend32( dst[dx], src, alpha );
 		}
@@ -1132,7 +1450,12 @@ static void executeBlit_TextureCombineColor_32_to_32( const SBlitJob * job )
 
 	for ( s32 dy = 0; dy != job->height; ++dy )
 	{
-		for ( s32 dx = 0; dx != job->width; ++dx )
+		s32 dx = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		if ( job->useSSE2 )
+			dx = blitTextureCombineColor32_SSE2( src, dst, job->width, job->argb );
+#endif
+		for ( ; dx != job->width; ++dx )
 		{
 			dst[dx] = PixelCombine32( dst[dx], PixelMul32_2( src[dx], job->argb ) );
 		}
@@ -1274,6 +1597,9 @@ static s32 Blit(eBlitter operation,
 	AbsRectangle v;
 
 	SBlitJob job;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	job.useSSE2 = os::Cpu::hasSSE2();
+#endif
 
 	setClip ( sourceClip, sourceClipping, source, 1 );
 	setClip ( destClip, destClipping, dest, 0 );
@@ -1317,10 +1643,97 @@ static s32 Blit(eBlitter operation,
 	return 1;
 }
 
+// source position of the center of a destination pixel, and the weight [0;255] of the next one
+inline void getBilinearSample( u32 d, float scale, s32 size, s32 &pos, u32 &weight )
+{
+	const float p = core::max_( ( d + 0.5f ) * scale - 0.5f, 0.f );
+	pos = (s32) p;
+	weight = (u32) ( ( p - pos ) * 256.f );
+	if ( pos >= size - 1 )
+	{
+		pos = size - 1;
+		weight = 0;
+	}
+}
+
+/*!
+	Stretches an A8R8G8B8 source with bilinear filtering. The filtered rows
+	are handed to the unstretched blitter of the operation.
+*/
+static void executeBlit_Bilinear( const SBlitJob * job, tExecuteBlit blitter )
+{
+	const s32 srcWidth = job->Source.x1 - job->Source.x0;
+	const s32 srcHeight = job->Source.y1 - job->Source.y0;
+	if ( job->width <= 0 || job->height <= 0 || srcWidth <= 0 || srcHeight <= 0 )
+		return;
+
+	const u32 w = job->width;
+	const u32 h = job->height;
+
+	// source column and weight of the next column for each destination column
+	core::array<s32> column;
+	core::array<u32> weight;
+	column.set_used( w );
+	weight.set_used( w );
+	for ( u32 dx = 0; dx != w; ++dx )
+		getBilinearSample( dx, 1.f/job->x_stretch, srcWidth, column[dx], weight[dx] );
+
+	// the columns used by all rows
+	const s32 first = column[0];
+	const u32 span = core::min_( column[w-1] + 1, srcWidth - 1 ) - first + 1;
+
+	core::array<u32> vertical;
+	core::array<u32> row;
+	vertical.set_used( span );
+	row.set_used( w );
+
+	SBlitJob rowJob = *job;
+	rowJob.stretch = false;
+	rowJob.height = 1;
+	rowJob.src = row.pointer();
+	rowJob.srcPitch = w * 4;
+	rowJob.srcPixelMul = 4;
+
+	for ( u32 dy = 0; dy != h; ++dy )
+	{
+		s32 y;
+		u32 fy;
+		getBilinearSample( dy, 1.f/job->y_stretch, srcHeight, y, fy );
+
+		const u32 *line = (const u32*) ( (const u8*) job->src + job->srcPitch * y ) + first;
+		if ( fy )
+		{
+			const u32 *next = (const u32*) ( (const u8*) line + job->srcPitch );
+			u32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			if ( job->useSSE2 )
+				x = blitLerpRows32_SSE2( line, next, vertical.pointer(), span, fy );
+#endif
+			for ( ; x != span; ++x )
+				vertical[x] = PixelLerp32_4( line[x], next[x], fy );
+			line = vertical.const_pointer();
+		}
+
+		for ( u32 dx = 0; dx != w; ++dx )
+		{
+			const u32 x = column[dx] - first;
+			row[dx] = weight[dx] ? PixelLerp32_4( line[x], line[x+1], weight[dx] ) : line[x];
+		}
+
+		rowJob.dst = (u8*) job->dst + job->dstPitch * dy;
+		blitter( &rowJob );
+	}
+}
+
+/*!
+	a 2D Blitter scaling the source rectangle to the destination rectangle.
+	Bilinear filtering is only done for A8R8G8B8 sources, others are
+	stretched by picking the nearest pixels.
+*/
 static s32 StretchBlit(eBlitter operation,
 		video::IImage* dest, const core::rect<s32> *destRect,
 		const core::rect<s32> *srcRect, video::IImage* const source,
-		u32 argb)
+		u32 argb, bool bilinear = false)
 {
 	tExecuteBlit blitter = getBlitter2( operation, dest, source );
 	if ( 0 == blitter )
@@ -1329,6 +1742,9 @@ static s32 StretchBlit(eBlitter operation,
 	}
 
 	SBlitJob job;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	job.useSSE2 = os::Cpu::hasSSE2();
+#endif
 
 	// Clipping
 	setClip ( job.Source, srcRect, source, 1 );
@@ -1360,7 +1776,10 @@ static s32 StretchBlit(eBlitter operation,
 	job.dstPixelMul = dest->getBytesPerPixel();
 	job.dst = (void*) ( (u8*) dest->getData() + ( job.Dest.y0 * job.dstPitch ) + ( job.Dest.x0 * job.dstPixelMul ) );
 
-	blitter( &job );
+	if ( bilinear && job.stretch && source && source->getColorFormat() == video::ECF_A8R8G8B8 )
+		executeBlit_Bilinear( &job, blitter );
+	else
+		blitter( &job );
 
 	return 1;
 }
@@ -745,6 +745,12 @@ REALINLINE void CBurningShader_Raster_Reference::scanline2()
 			line.t[i][0] += line.t[i][1];
 		}
 	}
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	// any compare function may bring depth closer to the far plane
+	if ( ShaderParam.RenderState [ BD3DRS_ZWRITEENABLE ] )
+		DepthBuffer->markSpan ( line.y, pShader.xStart, pShader.xEnd );
+#endif
 }
 
 
@@ -953,6 +959,9 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 			scan.t[i][1] += scan.slopeT[i][1] * subPixel;
 		}
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -976,7 +985,8 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 			}
 
 			// render a scanline
-			scanline ();
+			if ( line.y >= BandYStart )
+				scanline ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -1068,6 +1078,9 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 			scan.t[i][1] += scan.slopeT[i][1] * subPixel;
 		}
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -1091,7 +1104,8 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 			}
 
 			// render a scanline
-			scanline ();
+			if ( line.y >= BandYStart )
+				scanline ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
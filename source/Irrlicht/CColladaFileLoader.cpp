@@ -7,6 +7,8 @@
 
 #include "CColladaFileLoader.h"
 #include "CMeshTextureLoader.h"
+#include "CAsyncLoader.h"
+#include "CEmptySceneNode.h"
 #include "os.h"
 #include "IXMLReader.h"
 #include "IDummyTransformationSceneNode.h"
@@ -322,11 +324,79 @@ namespace
 	};
 
 
+//! Scene nodes and meshes of a file loaded on the loader thread
+/** They are built below a node which is not part of the scene and are added
+to the scene and the mesh cache on the thread which draws. */
+class CColladaSceneRequest : public IAsyncLoadRequest
+{
+public:
+
+	CColladaSceneRequest(scene::ISceneManager* smgr, const io::path& name)
+		: SceneManager(smgr), Name(name), Root(new CEmptySceneNode(0, smgr, -1))
+	{
+		#ifdef _DEBUG
+		setDebugName("CColladaSceneRequest");
+		#endif
+	}
+
+	virtual ~CColladaSceneRequest()
+	{
+		Root->drop();
+		for (u32 i=0; i<Meshes.size(); ++i)
+			Meshes[i]->drop();
+	}
+
+	virtual const io::path& getName() const _IRR_OVERRIDE_
+	{
+		return Name;
+	}
+
+	virtual bool load() _IRR_OVERRIDE_
+	{
+		return true;
+	}
+
+	//! moves the nodes to the root of the scene and adds the meshes to the cache
+	virtual bool finish() _IRR_OVERRIDE_
+	{
+		for (u32 i=0; i<Meshes.size(); ++i)
+			SceneManager->getMeshCache()->addMesh(MeshNames[i], Meshes[i]);
+
+		scene::ISceneNode* root = SceneManager->getRootSceneNode();
+		while (!Root->getChildren().empty())
+			(*Root->getChildren().begin())->setParent(root);
+
+		return true;
+	}
+
+	scene::ISceneNode* getRoot() const
+	{
+		return Root;
+	}
+
+	void addMesh(const io::path& name, IAnimatedMesh* mesh)
+	{
+		mesh->grab();
+		Meshes.push_back(mesh);
+		MeshNames.push_back(name);
+	}
+
+private:
+
+	scene::ISceneManager* SceneManager;
+	io::path Name;
+	scene::ISceneNode* Root;
+	core::array<IAnimatedMesh*> Meshes;
+	core::array<io::path> MeshNames;
+};
+
+
 //! Constructor
 CColladaFileLoader::CColladaFileLoader(scene::ISceneManager* smgr,
 		io::IFileSystem* fs)
 : SceneManager(smgr), FileSystem(fs), DummyMesh(0),
-	FirstLoadedMesh(0), LoadedMeshCount(0), CreateInstances(false)
+	FirstLoadedMesh(0), LoadedMeshCount(0), CreateInstances(false),
+	RootNode(0), SceneRequest(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CColladaFileLoader");
@@ -387,6 +457,16 @@ IAnimatedMesh* CColladaFileLoader::createMesh(io::IReadFile* file)
 	CurrentlyLoadingMesh = file->getFileName();
 	CreateInstances = SceneManager->getParameters()->getAttributeAsBool(
 		scene::COLLADA_CREATE_SCENE_INSTANCES);
+
+	// the scene belongs to the thread which draws
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	if (driver && driver->getAsyncLoader()->isLoaderThread())
+	{
+		SceneRequest = new CColladaSceneRequest(SceneManager, CurrentlyLoadingMesh);
+		RootNode = SceneRequest->getRoot();
+	}
+	else
+		RootNode = SceneManager->getRootSceneNode();
 	Version = 0;
 	FlipAxis = false;
 
@@ -405,7 +485,13 @@ IAnimatedMesh* CColladaFileLoader::createMesh(io::IReadFile* file)
 
 	reader->drop();
 	if (!Version)
+	{
+		if (SceneRequest)
+			SceneRequest->drop();
+		SceneRequest = 0;
+		RootNode = 0;
 		return 0;
+	}
 
 	// because this loader loads and creates a complete scene instead of
 	// a single mesh, return an empty dummy mesh to make the scene manager
@@ -415,15 +501,23 @@ IAnimatedMesh* CColladaFileLoader::createMesh(io::IReadFile* file)
 	scene::IAnimatedMesh* returnMesh = DummyMesh;
 
 	if (Version < 10400)
-		instantiateNode(SceneManager->getRootSceneNode());
+		instantiateNode(RootNode);
 
 	// add the first loaded mesh into the mesh cache too, if more than one
 	// meshes have been loaded from the file
 	if (LoadedMeshCount>1 && FirstLoadedMesh)
 	{
 		os::Printer::log("Added COLLADA mesh", FirstLoadedMeshName.c_str());
-		SceneManager->getMeshCache()->addMesh(FirstLoadedMeshName.c_str(), FirstLoadedMesh);
+		addToMeshCache(FirstLoadedMeshName, FirstLoadedMesh);
+	}
+
+	if (SceneRequest)
+	{
+		static_cast<CAsyncLoader*>(driver->getAsyncLoader())->finishOnDrawingThread(SceneRequest);
+		SceneRequest->drop();
+		SceneRequest = 0;
 	}
+	RootNode = 0;
 
 	// clean up temporary loaded data
 	clearData();
@@ -570,7 +664,7 @@ void CColladaFileLoader::readLibrarySection(io::IXMLReaderUTF8* reader)
 			{
 				CScenePrefab p("");
 
-				readNodeSection(reader, SceneManager->getRootSceneNode(), &p);
+				readNodeSection(reader, RootNode, &p);
 			}
 			else
 			if (effectSectionName == reader->getNodeName())
@@ -618,7 +712,7 @@ void CColladaFileLoader::readVisualScene(io::IXMLReaderUTF8* reader)
 				p = new CScenePrefab(readId(reader));
 			else
 			if (p && nodeSectionName == reader->getNodeName()) // as a child of visual_scene
-				readNodeSection(reader, SceneManager->getRootSceneNode(), p);
+				readNodeSection(reader, RootNode, p);
 			else
 			if (assetSectionName == reader->getNodeName())
 				readAssetSection(reader);
@@ -691,13 +785,13 @@ void CColladaFileLoader::readSceneSection(io::IXMLReaderUTF8* reader)
 			{
 				// create dummy node if there is none yet.
 				if (!node)
-					node = SceneManager->addDummyTransformationSceneNode(SceneManager->getRootSceneNode());
+					node = SceneManager->addDummyTransformationSceneNode(RootNode);
 
 				readNodeSection(reader, node);
 			}
 			else
 			if ((instanceSceneName == reader->getNodeName()))
-				readInstanceNode(reader, SceneManager->getRootSceneNode(), 0, 0,instanceSceneName);
+				readInstanceNode(reader, RootNode, 0, 0,instanceSceneName);
 			else
 			if (extraNodeName == reader->getNodeName())
 				skipSection(reader, false);
@@ -1856,7 +1950,7 @@ void CColladaFileLoader::readGeometry(io::IXMLReaderUTF8* reader)
 	// add to scene manager
 	if (LoadedMeshCount)
 	{
-		SceneManager->getMeshCache()->addMesh(filename.c_str(), amesh);
+		addToMeshCache(filename, amesh);
 		os::Printer::log("Added COLLADA mesh", filename.c_str(), ELL_DEBUG);
 	}
 	else
@@ -2756,6 +2850,16 @@ void CColladaFileLoader::clearData()
 }
 
 
+//! adds a mesh to the mesh cache, later when loading on the loader thread
+void CColladaFileLoader::addToMeshCache(const io::path& name, IAnimatedMesh* mesh)
+{
+	if (SceneRequest)
+		SceneRequest->addMesh(name, mesh);
+	else
+		SceneManager->getMeshCache()->addMesh(name, mesh);
+}
+
+
 //! changes the XML URI into an internal id
 void CColladaFileLoader::uriToId(core::stringc& str)
 {
@@ -25,6 +25,7 @@ namespace scene
 #endif
 
 class IColladaPrefab;
+class CColladaSceneRequest;
 
 enum ECOLLADA_PARAM_NAME
 {
@@ -301,6 +302,9 @@ private:
 	//! clears all loaded data
 	void clearData();
 
+	//! adds a mesh to the mesh cache, later when loading on the loader thread
+	void addToMeshCache(const io::path& name, IAnimatedMesh* mesh);
+
 	//! parses all collada parameters inside an element and stores them in ColladaParameters
 	void readColladaParameters(io::IXMLReaderUTF8* reader, const core::stringc& parentName);
 
@@ -373,6 +377,12 @@ private:
 
 	bool CreateInstances;
 
+	//! parent of the loaded scene, not part of the scene while loading on the loader thread
+	scene::ISceneNode* RootNode;
+
+	//! adds the loaded scene on the thread which draws, 0 when not loading on the loader thread
+	CColladaSceneRequest* SceneRequest;
+
 	struct EscapeCharacterURL
 	{
 		EscapeCharacterURL(irr::c8 c, const irr::c8* e)
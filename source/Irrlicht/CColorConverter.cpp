@@ -6,12 +6,248 @@
 #include "SColor.h"
 #include "os.h"
 #include "irrString.h"
+#include "CThreadPool.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+	#include <tmmintrin.h>
+
+	// SSSE3 functions are compiled for it even if the rest of the engine is not
+	#if defined(__GNUC__) && !defined(__SSSE3__)
+		#define _IRR_TARGET_SSSE3 __attribute__((target("ssse3")))
+	#else
+		#define _IRR_TARGET_SSSE3
+	#endif
+#endif
 
 namespace irr
 {
 namespace video
 {
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+/*
+	SSE2 and SSSE3 versions of the most common conversions. They convert
+	the pixels in blocks of 4 or 8 and return how many they did, the scalar
+	loops do the rest. The results have the same bits as the scalar code.
+*/
+namespace
+{
+	const bool UseSSE2 = os::Cpu::hasSSE2();
+	const bool UseSSSE3 = UseSSE2 && os::Cpu::hasSSSE3();
+
+	//! packs the lower 16 bit of the lanes of two vectors
+	inline __m128i pack32to16(const __m128i a, const __m128i b)
+	{
+		// sign extension keeps the signed saturation of packs from changing the bits
+		return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+			_mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+	}
+
+	//! x & mask shifted right
+	inline __m128i maskShiftRight(const __m128i x, u32 mask, int shift)
+	{
+		return _mm_srli_epi32(_mm_and_si128(x, _mm_set1_epi32(mask)), shift);
+	}
+
+	//! x & mask shifted left
+	inline __m128i maskShiftLeft(const __m128i x, u32 mask, int shift)
+	{
+		return _mm_slli_epi32(_mm_and_si128(x, _mm_set1_epi32(mask)), shift);
+	}
+
+	//! A8R8G8B8toA1R5G5B5 of four pixels
+	inline __m128i toA1R5G5B5_4(const __m128i c)
+	{
+		return _mm_or_si128(_mm_or_si128(maskShiftRight(c, 0x80000000, 16), maskShiftRight(c, 0x00F80000, 9)),
+			_mm_or_si128(maskShiftRight(c, 0x0000F800, 6), maskShiftRight(c, 0x000000F8, 3)));
+	}
+
+	//! A8R8G8B8toR5G6B5 of four pixels
+	inline __m128i toR5G6B5_4(const __m128i c)
+	{
+		return _mm_or_si128(_mm_or_si128(maskShiftRight(c, 0x00F80000, 8), maskShiftRight(c, 0x0000FC00, 5)),
+			maskShiftRight(c, 0x000000F8, 3));
+	}
+
+	//! A1R5G5B5toA8R8G8B8 of four pixels
+	inline __m128i fromA1R5G5B5_4(const __m128i c)
+	{
+		const __m128i a = _mm_and_si128(_mm_srai_epi32(_mm_slli_epi32(c, 16), 31), _mm_set1_epi32(0xFF000000));
+		const __m128i r = _mm_or_si128(maskShiftLeft(c, 0x7C00, 9), maskShiftLeft(c, 0x7000, 4));
+		const __m128i g = _mm_or_si128(maskShiftLeft(c, 0x03E0, 6), maskShiftLeft(c, 0x0380, 1));
+		const __m128i b = _mm_or_si128(maskShiftLeft(c, 0x001F, 3), maskShiftRight(c, 0x001C, 2));
+		return _mm_or_si128(_mm_or_si128(a, r), _mm_or_si128(g, b));
+	}
+
+	//! R5G6B5toA8R8G8B8 of four pixels
+	inline __m128i fromR5G6B5_4(const __m128i c)
+	{
+		return _mm_or_si128(_mm_or_si128(_mm_set1_epi32(0xFF000000), maskShiftLeft(c, 0xF800, 8)),
+			_mm_or_si128(maskShiftLeft(c, 0x07E0, 5), maskShiftLeft(c, 0x001F, 3)));
+	}
+
+	s32 A8R8G8B8toA1R5G5B5_SSE2(const u32* sB, s32 sN, u16* dB)
+	{
+		s32 x = 0;
+		for (; x + 8 <= sN; x += 8)
+		{
+			const __m128i lo = toA1R5G5B5_4(_mm_loadu_si128((const __m128i*)(sB + x)));
+			const __m128i hi = toA1R5G5B5_4(_mm_loadu_si128((const __m128i*)(sB + x + 4)));
+			_mm_storeu_si128((__m128i*)(dB + x), pack32to16(lo, hi));
+		}
+		return x;
+	}
+
+	s32 A8R8G8B8toR5G6B5_SSE2(const u32* sB, s32 sN, u16* dB)
+	{
+		s32 x = 0;
+		for (; x + 8 <= sN; x += 8)
+		{
+			const __m128i lo = toR5G6B5_4(_mm_loadu_si128((const __m128i*)(sB + x)));
+			const __m128i hi = toR5G6B5_4(_mm_loadu_si128((const __m128i*)(sB + x + 4)));
+			_mm_storeu_si128((__m128i*)(dB + x), pack32to16(lo, hi));
+		}
+		return x;
+	}
+
+	s32 A1R5G5B5toA8R8G8B8_SSE2(const u16* sB, s32 sN, u32* dB)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		s32 x = 0;
+		for (; x + 8 <= sN; x += 8)
+		{
+			const __m128i c = _mm_loadu_si128((const __m128i*)(sB + x));
+			_mm_storeu_si128((__m128i*)(dB + x), fromA1R5G5B5_4(_mm_unpacklo_epi16(c, zero)));
+			_mm_storeu_si128((__m128i*)(dB + x + 4), fromA1R5G5B5_4(_mm_unpackhi_epi16(c, zero)));
+		}
+		return x;
+	}
+
+	s32 R5G6B5toA8R8G8B8_SSE2(const u16* sB, s32 sN, u32* dB)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		s32 x = 0;
+		for (; x + 8 <= sN; x += 8)
+		{
+			const __m128i c = _mm_loadu_si128((const __m128i*)(sB + x));
+			_mm_storeu_si128((__m128i*)(dB + x), fromR5G6B5_4(_mm_unpacklo_epi16(c, zero)));
+			_mm_storeu_si128((__m128i*)(dB + x + 4), fromR5G6B5_4(_mm_unpackhi_epi16(c, zero)));
+		}
+		return x;
+	}
+
+	s32 A1R5G5B5toR5G6B5_SSE2(const u16* sB, s32 sN, u16* dB)
+	{
+		const __m128i maskRG = _mm_set1_epi16(0x7FE0);
+		const __m128i maskB = _mm_set1_epi16(0x001F);
+		s32 x = 0;
+		for (; x + 8 <= sN; x += 8)
+		{
+			const __m128i c = _mm_loadu_si128((const __m128i*)(sB + x));
+			_mm_storeu_si128((__m128i*)(dB + x), _mm_or_si128(
+				_mm_slli_epi16(_mm_and_si128(c, maskRG), 1), _mm_and_si128(c, maskB)));
+		}
+		return x;
+	}
+
+	s32 R5G6B5toA1R5G5B5_SSE2(const u16* sB, s32 sN, u16* dB)
+	{
+		const __m128i maskRG = _mm_set1_epi16((s16)0xFFC0);
+		const __m128i maskB = _mm_set1_epi16(0x001F);
+		const __m128i alpha = _mm_set1_epi16((s16)0x8000);
+		s32 x = 0;
+		for (; x + 8 <= sN; x += 8)
+		{
+			const __m128i c = _mm_loadu_si128((const __m128i*)(sB + x));
+			_mm_storeu_si128((__m128i*)(dB + x), _mm_or_si128(alpha, _mm_or_si128(
+				_mm_srli_epi16(_mm_and_si128(c, maskRG), 1), _mm_and_si128(c, maskB))));
+		}
+		return x;
+	}
+
+	s32 A8R8G8B8toA8B8G8R8_SSE2(const u32* sB, s32 sN, u32* dB)
+	{
+		const __m128i maskAG = _mm_set1_epi32(0xFF00FF00);
+		s32 x = 0;
+		for (; x + 4 <= sN; x += 4)
+		{
+			const __m128i c = _mm_loadu_si128((const __m128i*)(sB + x));
+			_mm_storeu_si128((__m128i*)(dB + x), _mm_or_si128(_mm_and_si128(c, maskAG),
+				_mm_or_si128(maskShiftRight(c, 0x00FF0000, 16), maskShiftLeft(c, 0x000000FF, 16))));
+		}
+		return x;
+	}
+
+	s32 B8G8R8A8toA8R8G8B8_SSE2(const u32* sB, s32 sN, u32* dB)
+	{
+		s32 x = 0;
+		for (; x + 4 <= sN; x += 4)
+		{
+			// reverse the bytes of each pixel
+			const __m128i c = _mm_loadu_si128((const __m128i*)(sB + x));
+			const __m128i outer = _mm_or_si128(_mm_srli_epi32(c, 24), _mm_slli_epi32(c, 24));
+			const __m128i inner = _mm_or_si128(maskShiftRight(c, 0x00FF0000, 8), maskShiftLeft(c, 0x0000FF00, 8));
+			_mm_storeu_si128((__m128i*)(dB + x), _mm_or_si128(outer, inner));
+		}
+		return x;
+	}
+
+	//! expands 3 byte pixels to 4 byte pixels with alpha 0xFF, shuffle selects the order of the bytes
+	_IRR_TARGET_SSSE3 s32 expand24to32_SSSE3(const u8* sB, s32 sN, u32* dB, const __m128i shuffle)
+	{
+		const __m128i alpha = _mm_set1_epi32(0xFF000000);
+		s32 x = 0;
+		// each load reads 16 bytes, but uses only the 12 bytes of 4 pixels
+		for (; x + 6 <= sN; x += 4)
+		{
+			const __m128i c = _mm_loadu_si128((const __m128i*)(sB + x * 3));
+			_mm_storeu_si128((__m128i*)(dB + x), _mm_or_si128(_mm_shuffle_epi8(c, shuffle), alpha));
+		}
+		return x;
+	}
+
+	//! drops the alpha byte of 4 byte pixels, shuffle selects the order of the bytes
+	_IRR_TARGET_SSSE3 s32 reduce32to24_SSSE3(const u32* sB, s32 sN, u8* dB, const __m128i shuffle)
+	{
+		s32 x = 0;
+		for (; x + 4 <= sN; x += 4)
+		{
+			const __m128i c = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(sB + x)), shuffle);
+			// store exactly the 12 bytes of the 4 pixels
+			_mm_storel_epi64((__m128i*)(dB + x * 3), c);
+			const s32 last = _mm_cvtsi128_si32(_mm_srli_si128(c, 8));
+			memcpy(dB + x * 3 + 8, &last, 4);
+		}
+		return x;
+	}
+
+	_IRR_TARGET_SSSE3 s32 R8G8B8toA8R8G8B8_SSSE3(const u8* sB, s32 sN, u32* dB)
+	{
+		return expand24to32_SSSE3(sB, sN, dB,
+			_mm_setr_epi8(2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9, -128));
+	}
+
+	_IRR_TARGET_SSSE3 s32 B8G8R8toA8R8G8B8_SSSE3(const u8* sB, s32 sN, u32* dB)
+	{
+		return expand24to32_SSSE3(sB, sN, dB,
+			_mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128));
+	}
+
+	_IRR_TARGET_SSSE3 s32 A8R8G8B8toR8G8B8_SSSE3(const u32* sB, s32 sN, u8* dB)
+	{
+		return reduce32to24_SSSE3(sB, sN, dB,
+			_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -128, -128, -128, -128));
+	}
+
+	_IRR_TARGET_SSSE3 s32 A8R8G8B8toB8G8R8_SSSE3(const u32* sB, s32 sN, u8* dB)
+	{
+		return reduce32to24_SSSE3(sB, sN, dB,
+			_mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128));
+	}
+}
+#endif
+
 //! converts a monochrome bitmap to A1R5G5B5 data
 void CColorConverter::convert1BitTo16Bit(const u8* in, s16* out, s32 width, s32 height, s32 linepad, bool flip)
 {
@@ -363,7 +599,18 @@ void CColorConverter::convert_A1R5G5B5toA8R8G8B8(const void* sP, s32 sN, void* d
 	u16* sB = (u16*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		done = A1R5G5B5toA8R8G8B8_SSE2(sB, sN, dB);
+		sB += done;
+		dB += done;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = A1R5G5B5toA8R8G8B8(*sB++);
 }
 
@@ -377,7 +624,18 @@ void CColorConverter::convert_A1R5G5B5toR5G6B5(const void* sP, s32 sN, void* dP)
 	u16* sB = (u16*)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		done = A1R5G5B5toR5G6B5_SSE2(sB, sN, dB);
+		sB += done;
+		dB += done;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = A1R5G5B5toR5G6B5(*sB++);
 }
 
@@ -386,7 +644,18 @@ void CColorConverter::convert_A8R8G8B8toR8G8B8(const void* sP, s32 sN, void* dP)
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSSE3)
+	{
+		done = A8R8G8B8toR8G8B8_SSSE3((const u32*)sB, sN, dB);
+		sB += done * 4;
+		dB += done * 3;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[2];
@@ -403,7 +672,18 @@ void CColorConverter::convert_A8R8G8B8toB8G8R8(const void* sP, s32 sN, void* dP)
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSSE3)
+	{
+		done = A8R8G8B8toB8G8R8_SSSE3((const u32*)sB, sN, dB);
+		sB += done * 4;
+		dB += done * 3;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[0];
@@ -425,7 +705,18 @@ void CColorConverter::convert_A8R8G8B8toA1R5G5B5(const void* sP, s32 sN, void* d
 	u32* sB = (u32*)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		done = A8R8G8B8toA1R5G5B5_SSE2(sB, sN, dB);
+		sB += done;
+		dB += done;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = A8R8G8B8toA1R5G5B5(*sB++);
 }
 
@@ -453,7 +744,18 @@ void CColorConverter::convert_A8R8G8B8toR5G6B5(const void* sP, s32 sN, void* dP)
 	u8 * sB = (u8 *)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		done = A8R8G8B8toR5G6B5_SSE2((const u32*)sB, sN, dB);
+		sB += done * 4;
+		dB += done;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		s32 r = sB[2] >> 3;
 		s32 g = sB[1] >> 2;
@@ -494,7 +796,18 @@ void CColorConverter::convert_R8G8B8toA8R8G8B8(const void* sP, s32 sN, void* dP)
 	u8*  sB = (u8* )sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSSE3)
+	{
+		done = R8G8B8toA8R8G8B8_SSSE3(sB, sN, dB);
+		sB += done * 3;
+		dB += done;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[0]<<16) | (sB[1]<<8) | sB[2];
 
@@ -526,7 +839,18 @@ void CColorConverter::convert_B8G8R8toA8R8G8B8(const void* sP, s32 sN, void* dP)
 	u8*  sB = (u8* )sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSSE3)
+	{
+		done = B8G8R8toA8R8G8B8_SSSE3(sB, sN, dB);
+		sB += done * 3;
+		dB += done;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[2]<<16) | (sB[1]<<8) | sB[0];
 
@@ -540,7 +864,18 @@ void CColorConverter::convert_B8G8R8A8toA8R8G8B8(const void* sP, s32 sN, void* d
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		done = B8G8R8A8toA8R8G8B8_SSE2((const u32*)sB, sN, (u32*)dB);
+		sB += done * 4;
+		dB += done * 4;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		dB[0] = sB[3];
 		dB[1] = sB[2];
@@ -558,7 +893,18 @@ void CColorConverter::convert_A8R8G8B8toA8B8G8R8(const void* sP, s32 sN, void* d
 	const u32* sB = (const u32*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		done = A8R8G8B8toA8B8G8R8_SSE2(sB, sN, dB);
+		sB += done;
+		dB += done;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		*dB++ = (*sB & 0xff00ff00) | ((*sB & 0x00ff0000) >> 16) | ((*sB & 0x000000ff) << 16);
 		++sB;
@@ -625,7 +971,18 @@ void CColorConverter::convert_R5G6B5toA8R8G8B8(const void* sP, s32 sN, void* dP)
 	u16* sB = (u16*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		done = R5G6B5toA8R8G8B8_SSE2(sB, sN, dB);
+		sB += done;
+		dB += done;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = R5G6B5toA8R8G8B8(*sB++);
 }
 
@@ -634,7 +991,18 @@ void CColorConverter::convert_R5G6B5toA1R5G5B5(const void* sP, s32 sN, void* dP)
 	u16* sB = (u16*)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 done = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if (UseSSE2)
+	{
+		done = R5G6B5toA1R5G5B5_SSE2(sB, sN, dB);
+		sB += done;
+		dB += done;
+	}
+#endif
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = R5G6B5toA1R5G5B5(*sB++);
 }
 
@@ -732,5 +1100,56 @@ void CColorConverter::convert_viaFormat(const void* sP, ECOLOR_FORMAT sF, s32 sN
 }
 
 
+namespace
+{
+	//! converts bands of rows of an image
+	struct SConvertJob : public IThreadJob
+	{
+		virtual void runPart(u32 part, u32 thread) _IRR_OVERRIDE_
+		{
+			const u32 end = core::min_(Height, (part + 1) * BandRows);
+			for (u32 y = part * BandRows; y < end; ++y)
+				CColorConverter::convert_viaFormat(Src + y * SrcPitch, SrcFormat, Width,
+					Dst + y * DstPitch, DstFormat);
+		}
+
+		const u8* Src;
+		u8* Dst;
+		ECOLOR_FORMAT SrcFormat;
+		ECOLOR_FORMAT DstFormat;
+		u32 SrcPitch;
+		u32 DstPitch;
+		u32 Width;
+		u32 Height;
+		u32 BandRows;
+	};
+
+	//! pixels converted by one part of a conversion job
+	const u32 CONVERT_BAND_PIXELS = 0x10000;
+}
+
+
+//! converts a rectangle of width*height pixels between images with the given pitches
+void CColorConverter::convert_viaFormat(const void* sP, ECOLOR_FORMAT sF, u32 sPitch,
+				void* dP, ECOLOR_FORMAT dF, u32 dPitch, u32 width, u32 height)
+{
+	if (!width || !height)
+		return;
+
+	SConvertJob job;
+	job.Src = (const u8*)sP;
+	job.Dst = (u8*)dP;
+	job.SrcFormat = sF;
+	job.DstFormat = dF;
+	job.SrcPitch = sPitch;
+	job.DstPitch = dPitch;
+	job.Width = width;
+	job.Height = height;
+	job.BandRows = core::max_(CONVERT_BAND_PIXELS / width, 1u);
+
+	CThreadPool::runShared(&job, (height + job.BandRows - 1) / job.BandRows);
+}
+
+
 } // end namespace video
 } // end namespace irr
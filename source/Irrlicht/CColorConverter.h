@@ -86,6 +86,11 @@ public:
 	static void convert_R5G6B5toA1R5G5B5(const void* sP, s32 sN, void* dP);
 	static void convert_viaFormat(const void* sP, ECOLOR_FORMAT sF, s32 sN,
 				void* dP, ECOLOR_FORMAT dF);
+
+	//! converts a rectangle of width*height pixels between images with the given pitches
+	/** Large rectangles are converted in bands of rows on the shared thread pool. */
+	static void convert_viaFormat(const void* sP, ECOLOR_FORMAT sF, u32 sPitch,
+				void* dP, ECOLOR_FORMAT dF, u32 dPitch, u32 width, u32 height);
 };
 
 
@@ -714,6 +714,8 @@ bool CD3D9Driver::setActiveTexture(u32 stage, const video::ITexture* texture)
 	else
 	{
 		pID3DDevice->SetTexture(stage, ((const CD3D9Texture*)texture)->getDX9BaseTexture());
+		++FrameStats.TextureBinds;
+		useTexture(texture);
 
 		if (stage <= 4)
             pID3DDevice->SetTexture(D3DVERTEXTEXTURESAMPLER0 + stage, ((const CD3D9Texture*)texture)->getDX9BaseTexture());
@@ -1282,6 +1284,7 @@ void CD3D9Driver::drawVertexPrimitiveList(const void* vertices,
 	if (!vertexCount || !primitiveCount)
 		return;
 
+	FrameStats.VerticesTransformed += vertexCount;
 	draw2D3DVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount,
 		vType, pType, iType, true);
 }
@@ -1301,6 +1304,7 @@ void CD3D9Driver::draw2DVertexPrimitiveList(const void* vertices,
 	if (!vertexCount || !primitiveCount)
 		return;
 
+	FrameStats.VerticesTransformed += vertexCount;
 	draw2D3DVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount,
 		vType, pType, iType, false);
 }
@@ -1940,6 +1944,8 @@ bool CD3D9Driver::setRenderStates3DMode()
 
 	if (ResetRenderStates || LastMaterial != Material)
 	{
+		++FrameStats.MaterialChanges;
+
 		// unset old material
 
 		if (CurrentRenderMode == ERM_3D &&
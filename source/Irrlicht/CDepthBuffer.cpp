@@ -5,6 +5,8 @@
 #include "IrrCompileConfig.h"
 #include "SoftwareDriver2_compile_config.h"
 #include "CDepthBuffer.h"
+#include "SoftwareDriver2_simd.h"
+#include "os.h"
 
 #ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 
@@ -16,12 +18,20 @@ namespace video
 
 //! constructor
 CDepthBuffer::CDepthBuffer(const core::dimension2d<u32>& size)
-: Buffer(0), Size(0,0)
+:
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	Coarse(0), CoarseDirty(0), CoarseWidth(0), CoarseHeight(0), UseSSE2(false),
+#endif
+	Buffer(0), Size(0,0)
 {
 	#ifdef _DEBUG
 	setDebugName("CDepthBuffer");
 	#endif
 
+#if defined ( SOFTWARE_DRIVER_2_HIERARCHICAL_Z ) && defined ( SOFTWARE_DRIVER_2_SSE2 )
+	UseSSE2 = os::Cpu::hasSSE2 ();
+#endif
+
 	setSize(size);
 }
 
@@ -30,6 +40,10 @@ CDepthBuffer::CDepthBuffer(const core::dimension2d<u32>& size)
 //! destructor
 CDepthBuffer::~CDepthBuffer()
 {
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	delete [] Coarse;
+	delete [] CoarseDirty;
+#endif
 	delete [] Buffer;
 }
 
@@ -49,6 +63,13 @@ void CDepthBuffer::clear()
 	zMaxValue = IR(zMax);
 
 	memset32 ( Buffer, zMaxValue, TotalSize );
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	const u32 blocks = CoarseWidth * CoarseHeight;
+	for ( u32 i = 0; i != blocks; ++i )
+		Coarse[i] = zMax;
+	memset ( CoarseDirty, 0, blocks );
+#endif
 }
 
 
@@ -66,6 +87,18 @@ void CDepthBuffer::setSize(const core::dimension2d<u32>& size)
 	Pitch = size.Width * sizeof ( fp24 );
 	TotalSize = Pitch * size.Height;
 	Buffer = new u8[TotalSize];
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	const u32 blockSize = 1 << SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+	CoarseWidth = ( size.Width + blockSize - 1 ) >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+	CoarseHeight = ( size.Height + blockSize - 1 ) >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+
+	delete [] Coarse;
+	delete [] CoarseDirty;
+	Coarse = new fp24[CoarseWidth * CoarseHeight];
+	CoarseDirty = new u8[CoarseWidth * CoarseHeight];
+#endif
+
 	clear ();
 }
 
@@ -77,6 +110,103 @@ const core::dimension2d<u32>& CDepthBuffer::getSize() const
 	return Size;
 }
 
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+
+//! recomputes the farthest (smallest) w of a block
+fp24 CDepthBuffer::updateCoarse ( u32 bx, u32 by )
+{
+	const u32 blockSize = 1 << SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+	const u32 x0 = bx << SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+	const u32 y0 = by << SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+	const u32 x1 = core::min_ ( x0 + blockSize, Size.Width );
+	const u32 y1 = core::min_ ( y0 + blockSize, Size.Height );
+
+	const fp24* z = (fp24*) Buffer + y0 * Size.Width;
+	fp24 farthest;
+
+#ifdef SOFTWARE_DRIVER_2_SSE2
+	if ( UseSSE2 && x1 - x0 == 8 )
+	{
+		__m128 m = _mm_loadu_ps ( z + x0 );
+		for ( u32 y = y0; y != y1; ++y, z += Size.Width )
+		{
+			m = _mm_min_ps ( m, _mm_loadu_ps ( z + x0 ) );
+			m = _mm_min_ps ( m, _mm_loadu_ps ( z + x0 + 4 ) );
+		}
+		m = _mm_min_ps ( m, _mm_shuffle_ps ( m, m, _MM_SHUFFLE ( 1, 0, 3, 2 ) ) );
+		m = _mm_min_ps ( m, _mm_shuffle_ps ( m, m, _MM_SHUFFLE ( 2, 3, 0, 1 ) ) );
+		farthest = _mm_cvtss_f32 ( m );
+	}
+	else
+#endif
+	{
+		farthest = z[x0];
+		for ( u32 y = y0; y != y1; ++y, z += Size.Width )
+		{
+			for ( u32 x = x0; x != x1; ++x )
+			{
+				if ( z[x] < farthest )
+					farthest = z[x];
+			}
+		}
+	}
+
+	const u32 index = by * CoarseWidth + bx;
+	Coarse[index] = farthest;
+	CoarseDirty[index] = 0;
+	return farthest;
+}
+
+
+//! returns true if w fails the depth test in every block of the rectangle
+bool CDepthBuffer::isOccluded ( s32 xStart, s32 yStart, s32 xEnd, s32 yEnd, f32 w )
+{
+	const u32 bx0 = xStart >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+	const u32 bx1 = xEnd >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+	const u32 by1 = yEnd >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+
+	bool occluded = true;
+
+	// all blocks are visited, so the scanline clipping sees fresh values
+	for ( u32 by = yStart >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2; by <= by1; ++by )
+	{
+		const u32 row = by * CoarseWidth;
+		for ( u32 bx = bx0; bx <= bx1; ++bx )
+		{
+			// depth test is w >= z. a stale value is never farther than the
+			// real one, so only a block which seems to pass needs an update
+			if ( w >= Coarse[row + bx] &&
+				( 0 == CoarseDirty[row + bx] || w >= updateCoarse ( bx, by ) ) )
+				occluded = false;
+		}
+	}
+	return occluded;
+}
+
+
+//! shrinks the span [xStart,xEnd] of row y to the blocks where w may pass
+bool CDepthBuffer::clipSpan ( s32 y, s32 &xStart, s32 &xEnd, f32 w )
+{
+	// values were refreshed by the triangle query, stale ones are conservative
+	const fp24* coarse = Coarse + ( y >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2 ) * CoarseWidth;
+	s32 b0 = xStart >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+	s32 b1 = xEnd >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+
+	while ( b0 <= b1 && w < coarse[b0] )
+		b0 += 1;
+	if ( b0 > b1 )
+		return false;
+	while ( w < coarse[b1] )
+		b1 -= 1;
+
+	xStart = core::max_ ( xStart, b0 << SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2 );
+	xEnd = core::min_ ( xEnd, ( ( b1 + 1 ) << SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2 ) - 1 );
+	return true;
+}
+
+#endif
+
 // -----------------------------------------------------------------
 
 //! constructor
@@ -6,6 +6,7 @@
 #define __C_Z_BUFFER_H_INCLUDED__
 
 #include "IDepthBuffer.h"
+#include "SoftwareDriver2_compile_config.h"
 
 namespace irr
 {
@@ -40,9 +41,42 @@ namespace video
 		//! returns pitch of depthbuffer (in bytes)
 		virtual u32 getPitch() const _IRR_OVERRIDE_ { return Pitch; }
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+		//! marks the blocks touched by a written span [xStart,xEnd] of row y
+		/** The coarse value of a marked block is recomputed on demand.
+		Blocks are 8 rows high and never cross a rasterizer tile, so every
+		block is only touched by the thread owning its tile. */
+		void markSpan ( s32 y, s32 xStart, s32 xEnd )
+		{
+			u8* dirty = CoarseDirty + ( y >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2 ) * CoarseWidth;
+			const s32 end = xEnd >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2;
+			for ( s32 b = xStart >> SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2; b <= end; ++b )
+				dirty[b] = 1;
+		}
+
+		//! returns true if w fails the depth test in every block of the rectangle
+		/** Rectangle bounds are inclusive and have to be inside the buffer.
+		w is the nearest (largest) w of the tested primitive. */
+		bool isOccluded ( s32 xStart, s32 yStart, s32 xEnd, s32 yEnd, f32 w );
+
+		//! shrinks the span [xStart,xEnd] of row y to the blocks where w may pass
+		/** \return false if the whole span is occluded */
+		bool clipSpan ( s32 y, s32 &xStart, s32 &xEnd, f32 w );
+#endif
 
 	private:
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+		//! recomputes the farthest (smallest) w of a block
+		fp24 updateCoarse ( u32 bx, u32 by );
+
+		fp24* Coarse;
+		u8* CoarseDirty;
+		u32 CoarseWidth;
+		u32 CoarseHeight;
+		bool UseSSE2;
+#endif
+
 		u8* Buffer;
 		core::dimension2d<u32> Size;
 		u32 TotalSize;
@@ -0,0 +1,140 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CFileIndex.h"
+
+namespace irr
+{
+namespace io
+{
+
+CFileIndex::CFileIndex()
+: Used(0)
+{
+}
+
+
+//! Removes all files
+void CFileIndex::clear()
+{
+	Table.clear();
+	Used = 0;
+}
+
+
+//! Adds all files of a file list which are not in the index yet
+void CFileIndex::add(const IFileList* list, u32 archive)
+{
+	if (!list)
+		return;
+
+	const u32 count = list->getFileCount();
+	for (u32 i=0; i<count; ++i)
+	{
+		if (list->isDirectory(i))
+			continue;
+
+		// keep the table at most half full
+		if ((Used + 1) * 2 > Table.size())
+			grow();
+
+		const io::path& name = list->getFullFileName(i);
+
+		SEntry entry;
+		entry.List = list;
+		entry.Archive = archive;
+		entry.Index = i;
+		entry.Hash = hash(name);
+
+		if (insert(entry, name))
+			++Used;
+	}
+}
+
+
+//! Finds a file
+bool CFileIndex::find(const io::path& name, u32& archive, u32& index) const
+{
+	if (!Used)
+		return false;
+
+	const u32 mask = Table.size() - 1;
+	const u32 h = hash(name);
+
+	for (u32 slot = h & mask; Table[slot].List; slot = (slot + 1) & mask)
+	{
+		const SEntry& e = Table[slot];
+		if (e.Hash == h && e.List->getFullFileName(e.Index).equals_ignore_case(name))
+		{
+			archive = e.Archive;
+			index = e.Index;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+//! case insensitive hash of a name, FNV-1a
+u32 CFileIndex::hash(const io::path& name)
+{
+	u32 h = 2166136261u;
+	for (u32 i=0; i<name.size(); ++i)
+	{
+		h ^= core::locale_lower((u32)name[i]);
+		h *= 16777619u;
+	}
+	return h;
+}
+
+
+//! resizes the table and inserts all entries again
+void CFileIndex::grow()
+{
+	core::array<SEntry> old;
+	old.swap(Table);
+
+	SEntry empty;
+	empty.List = 0;
+	empty.Archive = 0;
+	empty.Index = 0;
+	empty.Hash = 0;
+
+	const u32 size = old.size() ? old.size() * 2 : 64;
+	Table.reallocate(size);
+	Table.set_used(size);
+	for (u32 i=0; i<size; ++i)
+		Table[i] = empty;
+
+	// order of equal names does not matter, they were rejected before
+	for (u32 i=0; i<old.size(); ++i)
+	{
+		if (old[i].List)
+			insert(old[i], old[i].List->getFullFileName(old[i].Index));
+	}
+}
+
+
+//! inserts an entry, returns false if the name is already in the table
+bool CFileIndex::insert(const SEntry& entry, const io::path& name)
+{
+	const u32 mask = Table.size() - 1;
+
+	u32 slot = entry.Hash & mask;
+	for (; Table[slot].List; slot = (slot + 1) & mask)
+	{
+		const SEntry& e = Table[slot];
+		if (e.Hash == entry.Hash && e.List->getFullFileName(e.Index).equals_ignore_case(name))
+			return false;
+	}
+
+	Table[slot] = entry;
+	return true;
+}
+
+
+} // end namespace io
+} // end namespace irr
+
@@ -0,0 +1,76 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_FILE_INDEX_H_INCLUDED__
+#define __C_FILE_INDEX_H_INCLUDED__
+
+#include "IFileList.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace io
+{
+
+//! Hash table from file names to the first archive containing them
+/** Keys are the full names of the files in the file lists of the archives,
+compared without case. Only file lists which ignore case themselves may be
+added, those of other archives can hold names differing only in case, which
+would share one entry. The names are not copied, the file lists have to stay
+valid as long as they are in the index. */
+class CFileIndex
+{
+public:
+
+	//! Constructor
+	CFileIndex();
+
+	//! Removes all files
+	void clear();
+
+	//! Adds all files of a file list which are not in the index yet
+	/** Archives have to be added in the order they are searched.
+	\param list File list of the archive, folders are not added.
+	\param archive Index of the archive in the file system. */
+	void add(const IFileList* list, u32 archive);
+
+	//! Finds a file
+	/** \param name Name of the file with '/' as path separator.
+	\param archive Receives the index of the archive.
+	\param index Receives the index of the file in the file list of the archive.
+	\return True if the file was found. */
+	bool find(const io::path& name, u32& archive, u32& index) const;
+
+	//! Returns the number of files in the index
+	u32 size() const { return Used; }
+
+private:
+
+	struct SEntry
+	{
+		const IFileList* List;
+		u32 Archive;
+		u32 Index;
+		u32 Hash;
+	};
+
+	//! case insensitive hash of a name
+	static u32 hash(const io::path& name);
+
+	//! resizes the table and inserts all entries again
+	void grow();
+
+	//! inserts an entry, returns false if the name is already in the table
+	bool insert(const SEntry& entry, const io::path& name);
+
+	//! open addressing with linear probing, the size is a power of two
+	core::array<SEntry> Table;
+	u32 Used;
+};
+
+
+} // end namespace io
+} // end namespace irr
+
+#endif
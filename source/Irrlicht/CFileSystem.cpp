@@ -55,6 +55,7 @@ namespace io
 
 //! constructor
 CFileSystem::CFileSystem()
+: Lock(true)
 {
 	#ifdef _DEBUG
 	setDebugName("CFileSystem");
@@ -114,16 +115,32 @@ IReadFile* CFileSystem::createAndOpenFile(const io::path& filename)
 	if ( filename.empty() )
 		return 0;
 
+	// the working directory must not change until the file is open
+	CMutexLock lock(Lock);
+
 	IReadFile* file = 0;
+	u32 fileIndex = 0;
+	const u32 found = findIndexedFile(filename, fileIndex);
 	u32 i;
 
-	for (i=0; i< FileArchives.size(); ++i)
+	// archives before the one found in the index which are not indexed
+	for (i=0; i < found; ++i)
 	{
+		if (FileArchiveIndex[i] != EAI_NONE)
+			continue;
+
 		file = FileArchives[i]->createAndOpenFile(filename);
 		if (file)
 			return file;
 	}
 
+	if (found < FileArchives.size())
+	{
+		file = FileArchives[found]->createAndOpenFile(fileIndex);
+		if (file)
+			return file;
+	}
+
 	// Create the file using an absolute path so that it matches
 	// the scheme used by CNullDriver::getTexture().
 	return CReadFile::createReadFile(getAbsolutePath(filename));
@@ -176,6 +193,7 @@ void CFileSystem::addArchiveLoader(IArchiveLoader* loader)
 	if (!loader)
 		return;
 
+	CMutexLock lock(Lock);
 	loader->grab();
 	ArchiveLoader.push_back(loader);
 }
@@ -183,12 +201,14 @@ void CFileSystem::addArchiveLoader(IArchiveLoader* loader)
 //! Returns the total number of archive loaders added.
 u32 CFileSystem::getArchiveLoaderCount() const
 {
+	CMutexLock lock(Lock);
 	return ArchiveLoader.size();
 }
 
 //! Gets the archive loader by index.
 IArchiveLoader* CFileSystem::getArchiveLoader(u32 index) const
 {
+	CMutexLock lock(Lock);
 	if (index < ArchiveLoader.size())
 		return ArchiveLoader[index];
 	else
@@ -198,6 +218,7 @@ IArchiveLoader* CFileSystem::getArchiveLoader(u32 index) const
 //! move the hirarchy of the filesystem. moves sourceIndex relative up or down
 bool CFileSystem::moveFileArchive(u32 sourceIndex, s32 relative)
 {
+	CMutexLock lock(Lock);
 	bool r = false;
 	const s32 dest = (s32) sourceIndex + relative;
 	const s32 dir = relative < 0 ? -1 : 1;
@@ -212,8 +233,15 @@ bool CFileSystem::moveFileArchive(u32 sourceIndex, s32 relative)
 		t = FileArchives[s + dir];
 		FileArchives[s + dir] = FileArchives[s];
 		FileArchives[s] = t;
+
+		const E_ARCHIVE_INDEX index = FileArchiveIndex[s + dir];
+		FileArchiveIndex[s + dir] = FileArchiveIndex[s];
+		FileArchiveIndex[s] = index;
 		r = true;
 	}
+
+	if (r)
+		rebuildFileIndex();
 	return r;
 }
 
@@ -227,6 +255,9 @@ bool CFileSystem::addFileArchive(const io::path& filename, bool ignoreCase,
 	IFileArchive* archive = 0;
 	bool ret = false;
 
+	// held while the archive is created, the mount loader changes the working directory
+	CMutexLock lock(Lock);
+
 	// see if archive is already added
 	if (changeArchivePassword(filename, password, retArchive))
 		return true;
@@ -310,7 +341,8 @@ bool CFileSystem::addFileArchive(const io::path& filename, bool ignoreCase,
 
 	if (archive)
 	{
-		FileArchives.push_back(archive);
+		// the index compares names without case, so it only holds archives doing the same
+		appendFileArchive(archive, !ignoreCase ? EAI_NONE : ignorePaths ? EAI_FILE_NAMES : EAI_FULL_NAMES);
 		if (password.size())
 			archive->Password=password;
 		if (retArchive)
@@ -356,6 +388,8 @@ bool CFileSystem::addFileArchive(IReadFile* file, bool ignoreCase,
 	if (!file || archiveType == EFAT_FOLDER)
 		return false;
 
+	CMutexLock lock(Lock);
+
 	if (file)
 	{
 		if (changeArchivePassword(file->getFileName(), password, retArchive))
@@ -415,7 +449,8 @@ bool CFileSystem::addFileArchive(IReadFile* file, bool ignoreCase,
 
 		if (archive)
 		{
-			FileArchives.push_back(archive);
+			// the index compares names without case, so it only holds archives doing the same
+			appendFileArchive(archive, !ignoreCase ? EAI_NONE : ignorePaths ? EAI_FILE_NAMES : EAI_FULL_NAMES);
 			if (password.size())
 				archive->Password=password;
 			if (retArchive)
@@ -437,6 +472,7 @@ bool CFileSystem::addFileArchive(IFileArchive* archive)
 {
 	if ( archive )
 	{
+		CMutexLock lock(Lock);
 		for (u32 i=0; i < FileArchives.size(); ++i)
 		{
 			if (archive == FileArchives[i])
@@ -444,7 +480,8 @@ bool CFileSystem::addFileArchive(IFileArchive* archive)
 				return false;
 			}
 		}
-		FileArchives.push_back(archive);
+		// the flags the archive was created with are not known
+		appendFileArchive(archive, EAI_NONE);
 		archive->grab();
 
 		return true;
@@ -457,11 +494,14 @@ bool CFileSystem::addFileArchive(IFileArchive* archive)
 //! removes an archive from the file system.
 bool CFileSystem::removeFileArchive(u32 index)
 {
+	CMutexLock lock(Lock);
 	bool ret = false;
 	if (index < FileArchives.size())
 	{
 		FileArchives[index]->drop();
 		FileArchives.erase(index);
+		FileArchiveIndex.erase(index);
+		rebuildFileIndex();
 		ret = true;
 	}
 	return ret;
@@ -472,6 +512,7 @@ bool CFileSystem::removeFileArchive(u32 index)
 bool CFileSystem::removeFileArchive(const io::path& filename)
 {
 	const path absPath = getAbsolutePath(filename);
+	CMutexLock lock(Lock);
 	for (u32 i=0; i < FileArchives.size(); ++i)
 	{
 		if (absPath == FileArchives[i]->getFileList()->getPath())
@@ -484,6 +525,7 @@ bool CFileSystem::removeFileArchive(const io::path& filename)
 //! Removes an archive from the file system.
 bool CFileSystem::removeFileArchive(const IFileArchive* archive)
 {
+	CMutexLock lock(Lock);
 	for (u32 i=0; i < FileArchives.size(); ++i)
 	{
 		if (archive == FileArchives[i])
@@ -495,22 +537,102 @@ bool CFileSystem::removeFileArchive(const IFileArchive* archive)
 }
 
 
+//! adds an archive at the end of the search order
+void CFileSystem::appendFileArchive(IFileArchive* archive, E_ARCHIVE_INDEX index)
+{
+	FileArchives.push_back(archive);
+	FileArchiveIndex.push_back(index);
+
+	// names already in the index belong to archives searched before
+	if (index == EAI_FULL_NAMES)
+		FullNameIndex.add(archive->getFileList(), FileArchives.size()-1);
+	else if (index == EAI_FILE_NAMES)
+		FileNameIndex.add(archive->getFileList(), FileArchives.size()-1);
+}
+
+
+//! builds the file index again after archives were removed or moved
+void CFileSystem::rebuildFileIndex()
+{
+	FullNameIndex.clear();
+	FileNameIndex.clear();
+
+	for (u32 i=0; i < FileArchives.size(); ++i)
+	{
+		if (FileArchiveIndex[i] == EAI_FULL_NAMES)
+			FullNameIndex.add(FileArchives[i]->getFileList(), i);
+		else if (FileArchiveIndex[i] == EAI_FILE_NAMES)
+			FileNameIndex.add(FileArchives[i]->getFileList(), i);
+	}
+}
+
+
+//! finds a file in the indexed archives
+u32 CFileSystem::findIndexedFile(const io::path& filename, u32& fileIndex) const
+{
+	u32 found = FileArchives.size();
+
+	// folders are not indexed, all archives are asked for them
+	if (filename.empty() || filename.lastChar() == '/' || filename.lastChar() == '\\')
+	{
+		for (u32 i=0; i < FileArchiveIndex.size(); ++i)
+		{
+			if (FileArchiveIndex[i] != EAI_NONE)
+			{
+				const s32 index = FileArchives[i]->getFileList()->findFile(filename);
+				if (index != -1)
+				{
+					fileIndex = (u32)index;
+					return i;
+				}
+			}
+		}
+		return found;
+	}
+
+	io::path name(filename);
+	name.replace('\\', '/');
+
+	u32 archive, index;
+	if (FullNameIndex.find(name, archive, index))
+	{
+		found = archive;
+		fileIndex = index;
+	}
+
+	if (FileNameIndex.size())
+	{
+		core::deletePathFromFilename(name);
+		if (FileNameIndex.find(name, archive, index) && archive < found)
+		{
+			found = archive;
+			fileIndex = index;
+		}
+	}
+
+	return found;
+}
+
+
 //! gets an archive
 u32 CFileSystem::getFileArchiveCount() const
 {
+	CMutexLock lock(Lock);
 	return FileArchives.size();
 }
 
 
 IFileArchive* CFileSystem::getFileArchive(u32 index)
 {
-	return index < getFileArchiveCount() ? FileArchives[index] : 0;
+	CMutexLock lock(Lock);
+	return index < FileArchives.size() ? FileArchives[index] : 0;
 }
 
 
 //! Returns the string of the current working directory
 const io::path& CFileSystem::getWorkingDirectory()
 {
+	CMutexLock lock(Lock);
 	EFileSystemType type = FileSystemType;
 
 	if (type != FILESYSTEM_NATIVE)
@@ -519,16 +641,19 @@ const io::path& CFileSystem::getWorkingDirectory()
 	}
 	else
 	{
+		// only written when it changed, callers on other threads may read it
+		io::path cwd;
+
 		#if defined(_IRR_WINDOWS_API_)
 			fschar_t tmp[_MAX_PATH];
 			#if defined(_IRR_WCHAR_FILESYSTEM )
 				_wgetcwd(tmp, _MAX_PATH);
-				WorkingDirectory[FILESYSTEM_NATIVE] = tmp;
-				WorkingDirectory[FILESYSTEM_NATIVE].replace(L'\\', L'/');
+				cwd = tmp;
+				cwd.replace(L'\\', L'/');
 			#else
 				_getcwd(tmp, _MAX_PATH);
-				WorkingDirectory[FILESYSTEM_NATIVE] = tmp;
-				WorkingDirectory[FILESYSTEM_NATIVE].replace('\\', '/');
+				cwd = tmp;
+				cwd.replace('\\', '/');
 			#endif
 		#endif
 
@@ -549,7 +674,7 @@ const io::path& CFileSystem::getWorkingDirectory()
 				}
 				if (tmpPath)
 				{
-					WorkingDirectory[FILESYSTEM_NATIVE] = tmpPath;
+					cwd = tmpPath;
 					delete [] tmpPath;
 				}
 			#else
@@ -563,13 +688,15 @@ const io::path& CFileSystem::getWorkingDirectory()
 				}
 				if (tmpPath)
 				{
-					WorkingDirectory[FILESYSTEM_NATIVE] = tmpPath;
+					cwd = tmpPath;
 					delete [] tmpPath;
 				}
 			#endif
 		#endif
 
-		WorkingDirectory[type].validate();
+		cwd.validate();
+		if (cwd != WorkingDirectory[FILESYSTEM_NATIVE])
+			WorkingDirectory[FILESYSTEM_NATIVE] = cwd;
 	}
 
 	return WorkingDirectory[type];
@@ -579,6 +706,7 @@ const io::path& CFileSystem::getWorkingDirectory()
 //! Changes the current Working Directory to the given string.
 bool CFileSystem::changeWorkingDirectoryTo(const io::path& newDirectory)
 {
+	CMutexLock lock(Lock);
 	bool success=false;
 
 	if (FileSystemType != FILESYSTEM_NATIVE)
@@ -819,6 +947,7 @@ path CFileSystem::getRelativeFilename(const path& filename, const path& director
 //! Sets the current file systen type
 EFileSystemType CFileSystem::setFileListSystem(EFileSystemType listType)
 {
+	CMutexLock lock(Lock);
 	EFileSystemType current = FileSystemType;
 	FileSystemType = listType;
 	return current;
@@ -828,6 +957,7 @@ EFileSystemType CFileSystem::setFileListSystem(EFileSystemType listType)
 //! Creates a list of files and directories in the current working directory
 IFileList* CFileSystem::createFileList()
 {
+	CMutexLock lock(Lock);
 	CFileList* r = 0;
 	io::path Path = getWorkingDirectory();
 	Path.replace('\\', '/');
@@ -959,8 +1089,14 @@ IFileList* CFileSystem::createEmptyFileList(const io::path& path, bool ignoreCas
 //! determines if a file exists and would be able to be opened.
 bool CFileSystem::existFile(const io::path& filename) const
 {
+	CMutexLock lock(Lock);
+	u32 fileIndex = 0;
+	const u32 found = findIndexedFile(filename, fileIndex);
+	if (found < FileArchives.size())
+		return true;
+
 	for (u32 i=0; i < FileArchives.size(); ++i)
-		if (FileArchives[i]->getFileList()->findFile(filename)!=-1)
+		if (FileArchiveIndex[i] == EAI_NONE && FileArchives[i]->getFileList()->findFile(filename)!=-1)
 			return true;
 
 #if defined(_MSC_VER)
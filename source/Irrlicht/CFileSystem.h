@@ -7,6 +7,8 @@
 
 #include "IFileSystem.h"
 #include "irrArray.h"
+#include "CFileIndex.h"
+#include "CMutex.h"
 
 namespace irr
 {
@@ -156,6 +158,27 @@ public:
 
 private:
 
+	//! how the files of an archive are found in the index
+	enum E_ARCHIVE_INDEX
+	{
+		//! the archive is asked for each file
+		EAI_NONE = 0,
+		//! files are found by their full name
+		EAI_FULL_NAMES,
+		//! files are found by their name without path
+		EAI_FILE_NAMES
+	};
+
+	//! adds an archive at the end of the search order
+	void appendFileArchive(IFileArchive* archive, E_ARCHIVE_INDEX index);
+
+	//! builds the file index again after archives were removed or moved
+	void rebuildFileIndex();
+
+	//! finds a file in the indexed archives
+	/** \return Index of the archive or the number of archives if not found. */
+	u32 findIndexedFile(const io::path& filename, u32& fileIndex) const;
+
 	// don't expose, needs refactoring
 	bool changeArchivePassword(const path& filename,
 			const core::stringc& password,
@@ -169,6 +192,16 @@ private:
 	core::array<IArchiveLoader*> ArchiveLoader;
 	//! currently attached Archives
 	core::array<IFileArchive*> FileArchives;
+	//! how the files of each archive are found
+	core::array<E_ARCHIVE_INDEX> FileArchiveIndex;
+	//! files of the archives which are indexed with full names
+	CFileIndex FullNameIndex;
+	//! files of the archives which are indexed without paths
+	CFileIndex FileNameIndex;
+
+	//! guards the archives, the archive loaders and the working directory
+	/** Recursive, archive loaders call back into the file system. */
+	mutable CMutex Lock;
 };
 
 
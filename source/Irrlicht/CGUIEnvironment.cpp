@@ -38,6 +38,8 @@
 #include "CGUIProfiler.h"
 
 #include "CDefaultGUIElementFactory.h"
+#include "EProfileIDs.h"
+#include "IProfiler.h"
 #include "IWriteFile.h"
 #include "IXMLWriter.h"
 
@@ -95,6 +97,15 @@ CGUIEnvironment::CGUIEnvironment(io::IFileSystem* fs, video::IVideoDriver* drive
 	// environment is root tab group
 	Environment = this;
 	setTabGroup(true);
+
+	IRR_PROFILE(
+		static bool initProfile = false;
+		if (!initProfile )
+		{
+			initProfile = true;
+			getProfiler().add(EPID_GUI_DRAW_ALL, L"drawAll", L"Irrlicht gui");
+		}
+ 	)
 }
 
 
@@ -193,6 +204,8 @@ void CGUIEnvironment::loadBuiltInFont()
 //! draws all gui elements
 void CGUIEnvironment::drawAll()
 {
+	IRR_PROFILE(CProfileScope p1(EPID_GUI_DRAW_ALL);)
+
 	if (Driver)
 	{
 		core::dimension2d<s32> dim(Driver->getScreenSize());
@@ -6,6 +6,7 @@
 #include "irrString.h"
 #include "CColorConverter.h"
 #include "CBlit.h"
+#include "CThreadPool.h"
 #include "os.h"
 
 namespace irr
@@ -13,6 +14,411 @@ namespace irr
 namespace video
 {
 
+//! pixels scaled by one part of a scaling job
+static const u32 SCALING_BAND_PIXELS = 0x10000;
+
+
+//! scales bands of rows with the nearest source pixels
+struct CImage::SScalingJob : public IThreadJob
+{
+	virtual void runPart(u32 part, u32 thread) _IRR_OVERRIDE_
+	{
+		const u32 srcBpp = Source->BytesPerPixel;
+		const bool convert = (Source->Format != Format);
+
+		// source pixels of a row, if they have to be converted
+		core::array<u8> line;
+		if (convert)
+			line.set_used(Width * srcBpp);
+
+		const u32 end = core::min_(Height, (part + 1) * BandRows);
+		for (u32 y = part * BandRows; y < end; ++y)
+		{
+			const u8* src = Source->Data + Rows[y];
+			u8* dst = convert ? line.pointer() : Target + y * Pitch;
+
+			switch (srcBpp)
+			{
+			case 4:
+				for (u32 x = 0; x < Width; ++x)
+					((u32*)dst)[x] = *(const u32*)(src + Columns[x]);
+				break;
+			case 2:
+				for (u32 x = 0; x < Width; ++x)
+					((u16*)dst)[x] = *(const u16*)(src + Columns[x]);
+				break;
+			default:
+				for (u32 x = 0; x < Width; ++x)
+					memcpy(dst + x * srcBpp, src + Columns[x], srcBpp);
+				break;
+			}
+
+			if (convert)
+				CColorConverter::convert_viaFormat(dst, Source->Format, Width, Target + y * Pitch, Format);
+		}
+	}
+
+	const CImage* Source;
+	u8* Target;
+	ECOLOR_FORMAT Format;
+	u32 Pitch;
+	u32 Width;
+	u32 Height;
+	u32 BandRows;
+	const u32* Columns;
+	const u32* Rows;
+};
+
+
+//! scales bands of rows with a box filter
+struct CImage::SBoxFilterJob : public IThreadJob
+{
+	virtual void runPart(u32 part, u32 thread) _IRR_OVERRIDE_
+	{
+		const u32 end = core::min_(Height, (part + 1) * BandRows);
+		for (u32 y = part * BandRows; y < end; ++y)
+			for (u32 x = 0; x < Width; ++x)
+				Target->setPixel(x, y, Source->getPixelBox(Columns[x], Rows[y], Fx, Fy, Bias), Blend);
+	}
+
+	const CImage* Source;
+	IImage* Target;
+	u32 Width;
+	u32 Height;
+	u32 BandRows;
+	const s32* Columns;
+	const s32* Rows;
+	s32 Fx;
+	s32 Fy;
+	s32 Bias;
+	bool Blend;
+};
+
+
+namespace
+{
+	//! source rows and columns the Kaiser filter reads for one target pixel
+	const u32 KAISER_TAPS = 8;
+
+	//! modified Bessel function of the first kind of order 0
+	f64 besselI0(f64 x)
+	{
+		const f64 q = x * x * 0.25;
+		f64 term = 1.0;
+		f64 sum = 1.0;
+		for (u32 k = 1; k != 32; ++k)
+		{
+			term *= q / (k * k);
+			sum += term;
+		}
+		return sum;
+	}
+
+	//! conversions between sRGB and linear colors, built before main()
+	struct SSRGBTables
+	{
+		SSRGBTables()
+		{
+			for (u32 i = 0; i != 256; ++i)
+			{
+				const f32 c = i / 255.f;
+				ToLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (u32 i = 0; i != 4096; ++i)
+			{
+				const f32 l = i / 4095.f;
+				const f32 c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.f / 2.4f) - 0.055f;
+				FromLinear[i] = (u8) core::s32_clamp(core::round32(c * 255.f), 0, 255);
+			}
+		}
+
+		f32 ToLinear[256];
+		u8 FromLinear[4096];
+	};
+
+	const SSRGBTables SRGBTables;
+
+	//! averages 2x2 pixels of two A8R8G8B8 rows, rounding to nearest
+	inline u32 boxPixel(u32 a, u32 b, u32 c, u32 d)
+	{
+		const u32 rb = (a & 0x00FF00FF) + (b & 0x00FF00FF) + (c & 0x00FF00FF) + (d & 0x00FF00FF) + 0x00020002;
+		const u32 ag = ((a >> 8) & 0x00FF00FF) + ((b >> 8) & 0x00FF00FF) + ((c >> 8) & 0x00FF00FF) + ((d >> 8) & 0x00FF00FF) + 0x00020002;
+		return ((rb >> 2) & 0x00FF00FF) | (((ag >> 2) & 0x00FF00FF) << 8);
+	}
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	//! box filters 4 target pixels at a time while both source columns exist
+	/** \return number of target pixels done */
+	u32 boxRow_SSE2(const u32* row0, const u32* row1, u32 srcWidth, u32* dst, u32 width)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i round = _mm_set1_epi16(2);
+
+		u32 x = 0;
+		for (; x + 4 <= width && 2 * (x + 4) <= srcWidth; x += 4)
+		{
+			const __m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + 2 * x));
+			const __m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + 2 * x + 4));
+			const __m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + 2 * x));
+			const __m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + 2 * x + 4));
+
+			// vertical sums of the 8 source columns, two per register
+			const __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+			const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+			const __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+			const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+			// horizontal sums of the column pairs
+			const __m128i t01 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+			const __m128i t23 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+
+			const __m128i p01 = _mm_srli_epi16(_mm_add_epi16(t01, round), 2);
+			const __m128i p23 = _mm_srli_epi16(_mm_add_epi16(t23, round), 2);
+			_mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(p01, p23));
+		}
+		return x;
+	}
+
+	//! weighted sum of source rows, 4 floats at a time
+	/** \return number of floats done */
+	u32 filterColumns_SSE2(const f32* const* rows, const f32* weights, u32 taps, f32* dst, u32 count)
+	{
+		u32 i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 sum = _mm_mul_ps(_mm_loadu_ps(rows[0] + i), _mm_set1_ps(weights[0]));
+			for (u32 k = 1; k != taps; ++k)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[k] + i), _mm_set1_ps(weights[k])));
+			_mm_storeu_ps(dst + i, sum);
+		}
+		return i;
+	}
+
+	//! weighted sum of the b,g,r,a floats of source pixels
+	inline void filterPixel_SSE2(const f32* const* pixels, const f32* weights, u32 taps, f32* dst)
+	{
+		__m128 sum = _mm_mul_ps(_mm_loadu_ps(pixels[0]), _mm_set1_ps(weights[0]));
+		for (u32 k = 1; k != taps; ++k)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(pixels[k]), _mm_set1_ps(weights[k])));
+		_mm_storeu_ps(dst, sum);
+	}
+#endif
+}
+
+
+//! filters bands of rows of the next mip map level
+struct CImage::SMipMapJob : public IThreadJob
+{
+	virtual void runPart(u32 part, u32 thread) _IRR_OVERRIDE_
+	{
+		const u32 start = part * BandRows;
+		const u32 end = core::min_(Height, start + BandRows);
+
+		if (Taps == 2 && !SRGB)
+			boxRows(start, end);
+		else
+			filterRows(start, end);
+	}
+
+	//! returns a source row as A8R8G8B8, converting it into line if needed
+	const u32* getSourceRow(u32 y, core::array<u32>& line) const
+	{
+		const u8* src = Source->Data + y * Source->Pitch;
+		if (Source->Format == ECF_A8R8G8B8)
+			return (const u32*)src;
+
+		CColorConverter::convert_viaFormat(src, Source->Format, (s32)SourceWidth, line.pointer(), ECF_A8R8G8B8);
+		return line.const_pointer();
+	}
+
+	//! writes a filtered A8R8G8B8 row into the target
+	void setTargetRow(u32 y, const u32* row) const
+	{
+		u8* dst = (u8*)Target->getData() + y * Target->getPitch();
+		if (Target->getColorFormat() == ECF_A8R8G8B8)
+			memcpy(dst, row, Width * 4);
+		else
+			CColorConverter::convert_viaFormat(row, ECF_A8R8G8B8, (s32)Width, dst, Target->getColorFormat());
+	}
+
+	//! 2x2 box filter in integers
+	void boxRows(u32 start, u32 end)
+	{
+		core::array<u32> targetLine;
+		if (Target->getColorFormat() != ECF_A8R8G8B8)
+			targetLine.set_used(Width);
+
+		core::array<u32> line0;
+		core::array<u32> line1;
+		if (Source->Format != ECF_A8R8G8B8)
+		{
+			line0.set_used(SourceWidth);
+			line1.set_used(SourceWidth);
+		}
+
+		for (u32 y = start; y < end; ++y)
+		{
+			const u32* row0 = getSourceRow(2 * y, line0);
+			const u32* row1 = getSourceRow(core::min_(2 * y + 1, SourceHeight - 1), line1);
+
+			u32* dst = targetLine.size() ? targetLine.pointer() : (u32*)((u8*)Target->getData() + y * Target->getPitch());
+
+			u32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			if (UseSSE2)
+				x = boxRow_SSE2(row0, row1, SourceWidth, dst, Width);
+#endif
+			for (; x < Width; ++x)
+			{
+				const u32 x0 = 2 * x;
+				const u32 x1 = core::min_(x0 + 1, SourceWidth - 1);
+				dst[x] = boxPixel(row0[x0], row0[x1], row1[x0], row1[x1]);
+			}
+
+			if (targetLine.size())
+				setTargetRow(y, dst);
+		}
+	}
+
+	//! separable filter in floats, colors in linear space for sRGB
+	void filterRows(u32 start, u32 end)
+	{
+		core::array<u32> line;
+		if (Source->Format != ECF_A8R8G8B8)
+			line.set_used(SourceWidth);
+
+		// source rows as floats in b,g,r,a order, one slot per tap. The rows
+		// of a target row are consecutive, so they never share a slot.
+		core::array<f32> rows(Taps * SourceWidth * 4);
+		rows.set_used(Taps * SourceWidth * 4);
+		s32 rowInSlot[KAISER_TAPS];
+		for (u32 k = 0; k != Taps; ++k)
+			rowInSlot[k] = -1;
+
+		core::array<f32> columns;
+		columns.set_used(SourceWidth * 4);
+
+		core::array<u32> result;
+		result.set_used(Width);
+
+		const f32* tapRows[KAISER_TAPS];
+
+		for (u32 y = start; y < end; ++y)
+		{
+			for (u32 k = 0; k != Taps; ++k)
+			{
+				const s32 sy = core::s32_clamp(2 * (s32)y + Offset + (s32)k, 0, (s32)SourceHeight - 1);
+				const u32 slot = (u32)(2 * (s32)y + Offset + (s32)k + 2 * Taps) % Taps;
+				f32* row = rows.pointer() + slot * SourceWidth * 4;
+				if (rowInSlot[slot] != sy)
+				{
+					convertRow(getSourceRow(sy, line), row);
+					rowInSlot[slot] = sy;
+				}
+				tapRows[k] = row;
+			}
+
+			// vertical pass
+			const u32 count = SourceWidth * 4;
+			u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			if (UseSSE2)
+				i = filterColumns_SSE2(tapRows, Weights, Taps, columns.pointer(), count);
+#endif
+			for (; i < count; ++i)
+			{
+				f32 sum = 0.f;
+				for (u32 k = 0; k != Taps; ++k)
+					sum += tapRows[k][i] * Weights[k];
+				columns[i] = sum;
+			}
+
+			// horizontal pass
+			for (u32 x = 0; x < Width; ++x)
+			{
+				const f32* pixels[KAISER_TAPS];
+				for (u32 k = 0; k != Taps; ++k)
+					pixels[k] = columns.const_pointer() + 4 * core::s32_clamp(2 * (s32)x + Offset + (s32)k, 0, (s32)SourceWidth - 1);
+
+				f32 sum[4];
+#ifdef _IRR_COMPILE_WITH_SSE2_
+				if (UseSSE2)
+					filterPixel_SSE2(pixels, Weights, Taps, sum);
+				else
+#endif
+				{
+					sum[0] = sum[1] = sum[2] = sum[3] = 0.f;
+					for (u32 k = 0; k != Taps; ++k)
+					{
+						sum[0] += pixels[k][0] * Weights[k];
+						sum[1] += pixels[k][1] * Weights[k];
+						sum[2] += pixels[k][2] * Weights[k];
+						sum[3] += pixels[k][3] * Weights[k];
+					}
+				}
+				result[x] = packPixel(sum);
+			}
+
+			setTargetRow(y, result.const_pointer());
+		}
+	}
+
+	//! unpacks a row of A8R8G8B8 pixels to floats in [0;1]
+	void convertRow(const u32* src, f32* dst) const
+	{
+		for (u32 x = 0; x != SourceWidth; ++x, dst += 4)
+		{
+			const u32 c = src[x];
+			if (SRGB)
+			{
+				dst[0] = SRGBTables.ToLinear[c & 0xFF];
+				dst[1] = SRGBTables.ToLinear[(c >> 8) & 0xFF];
+				dst[2] = SRGBTables.ToLinear[(c >> 16) & 0xFF];
+			}
+			else
+			{
+				dst[0] = (c & 0xFF) * (1.f / 255.f);
+				dst[1] = ((c >> 8) & 0xFF) * (1.f / 255.f);
+				dst[2] = ((c >> 16) & 0xFF) * (1.f / 255.f);
+			}
+			dst[3] = (c >> 24) * (1.f / 255.f);
+		}
+	}
+
+	//! packs filtered b,g,r,a floats to A8R8G8B8
+	/** Rounds by truncating, which is the same as round32 for all values
+	not clamped to 0. */
+	u32 packPixel(const f32* c) const
+	{
+		u32 p = (u32)core::s32_clamp((s32)(c[3] * 255.f + 0.5f), 0, 255) << 24;
+		for (u32 i = 0; i != 3; ++i)
+		{
+			const u32 v = SRGB ?
+				SRGBTables.FromLinear[core::s32_clamp((s32)(c[i] * 4095.f + 0.5f), 0, 4095)] :
+				(u32)core::s32_clamp((s32)(c[i] * 255.f + 0.5f), 0, 255);
+			p |= v << (i * 8);
+		}
+		return p;
+	}
+
+	const CImage* Source;
+	IImage* Target;
+	u32 SourceWidth;
+	u32 SourceHeight;
+	u32 Width;
+	u32 Height;
+	u32 BandRows;
+
+	// the taps of a target pixel start Offset source pixels from twice its position
+	u32 Taps;
+	s32 Offset;
+	f32 Weights[KAISER_TAPS];
+
+	bool SRGB;
+	bool UseSSE2;
+};
+
+
 //! Constructor from raw data
 CImage::CImage(ECOLOR_FORMAT format, const core::dimension2d<u32>& size, void* data,
 	bool ownForeignMemory, bool deleteMemory) : IImage(format, size, deleteMemory)
@@ -213,22 +619,42 @@ void CImage::copyToScaling(void* target, u32 width, u32 height, ECOLOR_FORMAT fo
 		}
 	}
 
+	if (Size.Width==width && Size.Height==height)
+	{
+		CColorConverter::convert_viaFormat(Data, Format, Pitch, target, format, pitch, width, height);
+		return;
+	}
+
+	// source offsets of the columns and rows, the steps are summed up
+	// like the scalar walk over the image did
 	const f32 sourceXStep = (f32)Size.Width / (f32)width;
 	const f32 sourceYStep = (f32)Size.Height / (f32)height;
-	s32 yval=0, syval=0;
+	core::array<u32> columns(width);
+	f32 sx = 0.0f;
+	for (u32 x=0; x<width; ++x)
+	{
+		columns.push_back(((s32)sx)*BytesPerPixel);
+		sx+=sourceXStep;
+	}
+	core::array<u32> rows(height);
 	f32 sy = 0.0f;
 	for (u32 y=0; y<height; ++y)
 	{
-		f32 sx = 0.0f;
-		for (u32 x=0; x<width; ++x)
-		{
-			CColorConverter::convert_viaFormat(Data+ syval + ((s32)sx)*BytesPerPixel, Format, 1, ((u8*)target)+ yval + (x*bpp), format);
-			sx+=sourceXStep;
-		}
+		rows.push_back(((s32)sy)*Pitch);
 		sy+=sourceYStep;
-		syval=((s32)sy)*Pitch;
-		yval+=pitch;
 	}
+
+	SScalingJob job;
+	job.Source = this;
+	job.Target = (u8*)target;
+	job.Format = format;
+	job.Pitch = pitch;
+	job.Width = width;
+	job.Height = height;
+	job.BandRows = core::max_(SCALING_BAND_PIXELS / width, 1u);
+	job.Columns = columns.const_pointer();
+	job.Rows = rows.const_pointer();
+	CThreadPool::runShared(&job, (height + job.BandRows - 1) / job.BandRows);
 }
 
 
@@ -271,25 +697,151 @@ void CImage::copyToScalingBoxFilter(IImage* target, s32 bias, bool blend)
 	const f32 sourceXStep = (f32) Size.Width / (f32) destSize.Width;
 	const f32 sourceYStep = (f32) Size.Height / (f32) destSize.Height;
 
+	if (!destSize.Width || !destSize.Height)
+		return;
+
 	target->getData();
 
 	s32 fx = core::ceil32( sourceXStep );
 	s32 fy = core::ceil32( sourceYStep );
-	f32 sx;
-	f32 sy;
 
-	sy = 0.f;
+	core::array<s32> columns(destSize.Width);
+	f32 sx = 0.f;
+	for ( u32 x = 0; x != destSize.Width; ++x )
+	{
+		columns.push_back( core::floor32(sx) );
+		sx += sourceXStep;
+	}
+	core::array<s32> rows(destSize.Height);
+	f32 sy = 0.f;
 	for ( u32 y = 0; y != destSize.Height; ++y )
 	{
-		sx = 0.f;
-		for ( u32 x = 0; x != destSize.Width; ++x )
+		rows.push_back( core::floor32(sy) );
+		sy += sourceYStep;
+	}
+
+	SBoxFilterJob job;
+	job.Source = this;
+	job.Target = target;
+	job.Width = destSize.Width;
+	job.Height = destSize.Height;
+	job.BandRows = core::max_(SCALING_BAND_PIXELS / (destSize.Width * core::max_(fx * fy, 1)), 1u);
+	job.Columns = columns.const_pointer();
+	job.Rows = rows.const_pointer();
+	job.Fx = fx;
+	job.Fy = fy;
+	job.Bias = bias;
+	job.Blend = blend;
+	CThreadPool::runShared(&job, (destSize.Height + job.BandRows - 1) / job.BandRows);
+}
+
+//! filters this image into the next smaller mip map level
+void CImage::copyToMipMap(IImage* target, E_MIP_MAP_FILTER filter, bool sRGB)
+{
+	if (IImage::isCompressedFormat(Format) || IImage::isCompressedFormat(target->getColorFormat()))
+	{
+		os::Printer::log("IImage::copyToMipMap method doesn't work with compressed images.", ELL_WARNING);
+		return;
+	}
+
+	const core::dimension2d<u32> destSize = target->getDimension();
+	if (destSize.Width != core::max_(Size.Width >> 1, 1u) || destSize.Height != core::max_(Size.Height >> 1, 1u))
+	{
+		os::Printer::log("IImage::copyToMipMap target does not have the size of the next mip map level.", ELL_WARNING);
+		return;
+	}
+
+	SMipMapJob job;
+	job.Source = this;
+	job.Target = target;
+	job.SourceWidth = Size.Width;
+	job.SourceHeight = Size.Height;
+	job.Width = destSize.Width;
+	job.Height = destSize.Height;
+	job.SRGB = sRGB;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	job.UseSSE2 = os::Cpu::hasSSE2();
+#else
+	job.UseSSE2 = false;
+#endif
+
+	if (filter == EMMF_KAISER)
+	{
+		// sinc with its first zero 2 source pixels from the center, windowed
+		// over 4 source pixels to each side
+		const f64 beta = 4.0;
+		f64 sum = 0.0;
+		f64 weights[KAISER_TAPS];
+		for (u32 k = 0; k != KAISER_TAPS; ++k)
 		{
-			target->setPixel( x, y,
-				getPixelBox( core::floor32(sx), core::floor32(sy), fx, fy, bias ), blend );
-			sx += sourceXStep;
+			const f64 t = ((f64)k - 3.5) * 0.5;
+			const f64 sinc = core::PI64 * t;
+			const f64 window = 1.0 - (t * t) / 4.0;
+			weights[k] = sin(sinc) / sinc * besselI0(beta * sqrt(window)) / besselI0(beta);
+			sum += weights[k];
 		}
-		sy += sourceYStep;
+		for (u32 k = 0; k != KAISER_TAPS; ++k)
+			job.Weights[k] = (f32)(weights[k] / sum);
+		job.Taps = KAISER_TAPS;
+		job.Offset = -3;
+	}
+	else
+	{
+		job.Weights[0] = 0.5f;
+		job.Weights[1] = 0.5f;
+		job.Taps = 2;
+		job.Offset = 0;
+	}
+
+	// the bands overlap by the taps, so they are not made too small
+	job.BandRows = core::max_(SCALING_BAND_PIXELS / job.Width, 2 * job.Taps);
+	CThreadPool::runShared(&job, (job.Height + job.BandRows - 1) / job.BandRows);
+}
+
+
+//! creates all mip map levels below this image
+void CImage::createMipMaps(E_MIP_MAP_FILTER filter, bool sRGB)
+{
+	if (IImage::isCompressedFormat(Format))
+	{
+		os::Printer::log("IImage::createMipMaps method doesn't work with compressed images.", ELL_WARNING);
+		return;
 	}
+
+	if (Size.Width <= 1 && Size.Height <= 1)
+		return;
+
+	u32 dataSize = 0;
+	core::dimension2d<u32> levelSize(Size);
+	do
+	{
+		levelSize.Width = core::max_(levelSize.Width >> 1, 1u);
+		levelSize.Height = core::max_(levelSize.Height >> 1, 1u);
+		dataSize += getDataSizeFromFormat(Format, levelSize.Width, levelSize.Height);
+	} while (levelSize.Width != 1 || levelSize.Height != 1);
+
+	u8* data = Allocator.allocate(dataSize);
+
+	// each level is filtered from the one above
+	IImage* source = this;
+	source->grab();
+	u8* levelData = data;
+	levelSize = Size;
+	do
+	{
+		levelSize.Width = core::max_(levelSize.Width >> 1, 1u);
+		levelSize.Height = core::max_(levelSize.Height >> 1, 1u);
+
+		IImage* level = new CImage(Format, levelSize, levelData, true, false);
+		source->copyToMipMap(level, filter, sRGB);
+		source->drop();
+		source = level;
+
+		levelData += getDataSizeFromFormat(Format, levelSize.Width, levelSize.Height);
+	} while (levelSize.Width != 1 || levelSize.Height != 1);
+	source->drop();
+
+	setMipMapsData(data, true, true);
 }
 
 
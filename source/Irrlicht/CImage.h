@@ -58,8 +58,19 @@ public:
 	//! fills the surface with given color
 	virtual void fill(const SColor &color) _IRR_OVERRIDE_;
 
+	//! filters this image into the next smaller mip map level
+	virtual void copyToMipMap(IImage* target, E_MIP_MAP_FILTER filter=EMMF_BOX, bool sRGB=false) _IRR_OVERRIDE_;
+
+	//! creates all mip map levels below this image
+	virtual void createMipMaps(E_MIP_MAP_FILTER filter=EMMF_BOX, bool sRGB=false) _IRR_OVERRIDE_;
+
 private:
 	inline SColor getPixelBox ( s32 x, s32 y, s32 fx, s32 fy, s32 bias ) const;
+
+	//! jobs for scaling bands of rows on several threads
+	struct SScalingJob;
+	struct SBoxFilterJob;
+	struct SMipMapJob;
 };
 
 } // end namespace video
@@ -0,0 +1,327 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInstancedMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "IMaterialRenderer.h"
+
+namespace irr
+{
+namespace scene
+{
+
+
+//! constructor
+CInstancedMeshSceneNode::CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: IInstancedMeshSceneNode(parent, mgr, id, position, rotation, scale),
+	BoxDirty(false), WorldTransformsDirty(true), Mesh(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CInstancedMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CInstancedMeshSceneNode::~CInstancedMeshSceneNode()
+{
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! frame
+void CInstancedMeshSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible && Mesh && !Transforms.empty())
+	{
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+		bool solid = false;
+		bool transparent = false;
+
+		for (u32 i=0; i<Materials.size(); ++i)
+		{
+			video::IMaterialRenderer* rnd =
+				driver->getMaterialRenderer(Materials[i].MaterialType);
+
+			if ((rnd && rnd->isTransparent()) || Materials[i].isTransparent())
+				transparent = true;
+			else
+				solid = true;
+		}
+
+		if (solid)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+		if (transparent)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+	}
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+
+//! updates the bounding box if instances were changed
+void CInstancedMeshSceneNode::OnAnimate(u32 timeMs)
+{
+	// before culling, which may ask for the box on other threads
+	if (BoxDirty)
+		recalculateBoundingBox();
+
+	ISceneNode::OnAnimate(timeMs);
+}
+
+
+//! renders the node.
+void CInstancedMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!Mesh || !driver || Transforms.empty())
+		return;
+
+	const bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	updateWorldTransforms();
+
+	for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+	{
+		scene::IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+		if (!mb)
+			continue;
+
+		const video::SMaterial& material = Materials[i];
+		video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+		const bool transparent = (rnd && rnd->isTransparent());
+
+		// only render transparent buffer if this is the transparent render pass
+		// and solid only in solid pass
+		if (transparent == isTransparentPass)
+		{
+			driver->setMaterial(material);
+			driver->drawMeshBufferInstanced(mb, WorldTransforms.const_pointer(),
+				Colors.const_pointer(), WorldTransforms.size());
+		}
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible & scene::EDS_BBOX)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		driver->setMaterial(m);
+		driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+		driver->draw3DBox(getBoundingBox(), video::SColor(255,255,255,255));
+	}
+}
+
+
+//! updates the world transformations of the instances if needed
+void CInstancedMeshSceneNode::updateWorldTransforms()
+{
+	if (!WorldTransformsDirty && WorldTransformsBase == AbsoluteTransformation)
+		return;
+
+	WorldTransforms.set_used(Transforms.size());
+	for (u32 i=0; i<Transforms.size(); ++i)
+		WorldTransforms[i].setbyproduct_nocheck(AbsoluteTransformation, Transforms[i]);
+
+	WorldTransformsBase = AbsoluteTransformation;
+	WorldTransformsDirty = false;
+}
+
+
+//! recalculates the bounding box around all instances
+void CInstancedMeshSceneNode::recalculateBoundingBox() const
+{
+	BoxDirty = false;
+
+	if (!Mesh || Transforms.empty())
+	{
+		Box.reset(0.f, 0.f, 0.f);
+		return;
+	}
+
+	const core::aabbox3d<f32>& meshBox = Mesh->getBoundingBox();
+	for (u32 i=0; i<Transforms.size(); ++i)
+	{
+		core::aabbox3d<f32> box(meshBox);
+		Transforms[i].transformBoxEx(box);
+
+		if (0 == i)
+			Box = box;
+		else
+			Box.addInternalBox(box);
+	}
+}
+
+
+//! returns the axis aligned bounding box of all instances
+const core::aabbox3d<f32>& CInstancedMeshSceneNode::getBoundingBox() const
+{
+	if (BoxDirty)
+		recalculateBoundingBox();
+
+	return Box;
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CInstancedMeshSceneNode::getMaterial(u32 i)
+{
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CInstancedMeshSceneNode::getMaterialCount() const
+{
+	return Materials.size();
+}
+
+
+//! Sets a new mesh
+void CInstancedMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (!mesh)
+		return;
+
+	mesh->grab();
+	if (Mesh)
+		Mesh->drop();
+
+	Mesh = mesh;
+
+	Materials.clear();
+	for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+	{
+		IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+		if (mb)
+			Materials.push_back(mb->getMaterial());
+		else
+			Materials.push_back(video::SMaterial());
+	}
+
+	BoxDirty = true;
+}
+
+
+//! Adds an instance of the mesh
+u32 CInstancedMeshSceneNode::addInstance(const core::matrix4& transform, video::SColor color)
+{
+	Transforms.push_back(transform);
+	Colors.push_back(color);
+	WorldTransformsDirty = true;
+
+	// only grow the box, walking all instances would make adding them quadratic
+	if (Mesh && !BoxDirty)
+	{
+		core::aabbox3d<f32> box(Mesh->getBoundingBox());
+		transform.transformBoxEx(box);
+
+		if (1 == Transforms.size())
+			Box = box;
+		else
+			Box.addInternalBox(box);
+	}
+
+	return Transforms.size() - 1;
+}
+
+
+//! Changes an instance
+void CInstancedMeshSceneNode::setInstance(u32 index, const core::matrix4& transform, video::SColor color)
+{
+	if (index >= Transforms.size())
+		return;
+
+	Transforms[index] = transform;
+	Colors[index] = color;
+	WorldTransformsDirty = true;
+
+	// the box may shrink, walk the instances once when it is needed
+	BoxDirty = true;
+}
+
+
+//! Removes an instance
+void CInstancedMeshSceneNode::removeInstance(u32 index)
+{
+	if (index >= Transforms.size())
+		return;
+
+	const u32 last = Transforms.size() - 1;
+	Transforms[index] = Transforms[last];
+	Colors[index] = Colors[last];
+	Transforms.erase(last);
+	Colors.erase(last);
+
+	WorldTransformsDirty = true;
+	BoxDirty = true;
+}
+
+
+//! Removes all instances
+void CInstancedMeshSceneNode::removeAllInstances()
+{
+	Transforms.clear();
+	Colors.clear();
+	WorldTransforms.clear();
+	WorldTransformsDirty = true;
+	Box.reset(0.f, 0.f, 0.f);
+	BoxDirty = false;
+}
+
+
+//! Get the transformation of an instance, relative to the node
+const core::matrix4& CInstancedMeshSceneNode::getInstanceTransform(u32 index) const
+{
+	return Transforms[index];
+}
+
+
+//! Get the color of an instance
+video::SColor CInstancedMeshSceneNode::getInstanceColor(u32 index) const
+{
+	return Colors[index];
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CInstancedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CInstancedMeshSceneNode* nb = new CInstancedMeshSceneNode(Mesh, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->Materials = Materials;
+	nb->Transforms = Transforms;
+	nb->Colors = Colors;
+	nb->Box = Box;
+	nb->BoxDirty = BoxDirty;
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,109 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IInstancedMeshSceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	class CInstancedMeshSceneNode : public IInstancedMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CInstancedMeshSceneNode();
+
+		//! frame
+		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
+
+		//! updates the bounding box if instances were changed
+		virtual void OnAnimate(u32 timeMs) _IRR_OVERRIDE_;
+
+		//! renders the node.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! returns the axis aligned bounding box of all instances
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i) _IRR_OVERRIDE_;
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const _IRR_OVERRIDE_;
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_INSTANCED_MESH; }
+
+		//! Sets a new mesh
+		virtual void setMesh(IMesh* mesh) _IRR_OVERRIDE_;
+
+		//! Returns the current mesh
+		virtual IMesh* getMesh(void) _IRR_OVERRIDE_ { return Mesh; }
+
+		//! Adds an instance of the mesh
+		virtual u32 addInstance(const core::matrix4& transform, video::SColor color) _IRR_OVERRIDE_;
+
+		//! Changes an instance
+		virtual void setInstance(u32 index, const core::matrix4& transform, video::SColor color) _IRR_OVERRIDE_;
+
+		//! Removes an instance
+		virtual void removeInstance(u32 index) _IRR_OVERRIDE_;
+
+		//! Removes all instances
+		virtual void removeAllInstances() _IRR_OVERRIDE_;
+
+		//! Get the number of instances
+		virtual u32 getInstanceCount() const _IRR_OVERRIDE_ { return Transforms.size(); }
+
+		//! Get the transformation of an instance, relative to the node
+		virtual const core::matrix4& getInstanceTransform(u32 index) const _IRR_OVERRIDE_;
+
+		//! Get the color of an instance
+		virtual video::SColor getInstanceColor(u32 index) const _IRR_OVERRIDE_;
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) _IRR_OVERRIDE_;
+
+	protected:
+
+		//! updates the world transformations of the instances if needed
+		void updateWorldTransforms();
+
+		//! recalculates the bounding box around all instances
+		void recalculateBoundingBox() const;
+
+		core::array<video::SMaterial> Materials;
+
+		//! recalculated when it is needed after instances were changed or removed
+		mutable core::aabbox3d<f32> Box;
+		mutable bool BoxDirty;
+
+		core::array<core::matrix4> Transforms;
+		core::array<video::SColor> Colors;
+
+		//! instance transformations multiplied with the node transformation
+		core::array<core::matrix4> WorldTransforms;
+		core::matrix4 WorldTransformsBase;
+		bool WorldTransformsDirty;
+
+		IMesh* Mesh;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
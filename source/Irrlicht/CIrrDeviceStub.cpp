@@ -13,6 +13,7 @@
 #include "CLogger.h"
 #include "irrString.h"
 #include "IRandomizer.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -44,6 +45,9 @@ CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 	FileSystem = io::createFileSystem();
 	VideoModeList = new video::CVideoModeList();
 
+	// the shared thread pool lives as long as a device
+	CThreadPool::grabSharedPool();
+
 	core::stringc s = "Irrlicht Engine version ";
 	s.append(getVersion());
 	os::Printer::log(s.c_str(), ELL_INFORMATION);
@@ -88,6 +92,8 @@ CIrrDeviceStub::~CIrrDeviceStub()
 	if (Timer)
 		Timer->drop();
 
+	CThreadPool::dropSharedPool();
+
 	if (Logger->drop())
 		os::Printer::Logger = 0;
 }
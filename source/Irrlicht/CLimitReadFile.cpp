@@ -3,6 +3,8 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CLimitReadFile.h"
+#include "CMappedReadFile.h"
+#include "CMutex.h"
 #include "irrString.h"
 
 namespace irr
@@ -10,6 +12,13 @@ namespace irr
 namespace io
 {
 
+namespace
+{
+	//! guards the archive files shared by entries on several threads
+	/** Recursive, the archive file can itself be a part of a shared file. */
+	CMutex SharedFileLock(true);
+}
+
 
 CLimitReadFile::CLimitReadFile(IReadFile* alreadyOpenedFile, long pos,
 		long areaSize, const io::path& name)
@@ -22,7 +31,7 @@ CLimitReadFile::CLimitReadFile(IReadFile* alreadyOpenedFile, long pos,
 
 	if (File)
 	{
-		File->grab();
+		grabSharedFile(File);
 		AreaStart = pos;
 		AreaEnd = AreaStart + areaSize;
 	}
@@ -32,7 +41,7 @@ CLimitReadFile::CLimitReadFile(IReadFile* alreadyOpenedFile, long pos,
 CLimitReadFile::~CLimitReadFile()
 {
 	if (File)
-		File->drop();
+		dropSharedFile(File);
 }
 
 
@@ -47,8 +56,7 @@ size_t CLimitReadFile::read(void* buffer, size_t sizeToRead)
 	long toRead = core::min_(AreaEnd, r + (long)sizeToRead) - core::max_(AreaStart, r);
 	if (toRead < 0)
 		return 0;
-	File->seek(r);
-	r = (long)File->read(buffer, toRead);
+	r = (long)readSharedFile(File, r, buffer, toRead);
 	Pos += r;
 	return r;
 #else
@@ -116,8 +124,36 @@ const io::path& CLimitReadFile::getFileName() const
 }
 
 
+void grabSharedFile(IReadFile* file)
+{
+	CMutexLock lock(SharedFileLock);
+	file->grab();
+}
+
+
+void dropSharedFile(IReadFile* file)
+{
+	CMutexLock lock(SharedFileLock);
+	file->drop();
+}
+
+
+size_t readSharedFile(IReadFile* file, long pos, void* buffer, size_t sizeToRead)
+{
+	CMutexLock lock(SharedFileLock);
+	if (!file->seek(pos))
+		return 0;
+	return file->read(buffer, sizeToRead);
+}
+
+
 IReadFile* createLimitReadFile(const io::path& fileName, IReadFile* alreadyOpenedFile, long pos, long areaSize)
 {
+	// parts of files in memory are used without copying them
+	IReadFile* view = CMappedReadFile::createView(alreadyOpenedFile, pos, areaSize, fileName);
+	if (view)
+		return view;
+
 	return new CLimitReadFile(alreadyOpenedFile, pos, areaSize, fileName);
 }
 
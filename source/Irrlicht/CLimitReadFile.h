@@ -61,6 +61,20 @@ namespace io
 		IReadFile* File;
 	};
 
+	//! grabs a file which the entries of an archive share
+	/** Entries are read and dropped on any thread, so the reference count
+	of the archive file is only changed with the shared file lock held. */
+	void grabSharedFile(IReadFile* file);
+
+	//! drops a file which the entries of an archive share
+	void dropSharedFile(IReadFile* file);
+
+	//! reads from a file which the entries of an archive share
+	/** Seeks to pos and reads with the shared file lock held, so the
+	position of the file is never changed by another thread in between.
+	\return Number of bytes read. */
+	size_t readSharedFile(IReadFile* file, long pos, void* buffer, size_t sizeToRead);
+
 } // end namespace io
 } // end namespace irr
 
@@ -0,0 +1,165 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMappedReadFile.h"
+#include "CLimitReadFile.h"
+
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+
+CMappedReadFile::CMappedReadFile(const void* memory, long len, const io::path& fileName,
+		void* mapping, size_t mappingSize, IReadFile* owner)
+: Buffer((const c8*)memory), Len(len), Pos(0), Filename(fileName),
+	Mapping(mapping), MappingSize(mappingSize), Owner(owner)
+{
+	#ifdef _DEBUG
+	setDebugName("CMappedReadFile");
+	#endif
+
+	if (Owner)
+		grabSharedFile(Owner);
+}
+
+
+CMappedReadFile::~CMappedReadFile()
+{
+#ifdef _IRR_COMPILE_WITH_MAPPED_FILES_
+	if (Mapping)
+		munmap(Mapping, MappingSize);
+#endif
+
+	if (Owner)
+		dropSharedFile(Owner);
+}
+
+
+//! returns how much was read
+size_t CMappedReadFile::read(void* buffer, size_t sizeToRead)
+{
+	long amount = static_cast<long>(sizeToRead);
+	if (Pos + amount > Len)
+		amount = Len - Pos;
+
+	if (amount <= 0)
+		return 0;
+
+	memcpy(buffer, Buffer + Pos, amount);
+	Pos += amount;
+
+	return static_cast<size_t>(amount);
+}
+
+
+//! changes position in file, returns true if successful
+bool CMappedReadFile::seek(long finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+		finalPos += Pos;
+
+	if (finalPos < 0 || finalPos > Len)
+		return false;
+
+	Pos = finalPos;
+	return true;
+}
+
+
+//! returns size of file
+long CMappedReadFile::getSize() const
+{
+	return Len;
+}
+
+
+//! returns where in the file we are.
+long CMappedReadFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CMappedReadFile::getFileName() const
+{
+	return Filename;
+}
+
+
+//! maps a file from disk into memory
+IReadFile* CMappedReadFile::createMappedReadFile(const io::path& fileName)
+{
+#if defined(_IRR_COMPILE_WITH_MAPPED_FILES_) && !defined(_IRR_WCHAR_FILESYSTEM)
+	if (fileName.empty())
+		return 0;
+
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd == -1)
+		return 0;
+
+	// only regular files can be mapped, an empty mapping is not possible
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+	{
+		close(fd);
+		return 0;
+	}
+
+	const size_t size = (size_t)st.st_size;
+	void* mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// the mapping stays valid without the descriptor
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		return 0;
+
+	return new CMappedReadFile(mapping, (long)size, fileName, mapping, size, 0);
+#else
+	return 0;
+#endif
+}
+
+
+//! creates a view on a part of a file which is in memory
+IReadFile* CMappedReadFile::createView(IReadFile* file, long pos, long areaSize, const io::path& fileName)
+{
+	const c8* memory = (const c8*)getFileMemory(file);
+	if (!memory || pos < 0 || areaSize < 0 || pos + areaSize > file->getSize())
+		return 0;
+
+	return new CMappedReadFile(memory + pos, areaSize, fileName, 0, 0, file);
+}
+
+
+//! returns the contents of a file which is in memory, or 0
+const void* CMappedReadFile::getFileMemory(IReadFile* file)
+{
+	if (!file)
+		return 0;
+
+	switch (file->getType())
+	{
+	case ERFT_MEMORY_READ_FILE:
+	case ERFT_MAPPED_READ_FILE:
+		return static_cast<IMemoryReadFile*>(file)->getBuffer();
+	default:
+		return 0;
+	}
+}
+
+
+} // end namespace io
+} // end namespace irr
+
@@ -0,0 +1,89 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_MAPPED_READ_FILE_H_INCLUDED__
+#define __C_MAPPED_READ_FILE_H_INCLUDED__
+
+#include "IMemoryReadFile.h"
+#include "irrString.h"
+
+namespace irr
+{
+
+namespace io
+{
+
+	/*!
+		Class for reading a file which is mapped into memory, or a part
+		of another file which is already in memory. The contents are
+		never copied, getBuffer() points into the mapping.
+	*/
+	class CMappedReadFile : public IMemoryReadFile
+	{
+	public:
+
+		//! Destructor
+		virtual ~CMappedReadFile();
+
+		//! returns how much was read
+		virtual size_t read(void* buffer, size_t sizeToRead) _IRR_OVERRIDE_;
+
+		//! changes position in file, returns true if successful
+		virtual bool seek(long finalPos, bool relativeMovement = false) _IRR_OVERRIDE_;
+
+		//! returns size of file
+		virtual long getSize() const _IRR_OVERRIDE_;
+
+		//! returns where in the file we are.
+		virtual long getPos() const _IRR_OVERRIDE_;
+
+		//! returns name of file
+		virtual const io::path& getFileName() const _IRR_OVERRIDE_;
+
+		//! Get the type of the class implementing this interface
+		virtual EREAD_FILE_TYPE getType() const _IRR_OVERRIDE_
+		{
+			return ERFT_MAPPED_READ_FILE;
+		}
+
+		//! Get direct access to the mapped memory
+		virtual const void *getBuffer() const _IRR_OVERRIDE_
+		{
+			return Buffer;
+		}
+
+		//! maps a file from disk into memory
+		/** \return 0 if mapping is not supported or failed, e.g. for empty
+		files. Use CReadFile then. */
+		static IReadFile* createMappedReadFile(const io::path& fileName);
+
+		//! creates a view on a part of a file which is in memory
+		/** The view keeps the file alive.
+		\return 0 if the file is not in memory or the area exceeds it. */
+		static IReadFile* createView(IReadFile* file, long pos, long areaSize, const io::path& fileName);
+
+		//! returns the contents of a file which is in memory, or 0
+		static const void* getFileMemory(IReadFile* file);
+
+	private:
+
+		CMappedReadFile(const void* memory, long len, const io::path& fileName, void* mapping, size_t mappingSize, IReadFile* owner);
+
+		const c8* Buffer;
+		long Len;
+		long Pos;
+		io::path Filename;
+
+		//! mapping to unmap when dropped
+		void* Mapping;
+		size_t MappingSize;
+
+		//! file which owns the memory of a view
+		IReadFile* Owner;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
@@ -54,6 +54,11 @@ void CMeshSceneNode::OnRegisterSceneNode()
 {
 	if (IsVisible)
 	{
+		// render() is not called for nodes with only solid buffers, so the
+		// box is updated before the node is culled
+		if (Mesh)
+			Box = Mesh->getBoundingBox();
+
 		// because this node supports rendering of mixed mode meshes consisting of
 		// transparent and solid material at the same time, we need to go through all
 		// materials, check of what type they are and register this node for the right
@@ -106,7 +111,34 @@ void CMeshSceneNode::OnRegisterSceneNode()
 		// register according to material types counted
 
 		if (solidCount)
-			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+		{
+			// plain meshes hand their solid buffers to the scene manager,
+			// which sorts them by material together with all other solid
+			// buffers of the scene. Shadows and debug data need render().
+			// Static nodes may be drawn by a batch of the scene manager.
+			if (getType() == ESNT_MESH && Mesh && !Shadow && !DebugDataVisible)
+			{
+				if (!SceneManager->registerMeshForStaticBatching(this) &&
+					!SceneManager->isCulled(this))
+				{
+					for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+					{
+						scene::IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+						if (!mb)
+							continue;
+
+						const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+						video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+
+						// same test as in render()
+						if (!(rnd && rnd->isTransparent()))
+							SceneManager->registerMeshBufferForRendering(this, mb, material);
+					}
+				}
+			}
+			else
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+		}
 
 		if (transparentCount)
 			SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
@@ -130,7 +162,6 @@ void CMeshSceneNode::render()
 	++PassCount;
 
 	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
-	Box = Mesh->getBoundingBox();
 
 	if (Shadow && PassCount==1)
 		Shadow->updateShadowVolumes();
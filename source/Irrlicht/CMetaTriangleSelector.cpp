@@ -134,6 +134,91 @@ void CMetaTriangleSelector::getTriangles(core::triangle3df* triangles, s32 array
 }
 
 
+//! Check if all selectors find triangles by traversing a hierarchy.
+bool CMetaTriangleSelector::hasHierarchy() const
+{
+	if (TriangleSelectors.empty())
+		return false;
+
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+		if (!TriangleSelectors[i]->hasHierarchy())
+			return false;
+
+	return true;
+}
+
+
+//! Finds the triangle which a line hits first.
+bool CMetaTriangleSelector::getCollisionPoint(const core::line3d<f32>& line,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle,
+		SCollisionTriangleRange* outTriangleInfo) const
+{
+	f32 nearest = FLT_MAX;
+	core::vector3df intersection;
+	core::triangle3df triangle;
+	SCollisionTriangleRange info;
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	{
+		if (TriangleSelectors[i]->getCollisionPoint(line, intersection, triangle, &info))
+		{
+			const f32 distance = intersection.getDistanceFromSQ(line.start);
+			if (distance < nearest)
+			{
+				nearest = distance;
+				outIntersection = intersection;
+				outTriangle = triangle;
+				if (outTriangleInfo)
+					*outTriangleInfo = info;
+			}
+		}
+	}
+
+	return nearest != FLT_MAX;
+}
+
+
+//! Checks for many lines at once whether they hit a triangle.
+u32 CMetaTriangleSelector::getLineHits(const core::line3d<f32>* lines, u32 lineCount,
+		bool* outHits) const
+{
+	for (u32 l=0; l<lineCount; ++l)
+		outHits[l] = false;
+
+	core::array<bool> hits;
+	hits.set_used(lineCount);
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	{
+		if (TriangleSelectors[i]->getLineHits(lines, lineCount, hits.pointer()))
+		{
+			for (u32 l=0; l<lineCount; ++l)
+				outHits[l] |= hits[l];
+		}
+	}
+
+	u32 count = 0;
+	for (u32 l=0; l<lineCount; ++l)
+		if (outHits[l])
+			++count;
+
+	return count;
+}
+
+
+//! Passes the triangles which may lie within a box to a callback.
+bool CMetaTriangleSelector::visitTriangles(ITriangleCallback& callback,
+		const core::aabbox3d<f32>& box, const core::matrix4* transform,
+		bool useNodeTransform) const
+{
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	{
+		if (!TriangleSelectors[i]->visitTriangles(callback, box, transform, useNodeTransform))
+			return false;
+	}
+
+	return true;
+}
+
+
 //! Adds a triangle selector to the collection of triangle selectors
 //! in this metaTriangleSelector.
 void CMetaTriangleSelector::addTriangleSelector(ITriangleSelector* toAdd)
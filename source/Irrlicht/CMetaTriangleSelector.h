@@ -44,6 +44,23 @@ public:
 		const core::matrix4* transform,	bool useNodeTransform, 
 		irr::core::array<SCollisionTriangleRange>* outTriangleInfo) const _IRR_OVERRIDE_;
 
+	//! Check if all selectors find triangles by traversing a hierarchy.
+	virtual bool hasHierarchy() const _IRR_OVERRIDE_;
+
+	//! Finds the triangle which a line hits first.
+	virtual bool getCollisionPoint(const core::line3d<f32>& line,
+		core::vector3df& outIntersection, core::triangle3df& outTriangle,
+		SCollisionTriangleRange* outTriangleInfo) const _IRR_OVERRIDE_;
+
+	//! Checks for many lines at once whether they hit a triangle.
+	virtual u32 getLineHits(const core::line3d<f32>* lines, u32 lineCount,
+		bool* outHits) const _IRR_OVERRIDE_;
+
+	//! Passes the triangles which may lie within a box to a callback.
+	virtual bool visitTriangles(ITriangleCallback& callback,
+		const core::aabbox3d<f32>& box, const core::matrix4* transform,
+		bool useNodeTransform) const _IRR_OVERRIDE_;
+
 	//! Adds a triangle selector to the collection of triangle selectors
 	//! in this metaTriangleSelector.
 	virtual void addTriangleSelector(ITriangleSelector* toAdd) _IRR_OVERRIDE_;
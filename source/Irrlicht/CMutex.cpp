@@ -0,0 +1,142 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMutex.h"
+
+#if defined(_IRR_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <pthread.h>
+#endif
+
+namespace irr
+{
+
+#if defined(_IRR_WINDOWS_API_)
+
+struct CMutex::SMutexData
+{
+	CRITICAL_SECTION Lock;
+};
+
+CMutex::CMutex(bool recursive)
+: Data(new SMutexData)
+{
+	// critical sections are always recursive
+	(void)recursive;
+	InitializeCriticalSection(&Data->Lock);
+}
+
+CMutex::~CMutex()
+{
+	DeleteCriticalSection(&Data->Lock);
+	delete Data;
+}
+
+void CMutex::lock()
+{
+	EnterCriticalSection(&Data->Lock);
+}
+
+void CMutex::unlock()
+{
+	LeaveCriticalSection(&Data->Lock);
+}
+
+struct CCondition::SConditionData
+{
+	CONDITION_VARIABLE Changed;
+};
+
+CCondition::CCondition()
+: Data(new SConditionData)
+{
+	InitializeConditionVariable(&Data->Changed);
+}
+
+CCondition::~CCondition()
+{
+	delete Data;
+}
+
+void CCondition::wait(CMutex& mutex)
+{
+	SleepConditionVariableCS(&Data->Changed, &mutex.Data->Lock, INFINITE);
+}
+
+void CCondition::notifyAll()
+{
+	WakeAllConditionVariable(&Data->Changed);
+}
+
+#else
+
+struct CMutex::SMutexData
+{
+	pthread_mutex_t Lock;
+};
+
+CMutex::CMutex(bool recursive)
+: Data(new SMutexData)
+{
+	if (recursive)
+	{
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(&Data->Lock, &attr);
+		pthread_mutexattr_destroy(&attr);
+	}
+	else
+		pthread_mutex_init(&Data->Lock, 0);
+}
+
+CMutex::~CMutex()
+{
+	pthread_mutex_destroy(&Data->Lock);
+	delete Data;
+}
+
+void CMutex::lock()
+{
+	pthread_mutex_lock(&Data->Lock);
+}
+
+void CMutex::unlock()
+{
+	pthread_mutex_unlock(&Data->Lock);
+}
+
+struct CCondition::SConditionData
+{
+	pthread_cond_t Changed;
+};
+
+CCondition::CCondition()
+: Data(new SConditionData)
+{
+	pthread_cond_init(&Data->Changed, 0);
+}
+
+CCondition::~CCondition()
+{
+	pthread_cond_destroy(&Data->Changed);
+	delete Data;
+}
+
+void CCondition::wait(CMutex& mutex)
+{
+	pthread_cond_wait(&Data->Changed, &mutex.Data->Lock);
+}
+
+void CCondition::notifyAll()
+{
+	pthread_cond_broadcast(&Data->Changed);
+}
+
+#endif
+
+} // end namespace irr
+
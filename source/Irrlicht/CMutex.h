@@ -0,0 +1,100 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_MUTEX_H_INCLUDED__
+#define __C_MUTEX_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+
+namespace irr
+{
+
+//! Mutex for short critical sections of engine internals
+/** Not recursive by default, a thread must not lock it twice then. */
+class CMutex
+{
+public:
+
+	//! constructor
+	/** \param recursive The thread holding the mutex may lock it again,
+	and has to unlock it as often. */
+	explicit CMutex(bool recursive=false);
+
+	//! destructor
+	~CMutex();
+
+	//! waits until no other thread holds the mutex and takes it
+	void lock();
+
+	//! releases the mutex
+	void unlock();
+
+private:
+
+	// not copyable
+	CMutex(const CMutex& other);
+	CMutex& operator=(const CMutex& other);
+
+	friend class CCondition;
+
+	struct SMutexData;
+	SMutexData* Data;
+};
+
+//! Lets threads holding a mutex wait until another thread changed something
+class CCondition
+{
+public:
+
+	//! constructor
+	CCondition();
+
+	//! destructor
+	~CCondition();
+
+	//! releases the mutex, waits for a notification and takes the mutex again
+	/** The mutex must be locked once by the calling thread. The wait may
+	also end without a notification, so check the waited for state again. */
+	void wait(CMutex& mutex);
+
+	//! wakes all threads waiting on the condition
+	void notifyAll();
+
+private:
+
+	// not copyable
+	CCondition(const CCondition& other);
+	CCondition& operator=(const CCondition& other);
+
+	struct SConditionData;
+	SConditionData* Data;
+};
+
+//! Holds a mutex for the lifetime of a scope
+class CMutexLock
+{
+public:
+
+	CMutexLock(CMutex& mutex) : Mutex(mutex)
+	{
+		Mutex.lock();
+	}
+
+	~CMutexLock()
+	{
+		Mutex.unlock();
+	}
+
+private:
+
+	CMutexLock(const CMutexLock& other);
+	CMutexLock& operator=(const CMutexLock& other);
+
+	CMutex& Mutex;
+};
+
+} // end namespace irr
+
+#endif
+
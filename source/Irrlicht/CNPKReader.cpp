@@ -8,6 +8,7 @@
 
 #ifdef __IRR_COMPILE_WITH_NPK_ARCHIVE_LOADER_
 
+#include "CLimitReadFile.h"
 #include "os.h"
 #include "coreutil.h"
 
@@ -112,7 +113,7 @@ CNPKReader::CNPKReader(IReadFile* file, bool ignoreCase, bool ignorePaths)
 
 	if (File)
 	{
-		File->grab();
+		grabSharedFile(File);
 		if (scanLocalHeader())
 			sort();
 		else
@@ -124,7 +125,7 @@ CNPKReader::CNPKReader(IReadFile* file, bool ignoreCase, bool ignorePaths)
 CNPKReader::~CNPKReader()
 {
 	if (File)
-		File->drop();
+		dropSharedFile(File);
 }
 
 
@@ -16,6 +16,8 @@
 #include "CColorConverter.h"
 #include "IAttributeExchangingObject.h"
 #include "IRenderTarget.h"
+#include "EProfileIDs.h"
+#include "IProfiler.h"
 
 
 namespace irr
@@ -88,7 +90,8 @@ IImageWriter* createImageWriterPPM();
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
 	: SharedRenderTarget(0), CurrentRenderTarget(0), CurrentRenderTargetSize(0, 0), FileSystem(io), MeshManipulator(0),
 	ViewPort(0, 0, 0, 0), ScreenSize(screenSize), PrimitivesDrawn(0), MinVertexCountForVBO(500),
-	TextureCreationFlags(0), OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
+	TextureCreationFlags(0), FrameStatsWritten(0), FrameBeginTime(0), FrameEndTime(0), FrameCount(0), TextureMemoryBudget(0), AsyncLoader(0),
+	OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CNullDriver");
@@ -116,11 +119,24 @@ CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& scre
 	setTextureCreationFlag(ETCF_CREATE_MIP_MAPS, true);
 	setTextureCreationFlag(ETCF_ALLOW_MEMORY_COPY, true);
 
+	setFrameStatsHistorySize(128);
+
+	IRR_PROFILE(
+		static bool initProfile = false;
+		if (!initProfile )
+		{
+			initProfile = true;
+			getProfiler().add(EPID_VD_LOAD_TEXTURE, L"load texture", L"Irrlicht video");
+		}
+ 	)
+
 	ViewPort = core::rect<s32>(core::position2d<s32>(0,0), core::dimension2di(screenSize));
 
 	// create manipulator
 	MeshManipulator = new scene::CMeshManipulator();
 
+	AsyncLoader = new CAsyncLoader();
+
 	if (FileSystem)
 		FileSystem->grab();
 
@@ -212,6 +228,10 @@ CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& scre
 //! destructor
 CNullDriver::~CNullDriver()
 {
+	// requests still use the driver
+	AsyncLoader->finishAllRequests();
+	AsyncLoader->drop();
+
 	if (DriverAttributes)
 		DriverAttributes->drop();
 
@@ -320,12 +340,32 @@ bool CNullDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth, u
 {
 	core::clearFPUException();
 	PrimitivesDrawn = 0;
+	FrameStats = SFrameStats();
+	FrameBeginTime = os::Timer::getRealTimeMicroseconds();
+
+	if (AsyncLoader->getFrameBudget())
+		AsyncLoader->finishRequests(AsyncLoader->getFrameBudget());
+
 	return true;
 }
 
 bool CNullDriver::endScene()
 {
 	FPSCounter.registerFrame(os::Timer::getRealTime(), PrimitivesDrawn);
+
+	const u64 now = os::Timer::getRealTimeMicroseconds();
+	FrameStats.FrameTime = FrameEndTime ? (u32)(now - FrameEndTime) : 0;
+	FrameStats.RenderTime = (u32)(now - FrameBeginTime);
+	FrameStats.PrimitivesDrawn = PrimitivesDrawn;
+	FrameEndTime = now;
+
+	if (TextureMemoryBudget)
+		evictTextures();
+	++FrameCount;
+
+	if (FrameStatsHistory.size())
+		FrameStatsHistory[FrameStatsWritten % FrameStatsHistory.size()] = FrameStats;
+	++FrameStatsWritten;
 	updateAllHardwareBuffers();
 	updateAllOcclusionQueries();
 	return true;
@@ -400,6 +440,124 @@ void CNullDriver::removeAllTextures()
 }
 
 
+//! Set the memory budget for the textures loaded from files
+void CNullDriver::setTextureMemoryBudget(u64 bytes)
+{
+	TextureMemoryBudget = bytes;
+}
+
+
+//! Get the memory budget for the textures loaded from files
+u64 CNullDriver::getTextureMemoryBudget() const
+{
+	return TextureMemoryBudget;
+}
+
+
+//! Get the memory used by the pixel data of all textures
+u64 CNullDriver::getTextureMemoryUsed() const
+{
+	u64 used = 0;
+	for (u32 i=0; i<Textures.size(); ++i)
+		used += Textures[i].Surface->getMemorySize();
+
+	return used;
+}
+
+
+namespace
+{
+	//! texture which can be evicted, ordered by the last frame it was used in
+	struct SEvictionCandidate
+	{
+		u32 LastUsedFrame;
+		ITexture* Texture;
+
+		bool operator < (const SEvictionCandidate& other) const
+		{
+			return LastUsedFrame < other.LastUsedFrame;
+		}
+	};
+}
+
+
+//! evicts the least recently used textures until the textures fit into the budget
+void CNullDriver::evictTextures()
+{
+	u64 used = getTextureMemoryUsed();
+	if (used <= TextureMemoryBudget)
+		return;
+
+	// textures used in the finished frame are kept, even when over budget
+	core::array<SEvictionCandidate> candidates;
+	for (u32 i=0; i<Textures.size(); ++i)
+	{
+		ITexture* texture = Textures[i].Surface;
+		if (Textures[i].FromFile && !texture->isEvicted() && texture->getLastUsedFrame() != FrameCount)
+		{
+			SEvictionCandidate candidate;
+			candidate.LastUsedFrame = texture->getLastUsedFrame();
+			candidate.Texture = texture;
+			candidates.push_back(candidate);
+		}
+	}
+	candidates.sort();
+
+	for (u32 i=0; i<candidates.size() && used > TextureMemoryBudget; ++i)
+	{
+		ITexture* texture = candidates[i].Texture;
+
+		// only textures which can be read again
+		if (!FileSystem->existFile(texture->getName()))
+			continue;
+
+		const u32 size = texture->getMemorySize();
+		if (texture->evict())
+		{
+			used -= size;
+			++FrameStats.TexturesEvicted;
+		}
+	}
+}
+
+
+//! creates the pixel data of an evicted texture again from its file
+bool CNullDriver::reloadTexture(ITexture* texture)
+{
+	// like getTexture(), it opens the file without the loader lock, the file
+	// system can be used on any thread. createImagesFromFile() locks the
+	// surface loaders, which the loader thread uses as well.
+	io::IReadFile* file = FileSystem->createAndOpenFile(texture->getName());
+	if (!file)
+	{
+		os::Printer::log("Could not open file of evicted texture", texture->getName(), ELL_ERROR);
+		return false;
+	}
+
+	E_TEXTURE_TYPE type = ETT_2D;
+	core::array<IImage*> images = createImagesFromFile(file, &type);
+	file->drop();
+
+	const bool result = checkImage(images) && type == texture->getType() && texture->restore(images);
+
+	for (u32 i = 0; i < images.size(); ++i)
+	{
+		if (images[i])
+			images[i]->drop();
+	}
+
+	if (result)
+	{
+		++FrameStats.TexturesReloaded;
+		os::Printer::log("Reloaded evicted texture", texture->getName(), ELL_DEBUG);
+	}
+	else
+		os::Printer::log("Could not reload evicted texture", texture->getName(), ELL_ERROR);
+
+	return result;
+}
+
+
 //! Returns a texture by index
 ITexture* CNullDriver::getTextureByIndex(u32 i)
 {
@@ -430,6 +588,165 @@ void CNullDriver::renameTexture(ITexture* texture, const io::path& newName)
 	Textures.sort();
 }
 
+//! Texture loaded on the loader thread and created on the thread which draws
+class CTextureLoadRequest : public IAsyncLoadRequest
+{
+public:
+
+	//! loads the texture of a file
+	CTextureLoadRequest(CNullDriver* driver, const io::path& filename)
+		: Driver(driver), Name(filename), File(0), Image(0), Type(ETT_2D), Texture(0)
+	{
+		#ifdef _DEBUG
+		setDebugName("CTextureLoadRequest");
+		#endif
+
+		// Identify textures by their absolute filenames if possible.
+		AbsolutePath = Driver->FileSystem->getAbsolutePath(Name);
+	}
+
+	//! loads the texture of an opened file
+	CTextureLoadRequest(CNullDriver* driver, io::IReadFile* file)
+		: Driver(driver), Name(file->getFileName()), File(file), Image(0), Type(ETT_2D), Texture(0)
+	{
+		#ifdef _DEBUG
+		setDebugName("CTextureLoadRequest");
+		#endif
+
+		File->grab();
+	}
+
+	//! adds a texture created from an image
+	CTextureLoadRequest(CNullDriver* driver, const io::path& name, IImage* image)
+		: Driver(driver), Name(name), File(0), Image(image), Type(ETT_2D), Texture(0)
+	{
+		#ifdef _DEBUG
+		setDebugName("CTextureLoadRequest");
+		#endif
+
+		Image->grab();
+	}
+
+	virtual ~CTextureLoadRequest()
+	{
+		dropImages();
+		if (File)
+			File->drop();
+		if (Image)
+			Image->drop();
+		if (Texture)
+			Texture->drop();
+	}
+
+	virtual const io::path& getName() const _IRR_OVERRIDE_
+	{
+		return Name;
+	}
+
+	virtual ITexture* getTexture() const _IRR_OVERRIDE_
+	{
+		return Texture;
+	}
+
+	//! reads and decodes the file
+	virtual bool load() _IRR_OVERRIDE_
+	{
+		if (Image)
+			return true;
+
+		io::IReadFile* file = File;
+		if (file)
+			file->grab();
+		else
+		{
+			file = Driver->FileSystem->createAndOpenFile(AbsolutePath);
+			if (!file)
+				file = Driver->FileSystem->createAndOpenFile(Name);
+			if (!file)
+			{
+				os::Printer::log("Could not open file of texture", Name, ELL_WARNING);
+				return false;
+			}
+		}
+
+		FileName = file->getFileName();
+		Images = Driver->createImagesFromFile(file, &Type);
+		file->drop();
+
+		if (Images.empty())
+		{
+			os::Printer::log("Could not load texture", Name, ELL_ERROR);
+			return false;
+		}
+		return true;
+	}
+
+	//! creates the texture and adds it to the texture list
+	virtual bool finish() _IRR_OVERRIDE_
+	{
+		if (Image)
+		{
+			Texture = Driver->addTexture(Name, Image);
+			if (Texture)
+				Texture->grab();
+			return Texture != 0;
+		}
+
+		// the texture might have been loaded in the meantime
+		Texture = AbsolutePath.size() ? Driver->findTexture(AbsolutePath) : 0;
+		if (!Texture)
+			Texture = Driver->findTexture(Name);
+		if (!Texture && FileName.size())
+			Texture = Driver->findTexture(FileName);
+
+		if (Texture)
+		{
+			Texture->updateSource(ETS_FROM_CACHE);
+			Driver->useTexture(Texture);
+			Texture->grab();
+			dropImages();
+			return true;
+		}
+
+		Texture = Driver->createTextureFromImages(FileName, Images, Type);
+		dropImages();
+
+		if (!Texture)
+		{
+			os::Printer::log("Could not load texture", Name, ELL_ERROR);
+			return false;
+		}
+
+		os::Printer::log("Loaded texture", FileName, ELL_DEBUG);
+		Texture->updateSource(ETS_FROM_FILE);
+		Driver->addTexture(Texture, true);
+		return true;
+	}
+
+private:
+
+	void dropImages()
+	{
+		for (u32 i = 0; i < Images.size(); ++i)
+		{
+			if (Images[i])
+				Images[i]->drop();
+		}
+		Images.clear();
+	}
+
+	CNullDriver* Driver;
+	io::path Name;
+	io::path AbsolutePath;
+	io::path FileName;
+	io::IReadFile* File;
+	IImage* Image;
+	core::array<IImage*> Images;
+	E_TEXTURE_TYPE Type;
+	ITexture* Texture;
+};
+
+
 ITexture* CNullDriver::addTexture(const core::dimension2d<u32>& size, const io::path& name, ECOLOR_FORMAT format)
 {
 	if (IImage::isRenderTargetOnlyFormat(format))
@@ -477,6 +794,14 @@ ITexture* CNullDriver::addTexture(const io::path& name, IImage* image)
 	if (!image)
 		return 0;
 
+	if (AsyncLoader->isLoaderThread())
+	{
+		CTextureLoadRequest* request = new CTextureLoadRequest(this, name, image);
+		ITexture* texture = getTextureOnLoaderThread(request);
+		request->drop();
+		return texture;
+	}
+
 	ITexture* t = 0;
 
 	core::array<IImage*> imageArray(1);
@@ -568,6 +893,15 @@ ITexture* CNullDriver::addTextureCubemap(const irr::u32 sideLen, const io::path&
 //! loads a Texture
 ITexture* CNullDriver::getTexture(const io::path& filename)
 {
+	// the texture list belongs to the thread which draws
+	if (AsyncLoader->isLoaderThread())
+	{
+		CTextureLoadRequest* request = new CTextureLoadRequest(this, filename);
+		ITexture* texture = getTextureOnLoaderThread(request);
+		request->drop();
+		return texture;
+	}
+
 	// Identify textures by their absolute filenames if possible.
 	const io::path absolutePath = FileSystem->getAbsolutePath(filename);
 
@@ -575,6 +909,7 @@ ITexture* CNullDriver::getTexture(const io::path& filename)
 	if (texture)
 	{
 		texture->updateSource(ETS_FROM_CACHE);
+		useTexture(texture);
 		return texture;
 	}
 
@@ -583,6 +918,7 @@ ITexture* CNullDriver::getTexture(const io::path& filename)
 	if (texture)
 	{
 		texture->updateSource(ETS_FROM_CACHE);
+		useTexture(texture);
 		return texture;
 	}
 
@@ -602,6 +938,7 @@ ITexture* CNullDriver::getTexture(const io::path& filename)
 		if (texture)
 		{
 			texture->updateSource(ETS_FROM_CACHE);
+			useTexture(texture);
 			file->drop();
 			return texture;
 		}
@@ -612,7 +949,7 @@ ITexture* CNullDriver::getTexture(const io::path& filename)
 		if (texture)
 		{
 			texture->updateSource(ETS_FROM_FILE);
-			addTexture(texture);
+			addTexture(texture, true);
 			texture->drop(); // drop it because we created it, one grab too much
 		}
 		else
@@ -632,13 +969,20 @@ ITexture* CNullDriver::getTexture(io::IReadFile* file)
 {
 	ITexture* texture = 0;
 
-	if (file)
+	if (file && AsyncLoader->isLoaderThread())
+	{
+		CTextureLoadRequest* request = new CTextureLoadRequest(this, file);
+		texture = getTextureOnLoaderThread(request);
+		request->drop();
+	}
+	else if (file)
 	{
 		texture = findTexture(file->getFileName());
 
 		if (texture)
 		{
 			texture->updateSource(ETS_FROM_CACHE);
+			useTexture(texture);
 			return texture;
 		}
 
@@ -647,7 +991,7 @@ ITexture* CNullDriver::getTexture(io::IReadFile* file)
 		if (texture)
 		{
 			texture->updateSource(ETS_FROM_FILE);
-			addTexture(texture);
+			addTexture(texture, true);
 			texture->drop(); // drop it because we created it, one grab too much
 		}
 
@@ -662,38 +1006,48 @@ ITexture* CNullDriver::getTexture(io::IReadFile* file)
 //! opens the file and loads it into the surface
 video::ITexture* CNullDriver::loadTextureFromFile(io::IReadFile* file, const io::path& hashName )
 {
-	ITexture* texture = 0;
+	IRR_PROFILE(CProfileScope p1(EPID_VD_LOAD_TEXTURE);)
 
 	E_TEXTURE_TYPE type = ETT_2D;
 
 	core::array<IImage*> imageArray = createImagesFromFile(file, &type);
 
+	ITexture* texture = createTextureFromImages(hashName.size() ? hashName : file->getFileName(), imageArray, type);
+	if (texture)
+		os::Printer::log("Loaded texture", file->getFileName(), ELL_DEBUG);
+
+	for (u32 i = 0; i < imageArray.size(); ++i)
+	{
+		if (imageArray[i])
+			imageArray[i]->drop();
+	}
+
+	return texture;
+}
+
+
+//! creates a texture from the images of a file
+video::ITexture* CNullDriver::createTextureFromImages(const io::path& name, const core::array<IImage*>& imageArray, E_TEXTURE_TYPE type)
+{
+	ITexture* texture = 0;
+
 	if (checkImage(imageArray))
 	{
 		switch (type)
 		{
 		case ETT_2D:
-			texture = createDeviceDependentTexture(hashName.size() ? hashName : file->getFileName(), imageArray[0]);
+			texture = createDeviceDependentTexture(name, imageArray[0]);
 			break;
 		case ETT_CUBEMAP:
 			if (imageArray.size() >= 6 && imageArray[0] && imageArray[1] && imageArray[2] && imageArray[3] && imageArray[4] && imageArray[5])
 			{
-				texture = createDeviceDependentTextureCubemap(hashName.size() ? hashName : file->getFileName(), imageArray);
+				texture = createDeviceDependentTextureCubemap(name, imageArray);
 			}
 			break;
 		default:
 			_IRR_DEBUG_BREAK_IF(true);
 			break;
 		}
-
-		if (texture)
-			os::Printer::log("Loaded texture", file->getFileName(), ELL_DEBUG);
-	}
-
-	for (u32 i = 0; i < imageArray.size(); ++i)
-	{
-		if (imageArray[i])
-			imageArray[i]->drop();
 	}
 
 	return texture;
@@ -701,13 +1055,15 @@ video::ITexture* CNullDriver::loadTextureFromFile(io::IReadFile* file, const io:
 
 
 //! adds a surface, not loaded or created by the Irrlicht Engine
-void CNullDriver::addTexture(video::ITexture* texture)
+void CNullDriver::addTexture(video::ITexture* texture, bool fromFile)
 {
 	if (texture)
 	{
 		SSurface s;
 		s.Surface = texture;
+		s.FromFile = fromFile;
 		texture->grab();
+		texture->updateLastUsedFrame(FrameCount);
 
 		Textures.push_back(s);
 
@@ -727,6 +1083,7 @@ video::ITexture* CNullDriver::findTexture(const io::path& filename)
 	SSurface s;
 	SDummyTexture dummy(filename, ETT_2D);
 	s.Surface = &dummy;
+	s.FromFile = false;
 
 	s32 index = Textures.binary_search(s);
 	if (index != -1)
@@ -737,12 +1094,12 @@ video::ITexture* CNullDriver::findTexture(const io::path& filename)
 
 ITexture* CNullDriver::createDeviceDependentTexture(const io::path& name, IImage* image)
 {
-	return new SDummyTexture(name, ETT_2D);
+	return new SDummyTexture(name, ETT_2D, image);
 }
 
 ITexture* CNullDriver::createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image)
 {
-	return new SDummyTexture(name, ETT_CUBEMAP);
+	return new SDummyTexture(name, ETT_CUBEMAP, image[0]);
 }
 
 bool CNullDriver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SColor clearColor, f32 clearDepth, u8 clearStencil)
@@ -807,6 +1164,7 @@ void CNullDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
 	if ((iType==EIT_16BIT) && (vertexCount>65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
 	PrimitivesDrawn += primitiveCount;
+	++FrameStats.DrawCalls;
 }
 
 
@@ -816,6 +1174,7 @@ void CNullDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCoun
 	if ((iType==EIT_16BIT) && (vertexCount>65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
 	PrimitivesDrawn += primitiveCount;
+	++FrameStats.DrawCalls;
 }
 
 
@@ -1059,6 +1418,117 @@ u32 CNullDriver::getPrimitiveCountDrawn( u32 param ) const
 }
 
 
+//! Get the statistics of the frame currently drawn
+SFrameStats& CNullDriver::getFrameStats()
+{
+	return FrameStats;
+}
+
+
+//! Get the statistics of a finished frame
+const SFrameStats& CNullDriver::getFrameStatsHistory(u32 framesAgo) const
+{
+	if (framesAgo >= getFrameStatsHistoryCount())
+	{
+		static const SFrameStats empty;
+		return empty;
+	}
+
+	return FrameStatsHistory[(FrameStatsWritten - 1 - framesAgo) % FrameStatsHistory.size()];
+}
+
+
+//! Get the number of frames in the statistics history
+u32 CNullDriver::getFrameStatsHistoryCount() const
+{
+	return core::min_(FrameStatsWritten, FrameStatsHistory.size());
+}
+
+
+//! Set the number of finished frames kept in the statistics history
+void CNullDriver::setFrameStatsHistorySize(u32 frames)
+{
+	FrameStatsHistory.clear();
+	FrameStatsHistory.reallocate(frames);
+	for (u32 i=0; i<frames; ++i)
+		FrameStatsHistory.push_back(SFrameStats());
+	FrameStatsWritten = 0;
+}
+
+
+//! Writes the statistics history as comma separated values
+bool CNullDriver::writeFrameStatsHistory(io::IWriteFile* file) const
+{
+	if (!file)
+		return false;
+
+	const c8* header = "FrameTime,RenderTime,NodesVisited,NodesCulledByOcclusionQuery,"
+		"NodesCulledByBox,NodesCulledByFrustumSphere,NodesCulledByFrustumBox,"
+		"NodesDrawnSolid,NodesDrawnTransparent,NodesDrawnTransparentEffect,"
+		"DrawCalls,PrimitivesDrawn,MaterialChanges,TextureBinds,"
+		"TexturesEvicted,TexturesReloaded,VerticesTransformed,TrianglesRasterized,PixelsShaded\n";
+	const size_t headerSize = strlen(header);
+	if (file->write(header, headerSize) != headerSize)
+		return false;
+
+	for (u32 i=getFrameStatsHistoryCount(); i>0; --i)
+	{
+		const SFrameStats& f = getFrameStatsHistory(i-1);
+
+		c8 line[256];
+		const s32 size = snprintf_irr(line, 256, "%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+			f.FrameTime, f.RenderTime, f.NodesVisited, f.NodesCulledByOcclusionQuery,
+			f.NodesCulledByBox, f.NodesCulledByFrustumSphere, f.NodesCulledByFrustumBox,
+			f.NodesDrawnSolid, f.NodesDrawnTransparent, f.NodesDrawnTransparentEffect,
+			f.DrawCalls, f.PrimitivesDrawn, f.MaterialChanges, f.TextureBinds,
+			f.TexturesEvicted, f.TexturesReloaded, f.VerticesTransformed, f.TrianglesRasterized, f.PixelsShaded);
+		if (size <= 0 || file->write(line, (size_t)size) != (size_t)size)
+			return false;
+	}
+
+	return true;
+}
+
+
+//! Get the loader for loading resources in the background
+IAsyncLoader* CNullDriver::getAsyncLoader()
+{
+	return AsyncLoader;
+}
+
+
+//! Loads a texture in the background
+IAsyncLoadRequest* CNullDriver::createTextureLoadRequest(const io::path& filename)
+{
+	CTextureLoadRequest* request = new CTextureLoadRequest(this, filename);
+
+	// textures already loaded are done at once
+	ITexture* texture = findTexture(FileSystem->getAbsolutePath(filename));
+	if (!texture)
+		texture = findTexture(filename);
+
+	if (texture)
+	{
+		request->finish();
+		request->setState(EALS_DONE);
+	}
+	else
+		AsyncLoader->addRequest(request);
+
+	return request;
+}
+
+
+//! loads a texture for a mesh loader on the loader thread
+ITexture* CNullDriver::getTextureOnLoaderThread(CTextureLoadRequest* request)
+{
+	if (!request->load())
+		return 0;
+
+	AsyncLoader->finishOnDrawingThread(request);
+	return request->getTexture();
+}
+
 
 //! Sets the dynamic ambient light color. The default color is
 //! (0,0,0,0) which means it is dark.
@@ -1570,6 +2040,18 @@ core::array<IImage*> CNullDriver::createImagesFromFile(const io::path& filename,
 }
 
 core::array<IImage*> CNullDriver::createImagesFromFile(io::IReadFile* file, E_TEXTURE_TYPE* type)
+{
+	// the surface loaders are shared with the loader thread
+	AsyncLoader->lock();
+	core::array<IImage*> imageArray = loadImagesFromFile(file, type);
+	AsyncLoader->unlock();
+
+	return imageArray;
+}
+
+
+//! loads the images of a file with the surface loaders
+core::array<IImage*> CNullDriver::loadImagesFromFile(io::IReadFile* file, E_TEXTURE_TYPE* type)
 {
 	// TO-DO -> use 'move' feature from C++11 standard.
 
@@ -1734,12 +2216,8 @@ IImage* CNullDriver::createImage(ITexture* texture, const core::position2d<s32>&
 		IImage* image = new CImage(texture->getColorFormat(), clamped.getSize());
 		u8* dst = static_cast<u8*>(image->getData());
 		src += clamped.UpperLeftCorner.Y * texture->getPitch() + image->getBytesPerPixel() * clamped.UpperLeftCorner.X;
-		for (u32 i=0; i<clamped.getHeight(); ++i)
-		{
-			video::CColorConverter::convert_viaFormat(src, texture->getColorFormat(), clamped.getWidth(), dst, image->getColorFormat());
-			src += texture->getPitch();
-			dst += image->getPitch();
-		}
+		video::CColorConverter::convert_viaFormat(src, texture->getColorFormat(), texture->getPitch(),
+			dst, image->getColorFormat(), image->getPitch(), clamped.getWidth(), clamped.getHeight());
 		texture->unlock();
 		return image;
 	}
@@ -1788,6 +2266,53 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 }
 
 
+//! Draws many instances of a mesh buffer, one after the other
+void CNullDriver::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+	const core::matrix4* transforms, const SColor* colors, u32 instanceCount)
+{
+	if (!mb || !transforms)
+		return;
+
+	const u32 vertexCount = mb->getVertexCount();
+	const u32 pitch = getVertexPitchFromType(mb->getVertexType());
+	bool colored = false;
+
+	for (u32 i=0; i<instanceCount; ++i)
+	{
+		setTransform(ETS_WORLD, transforms[i]);
+
+		if (!colors || colors[i] == 0xffffffff)
+		{
+			drawMeshBuffer(mb);
+			continue;
+		}
+
+		// modulate a copy of the vertex colors, unless the last instance
+		// already used the same color
+		if (!colored || colors[i] != colors[i-1])
+		{
+			InstanceVertices.set_used(vertexCount * pitch);
+			memcpy(InstanceVertices.pointer(), mb->getVertices(), vertexCount * pitch);
+
+			const SColor c = colors[i];
+			u8* v = InstanceVertices.pointer();
+			for (u32 k=0; k<vertexCount; ++k, v+=pitch)
+			{
+				// all vertex types store their color at the same place
+				SColor& vc = ((S3DVertex*)v)->Color;
+				vc.set((vc.getAlpha()*c.getAlpha())/255, (vc.getRed()*c.getRed())/255,
+					(vc.getGreen()*c.getGreen())/255, (vc.getBlue()*c.getBlue())/255);
+			}
+			colored = true;
+		}
+
+		drawVertexPrimitiveList(InstanceVertices.const_pointer(), vertexCount,
+			mb->getIndices(), mb->getPrimitiveCount(), mb->getVertexType(),
+			mb->getPrimitiveType(), mb->getIndexType());
+	}
+}
+
+
 //! Draws the normals of a mesh buffer
 void CNullDriver::drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length, SColor color)
 {
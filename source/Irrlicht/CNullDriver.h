@@ -21,6 +21,7 @@
 #include "SVertexIndex.h"
 #include "SLight.h"
 #include "SExposedVideoData.h"
+#include "CAsyncLoader.h"
 
 #ifdef _MSC_VER
 #pragma warning( disable: 4996)
@@ -37,9 +38,12 @@ namespace video
 {
 	class IImageLoader;
 	class IImageWriter;
+	class CTextureLoadRequest;
 
 	class CNullDriver : public IVideoDriver, public IGPUProgrammingServices
 	{
+		friend class CTextureLoadRequest;
+
 	public:
 
 		//! constructor
@@ -253,6 +257,27 @@ namespace video
 		//! very useful method for statistics.
 		virtual u32 getPrimitiveCountDrawn( u32 param = 0 ) const _IRR_OVERRIDE_;
 
+		//! Get the statistics of the frame currently drawn
+		virtual SFrameStats& getFrameStats() _IRR_OVERRIDE_;
+
+		//! Get the statistics of a finished frame
+		virtual const SFrameStats& getFrameStatsHistory(u32 framesAgo=0) const _IRR_OVERRIDE_;
+
+		//! Get the number of frames in the statistics history
+		virtual u32 getFrameStatsHistoryCount() const _IRR_OVERRIDE_;
+
+		//! Set the number of finished frames kept in the statistics history
+		virtual void setFrameStatsHistorySize(u32 frames) _IRR_OVERRIDE_;
+
+		//! Writes the statistics history as comma separated values
+		virtual bool writeFrameStatsHistory(io::IWriteFile* file) const _IRR_OVERRIDE_;
+
+		//! Get the loader for loading resources in the background
+		virtual IAsyncLoader* getAsyncLoader() _IRR_OVERRIDE_;
+
+		//! Loads a texture in the background
+		virtual IAsyncLoadRequest* createTextureLoadRequest(const io::path& filename) _IRR_OVERRIDE_;
+
 		//! deletes all dynamic lights there are
 		virtual void deleteAllDynamicLights() _IRR_OVERRIDE_;
 
@@ -317,6 +342,25 @@ namespace video
 		//! memory.
 		virtual void removeAllTextures() _IRR_OVERRIDE_;
 
+		//! Set the memory budget for the textures loaded from files
+		virtual void setTextureMemoryBudget(u64 bytes) _IRR_OVERRIDE_;
+
+		//! Get the memory budget for the textures loaded from files
+		virtual u64 getTextureMemoryBudget() const _IRR_OVERRIDE_;
+
+		//! Get the memory used by the pixel data of all textures
+		virtual u64 getTextureMemoryUsed() const _IRR_OVERRIDE_;
+
+		//! Marks a texture as used in the current frame, called by the drivers when binding it
+		/** Reloads evicted textures.
+		\return False if the texture could not be reloaded. */
+		bool useTexture(const ITexture* texture)
+		{
+			ITexture* t = const_cast<ITexture*>(texture);
+			t->updateLastUsedFrame(FrameCount);
+			return !t->isEvicted() || reloadTexture(t);
+		}
+
 		//! Creates a render target texture.
 		virtual ITexture* addRenderTargetTexture(const core::dimension2d<u32>& size,
 			const io::path& name, const ECOLOR_FORMAT format = ECF_UNKNOWN) _IRR_OVERRIDE_;
@@ -378,6 +422,11 @@ namespace video
 		//! Draws a mesh buffer
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) _IRR_OVERRIDE_;
 
+		//! Draws many instances of a mesh buffer, one after the other
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const core::matrix4* transforms, const SColor* colors,
+			u32 instanceCount) _IRR_OVERRIDE_;
+
 		//! Draws the normals of a mesh buffer
 		virtual void drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length=10.f,
 			SColor color=0xffffffff) _IRR_OVERRIDE_;
@@ -693,8 +742,24 @@ namespace video
 		//! opens the file and loads it into the surface
 		video::ITexture* loadTextureFromFile(io::IReadFile* file, const io::path& hashName = "");
 
+		//! creates a texture from the images of a file
+		video::ITexture* createTextureFromImages(const io::path& name, const core::array<IImage*>& imageArray, E_TEXTURE_TYPE type);
+
+		//! loads the images of a file with the surface loaders, which have to be locked
+		core::array<IImage*> loadImagesFromFile(io::IReadFile* file, E_TEXTURE_TYPE* type);
+
+		//! loads a texture for a mesh loader on the loader thread
+		ITexture* getTextureOnLoaderThread(CTextureLoadRequest* request);
+
 		//! adds a surface, not loaded or created by the Irrlicht Engine
-		void addTexture(video::ITexture* surface);
+		/** \param fromFile True for textures loaded from files, which can be evicted. */
+		void addTexture(video::ITexture* surface, bool fromFile=false);
+
+		//! creates the pixel data of an evicted texture again from its file
+		bool reloadTexture(ITexture* texture);
+
+		//! evicts the least recently used textures until the textures fit into the budget
+		void evictTextures();
 
 		virtual ITexture* createDeviceDependentTexture(const io::path& name, IImage* image);
 
@@ -766,6 +831,7 @@ namespace video
 		struct SSurface
 		{
 			video::ITexture* Surface;
+			bool FromFile;
 
 			bool operator < (const SSurface& other) const
 			{
@@ -781,11 +847,22 @@ namespace video
 
 		struct SDummyTexture : public ITexture
 		{
-			SDummyTexture(const io::path& name, E_TEXTURE_TYPE type) : ITexture(name, type) {};
+			SDummyTexture(const io::path& name, E_TEXTURE_TYPE type, const IImage* image = 0) : ITexture(name, type)
+			{
+				// without pixel data, but accounted like the textures of the other drivers
+				if (image)
+				{
+					OriginalSize = Size = image->getDimension();
+					OriginalColorFormat = ColorFormat = image->getColorFormat();
+					Pitch = image->getPitch();
+				}
+			}
 
 			virtual void* lock(E_TEXTURE_LOCK_MODE mode = ETLM_READ_WRITE, u32 mipmapLevel=0, u32 layer = 0, E_TEXTURE_LOCK_FLAGS lockFlags = ETLF_FLIP_Y_UP_RTT) _IRR_OVERRIDE_ { return 0; }
 			virtual void unlock()_IRR_OVERRIDE_ {}
 			virtual void regenerateMipMapLevels(void* data = 0, u32 layer = 0) _IRR_OVERRIDE_ {}
+			virtual bool evictData() _IRR_OVERRIDE_ { return true; }
+			virtual bool restoreData(const core::array<IImage*>& images) _IRR_OVERRIDE_ { return true; }
 		};
 		core::array<SSurface> Textures;
 
@@ -860,6 +937,9 @@ namespace video
 		core::array<SLight> Lights;
 		core::array<SMaterialRenderer> MaterialRenderers;
 
+		//! scratch vertices for instances drawn with a color other than white
+		core::array<u8> InstanceVertices;
+
 		//core::array<SHWBufferLink*> HWBufferLinks;
 		core::map< const scene::IMeshBuffer* , SHWBufferLink* > HWBufferMap;
 
@@ -879,6 +959,20 @@ namespace video
 
 		u32 TextureCreationFlags;
 
+		//! statistics of the current frame
+		SFrameStats FrameStats;
+		//! ring buffer of finished frames, FrameStatsWritten counts all frames added
+		core::array<SFrameStats> FrameStatsHistory;
+		u32 FrameStatsWritten;
+		u64 FrameBeginTime;
+		u64 FrameEndTime;
+
+		//! frames finished by endScene, the textures remember the last one they were used in
+		u32 FrameCount;
+		u64 TextureMemoryBudget;
+
+		CAsyncLoader* AsyncLoader;
+
 		f32 FogStart;
 		f32 FogEnd;
 		f32 FogDensity;
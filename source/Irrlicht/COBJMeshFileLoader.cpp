@@ -13,6 +13,7 @@
 #include "SMeshBuffer.h"
 #include "SAnimatedMesh.h"
 #include "IReadFile.h"
+#include "CMappedReadFile.h"
 #include "IAttributes.h"
 #include "fast_atof.h"
 #include "coreutil.h"
@@ -29,14 +30,20 @@ namespace scene
 
 static const u32 WORD_BUFFER_LENGTH = 512;
 
+//! files are only split into chunks of at least this size for parsing on several threads
+static const long MIN_CHUNK_SIZE = 0x40000;
+
 //! Constructor
 COBJMeshFileLoader::COBJMeshFileLoader(scene::ISceneManager* smgr, io::IFileSystem* fs)
-: SceneManager(smgr), FileSystem(fs)
+: SceneManager(smgr), FileSystem(fs), ParsePool(0), ParseThreadCount(0)
 {
 	#ifdef _DEBUG
 	setDebugName("COBJMeshFileLoader");
 	#endif
 
+	ParseJob.Loader = this;
+	ParseJob.Counting = false;
+
 	if (FileSystem)
 		FileSystem->grab();
 
@@ -49,6 +56,9 @@ COBJMeshFileLoader::~COBJMeshFileLoader()
 {
 	if (FileSystem)
 		FileSystem->drop();
+
+	if (ParsePool)
+		ParsePool->drop();
 }
 
 
@@ -76,12 +86,6 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	if (!filesize)
 		return 0;
 
-	const u32 WORD_BUFFER_LENGTH = 512;
-
-	core::array<core::vector3df, core::irrAllocatorFast<core::vector3df> > vertexBuffer(1000);
-	core::array<core::vector3df, core::irrAllocatorFast<core::vector3df> > normalsBuffer(1000);
-	core::array<core::vector2df, core::irrAllocatorFast<core::vector2df> > textureCoordBuffer(1000);
-
 	SObjMtl * currMtl = new SObjMtl();
 	Materials.push_back(currMtl);
 	u32 smoothingGroup=0;
@@ -89,13 +93,22 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	const io::path fullName = file->getFileName();
 	const io::path relPath = FileSystem->getFileDir(fullName)+"/";
 
-	c8* buf = new c8[filesize];
-	memset(buf, 0, filesize);
-	file->read((void*)buf, filesize);
+	// files in memory are parsed in place
+	c8* bufCopy = 0;
+	const c8* buf = (const c8*)io::CMappedReadFile::getFileMemory(file);
+	if (!buf)
+	{
+		bufCopy = new c8[filesize];
+		memset(bufCopy, 0, filesize);
+		file->read((void*)bufCopy, filesize);
+		buf = bufCopy;
+	}
 	const c8* const bufEnd = buf+filesize;
 
-	// Process obj information
-	const c8* bufPtr = buf;
+	// Read the vertex data and the indices of the faces
+	parseChunks(buf, bufEnd);
+
+	// Process the remaining obj information and build the faces in file order
 	core::stringc grpName, mtlName;
 	bool mtlChanged=false;
 	bool useGroups = !SceneManager->getParameters()->getAttributeAsBool(OBJ_LOADER_IGNORE_GROUPS);
@@ -106,8 +119,17 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	const core::stringc TAG_OFF = "off";
 	irr::u32 degeneratedFaces = 0;
 
-	while(bufPtr != bufEnd)
+	for (u32 chunk = 0; chunk < Chunks.size(); ++chunk)
 	{
+	const SObjChunk& currChunk = Chunks[chunk];
+	const s32* corner = currChunk.FaceCorners.const_pointer();
+	u32 face = 0;
+
+	const c8* bufPtr = currChunk.Begin;
+	while(bufPtr != currChunk.End)
+	{
+		const c8* const lineEnd = goLineEnd(bufPtr, currChunk.End);
+
 		switch(bufPtr[0])
 		{
 		case 'm':	// mtllib (material)
@@ -115,7 +137,7 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 			if (useMaterials)
 			{
 				c8 name[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(name, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+				bufPtr = goAndCopyNextWord(name, bufPtr, WORD_BUFFER_LENGTH, lineEnd);
 #ifdef _IRR_DEBUG_OBJ_LOADER_
 				os::Printer::log("Reading material file",name);
 #endif
@@ -124,39 +146,10 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 		}
 			break;
 
-		case 'v':               // v, vn, vt
-			switch(bufPtr[1])
-			{
-			case ' ':          // vertex
-				{
-					core::vector3df vec;
-					bufPtr = readVec3(bufPtr, vec, bufEnd);
-					vertexBuffer.push_back(vec);
-				}
-				break;
-
-			case 'n':       // normal
-				{
-					core::vector3df vec;
-					bufPtr = readVec3(bufPtr, vec, bufEnd);
-					normalsBuffer.push_back(vec);
-				}
-				break;
-
-			case 't':       // texcoord
-				{
-					core::vector2df vec;
-					bufPtr = readUV(bufPtr, vec, bufEnd);
-					textureCoordBuffer.push_back(vec);
-				}
-				break;
-			}
-			break;
-
 		case 'g': // group name
 			{
 				c8 grp[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(grp, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+				bufPtr = goAndCopyNextWord(grp, bufPtr, WORD_BUFFER_LENGTH, lineEnd);
 #ifdef _IRR_DEBUG_OBJ_LOADER_
 	os::Printer::log("Loaded group start",grp, ELL_DEBUG);
 #endif
@@ -174,7 +167,7 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 		case 's': // smoothing can be a group or off (equiv. to 0)
 			{
 				c8 smooth[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(smooth, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+				bufPtr = goAndCopyNextWord(smooth, bufPtr, WORD_BUFFER_LENGTH, lineEnd);
 #ifdef _IRR_DEBUG_OBJ_LOADER_
 	os::Printer::log("Loaded smoothing group start",smooth, ELL_DEBUG);
 #endif
@@ -189,7 +182,7 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 			// get name of material
 			{
 				c8 matName[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(matName, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+				bufPtr = goAndCopyNextWord(matName, bufPtr, WORD_BUFFER_LENGTH, lineEnd);
 #ifdef _IRR_DEBUG_OBJ_LOADER_
 	os::Printer::log("Loaded material start",matName, ELL_DEBUG);
 #endif
@@ -200,7 +193,6 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 
 		case 'f':               // face
 		{
-			c8 vertexWord[WORD_BUFFER_LENGTH]; // for retrieving vertex data
 			video::S3DVertex v;
 			// Assign vertex color from currently active material's diffuse color
 			if (mtlChanged)
@@ -215,74 +207,50 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 			if (currMtl)
 				v.Color = currMtl->Meshbuffer->Material.DiffuseColor;
 
-			// get all vertices data in this face (current line of obj file)
-			const core::stringc wordBuffer = copyLine(bufPtr, bufEnd);
-			const c8* linePtr = wordBuffer.c_str();
-			const c8* const endPtr = linePtr+wordBuffer.size();
-
 			faceCorners.set_used(0); // fast clear
 
-			// read in all vertices
-			linePtr = goNextWord(linePtr, endPtr);
-			while (0 != linePtr[0])
+			// all vertices data in this face, as read by parseChunk
+			const u32 cornerCount = currChunk.FaceSizes[face++];
+			for (u32 i = 0; i < cornerCount; ++i, corner += 3)
 			{
-				// Array to communicate with retrieveVertexIndices()
-				// sends the buffer sizes and gets the actual indices
-				// if index not set returns -1
-				s32 Idx[3];
-				Idx[0] = Idx[1] = Idx[2] = -1;
-
-				// read in next vertex's data
-				u32 wlength = copyWord(vertexWord, linePtr, WORD_BUFFER_LENGTH, endPtr);
-				// this function will also convert obj's 1-based index to c++'s 0-based index
-				retrieveVertexIndices(vertexWord, Idx, vertexWord+wlength+1, vertexBuffer.size(), textureCoordBuffer.size(), normalsBuffer.size());
-				if ( -1 != Idx[0] && Idx[0] < (irr::s32)vertexBuffer.size() )
-					v.Pos = vertexBuffer[Idx[0]];
+				if ( -1 != corner[0] )
+					v.Pos = VertexBuffer[corner[0]];
 				else
 				{
-					os::Printer::log("Invalid vertex index in this line:", wordBuffer.c_str(), ELL_ERROR);
-					delete [] buf;
+					os::Printer::log("Invalid vertex index in this line:", copyLine(bufPtr, lineEnd).c_str(), ELL_ERROR);
+					delete [] bufCopy;
+					cleanUp();
 					return 0;
 				}
-				if ( -1 != Idx[1] && Idx[1] < (irr::s32)textureCoordBuffer.size() )
-					v.TCoords = textureCoordBuffer[Idx[1]];
+				if ( -1 != corner[1] )
+					v.TCoords = TextureCoordBuffer[corner[1]];
 				else
 					v.TCoords.set(0.0f,0.0f);
-				if ( -1 != Idx[2] && Idx[2] < (irr::s32)normalsBuffer.size() )
-					v.Normal = normalsBuffer[Idx[2]];
+				if ( -1 != corner[2] )
+					v.Normal = NormalsBuffer[corner[2]];
 				else
 				{
 					v.Normal.set(0.0f,0.0f,0.0f);
 					currMtl->RecalculateNormals=true;
 				}
 
-				int vertLocation;
-				core::map<video::S3DVertex, int>::Node* n = currMtl->VertMap.find(v);
-				if (n)
-				{
-					vertLocation = n->getValue();
-				}
-				else
-				{
+				// vertices are shared by corners with the same indices
+				const s32 newVertex = currMtl->Meshbuffer->Vertices.size();
+				const s32 vertLocation = currMtl->VertMap.findOrInsert(corner, newVertex);
+				if (vertLocation == newVertex)
 					currMtl->Meshbuffer->Vertices.push_back(v);
-					vertLocation = currMtl->Meshbuffer->Vertices.size() -1;
-					currMtl->VertMap.insert(v, vertLocation);
-				}
 
 				faceCorners.push_back(vertLocation);
-
-				// go to next vertex
-				linePtr = goNextWord(linePtr, endPtr);
 			}
 
 			// triangulate the face
-			const int c = faceCorners[0];
-			for ( u32 i = 1; i < faceCorners.size() - 1; ++i )
+			for ( u32 i = 1; i + 1 < faceCorners.size(); ++i )
 			{
 				// Add a triangle
 				const int a = faceCorners[i + 1];
 				const int b = faceCorners[i];
-				if (a != b && a != c && b != c)	// ignore degenerated faces. We can get them when we merge vertices above in the VertMap.
+				const int c = faceCorners[0];
+				if (a != b && a != c && b != c)	// ignore degenerated faces. We can get them when corners use the same indices.
 				{
 					currMtl->Meshbuffer->Indices.push_back(a);
 					currMtl->Meshbuffer->Indices.push_back(b);
@@ -296,14 +264,16 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 		}
 		break;
 
+		case 'v': // v, vn, vt, read by parseChunk
 		case '#': // comment
 		default:
 			break;
 		}	// end switch(bufPtr[0])
 		// eat up rest of line
-		bufPtr = goNextLine(bufPtr, bufEnd);
+		bufPtr = goFirstWord(lineEnd, currChunk.End);
 		++lineNr;
-	}	// end while(bufPtr && (bufPtr-buf<filesize))
+	}	// end while(bufPtr != currChunk.End)
+	}	// end for chunks
 
 	if ( degeneratedFaces > 0 )
 	{
@@ -348,7 +318,7 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	}
 
 	// Clean up the allocate obj file contents
-	delete [] buf;
+	delete [] bufCopy;
 	// more cleaning up
 	cleanUp();
 	mesh->drop();
@@ -357,6 +327,193 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 }
 
 
+//! splits the file into chunks and parses them, on several threads if enabled
+void COBJMeshFileLoader::parseChunks(const c8* buf, const c8* const bufEnd)
+{
+	u32 chunkCount = 1;
+	const s32 threads = SceneManager->getParameters()->getAttributeAsInt(OBJ_LOADER_THREADS);
+	if (threads > 1)
+	{
+		if ((u32)threads != ParseThreadCount)
+		{
+			if (ParsePool)
+				ParsePool->drop();
+
+			ParsePool = new CThreadPool(threads);
+			ParseThreadCount = threads;
+		}
+
+		chunkCount = core::clamp((u32)((bufEnd-buf) / MIN_CHUNK_SIZE), 1u, ParsePool->getThreadCount());
+	}
+
+	// chunks start at the beginning of a line
+	Chunks.reallocate(chunkCount);
+	const c8* begin = goFirstWord(buf, bufEnd);
+	for (u32 i=0; i<chunkCount; ++i)
+	{
+		const c8* end = bufEnd;
+		if (i+1 < chunkCount)
+		{
+			end = buf + (bufEnd-buf) / chunkCount * (i+1);
+			if (end < begin)
+				end = begin;
+			end = goFirstWord(goLineEnd(end, bufEnd), bufEnd);
+		}
+
+		Chunks.push_back(SObjChunk());
+		Chunks.getLast().Begin = begin;
+		Chunks.getLast().End = end;
+		begin = end;
+	}
+
+	// count the lines of each chunk to place their vertex data in the buffers
+	ParseJob.Counting = true;
+	if (chunkCount > 1)
+		ParsePool->run(&ParseJob, chunkCount);
+	else
+		ParseJob.runPart(0, 0);
+
+	u32 vertexCount = 0;
+	u32 normalCount = 0;
+	u32 tcoordCount = 0;
+	for (u32 i=0; i<chunkCount; ++i)
+	{
+		Chunks[i].VertexBase = vertexCount;
+		Chunks[i].NormalBase = normalCount;
+		Chunks[i].TCoordBase = tcoordCount;
+		vertexCount += Chunks[i].VertexCount;
+		normalCount += Chunks[i].NormalCount;
+		tcoordCount += Chunks[i].TCoordCount;
+	}
+	VertexBuffer.set_used(vertexCount);
+	NormalsBuffer.set_used(normalCount);
+	TextureCoordBuffer.set_used(tcoordCount);
+
+	ParseJob.Counting = false;
+	if (chunkCount > 1)
+		ParsePool->run(&ParseJob, chunkCount);
+	else
+		ParseJob.runPart(0, 0);
+}
+
+
+//! counts the lines of the chunk
+void COBJMeshFileLoader::countChunk(SObjChunk& chunk)
+{
+	const c8* bufPtr = chunk.Begin;
+	while (bufPtr != chunk.End)
+	{
+		const c8* const lineEnd = goLineEnd(bufPtr, chunk.End);
+
+		if (bufPtr[0] == 'f')
+			++chunk.FaceCount;
+		else if (bufPtr[0] == 'v' && lineEnd-bufPtr > 1)
+		{
+			switch(bufPtr[1])
+			{
+			case ' ':
+				++chunk.VertexCount;
+				break;
+			case 'n':
+				++chunk.NormalCount;
+				break;
+			case 't':
+				++chunk.TCoordCount;
+				break;
+			}
+		}
+
+		bufPtr = goFirstWord(lineEnd, chunk.End);
+	}
+}
+
+
+//! reads the vertex data and face indices of the chunk
+void COBJMeshFileLoader::parseChunk(SObjChunk& chunk)
+{
+	// sizes of the buffers as seen by the current line
+	u32 vertexCount = chunk.VertexBase;
+	u32 normalCount = chunk.NormalBase;
+	u32 tcoordCount = chunk.TCoordBase;
+
+	chunk.FaceSizes.reallocate(chunk.FaceCount);
+	chunk.FaceCorners.reallocate(chunk.FaceCount*9);
+
+	const c8* bufPtr = chunk.Begin;
+	while (bufPtr != chunk.End)
+	{
+		const c8* const lineEnd = goLineEnd(bufPtr, chunk.End);
+
+		switch(bufPtr[0])
+		{
+		case 'v':               // v, vn, vt
+			if (lineEnd-bufPtr > 1)
+			{
+				switch(bufPtr[1])
+				{
+				case ' ':          // vertex
+					readVec3(bufPtr, VertexBuffer[vertexCount++], lineEnd);
+					break;
+
+				case 'n':       // normal
+					readVec3(bufPtr, NormalsBuffer[normalCount++], lineEnd);
+					break;
+
+				case 't':       // texcoord
+					readUV(bufPtr, TextureCoordBuffer[tcoordCount++], lineEnd);
+					break;
+				}
+			}
+			break;
+
+		case 'f':               // face
+		{
+			c8 vertexWord[WORD_BUFFER_LENGTH]; // for retrieving vertex data
+			u32 cornerCount = 0;
+
+			// read in all vertices
+			const c8* linePtr = goNextWord(bufPtr, lineEnd, false);
+			while (linePtr != lineEnd)
+			{
+				// Array to communicate with retrieveVertexIndices()
+				// sends the buffer sizes and gets the actual indices
+				// if index not set returns -1
+				s32 Idx[3];
+				Idx[0] = Idx[1] = Idx[2] = -1;
+
+				// read in next vertex's data
+				u32 wlength = copyWord(vertexWord, linePtr, WORD_BUFFER_LENGTH, lineEnd);
+				// this function will also convert obj's 1-based index to c++'s 0-based index
+				retrieveVertexIndices(vertexWord, Idx, vertexWord+wlength+1, vertexCount, tcoordCount, normalCount);
+
+				// only data defined before the face can be used
+				if (Idx[0] >= (s32)vertexCount)
+					Idx[0] = -1;
+				if (Idx[1] >= (s32)tcoordCount)
+					Idx[1] = -1;
+				if (Idx[2] >= (s32)normalCount)
+					Idx[2] = -1;
+				for (u32 i=0; i<3; ++i)
+					chunk.FaceCorners.push_back(core::max_(Idx[i], -1));
+				++cornerCount;
+
+				// go to next vertex
+				linePtr = goNextWord(linePtr, lineEnd, false);
+			}
+
+			chunk.FaceSizes.push_back(cornerCount);
+		}
+		break;
+
+		default:
+			break;
+		}
+
+		bufPtr = goFirstWord(lineEnd, chunk.End);
+	}
+}
+
+
 const c8* COBJMeshFileLoader::readTextures(const c8* bufPtr, const c8* const bufEnd, SObjMtl* currMaterial, const io::path& relPath)
 {
 	u8 type=0; // map_Kd - diffuse color texture map
@@ -548,8 +705,14 @@ void COBJMeshFileLoader::readMTL(const c8* fileName, const io::path& relPath)
 		return;
 	}
 
-	c8* buf = new c8[filesize];
-	mtlReader->read((void*)buf, filesize);
+	c8* bufCopy = 0;
+	const c8* buf = (const c8*)io::CMappedReadFile::getFileMemory(mtlReader);
+	if (!buf)
+	{
+		bufCopy = new c8[filesize];
+		mtlReader->read((void*)bufCopy, filesize);
+		buf = bufCopy;
+	}
 	const c8* bufEnd = buf+filesize;
 
 	SObjMtl* currMaterial = 0;
@@ -696,7 +859,7 @@ void COBJMeshFileLoader::readMTL(const c8* fileName, const io::path& relPath)
 	if ( currMaterial )
 		Materials.push_back( currMaterial );
 
-	delete [] buf;
+	delete [] bufCopy;
 	mtlReader->drop();
 }
 
@@ -834,6 +997,16 @@ const c8* COBJMeshFileLoader::goNextLine(const c8* buf, const c8* const bufEnd)
 }
 
 
+//! Read until line break is reached and stop on it
+const c8* COBJMeshFileLoader::goLineEnd(const c8* buf, const c8* const bufEnd)
+{
+	while((buf != bufEnd) && (*buf != '\n') && (*buf != '\r'))
+		++buf;
+
+	return buf;
+}
+
+
 u32 COBJMeshFileLoader::copyWord(c8* outBuf, const c8* const inBuf, u32 outBufLength, const c8* const bufEnd)
 {
 	if (!outBufLength)
@@ -845,9 +1018,9 @@ u32 COBJMeshFileLoader::copyWord(c8* outBuf, const c8* const inBuf, u32 outBufLe
 	}
 
 	u32 i = 0;
-	while(inBuf[i])
+	while(&(inBuf[i]) != bufEnd && inBuf[i])
 	{
-		if (core::isspace(inBuf[i]) || &(inBuf[i]) == bufEnd)
+		if (core::isspace(inBuf[i]))
 			break;
 		++i;
 	}
@@ -964,6 +1137,70 @@ void COBJMeshFileLoader::cleanUp()
 	}
 
 	Materials.clear();
+
+	VertexBuffer.clear();
+	NormalsBuffer.clear();
+	TextureCoordBuffer.clear();
+	Chunks.clear();
+}
+
+
+//! mixes the (v, vt, vn) indices of a face corner
+static inline u32 hashVertexIndices(const s32* idx)
+{
+	u32 h = (u32)idx[0] * 73856093u;
+	h ^= (u32)idx[1] * 19349663u;
+	h ^= (u32)idx[2] * 83492791u;
+	return h ^ (h >> 15);
+}
+
+
+//! returns the vertex of the indices, or inserts the given vertex for them
+s32 COBJMeshFileLoader::CObjVertexMap::findOrInsert(const s32* idx, s32 vertex)
+{
+	// keep at least half of the entries free
+	if ((Count+1)*2 > Entries.size())
+		grow();
+
+	const u32 mask = Entries.size()-1;
+	u32 i = hashVertexIndices(idx) & mask;
+	while (Entries[i].Vertex != -1)
+	{
+		const SEntry& e = Entries[i];
+		if (e.Idx[0] == idx[0] && e.Idx[1] == idx[1] && e.Idx[2] == idx[2])
+			return e.Vertex;
+		i = (i+1) & mask;
+	}
+
+	SEntry& e = Entries[i];
+	e.Idx[0] = idx[0];
+	e.Idx[1] = idx[1];
+	e.Idx[2] = idx[2];
+	e.Vertex = vertex;
+	++Count;
+	return vertex;
+}
+
+
+//! doubles the size of the table
+void COBJMeshFileLoader::CObjVertexMap::grow()
+{
+	core::array<SEntry> old;
+	old.swap(Entries);
+
+	SEntry empty;
+	empty.Idx[0] = empty.Idx[1] = empty.Idx[2] = -1;
+	empty.Vertex = -1;
+	Entries.set_used(old.empty() ? 256 : old.size()*2);
+	for (u32 i=0; i<Entries.size(); ++i)
+		Entries[i] = empty;
+
+	Count = 0;
+	for (u32 i=0; i<old.size(); ++i)
+	{
+		if (old[i].Vertex != -1)
+			findOrInsert(old[i].Idx, old[i].Vertex);
+	}
 }
 
 
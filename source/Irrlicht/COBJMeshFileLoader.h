@@ -10,7 +10,7 @@
 #include "ISceneManager.h"
 #include "irrString.h"
 #include "SMeshBuffer.h"
-#include "irrMap.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -40,6 +40,30 @@ public:
 
 private:
 
+	//! Open addressing hash table from the (v, vt, vn) indices of face corners to vertices
+	class CObjVertexMap
+	{
+	public:
+
+		CObjVertexMap() : Count(0) {}
+
+		//! returns the vertex of the indices, or inserts the given vertex for them
+		s32 findOrInsert(const s32* idx, s32 vertex);
+
+	private:
+
+		struct SEntry
+		{
+			s32 Idx[3];
+			s32 Vertex;
+		};
+
+		void grow();
+
+		core::array<SEntry> Entries;
+		u32 Count;
+	};
+
 	struct SObjMtl
 	{
 		SObjMtl() : Meshbuffer(0), Bumpiness (1.0f), Illumination(0),
@@ -61,7 +85,7 @@ private:
 			Meshbuffer->Material = o.Meshbuffer->Material;
 		}
 
-		core::map<video::S3DVertex, int> VertMap;
+		CObjVertexMap VertMap;
 		scene::SMeshBuffer *Meshbuffer;
 		core::stringc Name;
 		core::stringc Group;
@@ -70,6 +94,54 @@ private:
 		bool RecalculateNormals;
 	};
 
+	//! Part of the file, starting and ending at line starts, parsed by one thread
+	struct SObjChunk
+	{
+		SObjChunk() : Begin(0), End(0), VertexCount(0), NormalCount(0), TCoordCount(0),
+			FaceCount(0), VertexBase(0), NormalBase(0), TCoordBase(0) {}
+
+		const c8* Begin;
+		const c8* End;
+
+		//! number of v, vn, vt and f lines in the chunk
+		u32 VertexCount;
+		u32 NormalCount;
+		u32 TCoordCount;
+		u32 FaceCount;
+
+		//! number of v, vn and vt lines before the chunk
+		u32 VertexBase;
+		u32 NormalBase;
+		u32 TCoordBase;
+
+		//! (v, vt, vn) indices of all face corners, -1 if not set or invalid
+		core::array<s32> FaceCorners;
+		//! number of corners of each face
+		core::array<u32> FaceSizes;
+	};
+
+	//! Runs the counting or the parsing of the chunks
+	struct SParseJob : public IThreadJob
+	{
+		virtual void runPart(u32 part, u32 thread) _IRR_OVERRIDE_
+		{
+			if (Counting)
+				Loader->countChunk(Loader->Chunks[part]);
+			else
+				Loader->parseChunk(Loader->Chunks[part]);
+		}
+
+		COBJMeshFileLoader* Loader;
+		bool Counting;
+	};
+
+	//! splits the file into chunks and parses them, on several threads if enabled
+	void parseChunks(const c8* buf, const c8* const bufEnd);
+	//! counts the lines of the chunk
+	void countChunk(SObjChunk& chunk);
+	//! reads the vertex data and face indices of the chunk
+	void parseChunk(SObjChunk& chunk);
+
 	// helper method for material reading
 	const c8* readTextures(const c8* bufPtr, const c8* const bufEnd, SObjMtl* currMaterial, const io::path& relPath);
 
@@ -79,6 +151,8 @@ private:
 	const c8* goNextWord(const c8* buf, const c8* const bufEnd, bool acrossNewlines=true);
 	// returns a pointer to the next printable character after the first line break
 	const c8* goNextLine(const c8* buf, const c8* const bufEnd);
+	// returns a pointer to the first line break or the end of the buffer
+	const c8* goLineEnd(const c8* buf, const c8* const bufEnd);
 	// copies the current word from the inBuf to the outBuf
 	u32 copyWord(c8* outBuf, const c8* inBuf, u32 outBufLength, const c8* const pBufEnd);
 	// copies the current line from the inBuf to the outBuf
@@ -113,6 +187,16 @@ private:
 	io::IFileSystem* FileSystem;
 
 	core::array<SObjMtl*> Materials;
+
+	//! vertex data of the file
+	core::array<core::vector3df> VertexBuffer;
+	core::array<core::vector3df> NormalsBuffer;
+	core::array<core::vector2df> TextureCoordBuffer;
+	core::array<SObjChunk> Chunks;
+
+	CThreadPool* ParsePool;
+	u32 ParseThreadCount;
+	SParseJob ParseJob;
 };
 
 } // end namespace scene
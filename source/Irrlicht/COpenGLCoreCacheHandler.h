@@ -68,6 +68,10 @@ class COpenGLCoreCacheHandler
 
 			if (index < MATERIAL_MAX_TEXTURES && index < TextureCount)
 			{
+				// evicted textures are uploaded again before the unit is activated
+				if (texture && texture->getDriverType() == DriverType)
+					CacheHandler.Driver->useTexture(texture);
+
 				if ( esa == EST_ACTIVE_ALWAYS )
 					CacheHandler.setActiveTexture(GL_TEXTURE0 + index);
 
@@ -105,6 +109,7 @@ class COpenGLCoreCacheHandler
 #endif
 
 							glBindTexture(curTextureType, static_cast<const TOpenGLTexture*>(texture)->getOpenGLTextureName());
+							++CacheHandler.Driver->getFrameStats().TextureBinds;
 						}
 						else
 						{
@@ -59,76 +59,7 @@ public:
 
 		getImageValues(image[0]);
 
-		const core::array<IImage*>* tmpImage = &image;
-
-		if (KeepImage || OriginalSize != Size || OriginalColorFormat != ColorFormat)
-		{
-			Image.set_used(image.size());
-
-			for (u32 i = 0; i < image.size(); ++i)
-			{
-				Image[i] = Driver->createImage(ColorFormat, Size);
-
-				if (image[i]->getDimension() == Size)
-					image[i]->copyTo(Image[i]);
-				else
-					image[i]->copyToScaling(Image[i]);
-			}
-
-			tmpImage = &Image;
-		}
-
-		glGenTextures(1, &TextureName);
-
-		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
-		Driver->getCacheHandler()->getTextureCache().set(0, this);
-
-		glTexParameteri(TextureType, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(TextureType, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-		if (HasMipMaps && AutoGenerateMipMaps)
-		{
-			if (Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_SPEED))
-				glHint(GL_GENERATE_MIPMAP_HINT, GL_FASTEST);
-			else if (Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_QUALITY))
-				glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST);
-			else
-				glHint(GL_GENERATE_MIPMAP_HINT, GL_DONT_CARE);
-		}
-
-#if (defined(IRR_OPENGL_VERSION) && IRR_OPENGL_VERSION < 20) || (defined(IRR_OPENGL_ES_VERSION) && IRR_OPENGL_ES_VERSION < 20)
-		if (HasMipMaps)
-			glTexParameteri(TextureType, GL_GENERATE_MIPMAP, (AutoGenerateMipMaps) ? GL_TRUE : GL_FALSE);
-#endif
-
-		for (u32 i = 0; i < (*tmpImage).size(); ++i)
-			uploadTexture(true, i, 0, (*tmpImage)[i]->getData());
-
-		bool autoGenerateRequired = true;
-
-		for (u32 i = 0; i < (*tmpImage).size(); ++i)
-		{
-			void* mipmapsData = (*tmpImage)[i]->getMipMapsData();
-
-			if (autoGenerateRequired || mipmapsData)
-				regenerateMipMapLevels(mipmapsData, i);
-
-			if (!mipmapsData)
-				autoGenerateRequired = false;
-		}
-
-		if (!KeepImage)
-		{
-			for (u32 i = 0; i < Image.size(); ++i)
-				Image[i]->drop();
-
-			Image.clear();
-		}
-
-
-		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
-
-		Driver->testGLError(__LINE__);
+		uploadImages(image);
 	}
 
 	COpenGLCoreTexture(const io::path& name, const core::dimension2d<u32>& size, E_TEXTURE_TYPE type, ECOLOR_FORMAT format, TOpenGLDriver* driver) 
@@ -210,10 +141,11 @@ public:
 		if (LockImage)
 			return LockImage->getData();
 
-		if (IImage::isCompressedFormat(ColorFormat))
+		if (IImage::isCompressedFormat(ColorFormat) || Evicted)
 			return 0;
 
 		LockReadOnly |= (mode == ETLM_READ_ONLY);
+		LockedForWriting |= (mode != ETLM_READ_ONLY);
 		LockLayer = layer;
 
 		if (KeepImage)
@@ -362,7 +294,7 @@ public:
 
 	virtual void regenerateMipMapLevels(void* data = 0, u32 layer = 0) _IRR_OVERRIDE_
 	{
-		if (!HasMipMaps || (!data && !AutoGenerateMipMaps) || (Size.Width <= 1 && Size.Height <= 1))
+		if (!HasMipMaps || (!data && !AutoGenerateMipMaps) || (Size.Width <= 1 && Size.Height <= 1) || Evicted)
 			return;
 
 		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
@@ -419,6 +351,34 @@ public:
 	}
 
 protected:
+	virtual bool evictData() _IRR_OVERRIDE_
+	{
+		if (LockImage)
+			return false;
+
+		Driver->getCacheHandler()->getTextureCache().remove(this);
+
+		glDeleteTextures(1, &TextureName);
+		TextureName = 0;
+
+		for (u32 i = 0; i < Image.size(); ++i)
+			Image[i]->drop();
+
+		Image.clear();
+
+		return true;
+	}
+
+	virtual bool restoreData(const core::array<IImage*>& images) _IRR_OVERRIDE_
+	{
+		// a new texture object starts with the default sampler states
+		StatesCache.IsCached = false;
+
+		uploadImages(images);
+
+		return TextureName != 0;
+	}
+
 	ECOLOR_FORMAT getBestColorFormat(ECOLOR_FORMAT format)
 	{
 		ECOLOR_FORMAT destFormat = (!IImage::isCompressedFormat(format)) ? ECF_A8R8G8B8 : format;
@@ -463,6 +423,79 @@ protected:
 		return destFormat;
 	}
 
+	void uploadImages(const core::array<IImage*>& image)
+	{
+		const core::array<IImage*>* tmpImage = &image;
+
+		if (KeepImage || OriginalSize != Size || OriginalColorFormat != ColorFormat)
+		{
+			Image.set_used(image.size());
+
+			for (u32 i = 0; i < image.size(); ++i)
+			{
+				Image[i] = Driver->createImage(ColorFormat, Size);
+
+				if (image[i]->getDimension() == Size)
+					image[i]->copyTo(Image[i]);
+				else
+					image[i]->copyToScaling(Image[i]);
+			}
+
+			tmpImage = &Image;
+		}
+
+		glGenTextures(1, &TextureName);
+
+		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
+		Driver->getCacheHandler()->getTextureCache().set(0, this);
+
+		glTexParameteri(TextureType, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(TextureType, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		if (HasMipMaps && AutoGenerateMipMaps)
+		{
+			if (Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_SPEED))
+				glHint(GL_GENERATE_MIPMAP_HINT, GL_FASTEST);
+			else if (Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_QUALITY))
+				glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST);
+			else
+				glHint(GL_GENERATE_MIPMAP_HINT, GL_DONT_CARE);
+		}
+
+#if (defined(IRR_OPENGL_VERSION) && IRR_OPENGL_VERSION < 20) || (defined(IRR_OPENGL_ES_VERSION) && IRR_OPENGL_ES_VERSION < 20)
+		if (HasMipMaps)
+			glTexParameteri(TextureType, GL_GENERATE_MIPMAP, (AutoGenerateMipMaps) ? GL_TRUE : GL_FALSE);
+#endif
+
+		for (u32 i = 0; i < (*tmpImage).size(); ++i)
+			uploadTexture(true, i, 0, (*tmpImage)[i]->getData());
+
+		bool autoGenerateRequired = true;
+
+		for (u32 i = 0; i < (*tmpImage).size(); ++i)
+		{
+			void* mipmapsData = (*tmpImage)[i]->getMipMapsData();
+
+			if (autoGenerateRequired || mipmapsData)
+				regenerateMipMapLevels(mipmapsData, i);
+
+			if (!mipmapsData)
+				autoGenerateRequired = false;
+		}
+
+		if (!KeepImage)
+		{
+			for (u32 i = 0; i < Image.size(); ++i)
+				Image[i]->drop();
+
+			Image.clear();
+		}
+
+		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
+
+		Driver->testGLError(__LINE__);
+	}
+
 	void getImageValues(const IImage* image)
 	{
 		OriginalColorFormat = image->getColorFormat();
@@ -34,7 +34,7 @@ const u16 COpenGLDriver::Quad2DIndices[4] = { 0, 1, 2, 3 };
 
 #if defined(_IRR_COMPILE_WITH_WINDOWS_DEVICE_) || defined(_IRR_COMPILE_WITH_X11_DEVICE_) || defined(_IRR_COMPILE_WITH_OSX_DEVICE_)
 COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params, io::IFileSystem* io, IContextManager* contextManager)
-	: CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(), CacheHandler(0), CurrentRenderMode(ERM_NONE), ResetRenderStates(true),
+	: CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(), CacheHandler(0), InstanceCount(1), CurrentRenderMode(ERM_NONE), ResetRenderStates(true),
 	Transformation3DChanged(true), AntiAlias(params.AntiAlias), ColorFormat(ECF_R8G8B8), FixedPipelineState(EOFPS_ENABLE), Params(params),
 	ContextManager(contextManager),
 #if defined(_IRR_COMPILE_WITH_WINDOWS_DEVICE_)
@@ -54,7 +54,7 @@ COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params, io::IFil
 #ifdef _IRR_COMPILE_WITH_SDL_DEVICE_
 COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params, io::IFileSystem* io, CIrrDeviceSDL* device)
 	: CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(), CacheHandler(0),
-	CurrentRenderMode(ERM_NONE), ResetRenderStates(true), Transformation3DChanged(true),
+	InstanceCount(1), CurrentRenderMode(ERM_NONE), ResetRenderStates(true), Transformation3DChanged(true),
 	AntiAlias(params.AntiAlias), ColorFormat(ECF_R8G8B8), FixedPipelineState(EOFPS_ENABLE),
 	Params(params), SDLDevice(device), ContextManager(0), DeviceType(EIDT_SDL)
 {
@@ -825,6 +825,7 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 		return;
 
 	CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
+	FrameStats.VerticesTransformed += vertexCount * InstanceCount;
 
 	if (vertices && !FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
 		getColorBuffer(vertices, vertexCount, vType);
@@ -975,6 +976,81 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 }
 
 
+//! Draws many instances of a mesh buffer
+void COpenGLDriver::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+	const core::matrix4* transforms, const SColor* colors, u32 instanceCount)
+{
+	if (!mb || !transforms || !instanceCount)
+		return;
+
+	// the instance attributes are read by the shader of the material
+	GLint program = 0;
+	if (queryFeature(EVDF_INSTANCING) && mb->getPrimitiveType() == scene::EPT_TRIANGLES)
+	{
+		setTransform(ETS_WORLD, core::IdentityMatrix);
+		setRenderStates3DMode();
+		glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	}
+
+	const GLint world = program ? extGlGetAttribLocation(program, "inInstanceWorld") : -1;
+	if (world < 0)
+	{
+		CNullDriver::drawMeshBufferInstanced(mb, transforms, colors, instanceCount);
+		return;
+	}
+
+	const GLint color = colors ? extGlGetAttribLocation(program, "inInstanceColor") : -1;
+
+	// the instance attributes point to client memory, which is only read
+	// without a bound vertex buffer
+	extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// a mat4 attribute uses four locations, one per column
+	for (u32 i=0; i<4; ++i)
+	{
+		extGlEnableVertexAttribArray(world+i);
+		extGlVertexAttribPointer(world+i, 4, GL_FLOAT, GL_FALSE, sizeof(core::matrix4), transforms[0].pointer()+i*4);
+		extGlVertexAttribDivisor(world+i, 1);
+	}
+
+	if (color >= 0)
+	{
+		extGlEnableVertexAttribArray(color);
+#ifdef GL_BGRA
+		if (FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra])
+			extGlVertexAttribPointer(color, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SColor), colors);
+		else
+#endif
+		{
+			InstanceColorBuffer.set_used(instanceCount*4);
+			for (u32 i=0; i<instanceCount; ++i)
+				colors[i].toOpenGLColor(&InstanceColorBuffer[i*4]);
+			extGlVertexAttribPointer(color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, InstanceColorBuffer.const_pointer());
+		}
+		extGlVertexAttribDivisor(color, 1);
+	}
+
+	InstanceCount = instanceCount;
+	drawMeshBuffer(mb);
+	InstanceCount = 1;
+
+	// only one instance was counted
+	PrimitivesDrawn += mb->getPrimitiveCount() * (instanceCount-1);
+
+	for (u32 i=0; i<4; ++i)
+	{
+		extGlVertexAttribDivisor(world+i, 0);
+		extGlDisableVertexAttribArray(world+i);
+	}
+
+	if (color >= 0)
+	{
+		extGlVertexAttribDivisor(color, 0);
+		extGlDisableVertexAttribArray(color);
+	}
+}
+
+
 void COpenGLDriver::getColorBuffer(const void* vertices, u32 vertexCount, E_VERTEX_TYPE vType)
 {
 	// convert colors to gl color format.
@@ -1114,7 +1190,10 @@ void COpenGLDriver::renderArray(const void* indexList, u32 primitiveCount,
 			glDrawElements(GL_TRIANGLE_FAN, primitiveCount+2, indexSize, indexList);
 			break;
 		case scene::EPT_TRIANGLES:
-			glDrawElements(GL_TRIANGLES, primitiveCount*3, indexSize, indexList);
+			if (InstanceCount > 1)
+				extGlDrawElementsInstanced(GL_TRIANGLES, primitiveCount*3, indexSize, indexList, InstanceCount);
+			else
+				glDrawElements(GL_TRIANGLES, primitiveCount*3, indexSize, indexList);
 			break;
 		case scene::EPT_QUAD_STRIP:
 			glDrawElements(GL_QUAD_STRIP, primitiveCount*2+2, indexSize, indexList);
@@ -1141,6 +1220,7 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 		return;
 
 	CNullDriver::draw2DVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
+	FrameStats.VerticesTransformed += vertexCount;
 
 	if (vertices && !FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
 		getColorBuffer(vertices, vertexCount, vType);
@@ -2117,6 +2197,8 @@ void COpenGLDriver::setRenderStates3DMode()
 
 	if (ResetRenderStates || LastMaterial != Material)
 	{
+		++FrameStats.MaterialChanges;
+
 		// unset old material
 
 		if (LastMaterial.MaterialType != Material.MaterialType &&
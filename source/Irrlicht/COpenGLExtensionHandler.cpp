@@ -68,6 +68,9 @@ COpenGLExtensionHandler::COpenGLExtensionHandler() :
 	pGlIsBufferARB(0), pGlGetBufferParameterivARB(0), pGlGetBufferPointervARB(0),
 	pGlProvokingVertexARB(0), pGlProvokingVertexEXT(0),
 	pGlProgramParameteriARB(0), pGlProgramParameteriEXT(0),
+	pGlGetAttribLocation(0), pGlVertexAttribPointer(0),
+	pGlEnableVertexAttribArray(0), pGlDisableVertexAttribArray(0),
+	pGlVertexAttribDivisorARB(0), pGlDrawElementsInstancedARB(0),
 	pGlGenQueriesARB(0), pGlDeleteQueriesARB(0), pGlIsQueryARB(0),
 	pGlBeginQueryARB(0), pGlEndQueryARB(0), pGlGetQueryivARB(0),
 	pGlGetQueryObjectivARB(0), pGlGetQueryObjectuivARB(0),
@@ -529,6 +532,14 @@ void COpenGLExtensionHandler::initExtensions(bool stencilBuffer)
 	pGlProgramParameteriARB= (PFNGLPROGRAMPARAMETERIARBPROC) IRR_OGL_LOAD_EXTENSION("glProgramParameteriARB");
 	pGlProgramParameteriEXT= (PFNGLPROGRAMPARAMETERIEXTPROC) IRR_OGL_LOAD_EXTENSION("glProgramParameteriEXT");
 
+	// instancing
+	pGlGetAttribLocation = (PFNGLGETATTRIBLOCATIONPROC) IRR_OGL_LOAD_EXTENSION("glGetAttribLocation");
+	pGlVertexAttribPointer = (PFNGLVERTEXATTRIBPOINTERPROC) IRR_OGL_LOAD_EXTENSION("glVertexAttribPointer");
+	pGlEnableVertexAttribArray = (PFNGLENABLEVERTEXATTRIBARRAYPROC) IRR_OGL_LOAD_EXTENSION("glEnableVertexAttribArray");
+	pGlDisableVertexAttribArray = (PFNGLDISABLEVERTEXATTRIBARRAYPROC) IRR_OGL_LOAD_EXTENSION("glDisableVertexAttribArray");
+	pGlVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARBPROC) IRR_OGL_LOAD_EXTENSION("glVertexAttribDivisorARB");
+	pGlDrawElementsInstancedARB = (PFNGLDRAWELEMENTSINSTANCEDARBPROC) IRR_OGL_LOAD_EXTENSION("glDrawElementsInstancedARB");
+
 	// occlusion query
 	pGlGenQueriesARB = (PFNGLGENQUERIESARBPROC) IRR_OGL_LOAD_EXTENSION("glGenQueriesARB");
 	pGlDeleteQueriesARB = (PFNGLDELETEQUERIESARBPROC) IRR_OGL_LOAD_EXTENSION("glDeleteQueriesARB");
@@ -863,6 +874,8 @@ bool COpenGLExtensionHandler::queryFeature(E_VIDEO_DRIVER_FEATURE feature) const
 		return (Version >= 130) || FeatureAvailable[IRR_ARB_texture_cube_map] || FeatureAvailable[IRR_EXT_texture_cube_map];
 	case EVDF_TEXTURE_CUBEMAP_SEAMLESS:
 		return FeatureAvailable[IRR_ARB_seamless_cube_map];
+	case EVDF_INSTANCING:
+		return FeatureAvailable[IRR_ARB_draw_instanced] && FeatureAvailable[IRR_ARB_instanced_arrays] && Version>=200;
 	default:
 		return false;
 	};
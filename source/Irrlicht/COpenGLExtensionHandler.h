@@ -1162,6 +1162,14 @@ class COpenGLExtensionHandler
 	void extGlProvokingVertex(GLenum mode);
 	void extGlProgramParameteri(GLuint program, GLenum pname, GLint value);
 
+	// instancing
+	GLint extGlGetAttribLocation(GLuint program, const char *name);
+	void extGlVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer);
+	void extGlEnableVertexAttribArray(GLuint index);
+	void extGlDisableVertexAttribArray(GLuint index);
+	void extGlVertexAttribDivisor(GLuint index, GLuint divisor);
+	void extGlDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount);
+
 	// occlusion query
 	void extGlGenQueries(GLsizei n, GLuint *ids);
 	void extGlDeleteQueries(GLsizei n, const GLuint *ids);
@@ -1308,6 +1316,12 @@ class COpenGLExtensionHandler
 		PFNGLPROVOKINGVERTEXEXTPROC pGlProvokingVertexEXT;
 		PFNGLPROGRAMPARAMETERIARBPROC pGlProgramParameteriARB;
 		PFNGLPROGRAMPARAMETERIEXTPROC pGlProgramParameteriEXT;
+		PFNGLGETATTRIBLOCATIONPROC pGlGetAttribLocation;
+		PFNGLVERTEXATTRIBPOINTERPROC pGlVertexAttribPointer;
+		PFNGLENABLEVERTEXATTRIBARRAYPROC pGlEnableVertexAttribArray;
+		PFNGLDISABLEVERTEXATTRIBARRAYPROC pGlDisableVertexAttribArray;
+		PFNGLVERTEXATTRIBDIVISORARBPROC pGlVertexAttribDivisorARB;
+		PFNGLDRAWELEMENTSINSTANCEDARBPROC pGlDrawElementsInstancedARB;
 		PFNGLGENQUERIESARBPROC pGlGenQueriesARB;
 		PFNGLDELETEQUERIESARBPROC pGlDeleteQueriesARB;
 		PFNGLISQUERYARBPROC pGlIsQueryARB;
@@ -2471,6 +2485,79 @@ inline void COpenGLExtensionHandler::extGlProgramParameteri(GLuint program, GLen
 #endif
 }
 
+inline GLint COpenGLExtensionHandler::extGlGetAttribLocation(GLuint program, const char *name)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlGetAttribLocation)
+		return pGlGetAttribLocation(program, name);
+#elif defined(GL_VERSION_2_0)
+	return glGetAttribLocation(program, name);
+#else
+	os::Printer::log("glGetAttribLocation not supported", ELL_ERROR);
+#endif
+	return -1;
+}
+
+inline void COpenGLExtensionHandler::extGlVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlVertexAttribPointer)
+		pGlVertexAttribPointer(index, size, type, normalized, stride, pointer);
+#elif defined(GL_VERSION_2_0)
+	glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+#else
+	os::Printer::log("glVertexAttribPointer not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlEnableVertexAttribArray(GLuint index)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlEnableVertexAttribArray)
+		pGlEnableVertexAttribArray(index);
+#elif defined(GL_VERSION_2_0)
+	glEnableVertexAttribArray(index);
+#else
+	os::Printer::log("glEnableVertexAttribArray not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlDisableVertexAttribArray(GLuint index)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlDisableVertexAttribArray)
+		pGlDisableVertexAttribArray(index);
+#elif defined(GL_VERSION_2_0)
+	glDisableVertexAttribArray(index);
+#else
+	os::Printer::log("glDisableVertexAttribArray not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlVertexAttribDivisorARB)
+		pGlVertexAttribDivisorARB(index, divisor);
+#elif defined(GL_ARB_instanced_arrays)
+	glVertexAttribDivisorARB(index, divisor);
+#else
+	os::Printer::log("glVertexAttribDivisor not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlDrawElementsInstancedARB)
+		pGlDrawElementsInstancedARB(mode, count, type, indices, primcount);
+#elif defined(GL_ARB_draw_instanced)
+	glDrawElementsInstancedARB(mode, count, type, indices, primcount);
+#else
+	os::Printer::log("glDrawElementsInstanced not supported", ELL_ERROR);
+#endif
+}
+
 inline void COpenGLExtensionHandler::extGlGenQueries(GLsizei n, GLuint *ids)
 {
 #ifdef _IRR_OPENGL_USE_EXTPOINTER_
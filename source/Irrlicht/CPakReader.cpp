@@ -7,6 +7,7 @@
 
 #ifdef __IRR_COMPILE_WITH_PAK_ARCHIVE_LOADER_
 
+#include "CLimitReadFile.h"
 #include "os.h"
 #include "coreutil.h"
 
@@ -108,7 +109,7 @@ CPakReader::CPakReader(IReadFile* file, bool ignoreCase, bool ignorePaths)
 
 	if (File)
 	{
-		File->grab();
+		grabSharedFile(File);
 		scanLocalHeader();
 		sort();
 	}
@@ -118,7 +119,7 @@ CPakReader::CPakReader(IReadFile* file, bool ignoreCase, bool ignorePaths)
 CPakReader::~CPakReader()
 {
 	if (File)
-		File->drop();
+		dropSharedFile(File);
 }
 
 
@@ -4,6 +4,19 @@
 
 #include "CProfiler.h"
 #include "CTimer.h"
+#include "os.h"
+#include "irrMap.h"
+
+#if defined(_IRR_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#endif
+
+#if defined(_MSC_VER)
+	#define _IRR_THREAD_LOCAL __declspec(thread)
+#else
+	#define _IRR_THREAD_LOCAL __thread
+#endif
 
 namespace irr
 {
@@ -13,7 +26,45 @@ IRRLICHT_API IProfiler& IRRCALLCONV getProfiler()
 	return profiler;
 }
 
+namespace
+{
+	// returns the value before the increment
+	inline u32 atomicIncrement(volatile u32* value)
+	{
+#if defined(_IRR_WINDOWS_API_)
+		return (u32)InterlockedIncrement((volatile LONG*)value) - 1;
+#else
+		return __sync_fetch_and_add(value, 1);
+#endif
+	}
+
+	// thread numbers for the timeline, 0 means not assigned yet
+	_IRR_THREAD_LOCAL u32 TraceThread = 0;
+	volatile u32 TraceThreadCount = 0;
+
+	// append a string with JSON escaping
+	void appendJsonString(core::stringc& result, const core::stringc& str)
+	{
+		result += '"';
+		for (u32 i=0; i<str.size(); ++i)
+		{
+			const c8 c = str[i];
+			if (c == '"' || c == '\\')
+			{
+				result += '\\';
+				result += c;
+			}
+			else if ((u8)c < 0x20)
+				result += ' ';
+			else
+				result += c;
+		}
+		result += '"';
+	}
+}
+
 CProfiler::CProfiler()
+: TraceMask(0), TraceWritten(0), TraceStartTime(0)
 {
 	Timer = new CTimer(true);
 
@@ -95,6 +146,120 @@ core::stringw CProfiler::getAsString(const SProfileData& data) const
 	}
 }
 
+void CProfiler::startTrace(u32 maxEvents)
+{
+	Tracing = false;
+
+	u32 size = 1;
+	while ( size < maxEvents && size < 0x80000000 )
+		size <<= 1;
+
+	TraceEvents.set_used(size);
+	TraceMask = size - 1;
+	TraceWritten = 0;
+	TraceStartTime = os::Timer::getRealTimeMicroseconds();
+
+	Tracing = true;
+}
+
+void CProfiler::stopTrace()
+{
+	Tracing = false;
+}
+
+u32 CProfiler::getTraceEventCount() const
+{
+	return core::min_((u32)TraceWritten, TraceEvents.size());
+}
+
+void CProfiler::addTraceEvent(s32 id, bool begin)
+{
+	if ( !TraceThread )
+		TraceThread = atomicIncrement(&TraceThreadCount) + 1;
+
+	// several threads can add events, each one gets its own slot
+	STraceEvent& event = TraceEvents[atomicIncrement(&TraceWritten) & TraceMask];
+	event.Time = os::Timer::getRealTimeMicroseconds();
+	event.Id = id;
+	event.Thread = TraceThread;
+	event.Begin = begin;
+}
+
+u32 CProfiler::atomicAdd(u32& value, u32 add)
+{
+#if defined(_IRR_WINDOWS_API_)
+	return (u32)InterlockedExchangeAdd((volatile LONG*)&value, (LONG)add) + add;
+#else
+	return __sync_add_and_fetch(&value, add);
+#endif
+}
+
+bool CProfiler::atomicCompareAndSwap(u32& value, u32 expected, u32 newValue)
+{
+#if defined(_IRR_WINDOWS_API_)
+	return (u32)InterlockedCompareExchange((volatile LONG*)&value, (LONG)newValue, (LONG)expected) == expected;
+#else
+	return __sync_bool_compare_and_swap(&value, expected, newValue);
+#endif
+}
+
+void CProfiler::printTrace(core::stringc &ostream) const
+{
+	// names are converted once, not per event
+	core::array<core::stringc> names(ProfileDatas.size());
+	core::array<core::stringc> groups(ProfileDatas.size());
+	for ( u32 i=0; i<ProfileDatas.size(); ++i )
+	{
+		names.push_back(core::stringc(ProfileDatas[i].getName()));
+		groups.push_back(core::stringc(ProfileGroups[ProfileDatas[i].getGroupIndex()].getName()));
+	}
+
+	// open events per thread, to skip stop events which lost their start event
+	core::map<u32, u32> depth;
+
+	ostream += "{\"traceEvents\":[";
+	bool first = true;
+	const u32 written = TraceWritten;
+	const u32 count = core::min_(written, TraceEvents.size());
+	for ( u32 i=written-count; i != written; ++i )
+	{
+		const STraceEvent& event = TraceEvents[i & TraceMask];
+		const s32 idx = getDataIndexById(event.Id);
+		if ( idx < 0 || event.Time < TraceStartTime )
+			continue;
+
+		core::map<u32, u32>::Node* node = depth.find(event.Thread);
+		if ( event.Begin )
+		{
+			if ( node )
+				node->setValue(node->getValue() + 1);
+			else
+				depth.insert(event.Thread, 1);
+		}
+		else
+		{
+			if ( !node || node->getValue() == 0 )
+				continue;
+			node->setValue(node->getValue() - 1);
+		}
+
+		if ( !first )
+			ostream += ",";
+		first = false;
+
+		ostream += "\n{\"name\":";
+		appendJsonString(ostream, names[idx]);
+		ostream += ",\"cat\":";
+		appendJsonString(ostream, groups[idx]);
+
+		c8 dummy[128];
+		snprintf_irr(dummy, 128, ",\"ph\":\"%c\",\"ts\":%llu,\"pid\":1,\"tid\":%u}",
+			event.Begin ? 'B' : 'E', (unsigned long long)(event.Time - TraceStartTime), event.Thread);
+		ostream += dummy;
+	}
+	ostream += "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
 //! Return a string which describes the columns returned by getAsString
 core::stringw CProfiler::makeTitleString() const
 {
@@ -23,9 +23,45 @@ public:
 	//! Write the profile data of one group into a string
     virtual void printGroup(core::stringw &result, u32 groupIndex, bool suppressUncalled) const  _IRR_OVERRIDE_;
 
+	//! Start recording a timeline of all start and stop calls
+	virtual void startTrace(u32 maxEvents) _IRR_OVERRIDE_;
+
+	//! Stop recording the timeline
+	virtual void stopTrace() _IRR_OVERRIDE_;
+
+	//! Return the number of events in the ring buffer
+	virtual u32 getTraceEventCount() const _IRR_OVERRIDE_;
+
+	//! Write the recorded timeline in the Chrome trace event format
+	virtual void printTrace(core::stringc &result) const _IRR_OVERRIDE_;
+
 protected:
 	core::stringw makeTitleString() const;
 	core::stringw getAsString(const SProfileData& data) const;
+
+	//! Record a start or stop event for the timeline
+	virtual void addTraceEvent(s32 id, bool begin) _IRR_OVERRIDE_;
+
+	//! Atomically add to a value of the profile data, returns the new value
+	virtual u32 atomicAdd(u32& value, u32 add) _IRR_OVERRIDE_;
+
+	//! Atomically replace a value of the profile data if it still is the expected one
+	virtual bool atomicCompareAndSwap(u32& value, u32 expected, u32 newValue) _IRR_OVERRIDE_;
+
+	struct STraceEvent
+	{
+		u64 Time;	// microseconds
+		s32 Id;
+		u32 Thread;
+		bool Begin;
+	};
+
+	//! ring buffer, size is a power of two
+	core::array<STraceEvent> TraceEvents;
+	u32 TraceMask;
+	//! number of events written since startTrace, only increased atomically
+	volatile u32 TraceWritten;
+	u64 TraceStartTime;
 };
 } // namespace irr
 
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CReadFile.h"
+#include "CMappedReadFile.h"
 
 namespace irr
 {
@@ -99,6 +100,10 @@ const io::path& CReadFile::getFileName() const
 
 IReadFile* CReadFile::createReadFile(const io::path& fileName)
 {
+	IReadFile* mapped = CMappedReadFile::createMappedReadFile(fileName);
+	if (mapped)
+		return mapped;
+
 	CReadFile* file = new CReadFile(fileName);
 	if (file->isOpen())
 		return file;
@@ -18,7 +18,7 @@ namespace scene
 
 //! constructor
 CSceneCollisionManager::CSceneCollisionManager(ISceneManager* smanager, video::IVideoDriver* driver)
-: SceneManager(smanager), Driver(driver)
+: SceneManager(smanager), Driver(driver), NodeTree(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CSceneCollisionManager");
@@ -34,6 +34,9 @@ CSceneCollisionManager::~CSceneCollisionManager()
 {
 	if (Driver)
 		Driver->drop();
+
+	if (NodeTree)
+		NodeTree->drop();
 }
 
 
@@ -62,8 +65,13 @@ ISceneNode* CSceneCollisionManager::getSceneNodeFromRayBB(
 
 	core::line3d<f32> truncatableRay(ray);
 
-	getPickedNodeBB((root==0)?SceneManager->getRootSceneNode():root, truncatableRay,
-		idBitMask, noDebugObjects, dist, best);
+	if (!root)
+		root = SceneManager->getRootSceneNode();
+
+	if (NodeTree && isInScene(root))
+		getPickedNodeFromTree(root, truncatableRay, idBitMask, noDebugObjects, dist, best);
+	else
+		getPickedNodeBB(root, truncatableRay, idBitMask, noDebugObjects, dist, best);
 
 	return best;
 }
@@ -87,138 +95,173 @@ void CSceneCollisionManager::getPickedNodeBB(ISceneNode* root,
 			if((noDebugObjects ? !current->isDebugObject() : true) &&
 				(bits==0 || (bits != 0 && (current->getID() & bits))))
 			{
-				// Assume that single-point bounding-boxes are not meant for collision
-				const core::aabbox3df & objectBox = current->getBoundingBox();
-				if ( objectBox.isEmpty() )
-					continue;
-
-				// get world to object space transform
-				core::matrix4 worldToObject;
-				if (!current->getAbsoluteTransformation().getInverse(worldToObject))
-					continue;
-
-				// transform vector from world space to object space
-				core::line3df objectRay(ray);
-				worldToObject.transformVect(objectRay.start);
-				worldToObject.transformVect(objectRay.end);
-
-				// Do the initial intersection test in object space, since the
-				// object space box test is more accurate.
-				if(objectBox.isPointInside(objectRay.start))
-				{
-					// use fast bbox intersection to find distance to hitpoint
-					// algorithm from Kay et al., code from gamedev.net
-					const core::vector3df dir = (objectRay.end-objectRay.start).normalize();
-					const core::vector3df minDist = (objectBox.MinEdge - objectRay.start)/dir;
-					const core::vector3df maxDist = (objectBox.MaxEdge - objectRay.start)/dir;
-					const core::vector3df realMin(core::min_(minDist.X, maxDist.X),core::min_(minDist.Y, maxDist.Y),core::min_(minDist.Z, maxDist.Z));
-					const core::vector3df realMax(core::max_(minDist.X, maxDist.X),core::max_(minDist.Y, maxDist.Y),core::max_(minDist.Z, maxDist.Z));
-
-					const f32 minmax = core::min_(realMax.X, realMax.Y, realMax.Z);
-					// nearest distance to intersection
-					const f32 maxmin = core::max_(realMin.X, realMin.Y, realMin.Z);
-
-					const f32 toIntersectionSq = (maxmin>0?maxmin*maxmin:minmax*minmax);
-					if (toIntersectionSq < outbestdistance)
-					{
-						outbestdistance = toIntersectionSq;
-						outbestnode = current;
+				testNodeBB(current, ray, rayVector, outbestdistance, outbestnode);
+			}
 
-						// And we can truncate the ray to stop us hitting further nodes.
-						ray.end = ray.start + (rayVector * sqrtf(toIntersectionSq));
-					}
-				}
-				else
-				if (objectBox.intersectsWithLine(objectRay))
-				{
-					// Now transform into world space, since we need to use world space
-					// scales and distances.
-					core::aabbox3df worldBox(objectBox);
-					current->getAbsoluteTransformation().transformBoxEx(worldBox);
-
-					core::vector3df edges[8];
-					worldBox.getEdges(edges);
-
-					/* We need to check against each of 6 faces, composed of these corners:
-						  /3--------/7
-						 /  |      / |
-						/   |     /  |
-						1---------5  |
-						|   2- - -| -6
-						|  /      |  /
-						|/        | /
-						0---------4/
-
-						Note that we define them as opposite pairs of faces.
-					*/
-					static const s32 faceEdges[6][3] =
-					{
-						{ 0, 1, 5 }, // Front
-						{ 6, 7, 3 }, // Back
-						{ 2, 3, 1 }, // Left
-						{ 4, 5, 7 }, // Right
-						{ 1, 3, 7 }, // Top
-						{ 2, 0, 4 }  // Bottom
-					};
-
-					core::vector3df intersection;
-					core::plane3df facePlane;
-					f32 bestDistToBoxBorder = FLT_MAX;
-					f32 bestToIntersectionSq = FLT_MAX;
-
-                    for(s32 face = 0; face < 6; ++face)
-					{
-						facePlane.setPlane(edges[faceEdges[face][0]],
-											edges[faceEdges[face][1]],
-											edges[faceEdges[face][2]]);
-
-						// Only consider lines that might be entering through this face, since we
-						// already know that the start point is outside the box.
-						if(facePlane.classifyPointRelation(ray.start) != core::ISREL3D_FRONT)
-							continue;
-
-						// Don't bother using a limited ray, since we already know that it should be long
-						// enough to intersect with the box.
-						if(facePlane.getIntersectionWithLine(ray.start, rayVector, intersection))
-						{
-							const f32 toIntersectionSq = ray.start.getDistanceFromSQ(intersection);
-							if(toIntersectionSq < outbestdistance)
-							{
-								// We have to check that the intersection with this plane is actually
-								// on the box, so need to go back to object space again.
-								worldToObject.transformVect(intersection);
-
-                                // find the closest point on the box borders. Have to do this as exact checks will fail due to floating point problems.
-								f32 distToBorder = core::max_ ( core::min_ (core::abs_(objectBox.MinEdge.X-intersection.X), core::abs_(objectBox.MaxEdge.X-intersection.X)),
-                                                                core::min_ (core::abs_(objectBox.MinEdge.Y-intersection.Y), core::abs_(objectBox.MaxEdge.Y-intersection.Y)),
-                                                                core::min_ (core::abs_(objectBox.MinEdge.Z-intersection.Z), core::abs_(objectBox.MaxEdge.Z-intersection.Z)) );
-                                if ( distToBorder < bestDistToBoxBorder )
-                                {
-                                    bestDistToBoxBorder = distToBorder;
-                                    bestToIntersectionSq = toIntersectionSq;
-                                }
-							}
-						}
-
-						// If the ray could be entering through the first face of a pair, then it can't
-						// also be entering through the opposite face, and so we can skip that face.
-						if (!(face & 0x01))
-							++face;
-					}
+			// Only check the children if this node is visible.
+			getPickedNodeBB(current, ray, bits, noDebugObjects, outbestdistance, outbestnode);
+		}
+	}
+}
 
-					if ( bestDistToBoxBorder < FLT_MAX )
-					{
-                        outbestdistance = bestToIntersectionSq;
-						outbestnode = current;
 
-                        // If we got a hit, we can now truncate the ray to stop us hitting further nodes.
-                        ray.end = ray.start + (rayVector * sqrtf(outbestdistance));
+//! tests the nodes whose boxes in the tree are hit by the ray, nearest first
+void CSceneCollisionManager::getPickedNodeFromTree(ISceneNode* root,
+		core::line3df& ray, s32 bits, bool noDebugObjects,
+		f32& outbestdistance, ISceneNode*& outbestnode)
+{
+	const core::vector3df rayVector = ray.getVector().normalize();
+
+	core::array<CSceneNodeTree::SLineHit> hits;
+	NodeTree->getNodesOnLine(ray, hits);
+	for (u32 i=0; i<hits.size(); ++i)
+	{
+		// the ray enters the boxes of all following nodes later
+		if (hits[i].DistanceSQ >= outbestdistance)
+			break;
+
+		ISceneNode* current = hits[i].Node;
+		if((noDebugObjects ? !current->isDebugObject() : true) &&
+			(bits==0 || (bits != 0 && (current->getID() & bits))) &&
+			isFoundBelow(current, root, true))
+		{
+			testNodeBB(current, ray, rayVector, outbestdistance, outbestnode);
+		}
+	}
+}
+
+
+//! tests the bounding box of one node against the ray
+void CSceneCollisionManager::testNodeBB(ISceneNode* current,
+		core::line3df& ray, const core::vector3df& rayVector,
+		f32& outbestdistance, ISceneNode*& outbestnode)
+{
+	// Assume that single-point bounding-boxes are not meant for collision
+	const core::aabbox3df & objectBox = current->getBoundingBox();
+	if ( objectBox.isEmpty() )
+		return;
+
+	// get world to object space transform
+	core::matrix4 worldToObject;
+	if (!current->getAbsoluteTransformation().getInverse(worldToObject))
+		return;
+
+	// transform vector from world space to object space
+	core::line3df objectRay(ray);
+	worldToObject.transformVect(objectRay.start);
+	worldToObject.transformVect(objectRay.end);
+
+	// Do the initial intersection test in object space, since the
+	// object space box test is more accurate.
+	if(objectBox.isPointInside(objectRay.start))
+	{
+		// use fast bbox intersection to find distance to hitpoint
+		// algorithm from Kay et al., code from gamedev.net
+		const core::vector3df dir = (objectRay.end-objectRay.start).normalize();
+		const core::vector3df minDist = (objectBox.MinEdge - objectRay.start)/dir;
+		const core::vector3df maxDist = (objectBox.MaxEdge - objectRay.start)/dir;
+		const core::vector3df realMin(core::min_(minDist.X, maxDist.X),core::min_(minDist.Y, maxDist.Y),core::min_(minDist.Z, maxDist.Z));
+		const core::vector3df realMax(core::max_(minDist.X, maxDist.X),core::max_(minDist.Y, maxDist.Y),core::max_(minDist.Z, maxDist.Z));
+
+		const f32 minmax = core::min_(realMax.X, realMax.Y, realMax.Z);
+		// nearest distance to intersection
+		const f32 maxmin = core::max_(realMin.X, realMin.Y, realMin.Z);
+
+		const f32 toIntersectionSq = (maxmin>0?maxmin*maxmin:minmax*minmax);
+		if (toIntersectionSq < outbestdistance)
+		{
+			outbestdistance = toIntersectionSq;
+			outbestnode = current;
+
+			// And we can truncate the ray to stop us hitting further nodes.
+			ray.end = ray.start + (rayVector * sqrtf(toIntersectionSq));
+		}
+	}
+	else
+	if (objectBox.intersectsWithLine(objectRay))
+	{
+		// Now transform into world space, since we need to use world space
+		// scales and distances.
+		core::aabbox3df worldBox(objectBox);
+		current->getAbsoluteTransformation().transformBoxEx(worldBox);
+
+		core::vector3df edges[8];
+		worldBox.getEdges(edges);
+
+		/* We need to check against each of 6 faces, composed of these corners:
+			  /3--------/7
+			 /  |      / |
+			/   |     /  |
+			1---------5  |
+			|   2- - -| -6
+			|  /      |  /
+			|/        | /
+			0---------4/
+
+			Note that we define them as opposite pairs of faces.
+		*/
+		static const s32 faceEdges[6][3] =
+		{
+			{ 0, 1, 5 }, // Front
+			{ 6, 7, 3 }, // Back
+			{ 2, 3, 1 }, // Left
+			{ 4, 5, 7 }, // Right
+			{ 1, 3, 7 }, // Top
+			{ 2, 0, 4 }  // Bottom
+		};
+
+		core::vector3df intersection;
+		core::plane3df facePlane;
+		f32 bestDistToBoxBorder = FLT_MAX;
+		f32 bestToIntersectionSq = FLT_MAX;
+
+		for(s32 face = 0; face < 6; ++face)
+		{
+			facePlane.setPlane(edges[faceEdges[face][0]],
+								edges[faceEdges[face][1]],
+								edges[faceEdges[face][2]]);
+
+			// Only consider lines that might be entering through this face, since we
+			// already know that the start point is outside the box.
+			if(facePlane.classifyPointRelation(ray.start) != core::ISREL3D_FRONT)
+				continue;
+
+			// Don't bother using a limited ray, since we already know that it should be long
+			// enough to intersect with the box.
+			if(facePlane.getIntersectionWithLine(ray.start, rayVector, intersection))
+			{
+				const f32 toIntersectionSq = ray.start.getDistanceFromSQ(intersection);
+				if(toIntersectionSq < outbestdistance)
+				{
+					// We have to check that the intersection with this plane is actually
+					// on the box, so need to go back to object space again.
+					worldToObject.transformVect(intersection);
+
+					// find the closest point on the box borders. Have to do this as exact checks will fail due to floating point problems.
+					f32 distToBorder = core::max_ ( core::min_ (core::abs_(objectBox.MinEdge.X-intersection.X), core::abs_(objectBox.MaxEdge.X-intersection.X)),
+													core::min_ (core::abs_(objectBox.MinEdge.Y-intersection.Y), core::abs_(objectBox.MaxEdge.Y-intersection.Y)),
+													core::min_ (core::abs_(objectBox.MinEdge.Z-intersection.Z), core::abs_(objectBox.MaxEdge.Z-intersection.Z)) );
+					if ( distToBorder < bestDistToBoxBorder )
+					{
+						bestDistToBoxBorder = distToBorder;
+						bestToIntersectionSq = toIntersectionSq;
 					}
 				}
 			}
 
-			// Only check the children if this node is visible.
-			getPickedNodeBB(current, ray, bits, noDebugObjects, outbestdistance, outbestnode);
+			// If the ray could be entering through the first face of a pair, then it can't
+			// also be entering through the opposite face, and so we can skip that face.
+			if (!(face & 0x01))
+				++face;
+		}
+
+		if ( bestDistToBoxBorder < FLT_MAX )
+		{
+			outbestdistance = bestToIntersectionSq;
+			outbestnode = current;
+
+			// If we got a hit, we can now truncate the ray to stop us hitting further nodes.
+			ray.end = ray.start + (rayVector * sqrtf(outbestdistance));
 		}
 	}
 }
@@ -259,8 +302,31 @@ ISceneNode* CSceneCollisionManager::getSceneNodeAndCollisionPointFromRay(
 
 	f32 bestDistanceSquared = FLT_MAX;
 	core::line3df rayRest(ray);
-	getPickedNodeFromBBAndSelector(hitResult, collisionRootNode, rayRest, idBitMask,
-					noDebugObjects, bestDistanceSquared);
+
+	// the tree only skips the nodes whose boxes are not hit at all
+	if (NodeTree && isInScene(collisionRootNode))
+	{
+		core::array<CSceneNodeTree::SLineHit> hits;
+		NodeTree->getNodesOnLine(rayRest, hits);
+		for (u32 i=0; i<hits.size(); ++i)
+		{
+			ISceneNode* current = hits[i].Node;
+			ITriangleSelector * selector = current->getTriangleSelector();
+
+			if (selector && current->isVisible() &&
+				(noDebugObjects ? !current->isDebugObject() : true) &&
+				(idBitMask==0 || (idBitMask != 0 && (current->getID() & idBitMask))) &&
+				isFoundBelow(current, collisionRootNode, false))
+			{
+				testNodeSelector(hitResult, current, selector, rayRest, bestDistanceSquared);
+			}
+		}
+	}
+	else
+	{
+		getPickedNodeFromBBAndSelector(hitResult, collisionRootNode, rayRest, idBitMask,
+						noDebugObjects, bestDistanceSquared);
+	}
 	return hitResult.Node;
 }
 
@@ -285,39 +351,154 @@ void CSceneCollisionManager::getPickedNodeFromBBAndSelector(
 			(noDebugObjects ? !current->isDebugObject() : true) &&
 			(bits==0 || (bits != 0 && (current->getID() & bits))))
 		{
-			// get world to object space transform
-			core::matrix4 mat;
-			if (!current->getAbsoluteTransformation().getInverse(mat))
-			continue;
+			testNodeSelector(hitResult, current, selector, ray, outBestDistanceSquared);
+		}
+
+		getPickedNodeFromBBAndSelector(hitResult, current, ray, bits, noDebugObjects,
+						outBestDistanceSquared);
+	}
+}
 
-			// transform vector from world space to object space
-			core::line3df line(ray);
-			mat.transformVect(line.start);
-			mat.transformVect(line.end);
 
-			const core::aabbox3df& box = current->getBoundingBox();
+//! tests the triangles of one node against the ray
+void CSceneCollisionManager::testNodeSelector(SCollisionHit& hitResult,
+				ISceneNode* current, ITriangleSelector* selector,
+				core::line3df& ray, f32& outBestDistanceSquared)
+{
+	// get world to object space transform
+	core::matrix4 mat;
+	if (!current->getAbsoluteTransformation().getInverse(mat))
+		return;
 
-			SCollisionHit candidateHitResult;
+	// transform vector from world space to object space
+	core::line3df line(ray);
+	mat.transformVect(line.start);
+	mat.transformVect(line.end);
+
+	const core::aabbox3df& box = current->getBoundingBox();
+
+	SCollisionHit candidateHitResult;
+
+	// do intersection test in object space
+	if (box.intersectsWithLine(line) &&
+		getCollisionPoint(candidateHitResult, ray, selector))
+	{
+		const f32 distanceSquared = (candidateHitResult.Intersection - ray.start).getLengthSQ();
+
+		if(distanceSquared < outBestDistanceSquared)
+		{
+			outBestDistanceSquared = distanceSquared;
+			hitResult = candidateHitResult;
+			const core::vector3df rayVector = ray.getVector().normalize();
+			ray.end = ray.start + (rayVector * sqrtf(distanceSquared));
+		}
+	}
+}
 
-			// do intersection test in object space
-			if (box.intersectsWithLine(line) &&
-				getCollisionPoint(candidateHitResult, ray, selector))
+
+//! Collects the scene nodes whose bounding box intersects a box.
+void CSceneCollisionManager::getSceneNodesFromBox(const core::aabbox3d<f32>& box,
+		core::array<ISceneNode*>& outNodes, s32 idBitMask,
+		bool noDebugObjects, ISceneNode* root)
+{
+	outNodes.set_used(0);
+
+	if (!root)
+		root = SceneManager->getRootSceneNode();
+
+	if (NodeTree && isInScene(root))
+	{
+		NodeTree->getNodesInBox(box, outNodes);
+
+		// keep the nodes which visiting all nodes would find
+		u32 count = 0;
+		for (u32 i=0; i<outNodes.size(); ++i)
+		{
+			ISceneNode* current = outNodes[i];
+			if((noDebugObjects ? !current->isDebugObject() : true) &&
+				(idBitMask==0 || (idBitMask != 0 && (current->getID() & idBitMask))) &&
+				!current->getBoundingBox().isEmpty() &&
+				isFoundBelow(current, root, true))
 			{
-				const f32 distanceSquared = (candidateHitResult.Intersection - ray.start).getLengthSQ();
+				outNodes[count++] = current;
+			}
+		}
+		outNodes.set_used(count);
+	}
+	else
+	{
+		getNodesFromBoxBB(root, box, idBitMask, noDebugObjects, outNodes);
+	}
+}
 
-				if(distanceSquared < outBestDistanceSquared)
-				{
-					outBestDistanceSquared = distanceSquared;
-					hitResult = candidateHitResult;
-					const core::vector3df rayVector = ray.getVector().normalize();
-					ray.end = ray.start + (rayVector * sqrtf(distanceSquared));
-				}
+
+//! recursive method for collecting the nodes in a box
+void CSceneCollisionManager::getNodesFromBoxBB(ISceneNode* root,
+		const core::aabbox3df& box, s32 bits, bool noDebugObjects,
+		core::array<ISceneNode*>& outNodes)
+{
+	const ISceneNodeList& children = root->getChildren();
+
+	ISceneNodeList::ConstIterator it = children.begin();
+	for (; it != children.end(); ++it)
+	{
+		ISceneNode* current = *it;
+
+		if (current->isVisible())
+		{
+			if((noDebugObjects ? !current->isDebugObject() : true) &&
+				(bits==0 || (bits != 0 && (current->getID() & bits))) &&
+				!current->getBoundingBox().isEmpty())
+			{
+				core::aabbox3df worldBox(current->getBoundingBox());
+				current->getAbsoluteTransformation().transformBoxEx(worldBox);
+				if (worldBox.intersectsWithBox(box))
+					outNodes.push_back(current);
 			}
+
+			// Only check the children if this node is visible.
+			getNodesFromBoxBB(current, box, bits, noDebugObjects, outNodes);
 		}
+	}
+}
 
-		getPickedNodeFromBBAndSelector(hitResult, current, ray, bits, noDebugObjects,
-						outBestDistanceSquared);
+
+//! returns if a node is part of the scene of the scene manager
+bool CSceneCollisionManager::isInScene(const ISceneNode* node) const
+{
+	while (node->getParent())
+		node = node->getParent();
+
+	return node == SceneManager->getRootSceneNode();
+}
+
+
+//! returns if a node found in the tree is a child of root and would be found by visiting the nodes
+/** The tree still holds nodes which were removed since the last update,
+their chain of parents does not lead to root anymore. */
+bool CSceneCollisionManager::isFoundBelow(const ISceneNode* node,
+		const ISceneNode* root, bool visibleParents) const
+{
+	if (node == root || !node->isVisible())
+		return false;
+
+	for (node = node->getParent(); node != root; node = node->getParent())
+	{
+		if (!node || (visibleParents && !node->isVisible()))
+			return false;
 	}
+	return true;
+}
+
+
+//! sets the tree of the node bounds used for the queries, 0 to visit all nodes
+void CSceneCollisionManager::setSceneNodeTree(CSceneNodeTree* tree)
+{
+	if (tree)
+		tree->grab();
+	if (NodeTree)
+		NodeTree->drop();
+	NodeTree = tree;
 }
 
 
@@ -344,15 +525,31 @@ bool CSceneCollisionManager::getCollisionPoint(SCollisionHit& hitResult, const c
 		return false;
 	}
 
+	// hierarchies find the nearest hit without copying all triangles near the ray
+	if ( selector->hasHierarchy() )
+	{
+		SCollisionTriangleRange triangleInfo;
+		if ( !selector->getCollisionPoint(ray, hitResult.Intersection, hitResult.Triangle, &triangleInfo) )
+			return false;
+
+		hitResult.Node = triangleInfo.SceneNode;
+		hitResult.MeshBuffer = triangleInfo.MeshBuffer;
+		hitResult.MaterialIndex = triangleInfo.MaterialIndex;
+		hitResult.TriangleSelector = triangleInfo.Selector;
+		return true;
+	}
+
 	s32 totalcnt = selector->getTriangleCount();
 	if ( totalcnt <= 0 )
 		return false;
 
-	Triangles.set_used(totalcnt);
+	// local, animators may collide on several threads
+	core::array<core::triangle3df> triangles(totalcnt);
+	triangles.set_used(totalcnt);
 
 	s32 cnt = 0;
 	irr::core::array<SCollisionTriangleRange> outTriangleInfo;
-	selector->getTriangles(Triangles.pointer(), totalcnt, cnt, ray, 0, true, &outTriangleInfo);
+	selector->getTriangles(triangles.pointer(), totalcnt, cnt, ray, 0, true, &outTriangleInfo);
 
 	const core::vector3df linevect = ray.getVector().normalize();
 	core::vector3df intersection;
@@ -369,7 +566,7 @@ bool CSceneCollisionManager::getCollisionPoint(SCollisionHit& hitResult, const c
 
 	for (s32 i=0; i<cnt; ++i)
 	{
-		const core::triangle3df & triangle = Triangles[i];
+		const core::triangle3df & triangle = triangles[i];
 
 		if(minX > triangle.pointA.X && minX > triangle.pointB.X && minX > triangle.pointC.X)
 			continue;
@@ -689,6 +886,21 @@ bool CSceneCollisionManager::testTriangleIntersection(SCollisionData* colData,
 }
 
 
+//! tests the triangles passed by a selector against the collision data
+struct CSceneCollisionManager::SCollisionCallback : public ITriangleCallback
+{
+	virtual bool onTriangle(const core::triangle3df& triangle, const SCollisionTriangleRange& info) _IRR_OVERRIDE_
+	{
+		if (Manager->testTriangleIntersection(ColData, triangle))
+			ColData->node = info.SceneNode;
+		return true;
+	}
+
+	CSceneCollisionManager* Manager;
+	SCollisionData* ColData;
+};
+
+
 //! Collides a moving ellipsoid with a 3d world with gravity and returns
 //! the resulting new position of the ellipsoid.
 core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
@@ -781,36 +993,48 @@ core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
 	box.MinEdge -= colData.eRadius;
 	box.MaxEdge += colData.eRadius;
 
-	s32 totalTriangleCnt = colData.selector->getTriangleCount();
-	Triangles.set_used(totalTriangleCnt);
-
 	core::matrix4 scaleMatrix;
 	scaleMatrix.setScale(
 			core::vector3df(1.0f / colData.eRadius.X,
 					1.0f / colData.eRadius.Y,
 					1.0f / colData.eRadius.Z));
 
-	irr::core::array<SCollisionTriangleRange> outTriangleInfo;
-	s32 triangleCnt = 0;
-	colData.selector->getTriangles(Triangles.pointer(), totalTriangleCnt, triangleCnt, box, &scaleMatrix, true, &outTriangleInfo);
-
-	// Find closest intersection
-	irr::s32 nearestTriangleIndex = -1;
-	for (s32 i=0; i<triangleCnt; ++i)
+	if (colData.selector->hasHierarchy())
 	{
-		if(testTriangleIntersection(&colData, Triangles[i]))
-		{
-			nearestTriangleIndex = i;
-		}
+		// test the triangles while traversing, instead of copying them
+		SCollisionCallback callback;
+		callback.Manager = this;
+		callback.ColData = &colData;
+		colData.selector->visitTriangles(callback, box, &scaleMatrix, true);
 	}
-	if ( nearestTriangleIndex >= 0 )
+	else
 	{
-		for ( irr::u32 t=0; t<outTriangleInfo.size(); ++t )
+		s32 totalTriangleCnt = colData.selector->getTriangleCount();
+		core::array<core::triangle3df> triangles(totalTriangleCnt);
+		triangles.set_used(totalTriangleCnt);
+
+		irr::core::array<SCollisionTriangleRange> outTriangleInfo;
+		s32 triangleCnt = 0;
+		colData.selector->getTriangles(triangles.pointer(), totalTriangleCnt, triangleCnt, box, &scaleMatrix, true, &outTriangleInfo);
+
+		// Find closest intersection
+		irr::s32 nearestTriangleIndex = -1;
+		for (s32 i=0; i<triangleCnt; ++i)
 		{
-			if ( outTriangleInfo[t].isIndexInRange(nearestTriangleIndex) )
+			if(testTriangleIntersection(&colData, triangles[i]))
 			{
-				colData.node = outTriangleInfo[t].SceneNode;
-				break;
+				nearestTriangleIndex = i;
+			}
+		}
+		if ( nearestTriangleIndex >= 0 )
+		{
+			for ( irr::u32 t=0; t<outTriangleInfo.size(); ++t )
+			{
+				if ( outTriangleInfo[t].isIndexInRange(nearestTriangleIndex) )
+				{
+					colData.node = outTriangleInfo[t].SceneNode;
+					break;
+				}
 			}
 		}
 	}
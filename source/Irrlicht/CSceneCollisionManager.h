@@ -8,6 +8,7 @@
 #include "ISceneCollisionManager.h"
 #include "ISceneManager.h"
 #include "IVideoDriver.h"
+#include "CSceneNodeTree.h"
 
 namespace irr
 {
@@ -41,6 +42,11 @@ namespace scene
 		virtual ISceneNode* getSceneNodeFromCameraBB(const ICameraSceneNode* camera,
 				s32 idBitMask=0, bool bNoDebugObjects = false) _IRR_OVERRIDE_;
 
+		//! Collects the scene nodes whose bounding box intersects a box.
+		virtual void getSceneNodesFromBox(const core::aabbox3d<f32>& box,
+				core::array<ISceneNode*>& outNodes, s32 idBitMask=0,
+				bool bNoDebugObjects=false, ISceneNode* root=0) _IRR_OVERRIDE_;
+
 		//! Finds the nearest collision point of a line and lots of triangles, if there is one.
 		virtual bool getCollisionPoint(SCollisionHit& hitResult, const core::line3d<f32>& ray,
 				ITriangleSelector* selector)  _IRR_OVERRIDE_;
@@ -76,6 +82,9 @@ namespace scene
 								ISceneNode * collisionRootNode = 0,
 								bool noDebugObjects = false)  _IRR_OVERRIDE_;
 
+		//! sets the tree of the node bounds used for the queries, 0 to visit all nodes
+		void setSceneNodeTree(CSceneNodeTree* tree);
+
 	private:
 
 		//! recursive method for going through all scene nodes
@@ -83,6 +92,16 @@ namespace scene
 					bool bNoDebugObjects,
 					f32& outbestdistance, ISceneNode*& outbestnode);
 
+		//! tests the nodes whose boxes in the tree are hit by the ray, nearest first
+		void getPickedNodeFromTree(ISceneNode* root, core::line3df& ray, s32 bits,
+					bool bNoDebugObjects,
+					f32& outbestdistance, ISceneNode*& outbestnode);
+
+		//! tests the bounding box of one node against the ray
+		void testNodeBB(ISceneNode* current, core::line3df& ray,
+					const core::vector3df& rayVector,
+					f32& outbestdistance, ISceneNode*& outbestnode);
+
 		//! recursive method for going through all scene nodes
 		void getPickedNodeFromBBAndSelector(
 						SCollisionHit& hitResult,
@@ -92,6 +111,22 @@ namespace scene
 						bool noDebugObjects,
 						f32 & outBestDistanceSquared);
 
+		//! tests the triangles of one node against the ray
+		void testNodeSelector(SCollisionHit& hitResult, ISceneNode* current,
+						ITriangleSelector* selector, core::line3df& ray,
+						f32& outBestDistanceSquared);
+
+		//! recursive method for collecting the nodes in a box
+		void getNodesFromBoxBB(ISceneNode* root, const core::aabbox3df& box, s32 bits,
+					bool bNoDebugObjects, core::array<ISceneNode*>& outNodes);
+
+		//! returns if a node is part of the scene of the scene manager
+		bool isInScene(const ISceneNode* node) const;
+
+		//! returns if a node found in the tree is a child of root and would be found by visiting the nodes
+		bool isFoundBelow(const ISceneNode* node, const ISceneNode* root,
+					bool visibleParents) const;
+
 
 		struct SCollisionData
 		{
@@ -117,6 +152,8 @@ namespace scene
 			ITriangleSelector* selector;
 		};
 
+		struct SCollisionCallback;
+
 		//! Tests the current collision data against an individual triangle.
 		/**
 		\param colData: the collision data.
@@ -142,7 +179,7 @@ namespace scene
 
 		ISceneManager* SceneManager;
 		video::IVideoDriver* Driver;
-		core::array<core::triangle3df> Triangles; // triangle buffer
+		CSceneNodeTree* NodeTree;
 	};
 
 
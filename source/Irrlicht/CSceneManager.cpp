@@ -154,6 +154,7 @@
 #include "CBillboardSceneNode.h"
 #endif // _IRR_COMPILE_WITH_BILLBOARD_SCENENODE_
 #include "CMeshSceneNode.h"
+#include "CInstancedMeshSceneNode.h"
 #include "CSkyBoxSceneNode.h"
 #ifdef _IRR_COMPILE_WITH_SKYDOME_SCENENODE_
 #include "CSkyDomeSceneNode.h"
@@ -180,6 +181,7 @@
 #include "CSceneCollisionManager.h"
 #include "CTriangleSelector.h"
 #include "COctreeTriangleSelector.h"
+#include "CBVHTriangleSelector.h"
 #include "CTriangleBBSelector.h"
 #include "CMetaTriangleSelector.h"
 #ifdef _IRR_COMPILE_WITH_TERRAIN_SCENENODE_
@@ -212,6 +214,9 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 		gui::IGUIEnvironment* gui)
 : ISceneNode(0, 0), Driver(driver), FileSystem(fs), GUIEnvironment(gui),
 	CursorControl(cursorControl), CollisionManager(0),
+	TraversalPool(0), TraversalSerialNode(0), TraversalThreadCount(0), TraversalParts(0),
+	TraversalTimeMs(0), TraversalAnimate(false), TraversalRunning(false), Registering(false),
+	MaterialChangesAvoided(0), StaticBatcher(0), NodeTree(0),
 	ActiveCamera(0), ShadowColor(150,0,0,0), AmbientLight(0,0,0,0), Parameters(0),
 	MeshCache(cache), CurrentRenderPass(ESNRP_NONE), LightManager(0),
 	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type")
@@ -224,6 +229,8 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	// root node's scene manager
 	SceneManager = this;
 
+	TraversalJob.Manager = this;
+
 	if (Driver)
 		Driver->grab();
 
@@ -352,6 +359,7 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 			getProfiler().add(EPID_SM_RENDER_TRANSPARENT, L"transp.nodes", L"Irrlicht scene");
 			getProfiler().add(EPID_SM_RENDER_EFFECT, L"effectnodes", L"Irrlicht scene");
 			getProfiler().add(EPID_SM_REGISTER, L"reg.render.node", L"Irrlicht scene");
+			getProfiler().add(EPID_SM_LOAD_MESH, L"load mesh", L"Irrlicht scene");
 		}
  	)
 }
@@ -360,6 +368,10 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 //! destructor
 CSceneManager::~CSceneManager()
 {
+	// mesh requests still use the scene manager
+	if (Driver)
+		Driver->getAsyncLoader()->finishAllRequests();
+
 	clearDeletionList();
 
 	//! force to remove hardwareTextures from the driver
@@ -375,7 +387,10 @@ CSceneManager::~CSceneManager()
 		CursorControl->drop();
 
 	if (CollisionManager)
+	{
+		CollisionManager->setSceneNodeTree(0);
 		CollisionManager->drop();
+	}
 
 	if (GeometryCreator)
 		GeometryCreator->drop();
@@ -409,6 +424,16 @@ CSceneManager::~CSceneManager()
 	if (LightManager)
 		LightManager->drop();
 
+	if (TraversalPool)
+		TraversalPool->drop();
+
+	if (StaticBatcher)
+		StaticBatcher->drop();
+
+	// the tree grabs the nodes
+	if (NodeTree)
+		NodeTree->drop();
+
 	// remove all nodes and animators before dropping the driver
 	// as render targets may be destroyed twice
 
@@ -461,9 +486,30 @@ IAnimatedMesh* CSceneManager::getMesh(io::IReadFile* file)
 
 // load and create a mesh which we know already isn't in the cache and put it in there
 IAnimatedMesh* CSceneManager::getUncachedMesh(io::IReadFile* file, const io::path& filename, const io::path& cachename)
+{
+	IRR_PROFILE(CProfileScope p1(EPID_SM_LOAD_MESH);)
+
+	IAnimatedMesh* msh = loadMesh(file, filename);
+	if (msh)
+	{
+		MeshCache->addMesh(cachename, msh);
+		msh->drop();
+	}
+
+	return msh;
+}
+
+
+// create a mesh with the mesh loaders, returns a grabbed mesh
+IAnimatedMesh* CSceneManager::loadMesh(io::IReadFile* file, const io::path& filename)
 {
 	IAnimatedMesh* msh = 0;
 
+	// the loaders are shared with the loader thread
+	IAsyncLoader* loader = Driver ? Driver->getAsyncLoader() : 0;
+	if (loader)
+		loader->lock();
+
 	// iterate the list in reverse order so user-added loaders can override the built-in ones
 	s32 count = MeshLoaderList.size();
 	for (s32 i=count-1; i>=0; --i)
@@ -474,14 +520,13 @@ IAnimatedMesh* CSceneManager::getUncachedMesh(io::IReadFile* file, const io::pat
 			file->seek(0);
 			msh = MeshLoaderList[i]->createMesh(file);
 			if (msh)
-			{
-				MeshCache->addMesh(cachename, msh);
-				msh->drop();
 				break;
-			}
 		}
 	}
 
+	if (loader)
+		loader->unlock();
+
 	if (!msh)
 		os::Printer::log("Could not load mesh, file format seems to be unsupported", filename, ELL_ERROR);
 	else
@@ -490,6 +535,98 @@ IAnimatedMesh* CSceneManager::getUncachedMesh(io::IReadFile* file, const io::pat
 	return msh;
 }
 
+
+//! Mesh loaded on the loader thread and added to the mesh cache on the thread which draws
+class CMeshLoadRequest : public IAsyncLoadRequest
+{
+public:
+
+	CMeshLoadRequest(CSceneManager* smgr, const io::path& filename, const io::path& cacheName)
+		: SceneManager(smgr), Name(filename), CacheName(cacheName), Mesh(0)
+	{
+		#ifdef _DEBUG
+		setDebugName("CMeshLoadRequest");
+		#endif
+	}
+
+	virtual ~CMeshLoadRequest()
+	{
+		if (Mesh)
+			Mesh->drop();
+	}
+
+	virtual const io::path& getName() const _IRR_OVERRIDE_
+	{
+		return Name;
+	}
+
+	virtual IAnimatedMesh* getMesh() const _IRR_OVERRIDE_
+	{
+		return Mesh;
+	}
+
+	//! reads the file and creates the mesh
+	virtual bool load() _IRR_OVERRIDE_
+	{
+		io::IReadFile* file = SceneManager->FileSystem->createAndOpenFile(Name);
+		if (!file)
+		{
+			os::Printer::log("Could not load mesh, because file could not be opened: ", Name, ELL_ERROR);
+			return false;
+		}
+
+		Mesh = SceneManager->loadMesh(file, Name);
+		file->drop();
+
+		return Mesh != 0;
+	}
+
+	//! adds the mesh to the cache, unless it was loaded in the meantime
+	virtual bool finish() _IRR_OVERRIDE_
+	{
+		IAnimatedMesh* cached = SceneManager->MeshCache->getMeshByName(CacheName);
+		if (cached)
+		{
+			cached->grab();
+			if (Mesh)
+				Mesh->drop();
+			Mesh = cached;
+		}
+		else if (Mesh)
+			SceneManager->MeshCache->addMesh(CacheName, Mesh);
+
+		return Mesh != 0;
+	}
+
+private:
+
+	CSceneManager* SceneManager;
+	io::path Name;
+	io::path CacheName;
+	IAnimatedMesh* Mesh;
+};
+
+
+//! Loads a mesh in the background
+IAsyncLoadRequest* CSceneManager::createMeshLoadRequest(const io::path& filename, const io::path& alternativeCacheName)
+{
+	const io::path& cacheName = alternativeCacheName.empty() ? filename : alternativeCacheName;
+	CMeshLoadRequest* request = new CMeshLoadRequest(this, filename, cacheName);
+
+	// meshes in the cache are done at once
+	if (MeshCache->getMeshByName(cacheName))
+	{
+		request->finish();
+		request->setState(EALS_DONE);
+	}
+	else if (Driver)
+		Driver->getAsyncLoader()->addRequest(request);
+	else
+		request->setState(request->load() && request->finish() ? EALS_DONE : EALS_FAILED);
+
+	return request;
+}
+
 //! returns the video driver
 video::IVideoDriver* CSceneManager::getVideoDriver()
 {
@@ -656,6 +793,25 @@ IMeshSceneNode* CSceneManager::addMeshSceneNode(IMesh* mesh, ISceneNode* parent,
 }
 
 
+//! adds a scene node for rendering many instances of a static mesh
+//! the returned pointer must not be dropped.
+IInstancedMeshSceneNode* CSceneManager::addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale, bool alsoAddIfMeshPointerZero)
+{
+	if (!alsoAddIfMeshPointerZero && !mesh)
+		return 0;
+
+	if (!parent)
+		parent = this;
+
+	IInstancedMeshSceneNode* node = new CInstancedMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
 //! Adds a scene node for rendering a animated water surface mesh.
 ISceneNode* CSceneManager::addWaterSurfaceSceneNode(IMesh* mesh, f32 waveHeight, f32 waveSpeed, f32 waveLength,
 	ISceneNode* parent, s32 id, const core::vector3df& position,
@@ -1226,30 +1382,57 @@ const core::aabbox3d<f32>& CSceneManager::getBoundingBox() const
 
 //! returns if node is culled
 bool CSceneManager::isCulled(const ISceneNode* node) const
+{
+	// nodes checking themselves while registering, like mesh scene nodes
+	// handing their buffers to the scene manager
+	if (Registering)
+	{
+		video::SFrameStats& stats = getRegisterStats();
+		++stats.NodesVisited;
+		return isCulledCounted(node, stats);
+	}
+
+	return getCulledBy(node) != EAC_OFF;
+}
+
+
+//! returns the culling method which culled the node, EAC_OFF if it is visible
+E_CULLING_TYPE CSceneManager::getCulledBy(const ISceneNode* node) const
 {
 	const ICameraSceneNode* cam = getActiveCamera();
 	if (!cam)
 	{
-		return false;
+		return EAC_OFF;
 	}
-	bool result = false;
 
 	// has occlusion query information
 	if (node->getAutomaticCulling() & scene::EAC_OCC_QUERY)
 	{
-		result = (Driver->getOcclusionQueryResult(const_cast<ISceneNode*>(node))==0);
+		if (Driver->getOcclusionQueryResult(const_cast<ISceneNode*>(node))==0)
+			return EAC_OCC_QUERY;
 	}
 
 	// can be seen by a bounding box ?
-	if (!result && (node->getAutomaticCulling() & scene::EAC_BOX))
+	if (node->getAutomaticCulling() & scene::EAC_BOX)
 	{
-		core::aabbox3d<f32> tbox = node->getBoundingBox();
-		node->getAbsoluteTransformation().transformBoxEx(tbox);
-		result = !(tbox.intersectsWithBox(cam->getViewFrustum()->getBoundingBox() ));
+		// the tree of the node bounds did the same test for all nodes at once
+		const CSceneNodeTree::E_VISIBILITY visibility = NodeTree ?
+			NodeTree->getVisibility(node, cam) : CSceneNodeTree::EV_UNKNOWN;
+
+		if (visibility == CSceneNodeTree::EV_OUTSIDE)
+			return EAC_BOX;
+
+		if (visibility == CSceneNodeTree::EV_UNKNOWN)
+		{
+			core::aabbox3d<f32> tbox = node->getBoundingBox();
+			node->getAbsoluteTransformation().transformBoxEx(tbox);
+			if (!(tbox.intersectsWithBox(cam->getViewFrustum()->getBoundingBox() )))
+				return EAC_BOX;
+		}
 	}
 
 	// can be seen by a bounding sphere
-	if (!result && (node->getAutomaticCulling() & scene::EAC_FRUSTUM_SPHERE))
+	if (node->getAutomaticCulling() & scene::EAC_FRUSTUM_SPHERE)
 	{
 		const core::aabbox3df nbox = node->getTransformedBoundingBox();
 		const float rad = nbox.getRadius();
@@ -1261,11 +1444,12 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 		const float dist = (center - camcenter).getLengthSQ();
 		const float maxdist = (rad + camrad) * (rad + camrad);
 
-		result = dist > maxdist;
+		if (dist > maxdist)
+			return EAC_FRUSTUM_SPHERE;
 	}
 
 	// can be seen by cam pyramid planes ?
-	if (!result && (node->getAutomaticCulling() & scene::EAC_FRUSTUM_BOX))
+	if (node->getAutomaticCulling() & scene::EAC_FRUSTUM_BOX)
 	{
 		SViewFrustum frust = *cam->getViewFrustum();
 
@@ -1290,22 +1474,55 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 			}
 
 			if (!boxInFrustum)
-			{
-				result = true;
-				break;
-			}
+				return EAC_FRUSTUM_BOX;
 		}
 	}
 
-	return result;
+	return EAC_OFF;
 }
 
 
-//! registers a node for rendering it at a specific time.
-u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
+//! returns if node is culled, and counts the culling method in the statistics
+bool CSceneManager::isCulledCounted(const ISceneNode* node, video::SFrameStats& stats) const
+{
+	switch (getCulledBy(node))
+	{
+	case EAC_OFF:
+		return false;
+	case EAC_OCC_QUERY:
+		++stats.NodesCulledByOcclusionQuery;
+		break;
+	case EAC_BOX:
+		++stats.NodesCulledByBox;
+		break;
+	case EAC_FRUSTUM_SPHERE:
+		++stats.NodesCulledByFrustumSphere;
+		break;
+	default:
+		++stats.NodesCulledByFrustumBox;
+		break;
+	}
+	return true;
+}
+
+
+//! returns the statistics the registration of the calling thread is counted in
+video::SFrameStats& CSceneManager::getRegisterStats() const
+{
+	// called by a traversal thread, use the statistics of its part
+	if (TraversalRunning)
+		return TraversalThreadLists[CThreadPool::getCurrentThread()]->Stats;
+
+	return Driver->getFrameStats();
+}
+
+
+//! registers a node in the render lists of the scene manager or of a traversal part
+template <class TLists>
+u32 CSceneManager::registerNodeInLists(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass, TLists& lists, video::SFrameStats& stats)
 {
-	IRR_PROFILE(CProfileScope p1(EPID_SM_REGISTER);)
 	u32 taken = 0;
+	++stats.NodesVisited;
 
 	switch(pass)
 	{
@@ -1313,9 +1530,9 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 	case ESNRP_CAMERA:
 		{
 			taken = 1;
-			for (u32 i = 0; i != CameraList.size(); ++i)
+			for (u32 i = 0; i != lists.CameraList.size(); ++i)
 			{
-				if (CameraList[i] == node)
+				if (lists.CameraList[i] == node)
 				{
 					taken = 0;
 					break;
@@ -1323,7 +1540,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 			}
 			if (taken)
 			{
-				CameraList.push_back(node);
+				lists.CameraList.push_back(node);
 			}
 		}
 		break;
@@ -1333,38 +1550,38 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 		// Lighting model in irrlicht has to be redone..
 		//if (!isCulled(node))
 		{
-			LightList.push_back(node);
+			lists.LightList.push_back(node);
 			taken = 1;
 		}
 		break;
 
 	case ESNRP_SKY_BOX:
-		SkyBoxList.push_back(node);
+		lists.SkyBoxList.push_back(node);
 		taken = 1;
 		break;
 	case ESNRP_SOLID:
-		if (!isCulled(node))
+		if (!isCulledCounted(node, stats))
 		{
-			SolidNodeList.push_back(node);
+			lists.SolidNodeList.push_back(node);
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT:
-		if (!isCulled(node))
+		if (!isCulledCounted(node, stats))
 		{
-			TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			lists.TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT_EFFECT:
-		if (!isCulled(node))
+		if (!isCulledCounted(node, stats))
 		{
-			TransparentEffectNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			lists.TransparentEffectNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
 			taken = 1;
 		}
 		break;
 	case ESNRP_AUTOMATIC:
-		if (!isCulled(node))
+		if (!isCulledCounted(node, stats))
 		{
 			const u32 count = node->getMaterialCount();
 
@@ -1377,7 +1594,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 				{
 					// register as transparent node
 					TransparentNodeEntry e(node, camWorldPos);
-					TransparentNodeList.push_back(e);
+					lists.TransparentNodeList.push_back(e);
 					taken = 1;
 					break;
 				}
@@ -1386,15 +1603,15 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 			// not transparent, register as solid
 			if (!taken)
 			{
-				SolidNodeList.push_back(node);
+				lists.SolidNodeList.push_back(node);
 				taken = 1;
 			}
 		}
 		break;
 	case ESNRP_SHADOW:
-		if (!isCulled(node))
+		if (!isCulledCounted(node, stats))
 		{
-			ShadowNodeList.push_back(node);
+			lists.ShadowNodeList.push_back(node);
 			taken = 1;
 		}
 		break;
@@ -1403,6 +1620,23 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 		break;
 	}
 
+	return taken;
+}
+
+
+//! registers a node for rendering it at a specific time.
+u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
+{
+	// called by a traversal thread, use the lists of its part
+	if (TraversalRunning)
+	{
+		SRegisterLists& lists = *TraversalThreadLists[CThreadPool::getCurrentThread()];
+		return registerNodeInLists(node, pass, lists, lists.Stats);
+	}
+
+	IRR_PROFILE(CProfileScope p1(EPID_SM_REGISTER);)
+	const u32 taken = registerNodeInLists(node, pass, *this, Driver->getFrameStats());
+
 #ifdef _IRR_SCENEMANAGER_DEBUG
 	s32 index = Parameters->findAttribute("calls");
 	Parameters->setAttribute(index, Parameters->getAttributeAsInt(index)+1);
@@ -1417,6 +1651,50 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 	return taken;
 }
 
+//! registers a solid mesh buffer of a node for rendering.
+u32 CSceneManager::registerMeshBufferForRendering(ISceneNode* node, IMeshBuffer* buffer, const video::SMaterial& material)
+{
+	if (!node || !buffer)
+		return 0;
+
+	const DefaultNodeEntry e(node, buffer, &material);
+
+	// called by a traversal thread, use the lists of its part
+	if (TraversalRunning)
+		TraversalThreadLists[CThreadPool::getCurrentThread()]->SolidNodeList.push_back(e);
+	else
+		SolidNodeList.push_back(e);
+
+	return 1;
+}
+
+
+//! Get the number of material changes avoided in the last solid pass.
+u32 CSceneManager::getMaterialChangesAvoided() const
+{
+	return MaterialChangesAvoided;
+}
+
+
+//! Registers a mesh scene node for static batching.
+u32 CSceneManager::registerMeshForStaticBatching(IMeshSceneNode* node)
+{
+	if (!StaticBatcher || !node)
+		return 0;
+
+	if (StaticBatcher->isBatched(node))
+		return 1;
+
+	// candidates are handled after the traversal
+	if (TraversalRunning)
+		TraversalThreadLists[CThreadPool::getCurrentThread()]->StaticBatchPending.push_back(node);
+	else
+		StaticBatchPending.push_back(node);
+
+	return 0;
+}
+
+
 void CSceneManager::clearAllRegisteredNodesForRendering()
 {
 	CameraList.clear();
@@ -1428,6 +1706,338 @@ void CSceneManager::clearAllRegisteredNodesForRendering()
 	ShadowNodeList.clear();
 }
 
+//! returns the number of threads for the traversal, creates the thread pool
+u32 CSceneManager::getTraversalThreads()
+{
+	const s32 threads = Parameters->getAttributeAsInt(PARALLEL_SCENE_TRAVERSAL);
+	if (threads < 2 || Children.size() < 2)
+		return 1;
+
+	if ((u32)threads != TraversalThreadCount)
+	{
+		if (TraversalPool)
+			TraversalPool->drop();
+
+		TraversalPool = new CThreadPool(threads);
+		TraversalThreadCount = threads;
+		TraversalThreadLists.set_used(TraversalPool->getThreadCount());
+	}
+
+	return TraversalPool->getThreadCount();
+}
+
+
+//! animates the children of the root node on the traversal threads
+void CSceneManager::animateParallel(u32 timeMs)
+{
+	if (!IsVisible)
+		return;
+
+	// the root node itself, as in ISceneNode::OnAnimate
+	ISceneNodeAnimatorList::Iterator ait = Animators.begin();
+	while (ait != Animators.end())
+	{
+		ISceneNodeAnimator* anim = *ait;
+		++ait;
+		if (anim->isEnabled())
+			anim->animateNode(this, timeMs);
+	}
+
+	updateAbsolutePosition();
+
+	// the subtree of the active camera is animated after the others on the
+	// calling thread, camera animators usually look at the rest of the scene
+	TraversalSerialNode = ActiveCamera;
+	while (TraversalSerialNode && TraversalSerialNode->getParent() != this)
+		TraversalSerialNode = TraversalSerialNode->getParent();
+
+	TraversalAnimate = true;
+	TraversalTimeMs = timeMs;
+	runTraversal();
+
+	if (TraversalSerialNode)
+		TraversalSerialNode->OnAnimate(timeMs);
+	TraversalSerialNode = 0;
+}
+
+
+//! registers the children of the root node on the traversal threads
+void CSceneManager::registerParallel()
+{
+	if (!IsVisible)
+		return;
+
+	TraversalAnimate = false;
+	runTraversal();
+}
+
+
+//! runs the current traversal phase on the children of the root node
+void CSceneManager::runTraversal()
+{
+	// work on a copy, nodes may be added to or removed from the root
+	// by the serial parts of the frame only
+	TraversalNodes.set_used(0);
+	ISceneNodeList::ConstIterator it = Children.begin();
+	for (; it != Children.end(); ++it)
+		TraversalNodes.push_back(*it);
+
+	// a few parts per thread balance uneven subtrees
+	TraversalParts = core::min_(TraversalNodes.size(), TraversalPool->getThreadCount() * 4);
+	while (TraversalLists.size() < TraversalParts)
+		TraversalLists.push_back(SRegisterLists());
+
+	TraversalRunning = true;
+	TraversalPool->run(&TraversalJob, TraversalParts);
+	TraversalRunning = false;
+
+	mergeTraversalLists();
+}
+
+
+//! runs one part of a parallel traversal
+void CSceneManager::runTraversalPart(u32 part, u32 thread)
+{
+	TraversalThreadLists[thread] = &TraversalLists[part];
+
+	const u32 count = TraversalNodes.size();
+	const u32 begin = part * count / TraversalParts;
+	const u32 end = (part + 1) * count / TraversalParts;
+
+	for (u32 i = begin; i < end; ++i)
+	{
+		ISceneNode* node = TraversalNodes[i];
+		if (TraversalAnimate)
+		{
+			if (node != TraversalSerialNode)
+				node->OnAnimate(TraversalTimeMs);
+		}
+		else
+			node->OnRegisterSceneNode();
+	}
+}
+
+
+//! appends the lists of all traversal parts to the scene manager lists
+/** Parts cover consecutive children, so the merged lists are in the same
+order as after a serial traversal. */
+void CSceneManager::mergeTraversalLists()
+{
+	for (u32 p = 0; p < TraversalParts; ++p)
+	{
+		SRegisterLists& lists = TraversalLists[p];
+		u32 i;
+
+		for (i = 0; i < lists.CameraList.size(); ++i)
+		{
+			if (CameraList.linear_search(lists.CameraList[i]) == -1)
+				CameraList.push_back(lists.CameraList[i]);
+		}
+
+		for (i = 0; i < lists.LightList.size(); ++i)
+			LightList.push_back(lists.LightList[i]);
+		for (i = 0; i < lists.ShadowNodeList.size(); ++i)
+			ShadowNodeList.push_back(lists.ShadowNodeList[i]);
+		for (i = 0; i < lists.SkyBoxList.size(); ++i)
+			SkyBoxList.push_back(lists.SkyBoxList[i]);
+		for (i = 0; i < lists.SolidNodeList.size(); ++i)
+			SolidNodeList.push_back(lists.SolidNodeList[i]);
+		for (i = 0; i < lists.TransparentNodeList.size(); ++i)
+			TransparentNodeList.push_back(lists.TransparentNodeList[i]);
+		for (i = 0; i < lists.TransparentEffectNodeList.size(); ++i)
+			TransparentEffectNodeList.push_back(lists.TransparentEffectNodeList[i]);
+		for (i = 0; i < lists.DeletionList.size(); ++i)
+			DeletionList.push_back(lists.DeletionList[i]);
+		for (i = 0; i < lists.StaticBatchPending.size(); ++i)
+			StaticBatchPending.push_back(lists.StaticBatchPending[i]);
+
+		video::SFrameStats& stats = Driver->getFrameStats();
+		stats.NodesVisited += lists.Stats.NodesVisited;
+		stats.NodesCulledByOcclusionQuery += lists.Stats.NodesCulledByOcclusionQuery;
+		stats.NodesCulledByBox += lists.Stats.NodesCulledByBox;
+		stats.NodesCulledByFrustumSphere += lists.Stats.NodesCulledByFrustumSphere;
+		stats.NodesCulledByFrustumBox += lists.Stats.NodesCulledByFrustumBox;
+
+		lists.CameraList.set_used(0);
+		lists.LightList.set_used(0);
+		lists.ShadowNodeList.set_used(0);
+		lists.SkyBoxList.set_used(0);
+		lists.SolidNodeList.set_used(0);
+		lists.TransparentNodeList.set_used(0);
+		lists.TransparentEffectNodeList.set_used(0);
+		lists.DeletionList.set_used(0);
+		lists.StaticBatchPending.set_used(0);
+		lists.Stats = video::SFrameStats();
+	}
+}
+
+
+namespace
+{
+	//! spreads a pointer over the given number of bits
+	inline u32 hashPointer(const void* p, u32 bits)
+	{
+		const u32 h = (u32)((size_t)p >> 4) * 2654435761u;
+		return bits ? h >> (32 - bits) : 0;
+	}
+
+	//! builds the sort key of a solid material
+	/** From high to low bits: material type (which includes shaders), first
+	and second texture, the remaining render states and the depth. Textures
+	and states are hashed, equal materials always get equal keys. */
+	u64 getSolidSortKey(const video::SMaterial& m, u32 depth)
+	{
+		u32 state = (m.ZBuffer & 7) |
+			(m.ZWriteEnable << 3) |
+			(m.BackfaceCulling << 4) |
+			(m.FrontfaceCulling << 5) |
+			(m.Lighting << 6) |
+			(m.Wireframe << 7) |
+			(m.PointCloud << 8) |
+			(m.GouraudShading << 9) |
+			(m.FogEnable << 10) |
+			(m.NormalizeNormals << 11) |
+			(m.ColorMask << 12);
+		state = state * 2654435761u + (u32)m.BlendOperation;
+		u32 param;
+		memcpy(&param, &m.MaterialTypeParam, sizeof(param));
+		state = state * 2654435761u + param;
+		for (u32 i = 2; i < video::MATERIAL_MAX_TEXTURES; ++i)
+			state = state * 2654435761u + hashPointer(m.getTexture(i), 32);
+
+		return ((u64)core::min_((u32)m.MaterialType, 255u) << 56) |
+			((u64)hashPointer(m.getTexture(0), 16) << 40) |
+			((u64)hashPointer(m.getTexture(1), 8) << 32) |
+			((u64)(state >> 16) << 16) |
+			(depth & 0xFFFF);
+	}
+
+	//! stable LSD radix sort on 8 bit digits
+	/** Digits on which all keys agree are skipped, so only the parts
+	of the key which actually differ in a frame cost a pass. */
+	template <class T>
+	void radixSort(core::array<T>& keys, core::array<T>& temp)
+	{
+		const u32 count = keys.size();
+		if (count < 2)
+			return;
+
+		u32 histogram[8][256];
+		memset(histogram, 0, sizeof(histogram));
+
+		u32 i, d;
+		for (i = 0; i < count; ++i)
+		{
+			const u64 key = keys[i].Key;
+			for (d = 0; d < 8; ++d)
+				++histogram[d][(key >> (d * 8)) & 0xFF];
+		}
+
+		temp.set_used(count);
+		T* src = keys.pointer();
+		T* dst = temp.pointer();
+
+		for (d = 0; d < 8; ++d)
+		{
+			u32* h = histogram[d];
+			if (h[(src[0].Key >> (d * 8)) & 0xFF] == count)
+				continue;
+
+			u32 sum = 0;
+			for (i = 0; i < 256; ++i)
+			{
+				const u32 c = h[i];
+				h[i] = sum;
+				sum += c;
+			}
+
+			for (i = 0; i < count; ++i)
+				dst[h[(src[i].Key >> (d * 8)) & 0xFF]++] = src[i];
+
+			core::swap(src, dst);
+		}
+
+		if (src != keys.pointer())
+			memcpy(keys.pointer(), src, count * sizeof(T));
+	}
+}
+
+
+//! sorts the solid list by material and depth and renders it
+void CSceneManager::renderSolidList()
+{
+	MaterialChangesAvoided = 0;
+
+	const u32 count = SolidNodeList.size();
+	const f32 depthScale = 65535.f / (ActiveCamera ? core::max_(ActiveCamera->getFarValue(), 1.f) : 65535.f);
+	u32 i;
+
+	SolidSortKeys.set_used(count);
+	for (i = 0; i < count; ++i)
+	{
+		const DefaultNodeEntry& e = SolidNodeList[i];
+
+		// front to back inside of equal materials
+		core::vector3df center;
+		if (e.Buffer)
+			e.Node->getAbsoluteTransformation().transformVect(center, e.Buffer->getBoundingBox().getCenter());
+		else
+			center = e.Node->getAbsolutePosition();
+		const u32 depth = (u32)core::clamp(center.getDistanceFrom(camWorldPos) * depthScale, 0.f, 65535.f);
+
+		const video::SMaterial* material = e.Material;
+		if (!material && e.Node->getMaterialCount())
+			material = &e.Node->getMaterial(0);
+
+		SolidSortKeys[i].Key = material ? getSolidSortKey(*material, depth) : depth;
+		SolidSortKeys[i].Index = i;
+	}
+
+	radixSort(SolidSortKeys, SolidSortTemp);
+
+	// material and transformation last set by a mesh buffer entry,
+	// a node's render() may change both
+	const video::SMaterial* lastMaterial = 0;
+	const ISceneNode* lastNode = 0;
+
+	for (i = 0; i < count; ++i)
+	{
+		const DefaultNodeEntry& e = SolidNodeList[SolidSortKeys[i].Index];
+
+		if (LightManager)
+			LightManager->OnNodePreRender(e.Node);
+
+		if (e.Buffer)
+		{
+			if (e.Node != lastNode)
+			{
+				Driver->setTransform(video::ETS_WORLD, e.Node->getAbsoluteTransformation());
+				lastNode = e.Node;
+			}
+
+			if (lastMaterial && (lastMaterial == e.Material || *lastMaterial == *e.Material))
+				++MaterialChangesAvoided;
+			else
+			{
+				Driver->setMaterial(*e.Material);
+				lastMaterial = e.Material;
+			}
+
+			Driver->drawMeshBuffer(e.Buffer);
+		}
+		else
+		{
+			e.Node->render();
+			lastMaterial = 0;
+			lastNode = 0;
+		}
+
+		if (LightManager)
+			LightManager->OnNodePostRender(e.Node);
+	}
+}
+
+
 //! This method is called just before the rendering process of the whole scene.
 //! draws all scene nodes
 void CSceneManager::drawAll()
@@ -1458,9 +2068,28 @@ void CSceneManager::drawAll()
 	// TODO: This should not use an attribute here but a real parameter when necessary (too slow!)
 	Driver->setAllowZWriteOnTransparent(Parameters->getAttributeAsBool(ALLOW_ZWRITE_ON_TRANSPARENT));
 
+	const u32 traversalThreads = getTraversalThreads();
+
+	const f32 batchCellSize = Parameters->getAttributeAsFloat(STATIC_MESH_BATCHING);
+	if (batchCellSize > 0.f)
+	{
+		if (!StaticBatcher)
+			StaticBatcher = new CStaticMeshBatcher(this);
+		StaticBatcher->setCellSize(batchCellSize);
+		StaticBatcher->beginFrame();
+	}
+	else if (StaticBatcher)
+	{
+		StaticBatcher->drop();
+		StaticBatcher = 0;
+	}
+
 	// do animations and other stuff.
 	IRR_PROFILE(getProfiler().start(EPID_SM_ANIMATE));
-	OnAnimate(os::Timer::getTime());
+	if (traversalThreads > 1)
+		animateParallel(os::Timer::getTime());
+	else
+		OnAnimate(os::Timer::getTime());
 	IRR_PROFILE(getProfiler().stop(EPID_SM_ANIMATE));
 
 	/*!
@@ -1476,8 +2105,39 @@ void CSceneManager::drawAll()
 	}
 	IRR_PROFILE(getProfiler().stop(EPID_SM_RENDER_CAMERAS));
 
+	// bring the tree of the node bounds up to date and test it against the frustum
+	if (Parameters->getAttributeAsBool(SCENE_NODE_TREE))
+	{
+		if (!NodeTree)
+		{
+			NodeTree = new CSceneNodeTree();
+			CollisionManager->setSceneNodeTree(NodeTree);
+		}
+		NodeTree->update(this);
+		NodeTree->cull(ActiveCamera);
+	}
+	else if (NodeTree)
+	{
+		CollisionManager->setSceneNodeTree(0);
+		NodeTree->drop();
+		NodeTree = 0;
+	}
+
 	// let all nodes register themselves
-	OnRegisterSceneNode();
+	Registering = true;
+	if (traversalThreads > 1)
+		registerParallel();
+	else
+		OnRegisterSceneNode();
+	Registering = false;
+
+	// rebuild changed batches and register the visible ones
+	if (StaticBatcher)
+	{
+		StaticBatcher->update(StaticBatchPending);
+		StaticBatchPending.set_used(0);
+		StaticBatcher->registerCells();
+	}
 
 	if (LightManager)
 		LightManager->OnPreRender(LightList);
@@ -1581,28 +2241,15 @@ void CSceneManager::drawAll()
 		CurrentRenderPass = ESNRP_SOLID;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
 
-		SolidNodeList.sort(); // sort by textures
-
 		if (LightManager)
-		{
 			LightManager->OnRenderPassPreRender(CurrentRenderPass);
-			for (i=0; i<SolidNodeList.size(); ++i)
-			{
-				ISceneNode* node = SolidNodeList[i].Node;
-				LightManager->OnNodePreRender(node);
-				node->render();
-				LightManager->OnNodePostRender(node);
-			}
-		}
-		else
-		{
-			for (i=0; i<SolidNodeList.size(); ++i)
-				SolidNodeList[i].Node->render();
-		}
+
+		renderSolidList();
 
 #ifdef _IRR_SCENEMANAGER_DEBUG
 		Parameters->setAttribute("drawn_solid", (s32) SolidNodeList.size() );
 #endif
+		Driver->getFrameStats().NodesDrawnSolid += SolidNodeList.size();
 		SolidNodeList.set_used(0);
 
 		if (LightManager)
@@ -1670,6 +2317,7 @@ void CSceneManager::drawAll()
 #ifdef _IRR_SCENEMANAGER_DEBUG
 		Parameters->setAttribute ( "drawn_transparent", (s32) TransparentNodeList.size() );
 #endif
+		Driver->getFrameStats().NodesDrawnTransparent += TransparentNodeList.size();
 		TransparentNodeList.set_used(0);
 
 		if (LightManager)
@@ -1704,6 +2352,7 @@ void CSceneManager::drawAll()
 #ifdef _IRR_SCENEMANAGER_DEBUG
 		Parameters->setAttribute("drawn_transparent_effect", (s32) TransparentEffectNodeList.size());
 #endif
+		Driver->getFrameStats().NodesDrawnTransparentEffect += TransparentEffectNodeList.size();
 		TransparentEffectNodeList.set_used(0);
 	}
 
@@ -1953,6 +2602,25 @@ ITriangleSelector* CSceneManager::createOctreeTriangleSelector(IMeshBuffer* mesh
 	return new COctreeTriangleSelector(meshBuffer, materialIndex, node, minimalPolysPerNode);
 }
 
+//! Creates a ITriangleSelector, optimized by a bounding volume hierarchy.
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(IMesh* mesh,
+							ISceneNode* node, s32 maximalPolysPerLeaf)
+{
+	if (!mesh)
+		return 0;
+
+	return new CBVHTriangleSelector(mesh, node, maximalPolysPerLeaf);
+}
+
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
+			ISceneNode* node, s32 maximalPolysPerLeaf)
+{
+	if ( !meshBuffer)
+		return 0;
+
+	return new CBVHTriangleSelector(meshBuffer, materialIndex, node, maximalPolysPerLeaf);
+}
+
 //! Creates a meta triangle selector.
 IMetaTriangleSelector* CSceneManager::createMetaTriangleSelector()
 {
@@ -1980,7 +2648,12 @@ void CSceneManager::addToDeletionQueue(ISceneNode* node)
 		return;
 
 	node->grab();
-	DeletionList.push_back(node);
+
+	// called by a traversal thread, queue it in the lists of its part
+	if (TraversalRunning)
+		TraversalThreadLists[CThreadPool::getCurrentThread()]->DeletionList.push_back(node);
+	else
+		DeletionList.push_back(node);
 }
 
 
@@ -2118,6 +2791,12 @@ void CSceneManager::removeAll()
 //! Clears the whole scene. All scene nodes are removed.
 void CSceneManager::clear()
 {
+	if (StaticBatcher)
+		StaticBatcher->clear();
+
+	if (NodeTree)
+		NodeTree->clear();
+
 	removeAll();
 }
 
@@ -13,6 +13,10 @@
 #include "IMeshLoader.h"
 #include "CAttributes.h"
 #include "ILightManager.h"
+#include "CThreadPool.h"
+#include "CStaticMeshBatcher.h"
+#include "CSceneNodeTree.h"
+#include "SFrameStats.h"
 
 namespace irr
 {
@@ -24,12 +28,16 @@ namespace scene
 {
 	class IMeshCache;
 	class IGeometryCreator;
+	class CMeshLoadRequest;
+	class CSceneCollisionManager;
 
 	/*!
 		The Scene Manager manages scene nodes, mesh resources, cameras and all the other stuff.
 	*/
 	class CSceneManager : public ISceneManager, public ISceneNode
 	{
+		friend class CMeshLoadRequest;
+
 	public:
 
 		//! constructor
@@ -46,6 +54,10 @@ namespace scene
 		//! gets an animateable mesh. loads it if needed. returned pointer must not be dropped.
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) _IRR_OVERRIDE_;
 
+		//! Loads a mesh in the background
+		virtual IAsyncLoadRequest* createMeshLoadRequest(const io::path& filename,
+			const io::path& alternativeCacheName) _IRR_OVERRIDE_;
+
 		//! Returns an interface to the mesh cache which is shared between all existing scene managers.
 		virtual IMeshCache* getMeshCache() _IRR_OVERRIDE_;
 
@@ -96,6 +108,14 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) _IRR_OVERRIDE_;
 
+		//! adds a scene node for rendering many instances of a static mesh
+		//! the returned pointer must not be dropped.
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) _IRR_OVERRIDE_;
+
 		//! Adds a scene node for rendering a animated water surface mesh.
 		virtual ISceneNode* addWaterSurfaceSceneNode(IMesh* mesh, f32 waveHeight, f32 waveSpeed, f32 wlength, ISceneNode* parent=0, s32 id=-1,
 			const core::vector3df& position = core::vector3df(0,0,0),
@@ -111,6 +131,15 @@ namespace scene
 		//! registers a node for rendering it at a specific time.
 		virtual u32 registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass = ESNRP_AUTOMATIC) _IRR_OVERRIDE_;
 
+		//! registers a solid mesh buffer of a node for rendering.
+		virtual u32 registerMeshBufferForRendering(ISceneNode* node, IMeshBuffer* buffer, const video::SMaterial& material) _IRR_OVERRIDE_;
+
+		//! Get the number of material changes avoided in the last solid pass.
+		virtual u32 getMaterialChangesAvoided() const _IRR_OVERRIDE_;
+
+		//! Registers a mesh scene node for static batching.
+		virtual u32 registerMeshForStaticBatching(IMeshSceneNode* node) _IRR_OVERRIDE_;
+
 		//! Clear all nodes which are currently registered for rendering
 		virtual void clearAllRegisteredNodesForRendering() _IRR_OVERRIDE_;
 
@@ -365,6 +394,14 @@ namespace scene
 		virtual ITriangleSelector* createOctreeTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
 			ISceneNode* node, s32 minimalPolysPerNode=32) _IRR_OVERRIDE_;
 
+		//! Creates a ITriangleSelector, optimized by a bounding volume hierarchy.
+		virtual ITriangleSelector* createBVHTriangleSelector(IMesh* mesh,
+			ISceneNode* node, s32 maximalPolysPerLeaf) _IRR_OVERRIDE_;
+
+		//! Creates a ITriangleSelector for a meshbuffer, optimized by a bounding volume hierarchy.
+		virtual ITriangleSelector* createBVHTriangleSelector(IMeshBuffer* meshBuffer, irr::u32 materialIndex,
+			ISceneNode* node, s32 maximalPolysPerLeaf) _IRR_OVERRIDE_;
+
 		//! Creates a simple dynamic ITriangleSelector, based on a axis aligned bounding box.
 		virtual ITriangleSelector* createTriangleSelectorFromBoundingBox(
 			ISceneNode* node) _IRR_OVERRIDE_;
@@ -536,29 +573,68 @@ namespace scene
 		// load and create a mesh which we know already isn't in the cache and put it in there
 		IAnimatedMesh* getUncachedMesh(io::IReadFile* file, const io::path& filename, const io::path& cachename);
 
+		// create a mesh with the mesh loaders, returns a grabbed mesh
+		IAnimatedMesh* loadMesh(io::IReadFile* file, const io::path& filename);
+
 		//! clears the deletion list
 		void clearDeletionList();
 
+		//! returns the culling method which culled the node, EAC_OFF if it is visible
+		E_CULLING_TYPE getCulledBy(const ISceneNode* node) const;
+
+		//! returns if node is culled, and counts the culling method in the statistics
+		bool isCulledCounted(const ISceneNode* node, video::SFrameStats& stats) const;
+
+		//! returns the statistics the registration of the calling thread is counted in
+		video::SFrameStats& getRegisterStats() const;
+
 		//! writes a scene node
 		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath=0, bool init=false);
 
+		//! registers a node in the render lists of the scene manager or of a traversal part
+		template <class TLists>
+		u32 registerNodeInLists(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass, TLists& lists, video::SFrameStats& stats);
+
+		//! returns the number of threads for the traversal, creates the thread pool
+		u32 getTraversalThreads();
+
+		//! animates the children of the root node on the traversal threads
+		void animateParallel(u32 timeMs);
+
+		//! registers the children of the root node on the traversal threads
+		void registerParallel();
+
+		//! runs the current traversal phase on the children of the root node
+		void runTraversal();
+
+		//! runs one part of a parallel traversal
+		void runTraversalPart(u32 part, u32 thread);
+
+		//! appends the lists of all traversal parts to the scene manager lists
+		void mergeTraversalLists();
+
+		//! sorts the solid list by material and depth and renders it
+		void renderSolidList();
+
+		//! solid node, or a single mesh buffer of a node drawn by the scene manager
 		struct DefaultNodeEntry
 		{
 			DefaultNodeEntry(ISceneNode* n) :
-				Node(n), TextureValue(0)
-			{
-				if (n->getMaterialCount())
-					TextureValue = (n->getMaterial(0).getTexture(0));
-			}
+				Node(n), Buffer(0), Material(0) {}
 
-			bool operator < (const DefaultNodeEntry& other) const
-			{
-				return (TextureValue < other.TextureValue);
-			}
+			DefaultNodeEntry(ISceneNode* n, IMeshBuffer* mb, const video::SMaterial* m) :
+				Node(n), Buffer(mb), Material(m) {}
 
 			ISceneNode* Node;
-			private:
-			void* TextureValue;
+			IMeshBuffer* Buffer;
+			const video::SMaterial* Material;
+		};
+
+		//! sort key of a solid list entry
+		struct SolidSortEntry
+		{
+			u64 Key;
+			u32 Index;
 		};
 
 		//! sort on distance (center) to camera
@@ -619,7 +695,49 @@ namespace scene
 		gui::ICursorControl* CursorControl;
 
 		//! collision manager
-		ISceneCollisionManager* CollisionManager;
+		CSceneCollisionManager* CollisionManager;
+
+		//! render lists and deletion queue of one part of a parallel traversal
+		struct SRegisterLists
+		{
+			core::array<ISceneNode*> CameraList;
+			core::array<ISceneNode*> LightList;
+			core::array<ISceneNode*> ShadowNodeList;
+			core::array<ISceneNode*> SkyBoxList;
+			core::array<DefaultNodeEntry> SolidNodeList;
+			core::array<TransparentNodeEntry> TransparentNodeList;
+			core::array<TransparentNodeEntry> TransparentEffectNodeList;
+			core::array<ISceneNode*> DeletionList;
+			core::array<IMeshSceneNode*> StaticBatchPending;
+			video::SFrameStats Stats;
+		};
+
+		//! job running a part of the children of the root node
+		struct STraversalJob : public IThreadJob
+		{
+			virtual void runPart(u32 part, u32 thread) _IRR_OVERRIDE_
+			{
+				Manager->runTraversalPart(part, thread);
+			}
+
+			CSceneManager* Manager;
+		};
+
+		//! parallel traversal
+		CThreadPool* TraversalPool;
+		STraversalJob TraversalJob;
+		core::array<ISceneNode*> TraversalNodes;
+		core::array<SRegisterLists> TraversalLists;
+		core::array<SRegisterLists*> TraversalThreadLists;
+		ISceneNode* TraversalSerialNode;
+		u32 TraversalThreadCount;
+		u32 TraversalParts;
+		u32 TraversalTimeMs;
+		bool TraversalAnimate;
+		bool TraversalRunning;
+
+		//! true while the nodes register themselves, culling checks are counted then
+		bool Registering;
 
 		//! render pass lists
 		core::array<ISceneNode*> CameraList;
@@ -630,6 +748,18 @@ namespace scene
 		core::array<TransparentNodeEntry> TransparentNodeList;
 		core::array<TransparentNodeEntry> TransparentEffectNodeList;
 
+		//! sort keys of the solid list, and scratch space for the radix sort
+		core::array<SolidSortEntry> SolidSortKeys;
+		core::array<SolidSortEntry> SolidSortTemp;
+		u32 MaterialChangesAvoided;
+
+		//! static batching, only created if enabled
+		CStaticMeshBatcher* StaticBatcher;
+		core::array<IMeshSceneNode*> StaticBatchPending;
+
+		//! tree of the bounds of all nodes, only created if enabled
+		CSceneNodeTree* NodeTree;
+
 		core::array<IMeshLoader*> MeshLoaderList;
 		core::array<ISceneLoader*> SceneLoaderList;
 		core::array<ISceneNode*> DeletionList;
@@ -0,0 +1,709 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodeTree.h"
+#include "ISceneNode.h"
+#include "ICameraSceneNode.h"
+#include "SViewFrustum.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! margin added to the world box of a leaf, relative to its largest extent
+static const f32 NODE_TREE_MARGIN = 0.1f;
+
+//! number of frames a moving node is expected to keep its motion
+static const f32 NODE_TREE_MOTION_FRAMES = 4.f;
+
+//! size of the stacks of the queries, enough for any balanced tree
+static const u32 NODE_TREE_STACK_SIZE = 256;
+
+namespace
+{
+	//! compares boxes exactly, the operator of aabbox3d uses a tolerance
+	inline bool isSameBox(const core::aabbox3df& a, const core::aabbox3df& b)
+	{
+		return a.MinEdge.X == b.MinEdge.X && a.MinEdge.Y == b.MinEdge.Y && a.MinEdge.Z == b.MinEdge.Z &&
+			a.MaxEdge.X == b.MaxEdge.X && a.MaxEdge.Y == b.MaxEdge.Y && a.MaxEdge.Z == b.MaxEdge.Z;
+	}
+
+	inline core::aabbox3df getUnion(const core::aabbox3df& a, const core::aabbox3df& b)
+	{
+		core::aabbox3df box(a);
+		box.addInternalBox(b);
+		return box;
+	}
+
+	//! enlarges a box by the margin, and further in the direction the node moves
+	inline core::aabbox3df getEnlarged(const core::aabbox3df& box, const core::vector3df& motion)
+	{
+		const core::vector3df extent = box.getExtent();
+		const f32 margin = core::max_(extent.X, extent.Y, extent.Z) * NODE_TREE_MARGIN + core::ROUNDING_ERROR_f32;
+		core::aabbox3df enlarged(box.MinEdge - core::vector3df(margin), box.MaxEdge + core::vector3df(margin));
+
+		const core::vector3df ahead = motion * NODE_TREE_MOTION_FRAMES;
+		if (ahead.X < 0.f) enlarged.MinEdge.X += ahead.X; else enlarged.MaxEdge.X += ahead.X;
+		if (ahead.Y < 0.f) enlarged.MinEdge.Y += ahead.Y; else enlarged.MaxEdge.Y += ahead.Y;
+		if (ahead.Z < 0.f) enlarged.MinEdge.Z += ahead.Z; else enlarged.MaxEdge.Z += ahead.Z;
+		return enlarged;
+	}
+
+	inline u32 getHash(const ISceneNode* node)
+	{
+		const size_t key = (size_t)node;
+		return (u32)((key >> 4) ^ (key >> 20)) * 2654435761u;
+	}
+
+	//! clips the range of a line to the slab of a box on one axis
+	inline bool clipAxis(f32 start, f32 dir, f32 minEdge, f32 maxEdge, f32& tmin, f32& tmax)
+	{
+		if (dir == 0.f)
+			return start >= minEdge && start <= maxEdge;
+
+		const f32 inv = 1.f / dir;
+		f32 t0 = (minEdge - start) * inv;
+		f32 t1 = (maxEdge - start) * inv;
+		if (t0 > t1)
+			core::swap(t0, t1);
+		if (t0 > tmin)
+			tmin = t0;
+		if (t1 < tmax)
+			tmax = t1;
+		return tmin <= tmax;
+	}
+
+	//! returns the line parameter at which a line enters a box, if it does
+	inline bool getLineEntry(const core::aabbox3df& box, const core::vector3df& start,
+		const core::vector3df& dir, f32& outT)
+	{
+		f32 tmin = 0.f;
+		f32 tmax = 1.f;
+		if (!clipAxis(start.X, dir.X, box.MinEdge.X, box.MaxEdge.X, tmin, tmax) ||
+			!clipAxis(start.Y, dir.Y, box.MinEdge.Y, box.MaxEdge.Y, tmin, tmax) ||
+			!clipAxis(start.Z, dir.Z, box.MinEdge.Z, box.MaxEdge.Z, tmin, tmax))
+			return false;
+
+		outT = tmin;
+		return true;
+	}
+}
+
+
+//! constructor
+CSceneNodeTree::CSceneNodeTree()
+: Root(-1), FreeList(-1), Frame(0), CullCamera(0), CullFrame(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CSceneNodeTree");
+	#endif
+}
+
+
+//! destructor
+CSceneNodeTree::~CSceneNodeTree()
+{
+	clear();
+}
+
+
+//! removes all nodes
+void CSceneNodeTree::clear()
+{
+	for (u32 i=0; i<Leaves.size(); ++i)
+		Leaves[i].Node->drop();
+
+	TreeNodes.clear();
+	Leaves.clear();
+	Slots.clear();
+	Root = -1;
+	FreeList = -1;
+	CullCamera = 0;
+}
+
+
+//! brings the tree up to date with all nodes below root
+void CSceneNodeTree::update(ISceneNode* root)
+{
+	++Frame;
+
+	if (root)
+		updateChildren(root);
+
+	// nodes which were not found anymore have been removed from the scene
+	for (u32 i=Leaves.size(); i>0; --i)
+	{
+		if (Leaves[i-1].Seen != Frame)
+			removeLeaf(i-1);
+	}
+}
+
+
+//! updates the leaves of the children of a node and of their children
+void CSceneNodeTree::updateChildren(ISceneNode* node)
+{
+	const ISceneNodeList& children = node->getChildren();
+	ISceneNodeList::ConstIterator it = children.begin();
+	for (; it != children.end(); ++it)
+	{
+		ISceneNode* child = *it;
+
+		const s32 index = findLeaf(child);
+		if (index < 0)
+		{
+			addLeaf(child);
+		}
+		else
+		{
+			SLeaf& leaf = Leaves[index];
+			leaf.Seen = Frame;
+
+			const core::matrix4& transform = child->getAbsoluteTransformation();
+			const core::aabbox3df& box = child->getBoundingBox();
+			if (!(leaf.Transform == transform) || !isSameBox(leaf.LocalBox, box))
+			{
+				const core::vector3df oldCenter = leaf.WorldBox.getCenter();
+
+				leaf.Transform = transform;
+				leaf.LocalBox = box;
+				leaf.WorldBox = box;
+				transform.transformBoxEx(leaf.WorldBox);
+
+				// only reinsert nodes which left their enlarged box
+				if (!leaf.WorldBox.isFullInside(TreeNodes[leaf.TreeNode].Box))
+				{
+					removeTreeLeaf(leaf.TreeNode);
+					TreeNodes[leaf.TreeNode].Box = getEnlarged(leaf.WorldBox, leaf.WorldBox.getCenter() - oldCenter);
+					insertTreeLeaf(leaf.TreeNode);
+				}
+			}
+		}
+
+		updateChildren(child);
+	}
+}
+
+
+//! adds a new leaf for a node
+void CSceneNodeTree::addLeaf(ISceneNode* node)
+{
+	// keep the hash table at most half full
+	if ((Leaves.size() + 1) * 2 > Slots.size())
+		resizeSlots(core::max_(16u, Slots.size() * 2));
+
+	node->grab();
+
+	SLeaf leaf;
+	leaf.Node = node;
+	leaf.Transform = node->getAbsoluteTransformation();
+	leaf.LocalBox = node->getBoundingBox();
+	leaf.WorldBox = leaf.LocalBox;
+	leaf.Transform.transformBoxEx(leaf.WorldBox);
+	leaf.TreeNode = allocateTreeNode();
+	leaf.Seen = Frame;
+	leaf.Visible = 0;
+
+	TreeNodes[leaf.TreeNode].Box = getEnlarged(leaf.WorldBox, core::vector3df(0.f));
+	TreeNodes[leaf.TreeNode].Leaf = Leaves.size();
+	Leaves.push_back(leaf);
+	setSlot(node, Leaves.size() - 1);
+
+	insertTreeLeaf(leaf.TreeNode);
+}
+
+
+//! removes a leaf and releases its node
+void CSceneNodeTree::removeLeaf(u32 index)
+{
+	ISceneNode* node = Leaves[index].Node;
+	const s32 treeNode = Leaves[index].TreeNode;
+
+	removeTreeLeaf(treeNode);
+	freeTreeNode(treeNode);
+	removeSlot(node);
+
+	// fill the gap with the last leaf
+	const u32 last = Leaves.size() - 1;
+	if (index != last)
+	{
+		Leaves[index] = Leaves[last];
+		TreeNodes[Leaves[index].TreeNode].Leaf = index;
+		setSlot(Leaves[index].Node, index);
+	}
+	Leaves.set_used(last);
+
+	node->drop();
+}
+
+
+//! tests the world boxes of the nodes against the bounding box of the view frustum
+void CSceneNodeTree::cull(const ICameraSceneNode* camera)
+{
+	++CullFrame;
+	CullCamera = camera;
+	if (!camera || Root < 0)
+		return;
+
+	CullBox = camera->getViewFrustum()->getBoundingBox();
+
+	s32 stack[NODE_TREE_STACK_SIZE];
+	u32 top = 0;
+	stack[top++] = Root;
+
+	while (top)
+	{
+		const STreeNode& node = TreeNodes[stack[--top]];
+		if (!node.Box.intersectsWithBox(CullBox))
+			continue;
+
+		if (node.Leaf >= 0)
+		{
+			// same test as the scene manager does for EAC_BOX
+			SLeaf& leaf = Leaves[node.Leaf];
+			if (leaf.WorldBox.intersectsWithBox(CullBox))
+				leaf.Visible = CullFrame;
+		}
+		else
+		{
+			stack[top++] = node.Child1;
+			stack[top++] = node.Child2;
+		}
+	}
+}
+
+
+//! returns the result of the last cull for a node
+CSceneNodeTree::E_VISIBILITY CSceneNodeTree::getVisibility(const ISceneNode* node,
+		const ICameraSceneNode* camera) const
+{
+	if (!camera || camera != CullCamera ||
+		!isSameBox(camera->getViewFrustum()->getBoundingBox(), CullBox))
+		return EV_UNKNOWN;
+
+	const s32 index = findLeaf(node);
+	if (index < 0)
+		return EV_UNKNOWN;
+
+	// nodes may change while they are registered
+	const SLeaf& leaf = Leaves[index];
+	if (!(leaf.Transform == node->getAbsoluteTransformation()) ||
+		!isSameBox(leaf.LocalBox, node->getBoundingBox()))
+		return EV_UNKNOWN;
+
+	return (leaf.Visible == CullFrame) ? EV_INSIDE : EV_OUTSIDE;
+}
+
+
+//! collects the nodes whose enlarged box is hit by a line, nearest first
+void CSceneNodeTree::getNodesOnLine(const core::line3df& line, core::array<SLineHit>& outHits) const
+{
+	outHits.set_used(0);
+	if (Root < 0)
+		return;
+
+	const core::vector3df dir = line.end - line.start;
+	const f32 lengthSQ = dir.getLengthSQ();
+
+	s32 stack[NODE_TREE_STACK_SIZE];
+	u32 top = 0;
+	stack[top++] = Root;
+
+	while (top)
+	{
+		const STreeNode& node = TreeNodes[stack[--top]];
+
+		f32 t;
+		if (!getLineEntry(node.Box, line.start, dir, t))
+			continue;
+
+		if (node.Leaf >= 0)
+		{
+			SLineHit hit;
+			hit.Node = Leaves[node.Leaf].Node;
+			hit.DistanceSQ = t * t * lengthSQ;
+			outHits.push_back(hit);
+		}
+		else
+		{
+			stack[top++] = node.Child1;
+			stack[top++] = node.Child2;
+		}
+	}
+
+	outHits.sort();
+}
+
+
+//! collects the nodes whose world box intersects a box
+void CSceneNodeTree::getNodesInBox(const core::aabbox3df& box, core::array<ISceneNode*>& outNodes) const
+{
+	outNodes.set_used(0);
+	if (Root < 0)
+		return;
+
+	s32 stack[NODE_TREE_STACK_SIZE];
+	u32 top = 0;
+	stack[top++] = Root;
+
+	while (top)
+	{
+		const STreeNode& node = TreeNodes[stack[--top]];
+		if (!node.Box.intersectsWithBox(box))
+			continue;
+
+		if (node.Leaf >= 0)
+		{
+			const SLeaf& leaf = Leaves[node.Leaf];
+			if (leaf.WorldBox.intersectsWithBox(box))
+				outNodes.push_back(leaf.Node);
+		}
+		else
+		{
+			stack[top++] = node.Child1;
+			stack[top++] = node.Child2;
+		}
+	}
+}
+
+
+//! returns an unused node of the tree
+s32 CSceneNodeTree::allocateTreeNode()
+{
+	s32 index = FreeList;
+	if (index < 0)
+	{
+		TreeNodes.push_back(STreeNode());
+		index = TreeNodes.size() - 1;
+	}
+	else
+	{
+		FreeList = TreeNodes[index].Parent;
+	}
+
+	STreeNode& node = TreeNodes[index];
+	node.Parent = -1;
+	node.Child1 = -1;
+	node.Child2 = -1;
+	node.Height = 0;
+	node.Leaf = -1;
+	return index;
+}
+
+
+//! puts a node of the tree on the free list
+void CSceneNodeTree::freeTreeNode(s32 index)
+{
+	TreeNodes[index].Parent = FreeList;
+	TreeNodes[index].Height = -1;
+	FreeList = index;
+}
+
+
+//! inserts a leaf next to the node whose box grows the least
+void CSceneNodeTree::insertTreeLeaf(s32 leaf)
+{
+	if (Root < 0)
+	{
+		Root = leaf;
+		TreeNodes[Root].Parent = -1;
+		return;
+	}
+
+	// find the best sibling by the surface area of the boxes
+	const core::aabbox3df leafBox = TreeNodes[leaf].Box;
+	s32 index = Root;
+	while (TreeNodes[index].Leaf < 0)
+	{
+		const STreeNode& node = TreeNodes[index];
+		const f32 area = node.Box.getArea();
+		const f32 combinedArea = getUnion(node.Box, leafBox).getArea();
+
+		// cost of a new parent for this node and the leaf
+		const f32 cost = 2.f * combinedArea;
+
+		// minimum cost of pushing the leaf further down
+		const f32 inheritanceCost = 2.f * (combinedArea - area);
+
+		const STreeNode& child1 = TreeNodes[node.Child1];
+		f32 cost1 = getUnion(child1.Box, leafBox).getArea() + inheritanceCost;
+		if (child1.Leaf < 0)
+			cost1 -= child1.Box.getArea();
+
+		const STreeNode& child2 = TreeNodes[node.Child2];
+		f32 cost2 = getUnion(child2.Box, leafBox).getArea() + inheritanceCost;
+		if (child2.Leaf < 0)
+			cost2 -= child2.Box.getArea();
+
+		if (cost < cost1 && cost < cost2)
+			break;
+
+		index = (cost1 < cost2) ? node.Child1 : node.Child2;
+	}
+
+	const s32 sibling = index;
+
+	// create a new parent for the sibling and the leaf
+	const s32 oldParent = TreeNodes[sibling].Parent;
+	const s32 newParent = allocateTreeNode();
+	TreeNodes[newParent].Parent = oldParent;
+	TreeNodes[newParent].Box = getUnion(leafBox, TreeNodes[sibling].Box);
+	TreeNodes[newParent].Height = TreeNodes[sibling].Height + 1;
+	TreeNodes[newParent].Child1 = sibling;
+	TreeNodes[newParent].Child2 = leaf;
+	TreeNodes[sibling].Parent = newParent;
+	TreeNodes[leaf].Parent = newParent;
+
+	if (oldParent < 0)
+		Root = newParent;
+	else if (TreeNodes[oldParent].Child1 == sibling)
+		TreeNodes[oldParent].Child1 = newParent;
+	else
+		TreeNodes[oldParent].Child2 = newParent;
+
+	// fix the heights and boxes of the parents
+	index = TreeNodes[leaf].Parent;
+	while (index >= 0)
+	{
+		index = balance(index);
+
+		STreeNode& node = TreeNodes[index];
+		node.Height = 1 + core::max_(TreeNodes[node.Child1].Height, TreeNodes[node.Child2].Height);
+		node.Box = getUnion(TreeNodes[node.Child1].Box, TreeNodes[node.Child2].Box);
+
+		index = node.Parent;
+	}
+}
+
+
+//! removes a leaf from the tree, the node of the leaf is not freed
+void CSceneNodeTree::removeTreeLeaf(s32 leaf)
+{
+	if (leaf == Root)
+	{
+		Root = -1;
+		return;
+	}
+
+	const s32 parent = TreeNodes[leaf].Parent;
+	const s32 grandParent = TreeNodes[parent].Parent;
+	const s32 sibling = (TreeNodes[parent].Child1 == leaf) ? TreeNodes[parent].Child2 : TreeNodes[parent].Child1;
+
+	freeTreeNode(parent);
+
+	if (grandParent < 0)
+	{
+		Root = sibling;
+		TreeNodes[sibling].Parent = -1;
+		return;
+	}
+
+	// the sibling takes the place of the parent
+	if (TreeNodes[grandParent].Child1 == parent)
+		TreeNodes[grandParent].Child1 = sibling;
+	else
+		TreeNodes[grandParent].Child2 = sibling;
+	TreeNodes[sibling].Parent = grandParent;
+
+	s32 index = grandParent;
+	while (index >= 0)
+	{
+		index = balance(index);
+
+		STreeNode& node = TreeNodes[index];
+		node.Height = 1 + core::max_(TreeNodes[node.Child1].Height, TreeNodes[node.Child2].Height);
+		node.Box = getUnion(TreeNodes[node.Child1].Box, TreeNodes[node.Child2].Box);
+
+		index = node.Parent;
+	}
+}
+
+
+//! rotates the higher child of a node up if the heights of its children differ by more than one
+/** \return Index of the node which took the place of the node. */
+s32 CSceneNodeTree::balance(s32 iA)
+{
+	STreeNode& A = TreeNodes[iA];
+	if (A.Leaf >= 0 || A.Height < 2)
+		return iA;
+
+	const s32 iB = A.Child1;
+	const s32 iC = A.Child2;
+	STreeNode& B = TreeNodes[iB];
+	STreeNode& C = TreeNodes[iC];
+
+	const s32 diff = C.Height - B.Height;
+
+	// rotate C up
+	if (diff > 1)
+	{
+		const s32 iF = C.Child1;
+		const s32 iG = C.Child2;
+		STreeNode& F = TreeNodes[iF];
+		STreeNode& G = TreeNodes[iG];
+
+		C.Child1 = iA;
+		C.Parent = A.Parent;
+		A.Parent = iC;
+
+		if (C.Parent < 0)
+			Root = iC;
+		else if (TreeNodes[C.Parent].Child1 == iA)
+			TreeNodes[C.Parent].Child1 = iC;
+		else
+			TreeNodes[C.Parent].Child2 = iC;
+
+		if (F.Height > G.Height)
+		{
+			C.Child2 = iF;
+			A.Child2 = iG;
+			G.Parent = iA;
+			A.Box = getUnion(B.Box, G.Box);
+			C.Box = getUnion(A.Box, F.Box);
+			A.Height = 1 + core::max_(B.Height, G.Height);
+			C.Height = 1 + core::max_(A.Height, F.Height);
+		}
+		else
+		{
+			C.Child2 = iG;
+			A.Child2 = iF;
+			F.Parent = iA;
+			A.Box = getUnion(B.Box, F.Box);
+			C.Box = getUnion(A.Box, G.Box);
+			A.Height = 1 + core::max_(B.Height, F.Height);
+			C.Height = 1 + core::max_(A.Height, G.Height);
+		}
+
+		return iC;
+	}
+
+	// rotate B up
+	if (diff < -1)
+	{
+		const s32 iD = B.Child1;
+		const s32 iE = B.Child2;
+		STreeNode& D = TreeNodes[iD];
+		STreeNode& E = TreeNodes[iE];
+
+		B.Child1 = iA;
+		B.Parent = A.Parent;
+		A.Parent = iB;
+
+		if (B.Parent < 0)
+			Root = iB;
+		else if (TreeNodes[B.Parent].Child1 == iA)
+			TreeNodes[B.Parent].Child1 = iB;
+		else
+			TreeNodes[B.Parent].Child2 = iB;
+
+		if (D.Height > E.Height)
+		{
+			B.Child2 = iD;
+			A.Child1 = iE;
+			E.Parent = iA;
+			A.Box = getUnion(C.Box, E.Box);
+			B.Box = getUnion(A.Box, D.Box);
+			A.Height = 1 + core::max_(C.Height, E.Height);
+			B.Height = 1 + core::max_(A.Height, D.Height);
+		}
+		else
+		{
+			B.Child2 = iE;
+			A.Child1 = iD;
+			D.Parent = iA;
+			A.Box = getUnion(C.Box, D.Box);
+			B.Box = getUnion(A.Box, E.Box);
+			A.Height = 1 + core::max_(C.Height, D.Height);
+			B.Height = 1 + core::max_(A.Height, E.Height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
+
+
+//! returns the index of the leaf of a node, -1 if the node is not in the tree
+s32 CSceneNodeTree::findLeaf(const ISceneNode* node) const
+{
+	if (Slots.empty())
+		return -1;
+
+	const u32 mask = Slots.size() - 1;
+	u32 i = getHash(node) & mask;
+	while (Slots[i].Node)
+	{
+		if (Slots[i].Node == node)
+			return Slots[i].Leaf;
+		i = (i + 1) & mask;
+	}
+	return -1;
+}
+
+
+//! sets the leaf of a node in the hash table
+void CSceneNodeTree::setSlot(const ISceneNode* node, s32 leaf)
+{
+	const u32 mask = Slots.size() - 1;
+	u32 i = getHash(node) & mask;
+	while (Slots[i].Node && Slots[i].Node != node)
+		i = (i + 1) & mask;
+
+	Slots[i].Node = node;
+	Slots[i].Leaf = leaf;
+}
+
+
+//! removes a node from the hash table
+void CSceneNodeTree::removeSlot(const ISceneNode* node)
+{
+	const u32 mask = Slots.size() - 1;
+	u32 i = getHash(node) & mask;
+	while (Slots[i].Node != node)
+		i = (i + 1) & mask;
+
+	// move following entries back into the gap, unless that is before their hash position
+	u32 j = i;
+	for (;;)
+	{
+		Slots[i].Node = 0;
+
+		for (;;)
+		{
+			j = (j + 1) & mask;
+			if (!Slots[j].Node)
+				return;
+
+			const u32 k = getHash(Slots[j].Node) & mask;
+			const bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+			if (!stays)
+				break;
+		}
+
+		Slots[i] = Slots[j];
+		i = j;
+	}
+}
+
+
+//! resizes the hash table and enters all leaves again
+void CSceneNodeTree::resizeSlots(u32 size)
+{
+	SSlot empty;
+	empty.Node = 0;
+	empty.Leaf = -1;
+
+	Slots.set_used(size);
+	for (u32 i=0; i<size; ++i)
+		Slots[i] = empty;
+
+	for (u32 i=0; i<Leaves.size(); ++i)
+		setSlot(Leaves[i].Node, i);
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,154 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_NODE_TREE_H_INCLUDED__
+#define __C_SCENE_NODE_TREE_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "irrArray.h"
+#include "matrix4.h"
+#include "aabbox3d.h"
+#include "line3d.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ISceneNode;
+	class ICameraSceneNode;
+
+	//! Dynamic bounding volume tree of the world space boxes of the scene nodes
+	/** Every scene node below the root is a leaf of a binary tree of boxes,
+	which is kept balanced by rotations like an AVL tree. Leaves store the box
+	of their node enlarged by a margin, so a node which moves a little keeps
+	its place in the tree. The tree is brought up to date once per frame: only
+	nodes whose absolute transformation or bounding box changed get a new box,
+	and only the ones which left their enlarged box are reinserted. Queries
+	for lines, boxes and the view frustum only visit the branches they touch.
+	The leaves grab their nodes, so nodes removed from the scene stay alive
+	until the next update. */
+	class CSceneNodeTree : public virtual IReferenceCounted
+	{
+	public:
+
+		//! result of the last frustum test for a node
+		enum E_VISIBILITY
+		{
+			//! the node is not in the tree, or changed since the last update
+			EV_UNKNOWN = 0,
+
+			//! the world box of the node intersects the bounding box of the frustum
+			EV_INSIDE,
+
+			//! the world box of the node is outside of the bounding box of the frustum
+			EV_OUTSIDE
+		};
+
+		//! a node whose enlarged box is hit by a line
+		struct SLineHit
+		{
+			ISceneNode* Node;
+
+			//! squared distance from the line start to the point where the line enters the enlarged box
+			f32 DistanceSQ;
+
+			bool operator<(const SLineHit& other) const
+			{
+				return DistanceSQ < other.DistanceSQ;
+			}
+		};
+
+		//! constructor
+		CSceneNodeTree();
+
+		//! destructor
+		virtual ~CSceneNodeTree();
+
+		//! brings the tree up to date with all nodes below root
+		void update(ISceneNode* root);
+
+		//! tests the world boxes of the nodes against the bounding box of the view frustum
+		void cull(const ICameraSceneNode* camera);
+
+		//! returns the result of the last cull for a node
+		/** Only reads the tree, so it may be called by several threads at once. */
+		E_VISIBILITY getVisibility(const ISceneNode* node, const ICameraSceneNode* camera) const;
+
+		//! collects the nodes whose enlarged box is hit by a line, nearest first
+		void getNodesOnLine(const core::line3df& line, core::array<SLineHit>& outHits) const;
+
+		//! collects the nodes whose world box intersects a box
+		void getNodesInBox(const core::aabbox3df& box, core::array<ISceneNode*>& outNodes) const;
+
+		//! removes all nodes
+		void clear();
+
+		//! returns the number of nodes in the tree
+		u32 getNodeCount() const { return Leaves.size(); }
+
+	private:
+
+		//! node of the tree, either an inner node with two children or a leaf
+		struct STreeNode
+		{
+			core::aabbox3df Box;
+			s32 Parent; // next free node while unused
+			s32 Child1;
+			s32 Child2;
+			s32 Height; // 0 for leaves
+			s32 Leaf; // index into Leaves, -1 for inner nodes
+		};
+
+		//! a scene node with everything needed to notice changes
+		struct SLeaf
+		{
+			ISceneNode* Node;
+			core::matrix4 Transform;
+			core::aabbox3df LocalBox;
+			core::aabbox3df WorldBox;
+			s32 TreeNode;
+			u32 Seen;
+			u32 Visible;
+		};
+
+		//! entry of the open addressing hash table from scene nodes to leaves
+		struct SSlot
+		{
+			const ISceneNode* Node;
+			s32 Leaf;
+		};
+
+		void updateChildren(ISceneNode* node);
+		void addLeaf(ISceneNode* node);
+		void removeLeaf(u32 index);
+
+		s32 allocateTreeNode();
+		void freeTreeNode(s32 index);
+		void insertTreeLeaf(s32 index);
+		void removeTreeLeaf(s32 index);
+		s32 balance(s32 index);
+
+		s32 findLeaf(const ISceneNode* node) const;
+		void setSlot(const ISceneNode* node, s32 leaf);
+		void removeSlot(const ISceneNode* node);
+		void resizeSlots(u32 size);
+
+		core::array<STreeNode> TreeNodes;
+		core::array<SLeaf> Leaves;
+		core::array<SSlot> Slots;
+		s32 Root;
+		s32 FreeList;
+		u32 Frame;
+
+		//! camera and frustum box of the last cull
+		const ICameraSceneNode* CullCamera;
+		core::aabbox3df CullBox;
+		u32 CullFrame;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -8,8 +8,13 @@
 #include "CSkinnedMesh.h"
 #include "CBoneSceneNode.h"
 #include "IAnimatedMeshSceneNode.h"
+#include "CThreadPool.h"
 #include "os.h"
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	#include <emmintrin.h>
+#endif
+
 namespace
 {
 	// Frames must always be increasing, so we remove objects where this isn't the case
@@ -82,6 +87,12 @@ namespace
 	{
 		return a.rotation == b.rotation;
 	}
+
+	// poses kept for other instances at the same frame
+	const irr::u32 MAX_CACHED_POSES = 16;
+
+	// vertices skinned by one part of a skinning job
+	const irr::u32 SKINNING_BAND_VERTICES = 0x1000;
 };
 
 namespace irr
@@ -92,7 +103,8 @@ namespace scene
 
 //! constructor
 CSkinnedMesh::CSkinnedMesh()
-: SkinningBuffers(0), EndFrame(0.f), FramesPerSecond(25.f),
+: SkinningBuffers(0), PoseCacheTime(0), PoseVersion(0),
+	EndFrame(0.f), FramesPerSecond(25.f),
 	LastAnimatedFrame(-1), SkinnedLastFrame(false),
 	InterpolationMode(EIM_LINEAR),
 	HasAnimation(false), PreparedForSkinning(false),
@@ -109,6 +121,9 @@ CSkinnedMesh::CSkinnedMesh()
 //! destructor
 CSkinnedMesh::~CSkinnedMesh()
 {
+	for (u32 i=0; i<PoseCache.size(); ++i)
+		PoseCache[i]->drop();
+
 	for (u32 i=0; i<AllJoints.size(); ++i)
 		delete AllJoints[i];
 
@@ -191,7 +206,7 @@ void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
 		core::vector3df scale = oldScale;
 		core::quaternion rotation = oldRotation;
 
-		getFrameData(frame, joint,
+		getFrameData(frame, JointTracks[i],
 				position, joint->positionHint,
 				scale, joint->scaleHint,
 				rotation, joint->rotationHint);
@@ -232,67 +247,74 @@ void CSkinnedMesh::buildAllLocalAnimatedMatrices()
 	{
 		SJoint *joint = AllJoints[i];
 
-		//Could be faster:
+		buildLocalAnimatedMatrix(joint, JointTracks[i], joint->Animatedposition,
+				joint->Animatedrotation, joint->Animatedscale,
+				joint->LocalAnimatedMatrix, joint->GlobalSkinningSpace);
+	}
+	SkinnedLastFrame=false;
+}
 
-		if (joint->UseAnimationFrom &&
-			(joint->UseAnimationFrom->PositionKeys.size() ||
-			 joint->UseAnimationFrom->ScaleKeys.size() ||
-			 joint->UseAnimationFrom->RotationKeys.size() ))
-		{
-			joint->GlobalSkinningSpace=false;
-
-			// IRR_TEST_BROKEN_QUATERNION_USE: TODO - switched to getMatrix_transposed instead of getMatrix for downward compatibility.
-			//								   Not tested so far if this was correct or wrong before quaternion fix!
-			joint->Animatedrotation.getMatrix_transposed(joint->LocalAnimatedMatrix);
-
-			// --- joint->LocalAnimatedMatrix *= joint->Animatedrotation.getMatrix() ---
-			f32 *m1 = joint->LocalAnimatedMatrix.pointer();
-			core::vector3df &Pos = joint->Animatedposition;
-			m1[0] += Pos.X*m1[3];
-			m1[1] += Pos.Y*m1[3];
-			m1[2] += Pos.Z*m1[3];
-			m1[4] += Pos.X*m1[7];
-			m1[5] += Pos.Y*m1[7];
-			m1[6] += Pos.Z*m1[7];
-			m1[8] += Pos.X*m1[11];
-			m1[9] += Pos.Y*m1[11];
-			m1[10] += Pos.Z*m1[11];
-			m1[12] += Pos.X*m1[15];
-			m1[13] += Pos.Y*m1[15];
-			m1[14] += Pos.Z*m1[15];
-			// -----------------------------------
 
-			if (joint->ScaleKeys.size())
-			{
-				/*
-				core::matrix4 scaleMatrix;
-				scaleMatrix.setScale(joint->Animatedscale);
-				joint->LocalAnimatedMatrix *= scaleMatrix;
-				*/
-
-				// -------- joint->LocalAnimatedMatrix *= scaleMatrix -----------------
-				core::matrix4& mat = joint->LocalAnimatedMatrix;
-				mat[0] *= joint->Animatedscale.X;
-				mat[1] *= joint->Animatedscale.X;
-				mat[2] *= joint->Animatedscale.X;
-				mat[3] *= joint->Animatedscale.X;
-				mat[4] *= joint->Animatedscale.Y;
-				mat[5] *= joint->Animatedscale.Y;
-				mat[6] *= joint->Animatedscale.Y;
-				mat[7] *= joint->Animatedscale.Y;
-				mat[8] *= joint->Animatedscale.Z;
-				mat[9] *= joint->Animatedscale.Z;
-				mat[10] *= joint->Animatedscale.Z;
-				mat[11] *= joint->Animatedscale.Z;
-				// -----------------------------------
-			}
-		}
-		else
+void CSkinnedMesh::buildLocalAnimatedMatrix(const SJoint *joint, const SAnimationTrack *track,
+		const core::vector3df &position, const core::quaternion &rotation,
+		const core::vector3df &scale, core::matrix4 &matrix,
+		bool &globalSkinningSpace) const
+{
+	//Could be faster:
+
+	if (track && track->hasKeys())
+	{
+		globalSkinningSpace=false;
+
+		// IRR_TEST_BROKEN_QUATERNION_USE: TODO - switched to getMatrix_transposed instead of getMatrix for downward compatibility.
+		//								   Not tested so far if this was correct or wrong before quaternion fix!
+		rotation.getMatrix_transposed(matrix);
+
+		// --- matrix *= rotation.getMatrix() ---
+		f32 *m1 = matrix.pointer();
+		const core::vector3df &Pos = position;
+		m1[0] += Pos.X*m1[3];
+		m1[1] += Pos.Y*m1[3];
+		m1[2] += Pos.Z*m1[3];
+		m1[4] += Pos.X*m1[7];
+		m1[5] += Pos.Y*m1[7];
+		m1[6] += Pos.Z*m1[7];
+		m1[8] += Pos.X*m1[11];
+		m1[9] += Pos.Y*m1[11];
+		m1[10] += Pos.Z*m1[11];
+		m1[12] += Pos.X*m1[15];
+		m1[13] += Pos.Y*m1[15];
+		m1[14] += Pos.Z*m1[15];
+		// -----------------------------------
+
+		if (track->ScaleFrames.Count)
 		{
-			joint->LocalAnimatedMatrix=joint->LocalMatrix;
+			/*
+			core::matrix4 scaleMatrix;
+			scaleMatrix.setScale(scale);
+			matrix *= scaleMatrix;
+			*/
+
+			// -------- matrix *= scaleMatrix -----------------
+			matrix[0] *= scale.X;
+			matrix[1] *= scale.X;
+			matrix[2] *= scale.X;
+			matrix[3] *= scale.X;
+			matrix[4] *= scale.Y;
+			matrix[5] *= scale.Y;
+			matrix[6] *= scale.Y;
+			matrix[7] *= scale.Y;
+			matrix[8] *= scale.Z;
+			matrix[9] *= scale.Z;
+			matrix[10] *= scale.Z;
+			matrix[11] *= scale.Z;
+			// -----------------------------------
 		}
 	}
-	SkinnedLastFrame=false;
+	else
+	{
+		matrix=joint->LocalMatrix;
+	}
 }
 
 
@@ -318,202 +340,226 @@ void CSkinnedMesh::buildAllGlobalAnimatedMatrices(SJoint *joint, SJoint *parentJ
 }
 
 
-void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
+void CSkinnedMesh::getFrameData(f32 frame, const SAnimationTrack *track,
 				core::vector3df &position, s32 &positionHint,
 				core::vector3df &scale, s32 &scaleHint,
-				core::quaternion &rotation, s32 &rotationHint)
+				core::quaternion &rotation, s32 &rotationHint) const
 {
-	s32 foundPositionIndex = -1;
-	s32 foundScaleIndex = -1;
-	s32 foundRotationIndex = -1;
+	if (!track)
+		return;
 
-	if (joint->UseAnimationFrom)
+	const s32 foundPositionIndex = track->PositionFrames.find(frame, positionHint);
+	if (foundPositionIndex!=-1)
 	{
-		const core::array<SPositionKey> &PositionKeys=joint->UseAnimationFrom->PositionKeys;
-		const core::array<SScaleKey> &ScaleKeys=joint->UseAnimationFrom->ScaleKeys;
-		const core::array<SRotationKey> &RotationKeys=joint->UseAnimationFrom->RotationKeys;
-
-		if (PositionKeys.size())
+		if (InterpolationMode==EIM_CONSTANT || foundPositionIndex==0)
 		{
-			foundPositionIndex = -1;
+			position = track->Positions[foundPositionIndex];
+		}
+		else if (InterpolationMode==EIM_LINEAR)
+		{
+			const core::vector3df& positionA = track->Positions[foundPositionIndex];
+			const core::vector3df& positionB = track->Positions[foundPositionIndex-1];
 
-			//Test the Hints...
-			if (positionHint>=0 && (u32)positionHint < PositionKeys.size())
-			{
-				//check this hint
-				if (positionHint>0 && PositionKeys[positionHint].frame>=frame && PositionKeys[positionHint-1].frame<frame )
-					foundPositionIndex=positionHint;
-				else if (positionHint+1 < (s32)PositionKeys.size())
-				{
-					//check the next index
-					if ( PositionKeys[positionHint+1].frame>=frame &&
-							PositionKeys[positionHint+0].frame<frame)
-					{
-						positionHint++;
-						foundPositionIndex=positionHint;
-					}
-				}
-			}
+			const f32 fd1 = frame - track->PositionFrames.getFrame(foundPositionIndex);
+			const f32 fd2 = track->PositionFrames.getFrame(foundPositionIndex-1) - frame;
+			position = ((positionB-positionA)/(fd1+fd2))*fd1 + positionA;
+		}
+	}
 
-			//The hint test failed, do a full scan...
-			if (foundPositionIndex==-1)
-			{
-				for (u32 i=0; i<PositionKeys.size(); ++i)
-				{
-					if (PositionKeys[i].frame >= frame) //Keys should to be sorted by frame
-					{
-						foundPositionIndex=i;
-						positionHint=i;
-						break;
-					}
-				}
-			}
+	//------------------------------------------------------------
 
-			//Do interpolation...
-			if (foundPositionIndex!=-1)
-			{
-				if (InterpolationMode==EIM_CONSTANT || foundPositionIndex==0)
-				{
-					position = PositionKeys[foundPositionIndex].position;
-				}
-				else if (InterpolationMode==EIM_LINEAR)
-				{
-					const SPositionKey& KeyA = PositionKeys[foundPositionIndex];
-					const SPositionKey& KeyB = PositionKeys[foundPositionIndex-1];
+	const s32 foundScaleIndex = track->ScaleFrames.find(frame, scaleHint);
+	if (foundScaleIndex!=-1)
+	{
+		if (InterpolationMode==EIM_CONSTANT || foundScaleIndex==0)
+		{
+			scale = track->Scales[foundScaleIndex];
+		}
+		else if (InterpolationMode==EIM_LINEAR)
+		{
+			const core::vector3df& scaleA = track->Scales[foundScaleIndex];
+			const core::vector3df& scaleB = track->Scales[foundScaleIndex-1];
 
-					const f32 fd1 = frame - KeyA.frame;
-					const f32 fd2 = KeyB.frame - frame;
-					position = ((KeyB.position-KeyA.position)/(fd1+fd2))*fd1 + KeyA.position;
-				}
-			}
+			const f32 fd1 = frame - track->ScaleFrames.getFrame(foundScaleIndex);
+			const f32 fd2 = track->ScaleFrames.getFrame(foundScaleIndex-1) - frame;
+			scale = ((scaleB-scaleA)/(fd1+fd2))*fd1 + scaleA;
 		}
+	}
 
-		//------------------------------------------------------------
+	//-------------------------------------------------------------
 
-		if (ScaleKeys.size())
+	const s32 foundRotationIndex = track->RotationFrames.find(frame, rotationHint);
+	if (foundRotationIndex!=-1)
+	{
+		if (InterpolationMode==EIM_CONSTANT || foundRotationIndex==0)
 		{
-			foundScaleIndex = -1;
+			track->getRotation(foundRotationIndex, rotation);
+		}
+		else if (InterpolationMode==EIM_LINEAR)
+		{
+			core::quaternion rotationA;
+			core::quaternion rotationB;
+			track->getRotation(foundRotationIndex, rotationA);
+			track->getRotation(foundRotationIndex-1, rotationB);
 
-			//Test the Hints...
-			if (scaleHint>=0 && (u32)scaleHint < ScaleKeys.size())
-			{
-				//check this hint
-				if (scaleHint>0 && ScaleKeys[scaleHint].frame>=frame && ScaleKeys[scaleHint-1].frame<frame )
-					foundScaleIndex=scaleHint;
-				else if (scaleHint+1 < (s32)ScaleKeys.size())
-				{
-					//check the next index
-					if ( ScaleKeys[scaleHint+1].frame>=frame &&
-							ScaleKeys[scaleHint+0].frame<frame)
-					{
-						scaleHint++;
-						foundScaleIndex=scaleHint;
-					}
-				}
-			}
+			const f32 fd1 = frame - track->RotationFrames.getFrame(foundRotationIndex);
+			const f32 fd2 = track->RotationFrames.getFrame(foundRotationIndex-1) - frame;
+			const f32 t = fd1/(fd1+fd2);
 
+			rotation.slerp(rotationA, rotationB, t);
+		}
+	}
+}
 
-			//The hint test failed, do a full scan...
-			if (foundScaleIndex==-1)
-			{
-				for (u32 i=0; i<ScaleKeys.size(); ++i)
-				{
-					if (ScaleKeys[i].frame >= frame) //Keys should to be sorted by frame
-					{
-						foundScaleIndex=i;
-						scaleHint=i;
-						break;
-					}
-				}
-			}
 
-			//Do interpolation...
-			if (foundScaleIndex!=-1)
-			{
-				if (InterpolationMode==EIM_CONSTANT || foundScaleIndex==0)
-				{
-					scale = ScaleKeys[foundScaleIndex].scale;
-				}
-				else if (InterpolationMode==EIM_LINEAR)
-				{
-					const SScaleKey& KeyA = ScaleKeys[foundScaleIndex];
-					const SScaleKey& KeyB = ScaleKeys[foundScaleIndex-1];
+//! Searches the first key at or after the frame, -1 if all keys are before it
+/** The key is computed for evenly spaced frames, else found by bisection. */
+s32 CSkinnedMesh::SKeyFrames::search(f32 frame, s32 &hint) const
+{
+	if (!Count || getFrame(Count-1) < frame)
+		return -1;
 
-					const f32 fd1 = frame - KeyA.frame;
-					const f32 fd2 = KeyB.frame - frame;
-					scale = ((KeyB.scale-KeyA.scale)/(fd1+fd2))*fd1 + KeyA.scale;
-				}
-			}
+	u32 index;
+	if (Frames.empty())
+	{
+		index = 0;
+		if (Step>0.f && frame>First)
+			index = core::min_((u32)((frame-First)/Step), Count-1);
+
+		// correct the rounding of the division
+		while (index>0 && getFrame(index-1)>=frame)
+			--index;
+		while (getFrame(index)<frame)
+			++index;
+	}
+	else
+	{
+		index = 0;
+		u32 end = Count-1;
+		while (index<end)
+		{
+			const u32 middle = (index+end)/2;
+			if (Frames[middle]<frame)
+				index = middle+1;
+			else
+				end = middle;
 		}
+	}
 
-		//-------------------------------------------------------------
+	hint = index;
+	return index;
+}
 
-		if (RotationKeys.size())
+
+//! Builds the compact tracks which are sampled from the keys of the joints
+void CSkinnedMesh::buildAnimationTracks()
+{
+	OtherTracks.clear();
+	AnimationTracks.clear();
+	AnimationTracks.reallocate(AllJoints.size());
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		SJoint *joint=AllJoints[i];
+		AnimationTracks.push_back(SAnimationTrack());
+		SAnimationTrack& track=AnimationTracks.getLast();
+		u32 j;
+
+		track.PositionFrames.set(joint->PositionKeys);
+		track.Positions.reallocate(joint->PositionKeys.size());
+		for (j=0; j<joint->PositionKeys.size(); ++j)
+			track.Positions.push_back(joint->PositionKeys[j].position);
+
+		track.ScaleFrames.set(joint->ScaleKeys);
+		track.Scales.reallocate(joint->ScaleKeys.size());
+		for (j=0; j<joint->ScaleKeys.size(); ++j)
+			track.Scales.push_back(joint->ScaleKeys[j].scale);
+
+		track.RotationFrames.set(joint->RotationKeys);
+		track.Rotations.reallocate(joint->RotationKeys.size()*4);
+		for (j=0; j<joint->RotationKeys.size(); ++j)
 		{
-			foundRotationIndex = -1;
+			core::quaternion rotation=joint->RotationKeys[j].rotation;
+			rotation.normalize();
+			track.Rotations.push_back((s16)core::round32(rotation.X*32767.f));
+			track.Rotations.push_back((s16)core::round32(rotation.Y*32767.f));
+			track.Rotations.push_back((s16)core::round32(rotation.Z*32767.f));
+			track.Rotations.push_back((s16)core::round32(rotation.W*32767.f));
+		}
 
-			//Test the Hints...
-			if (rotationHint>=0 && (u32)rotationHint < RotationKeys.size())
-			{
-				//check this hint
-				if (rotationHint>0 && RotationKeys[rotationHint].frame>=frame && RotationKeys[rotationHint-1].frame<frame )
-					foundRotationIndex=rotationHint;
-				else if (rotationHint+1 < (s32)RotationKeys.size())
-				{
-					//check the next index
-					if ( RotationKeys[rotationHint+1].frame>=frame &&
-							RotationKeys[rotationHint+0].frame<frame)
-					{
-						rotationHint++;
-						foundRotationIndex=rotationHint;
-					}
-				}
-			}
+		// only the tracks are kept
+		joint->PositionKeys.clear();
+		joint->ScaleKeys.clear();
+		joint->RotationKeys.clear();
+	}
 
+	JointTracks.set_used(AllJoints.size());
+	for (u32 i=0; i<AllJoints.size(); ++i)
+		JointTracks[i]=&AnimationTracks[i];
+}
 
-			//The hint test failed, do a full scan...
-			if (foundRotationIndex==-1)
-			{
-				for (u32 i=0; i<RotationKeys.size(); ++i)
-				{
-					if (RotationKeys[i].frame >= frame) //Keys should be sorted by frame
-					{
-						foundRotationIndex=i;
-						rotationHint=i;
-						break;
-					}
-				}
-			}
 
-			//Do interpolation...
-			if (foundRotationIndex!=-1)
-			{
-				if (InterpolationMode==EIM_CONSTANT || foundRotationIndex==0)
-				{
-					rotation = RotationKeys[foundRotationIndex].rotation;
-				}
-				else if (InterpolationMode==EIM_LINEAR)
-				{
-					const SRotationKey& KeyA = RotationKeys[foundRotationIndex];
-					const SRotationKey& KeyB = RotationKeys[foundRotationIndex-1];
+//! Fills the empty key arrays with the keys of a track
+void CSkinnedMesh::unpackAnimationTrack(u32 number, core::array<SPositionKey> &positionKeys,
+		core::array<SScaleKey> &scaleKeys, core::array<SRotationKey> &rotationKeys) const
+{
+	if (number >= AnimationTracks.size())
+		return;
 
-					const f32 fd1 = frame - KeyA.frame;
-					const f32 fd2 = KeyB.frame - frame;
-					const f32 t = fd1/(fd1+fd2);
+	const SAnimationTrack& track=AnimationTracks[number];
+	u32 i;
+
+	if (positionKeys.empty())
+	{
+		positionKeys.set_used(track.PositionFrames.Count);
+		for (i=0; i<positionKeys.size(); ++i)
+		{
+			positionKeys[i].frame=track.PositionFrames.getFrame(i);
+			positionKeys[i].position=track.Positions[i];
+		}
+	}
 
-					/*
-					f32 t = 0;
-					if (KeyA.frame!=KeyB.frame)
-						t = (frame-KeyA.frame) / (KeyB.frame - KeyA.frame);
-					*/
+	if (scaleKeys.empty())
+	{
+		scaleKeys.set_used(track.ScaleFrames.Count);
+		for (i=0; i<scaleKeys.size(); ++i)
+		{
+			scaleKeys[i].frame=track.ScaleFrames.getFrame(i);
+			scaleKeys[i].scale=track.Scales[i];
+		}
+	}
 
-					rotation.slerp(KeyA.rotation, KeyB.rotation, t);
-				}
-			}
+	if (rotationKeys.empty())
+	{
+		rotationKeys.set_used(track.RotationFrames.Count);
+		for (i=0; i<rotationKeys.size(); ++i)
+		{
+			rotationKeys[i].frame=track.RotationFrames.getFrame(i);
+			track.getRotation(i, rotationKeys[i].rotation);
+			rotationKeys[i].rotation.normalize();
 		}
 	}
 }
 
+
+//! Gets the animation keys of a joint, also after finalize freed them
+void CSkinnedMesh::getJointKeys(const SJoint *joint, core::array<SPositionKey> &positionKeys,
+		core::array<SScaleKey> &scaleKeys, core::array<SRotationKey> &rotationKeys) const
+{
+	positionKeys=joint->PositionKeys;
+	scaleKeys=joint->ScaleKeys;
+	rotationKeys=joint->RotationKeys;
+
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		if (AllJoints[i]==joint)
+		{
+			unpackAnimationTrack(i, positionKeys, scaleKeys, rotationKeys);
+			break;
+		}
+	}
+}
+
+
 //--------------------------------------------------------------------------
 //				Software Skinning
 //--------------------------------------------------------------------------
@@ -545,73 +591,534 @@ void CSkinnedMesh::skinMesh()
 			}
 		}
 
-		//clear skinning helper array
-		for (i=0; i<Vertices_Moved.size(); ++i)
-			for (u32 j=0; j<Vertices_Moved[i].size(); ++j)
-				Vertices_Moved[i][j]=false;
-
-		//skin starting with the root joints
-		for (i=0; i<RootJoints.size(); ++i)
-			skinJoint(RootJoints[i], 0);
+		//Find each joints pull on vertices...
+		core::array<core::matrix4> skinMatrices;
+		skinMatrices.set_used(AllJoints.size());
+		for (i=0; i<AllJoints.size(); ++i)
+			skinMatrices[i].setbyproduct(AllJoints[i]->GlobalAnimatedMatrix, AllJoints[i]->GlobalInversedMatrix);
 
 		for (i=0; i<SkinningBuffers->size(); ++i)
-			(*SkinningBuffers)[i]->setDirty(EBT_VERTEX);
+			skinBuffer(i, skinMatrices, (*SkinningBuffers)[i]);
 	}
 	updateBoundingBox();
 }
 
 
-void CSkinnedMesh::skinJoint(SJoint *joint, SJoint *parentJoint)
+//! skins bands of the vertices of a skin table into a mesh buffer
+struct CSkinnedMesh::SSkinningJob : public IThreadJob
 {
-	if (joint->Weights.size())
+	virtual void runPart(u32 part, u32 thread) _IRR_OVERRIDE_
 	{
-		//Find this joints pull on vertices...
-		core::matrix4 jointVertexPull(core::matrix4::EM4CONST_NOTHING);
-		jointVertexPull.setbyproduct(joint->GlobalAnimatedMatrix, joint->GlobalInversedMatrix);
-
-		core::vector3df thisVertexMove, thisNormalMove;
+		const u32 start = part * SKINNING_BAND_VERTICES;
+		const u32 end = core::min_(Table->Vertices.size(), start + SKINNING_BAND_VERTICES);
 
-		core::array<scene::SSkinMeshBuffer*> &buffersUsed=*SkinningBuffers;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		if (UseSSE2)
+		{
+			skinVertices_SSE2(start, end, Boxes[part]);
+			return;
+		}
+#endif
+		skinVertices(start, end, Boxes[part]);
+	}
 
-		//Skin Vertices Positions and Normals...
-		for (u32 i=0; i<joint->Weights.size(); ++i)
+	//! blends the matrices of the joints of each vertex and transforms it
+	void skinVertices(u32 start, u32 end, core::aabbox3df& box) const
+	{
+		for (u32 i = start; i < end; ++i)
 		{
-			SWeight& weight = joint->Weights[i];
+			const SSkinVertex& skinVertex = Table->Vertices[i];
+
+			// affine part of the blended matrix, column by column
+			f32 m[16];
+			const f32* pull = SkinMatrices[skinVertex.Joints[0]].pointer();
+			for (u32 c = 0; c < 16; c += 4)
+			{
+				m[c] = pull[c] * skinVertex.Weights[0];
+				m[c+1] = pull[c+1] * skinVertex.Weights[0];
+				m[c+2] = pull[c+2] * skinVertex.Weights[0];
+			}
+			for (u32 k = 1; k < skinVertex.JointCount; ++k)
+			{
+				pull = SkinMatrices[skinVertex.Joints[k]].pointer();
+				for (u32 c = 0; c < 16; c += 4)
+				{
+					m[c] += pull[c] * skinVertex.Weights[k];
+					m[c+1] += pull[c+1] * skinVertex.Weights[k];
+					m[c+2] += pull[c+2] * skinVertex.Weights[k];
+				}
+			}
 
-			// Pull this vertex...
-			jointVertexPull.transformVect(thisVertexMove, weight.StaticPos);
+			video::S3DVertex* vertex = (video::S3DVertex*)(Vertices + skinVertex.Vertex * Pitch);
+			const core::vector3df& p = skinVertex.StaticPos;
+			vertex->Pos.X = m[0] * p.X + m[4] * p.Y + m[8] * p.Z + m[12];
+			vertex->Pos.Y = m[1] * p.X + m[5] * p.Y + m[9] * p.Z + m[13];
+			vertex->Pos.Z = m[2] * p.X + m[6] * p.Y + m[10] * p.Z + m[14];
 
 			if (AnimateNormals)
-				jointVertexPull.rotateVect(thisNormalMove, weight.StaticNormal);
-
-			if (! (*(weight.Moved)) )
 			{
-				*(weight.Moved) = true;
+				const core::vector3df& n = skinVertex.StaticNormal;
+				vertex->Normal.X = m[0] * n.X + m[4] * n.Y + m[8] * n.Z;
+				vertex->Normal.Y = m[1] * n.X + m[5] * n.Y + m[9] * n.Z;
+				vertex->Normal.Z = m[2] * n.X + m[6] * n.Y + m[10] * n.Z;
+			}
 
-				buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Pos = thisVertexMove * weight.strength;
+			if (i == start)
+				box.reset(vertex->Pos);
+			else
+				box.addInternalPoint(vertex->Pos);
+		}
+	}
 
-				if (AnimateNormals)
-					buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Normal = thisNormalMove * weight.strength;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	//! skinVertices() with the columns of the blended matrix in registers
+	void skinVertices_SSE2(u32 start, u32 end, core::aabbox3df& box) const
+	{
+		__m128 minEdge = _mm_set1_ps(FLT_MAX);
+		__m128 maxEdge = _mm_set1_ps(-FLT_MAX);
 
-				//*(weight._Pos) = thisVertexMove * weight.strength;
+		for (u32 i = start; i < end; ++i)
+		{
+			const SSkinVertex& skinVertex = Table->Vertices[i];
+
+			const f32* pull = SkinMatrices[skinVertex.Joints[0]].pointer();
+			__m128 weight = _mm_set1_ps(skinVertex.Weights[0]);
+			__m128 c0 = _mm_mul_ps(_mm_loadu_ps(pull), weight);
+			__m128 c1 = _mm_mul_ps(_mm_loadu_ps(pull + 4), weight);
+			__m128 c2 = _mm_mul_ps(_mm_loadu_ps(pull + 8), weight);
+			__m128 c3 = _mm_mul_ps(_mm_loadu_ps(pull + 12), weight);
+			for (u32 k = 1; k < skinVertex.JointCount; ++k)
+			{
+				pull = SkinMatrices[skinVertex.Joints[k]].pointer();
+				weight = _mm_set1_ps(skinVertex.Weights[k]);
+				c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(pull), weight));
+				c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(pull + 4), weight));
+				c2 = _mm_add_ps(c2, _mm_mul_ps(_mm_loadu_ps(pull + 8), weight));
+				c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(pull + 12), weight));
 			}
-			else
+
+			video::S3DVertex* vertex = (video::S3DVertex*)(Vertices + skinVertex.Vertex * Pitch);
+			const core::vector3df& p = skinVertex.StaticPos;
+			__m128 pos = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p.X)), _mm_mul_ps(c1, _mm_set1_ps(p.Y)));
+			pos = _mm_add_ps(_mm_add_ps(pos, _mm_mul_ps(c2, _mm_set1_ps(p.Z))), c3);
+			_mm_storel_pi((__m64*)&vertex->Pos.X, pos);
+			_mm_store_ss(&vertex->Pos.Z, _mm_movehl_ps(pos, pos));
+
+			if (AnimateNormals)
 			{
-				buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Pos += thisVertexMove * weight.strength;
+				const core::vector3df& n = skinVertex.StaticNormal;
+				__m128 normal = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(n.X)), _mm_mul_ps(c1, _mm_set1_ps(n.Y)));
+				normal = _mm_add_ps(normal, _mm_mul_ps(c2, _mm_set1_ps(n.Z)));
+				_mm_storel_pi((__m64*)&vertex->Normal.X, normal);
+				_mm_store_ss(&vertex->Normal.Z, _mm_movehl_ps(normal, normal));
+			}
+
+			minEdge = _mm_min_ps(minEdge, pos);
+			maxEdge = _mm_max_ps(maxEdge, pos);
+		}
+
+		f32 edges[8];
+		_mm_storeu_ps(edges, minEdge);
+		_mm_storeu_ps(edges + 4, maxEdge);
+		box.MinEdge.set(edges[0], edges[1], edges[2]);
+		box.MaxEdge.set(edges[4], edges[5], edges[6]);
+	}
+#endif
+
+	const SSkinTable* Table;
+	const core::matrix4* SkinMatrices;
+	u8* Vertices;
+	u32 Pitch;
+
+	// bounding box of the vertices of each part
+	core::array<core::aabbox3df> Boxes;
+
+	bool AnimateNormals;
+	bool UseSSE2;
+};
+
+
+//! Skins the vertices of a mesh buffer and sets its bounding box
+void CSkinnedMesh::skinBuffer(u32 number, const core::array<core::matrix4> &skinMatrices,
+		SSkinMeshBuffer *buffer) const
+{
+	if (number >= SkinTables.size() || SkinTables[number].Vertices.empty())
+		return;
+
+	SSkinningJob job;
+	job.Table = &SkinTables[number];
+	job.SkinMatrices = skinMatrices.const_pointer();
+	job.Vertices = (u8*)buffer->getVertices();
+	job.Pitch = video::getVertexPitchFromType(buffer->getVertexType());
+	job.AnimateNormals = AnimateNormals;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	job.UseSSE2 = os::Cpu::hasSSE2();
+#else
+	job.UseSSE2 = false;
+#endif
+
+	const u32 parts = (job.Table->Vertices.size() + SKINNING_BAND_VERTICES - 1) / SKINNING_BAND_VERTICES;
+	job.Boxes.set_used(parts);
+	CThreadPool::runShared(&job, parts);
+
+	// once for all vertices, instead of for every weight
+	core::aabbox3df box = job.Boxes[0];
+	for (u32 i=1; i<parts; ++i)
+		box.addInternalBox(job.Boxes[i]);
+	if (job.Table->HasStaticVertices)
+		box.addInternalBox(job.Table->StaticBox);
+
+	buffer->BoundingBox = box;
+	buffer->BoundingBoxNeedsRecalculated = false;
+	buffer->setDirty(EBT_VERTEX);
+}
+
+
+//--------------------------------------------------------------------------
+//				Instance Poses
+//--------------------------------------------------------------------------
+
+//! Returns the pose at a frame, shared by all callers asking for the same frame
+SSkinnedMeshPose* CSkinnedMesh::getPose(f32 frame, SSkinnedMeshPose* pose)
+{
+	// the own pose is not changed by others, whether shared or not
+	if (pose && pose->Frame==frame && pose->Version==PoseVersion)
+		return pose;
+
+	// instances of the mesh may be animated on several threads, the lock is
+	// only held for the cache, not for animating and skinning
+	PoseLock.lock();
+
+	for (u32 i=0; i<PoseCache.size(); ++i)
+	{
+		if (PoseCache[i]->Frame==frame)
+		{
+			SSkinnedMeshPose* cached=PoseCache[i];
+			cached->LastUsed=++PoseCacheTime;
+			cached->grab();
+			if (pose)
+				pose->drop();
+
+			// another thread is skinning this frame, wait for it instead
+			// of skinning it too
+			while (cached->InProgress)
+				PoseDone.wait(PoseLock);
+
+			PoseLock.unlock();
+			return cached;
+		}
+	}
+
+	pose=takeUniquePose(pose);
+
+	// put it into the cache before animating, so the other instances at
+	// this frame find it and wait for it
+	pose->Frame=frame;
+	pose->InProgress=true;
+	pose->LastUsed=++PoseCacheTime;
+	pose->grab();
+	if (PoseCache.size() < MAX_CACHED_POSES)
+		PoseCache.push_back(pose);
+	else
+	{
+		u32 oldest=0;
+		for (u32 i=1; i<PoseCache.size(); ++i)
+		{
+			if (PoseCache[i]->LastUsed < PoseCache[oldest]->LastUsed)
+				oldest=i;
+		}
+		PoseCache[oldest]->drop();
+		PoseCache[oldest]=pose;
+	}
+
+	PoseLock.unlock();
+
+	animatePose(*pose, frame, 1.0f);
+	skinPose(*pose);
+
+	PoseLock.lock();
+	pose->InProgress=false;
+	PoseDone.notifyAll();
+	PoseLock.unlock();
+
+	return pose;
+}
+
+
+//! Returns a pose nobody else uses, which may be changed freely
+SSkinnedMeshPose* CSkinnedMesh::getUniquePose(SSkinnedMeshPose* pose)
+{
+	CMutexLock lock(PoseLock);
+	return takeUniquePose(pose);
+}
 
-				if (AnimateNormals)
-					buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Normal += thisNormalMove * weight.strength;
 
-				//*(weight._Pos) += thisVertexMove * weight.strength;
+//! getUniquePose(), called with the PoseLock held
+SSkinnedMeshPose* CSkinnedMesh::takeUniquePose(SSkinnedMeshPose* pose)
+{
+	if (pose && pose->Version==PoseVersion)
+	{
+		const s32 cached=PoseCache.linear_search(pose);
+		if (pose->getReferenceCount() == (cached<0 ? 1 : 2))
+		{
+			if (cached>=0)
+			{
+				PoseCache.erase(cached);
+				pose->drop();
 			}
+			return pose;
+		}
+	}
+
+	if (pose)
+		pose->drop();
+
+	// reuse a cached pose which no instance is at anymore
+	s32 unused=-1;
+	for (u32 i=0; i<PoseCache.size(); ++i)
+	{
+		if (PoseCache[i]->getReferenceCount()==1 &&
+			(unused<0 || PoseCache[i]->LastUsed < PoseCache[unused]->LastUsed))
+			unused=i;
+	}
+	if (unused>=0)
+	{
+		pose=PoseCache[unused];
+		PoseCache.erase(unused);
+		return pose;
+	}
+
+	return createPose();
+}
+
+
+SSkinnedMeshPose* CSkinnedMesh::createPose() const
+{
+	SSkinnedMeshPose* pose=new SSkinnedMeshPose();
+	pose->Version=PoseVersion;
+
+	pose->Joints.set_used(AllJoints.size());
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		const SJoint *joint=AllJoints[i];
+		SSkinnedMeshPose::SJointPose& jointPose=pose->Joints[i];
+
+		jointPose.Position=joint->Animatedposition;
+		jointPose.Scale=joint->Animatedscale;
+		jointPose.Rotation=joint->Animatedrotation;
+		jointPose.PositionHint=-1;
+		jointPose.ScaleHint=-1;
+		jointPose.RotationHint=-1;
+		jointPose.LocalMatrix=joint->LocalMatrix;
+		jointPose.GlobalMatrix=joint->GlobalMatrix;
+		jointPose.GlobalSkinningSpace=joint->GlobalSkinningSpace;
+	}
+
+	pose->MeshBuffers.reallocate(LocalBuffers.size());
+	for (u32 i=0; i<LocalBuffers.size(); ++i)
+	{
+		const SSkinMeshBuffer* meshBuffer=LocalBuffers[i];
+		SSkinMeshBuffer* buffer=new SSkinMeshBuffer(meshBuffer->VertexType);
+
+		buffer->Vertices_Tangents=meshBuffer->Vertices_Tangents;
+		buffer->Vertices_2TCoords=meshBuffer->Vertices_2TCoords;
+		buffer->Vertices_Standard=meshBuffer->Vertices_Standard;
+		buffer->Indices=meshBuffer->Indices;
+		buffer->Transformation=meshBuffer->Transformation;
+		buffer->Material=meshBuffer->Material;
+		buffer->BoundingBox=meshBuffer->BoundingBox;
+		buffer->PrimitiveType=meshBuffer->PrimitiveType;
+		buffer->setHardwareMappingHint(meshBuffer->getHardwareMappingHint_Vertex(), EBT_VERTEX);
+		buffer->setHardwareMappingHint(meshBuffer->getHardwareMappingHint_Index(), EBT_INDEX);
+
+		pose->MeshBuffers.push_back(buffer);
+	}
+	pose->BoundingBox=BoundingBox;
+
+	return pose;
+}
+
+
+//! Drops the cached poses and makes instances create new ones, after the mesh was changed
+void CSkinnedMesh::invalidatePoses()
+{
+	CMutexLock lock(PoseLock);
+
+	for (u32 i=0; i<PoseCache.size(); ++i)
+		PoseCache[i]->drop();
+	PoseCache.clear();
+
+	++PoseVersion;
+}
+
+
+//! Animates the joints of a pose based on frame input
+//! blend: {0-old position, 1-New position}
+void CSkinnedMesh::animatePose(SSkinnedMeshPose& pose, f32 frame, f32 blend) const
+{
+	pose.Frame=frame;
 
-			buffersUsed[weight.buffer_id]->boundingBoxNeedsRecalculated();
+	if (!HasAnimation || blend<=0.f)
+		return;
+
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		const SJoint *joint = AllJoints[i];
+		SSkinnedMeshPose::SJointPose& jointPose=pose.Joints[i];
+
+		core::vector3df position = jointPose.Position;
+		core::vector3df scale = jointPose.Scale;
+		core::quaternion rotation = jointPose.Rotation;
+
+		getFrameData(frame, JointTracks[i],
+				position, jointPose.PositionHint,
+				scale, jointPose.ScaleHint,
+				rotation, jointPose.RotationHint);
+
+		if (blend==1.0f)
+		{
+			//No blending needed
+			jointPose.Position = position;
+			jointPose.Scale = scale;
+			jointPose.Rotation = rotation;
 		}
+		else
+		{
+			//Blend animation
+			jointPose.Position = core::lerp(jointPose.Position, position, blend);
+			jointPose.Scale = core::lerp(jointPose.Scale, scale, blend);
+			jointPose.Rotation.slerp(jointPose.Rotation, rotation, blend);
+		}
+
+		buildLocalAnimatedMatrix(joint, JointTracks[i], jointPose.Position,
+				jointPose.Rotation, jointPose.Scale,
+				jointPose.LocalMatrix, jointPose.GlobalSkinningSpace);
+	}
+}
+
+
+//! Preforms a software skin of the mesh buffers of a pose based on its joints
+void CSkinnedMesh::skinPose(SSkinnedMeshPose& pose) const
+{
+	if (!HasAnimation)
+		return;
+
+	core::array<SSkinnedMeshPose::SJointPose>& joints=pose.Joints;
+	u32 i;
+
+	// Find global matrices, parents come first
+	for (i=0; i<JointOrder.size(); ++i)
+	{
+		const u32 number=JointOrder[i];
+		const s32 parent=JointParents[number];
+		if (parent<0 || joints[number].GlobalSkinningSpace)
+			joints[number].GlobalMatrix = joints[number].LocalMatrix;
+		else
+			joints[number].GlobalMatrix = joints[parent].GlobalMatrix * joints[number].LocalMatrix;
 	}
 
-	//Skin all children
+	if (!HardwareSkinning)
+	{
+		//rigid animation
+		for (i=0; i<AllJoints.size(); ++i)
+		{
+			for (u32 j=0; j<AllJoints[i]->AttachedMeshes.size(); ++j)
+			{
+				SSkinMeshBuffer* buffer=static_cast<SSkinMeshBuffer*>(pose.MeshBuffers[AllJoints[i]->AttachedMeshes[j]]);
+				buffer->Transformation=joints[i].GlobalMatrix;
+			}
+		}
+
+		//Find each joints pull on vertices...
+		core::array<core::matrix4> skinMatrices;
+		skinMatrices.set_used(AllJoints.size());
+		for (i=0; i<AllJoints.size(); ++i)
+			skinMatrices[i].setbyproduct(joints[i].GlobalMatrix, AllJoints[i]->GlobalInversedMatrix);
+
+		for (i=0; i<pose.MeshBuffers.size(); ++i)
+			skinBuffer(i, skinMatrices, static_cast<SSkinMeshBuffer*>(pose.MeshBuffers[i]));
+	}
+
+	//update the buffers and the bounding box
+	pose.BoundingBox.reset(0,0,0);
+	for (i=0; i<pose.MeshBuffers.size(); ++i)
+	{
+		SSkinMeshBuffer* buffer=static_cast<SSkinMeshBuffer*>(pose.MeshBuffers[i]);
+		buffer->Material=LocalBuffers[i]->Material;
+		buffer->recalculateBoundingBox();
+		core::aabbox3df bb = buffer->BoundingBox;
+		buffer->Transformation.transformBoxEx(bb);
+
+		pose.BoundingBox.addInternalBox(bb);
+	}
+}
+
+
+//! Recovers the joints from a pose
+void CSkinnedMesh::recoverJointsFromPose(const SSkinnedMeshPose& pose,
+		core::array<IBoneSceneNode*> &jointChildSceneNodes) const
+{
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		IBoneSceneNode* node=jointChildSceneNodes[i];
+		const SSkinnedMeshPose::SJointPose& jointPose=pose.Joints[i];
+		node->setPosition(jointPose.LocalMatrix.getTranslation());
+		node->setRotation(jointPose.LocalMatrix.getRotationDegrees());
+		node->setScale(jointPose.LocalMatrix.getScale());
+
+		node->positionHint=jointPose.PositionHint;
+		node->scaleHint=jointPose.ScaleHint;
+		node->rotationHint=jointPose.RotationHint;
+
+		node->updateAbsolutePosition();
+	}
+}
+
+
+//! Tranfers the joint data to a pose
+void CSkinnedMesh::transferJointsToPose(SSkinnedMeshPose& pose,
+		const core::array<IBoneSceneNode*> &jointChildSceneNodes) const
+{
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		const IBoneSceneNode* const node=jointChildSceneNodes[i];
+		SSkinnedMeshPose::SJointPose& jointPose=pose.Joints[i];
+
+		jointPose.LocalMatrix.setRotationDegrees(node->getRotation());
+		jointPose.LocalMatrix.setTranslation(node->getPosition());
+		jointPose.LocalMatrix *= core::matrix4().setScale(node->getScale());
+
+		jointPose.PositionHint=node->positionHint;
+		jointPose.ScaleHint=node->scaleHint;
+		jointPose.RotationHint=node->rotationHint;
+
+		jointPose.GlobalSkinningSpace=(node->getSkinningSpace()==EBSS_GLOBAL);
+	}
+	// no longer the pose of a frame
+	pose.Frame=-1.f;
+}
+
+
+//! Gets the number of the parent of a joint, -1 for root joints
+s32 CSkinnedMesh::getJointParent(u32 number) const
+{
+	if (number >= JointParents.size())
+		return -1;
+	return JointParents[number];
+}
+
+
+void CSkinnedMesh::buildJointOrder(SJoint *joint, s32 parent)
+{
+	const s32 number=AllJoints.linear_search(joint);
+	if (number<0)
+		return;
+
+	JointParents[number]=parent;
+	JointOrder.push_back(number);
+
 	for (u32 j=0; j<joint->Children.size(); ++j)
-		skinJoint(joint->Children[j], joint);
+		buildJointOrder(joint->Children[j], number);
 }
 
 
@@ -698,6 +1205,7 @@ void CSkinnedMesh::setMaterialFlag(video::E_MATERIAL_FLAG flag, bool newvalue)
 {
 	for (u32 i=0; i<LocalBuffers.size(); ++i)
 		LocalBuffers[i]->Material.setFlag(flag,newvalue);
+	invalidatePoses();
 }
 
 
@@ -707,6 +1215,7 @@ void CSkinnedMesh::setHardwareMappingHint(E_HARDWARE_MAPPING newMappingHint,
 {
 	for (u32 i=0; i<LocalBuffers.size(); ++i)
 		LocalBuffers[i]->setHardwareMappingHint(newMappingHint, buffer);
+	invalidatePoses();
 }
 
 
@@ -715,6 +1224,7 @@ void CSkinnedMesh::setDirty(E_BUFFER_TYPE buffer)
 {
 	for (u32 i=0; i<LocalBuffers.size(); ++i)
 		LocalBuffers[i]->setDirty(buffer);
+	invalidatePoses();
 }
 
 
@@ -723,29 +1233,45 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 {
 	bool unmatched=false;
 
+	// the tracks are copied, the other mesh may be dropped or finalized again
+	const core::array<SAnimationTrack>& otherTracks=static_cast<const CSkinnedMesh*>(mesh)->AnimationTracks;
+	OtherTracks.clear();
+	OtherTracks.reallocate(AllJoints.size());
+	JointTracks.set_used(AllJoints.size());
+
 	for(u32 i=0;i<AllJoints.size();++i)
 	{
 		SJoint *joint=AllJoints[i];
 		joint->UseAnimationFrom=0;
+		JointTracks[i]=0;
 
 		if (joint->Name=="")
 			unmatched=true;
 		else
 		{
+			u32 other=0;
 			for(u32 j=0;j<mesh->getAllJoints().size();++j)
 			{
 				SJoint *otherJoint=mesh->getAllJoints()[j];
 				if (joint->Name==otherJoint->Name)
 				{
 					joint->UseAnimationFrom=otherJoint;
+					other=j;
 				}
 			}
 			if (!joint->UseAnimationFrom)
 				unmatched=true;
+			else if (other<otherTracks.size())
+			{
+				// at most one track per joint, so the array is never reallocated
+				OtherTracks.push_back(otherTracks[other]);
+				JointTracks[i]=&OtherTracks.getLast();
+			}
 		}
 	}
 
 	checkForAnimation();
+	invalidatePoses();
 
 	return !unmatched;
 }
@@ -757,6 +1283,7 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 void CSkinnedMesh::updateNormalsWhenAnimating(bool on)
 {
 	AnimateNormals = on;
+	invalidatePoses();
 }
 
 
@@ -764,6 +1291,7 @@ void CSkinnedMesh::updateNormalsWhenAnimating(bool on)
 void CSkinnedMesh::setInterpolationMode(E_INTERPOLATION_MODE mode)
 {
 	InterpolationMode = mode;
+	invalidatePoses();
 }
 
 
@@ -794,21 +1322,21 @@ bool CSkinnedMesh::setHardwareSkinning(bool on)
 		{
 
 			//set mesh to static pose...
-			for (u32 i=0; i<AllJoints.size(); ++i)
+			for (u32 i=0; i<SkinTables.size(); ++i)
 			{
-				SJoint *joint=AllJoints[i];
-				for (u32 j=0; j<joint->Weights.size(); ++j)
+				const SSkinTable& table=SkinTables[i];
+				for (u32 j=0; j<table.Vertices.size(); ++j)
 				{
-					const u16 buffer_id=joint->Weights[j].buffer_id;
-					const u32 vertex_id=joint->Weights[j].vertex_id;
-					LocalBuffers[buffer_id]->getVertex(vertex_id)->Pos = joint->Weights[j].StaticPos;
-					LocalBuffers[buffer_id]->getVertex(vertex_id)->Normal = joint->Weights[j].StaticNormal;
-					LocalBuffers[buffer_id]->boundingBoxNeedsRecalculated();
+					const SSkinVertex& vertex=table.Vertices[j];
+					LocalBuffers[i]->getVertex(vertex.Vertex)->Pos = vertex.StaticPos;
+					LocalBuffers[i]->getVertex(vertex.Vertex)->Normal = vertex.StaticNormal;
 				}
+				LocalBuffers[i]->boundingBoxNeedsRecalculated();
 			}
 		}
 
 		HardwareSkinning=on;
+		invalidatePoses();
 	}
 	return HardwareSkinning;
 }
@@ -852,17 +1380,10 @@ void CSkinnedMesh::checkForAnimation()
 	u32 i,j;
 	//Check for animation...
 	HasAnimation = false;
-	for(i=0;i<AllJoints.size();++i)
+	for(i=0;i<JointTracks.size();++i)
 	{
-		if (AllJoints[i]->UseAnimationFrom)
-		{
-			if (AllJoints[i]->UseAnimationFrom->PositionKeys.size() ||
-				AllJoints[i]->UseAnimationFrom->ScaleKeys.size() ||
-				AllJoints[i]->UseAnimationFrom->RotationKeys.size() )
-			{
-				HasAnimation = true;
-			}
-		}
+		if (JointTracks[i] && JointTracks[i]->hasKeys())
+			HasAnimation = true;
 	}
 
 	//meshes with weights, are still counted as animated for ragdolls, etc
@@ -879,22 +1400,10 @@ void CSkinnedMesh::checkForAnimation()
 	{
 		//--- Find the length of the animation ---
 		EndFrame=0;
-		for(i=0;i<AllJoints.size();++i)
+		for(i=0;i<JointTracks.size();++i)
 		{
-			if (AllJoints[i]->UseAnimationFrom)
-			{
-				if (AllJoints[i]->UseAnimationFrom->PositionKeys.size())
-					if (AllJoints[i]->UseAnimationFrom->PositionKeys.getLast().frame > EndFrame)
-						EndFrame=AllJoints[i]->UseAnimationFrom->PositionKeys.getLast().frame;
-
-				if (AllJoints[i]->UseAnimationFrom->ScaleKeys.size())
-					if (AllJoints[i]->UseAnimationFrom->ScaleKeys.getLast().frame > EndFrame)
-						EndFrame=AllJoints[i]->UseAnimationFrom->ScaleKeys.getLast().frame;
-
-				if (AllJoints[i]->UseAnimationFrom->RotationKeys.size())
-					if (AllJoints[i]->UseAnimationFrom->RotationKeys.getLast().frame > EndFrame)
-						EndFrame=AllJoints[i]->UseAnimationFrom->RotationKeys.getLast().frame;
-			}
+			if (JointTracks[i])
+				EndFrame=core::max_(EndFrame, JointTracks[i]->getEndFrame());
 		}
 	}
 
@@ -925,32 +1434,11 @@ void CSkinnedMesh::checkForAnimation()
 			}
 		}
 
-		//An array used in skinning
-
-		for (i=0; i<Vertices_Moved.size(); ++i)
-			for (j=0; j<Vertices_Moved[i].size(); ++j)
-				Vertices_Moved[i][j] = false;
-
-		// For skinning: cache weight values for speed
-
-		for (i=0; i<AllJoints.size(); ++i)
-		{
-			SJoint *joint = AllJoints[i];
-			for (j=0; j<joint->Weights.size(); ++j)
-			{
-				const u16 buffer_id=joint->Weights[j].buffer_id;
-				const u32 vertex_id=joint->Weights[j].vertex_id;
-
-				joint->Weights[j].Moved = &Vertices_Moved[buffer_id] [vertex_id];
-				joint->Weights[j].StaticPos = LocalBuffers[buffer_id]->getVertex(vertex_id)->Pos;
-				joint->Weights[j].StaticNormal = LocalBuffers[buffer_id]->getVertex(vertex_id)->Normal;
-
-				//joint->Weights[j]._Pos=&Buffers[buffer_id]->getVertex(vertex_id)->Pos;
-			}
-		}
-
 		// normalize weights
 		normalizeWeights();
+
+		// per vertex joints for skinning
+		buildSkinTables();
 	}
 	SkinnedLastFrame=false;
 }
@@ -964,6 +1452,14 @@ void CSkinnedMesh::finalize()
 	// Make sure we recalc the next frame
 	LastAnimatedFrame=-1;
 	SkinnedLastFrame=false;
+	invalidatePoses();
+
+	// keys packed by an earlier call are packed again with the new ones
+	for (i=0; i<AllJoints.size(); ++i)
+	{
+		SJoint *joint=AllJoints[i];
+		unpackAnimationTrack(i, joint->PositionKeys, joint->ScaleKeys, joint->RotationKeys);
+	}
 
 	//calculate bounding box
 	for (i=0; i<LocalBuffers.size(); ++i)
@@ -1005,17 +1501,30 @@ void CSkinnedMesh::finalize()
 		AllJoints[i]->UseAnimationFrom=AllJoints[i];
 	}
 
-	//Set array sizes...
-
-	for (i=0; i<LocalBuffers.size(); ++i)
+	//Joint hierarchy for skinning poses
+	JointParents.set_used(AllJoints.size());
+	for(i=0; i < JointParents.size(); ++i)
+		JointParents[i]=-1;
+	JointOrder.clear();
+	for(i=0; i < RootJoints.size(); ++i)
+		buildJointOrder(RootJoints[i], -1);
+
+	// the keys are padded to the end of the whole animation
+	bool hasKeys=false;
+	EndFrame=0;
+	for(i=0;i<AllJoints.size();++i)
 	{
-		Vertices_Moved.push_back( core::array<bool>() );
-		Vertices_Moved[i].set_used(LocalBuffers[i]->getVertexCount());
+		const SJoint *joint=AllJoints[i];
+		if (joint->PositionKeys.size())
+			EndFrame=core::max_(EndFrame, joint->PositionKeys.getLast().frame);
+		if (joint->ScaleKeys.size())
+			EndFrame=core::max_(EndFrame, joint->ScaleKeys.getLast().frame);
+		if (joint->RotationKeys.size())
+			EndFrame=core::max_(EndFrame, joint->RotationKeys.getLast().frame);
+		hasKeys |= (joint->PositionKeys.size() || joint->ScaleKeys.size() || joint->RotationKeys.size());
 	}
 
-	checkForAnimation();
-
-	if (HasAnimation)
+	if (hasKeys)
 	{
 		irr::u32 redundantPosKeys = 0;
 		irr::u32 unorderedPosKeys = 0;
@@ -1128,6 +1637,11 @@ void CSkinnedMesh::finalize()
 		}
 	}
 
+	//The keys are sampled from compact tracks
+	buildAnimationTracks();
+
+	checkForAnimation();
+
 	//Needed for animation and skinning...
 
 	calculateGlobalMatrices(0,0);
@@ -1311,60 +1825,94 @@ void CSkinnedMesh::normalizeWeights()
 }
 
 
-void CSkinnedMesh::recoverJointsFromMesh(core::array<IBoneSceneNode*> &jointChildSceneNodes)
+//! Builds the skinned vertices of each buffer from the weights of the joints
+void CSkinnedMesh::buildSkinTables()
 {
-	for (u32 i=0; i<AllJoints.size(); ++i)
-	{
-		IBoneSceneNode* node=jointChildSceneNodes[i];
-		SJoint *joint=AllJoints[i];
-		node->setPosition(joint->LocalAnimatedMatrix.getTranslation());
-		node->setRotation(joint->LocalAnimatedMatrix.getRotationDegrees());
-		node->setScale(joint->LocalAnimatedMatrix.getScale());
-
-		node->positionHint=joint->positionHint;
-		node->scaleHint=joint->scaleHint;
-		node->rotationHint=joint->rotationHint;
+	u32 i,j;
 
-		node->updateAbsolutePosition();
+	// the joints of each vertex, strongest first
+	core::array< core::array<SSkinVertex> > vertices;
+	vertices.reallocate(LocalBuffers.size());
+	for (i=0; i<LocalBuffers.size(); ++i)
+	{
+		vertices.push_back(core::array<SSkinVertex>());
+		vertices[i].set_used(LocalBuffers[i]->getVertexCount());
+		for (j=0; j<vertices[i].size(); ++j)
+			vertices[i][j].JointCount=0;
 	}
-}
-
 
-void CSkinnedMesh::transferJointsToMesh(const core::array<IBoneSceneNode*> &jointChildSceneNodes)
-{
-	for (u32 i=0; i<AllJoints.size(); ++i)
+	bool dropped=false;
+	for (i=0; i<AllJoints.size(); ++i)
 	{
-		const IBoneSceneNode* const node=jointChildSceneNodes[i];
-		SJoint *joint=AllJoints[i];
-
-		joint->LocalAnimatedMatrix.setRotationDegrees(node->getRotation());
-		joint->LocalAnimatedMatrix.setTranslation(node->getPosition());
-		joint->LocalAnimatedMatrix *= core::matrix4().setScale(node->getScale());
+		const SJoint *joint=AllJoints[i];
+		for (j=0; j<joint->Weights.size(); ++j)
+		{
+			const SWeight& weight=joint->Weights[j];
+			SSkinVertex& vertex=vertices[weight.buffer_id][weight.vertex_id];
 
-		joint->positionHint=node->positionHint;
-		joint->scaleHint=node->scaleHint;
-		joint->rotationHint=node->rotationHint;
+			u32 k=vertex.JointCount;
+			if (k==4)
+			{
+				dropped=true;
+				if (weight.strength<=vertex.Weights[3])
+					continue;
+				k=3;
+			}
+			else
+				++vertex.JointCount;
 
-		joint->GlobalSkinningSpace=(node->getSkinningSpace()==EBSS_GLOBAL);
+			for (; k>0 && vertex.Weights[k-1]<weight.strength; --k)
+			{
+				vertex.Joints[k]=vertex.Joints[k-1];
+				vertex.Weights[k]=vertex.Weights[k-1];
+			}
+			vertex.Joints[k]=(u16)i;
+			vertex.Weights[k]=weight.strength;
+		}
 	}
-	// Make sure we recalc the next frame
-	LastAnimatedFrame=-1;
-	SkinnedLastFrame=false;
-}
 
+	if (dropped)
+		os::Printer::log("Skinned Mesh: Vertices pulled by more than 4 joints only keep the 4 strongest ones", ELL_INFORMATION);
 
-void CSkinnedMesh::transferOnlyJointsHintsToMesh(const core::array<IBoneSceneNode*> &jointChildSceneNodes)
-{
-	for (u32 i=0; i<AllJoints.size(); ++i)
+	SkinTables.clear();
+	SkinTables.reallocate(LocalBuffers.size());
+	for (i=0; i<LocalBuffers.size(); ++i)
 	{
-		const IBoneSceneNode* const node=jointChildSceneNodes[i];
-		SJoint *joint=AllJoints[i];
+		SkinTables.push_back(SSkinTable());
+		SSkinTable& table=SkinTables.getLast();
+
+		for (j=0; j<vertices[i].size(); ++j)
+		{
+			SSkinVertex& vertex=vertices[i][j];
+			const video::S3DVertex* staticVertex=LocalBuffers[i]->getVertex(j);
+
+			if (!vertex.JointCount)
+			{
+				if (table.HasStaticVertices)
+					table.StaticBox.addInternalPoint(staticVertex->Pos);
+				else
+					table.StaticBox.reset(staticVertex->Pos);
+				table.HasStaticVertices=true;
+				continue;
+			}
 
-		joint->positionHint=node->positionHint;
-		joint->scaleHint=node->scaleHint;
-		joint->rotationHint=node->rotationHint;
+			// dropped joints leave weights which do not add up to 1
+			f32 total=0.f;
+			u32 k;
+			for (k=0; k<vertex.JointCount; ++k)
+				total+=vertex.Weights[k];
+			if (total!=0.f && !core::equals(total, 1.f))
+			{
+				for (k=0; k<vertex.JointCount; ++k)
+					vertex.Weights[k]/=total;
+			}
+
+			vertex.Vertex=j;
+			vertex.StaticPos=staticVertex->Pos;
+			vertex.StaticNormal=staticVertex->Normal;
+			table.Vertices.push_back(vertex);
+		}
 	}
-	SkinnedLastFrame=false;
 }
 
 
@@ -1414,6 +1962,8 @@ void CSkinnedMesh::addJoints(core::array<IBoneSceneNode*> &jointChildSceneNodes,
 
 void CSkinnedMesh::convertMeshToTangents()
 {
+	invalidatePoses();
+
 	// now calculate tangents
 	for (u32 b=0; b < LocalBuffers.size(); ++b)
 	{
@@ -9,10 +9,12 @@
 
 #include "ISkinnedMesh.h"
 #include "SMeshBuffer.h"
+#include "SMesh.h"
 #include "S3DVertex.h"
 #include "irrString.h"
 #include "matrix4.h"
 #include "quaternion.h"
+#include "CMutex.h"
 
 namespace irr
 {
@@ -22,6 +24,53 @@ namespace scene
 	class IAnimatedMeshSceneNode;
 	class IBoneSceneNode;
 
+	//! Animated joints and skinned mesh buffers of one instance of a skinned mesh
+	/** Scene nodes sharing a skinned mesh animate and skin into a pose of
+	their own, so the mesh buffers of the shared mesh are never written to.
+	The mesh buffers of the pose are SSkinMeshBuffer copies of the mesh
+	buffers of the skinned mesh. */
+	struct SSkinnedMeshPose : public SMesh
+	{
+		SSkinnedMeshPose() : Frame(-1.f), Version(0), LastUsed(0), InProgress(false)
+		{
+			#ifdef _DEBUG
+			setDebugName("SSkinnedMeshPose");
+			#endif
+		}
+
+		//! Animated state of a joint
+		struct SJointPose
+		{
+			core::vector3df Position;
+			core::vector3df Scale;
+			core::quaternion Rotation;
+
+			s32 PositionHint;
+			s32 ScaleHint;
+			s32 RotationHint;
+
+			core::matrix4 LocalMatrix;
+			core::matrix4 GlobalMatrix;
+
+			bool GlobalSkinningSpace;
+		};
+
+		//! Joints in the order of the joints of the skinned mesh
+		core::array<SJointPose> Joints;
+
+		//! Frame the pose was animated to, -1 if it was set from joint nodes
+		f32 Frame;
+
+		//! Version of the skinned mesh the pose was created from
+		u32 Version;
+
+		//! Pose cache time of the last use
+		u32 LastUsed;
+
+		//! The pose is in the cache but still animated and skinned
+		bool InProgress;
+	};
+
 	class CSkinnedMesh: public ISkinnedMesh
 	{
 	public:
@@ -128,6 +177,10 @@ namespace scene
 		//! loaders should call this after populating the mesh
 		virtual void finalize() _IRR_OVERRIDE_;
 
+		//! Gets the animation keys of a joint, also after finalize freed them
+		virtual void getJointKeys(const SJoint *joint, core::array<SPositionKey> &positionKeys,
+				core::array<SScaleKey> &scaleKeys, core::array<SRotationKey> &rotationKeys) const _IRR_OVERRIDE_;
+
 		//! Adds a new meshbuffer to the mesh, access it as last one
 		virtual SSkinMeshBuffer *addMeshBuffer() _IRR_OVERRIDE_;
 
@@ -146,14 +199,40 @@ namespace scene
 
 		virtual void updateBoundingBox(void);
 
-		//! Recovers the joints from the mesh
-		void recoverJointsFromMesh(core::array<IBoneSceneNode*> &jointChildSceneNodes);
+		//! Returns the pose at a frame, shared by all callers asking for the same frame
+		/** Poses are animated with full blend. The last poses are kept in a
+		small cache, so instances at the same frame are animated and skinned
+		only once. Several threads may get poses of the same mesh at once.
+		\param frame Frame to animate to.
+		\param pose The pose the caller got the last time or 0. It is
+		animated again if nobody else uses it and dropped otherwise.
+		\return Pose at the frame, drop it when done. */
+		SSkinnedMeshPose* getPose(f32 frame, SSkinnedMeshPose* pose);
+
+		//! Returns a pose nobody else uses, which may be changed freely
+		/** Several threads may get poses of the same mesh at once.
+		\param pose The pose the caller got the last time or 0. It is
+		returned if nobody else uses it and dropped otherwise.
+		\return Pose which is not shared, drop it when done. */
+		SSkinnedMeshPose* getUniquePose(SSkinnedMeshPose* pose);
+
+		//! Animates the joints of a pose based on frame input
+		//! blend: {0-old position, 1-New position}
+		void animatePose(SSkinnedMeshPose& pose, f32 frame, f32 blend) const;
+
+		//! Preforms a software skin of the mesh buffers of a pose based on its joints
+		void skinPose(SSkinnedMeshPose& pose) const;
 
-		//! Tranfers the joint data to the mesh
-		void transferJointsToMesh(const core::array<IBoneSceneNode*> &jointChildSceneNodes);
+		//! Recovers the joints from a pose
+		void recoverJointsFromPose(const SSkinnedMeshPose& pose,
+				core::array<IBoneSceneNode*> &jointChildSceneNodes) const;
 
-		//! Tranfers the joint hints to the mesh
-		void transferOnlyJointsHintsToMesh(const core::array<IBoneSceneNode*> &jointChildSceneNodes);
+		//! Tranfers the joint data to a pose
+		void transferJointsToPose(SSkinnedMeshPose& pose,
+				const core::array<IBoneSceneNode*> &jointChildSceneNodes) const;
+
+		//! Gets the number of the parent of a joint, -1 for root joints
+		s32 getJointParent(u32 number) const;
 
 		//! Creates an array of joints from this mesh as children of node
 		void addJoints(core::array<IBoneSceneNode*> &jointChildSceneNodes,
@@ -169,14 +248,160 @@ private:
 
 		void buildAllGlobalAnimatedMatrices(SJoint *Joint=0, SJoint *ParentJoint=0);
 
-		void getFrameData(f32 frame, SJoint *Node,
+		//! Frames of the keys of an animation track
+		struct SKeyFrames
+		{
+			SKeyFrames() : Count(0), First(0.f), Step(0.f) {}
+
+			//! Takes the frames of sorted keys
+			template <class T>
+			void set(const core::array<T> &keys)
+			{
+				Count=keys.size();
+				First=Count ? keys[0].frame : 0.f;
+				Step=Count>1 ? keys[1].frame-keys[0].frame : 0.f;
+
+				// evenly spaced frames are computed instead of stored
+				bool uniform=(Count<2 || Step>0.f);
+				for (u32 i=2; uniform && i<Count; ++i)
+					uniform=(keys[i].frame==First+Step*(f32)i);
+
+				Frames.clear();
+				if (!uniform)
+				{
+					Frames.reallocate(Count);
+					for (u32 i=0; i<Count; ++i)
+						Frames.push_back(keys[i].frame);
+				}
+			}
+
+			f32 getFrame(u32 index) const
+			{
+				return Frames.size() ? Frames[index] : First+Step*(f32)index;
+			}
+
+			//! Returns the first key at or after the frame, -1 if all keys are before it
+			/** The hint and the key after it are tried first, as the frame
+			mostly moves on by less than a key. */
+			s32 find(f32 frame, s32 &hint) const
+			{
+				if (hint>=0 && (u32)hint < Count)
+				{
+					if (getFrame(hint)>=frame)
+					{
+						if (hint==0 || getFrame(hint-1)<frame)
+							return hint;
+					}
+					else if ((u32)hint+1 < Count && getFrame(hint+1)>=frame)
+						return ++hint;
+				}
+				return search(frame, hint);
+			}
+
+			s32 search(f32 frame, s32 &hint) const;
+
+			//! Empty when the frames are evenly spaced
+			core::array<f32> Frames;
+			u32 Count;
+			f32 First;
+			f32 Step;
+		};
+
+		//! Keys of a joint, with the rotations quantized to 16 bit
+		struct SAnimationTrack
+		{
+			//! Gets a rotation, which is not normalized again
+			void getRotation(u32 index, core::quaternion &rotation) const
+			{
+				const s16* q=&Rotations[index*4];
+				rotation.set(q[0]*(1.f/32767.f), q[1]*(1.f/32767.f), q[2]*(1.f/32767.f), q[3]*(1.f/32767.f));
+			}
+
+			SKeyFrames PositionFrames;
+			core::array<core::vector3df> Positions;
+
+			SKeyFrames ScaleFrames;
+			core::array<core::vector3df> Scales;
+
+			SKeyFrames RotationFrames;
+			core::array<s16> Rotations;
+
+			bool hasKeys() const
+			{
+				return PositionFrames.Count || ScaleFrames.Count || RotationFrames.Count;
+			}
+
+			//! Returns the frame of the last key
+			f32 getEndFrame() const
+			{
+				f32 frame=0.f;
+				if (PositionFrames.Count)
+					frame=core::max_(frame, PositionFrames.getFrame(PositionFrames.Count-1));
+				if (ScaleFrames.Count)
+					frame=core::max_(frame, ScaleFrames.getFrame(ScaleFrames.Count-1));
+				if (RotationFrames.Count)
+					frame=core::max_(frame, RotationFrames.getFrame(RotationFrames.Count-1));
+				return frame;
+			}
+		};
+
+		void buildAnimationTracks();
+
+		//! Fills the empty key arrays with the keys of a track
+		void unpackAnimationTrack(u32 number, core::array<SPositionKey> &positionKeys,
+				core::array<SScaleKey> &scaleKeys, core::array<SRotationKey> &rotationKeys) const;
+
+		void buildLocalAnimatedMatrix(const SJoint *joint, const SAnimationTrack *track,
+				const core::vector3df &position, const core::quaternion &rotation,
+				const core::vector3df &scale, core::matrix4 &matrix,
+				bool &globalSkinningSpace) const;
+
+		void getFrameData(f32 frame, const SAnimationTrack *track,
 				core::vector3df &position, s32 &positionHint,
 				core::vector3df &scale, s32 &scaleHint,
-				core::quaternion &rotation, s32 &rotationHint);
+				core::quaternion &rotation, s32 &rotationHint) const;
 
 		void calculateGlobalMatrices(SJoint *Joint,SJoint *ParentJoint);
 
-		void skinJoint(SJoint *Joint, SJoint *ParentJoint);
+		//! Up to four joints pulling on a skinned vertex
+		struct SSkinVertex
+		{
+			core::vector3df StaticPos;
+			core::vector3df StaticNormal;
+			u32 Vertex;
+			u16 JointCount;
+			u16 Joints[4];
+			f32 Weights[4];
+		};
+
+		//! Skinned vertices of a mesh buffer
+		struct SSkinTable
+		{
+			SSkinTable() : HasStaticVertices(false) {}
+
+			//! Sorted by vertex
+			core::array<SSkinVertex> Vertices;
+
+			//! Bounding box of the vertices which are not skinned
+			core::aabbox3df StaticBox;
+			bool HasStaticVertices;
+		};
+
+		struct SSkinningJob;
+
+		void buildSkinTables();
+
+		void skinBuffer(u32 number, const core::array<core::matrix4> &skinMatrices,
+				SSkinMeshBuffer *buffer) const;
+
+		void buildJointOrder(SJoint *joint, s32 parent);
+
+		SSkinnedMeshPose* createPose() const;
+
+		//! getUniquePose(), called with the PoseLock held
+		SSkinnedMeshPose* takeUniquePose(SSkinnedMeshPose* pose);
+
+		void invalidatePoses();
 
 		void calculateTangents(core::vector3df& normal,
 			core::vector3df& tangent, core::vector3df& binormal,
@@ -190,7 +415,33 @@ private:
 		core::array<SJoint*> AllJoints;
 		core::array<SJoint*> RootJoints;
 
-		core::array< core::array<bool> > Vertices_Moved;
+		//! Keys of each joint, built from the joints on finalize
+		core::array<SAnimationTrack> AnimationTracks;
+
+		//! Tracks copied from the mesh given to useAnimationFrom
+		core::array<SAnimationTrack> OtherTracks;
+
+		//! Track each joint is animated with, null for joints without animation
+		core::array<const SAnimationTrack*> JointTracks;
+
+		//! Skinned vertices of each mesh buffer, built from the weights
+		core::array<SSkinTable> SkinTables;
+
+		//! Parent number of each joint, -1 for root joints
+		core::array<s32> JointParents;
+
+		//! Joint numbers with parents before their children, in skinning order
+		core::array<u32> JointOrder;
+
+		core::array<SSkinnedMeshPose*> PoseCache;
+		u32 PoseCacheTime;
+
+		//! guards the pose cache and the reference counts of the poses in it
+		CMutex PoseLock;
+
+		//! notified when a cached pose is no longer in progress
+		CCondition PoseDone;
+		u32 PoseVersion;
 
 		core::aabbox3d<f32> BoundingBox;
 
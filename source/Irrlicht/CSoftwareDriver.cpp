@@ -200,6 +200,12 @@ bool CSoftwareDriver::setActiveTexture(u32 stage, video::ITexture* texture)
 		return false;
 	}
 
+	if (texture && texture != Texture)
+		++FrameStats.TextureBinds;
+
+	if (texture)
+		useTexture(texture);
+
 	if (Texture)
 		Texture->drop();
 
@@ -216,6 +222,9 @@ bool CSoftwareDriver::setActiveTexture(u32 stage, video::ITexture* texture)
 //! sets a material
 void CSoftwareDriver::setMaterial(const SMaterial& material)
 {
+	if (Material != material)
+		++FrameStats.MaterialChanges;
+
 	Material = material;
 	OverrideMaterial.apply(Material);
 
@@ -652,6 +661,7 @@ void CSoftwareDriver::drawClippedIndexedTriangleListT(const VERTEXTYPE* vertices
 
 	CNullDriver::drawVertexPrimitiveList(clippedVertices.pointer(), clippedVertices.size(),
 		clippedIndices.pointer(), clippedIndices.size()/3, EVT_STANDARD, scene::EPT_TRIANGLES, EIT_16BIT);
+	FrameStats.VerticesTransformed += clippedVertices.size();
 
 	if (TransformedPoints.size() < clippedVertices.size())
 		TransformedPoints.set_used(clippedVertices.size());
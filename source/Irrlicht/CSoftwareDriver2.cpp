@@ -23,11 +23,19 @@ namespace irr
 namespace video
 {
 
+// rows of the render target per tile
+static const s32 TILE_HEIGHT = 32;
+
+// queued triangles before the tiles are drawn
+static const u32 TILE_QUEUE_MAX = 16384;
+
+
 //! constructor
 CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters& params, io::IFileSystem* io, video::IImagePresenter* presenter)
 : CNullDriver(io, params.WindowSize), BackBuffer(0), Presenter(presenter),
 	WindowId(0), SceneSourceRect(0),
 	RenderTargetTexture(0), RenderTargetSurface(0), CurrentShader(0),
+	CurrentShaderType(ETR_INVALID), RasterizerPool(0), RasterStateDirty(true),
 	 DepthBuffer(0), StencilBuffer ( 0 ),
 	 CurrentOut ( 16 * 2, 256 ), Temp ( 16 * 2, 256 )
 {
@@ -35,6 +43,12 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 	setDebugName("CBurningVideoDriver");
 	#endif
 
+#ifdef SOFTWARE_DRIVER_2_SSE2
+	UseSSE2 = os::Cpu::hasSSE2 ();
+#else
+	UseSSE2 = false;
+#endif
+
 	// create backbuffer
 	BackBuffer = new CImage(BURNINGSHADER_COLOR_FORMAT, params.WindowSize);
 	if (BackBuffer)
@@ -58,38 +72,29 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 	DriverAttributes->setAttribute("Version", 49);
 
 	// create triangle renderers
+	createTriangleRenderers ( BurningShader );
+
+	// every tile rasterizer thread gets its own set of triangle renderers
+	if ( params.RasterizerThreads != 1 )
+	{
+		RasterizerPool = new CThreadPool ( params.RasterizerThreads );
+		const u32 threads = RasterizerPool->getThreadCount ();
+		if ( threads > 1 )
+		{
+			TileShader.set_used ( threads * ETR2_COUNT );
+			for ( u32 i = 0; i != threads; ++i )
+				createTriangleRenderers ( TileShader.pointer() + i * ETR2_COUNT );
 
-	irr::memset32 ( BurningShader, 0, sizeof ( BurningShader ) );
-	//BurningShader[ETR_FLAT] = createTRFlat2(DepthBuffer);
-	//BurningShader[ETR_FLAT_WIRE] = createTRFlatWire2(DepthBuffer);
-	BurningShader[ETR_GOURAUD] = createTriangleRendererGouraud2(this);
-	BurningShader[ETR_GOURAUD_ALPHA] = createTriangleRendererGouraudAlpha2(this );
-	BurningShader[ETR_GOURAUD_ALPHA_NOZ] = createTRGouraudAlphaNoZ2(this );
-	//BurningShader[ETR_GOURAUD_WIRE] = createTriangleRendererGouraudWire2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT] = createTriangleRendererTextureFlat2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT_WIRE] = createTriangleRendererTextureFlatWire2(DepthBuffer);
-	BurningShader[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1] = createTriangleRendererTextureLightMap2_M1(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2] = createTriangleRendererTextureLightMap2_M2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M4] = createTriangleRendererGTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_LIGHTMAP_M4] = createTriangleRendererTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD] = createTriangleRendererTextureLightMap2_Add(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_DETAIL_MAP] = createTriangleRendererTextureDetailMap2(this);
-
-	BurningShader[ETR_TEXTURE_GOURAUD_WIRE] = createTriangleRendererTextureGouraudWire2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2 ( this );
-
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(this );
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ( this );
-
-	BurningShader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap ( this );
-	BurningShader[ETR_STENCIL_SHADOW] = createTRStencilShadow ( this );
-	BurningShader[ETR_TEXTURE_BLEND] = createTRTextureBlend( this );
-
-	BurningShader[ETR_REFERENCE] = createTriangleRendererReference ( this );
+			char buf[64];
+			snprintf_irr ( buf, 64, "Burning's Video: %d rasterizer threads", threads );
+			os::Printer::log ( buf, ELL_INFORMATION );
+		}
+		else
+		{
+			RasterizerPool->drop ();
+			RasterizerPool = 0;
+		}
+	}
 
 
 	// add the same renderer for all solid types
@@ -141,6 +146,8 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 //! destructor
 CBurningVideoDriver::~CBurningVideoDriver()
 {
+	flushRasterizer();
+
 	// delete Backbuffer
 	if (BackBuffer)
 		BackBuffer->drop();
@@ -153,6 +160,15 @@ CBurningVideoDriver::~CBurningVideoDriver()
 			BurningShader[i]->drop();
 	}
 
+	for (u32 i=0; i!=TileShader.size(); ++i)
+	{
+		if (TileShader[i])
+			TileShader[i]->drop();
+	}
+
+	if (RasterizerPool)
+		RasterizerPool->drop();
+
 	// delete Additional buffer
 	if (StencilBuffer)
 		StencilBuffer->drop();
@@ -168,6 +184,62 @@ CBurningVideoDriver::~CBurningVideoDriver()
 }
 
 
+//! creates one set of triangle renderers
+void CBurningVideoDriver::createTriangleRenderers(IBurningShader** shader)
+{
+	irr::memset32 ( shader, 0, sizeof ( IBurningShader* ) * ETR2_COUNT );
+	//shader[ETR_FLAT] = createTRFlat2(DepthBuffer);
+	//shader[ETR_FLAT_WIRE] = createTRFlatWire2(DepthBuffer);
+	shader[ETR_GOURAUD] = createTriangleRendererGouraud2(this);
+	shader[ETR_GOURAUD_ALPHA] = createTriangleRendererGouraudAlpha2(this );
+	shader[ETR_GOURAUD_ALPHA_NOZ] = createTRGouraudAlphaNoZ2(this );
+	//shader[ETR_GOURAUD_WIRE] = createTriangleRendererGouraudWire2(DepthBuffer);
+	//shader[ETR_TEXTURE_FLAT] = createTriangleRendererTextureFlat2(DepthBuffer);
+	//shader[ETR_TEXTURE_FLAT_WIRE] = createTriangleRendererTextureFlatWire2(DepthBuffer);
+	shader[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1] = createTriangleRendererTextureLightMap2_M1(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2] = createTriangleRendererTextureLightMap2_M2(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M4] = createTriangleRendererGTextureLightMap2_M4(this);
+	shader[ETR_TEXTURE_LIGHTMAP_M4] = createTriangleRendererTextureLightMap2_M4(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD] = createTriangleRendererTextureLightMap2_Add(this);
+	shader[ETR_TEXTURE_GOURAUD_DETAIL_MAP] = createTriangleRendererTextureDetailMap2(this);
+
+	shader[ETR_TEXTURE_GOURAUD_WIRE] = createTriangleRendererTextureGouraudWire2(this);
+	shader[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(this);
+	shader[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(this);
+	shader[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(this);
+	shader[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2 ( this );
+
+	shader[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(this );
+	shader[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ( this );
+
+	shader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap ( this );
+	shader[ETR_STENCIL_SHADOW] = createTRStencilShadow ( this );
+	shader[ETR_TEXTURE_BLEND] = createTRTextureBlend( this );
+
+	shader[ETR_REFERENCE] = createTriangleRendererReference ( this );
+}
+
+
+//! passes the material states to a triangle renderer
+static void setShaderMaterial ( IBurningShader* shader, EBurningFFShader type, const SBurningShaderMaterial& material )
+{
+	shader->setZCompareFunc ( material.org.ZBuffer );
+	shader->setMaterial ( material );
+
+	switch ( type )
+	{
+		case ETR_TEXTURE_GOURAUD_ALPHA:
+		case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
+		case ETR_TEXTURE_BLEND:
+			shader->setParam ( 0, material.org.MaterialTypeParam );
+			break;
+		default:
+		break;
+	}
+}
+
+
 /*!
 	selects the right triangle renderer based on the render states.
 */
@@ -280,22 +352,12 @@ void CBurningVideoDriver::setCurrentShader()
 
 	// switchToTriangleRenderer
 	CurrentShader = BurningShader[shader];
+	CurrentShaderType = shader;
+	RasterStateDirty = true;
 	if ( CurrentShader )
 	{
-		CurrentShader->setZCompareFunc ( Material.org.ZBuffer );
 		CurrentShader->setRenderTarget(RenderTargetSurface, ViewPort);
-		CurrentShader->setMaterial ( Material );
-
-		switch ( shader )
-		{
-			case ETR_TEXTURE_GOURAUD_ALPHA:
-			case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
-			case ETR_TEXTURE_BLEND:
-				CurrentShader->setParam ( 0, Material.org.MaterialTypeParam );
-				break;
-			default:
-			break;
-		}
+		setShaderMaterial ( CurrentShader, shader, Material );
 	}
 
 }
@@ -325,6 +387,7 @@ bool CBurningVideoDriver::queryFeature(E_VIDEO_DRIVER_FEATURE feature) const
 	case EVDF_MULTITEXTURE:
 	case EVDF_HARDWARE_TL:
 	case EVDF_TEXTURE_NSQUARE:
+	case EVDF_TEXTURE_COMPRESSED_DXT:
 		return true;
 
 	default:
@@ -404,6 +467,20 @@ bool CBurningVideoDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clear
 
 bool CBurningVideoDriver::endScene()
 {
+	flushRasterizer();
+
+	u32 i;
+	for ( i = 0; i != ETR2_COUNT; ++i )
+	{
+		if ( BurningShader[i] )
+			FrameStats.PixelsShaded += BurningShader[i]->takePixelsShaded();
+	}
+	for ( i = 0; i != TileShader.size(); ++i )
+	{
+		if ( TileShader[i] )
+			FrameStats.PixelsShaded += TileShader[i]->takePixelsShaded();
+	}
+
 	CNullDriver::endScene();
 
 	return Presenter->present(BackBuffer, WindowId, SceneSourceRect);
@@ -442,6 +519,8 @@ bool CBurningVideoDriver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag
 //! sets a render target
 void CBurningVideoDriver::setRenderTargetImage(video::CImage* image)
 {
+	flushRasterizer();
+
 	if (RenderTargetSurface)
 		RenderTargetSurface->drop();
 
@@ -462,6 +541,13 @@ void CBurningVideoDriver::setRenderTargetImage(video::CImage* image)
 
 	if (StencilBuffer)
 		StencilBuffer->setSize(RenderTargetSize);
+
+	if (RasterizerPool)
+	{
+		const u32 tileCount = ( RenderTargetSize.Height + TILE_HEIGHT - 1 ) / TILE_HEIGHT;
+		while ( TileBin.size() < tileCount )
+			TileBin.push_back ( core::array<u32>() );
+	}
 }
 
 
@@ -876,29 +962,164 @@ const SVSize CBurningVideoDriver::vSize[] =
 */
 void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 destIndex)
 {
-	u8 * source;
-	s4DVertex *dest;
+	SCacheInfo fill;
+	fill.index = sourceIndex;
+	fill.hit = destIndex;
 
-	source = (u8*) VertexCache.vertices + ( sourceIndex * vSize[VertexCache.vType].Pitch );
+	VertexCache_fillBatch ( &fill, 1 );
 
-	// it's a look ahead so we never hit it..
-	// but give priority...
-	//VertexCache.info[ destIndex ].hit = hitCount;
-
-	// store info
-	VertexCache.info[ destIndex ].index = sourceIndex;
 	VertexCache.info[ destIndex ].hit = 0;
+}
 
-	// destination Vertex
-	dest = (s4DVertex *) ( (u8*) VertexCache.mem.data + ( destIndex << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
 
-	// transform Model * World * Camera * Projection * NDCSpace matrix
-	const S3DVertex *base = ((S3DVertex*) source );
-	Transformation [ ETS_CURRENT].transformVect ( &dest->Pos.x, base->Pos );
+/*!
+	fill cache lines with transformed, light and clipp test vertices.
+	fill[i].index is the source vertex, fill[i].hit the cache line.
+	positions, clip codes and light space vectors are done for the whole batch,
+	lighting and texture coordinates per vertex.
+*/
+void CBurningVideoDriver::VertexCache_fillBatch ( const SCacheInfo *fill, const u32 count )
+{
+	VertexCache_transform ( fill, count );
+	FrameStats.VerticesTransformed += count;
+
+	for ( u32 i = 0; i != count; ++i )
+	{
+		s4DVertex *dest = (s4DVertex *) ( (u8*) VertexCache.mem.data + ( fill[i].hit << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
 
-	//mhm ;-) maybe no goto
-	if ( VertexCache.vType == 4 ) goto clipandproject;
+		// store info
+		VertexCache.info[ fill[i].hit ].index = fill[i].index;
 
+		if ( VertexCache.vType != 4 )
+			VertexCache_shade ( fill[i].index, dest, i );
+
+		// to DC Space, project homogenous vertex
+		if ( (dest[0].flag & VERTEX4D_CLIPMASK ) == VERTEX4D_INSIDE )
+		{
+			ndc_2_dc_and_project2 ( (const s4DVertex**) &dest, 1 );
+		}
+	}
+}
+
+
+/*!
+	transform Model * World * Camera * Projection * NDCSpace matrix and clip test,
+	and the vertex normal and position in light space.
+*/
+void CBurningVideoDriver::VertexCache_transform ( const SCacheInfo *fill, const u32 count )
+{
+	const u8 *vertices = (const u8*) VertexCache.vertices;
+	const u32 pitch = vSize[VertexCache.vType].Pitch;
+	const u32 format = vSize[VertexCache.vType].Format;
+
+	bool lightSpace = false;
+	bool lightSpaceVertex = false;
+
+#if defined (SOFTWARE_DRIVER_2_LIGHTING) || defined ( SOFTWARE_DRIVER_2_TEXTURE_TRANSFORM )
+	if ( VertexCache.vType != 4 &&
+		( Material.org.Lighting || (LightSpace.Flags & VERTEXTRANSFORM) ) &&
+		0 == ( TransformationFlag[ETS_WORLD] & ETF_IDENTITY )
+		)
+	{
+		lightSpace = true;
+		lightSpaceVertex = 0 != ( LightSpace.Flags & ( POINTLIGHT | FOG | SPECULAR | VERTEXTRANSFORM) );
+	}
+#endif
+
+	u32 i;
+
+#ifdef SOFTWARE_DRIVER_2_SSE2
+	if ( UseSSE2 )
+	{
+		// four vertices at a time, the last group repeats its last vertex
+		for ( i = 0; i < count; i += 4 )
+		{
+			const u32 n = core::min_ ( count - i, (u32) 4 );
+
+			const S3DVertex *base[4];
+			s4DVertex *dest[4];
+			u32 g;
+			for ( g = 0; g != 4; ++g )
+			{
+				const SCacheInfo &f = fill [ i + core::min_ ( g, n - 1 ) ];
+				base[g] = (const S3DVertex*) ( vertices + f.index * pitch );
+				dest[g] = (s4DVertex *) ( (u8*) VertexCache.mem.data + ( f.hit << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
+			}
+
+			const __m128 x = _mm_setr_ps ( base[0]->Pos.X, base[1]->Pos.X, base[2]->Pos.X, base[3]->Pos.X );
+			const __m128 y = _mm_setr_ps ( base[0]->Pos.Y, base[1]->Pos.Y, base[2]->Pos.Y, base[3]->Pos.Y );
+			const __m128 z = _mm_setr_ps ( base[0]->Pos.Z, base[1]->Pos.Z, base[2]->Pos.Z, base[3]->Pos.Z );
+
+			__m128 v[4];
+			transformVect4 ( v, Transformation[ETS_CURRENT].pointer(), x, y, z );
+
+			u32 flag[4];
+			_mm_storeu_si128 ( (__m128i*) flag, clipToFrustumTest4 ( v[0], v[1], v[2], v[3] ) );
+
+			_MM_TRANSPOSE4_PS ( v[0], v[1], v[2], v[3] );
+			for ( g = 0; g != n; ++g )
+			{
+				_mm_storeu_ps ( &dest[g]->Pos.x, v[g] );
+				dest[g][0].flag = dest[g][1].flag = format;
+#ifdef IRRLICHT_FAST_MATH
+				dest[g][0].flag |= clipToFrustumTest ( dest[g] );
+#else
+				dest[g][0].flag |= flag[g];
+#endif
+			}
+
+			if ( !lightSpace )
+				continue;
+
+			__m128 nx = _mm_setr_ps ( base[0]->Normal.X, base[1]->Normal.X, base[2]->Normal.X, base[3]->Normal.X );
+			__m128 ny = _mm_setr_ps ( base[0]->Normal.Y, base[1]->Normal.Y, base[2]->Normal.Y, base[3]->Normal.Y );
+			__m128 nz = _mm_setr_ps ( base[0]->Normal.Z, base[1]->Normal.Z, base[2]->Normal.Z, base[3]->Normal.Z );
+
+			rotateVect4 ( v, Transformation[ETS_WORLD].pointer(), nx, ny, nz );
+			v[3] = _mm_set1_ps ( 1.f );
+			_MM_TRANSPOSE4_PS ( v[0], v[1], v[2], v[3] );
+			for ( g = 0; g != n; ++g )
+				_mm_storeu_ps ( &VertexCache.normal[i + g].x, v[g] );
+
+			if ( !lightSpaceVertex )
+				continue;
+
+			transformVect4 ( v, Transformation[ETS_WORLD].pointer(), x, y, z );
+			_MM_TRANSPOSE4_PS ( v[0], v[1], v[2], v[3] );
+			for ( g = 0; g != n; ++g )
+				_mm_storeu_ps ( &VertexCache.vertex[i + g].x, v[g] );
+		}
+		return;
+	}
+#endif
+
+	for ( i = 0; i != count; ++i )
+	{
+		const S3DVertex *base = (const S3DVertex*) ( vertices + fill[i].index * pitch );
+		s4DVertex *dest = (s4DVertex *) ( (u8*) VertexCache.mem.data + ( fill[i].hit << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
+
+		Transformation [ ETS_CURRENT].transformVect ( &dest->Pos.x, base->Pos );
+
+		dest[0].flag = dest[1].flag = format;
+		dest[0].flag |= clipToFrustumTest ( dest );
+
+		if ( lightSpace )
+		{
+			Transformation[ETS_WORLD].rotateVect ( &VertexCache.normal[i].x, base->Normal );
+			if ( lightSpaceVertex )
+				Transformation[ETS_WORLD].transformVect ( &VertexCache.vertex[i].x, base->Pos );
+		}
+	}
+}
+
+
+/*!
+	lighting, texture coordinates and light tangents of a transformed vertex
+*/
+void CBurningVideoDriver::VertexCache_shade ( const u32 sourceIndex, s4DVertex *dest, const u32 batchIndex )
+{
+	const u8 * source = (const u8*) VertexCache.vertices + ( sourceIndex * vSize[VertexCache.vType].Pitch );
+	const S3DVertex *base = ((const S3DVertex*) source );
 
 #if defined (SOFTWARE_DRIVER_2_LIGHTING) || defined ( SOFTWARE_DRIVER_2_TEXTURE_TRANSFORM )
 
@@ -912,11 +1133,14 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 		}
 		else
 		{
-			Transformation[ETS_WORLD].rotateVect ( &LightSpace.normal.x, base->Normal );
+			// rotated in VertexCache_transform
+			LightSpace.normal.x = VertexCache.normal[batchIndex].x;
+			LightSpace.normal.y = VertexCache.normal[batchIndex].y;
+			LightSpace.normal.z = VertexCache.normal[batchIndex].z;
 
 			// vertex in light space
 			if ( LightSpace.Flags & ( POINTLIGHT | FOG | SPECULAR | VERTEXTRANSFORM) )
-				Transformation[ETS_WORLD].transformVect ( &LightSpace.vertex.x, base->Pos );
+				LightSpace.vertex = VertexCache.vertex[batchIndex];
 		}
 
 		if ( LightSpace.Flags & NORMALIZE )
@@ -1062,7 +1286,7 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 	// tangent space light vector, emboss
 	if ( Lights.size () && ( vSize[VertexCache.vType].Format & VERTEX4D_FORMAT_BUMP_DOT3 ) )
 	{
-		const S3DVertexTangents *tangent = ((S3DVertexTangents*) source );
+		const S3DVertexTangents *tangent = ((const S3DVertexTangents*) source );
 		const SBurningShaderLight &light = LightSpace.Light[0];
 
 		sVec4 vp;
@@ -1092,7 +1316,7 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 
 	if ( LightSpace.Light.size () && ( vSize[VertexCache.vType].Format & VERTEX4D_FORMAT_BUMP_DOT3 ) )
 	{
-		const S3DVertexTangents *tangent = ((S3DVertexTangents*) source );
+		const S3DVertexTangents *tangent = ((const S3DVertexTangents*) source );
 
 		sVec4 vp;
 
@@ -1156,45 +1380,62 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 
 
 #endif
+}
 
-clipandproject:
-	dest[0].flag = dest[1].flag = vSize[VertexCache.vType].Format;
-
-	// test vertex
-	dest[0].flag |= clipToFrustumTest ( dest);
+//
 
-	// to DC Space, project homogenous vertex
-	if ( (dest[0].flag & VERTEX4D_CLIPMASK ) == VERTEX4D_INSIDE )
+//! returns the cache line holding a source vertex, or VERTEXCACHE_MISS
+REALINLINE u32 CBurningVideoDriver::VertexCache_getSlot ( const u32 sourceIndex ) const
+{
+	u32 h = vertexCacheHash ( sourceIndex );
+	while ( VertexCache.lookup[h].index != VERTEXCACHE_MISS )
 	{
-		ndc_2_dc_and_project2 ( (const s4DVertex**) &dest, 1 );
+		if ( VertexCache.lookup[h].index == sourceIndex )
+			return VertexCache.lookup[h].hit;
+		h = ( h + 1 ) & ( VERTEXCACHE_HASH - 1 );
 	}
-
-	//return dest;
+	return VERTEXCACHE_MISS;
 }
 
-//
-
-REALINLINE s4DVertex * CBurningVideoDriver::VertexCache_getVertex ( const u32 sourceIndex )
+//! rebuilds the index lookup from the cache lines
+void CBurningVideoDriver::VertexCache_buildLookup ()
 {
-	for ( s32 i = 0; i < VERTEXCACHE_ELEMENT; ++i )
+	irr::memset32 ( VertexCache.lookup, VERTEXCACHE_MISS, sizeof ( VertexCache.lookup ) );
+
+	for ( u32 i = 0; i != VERTEXCACHE_ELEMENT; ++i )
 	{
-		if ( VertexCache.info[ i ].index == sourceIndex )
-		{
-			return (s4DVertex *) ( (u8*) VertexCache.mem.data + ( i << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
-		}
+		const u32 index = VertexCache.info[i].index;
+		if ( index == VERTEXCACHE_MISS )
+			continue;
+
+		u32 h = vertexCacheHash ( index );
+		while ( VertexCache.lookup[h].index != VERTEXCACHE_MISS )
+			h = ( h + 1 ) & ( VERTEXCACHE_HASH - 1 );
+
+		VertexCache.lookup[h].index = index;
+		VertexCache.lookup[h].hit = i;
 	}
-	return 0;
+}
+
+REALINLINE s4DVertex * CBurningVideoDriver::VertexCache_getVertex ( const u32 sourceIndex )
+{
+	const u32 i = VertexCache_getSlot ( sourceIndex );
+	if ( i == VERTEXCACHE_MISS )
+		return 0;
+
+	return (s4DVertex *) ( (u8*) VertexCache.mem.data + ( i << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
 }
 
 
 /*
 	Cache based on linear walk indices
-	fill blockwise on the next 16(Cache_Size) unique vertices in indexlist
-	merge the next 16 vertices with the current
+	fill blockwise on the next 64(Cache_Size) unique vertices in indexlist
+	merge the next 64 vertices with the current
 */
 REALINLINE void CBurningVideoDriver::VertexCache_get(const s4DVertex ** face)
 {
 	SCacheInfo info[VERTEXCACHE_ELEMENT];
+	SCacheInfo unique[VERTEXCACHE_HASH];
 
 	// next primitive must be complete in cache
 	if (	VertexCache.indicesIndex - VertexCache.indicesRun < 3 &&
@@ -1205,11 +1446,13 @@ REALINLINE void CBurningVideoDriver::VertexCache_get(const s4DVertex ** face)
 		VertexCache.indicesIndex = VertexCache.indicesRun;
 
 		irr::memset32 ( info, VERTEXCACHE_MISS, sizeof ( info ) );
+		irr::memset32 ( unique, VERTEXCACHE_MISS, sizeof ( unique ) );
 
 		// get the next unique vertices cache line
 		u32 fillIndex = 0;
 		u32 dIndex = 0;
 		u32 i = 0;
+		u32 h;
 		u32 sourceIndex = 0;
 
 		while ( VertexCache.indicesIndex < VertexCache.indexCount &&
@@ -1232,18 +1475,13 @@ REALINLINE void CBurningVideoDriver::VertexCache_get(const s4DVertex ** face)
 			VertexCache.indicesIndex += 1;
 
 			// if not exist, push back
-			s32 exist = 0;
-			for ( dIndex = 0;  dIndex < fillIndex; ++dIndex )
-			{
-				if ( info[ dIndex ].index == sourceIndex )
-				{
-					exist = 1;
-					break;
-				}
-			}
+			h = vertexCacheHash ( sourceIndex );
+			while ( unique[h].index != VERTEXCACHE_MISS && unique[h].index != sourceIndex )
+				h = ( h + 1 ) & ( VERTEXCACHE_HASH - 1 );
 
-			if ( 0 == exist )
+			if ( unique[h].index == VERTEXCACHE_MISS )
 			{
+				unique[h].index = sourceIndex;
 				info[fillIndex++].index = sourceIndex;
 			}
 		}
@@ -1257,34 +1495,37 @@ REALINLINE void CBurningVideoDriver::VertexCache_get(const s4DVertex ** face)
 		// mark all existing
 		for ( i = 0; i!= fillIndex; ++i )
 		{
-			for ( dIndex = 0;  dIndex < VERTEXCACHE_ELEMENT; ++dIndex )
+			dIndex = VertexCache_getSlot ( info[i].index );
+			if ( dIndex != VERTEXCACHE_MISS )
 			{
-				if ( VertexCache.info[ dIndex ].index == info[i].index )
-				{
-					info[i].hit = dIndex;
-					VertexCache.info[ dIndex ].hit = 1;
-					break;
-				}
+				info[i].hit = dIndex;
+				VertexCache.info[ dIndex ].hit = 1;
 			}
 		}
 
-		// fill new
+		// assign free cache lines to the new vertices, fill them as one batch
+		SCacheInfo fill[VERTEXCACHE_ELEMENT];
+		u32 fillCount = 0;
+
+		dIndex = 0;
 		for ( i = 0; i!= fillIndex; ++i )
 		{
 			if ( info[i].hit != VERTEXCACHE_MISS )
 				continue;
 
-			for ( dIndex = 0;  dIndex < VERTEXCACHE_ELEMENT; ++dIndex )
-			{
-				if ( 0 == VertexCache.info[dIndex].hit )
-				{
-					VertexCache_fill ( info[i].index, dIndex );
-					VertexCache.info[dIndex].hit += 1;
-					info[i].hit = dIndex;
-					break;
-				}
-			}
+			while ( VertexCache.info[dIndex].hit )
+				dIndex += 1;
+
+			VertexCache.info[dIndex].hit = 1;
+			info[i].hit = dIndex;
+
+			fill[fillCount].index = info[i].index;
+			fill[fillCount].hit = dIndex;
+			fillCount += 1;
 		}
+
+		VertexCache_fillBatch ( fill, fillCount );
+		VertexCache_buildLookup ();
 	}
 
 	const u32 i0 = core::if_c_a_else_0 ( VertexCache.pType != scene::EPT_TRIANGLE_FAN, VertexCache.indicesRun );
@@ -1431,6 +1672,143 @@ void CBurningVideoDriver::VertexCache_reset ( const void* vertices, u32 vertexCo
 	}
 
 	irr::memset32 ( VertexCache.info, VERTEXCACHE_MISS, sizeof ( VertexCache.info ) );
+	irr::memset32 ( VertexCache.lookup, VERTEXCACHE_MISS, sizeof ( VertexCache.lookup ) );
+}
+
+
+/*!
+	draws a triangle with the current shader, or queues it for the tile rasterizer.
+	queued triangles are binned into horizontal tiles of the render target.
+	every tile is drawn by a single thread in submission order, the shaders
+	only clip their scanlines to the tile, so the result is pixel exact.
+*/
+void CBurningVideoDriver::rasterizeTriangle(const s4DVertex* a, const s4DVertex* b, const s4DVertex* c)
+{
+	++FrameStats.TrianglesRasterized;
+
+	// lines and direct shader parameters are not replayed
+	if ( 0 == RasterizerPool ||
+		CurrentShaderType == ETR_TEXTURE_GOURAUD_WIRE ||
+		CurrentShaderType == ETR_STENCIL_SHADOW ||
+		CurrentShaderType == ETR_INVALID
+		)
+	{
+		flushRasterizer();
+		CurrentShader->drawTriangle ( a, b, c );
+		return;
+	}
+
+	// rows hit with the top-left fill convention
+	const f32 yMin = core::min_ ( a->Pos.y, b->Pos.y, c->Pos.y );
+	const f32 yMax = core::max_ ( a->Pos.y, b->Pos.y, c->Pos.y );
+	const s32 yStart = core::s32_max ( core::ceil32 ( yMin ), 0 );
+	const s32 yEnd = core::s32_min ( core::ceil32 ( yMax ) - 1, (s32) RenderTargetSize.Height - 1 );
+	if ( yEnd < yStart )
+		return;
+
+	if ( RasterStateDirty )
+	{
+		SRasterState state;
+		state.Shader = CurrentShaderType;
+		state.Material = Material;
+
+		// keep the textures alive until the tiles are drawn
+		for ( u32 m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+		{
+			if ( Material.org.getTexture ( m ) )
+				Material.org.getTexture ( m )->grab();
+		}
+
+		RasterState.push_back ( state );
+		RasterStateDirty = false;
+	}
+
+	SRasterTriangle tri;
+	tri.v[0] = *a;
+	tri.v[1] = *b;
+	tri.v[2] = *c;
+	for ( u32 m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+		tri.IT[m] = CurrentShader->getInternalTexture ( m );
+	tri.State = RasterState.size() - 1;
+
+	const u32 index = RasterQueue.size();
+	RasterQueue.push_back ( tri );
+
+	const s32 tileEnd = yEnd / TILE_HEIGHT;
+	for ( s32 tile = yStart / TILE_HEIGHT; tile <= tileEnd; ++tile )
+		TileBin[tile].push_back ( index );
+
+	if ( RasterQueue.size() >= TILE_QUEUE_MAX )
+		flushRasterizer();
+}
+
+
+//! draws all queued triangles
+void CBurningVideoDriver::flushRasterizer()
+{
+	if ( 0 == RasterQueue.size() )
+		return;
+
+	// shared render target, grabbed on the calling thread
+	for ( u32 i = 0; i != TileShader.size(); ++i )
+	{
+		if ( TileShader[i] )
+			TileShader[i]->setRenderTarget ( RenderTargetSurface, ViewPort );
+	}
+
+	const u32 tileCount = ( RenderTargetSize.Height + TILE_HEIGHT - 1 ) / TILE_HEIGHT;
+
+	CRasterJob job ( this );
+	RasterizerPool->run ( &job, tileCount );
+
+	u32 i;
+	for ( i = 0; i != RasterState.size(); ++i )
+	{
+		for ( u32 m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+		{
+			if ( RasterState[i].Material.org.getTexture ( m ) )
+				RasterState[i].Material.org.getTexture ( m )->drop();
+		}
+	}
+
+	for ( i = 0; i != tileCount; ++i )
+		TileBin[i].set_used ( 0 );
+
+	RasterState.set_used ( 0 );
+	RasterQueue.set_used ( 0 );
+	RasterStateDirty = true;
+}
+
+
+//! draws the queued triangles touching one tile
+void CBurningVideoDriver::rasterizeTile(u32 tile, u32 thread)
+{
+	IBurningShader** shader = TileShader.pointer() + thread * ETR2_COUNT;
+	const core::array<u32>& bin = TileBin[tile];
+	const s32 yStart = tile * TILE_HEIGHT;
+
+	IBurningShader* render = 0;
+	u32 state = 0xFFFFFFFF;
+
+	for ( u32 i = 0; i != bin.size(); ++i )
+	{
+		const SRasterTriangle& tri = RasterQueue[bin[i]];
+
+		if ( tri.State != state )
+		{
+			state = tri.State;
+			const SRasterState& s = RasterState[state];
+
+			render = shader[s.Shader];
+			setShaderMaterial ( render, s.Shader, s.Material );
+			render->setScanLineBand ( yStart, yStart + TILE_HEIGHT );
+		}
+
+		for ( u32 m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+			render->setInternalTexture ( m, tri.IT[m] );
+
+		render->drawTriangle ( tri.v + 0, tri.v + 1, tri.v + 2 );
+	}
 }
 
 
@@ -1502,7 +1880,7 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 			}
 
 			// rasterize
-			CurrentShader->drawTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
+			rasterizeTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
 			continue;
 		}
 
@@ -1556,7 +1934,7 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 		for ( g = 0; g <= vOut - 6; g += 2 )
 		{
 			// rasterize
-			CurrentShader->drawTriangle ( CurrentOut.data + 0 + 1,
+			rasterizeTriangle ( CurrentOut.data + 0 + 1,
 							CurrentOut.data + g + 3,
 							CurrentOut.data + g + 5);
 		}
@@ -1661,8 +2039,27 @@ u32 CBurningVideoDriver::getMaximalDynamicLightAmount() const
 //! sets a material
 void CBurningVideoDriver::setMaterial(const SMaterial& material)
 {
+	if ( Material.org != material )
+	{
+		++FrameStats.MaterialChanges;
+
+		// the shaders sample the textures of the material directly
+		for ( u32 i = 0; i != BURNING_MATERIAL_MAX_TEXTURES; ++i )
+		{
+			if ( material.getTexture ( i ) && material.getTexture ( i ) != Material.org.getTexture ( i ) )
+				++FrameStats.TextureBinds;
+		}
+	}
+
 	Material.org = material;
 
+	// evicted textures are loaded again, those which fail are not sampled
+	for ( u32 i = 0; i != BURNING_MATERIAL_MAX_TEXTURES; ++i )
+	{
+		if ( material.getTexture ( i ) && !useTexture ( material.getTexture ( i ) ) )
+			Material.org.setTexture ( i, 0 );
+	}
+
 #ifdef SOFTWARE_DRIVER_2_TEXTURE_TRANSFORM
 	for (u32 i = 0; i < 2; ++i)
 	{
@@ -1870,6 +2267,8 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 					 const core::rect<s32>* clipRect, SColor color,
 					 bool useAlphaChannelOfTexture)
 {
+	flushRasterizer();
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_BURNINGSVIDEO)
@@ -1878,6 +2277,9 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 			return;
 		}
 
+		if (!useTexture(texture))
+			return;
+
 #if 0
 		// 2d methods don't use viewPort
 		core::position2di dest = destPos;
@@ -1908,6 +2310,8 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
 		const video::SColor* const colors, bool useAlphaChannelOfTexture)
 {
+	flushRasterizer();
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_BURNINGSVIDEO)
@@ -1916,12 +2320,18 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 			return;
 		}
 
+		if (!useTexture(texture))
+			return;
+
+	// filtered like the hardware drivers filter the 2d material
+	const bool bilinear = OverrideMaterial2DEnabled && OverrideMaterial2D.TextureLayer[0].BilinearFilter;
+
 	if (useAlphaChannelOfTexture)
 		StretchBlit(BLITTER_TEXTURE_ALPHA_BLEND, RenderTargetSurface, &destRect, &sourceRect,
-			    ((CSoftwareTexture2*)texture)->getImage(), (colors ? colors[0].color : 0));
+			    ((CSoftwareTexture2*)texture)->getImage(), (colors ? colors[0].color : 0), bilinear);
 	else
 		StretchBlit(BLITTER_TEXTURE, RenderTargetSurface, &destRect, &sourceRect,
-			    ((CSoftwareTexture2*)texture)->getImage(), (colors ? colors[0].color : 0));
+			    ((CSoftwareTexture2*)texture)->getImage(), (colors ? colors[0].color : 0), bilinear);
 	}
 }
 
@@ -1930,6 +2340,8 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 					const core::position2d<s32>& end,
 					SColor color)
 {
+	flushRasterizer();
+
 	drawLine(BackBuffer, start, end, color );
 }
 
@@ -1937,6 +2349,8 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 //! Draws a pixel
 void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 {
+	flushRasterizer();
+
 	BackBuffer->setPixel(x, y, color, true);
 }
 
@@ -1945,6 +2359,8 @@ void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 void CBurningVideoDriver::draw2DRectangle(SColor color, const core::rect<s32>& pos,
 									 const core::rect<s32>* clip)
 {
+	flushRasterizer();
+
 	if (clip)
 	{
 		core::rect<s32> p(pos);
@@ -2016,6 +2432,8 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 	SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 	const core::rect<s32>* clip)
 {
+	flushRasterizer();
+
 #ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
 
 	core::rect<s32> pos = position;
@@ -2092,6 +2510,7 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 
 		if ( test == VERTEX4D_INSIDE )
 		{
+			++FrameStats.TrianglesRasterized;
 			render->drawTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
 			continue;
 		}
@@ -2114,6 +2533,7 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 		for ( g = 0; g <= vOut - 6; g += 2 )
 		{
 			// rasterize
+			++FrameStats.TrianglesRasterized;
 			render->drawTriangle ( CurrentOut.data + 1, &CurrentOut.data[g + 3], &CurrentOut.data[g + 5] );
 		}
 
@@ -2128,6 +2548,8 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 void CBurningVideoDriver::draw3DLine(const core::vector3df& start,
 	const core::vector3df& end, SColor color)
 {
+	flushRasterizer();
+
 	Transformation [ ETS_CURRENT].transformVect ( &CurrentOut.data[0].Pos.x, start );
 	Transformation [ ETS_CURRENT].transformVect ( &CurrentOut.data[2].Pos.x, end );
 
@@ -2229,6 +2651,8 @@ ITexture* CBurningVideoDriver::addRenderTargetTexture(const core::dimension2d<u3
 
 void CBurningVideoDriver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 {
+	flushRasterizer();
+
 	if ((flag & ECBF_COLOR) && RenderTargetSurface)
 		RenderTargetSurface->fill(color);
 
@@ -2243,6 +2667,8 @@ void CBurningVideoDriver::clearBuffers(u16 flag, SColor color, f32 depth, u8 ste
 //! Returns an image created from the last rendered frame.
 IImage* CBurningVideoDriver::createScreenShot(video::ECOLOR_FORMAT format, video::E_RENDER_TARGET target)
 {
+	flushRasterizer();
+
 	if (target != video::ERT_FRAME_BUFFER)
 		return 0;
 
@@ -2259,7 +2685,8 @@ IImage* CBurningVideoDriver::createScreenShot(video::ECOLOR_FORMAT format, video
 ITexture* CBurningVideoDriver::createDeviceDependentTexture(const io::path& name, IImage* image)
 {
 	CSoftwareTexture2* texture = new CSoftwareTexture2(image, name, (getTextureCreationFlag(ETCF_CREATE_MIP_MAPS) ? CSoftwareTexture2::GEN_MIPMAP : 0) |
-		(getTextureCreationFlag(ETCF_ALLOW_NON_POWER_2) ? 0 : CSoftwareTexture2::NP2_SIZE));
+		(getTextureCreationFlag(ETCF_ALLOW_NON_POWER_2) ? 0 : CSoftwareTexture2::NP2_SIZE) |
+		(getTextureCreationFlag(ETCF_OPTIMIZED_FOR_QUALITY) ? CSoftwareTexture2::MIPMAP_QUALITY : 0));
 
 	return texture;
 }
@@ -2279,10 +2706,13 @@ u32 CBurningVideoDriver::getMaximalPrimitiveCount() const
 //! volume. Next use IVideoDriver::drawStencilShadow() to visualize the shadow.
 void CBurningVideoDriver::drawStencilShadowVolume(const core::array<core::vector3df>& triangles, bool zfail, u32 debugDataVisible)
 {
+	flushRasterizer();
+
 	const u32 count = triangles.size();
 	IBurningShader *shader = BurningShader [ ETR_STENCIL_SHADOW ];
 
 	CurrentShader = shader;
+	CurrentShaderType = ETR_STENCIL_SHADOW;
 	shader->setRenderTarget(RenderTargetSurface, ViewPort);
 
 	Material.org.MaterialType = video::EMT_SOLID;
@@ -2340,6 +2770,8 @@ void CBurningVideoDriver::drawStencilShadowVolume(const core::array<core::vector
 void CBurningVideoDriver::drawStencilShadow(bool clearStencilBuffer, video::SColor leftUpEdge,
 	video::SColor rightUpEdge, video::SColor leftDownEdge, video::SColor rightDownEdge)
 {
+	flushRasterizer();
+
 	if (!StencilBuffer)
 		return;
 	// draw a shadow rectangle covering the entire screen using stencil buffer
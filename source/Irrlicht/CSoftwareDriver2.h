@@ -12,6 +12,7 @@
 #include "os.h"
 #include "irrString.h"
 #include "SIrrCreationParameters.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -190,8 +191,54 @@ namespace video
 		//! selects the right triangle renderer based on the render states.
 		void setCurrentShader();
 
+		//! creates one set of triangle renderers
+		void createTriangleRenderers(IBurningShader** shader);
+
 		IBurningShader* CurrentShader;
 		IBurningShader* BurningShader[ETR2_COUNT];
+		EBurningFFShader CurrentShaderType;
+
+		// tile rasterizer
+		struct SRasterState
+		{
+			EBurningFFShader Shader;
+			SBurningShaderMaterial Material;
+		};
+
+		struct SRasterTriangle
+		{
+			s4DVertex v[3];
+			sInternalTexture IT[BURNING_MATERIAL_MAX_TEXTURES];
+			u32 State;
+		};
+
+		class CRasterJob : public IThreadJob
+		{
+		public:
+			CRasterJob(CBurningVideoDriver* driver) : Driver(driver) {}
+			virtual void runPart(u32 part, u32 thread) _IRR_OVERRIDE_
+			{
+				Driver->rasterizeTile(part, thread);
+			}
+		private:
+			CBurningVideoDriver* Driver;
+		};
+
+		//! draws a triangle with the current shader or queues it for the tile rasterizer
+		void rasterizeTriangle(const s4DVertex* a, const s4DVertex* b, const s4DVertex* c);
+
+		//! draws all queued triangles
+		void flushRasterizer();
+
+		//! draws the queued triangles touching one tile
+		void rasterizeTile(u32 tile, u32 thread);
+
+		CThreadPool* RasterizerPool;
+		core::array<IBurningShader*> TileShader;
+		core::array<SRasterState> RasterState;
+		core::array<SRasterTriangle> RasterQueue;
+		core::array< core::array<u32> > TileBin;
+		bool RasterStateDirty;
 
 		IDepthBuffer* DepthBuffer;
 		IStencilBuffer* StencilBuffer;
@@ -240,7 +287,15 @@ namespace video
 		void VertexCache_getbypass ( s4DVertex ** face );
 
 		void VertexCache_fill ( const u32 sourceIndex,const u32 destIndex );
+		void VertexCache_fillBatch ( const SCacheInfo *fill, const u32 count );
+		void VertexCache_transform ( const SCacheInfo *fill, const u32 count );
+		void VertexCache_shade ( const u32 sourceIndex, s4DVertex *dest, const u32 batchIndex );
 		s4DVertex * VertexCache_getVertex ( const u32 sourceIndex );
+		u32 VertexCache_getSlot ( const u32 sourceIndex ) const;
+		void VertexCache_buildLookup ();
+
+		// cpu supports the SSE2 vertex functions
+		bool UseSSE2;
 
 
 		// culling & clipping
@@ -13,12 +13,180 @@
 
 namespace irr
 {
+namespace video
+{
+namespace
+{
+	//! returns true for the compressed formats Burning's Video can sample
+	bool isDXTFormat(ECOLOR_FORMAT format)
+	{
+		return format == ECF_DXT1 || format == ECF_DXT2 || format == ECF_DXT3 ||
+			format == ECF_DXT4 || format == ECF_DXT5;
+	}
+
+	//! expands a R5G6B5 endpoint of a DXT color block
+	inline u32 dxtEndpoint(u32 c)
+	{
+		const u32 r = (c >> 11) & 0x1F;
+		const u32 g = (c >> 5) & 0x3F;
+		const u32 b = c & 0x1F;
+		return 0xFF000000 | ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) | (b << 3 | b >> 2);
+	}
+
+	//! weighted mean of the color channels of two endpoints
+	inline u32 dxtMix(u32 c0, u32 w0, u32 c1, u32 w1)
+	{
+		const u32 sum = w0 + w1;
+		u32 c = 0xFF000000;
+		for (u32 shift = 0; shift != 24; shift += 8)
+			c |= ((((c0 >> shift) & 0xFF) * w0 + ((c1 >> shift) & 0xFF) * w1) / sum) << shift;
+		return c;
+	}
+
+	//! decodes a 4x4 block of a DXT1 to DXT5 image to A8R8G8B8 texels in rows
+	void decodeDXTBlock(ECOLOR_FORMAT format, const u8* block, u32 texel[16])
+	{
+		// DXT2 to DXT5 start with the alpha, their colors always have 4 entries
+		const u8* color = format == ECF_DXT1 ? block : block + 8;
+
+		const u32 c0 = color[0] | color[1] << 8;
+		const u32 c1 = color[2] | color[3] << 8;
+
+		u32 palette[4];
+		palette[0] = dxtEndpoint(c0);
+		palette[1] = dxtEndpoint(c1);
+		if (c0 > c1 || format != ECF_DXT1)
+		{
+			palette[2] = dxtMix(palette[0], 2, palette[1], 1);
+			palette[3] = dxtMix(palette[0], 1, palette[1], 2);
+		}
+		else
+		{
+			palette[2] = dxtMix(palette[0], 1, palette[1], 1);
+			palette[3] = 0;
+		}
+
+		const u32 index = color[4] | color[5] << 8 | color[6] << 16 | (u32)color[7] << 24;
+		for (u32 i = 0; i != 16; ++i)
+			texel[i] = palette[(index >> (i * 2)) & 3];
+
+		switch (format)
+		{
+		case ECF_DXT2:
+		case ECF_DXT3:
+			// explicit 4 bit alpha
+			for (u32 i = 0; i != 16; ++i)
+			{
+				const u32 a = (block[i >> 1] >> ((i & 1) * 4)) & 0xF;
+				texel[i] = (texel[i] & 0x00FFFFFF) | (a * 0x11) << 24;
+			}
+			break;
+		case ECF_DXT4:
+		case ECF_DXT5:
+		{
+			// 3 bit indices into 8 interpolated alpha values
+			u32 alpha[8];
+			alpha[0] = block[0];
+			alpha[1] = block[1];
+			if (alpha[0] > alpha[1])
+			{
+				for (u32 k = 1; k != 7; ++k)
+					alpha[k + 1] = ((7 - k) * alpha[0] + k * alpha[1]) / 7;
+			}
+			else
+			{
+				for (u32 k = 1; k != 5; ++k)
+					alpha[k + 1] = ((5 - k) * alpha[0] + k * alpha[1]) / 5;
+				alpha[6] = 0;
+				alpha[7] = 0xFF;
+			}
+
+			const u32 indexLow = block[2] | block[3] << 8 | block[4] << 16;
+			const u32 indexHigh = block[5] | block[6] << 8 | block[7] << 16;
+			for (u32 i = 0; i != 16; ++i)
+			{
+				const u32 a = alpha[((i < 8 ? indexLow : indexHigh) >> ((i & 7) * 3)) & 7];
+				texel[i] = (texel[i] & 0x00FFFFFF) | a << 24;
+			}
+		} break;
+		default:
+			break;
+		}
+	}
+
+	//! returns the size of a DXT block in bytes
+	inline u32 dxtBlockSize(ECOLOR_FORMAT format)
+	{
+		return format == ECF_DXT1 ? 8 : 16;
+	}
+
+	//! decodes a DXT compressed image to A8R8G8B8
+	CImage* decodeDXTImage(ECOLOR_FORMAT format, const core::dimension2d<u32>& size, const void* data)
+	{
+		CImage* image = new CImage(ECF_A8R8G8B8, size);
+
+		u32* dst = (u32*) image->getData();
+		const u8* block = (const u8*) data;
+		const u32 blockSize = dxtBlockSize(format);
+		u32 texel[16];
+
+		for (u32 y = 0; y < size.Height; y += 4)
+		{
+			for (u32 x = 0; x < size.Width; x += 4)
+			{
+				decodeDXTBlock(format, block, texel);
+				block += blockSize;
+
+				const u32 w = core::min_(4u, size.Width - x);
+				const u32 h = core::min_(4u, size.Height - y);
+				for (u32 j = 0; j != h; ++j)
+					memcpy(dst + (y + j) * size.Width + x, texel + j * 4, w * sizeof(u32));
+			}
+		}
+
+		return image;
+	}
+}
+} // end namespace video
+
+
+//! decodes the texel at a byte offset of the uncompressed level through the block cache
+tVideoSample getTexel_block(const sInternalTexture* t, const u32 ofs)
+{
+	const u32 x = (ofs & ((1 << t->pitchlog2) - 1)) >> VIDEO_SAMPLE_GRANULARITY;
+	const u32 y = ofs >> t->pitchlog2;
+	const u32 blocksPerRow = ((1 << (t->pitchlog2 - VIDEO_SAMPLE_GRANULARITY)) + 3) >> 2;
+
+	const u32 block = (y >> 2) * blocksPerRow + (x >> 2);
+	const u32 entry = ((x >> 2) & 7) | ((y >> 2) & 7) << 3;
+
+	sTexelBlockCache* cache = t->blockCache;
+	if (cache->tag[entry] != block + 1)
+	{
+		const video::ECOLOR_FORMAT format = (video::ECOLOR_FORMAT) t->blockFormat;
+		u32 texel[16];
+		video::decodeDXTBlock(format, (const u8*) t->data + block * video::dxtBlockSize(format), texel);
+
+		for (u32 i = 0; i != 16; ++i)
+		{
+#ifdef SOFTWARE_DRIVER_2_32BIT
+			cache->texel[entry][i] = texel[i];
+#else
+			cache->texel[entry][i] = video::A8R8G8B8toA1R5G5B5(texel[i]);
+#endif
+		}
+		cache->tag[entry] = block + 1;
+	}
+
+	return cache->texel[entry][(y & 3) << 2 | (x & 3)];
+}
+
 namespace video
 {
 
 //! constructor
 CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name, u32 flags)
-	: ITexture(name, ETT_2D), MipMapLOD(0), Flags ( flags ), OriginalFormat(video::ECF_UNKNOWN)
+	: ITexture(name, ETT_2D), DecodedImage(0), MipMapLOD(0), Flags ( flags ), OriginalFormat(video::ECF_UNKNOWN)
 {
 	#ifdef _DEBUG
 	setDebugName("CSoftwareTexture2");
@@ -35,57 +203,79 @@ CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name, u32 fl
 	memset32 ( MipMap, 0, sizeof ( MipMap ) );
 
 	if (image)
-	{
-		bool IsCompressed = false;
+		loadImage(image);
+}
 
-		if (IImage::isCompressedFormat(image->getColorFormat()))
-		{
-			os::Printer::log("Texture compression not available.", ELL_ERROR);
-			IsCompressed = true;
-		}
 
-		OriginalSize = image->getDimension();
-		OriginalFormat = image->getColorFormat();
+//! creates the first level from the image and generates the others
+void CSoftwareTexture2::loadImage(IImage* image)
+{
+	bool IsCompressed = false;
 
-		core::dimension2d<u32> optSize(
-				OriginalSize.getOptimalSize(0 != (Flags & NP2_SIZE),
-				false, true,
-				SOFTWARE_DRIVER_2_TEXTURE_MAXSIZE)
-			);
+	OriginalSize = image->getDimension();
+	OriginalFormat = image->getColorFormat();
 
-		if (OriginalSize == optSize)
-		{
-			MipMap[0] = new CImage(BURNINGSHADER_COLOR_FORMAT, image->getDimension());
+	// DXT textures are decoded while sampling, other formats are dropped
+	IImage* source = image;
+	if (IImage::isCompressedFormat(OriginalFormat) && !isDXTFormat(OriginalFormat))
+	{
+		os::Printer::log("Texture compression not available.", ELL_ERROR);
+		IsCompressed = true;
+	}
 
-			if (!IsCompressed)
-				image->copyTo(MipMap[0]);
-		}
-		else
-		{
-			char buf[256];
-			core::stringw showName ( name );
-			snprintf_irr ( buf, 256, "Burningvideo: Warning Texture %ls reformat %dx%d -> %dx%d,%d",
-							showName.c_str(),
-							OriginalSize.Width, OriginalSize.Height, optSize.Width, optSize.Height,
-							BURNINGSHADER_COLOR_FORMAT
-						);
-
-			os::Printer::log ( buf, ELL_WARNING );
-			MipMap[0] = new CImage(BURNINGSHADER_COLOR_FORMAT, optSize);
-
-			if (!IsCompressed)
-				image->copyToScalingBoxFilter ( MipMap[0],0, false );
-		}
+	core::dimension2d<u32> optSize(
+			OriginalSize.getOptimalSize(0 != (Flags & NP2_SIZE),
+			false, true,
+			SOFTWARE_DRIVER_2_TEXTURE_MAXSIZE)
+		);
 
-		Size = MipMap[MipMapLOD]->getDimension();
-		Pitch = MipMap[MipMapLOD]->getPitch();
+	// sampling the blocks needs a power of two size
+	const bool keepCompressed = isDXTFormat(OriginalFormat) &&
+		OriginalSize == optSize && optSize.getOptimalSize(true, false) == optSize;
 
-		OrigImageDataSizeInPixels = (f32) 0.3f * MipMap[0]->getImageDataSizeInPixels();
+	if (isDXTFormat(OriginalFormat) && !keepCompressed)
+		source = decodeDXTImage(OriginalFormat, OriginalSize, image->getData());
 
-		HasMipMaps = (Flags & GEN_MIPMAP) != 0;
+	if (keepCompressed)
+	{
+		MipMap[0] = new CImage(OriginalFormat, OriginalSize, image->getData(), false);
+		ColorFormat = OriginalFormat;
+	}
+	else if (OriginalSize == optSize)
+	{
+		MipMap[0] = new CImage(BURNINGSHADER_COLOR_FORMAT, image->getDimension());
 
-		regenerateMipMapLevels(image->getMipMapsData());
+		if (!IsCompressed)
+			source->copyTo(MipMap[0]);
+	}
+	else
+	{
+		char buf[256];
+		core::stringw showName ( NamedPath.getPath() );
+		snprintf_irr ( buf, 256, "Burningvideo: Warning Texture %ls reformat %dx%d -> %dx%d,%d",
+						showName.c_str(),
+						OriginalSize.Width, OriginalSize.Height, optSize.Width, optSize.Height,
+						BURNINGSHADER_COLOR_FORMAT
+					);
+
+		os::Printer::log ( buf, ELL_WARNING );
+		MipMap[0] = new CImage(BURNINGSHADER_COLOR_FORMAT, optSize);
+
+		if (!IsCompressed)
+			source->copyToScalingBoxFilter ( MipMap[0],0, false );
 	}
+
+	if (source != image)
+		source->drop();
+
+	Size = MipMap[MipMapLOD]->getDimension();
+	Pitch = MipMap[MipMapLOD]->getPitch();
+
+	OrigImageDataSizeInPixels = (f32) 0.3f * MipMap[0]->getImageDataSizeInPixels();
+
+	HasMipMaps = (Flags & GEN_MIPMAP) != 0;
+
+	regenerateMipMapLevels(image->getMipMapsData());
 }
 
 
@@ -97,6 +287,51 @@ CSoftwareTexture2::~CSoftwareTexture2()
 		if ( MipMap[i] )
 			MipMap[i]->drop();
 	}
+
+	if (DecodedImage)
+		DecodedImage->drop();
+}
+
+
+//! releases all levels, the texture is loaded again with restoreData
+bool CSoftwareTexture2::evictData()
+{
+	for ( s32 i = 0; i!= SOFTWARE_DRIVER_2_MIPMAPPING_MAX; ++i )
+	{
+		if ( MipMap[i] )
+		{
+			MipMap[i]->drop();
+			MipMap[i] = 0;
+		}
+	}
+
+	unlock();
+	MipMapLOD = 0;
+	return true;
+}
+
+
+//! creates the levels of an evicted texture again
+bool CSoftwareTexture2::restoreData(const core::array<IImage*>& images)
+{
+	loadImage(images[0]);
+	return MipMap[0] != 0;
+}
+
+
+//! returns unoptimized surface
+CImage* CSoftwareTexture2::getImage() const
+{
+	if (!MipMap[0])
+		return 0;
+
+	if (!IImage::isCompressedFormat(MipMap[0]->getColorFormat()))
+		return MipMap[0];
+
+	if (!DecodedImage)
+		DecodedImage = decodeDXTImage(MipMap[0]->getColorFormat(), MipMap[0]->getDimension(), MipMap[0]->getData());
+
+	return DecodedImage;
 }
 
 
@@ -104,7 +339,7 @@ CSoftwareTexture2::~CSoftwareTexture2()
 //! modifying the texture
 void CSoftwareTexture2::regenerateMipMapLevels(void* data, u32 layer)
 {
-	if (!hasMipMaps())
+	if (!hasMipMaps() || !MipMap[0])
 		return;
 
 	s32 i;
@@ -116,18 +351,47 @@ void CSoftwareTexture2::regenerateMipMapLevels(void* data, u32 layer)
 			MipMap[i]->drop();
 	}
 
+	// compressed levels are kept compressed when the file has them in the
+	// same size, the others are decoded
+	const bool keepCompressed = IImage::isCompressedFormat(MipMap[0]->getColorFormat());
+
+	// generated levels are halved from the decoded first level, until they
+	// have the size of the level
+	IImage* source = 0;
+	const E_MIP_MAP_FILTER filter = (Flags & MIPMAP_QUALITY) ? EMMF_KAISER : EMMF_BOX;
+
 	core::dimension2d<u32> newSize;
 	core::dimension2d<u32> origSize = Size;
 
 	for (i=1; i < SOFTWARE_DRIVER_2_MIPMAPPING_MAX; ++i)
 	{
+		// the data ends with the 1x1 level
+		if (origSize.Width == 1 && origSize.Height == 1)
+			data = 0;
+
 		newSize = MipMap[i-1]->getDimension();
 		newSize.Width = core::s32_max ( 1, newSize.Width >> SOFTWARE_DRIVER_2_MIPMAPPING_SCALE );
 		newSize.Height = core::s32_max ( 1, newSize.Height >> SOFTWARE_DRIVER_2_MIPMAPPING_SCALE );
 		origSize.Width = core::s32_max(1, origSize.Width >> 1);
 		origSize.Height = core::s32_max(1, origSize.Height >> 1);
 
-		if (data)
+		if (data && isDXTFormat(OriginalFormat))
+		{
+			if (keepCompressed && origSize == newSize)
+				MipMap[i] = new CImage(OriginalFormat, newSize, data, false);
+			else
+			{
+				IImage* tmpImage = decodeDXTImage(OriginalFormat, origSize, data);
+				MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
+				if (origSize==newSize)
+					tmpImage->copyTo(MipMap[i]);
+				else
+					tmpImage->copyToScalingBoxFilter(MipMap[i]);
+				tmpImage->drop();
+			}
+			data = (u8*)data + IImage::getDataSizeFromFormat(OriginalFormat, origSize.Width, origSize.Height);
+		}
+		else if (data && !IImage::isCompressedFormat(OriginalFormat))
 		{
 			if (OriginalFormat != BURNINGSHADER_COLOR_FORMAT)
 			{
@@ -151,17 +415,34 @@ void CSoftwareTexture2::regenerateMipMapLevels(void* data, u32 layer)
 					tmpImage->drop();
 				}
 			}
-			data = (u8*)data +origSize.getArea()*IImage::getBitsPerPixelFromFormat(OriginalFormat)/8;
+			data = (u8*)data + IImage::getDataSizeFromFormat(OriginalFormat, origSize.Width, origSize.Height);
 		}
 		else
 		{
-			MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
+			if (!source)
+			{
+				source = keepCompressed ? decodeDXTImage(OriginalFormat, MipMap[0]->getDimension(), MipMap[0]->getData()) : MipMap[0];
+				if (source == MipMap[0])
+					source->grab();
+			}
+
+			while (source->getDimension() != newSize)
+			{
+				const core::dimension2d<u32> half(core::max_(source->getDimension().Width >> 1, 1u),
+					core::max_(source->getDimension().Height >> 1, 1u));
+				IImage* next = new CImage(ECF_A8R8G8B8, half);
+				source->copyToMipMap(next, filter);
+				source->drop();
+				source = next;
+			}
 
-			//static u32 color[] = { 0, 0xFFFF0000, 0xFF00FF00,0xFF0000FF,0xFFFFFF00,0xFFFF00FF,0xFF00FFFF,0xFF0F0F0F };
-			MipMap[i]->fill ( 0 );
-			MipMap[0]->copyToScalingBoxFilter( MipMap[i], 0, false );
+			MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
+			source->copyTo(MipMap[i]);
 		}
 	}
+
+	if (source)
+		source->drop();
 }
 
 
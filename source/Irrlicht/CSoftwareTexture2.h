@@ -31,6 +31,7 @@ public:
 		GEN_MIPMAP	= 1,
 		IS_RENDERTARGET	= 2,
 		NP2_SIZE	= 4,
+		MIPMAP_QUALITY	= 8,
 	};
 	CSoftwareTexture2(IImage* surface, const io::path& name, u32 flags);
 
@@ -40,6 +41,11 @@ public:
 	//! lock function
 	virtual void* lock(E_TEXTURE_LOCK_MODE mode, u32 mipmapLevel, u32 layer, E_TEXTURE_LOCK_FLAGS lockFlags = ETLF_FLIP_Y_UP_RTT) _IRR_OVERRIDE_
 	{
+		if (Evicted)
+			return 0;
+
+		LockedForWriting |= (mode != ETLM_READ_ONLY);
+
 		if (Flags & GEN_MIPMAP)
 		{
 			MipMapLOD = mipmapLevel;
@@ -53,6 +59,11 @@ public:
 	//! unlock function
 	virtual void unlock() _IRR_OVERRIDE_
 	{
+		if (DecodedImage)
+		{
+			DecodedImage->drop();
+			DecodedImage = 0;
+		}
 	}
 
 	//! Returns the size of the largest mipmap.
@@ -63,10 +74,8 @@ public:
 	}
 
 	//! returns unoptimized surface
-	virtual CImage* getImage() const
-	{
-		return MipMap[0];
-	}
+	/** DXT compressed textures return a decoded copy, created on first use. */
+	virtual CImage* getImage() const;
 
 	//! returns texture surface
 	virtual CImage* getTexture() const
@@ -76,10 +85,17 @@ public:
 
 	virtual void regenerateMipMapLevels(void* data = 0, u32 layer = 0) _IRR_OVERRIDE_;
 
+protected:
+	virtual bool evictData() _IRR_OVERRIDE_;
+	virtual bool restoreData(const core::array<IImage*>& images) _IRR_OVERRIDE_;
+
 private:
+	void loadImage(IImage* image);
+
 	f32 OrigImageDataSizeInPixels;
 
 	CImage * MipMap[SOFTWARE_DRIVER_2_MIPMAPPING_MAX];
+	mutable CImage * DecodedImage;
 
 	u32 MipMapLOD;
 	u32 Flags;
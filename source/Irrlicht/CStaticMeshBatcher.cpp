@@ -0,0 +1,551 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CStaticMeshBatcher.h"
+#include "ISceneManager.h"
+#include "IMeshSceneNode.h"
+#include "IMeshManipulator.h"
+#include "IVideoDriver.h"
+#include "IMaterialRenderer.h"
+#include "CMeshBuffer.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! number of frames a node has to keep its transformation before it is batched
+static const u32 STATIC_BATCH_STABLE_FRAMES = 3;
+
+//! Culling proxy of one grid cell, not part of the scene graph
+class CStaticBatchCellSceneNode : public ISceneNode
+{
+public:
+
+	CStaticBatchCellSceneNode(ISceneManager* mgr)
+		: ISceneNode(0, mgr)
+	{
+		#ifdef _DEBUG
+		setDebugName("CStaticBatchCellSceneNode");
+		#endif
+	}
+
+	//! batches are drawn by the scene manager
+	virtual void render() _IRR_OVERRIDE_ {}
+
+	virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_
+	{
+		return Box;
+	}
+
+	core::aabbox3d<f32> Box;
+};
+
+
+namespace
+{
+	inline void transformVertex(video::S3DVertex& v, const core::matrix4& m)
+	{
+		m.transformVect(v.Pos);
+		m.rotateVect(v.Normal);
+		v.Normal.normalize();
+	}
+
+	inline void transformVertex(video::S3DVertexTangents& v, const core::matrix4& m)
+	{
+		m.transformVect(v.Pos);
+		m.rotateVect(v.Normal);
+		v.Normal.normalize();
+		m.rotateVect(v.Tangent);
+		v.Tangent.normalize();
+		m.rotateVect(v.Binormal);
+		v.Binormal.normalize();
+	}
+
+	//! appends a buffer to a batch, transformed into world space
+	template <class T>
+	void appendTransformed(CMeshBuffer<T>* dst, const IMeshBuffer* src, const core::matrix4& m)
+	{
+		const u32 base = dst->Vertices.size();
+		const u32 vertexCount = src->getVertexCount();
+		const T* v = (const T*) src->getVertices();
+
+		dst->Vertices.reallocate(base + vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			T vertex = v[i];
+			transformVertex(vertex, m);
+			dst->Vertices.push_back(vertex);
+		}
+
+		const u16* indices = src->getIndices();
+		const u32 indexCount = src->getIndexCount();
+
+		dst->Indices.reallocate(dst->Indices.size() + indexCount);
+		for (u32 i=0; i<indexCount; ++i)
+			dst->Indices.push_back((u16)(indices[i] + base));
+	}
+}
+
+
+//! constructor
+CStaticMeshBatcher::CStaticMeshBatcher(ISceneManager* mgr)
+: SceneManager(mgr), CellSize(0.f), Frame(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CStaticMeshBatcher");
+	#endif
+}
+
+
+//! destructor
+CStaticMeshBatcher::~CStaticMeshBatcher()
+{
+	clear();
+}
+
+
+//! sets the edge length of the grid cells, a change rebuilds all batches
+void CStaticMeshBatcher::setCellSize(f32 size)
+{
+	if (size == CellSize)
+		return;
+
+	clear();
+	CellSize = size;
+}
+
+
+//! starts a new frame, call before the nodes are registered
+void CStaticMeshBatcher::beginFrame()
+{
+	++Frame;
+}
+
+
+//! returns if the solid buffers of the node are drawn by an up to date batch
+bool CStaticMeshBatcher::isBatched(IMeshSceneNode* node)
+{
+	core::map<IMeshSceneNode*, SEntry*>::Node* n = Entries.find(node);
+	if (!n)
+		return false;
+
+	SEntry* entry = n->getValue();
+	if (!matches(entry))
+		return false;
+
+	entry->Seen = Frame;
+	return true;
+}
+
+
+//! updates the batches after all nodes were registered
+void CStaticMeshBatcher::update(const core::array<IMeshSceneNode*>& pending)
+{
+	u32 i;
+
+	// nodes which were not registered, or which changed
+	core::array<SEntry*> removed;
+	core::map<IMeshSceneNode*, SEntry*>::Iterator eit = Entries.getIterator();
+	for (; !eit.atEnd(); eit++)
+	{
+		if (eit->getValue()->Seen != Frame)
+			removed.push_back(eit->getValue());
+	}
+	for (i=0; i<removed.size(); ++i)
+		removeEntry(removed[i]);
+
+	// rebuild changed cells only
+	core::array<SCell*> empty;
+	core::map<u64, SCell*>::Iterator it = Cells.getIterator();
+	for (; !it.atEnd(); it++)
+	{
+		SCell* cell = it->getValue();
+		if (cell->Entries.empty())
+			empty.push_back(cell);
+		else if (cell->Dirty)
+			rebuildCell(cell);
+	}
+
+	for (i=0; i<empty.size(); ++i)
+	{
+		Cells.remove(empty[i]->Key);
+		clearBuffers(empty[i]);
+		empty[i]->Node->drop();
+		delete empty[i];
+	}
+
+	// wait until new nodes stopped moving. New nodes drew themselves in
+	// this frame, so their cells are rebuilt in the next one.
+	for (i=0; i<pending.size(); ++i)
+	{
+		IMeshSceneNode* node = pending[i];
+		if (!canBatch(node))
+			continue;
+
+		core::map<IMeshSceneNode*, SCandidate>::Node* c = Candidates.find(node);
+		if (c && c->getValue().Transform == node->getAbsoluteTransformation())
+		{
+			SCandidate& candidate = c->getValue();
+			candidate.Seen = Frame;
+			if (++candidate.Frames >= STATIC_BATCH_STABLE_FRAMES)
+			{
+				Candidates.remove(c);
+				addNode(node);
+			}
+		}
+		else
+		{
+			SCandidate candidate;
+			candidate.Transform = node->getAbsoluteTransformation();
+			candidate.Frames = 1;
+			candidate.Seen = Frame;
+			Candidates.set(node, candidate);
+		}
+	}
+
+	core::array<IMeshSceneNode*> lost;
+	core::map<IMeshSceneNode*, SCandidate>::Iterator cit = Candidates.getIterator();
+	for (; !cit.atEnd(); cit++)
+	{
+		if (cit->getValue().Seen != Frame)
+			lost.push_back(cit->getKey());
+	}
+	for (i=0; i<lost.size(); ++i)
+		Candidates.remove(lost[i]);
+}
+
+
+//! registers the buffers of all visible cells for rendering
+void CStaticMeshBatcher::registerCells()
+{
+	core::map<u64, SCell*>::Iterator it = Cells.getIterator();
+	for (; !it.atEnd(); it++)
+	{
+		SCell* cell = it->getValue();
+		if (cell->Buffers.empty() || SceneManager->isCulled(cell->Node))
+			continue;
+
+		for (u32 i=0; i<cell->Buffers.size(); ++i)
+		{
+			IMeshBuffer* mb = cell->Buffers[i];
+			SceneManager->registerMeshBufferForRendering(cell->Node, mb, mb->getMaterial());
+		}
+	}
+}
+
+
+//! removes all batches
+void CStaticMeshBatcher::clear()
+{
+	core::map<IMeshSceneNode*, SEntry*>::Iterator eit = Entries.getIterator();
+	for (; !eit.atEnd(); eit++)
+	{
+		eit->getValue()->Node->drop();
+		delete eit->getValue();
+	}
+	Entries.clear();
+	Candidates.clear();
+
+	core::map<u64, SCell*>::Iterator it = Cells.getIterator();
+	for (; !it.atEnd(); it++)
+	{
+		clearBuffers(it->getValue());
+		it->getValue()->Node->drop();
+		delete it->getValue();
+	}
+	Cells.clear();
+
+	core::map<IMesh*, SWelded>::Iterator wit = Welded.getIterator();
+	for (; !wit.atEnd(); wit++)
+	{
+		wit->getValue().Mesh->drop();
+		wit->getKey()->drop();
+	}
+	Welded.clear();
+}
+
+
+//! only triangle lists with 16 bit indices and at least one solid buffer
+bool CStaticMeshBatcher::canBatch(IMeshSceneNode* node) const
+{
+	IMesh* mesh = node->getMesh();
+	if (!mesh)
+		return false;
+
+	bool solid = false;
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(i);
+		if (!mb || mb->getIndexType() != video::EIT_16BIT ||
+			mb->getPrimitiveType() != EPT_TRIANGLES ||
+			mb->getVertexType() > video::EVT_TANGENTS)
+			return false;
+
+		solid |= isSolid(node->getMaterial(i));
+	}
+
+	return solid;
+}
+
+
+//! same test as in CMeshSceneNode::render()
+bool CStaticMeshBatcher::isSolid(const video::SMaterial& material) const
+{
+	video::IMaterialRenderer* rnd = SceneManager->getVideoDriver()->getMaterialRenderer(material.MaterialType);
+	return !(rnd && rnd->isTransparent());
+}
+
+
+//! stores the state of the node which is baked into the batches
+void CStaticMeshBatcher::record(SEntry* entry) const
+{
+	IMeshSceneNode* node = entry->Node;
+
+	entry->Mesh = node->getMesh();
+	entry->Transform = node->getAbsoluteTransformation();
+	entry->ReadOnlyMaterials = node->isReadOnlyMaterials();
+	entry->Materials.clear();
+	entry->ChangedIDs.clear();
+
+	for (u32 i=0; i<entry->Mesh->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* mb = entry->Mesh->getMeshBuffer(i);
+		entry->Materials.push_back(node->getMaterial(i));
+		entry->ChangedIDs.push_back(mb->getChangedID_Vertex());
+		entry->ChangedIDs.push_back(mb->getChangedID_Index());
+	}
+}
+
+
+//! checks if the node still looks like it did when it was batched
+bool CStaticMeshBatcher::matches(const SEntry* entry) const
+{
+	IMeshSceneNode* node = entry->Node;
+
+	if (node->getMesh() != entry->Mesh ||
+		node->isReadOnlyMaterials() != entry->ReadOnlyMaterials ||
+		node->getAbsoluteTransformation() != entry->Transform ||
+		entry->Mesh->getMeshBufferCount() != entry->Materials.size())
+		return false;
+
+	for (u32 i=0; i<entry->Materials.size(); ++i)
+	{
+		const IMeshBuffer* mb = entry->Mesh->getMeshBuffer(i);
+		if (mb->getChangedID_Vertex() != entry->ChangedIDs[i*2] ||
+			mb->getChangedID_Index() != entry->ChangedIDs[i*2+1] ||
+			node->getMaterial(i) != entry->Materials[i])
+			return false;
+	}
+
+	return true;
+}
+
+
+void CStaticMeshBatcher::addNode(IMeshSceneNode* node)
+{
+	SEntry* entry = new SEntry;
+	entry->Node = node;
+	node->grab();
+	record(entry);
+	entry->Seen = Frame;
+
+	getWelded(entry->Mesh);
+	Welded.find(entry->Mesh)->getValue().Users += 1;
+
+	const u64 key = getCellKey(node->getTransformedBoundingBox().getCenter());
+	core::map<u64, SCell*>::Node* n = Cells.find(key);
+	SCell* cell;
+	if (n)
+		cell = n->getValue();
+	else
+	{
+		cell = new SCell;
+		cell->Key = key;
+		cell->Node = new CStaticBatchCellSceneNode(SceneManager);
+		cell->Dirty = true;
+		Cells.insert(key, cell);
+	}
+
+	cell->Entries.push_back(entry);
+	cell->Dirty = true;
+	entry->Cell = cell;
+
+	Entries.insert(node, entry);
+}
+
+
+void CStaticMeshBatcher::removeEntry(SEntry* entry)
+{
+	SCell* cell = entry->Cell;
+	const s32 index = cell->Entries.linear_search(entry);
+	if (index != -1)
+		cell->Entries.erase(index);
+	cell->Dirty = true;
+
+	releaseWelded(entry->Mesh);
+	Entries.remove(entry->Node);
+	entry->Node->drop();
+	delete entry;
+}
+
+
+//! appends the welded solid buffers of all nodes of the cell to its batches
+void CStaticMeshBatcher::rebuildCell(SCell* cell)
+{
+	clearBuffers(cell);
+
+	for (u32 e=0; e<cell->Entries.size(); ++e)
+	{
+		const SEntry* entry = cell->Entries[e];
+		IMesh* welded = getWelded(entry->Mesh);
+
+		for (u32 i=0; i<welded->getMeshBufferCount(); ++i)
+		{
+			const video::SMaterial& material = entry->Materials[i];
+			if (!isSolid(material))
+				continue;
+
+			const IMeshBuffer* src = welded->getMeshBuffer(i);
+			if (!src->getVertexCount())
+				continue;
+
+			// find a batch with room left
+			IMeshBuffer* dst = 0;
+			for (u32 b=0; b<cell->Buffers.size(); ++b)
+			{
+				IMeshBuffer* mb = cell->Buffers[b];
+				if (mb->getVertexType() == src->getVertexType() &&
+					mb->getVertexCount() + src->getVertexCount() <= 65536 &&
+					mb->getMaterial() == material)
+				{
+					dst = mb;
+					break;
+				}
+			}
+
+			if (!dst)
+			{
+				switch (src->getVertexType())
+				{
+				case video::EVT_STANDARD:
+					dst = new SMeshBuffer();
+					break;
+				case video::EVT_2TCOORDS:
+					dst = new SMeshBufferLightMap();
+					break;
+				case video::EVT_TANGENTS:
+					dst = new SMeshBufferTangents();
+					break;
+				}
+				dst->getMaterial() = material;
+				dst->setHardwareMappingHint(EHM_STATIC);
+				cell->Buffers.push_back(dst);
+			}
+
+			switch (src->getVertexType())
+			{
+			case video::EVT_STANDARD:
+				appendTransformed((SMeshBuffer*)dst, src, entry->Transform);
+				break;
+			case video::EVT_2TCOORDS:
+				appendTransformed((SMeshBufferLightMap*)dst, src, entry->Transform);
+				break;
+			case video::EVT_TANGENTS:
+				appendTransformed((SMeshBufferTangents*)dst, src, entry->Transform);
+				break;
+			}
+		}
+	}
+
+	core::aabbox3d<f32>& box = cell->Node->Box;
+	for (u32 b=0; b<cell->Buffers.size(); ++b)
+	{
+		IMeshBuffer* mb = cell->Buffers[b];
+		mb->recalculateBoundingBox();
+		mb->setDirty();
+
+		if (0 == b)
+			box.reset(mb->getBoundingBox());
+		else
+			box.addInternalBox(mb->getBoundingBox());
+	}
+
+	cell->Dirty = false;
+}
+
+
+void CStaticMeshBatcher::clearBuffers(SCell* cell)
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	for (u32 i=0; i<cell->Buffers.size(); ++i)
+	{
+		driver->removeHardwareBuffer(cell->Buffers[i]);
+		cell->Buffers[i]->drop();
+	}
+	cell->Buffers.set_used(0);
+}
+
+
+//! returns the welded copy of a mesh, welds it again when it was changed
+IMesh* CStaticMeshBatcher::getWelded(IMesh* mesh)
+{
+	core::array<u32> ids;
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		ids.push_back(mesh->getMeshBuffer(i)->getChangedID_Vertex());
+		ids.push_back(mesh->getMeshBuffer(i)->getChangedID_Index());
+	}
+
+	core::map<IMesh*, SWelded>::Node* n = Welded.find(mesh);
+	if (n && n->getValue().ChangedIDs == ids)
+		return n->getValue().Mesh;
+
+	IMesh* welded = SceneManager->getMeshManipulator()->createMeshWelded(mesh);
+
+	if (n)
+	{
+		n->getValue().Mesh->drop();
+		n->getValue().Mesh = welded;
+		n->getValue().ChangedIDs = ids;
+	}
+	else
+	{
+		SWelded w;
+		w.Mesh = welded;
+		w.ChangedIDs = ids;
+		w.Users = 0;
+		mesh->grab();
+		Welded.insert(mesh, w);
+	}
+
+	return welded;
+}
+
+
+void CStaticMeshBatcher::releaseWelded(IMesh* mesh)
+{
+	core::map<IMesh*, SWelded>::Node* n = Welded.find(mesh);
+	if (!n || --n->getValue().Users)
+		return;
+
+	n->getValue().Mesh->drop();
+	Welded.remove(n);
+	mesh->drop();
+}
+
+
+u64 CStaticMeshBatcher::getCellKey(const core::vector3df& pos) const
+{
+	const u64 x = (u32)core::floor32(pos.X / CellSize) & 0x1FFFFF;
+	const u64 y = (u32)core::floor32(pos.Y / CellSize) & 0x1FFFFF;
+	const u64 z = (u32)core::floor32(pos.Z / CellSize) & 0x1FFFFF;
+	return (x << 42) | (y << 21) | z;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
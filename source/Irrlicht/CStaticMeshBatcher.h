@@ -0,0 +1,139 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_STATIC_MESH_BATCHER_H_INCLUDED__
+#define __C_STATIC_MESH_BATCHER_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "irrArray.h"
+#include "irrMap.h"
+#include "matrix4.h"
+#include "SMaterial.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ISceneManager;
+	class IMeshSceneNode;
+	class IMesh;
+	class IMeshBuffer;
+	class CStaticBatchCellSceneNode;
+
+	//! Merges the solid mesh buffers of static mesh scene nodes into world space batches
+	/** Nodes are sorted into the cells of a uniform grid, so batches can still
+	be culled. Inside of a cell, all buffers with equal material and vertex
+	type are appended to a few large buffers. The geometry of each mesh is
+	welded once with the mesh manipulator before it is copied into batches.
+	A node joins the batches after its transformation did not change for a
+	few frames. A cell is rebuilt when one of its nodes moves, changes its
+	mesh or materials, or is not registered for rendering anymore. */
+	class CStaticMeshBatcher : public virtual IReferenceCounted
+	{
+	public:
+
+		//! constructor
+		CStaticMeshBatcher(ISceneManager* mgr);
+
+		//! destructor
+		virtual ~CStaticMeshBatcher();
+
+		//! sets the edge length of the grid cells, a change rebuilds all batches
+		void setCellSize(f32 size);
+
+		//! starts a new frame, call before the nodes are registered
+		void beginFrame();
+
+		//! returns if the solid buffers of the node are drawn by an up to date batch
+		/** Only reads the batches, so it may be called by several threads at
+		once as long as each node is checked by one thread only. */
+		bool isBatched(IMeshSceneNode* node);
+
+		//! updates the batches after all nodes were registered
+		/** \param pending Registered nodes which were not drawn by a batch. */
+		void update(const core::array<IMeshSceneNode*>& pending);
+
+		//! registers the buffers of all visible cells for rendering
+		void registerCells();
+
+		//! removes all batches
+		void clear();
+
+		//! returns the number of nodes drawn by batches
+		u32 getBatchedNodeCount() const { return Entries.size(); }
+
+	private:
+
+		struct SCell;
+
+		//! a batched node, with everything needed to notice changes
+		struct SEntry
+		{
+			IMeshSceneNode* Node;
+			IMesh* Mesh;
+			core::matrix4 Transform;
+			core::array<video::SMaterial> Materials;
+			core::array<u32> ChangedIDs;
+			bool ReadOnlyMaterials;
+			SCell* Cell;
+			u32 Seen;
+		};
+
+		//! a node waiting for its transformation to become stable
+		struct SCandidate
+		{
+			core::matrix4 Transform;
+			u32 Frames;
+			u32 Seen;
+		};
+
+		//! welded copy of a mesh used by batched nodes
+		struct SWelded
+		{
+			IMesh* Mesh;
+			core::array<u32> ChangedIDs;
+			u32 Users;
+		};
+
+		//! one grid cell with its batches
+		struct SCell
+		{
+			u64 Key;
+			CStaticBatchCellSceneNode* Node;
+			core::array<SEntry*> Entries;
+			core::array<IMeshBuffer*> Buffers;
+			bool Dirty;
+		};
+
+		bool canBatch(IMeshSceneNode* node) const;
+		bool isSolid(const video::SMaterial& material) const;
+		void record(SEntry* entry) const;
+		bool matches(const SEntry* entry) const;
+
+		void addNode(IMeshSceneNode* node);
+		void removeEntry(SEntry* entry);
+		void rebuildCell(SCell* cell);
+		void clearBuffers(SCell* cell);
+
+		IMesh* getWelded(IMesh* mesh);
+		void releaseWelded(IMesh* mesh);
+
+		u64 getCellKey(const core::vector3df& pos) const;
+
+		ISceneManager* SceneManager;
+
+		core::map<IMeshSceneNode*, SEntry*> Entries;
+		core::map<IMeshSceneNode*, SCandidate> Candidates;
+		core::map<IMesh*, SWelded> Welded;
+		core::map<u64, SCell*> Cells;
+
+		f32 CellSize;
+		u32 Frame;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -68,6 +68,12 @@
 
 #endif
 
+// sse2 span function for this render case
+#if defined ( SOFTWARE_DRIVER_2_SSE2 ) && defined ( CMP_W ) && defined ( WRITE_W ) && defined ( INVERSE_W ) && \
+	defined ( IPOL_C0 ) && !defined ( IPOL_T0 ) && !defined ( IRRLICHT_FAST_MATH )
+	#define SSE2_SPAN
+#endif
+
 
 namespace irr
 {
@@ -88,6 +94,10 @@ public:
 
 private:
 	void scanline_bilinear ();
+#ifdef SSE2_SPAN
+	s32 scanline_bilinear_sse2 ( tVideoSample *dst, fp24 *z, s32 count,
+		const fp24 slopeW, const sVec4 &slopeC );
+#endif
 	sScanConvertData scan;
 	sScanLineData line;
 
@@ -144,6 +154,15 @@ void CTRGouraud2::scanline_bilinear ()
 	if ( dx < 0 )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	const s32 hizSkip = hizClipScanline ( line.y, xStart, dx, line.w[0], line.w[1] );
+	if ( hizSkip < 0 )
+		return;
+	PixelsShaded += dx + 1 - hizSkip;
+#else
+	PixelsShaded += dx + 1;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -199,7 +218,33 @@ void CTRGouraud2::scanline_bilinear ()
 
 #endif
 
-	for ( s32 i = 0; i <= dx; ++i )
+	s32 i = 0;
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	// step over the hidden leading blocks
+	for ( ; i < hizSkip; ++i )
+	{
+#ifdef IPOL_W
+		line.w[0] += slopeW;
+#endif
+#ifdef IPOL_C0
+		line.c[0][0] += slopeC;
+#endif
+#ifdef IPOL_T0
+		line.t[0][0] += slopeT[0];
+#endif
+#ifdef IPOL_T1
+		line.t[1][0] += slopeT[1];
+#endif
+	}
+#endif
+
+#ifdef SSE2_SPAN
+	if ( UseSSE2 )
+		i += scanline_bilinear_sse2 ( dst + i, z + i, dx + 1 - i, slopeW, slopeC );
+#endif
+
+	for ( ; i <= dx; ++i )
 	{
 #ifdef CMP_Z
 		if ( line.z[0] < z[i] )
@@ -249,7 +294,63 @@ void CTRGouraud2::scanline_bilinear ()
 #endif
 	}
 
+#if defined ( SOFTWARE_DRIVER_2_HIERARCHICAL_Z ) && defined ( WRITE_W )
+	DepthBuffer->markSpan ( line.y, xStart + hizSkip, xStart + dx );
+#endif
+}
+
+#ifdef SSE2_SPAN
+/*!
+	four pixels at a time, returns the number of pixels drawn.
+	attributes are stepped pixel by pixel like in the scalar loop.
+*/
+s32 CTRGouraud2::scanline_bilinear_sse2 ( tVideoSample *dst, fp24 *z, s32 count,
+		const fp24 slopeW, const sVec4 &slopeC )
+{
+	const s32 spans = count & ~3;
+	if ( 0 == spans )
+		return 0;
+
+	const __m128 dc = _mm_loadu_ps ( &slopeC.x );
+	const __m128 dw = _mm_set_ss ( slopeW );
+	const __m128 one = _mm_set1_ps ( 1.f );
+	const __m128 colorMul = _mm_set1_ps ( COLOR_MAX * FIX_POINT_F32_MUL );
+
+	__m128 c = _mm_loadu_ps ( &line.c[0][0].x );
+	__m128 wv = _mm_set_ss ( line.w[0] );
+
+	for ( s32 i = 0; i != spans; i += 4 )
+	{
+		__m128 c0, c1, c2, c3;
+		__m128 w0, w1, w2, w3;
+		step4 ( c, dc, c0, c1, c2, c3 );
+		step4 ( wv, dw, w0, w1, w2, w3 );
+		_MM_TRANSPOSE4_PS ( c0, c1, c2, c3 );
+		_MM_TRANSPOSE4_PS ( w0, w1, w2, w3 );
+
+		const __m128 zOld = _mm_loadu_ps ( z + i );
+		const __m128 mask = _mm_cmpge_ps ( w0, zOld );
+		if ( 0 == _mm_movemask_ps ( mask ) )
+			continue;
+
+		const __m128 inversew = _mm_div_ps ( one, w0 );
+
+		const __m128i color = fix_to_color4 ( tofix4 ( _mm_mul_ps ( c1, inversew ), colorMul ),
+											tofix4 ( _mm_mul_ps ( c2, inversew ), colorMul ),
+											tofix4 ( _mm_mul_ps ( c3, inversew ), colorMul )
+										);
+
+		__m128i* d = (__m128i*) ( dst + i );
+		_mm_storeu_si128 ( d, select4 ( _mm_castps_si128 ( mask ), color, _mm_loadu_si128 ( d ) ) );
+		_mm_storeu_ps ( z + i, select4 ( mask, w0, zOld ) );
+	}
+
+	_mm_storeu_ps ( &line.c[0][0].x, c );
+	_mm_store_ss ( &line.w[0], wv );
+
+	return spans;
 }
+#endif
 
 void CTRGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
 {
@@ -269,6 +370,11 @@ void CTRGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4D
 	if ( F32_LOWER_EQUAL_0 ( scan.invDeltaY[0] ) )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	if ( hizOccluded ( a, b, c ) )
+		return;
+#endif
+
 	// find if the major edge is left or right aligned
 	f32 temp[4];
 
@@ -388,6 +494,9 @@ void CTRGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4D
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -420,7 +529,8 @@ void CTRGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4D
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -548,6 +658,9 @@ void CTRGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4D
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -580,7 +693,8 @@ void CTRGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4D
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
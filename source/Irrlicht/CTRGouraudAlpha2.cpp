@@ -150,6 +150,8 @@ void CTRGouraudAlpha2::scanline_bilinear ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -402,6 +404,9 @@ void CTRGouraudAlpha2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,cons
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -434,7 +439,8 @@ void CTRGouraudAlpha2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,cons
 #endif
 
 			// render a scanline
-			scanline_bilinear ( );
+			if ( line.y >= BandYStart )
+				scanline_bilinear ( );
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -562,6 +568,9 @@ void CTRGouraudAlpha2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,cons
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -594,7 +603,8 @@ void CTRGouraudAlpha2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,cons
 #endif
 
 			// render a scanline
-			scanline_bilinear ( );
+			if ( line.y >= BandYStart )
+				scanline_bilinear ( );
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -146,6 +146,8 @@ void CTRGouraudAlphaNoZ2::scanline_bilinear ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -400,6 +402,9 @@ void CTRGouraudAlphaNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,c
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -432,7 +437,8 @@ void CTRGouraudAlphaNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,c
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -560,6 +566,9 @@ void CTRGouraudAlphaNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,c
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -592,7 +601,8 @@ void CTRGouraudAlphaNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,c
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
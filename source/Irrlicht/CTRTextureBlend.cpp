@@ -263,6 +263,8 @@ void CTRTextureBlend::fragment_dst_color_src_alpha ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -447,6 +449,8 @@ void CTRTextureBlend::fragment_src_color_src_alpha ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -627,6 +631,8 @@ void CTRTextureBlend::fragment_one_one_minus_src_alpha()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -824,6 +830,8 @@ void CTRTextureBlend::fragment_one_minus_dst_alpha_one ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1020,6 +1028,8 @@ void CTRTextureBlend::fragment_src_alpha_one ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1247,6 +1257,8 @@ void CTRTextureBlend::fragment_dst_color_one_minus_dst_alpha ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1443,6 +1455,8 @@ void CTRTextureBlend::fragment_dst_color_zero ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1637,6 +1651,8 @@ void CTRTextureBlend::fragment_dst_color_one ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1834,6 +1850,8 @@ void CTRTextureBlend::fragment_zero_one_minus_scr_color ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -2129,6 +2147,9 @@ void CTRTextureBlend::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -2161,7 +2182,8 @@ void CTRTextureBlend::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const
 #endif
 
 			// render a scanline
-			(this->*fragmentShader) ();
+			if ( line.y >= BandYStart )
+				(this->*fragmentShader) ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -2289,6 +2311,9 @@ void CTRTextureBlend::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -2321,7 +2346,8 @@ void CTRTextureBlend::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const
 #endif
 
 			// render a scanline
-			(this->*fragmentShader) ();
+			if ( line.y >= BandYStart )
+				(this->*fragmentShader) ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -146,6 +146,14 @@ void CTRTextureDetailMap2::scanline_bilinear ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	// hidden leading pixels are left to the depth test
+	if ( hizClipScanline ( line.y, xStart, dx, line.w[0], line.w[1] ) < 0 )
+		return;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -259,6 +267,9 @@ void CTRTextureDetailMap2::scanline_bilinear ()
 #endif
 	}
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	DepthBuffer->markSpan ( line.y, xStart, xStart + dx );
+#endif
 }
 
 void CTRTextureDetailMap2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
@@ -279,6 +290,11 @@ void CTRTextureDetailMap2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,
 	if ( F32_LOWER_EQUAL_0 ( scan.invDeltaY[0] ) )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	if ( hizOccluded ( a, b, c ) )
+		return;
+#endif
+
 	// find if the major edge is left or right aligned
 	f32 temp[4];
 
@@ -397,6 +413,9 @@ void CTRTextureDetailMap2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -429,7 +448,8 @@ void CTRTextureDetailMap2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -557,6 +577,9 @@ void CTRTextureDetailMap2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -589,7 +612,8 @@ void CTRTextureDetailMap2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
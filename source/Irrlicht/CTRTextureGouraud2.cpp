@@ -68,6 +68,12 @@
 
 #endif
 
+// sse2 span function for this render case
+#if defined ( SOFTWARE_DRIVER_2_SSE2 ) && defined ( CMP_W ) && defined ( WRITE_W ) && defined ( INVERSE_W ) && \
+	defined ( IPOL_C0 ) && defined ( IPOL_T0 ) && !defined ( IPOL_T1 ) && !defined ( BURNINGVIDEO_RENDERER_FAST )
+	#define SSE2_SPAN
+#endif
+
 
 namespace irr
 {
@@ -88,6 +94,10 @@ public:
 
 private:
 	void scanline_bilinear ();
+#ifdef SSE2_SPAN
+	s32 scanline_bilinear_sse2 ( tVideoSample *dst, fp24 *z, s32 count,
+		const fp24 slopeW, const sVec4 &slopeC, const sVec2 &slopeT );
+#endif
 	sScanConvertData scan;
 	sScanLineData line;
 
@@ -145,6 +155,15 @@ void CTRTextureGouraud2::scanline_bilinear ()
 	if ( dx < 0 )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	const s32 hizSkip = hizClipScanline ( line.y, xStart, dx, line.w[0], line.w[1] );
+	if ( hizSkip < 0 )
+		return;
+	PixelsShaded += dx + 1 - hizSkip;
+#else
+	PixelsShaded += dx + 1;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -205,7 +224,34 @@ void CTRTextureGouraud2::scanline_bilinear ()
 	u32 dIndex = ( line.y & 3 ) << 2;
 #endif
 
-	for ( s32 i = 0; i <= dx; ++i )
+	s32 i = 0;
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	// step over the hidden leading blocks
+	for ( ; i < hizSkip; ++i )
+	{
+#ifdef IPOL_W
+		line.w[0] += slopeW;
+#endif
+#ifdef IPOL_C0
+		line.c[0][0] += slopeC;
+#endif
+#ifdef IPOL_T0
+		line.t[0][0] += slopeT[0];
+#endif
+#ifdef IPOL_T1
+		line.t[1][0] += slopeT[1];
+#endif
+	}
+#endif
+
+#ifdef SSE2_SPAN
+	// the vector path reads texels uncompressed, so DXT levels take the scalar loop
+	if ( UseSSE2 && 0 == IT[0].blockCache )
+		i += scanline_bilinear_sse2 ( dst + i, z + i, dx + 1 - i, slopeW, slopeC, slopeT[0] );
+#endif
+
+	for ( ; i <= dx; ++i )
 	{
 #ifdef CMP_Z
 		if ( line.z[0] < z[i] )
@@ -279,8 +325,71 @@ void CTRTextureGouraud2::scanline_bilinear ()
 #endif
 	}
 
+#if defined ( SOFTWARE_DRIVER_2_HIERARCHICAL_Z ) && defined ( WRITE_W )
+	DepthBuffer->markSpan ( line.y, xStart + hizSkip, xStart + dx );
+#endif
 }
 
+#ifdef SSE2_SPAN
+/*!
+	four pixels at a time, returns the number of pixels drawn.
+	attributes are stepped pixel by pixel like in the scalar loop.
+*/
+s32 CTRTextureGouraud2::scanline_bilinear_sse2 ( tVideoSample *dst, fp24 *z, s32 count,
+		const fp24 slopeW, const sVec4 &slopeC, const sVec2 &slopeT )
+{
+	const s32 spans = count & ~3;
+	if ( 0 == spans )
+		return 0;
+
+	const __m128 dc = _mm_loadu_ps ( &slopeC.x );
+	const __m128 dwt = _mm_setr_ps ( slopeW, slopeT.x, slopeT.y, 0.f );
+	const __m128 fixMul = _mm_set1_ps ( FIX_POINT_F32_MUL );
+
+	__m128 c = _mm_loadu_ps ( &line.c[0][0].x );
+	__m128 wt = _mm_setr_ps ( line.w[0], line.t[0][0].x, line.t[0][0].y, 0.f );
+
+	for ( s32 i = 0; i != spans; i += 4 )
+	{
+		__m128 c0, c1, c2, c3;
+		__m128 w, tx, ty, t3;
+		step4 ( c, dc, c0, c1, c2, c3 );
+		step4 ( wt, dwt, w, tx, ty, t3 );
+		_MM_TRANSPOSE4_PS ( c0, c1, c2, c3 );
+		_MM_TRANSPOSE4_PS ( w, tx, ty, t3 );
+
+		const __m128 zOld = _mm_loadu_ps ( z + i );
+		const __m128 mask = _mm_cmpge_ps ( w, zOld );
+		if ( 0 == _mm_movemask_ps ( mask ) )
+			continue;
+
+		_mm_storeu_ps ( z + i, select4 ( mask, w, zOld ) );
+
+		const __m128 inversew = _mm_div_ps ( fixMul, w );
+
+		__m128i r0, g0, b0;
+		getSample_texture4 ( r0, g0, b0, &IT[0], tofix4 ( tx, inversew ), tofix4 ( ty, inversew ) );
+
+		const __m128i color = fix_to_color4 ( imulFix4 ( r0, tofix4 ( c1, inversew ) ),
+											imulFix4 ( g0, tofix4 ( c2, inversew ) ),
+											imulFix4 ( b0, tofix4 ( c3, inversew ) )
+										);
+
+		__m128i* d = (__m128i*) ( dst + i );
+		_mm_storeu_si128 ( d, select4 ( _mm_castps_si128 ( mask ), color, _mm_loadu_si128 ( d ) ) );
+	}
+
+	f32 v[4];
+	_mm_storeu_ps ( &line.c[0][0].x, c );
+	_mm_storeu_ps ( v, wt );
+	line.w[0] = v[0];
+	line.t[0][0].x = v[1];
+	line.t[0][0].y = v[2];
+
+	return spans;
+}
+#endif
+
 void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
 {
 	// sort on height, y
@@ -299,6 +408,11 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 	if ( F32_LOWER_EQUAL_0 ( scan.invDeltaY[0] ) )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	if ( hizOccluded ( a, b, c ) )
+		return;
+#endif
+
 	// find if the major edge is left or right aligned
 	f32 temp[4];
 
@@ -417,6 +531,9 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -449,7 +566,8 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -577,6 +695,9 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -609,7 +730,8 @@ void CTRTextureGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,co
 #endif
 
 			// render a scanline
-			scanline_bilinear ( );
+			if ( line.y >= BandYStart )
+				scanline_bilinear ( );
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
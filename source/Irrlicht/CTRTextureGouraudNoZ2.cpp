@@ -73,6 +73,12 @@
 
 #endif
 
+// sse2 span function for this render case
+#if defined ( SOFTWARE_DRIVER_2_SSE2 ) && !defined ( USE_ZBUFFER ) && defined ( IPOL_W ) && defined ( INVERSE_W ) && \
+	!defined ( IPOL_C0 ) && defined ( IPOL_T0 ) && !defined ( IPOL_T1 )
+	#define SSE2_SPAN
+#endif
+
 
 namespace irr
 {
@@ -93,6 +99,9 @@ public:
 
 private:
 	void scanline_bilinear ();
+#ifdef SSE2_SPAN
+	s32 scanline_bilinear_sse2 ( tVideoSample *dst, s32 count, const fp24 slopeW, const sVec2 &slopeT );
+#endif
 	sScanConvertData scan;
 	sScanLineData line;
 
@@ -150,6 +159,8 @@ void CTRTextureGouraudNoZ2::scanline_bilinear ( )
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -201,7 +212,15 @@ void CTRTextureGouraudNoZ2::scanline_bilinear ( )
 	tFixPoint ty0;
 
 
-	for ( s32 i = 0; i <= dx; ++i )
+	s32 i = 0;
+
+#ifdef SSE2_SPAN
+	// the vector path reads texels uncompressed, so DXT levels take the scalar loop
+	if ( UseSSE2 && 0 == IT[0].blockCache )
+		i = scanline_bilinear_sse2 ( dst, dx + 1, slopeW, slopeT[0] );
+#endif
+
+	for ( ; i <= dx; ++i )
 	{
 #ifdef CMP_Z
 		if ( line.z[0] < z[i] )
@@ -249,6 +268,43 @@ void CTRTextureGouraudNoZ2::scanline_bilinear ( )
 
 }
 
+#ifdef SSE2_SPAN
+/*!
+	four pixels at a time, returns the number of pixels drawn.
+	attributes are stepped pixel by pixel like in the scalar loop.
+*/
+s32 CTRTextureGouraudNoZ2::scanline_bilinear_sse2 ( tVideoSample *dst, s32 count, const fp24 slopeW, const sVec2 &slopeT )
+{
+	const s32 spans = count & ~3;
+	if ( 0 == spans )
+		return 0;
+
+	const __m128 dwt = _mm_setr_ps ( slopeW, slopeT.x, slopeT.y, 0.f );
+	const __m128 fixMul = _mm_set1_ps ( FIX_POINT_F32_MUL );
+
+	__m128 wt = _mm_setr_ps ( line.w[0], line.t[0][0].x, line.t[0][0].y, 0.f );
+
+	for ( s32 i = 0; i != spans; i += 4 )
+	{
+		__m128 w, tx, ty, t3;
+		step4 ( wt, dwt, w, tx, ty, t3 );
+		_MM_TRANSPOSE4_PS ( w, tx, ty, t3 );
+
+		const __m128 inversew = _mm_div_ps ( fixMul, w );
+		_mm_storeu_si128 ( (__m128i*) ( dst + i ),
+			getTexel_plain4 ( &IT[0], tofix4 ( tx, inversew ), tofix4 ( ty, inversew ) ) );
+	}
+
+	f32 v[4];
+	_mm_storeu_ps ( v, wt );
+	line.w[0] = v[0];
+	line.t[0][0].x = v[1];
+	line.t[0][0].y = v[2];
+
+	return spans;
+}
+#endif
+
 void CTRTextureGouraudNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
 {
 	// sort on height, y
@@ -385,6 +441,9 @@ void CTRTextureGouraudNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -417,7 +476,8 @@ void CTRTextureGouraudNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b
 #endif
 
 			// render a scanline
-			scanline_bilinear ( );
+			if ( line.y >= BandYStart )
+				scanline_bilinear ( );
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -545,6 +605,9 @@ void CTRTextureGouraudNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -577,7 +640,8 @@ void CTRTextureGouraudNoZ2::drawTriangle ( const s4DVertex *a,const s4DVertex *b
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -145,6 +145,14 @@ REALINLINE void CTRTextureLightMap2_Add::scanline_bilinear ()
 	if ( dx < 0 )
 		return;
 
+	PixelsShaded += dx + 1;
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	// hidden leading pixels are left to the depth test
+	if ( hizClipScanline ( line.y, xStart, dx, line.w[0], line.w[1] ) < 0 )
+		return;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -264,6 +272,9 @@ REALINLINE void CTRTextureLightMap2_Add::scanline_bilinear ()
 #endif
 	}
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	DepthBuffer->markSpan ( line.y, xStart, xStart + dx );
+#endif
 }
 
 void CTRTextureLightMap2_Add::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
@@ -284,6 +295,11 @@ void CTRTextureLightMap2_Add::drawTriangle ( const s4DVertex *a,const s4DVertex
 	if ( F32_LOWER_EQUAL_0 ( scan.invDeltaY[0] ) )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	if ( hizOccluded ( a, b, c ) )
+		return;
+#endif
+
 	// find if the major edge is left or right aligned
 	f32 temp[4];
 
@@ -402,6 +418,9 @@ void CTRTextureLightMap2_Add::drawTriangle ( const s4DVertex *a,const s4DVertex
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -434,7 +453,8 @@ void CTRTextureLightMap2_Add::drawTriangle ( const s4DVertex *a,const s4DVertex
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -562,6 +582,9 @@ void CTRTextureLightMap2_Add::drawTriangle ( const s4DVertex *a,const s4DVertex
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -594,7 +617,8 @@ void CTRTextureLightMap2_Add::drawTriangle ( const s4DVertex *a,const s4DVertex
 #endif
 
 			// render a scanline
-			scanline_bilinear ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
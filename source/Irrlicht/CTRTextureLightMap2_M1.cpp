@@ -122,6 +122,14 @@ REALINLINE void CTRTextureLightMap2_M1::scanline_bilinear2 ()
 	if ( dx < 0 )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	// hidden leading pixels are left to the depth test
+	if ( hizClipScanline ( line.y, xStart, dx, line.w[0], line.w[1] ) < 0 )
+		return;
+#endif
+
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -241,6 +249,9 @@ REALINLINE void CTRTextureLightMap2_M1::scanline_bilinear2 ()
 		line.t[1][0] += line.t[1][1];
 	}
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	DepthBuffer->markSpan ( line.y, xStart, xStart + dx );
+#endif
 }
 
 
@@ -264,6 +275,11 @@ void CTRTextureLightMap2_M1::drawTriangle ( const s4DVertex *a,const s4DVertex *
 	if ( F32_LOWER_EQUAL_0 ( scan.invDeltaY[0] )  )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	if ( hizOccluded ( a, b, c ) )
+		return;
+#endif
+
 	// find if the major edge is left or right aligned
 	f32 temp[4];
 
@@ -382,6 +398,9 @@ void CTRTextureLightMap2_M1::drawTriangle ( const s4DVertex *a,const s4DVertex *
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -414,7 +433,8 @@ void CTRTextureLightMap2_M1::drawTriangle ( const s4DVertex *a,const s4DVertex *
 #endif
 
 			// render a scanline
-			scanline_bilinear2 ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear2 ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -543,6 +563,9 @@ void CTRTextureLightMap2_M1::drawTriangle ( const s4DVertex *a,const s4DVertex *
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -575,7 +598,8 @@ void CTRTextureLightMap2_M1::drawTriangle ( const s4DVertex *a,const s4DVertex *
 #endif
 
 			// render a scanline
-			scanline_bilinear2 ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear2 ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
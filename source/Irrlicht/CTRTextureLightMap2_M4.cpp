@@ -68,6 +68,12 @@
 
 #endif
 
+// sse2 span function for this render case
+#if defined ( SOFTWARE_DRIVER_2_SSE2 ) && defined ( CMP_W ) && defined ( WRITE_W ) && defined ( INVERSE_W ) && \
+	!defined ( BURNINGVIDEO_RENDERER_FAST )
+	#define SSE2_SPAN
+#endif
+
 namespace irr
 {
 
@@ -93,6 +99,9 @@ private:
 	void scanline_bilinear ();
 	void scanline_bilinear2_mag ();
 	void scanline_bilinear2_min ();
+#ifdef SSE2_SPAN
+	s32 scanline_bilinear2_sse2 ( tVideoSample *dst, fp24 *z, s32 count, bool bilinear );
+#endif
 
 	sScanLineData line;
 
@@ -125,6 +134,14 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_mag ()
 	if ( dx < 0 )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	// hidden leading pixels are left to the depth test
+	if ( hizClipScanline ( line.y, xStart, dx, line.w[0], line.w[1] ) < 0 )
+		return;
+#endif
+
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -197,6 +214,11 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_mag ()
 	tFixPoint r1, g1, b1;
 #endif
 
+#ifdef SSE2_SPAN
+	// the vector path reads texels uncompressed, so DXT levels take the scalar loop
+	if ( UseSSE2 && 0 == IT[0].blockCache && 0 == IT[1].blockCache )
+		i += scanline_bilinear2_sse2 ( dst + i, z + i, dx + 1 - i, true );
+#endif
 
 	for ( ;i <= dx; i++ )
 	{
@@ -245,6 +267,9 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_mag ()
 		line.t[1][0] += line.t[1][1];
 	}
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	DepthBuffer->markSpan ( line.y, xStart, xStart + dx );
+#endif
 }
 
 
@@ -267,6 +292,14 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_min ()
 	if ( dx < 0 )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	// hidden leading pixels are left to the depth test
+	if ( hizClipScanline ( line.y, xStart, dx, line.w[0], line.w[1] ) < 0 )
+		return;
+#endif
+
+	PixelsShaded += dx + 1;
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -329,6 +362,10 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_min ()
 	tFixPoint r0, g0, b0;
 	tFixPoint r1, g1, b1;
 
+#ifdef SSE2_SPAN
+	if ( UseSSE2 && 0 == IT[0].blockCache && 0 == IT[1].blockCache )
+		i += scanline_bilinear2_sse2 ( dst + i, z + i, dx + 1 - i, false );
+#endif
 
 	for ( ;i <= dx; i++ )
 	{
@@ -367,7 +404,84 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_min ()
 		line.t[1][0] += line.t[1][1];
 	}
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	DepthBuffer->markSpan ( line.y, xStart, xStart + dx );
+#endif
+}
+
+#ifdef SSE2_SPAN
+/*!
+	four pixels at a time, returns the number of pixels drawn.
+	bilinear samples both textures like the mag scanline, else the texels
+	are point sampled like the min scanline.
+*/
+s32 CTRTextureLightMap2_M4::scanline_bilinear2_sse2 ( tVideoSample *dst, fp24 *z, s32 count, bool bilinear )
+{
+	const s32 spans = count & ~3;
+	if ( 0 == spans )
+		return 0;
+
+	// line.w[1] and line.t[][1] hold the slopes
+	const __m128 dwt = _mm_setr_ps ( line.w[1], line.t[0][1].x, line.t[0][1].y, 0.f );
+	const __m128 dt1 = _mm_setr_ps ( line.t[1][1].x, line.t[1][1].y, 0.f, 0.f );
+	const __m128 fixMul = _mm_set1_ps ( FIX_POINT_F32_MUL );
+
+	__m128 wt = _mm_setr_ps ( line.w[0], line.t[0][0].x, line.t[0][0].y, 0.f );
+	__m128 t1 = _mm_setr_ps ( line.t[1][0].x, line.t[1][0].y, 0.f, 0.f );
+
+	for ( s32 i = 0; i != spans; i += 4 )
+	{
+		__m128 w, tx0, ty0, t3;
+		__m128 p0, p1, p2, p3;
+		__m128 tx1, ty1;
+		step4 ( wt, dwt, w, tx0, ty0, t3 );
+		step4 ( t1, dt1, p0, p1, p2, p3 );
+		_MM_TRANSPOSE4_PS ( w, tx0, ty0, t3 );
+		transpose2 ( tx1, ty1, p0, p1, p2, p3 );
+
+		const __m128 zOld = _mm_loadu_ps ( z + i );
+		const __m128 mask = _mm_cmpge_ps ( w, zOld );
+		if ( 0 == _mm_movemask_ps ( mask ) )
+			continue;
+
+		_mm_storeu_ps ( z + i, select4 ( mask, w, zOld ) );
+
+		const __m128 inversew = _mm_div_ps ( fixMul, w );
+
+		__m128i r0, g0, b0;
+		__m128i r1, g1, b1;
+		if ( bilinear )
+		{
+			getSample_texture4 ( r0, g0, b0, &IT[0], tofix4 ( tx0, inversew ), tofix4 ( ty0, inversew ) );
+			getSample_texture4 ( r1, g1, b1, &IT[1], tofix4 ( tx1, inversew ), tofix4 ( ty1, inversew ) );
+		}
+		else
+		{
+			getTexel_fix4 ( r0, g0, b0, &IT[0], tofix4 ( tx0, inversew ), tofix4 ( ty0, inversew ) );
+			getTexel_fix4 ( r1, g1, b1, &IT[1], tofix4 ( tx1, inversew ), tofix4 ( ty1, inversew ) );
+		}
+
+		const __m128i color = fix_to_color4 ( clampfix_maxcolor4 ( imulFix_tex4_4 ( r0, r1 ) ),
+											clampfix_maxcolor4 ( imulFix_tex4_4 ( g0, g1 ) ),
+											clampfix_maxcolor4 ( imulFix_tex4_4 ( b0, b1 ) )
+										);
+
+		__m128i* d = (__m128i*) ( dst + i );
+		_mm_storeu_si128 ( d, select4 ( _mm_castps_si128 ( mask ), color, _mm_loadu_si128 ( d ) ) );
+	}
+
+	f32 v[4];
+	_mm_storeu_ps ( v, wt );
+	line.w[0] = v[0];
+	line.t[0][0].x = v[1];
+	line.t[0][0].y = v[2];
+	_mm_storeu_ps ( v, t1 );
+	line.t[1][0].x = v[0];
+	line.t[1][0].y = v[1];
+
+	return spans;
 }
+#endif
 
 //#ifdef BURNINGVIDEO_RENDERER_FAST
 #if 1
@@ -400,6 +514,11 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 	if ( F32_LOWER_EQUAL_0 ( scan.invDeltaY[0] )  )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	if ( hizOccluded ( a, b, c ) )
+		return;
+#endif
+
 	// find if the major edge is left or right aligned
 	f32 temp[4];
 
@@ -518,6 +637,9 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -550,7 +672,8 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 #endif
 
 			// render a scanline
-			scanline_bilinear2_min ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear2_min ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -679,6 +802,9 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -711,7 +837,8 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 #endif
 
 			// render a scanline
-			scanline_bilinear2_min ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear2_min ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -773,6 +900,11 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 	if ( F32_LOWER_EQUAL_0 ( scan.invDeltaY[0] )  )
 		return;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	if ( hizOccluded ( a, b, c ) )
+		return;
+#endif
+
 	// find if the major edge is left or right aligned
 	f32 temp[4];
 
@@ -892,6 +1024,9 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -924,7 +1059,8 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 #endif
 
 			// render a scanline
-			scanline_bilinear2_mag ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear2_mag ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -1053,6 +1189,9 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 
 #endif
 
+		if ( yEnd >= BandYEnd )
+			yEnd = BandYEnd - 1;
+
 		// rasterize the edge scanlines
 		for( line.y = yStart; line.y <= yEnd; ++line.y)
 		{
@@ -1085,7 +1224,8 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 #endif
 
 			// render a scanline
-			scanline_bilinear2_mag ();
+			if ( line.y >= BandYStart )
+				scanline_bilinear2_mag ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
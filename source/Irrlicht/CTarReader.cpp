@@ -131,7 +131,7 @@ CTarReader::CTarReader(IReadFile* file, bool ignoreCase, bool ignorePaths)
 
 	if (File)
 	{
-		File->grab();
+		grabSharedFile(File);
 
 		// fill the file list
 		populateFileList();
@@ -144,7 +144,7 @@ CTarReader::CTarReader(IReadFile* file, bool ignoreCase, bool ignorePaths)
 CTarReader::~CTarReader()
 {
 	if (File)
-		File->drop();
+		dropSharedFile(File);
 }
 
 
@@ -0,0 +1,430 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CThreadPool.h"
+
+#if defined(_IRR_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+	#define _IRR_THREAD_LOCAL __declspec(thread)
+#else
+	#define _IRR_THREAD_LOCAL __thread
+#endif
+
+namespace irr
+{
+
+// index of the calling thread in its pool
+static _IRR_THREAD_LOCAL u32 CurrentThread = 0;
+
+// pool returned by getSharedPool()
+static CThreadPool* SharedPool = 0;
+
+// number of grabSharedPool() calls which were not dropped yet
+static s32 SharedPoolUsers = 0;
+
+#if defined(_IRR_WINDOWS_API_)
+
+struct CThreadPool::SThreadData
+{
+	CRITICAL_SECTION Lock;
+	HANDLE Wake;	// semaphore, one count per worker and run
+	HANDLE Done;	// auto reset event, set by the last worker
+	core::array<HANDLE> Threads;
+};
+
+struct SThreadStart
+{
+	CThreadPool* Pool;
+	u32 Thread;
+};
+
+static DWORD WINAPI threadPoolFun(void* p)
+{
+	SThreadStart* start = (SThreadStart*) p;
+	CThreadPool* pool = start->Pool;
+	const u32 thread = start->Thread;
+	delete start;
+
+	pool->workerLoop(thread);
+	return 0;
+}
+
+#else
+
+struct CThreadPool::SThreadData
+{
+	pthread_mutex_t Lock;
+	pthread_cond_t Wake;
+	pthread_cond_t Done;
+	core::array<pthread_t> Threads;
+};
+
+struct SThreadStart
+{
+	CThreadPool* Pool;
+	u32 Thread;
+};
+
+static void* threadPoolFun(void* p)
+{
+	SThreadStart* start = (SThreadStart*) p;
+	CThreadPool* pool = start->Pool;
+	const u32 thread = start->Thread;
+	delete start;
+
+	pool->workerLoop(thread);
+	return 0;
+}
+
+#endif
+
+
+//! constructor
+CThreadPool::CThreadPool(u32 threadCount)
+: ThreadCount(threadCount), Job(0), PartCount(0), NextPart(0), Busy(0),
+	Generation(0), Claimed(false), Quit(false), Data(new SThreadData)
+{
+	#ifdef _DEBUG
+	setDebugName("CThreadPool");
+	#endif
+
+	if ( 0 == ThreadCount )
+		ThreadCount = getProcessorCount();
+	if ( 0 == ThreadCount )
+		ThreadCount = 1;
+
+#if defined(_IRR_WINDOWS_API_)
+	InitializeCriticalSection(&Data->Lock);
+	Data->Wake = CreateSemaphoreA(0, 0, 0x7FFFFFFF, 0);
+	Data->Done = CreateEventA(0, FALSE, FALSE, 0);
+
+	for (u32 i = 1; i < ThreadCount; ++i)
+	{
+		SThreadStart* start = new SThreadStart;
+		start->Pool = this;
+		start->Thread = i;
+
+		DWORD id;
+		HANDLE h = CreateThread(0, 0, threadPoolFun, start, 0, &id);
+		if ( 0 == h )
+		{
+			delete start;
+			break;
+		}
+		Data->Threads.push_back(h);
+	}
+#else
+	pthread_mutex_init(&Data->Lock, 0);
+	pthread_cond_init(&Data->Wake, 0);
+	pthread_cond_init(&Data->Done, 0);
+
+	for (u32 i = 1; i < ThreadCount; ++i)
+	{
+		SThreadStart* start = new SThreadStart;
+		start->Pool = this;
+		start->Thread = i;
+
+		pthread_t h;
+		if ( 0 != pthread_create(&h, 0, threadPoolFun, start) )
+		{
+			delete start;
+			break;
+		}
+		Data->Threads.push_back(h);
+	}
+#endif
+
+	// fall back to fewer threads if the system refused to create them
+	ThreadCount = Data->Threads.size() + 1;
+}
+
+
+//! destructor, stops all worker threads
+CThreadPool::~CThreadPool()
+{
+	lock();
+	Quit = true;
+	unlock();
+
+#if defined(_IRR_WINDOWS_API_)
+	ReleaseSemaphore(Data->Wake, Data->Threads.size(), 0);
+	for (u32 i = 0; i != Data->Threads.size(); ++i)
+	{
+		WaitForSingleObject(Data->Threads[i], INFINITE);
+		CloseHandle(Data->Threads[i]);
+	}
+	CloseHandle(Data->Wake);
+	CloseHandle(Data->Done);
+	DeleteCriticalSection(&Data->Lock);
+#else
+	pthread_mutex_lock(&Data->Lock);
+	pthread_cond_broadcast(&Data->Wake);
+	pthread_mutex_unlock(&Data->Lock);
+
+	for (u32 i = 0; i != Data->Threads.size(); ++i)
+		pthread_join(Data->Threads[i], 0);
+
+	pthread_cond_destroy(&Data->Done);
+	pthread_cond_destroy(&Data->Wake);
+	pthread_mutex_destroy(&Data->Lock);
+#endif
+
+	delete Data;
+}
+
+
+//! returns the number of processors of the system
+u32 CThreadPool::getProcessorCount()
+{
+#if defined(_IRR_WINDOWS_API_)
+	SYSTEM_INFO sysinfo;
+	GetSystemInfo(&sysinfo);
+	return sysinfo.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	const long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (u32) n : 1;
+#else
+	return 1;
+#endif
+}
+
+
+//! returns the index of the calling thread in the pool which runs it
+u32 CThreadPool::getCurrentThread()
+{
+	return CurrentThread;
+}
+
+
+void CThreadPool::lock()
+{
+#if defined(_IRR_WINDOWS_API_)
+	EnterCriticalSection(&Data->Lock);
+#else
+	pthread_mutex_lock(&Data->Lock);
+#endif
+}
+
+
+void CThreadPool::unlock()
+{
+#if defined(_IRR_WINDOWS_API_)
+	LeaveCriticalSection(&Data->Lock);
+#else
+	pthread_mutex_unlock(&Data->Lock);
+#endif
+}
+
+
+//! runs parts until the job is exhausted
+void CThreadPool::runParts(u32 thread)
+{
+	while ( 1 )
+	{
+		lock();
+		if ( NextPart >= PartCount )
+		{
+			unlock();
+			break;
+		}
+		const u32 part = NextPart++;
+		IThreadJob* job = Job;
+		unlock();
+
+		job->runPart(part, thread);
+	}
+}
+
+
+//! runs all parts of the job and returns when all of them are done
+void CThreadPool::run(IThreadJob* job, u32 partCount)
+{
+	if ( 0 == job || 0 == partCount )
+		return;
+
+	const u32 workers = Data->Threads.size();
+
+	// nothing to share
+	if ( 0 == workers || 1 == partCount )
+	{
+		for (u32 i = 0; i != partCount; ++i)
+			job->runPart(i, 0);
+		return;
+	}
+
+	lock();
+	Job = job;
+	PartCount = partCount;
+	NextPart = 0;
+	Busy = workers;
+	Generation += 1;
+
+#if defined(_IRR_WINDOWS_API_)
+	unlock();
+	ReleaseSemaphore(Data->Wake, workers, 0);
+#else
+	pthread_cond_broadcast(&Data->Wake);
+	unlock();
+#endif
+
+	runParts(0);
+
+	// wait for the workers
+#if defined(_IRR_WINDOWS_API_)
+	WaitForSingleObject(Data->Done, INFINITE);
+#else
+	pthread_mutex_lock(&Data->Lock);
+	while ( Busy )
+		pthread_cond_wait(&Data->Done, &Data->Lock);
+	pthread_mutex_unlock(&Data->Lock);
+#endif
+
+	lock();
+	Job = 0;
+	unlock();
+}
+
+
+//! runs all parts of the job like run(), unless another thread is running a job on the pool
+bool CThreadPool::tryRun(IThreadJob* job, u32 partCount)
+{
+	if ( 0 == job || 0 == partCount )
+		return true;
+
+	// claim the pool, only the thread which claimed it releases it
+	lock();
+	const bool busy = Claimed;
+	Claimed = true;
+	unlock();
+
+	if ( busy )
+		return false;
+
+	run(job, partCount);
+
+	lock();
+	Claimed = false;
+	unlock();
+	return true;
+}
+
+
+//! returns a pool with one thread per processor, shared by engine internals
+CThreadPool* CThreadPool::getSharedPool()
+{
+	if ( 0 == SharedPool )
+	{
+		// several threads may create one, only the first one is kept
+		CThreadPool* pool = new CThreadPool(0);
+#if defined(_IRR_WINDOWS_API_)
+		if ( 0 != InterlockedCompareExchangePointer((PVOID volatile*)&SharedPool, pool, 0) )
+#else
+		if ( 0 != __sync_val_compare_and_swap(&SharedPool, (CThreadPool*)0, pool) )
+#endif
+			pool->drop();
+	}
+
+	return SharedPool;
+}
+
+
+//! keeps the shared pool alive until the matching dropSharedPool()
+void CThreadPool::grabSharedPool()
+{
+#if defined(_IRR_WINDOWS_API_)
+	InterlockedIncrement((LONG volatile*)&SharedPoolUsers);
+#else
+	__sync_add_and_fetch(&SharedPoolUsers, 1);
+#endif
+}
+
+
+//! destroys the shared pool when the last grabSharedPool() is matched
+void CThreadPool::dropSharedPool()
+{
+#if defined(_IRR_WINDOWS_API_)
+	if ( 0 != InterlockedDecrement((LONG volatile*)&SharedPoolUsers) )
+		return;
+	CThreadPool* pool = (CThreadPool*)InterlockedExchangePointer((PVOID volatile*)&SharedPool, 0);
+#else
+	if ( 0 != __sync_sub_and_fetch(&SharedPoolUsers, 1) )
+		return;
+	CThreadPool* pool = __sync_lock_test_and_set(&SharedPool, (CThreadPool*)0);
+#endif
+
+	if ( pool )
+		pool->drop();
+}
+
+
+//! runs the parts of the job on the shared pool, or on the calling thread if it is busy
+void CThreadPool::runShared(IThreadJob* job, u32 partCount)
+{
+	if ( partCount > 1 && getSharedPool()->tryRun(job, partCount) )
+		return;
+
+	for (u32 i = 0; i < partCount; ++i)
+		job->runPart(i, 0);
+}
+
+
+//! internal worker loop
+void CThreadPool::workerLoop(u32 thread)
+{
+	CurrentThread = thread;
+
+#if defined(_IRR_WINDOWS_API_)
+	while ( 1 )
+	{
+		WaitForSingleObject(Data->Wake, INFINITE);
+
+		lock();
+		const bool quit = Quit;
+		unlock();
+		if ( quit )
+			break;
+
+		runParts(thread);
+
+		lock();
+		const bool last = ( 0 == --Busy );
+		unlock();
+		if ( last )
+			SetEvent(Data->Done);
+	}
+#else
+	u32 generation = 0;
+
+	pthread_mutex_lock(&Data->Lock);
+	while ( 1 )
+	{
+		while ( !Quit && generation == Generation )
+			pthread_cond_wait(&Data->Wake, &Data->Lock);
+
+		if ( Quit )
+			break;
+
+		generation = Generation;
+		pthread_mutex_unlock(&Data->Lock);
+
+		runParts(thread);
+
+		pthread_mutex_lock(&Data->Lock);
+		if ( 0 == --Busy )
+			pthread_cond_signal(&Data->Done);
+	}
+	pthread_mutex_unlock(&Data->Lock);
+#endif
+}
+
+
+} // end namespace irr
+
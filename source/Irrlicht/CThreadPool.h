@@ -0,0 +1,107 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_THREAD_POOL_H_INCLUDED__
+#define __C_THREAD_POOL_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "IReferenceCounted.h"
+#include "irrArray.h"
+
+namespace irr
+{
+
+//! A job which can be split into independent parts
+class IThreadJob
+{
+public:
+	virtual ~IThreadJob() {}
+
+	//! processes one part of the job
+	/** \param part Index of the part, 0 <= part < partCount.
+	\param thread Index of the executing thread, 0 is the calling thread. */
+	virtual void runPart(u32 part, u32 thread) = 0;
+};
+
+//! Small fixed size pool of worker threads
+/** The calling thread always takes part in the work, so a pool of
+threadCount threads creates threadCount-1 additional threads. Parts are
+handed out dynamically, so uneven parts balance themselves. */
+class CThreadPool : public virtual IReferenceCounted
+{
+public:
+
+	//! constructor
+	/** \param threadCount Number of threads including the caller.
+	0 uses one thread per processor. */
+	CThreadPool(u32 threadCount);
+
+	//! destructor, stops all worker threads
+	virtual ~CThreadPool();
+
+	//! returns the number of threads including the caller
+	u32 getThreadCount() const { return ThreadCount; }
+
+	//! runs all parts of the job and returns when all of them are done
+	void run(IThreadJob* job, u32 partCount);
+
+	//! runs all parts of the job like run(), unless another thread is running a job on the pool
+	/** \return False if the pool was busy, nothing was run then. */
+	bool tryRun(IThreadJob* job, u32 partCount);
+
+	//! returns a pool with one thread per processor, shared by engine internals
+	/** It is created on the first call and lives until the last device is
+	dropped, see grabSharedPool(). Use it with tryRun(), as several threads
+	may want it at the same time. */
+	static CThreadPool* getSharedPool();
+
+	//! keeps the shared pool alive until the matching dropSharedPool(), called by each device
+	static void grabSharedPool();
+
+	//! destroys the shared pool when the last grabSharedPool() is matched
+	/** Must not be called while the shared pool runs a job. */
+	static void dropSharedPool();
+
+	//! runs the parts of the job on the shared pool, or on the calling thread if it is busy
+	/** A job with a single part is always run on the calling thread. */
+	static void runShared(IThreadJob* job, u32 partCount);
+
+	//! returns the number of processors of the system
+	static u32 getProcessorCount();
+
+	//! returns the index of the calling thread in the pool which runs it
+	/** 0 for the thread which called run() and for threads outside of a pool. */
+	static u32 getCurrentThread();
+
+	//! internal worker loop, do not call
+	void workerLoop(u32 thread);
+
+private:
+
+	//! runs parts until the job is exhausted
+	void runParts(u32 thread);
+
+	void lock();
+	void unlock();
+
+	u32 ThreadCount;
+
+	IThreadJob* Job;
+	u32 PartCount;
+	u32 NextPart;
+	u32 Busy;
+	u32 Generation;
+
+	//! set by tryRun() while it owns the pool
+	bool Claimed;
+	bool Quit;
+
+	struct SThreadData;
+	SThreadData* Data;
+};
+
+} // end namespace irr
+
+#endif
+
@@ -8,6 +8,7 @@
 #ifdef __IRR_COMPILE_WITH_WAD_ARCHIVE_LOADER_
 
 #include "CWADReader.h"
+#include "CLimitReadFile.h"
 #include "os.h"
 #include "coreutil.h"
 
@@ -99,7 +100,7 @@ CWADReader::CWADReader(IReadFile* file, bool ignoreCase, bool ignorePaths)
 
 	if (File)
 	{
-		File->grab();
+		grabSharedFile(File);
 
 		Base = File->getFileName();
 		Base.replace ( '\\', '/' );
@@ -137,7 +138,7 @@ CWADReader::CWADReader(IReadFile* file, bool ignoreCase, bool ignorePaths)
 CWADReader::~CWADReader()
 {
 	if (File)
-		File->drop();
+		dropSharedFile(File);
 }
 
 
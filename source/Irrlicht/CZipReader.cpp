@@ -16,6 +16,9 @@ extern "C" void bz_internal_error(int errorCode)
 
 #include "CFileList.h"
 #include "CReadFile.h"
+#include "CMemoryFile.h"
+#include "CMappedReadFile.h"
+#include "CLimitReadFile.h"
 #include "coreutil.h"
 
 #include "IrrCompileConfig.h"
@@ -146,7 +149,7 @@ CZipReader::CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool i
 
 	if (File)
 	{
-		File->grab();
+		grabSharedFile(File);
 
 		// load file entries
 		if (IsGZip)
@@ -161,7 +164,7 @@ CZipReader::CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool i
 CZipReader::~CZipReader()
 {
 	if (File)
-		File->drop();
+		dropSharedFile(File);
 }
 
 
@@ -506,6 +509,377 @@ namespace
 }
 #endif
 
+namespace
+{
+	//! entries which are at most this large are decompressed at once into memory
+	const u32 ZIP_STREAM_MIN_SIZE = 0x10000;
+
+	//! size of the buffer for compressed data read from a file on disk
+	const u32 ZIP_STREAM_INPUT_SIZE = 0x4000;
+
+	/*!
+		Read file decompressing a zip entry while it is read.
+		Only the state of the decompressor and a small input buffer are
+		kept in memory. Seeking forward decompresses up to the new position,
+		seeking backward starts again at the beginning of the entry.
+	*/
+	class CZipStreamReadFile : public IReadFile
+	{
+	public:
+
+		CZipStreamReadFile(IReadFile* file, long offset, u32 compressedSize,
+				u32 uncompressedSize, s16 method, const io::path& fileName)
+		: File(file), Memory((const u8*)CMappedReadFile::getFileMemory(file)),
+			Offset(offset), CompressedSize(compressedSize), Size(uncompressedSize),
+			Method(method), Filename(fileName), Pos(0), InRead(0), InNext(0), InAvail(0),
+			Started(false), Finished(false), Failed(false)
+		{
+			#ifdef _DEBUG
+			setDebugName("CZipStreamReadFile");
+			#endif
+
+			grabSharedFile(File);
+			if (!Memory)
+				InBuffer.set_used(core::min_(CompressedSize, ZIP_STREAM_INPUT_SIZE));
+
+			Failed = !start();
+		}
+
+		virtual ~CZipStreamReadFile()
+		{
+			end();
+			dropSharedFile(File);
+		}
+
+		//! returns how much was read
+		virtual size_t read(void* buffer, size_t sizeToRead) _IRR_OVERRIDE_
+		{
+			long amount = static_cast<long>(sizeToRead);
+			if (Pos + amount > Size)
+				amount = Size - Pos;
+
+			if (amount <= 0)
+				return 0;
+
+			const u32 done = decompress((u8*)buffer, (u32)amount);
+			Pos += done;
+			return done;
+		}
+
+		//! changes position in file, returns true if successful
+		virtual bool seek(long finalPos, bool relativeMovement = false) _IRR_OVERRIDE_
+		{
+			if (relativeMovement)
+				finalPos += Pos;
+
+			if (finalPos < 0 || finalPos > Size)
+				return false;
+
+			if (finalPos < Pos)
+			{
+				end();
+				Pos = 0;
+				InRead = 0;
+				InAvail = 0;
+				Failed = !start();
+			}
+
+			u8 skip[1024];
+			while (Pos < finalPos)
+			{
+				const u32 done = decompress(skip, core::min_((u32)(finalPos - Pos), (u32)sizeof(skip)));
+				if (!done)
+					return false;
+				Pos += done;
+			}
+
+			return true;
+		}
+
+		//! returns size of file
+		virtual long getSize() const _IRR_OVERRIDE_
+		{
+			return Size;
+		}
+
+		//! returns where in the file we are.
+		virtual long getPos() const _IRR_OVERRIDE_
+		{
+			return Pos;
+		}
+
+		//! returns name of file
+		virtual const io::path& getFileName() const _IRR_OVERRIDE_
+		{
+			return Filename;
+		}
+
+		//! returns if the decompressor could be set up
+		bool isValid() const
+		{
+			return !Failed;
+		}
+
+	private:
+
+		//! makes the next compressed data available, returns false at the end of the entry
+		bool fillInput()
+		{
+			if (InAvail)
+				return true;
+
+			if (InRead >= CompressedSize)
+				return false;
+
+			if (Memory)
+			{
+				InNext = Memory + Offset;
+				InAvail = CompressedSize;
+			}
+			else
+			{
+				// the archive file is shared with other entries
+				InAvail = (u32)readSharedFile(File, Offset + InRead, InBuffer.pointer(), core::min_(CompressedSize - InRead, InBuffer.size()));
+				InNext = InBuffer.pointer();
+				if (!InAvail)
+					return false;
+			}
+
+			InRead += InAvail;
+			return true;
+		}
+
+		//! sets up the decompressor at the beginning of the entry
+		bool start()
+		{
+			Finished = false;
+
+			switch (Method)
+			{
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+			case 8:
+				memset(&ZStream, 0, sizeof(ZStream));
+				// wbits < 0 indicates no zlib header inside the data.
+				Started = (inflateInit2(&ZStream, -MAX_WBITS) == Z_OK);
+				break;
+#endif
+#ifdef _IRR_COMPILE_WITH_BZIP2_
+			case 12:
+				memset(&BzStream, 0, sizeof(BzStream));
+				Started = (BZ2_bzDecompressInit(&BzStream, 0, 0) == BZ_OK);
+				break;
+#endif
+#ifdef _IRR_COMPILE_WITH_LZMA_
+			case 14:
+				{
+					// version, size of the properties and the properties come first
+					u8 header[4+LZMA_PROPS_SIZE];
+					if (readInput(header, 4) != 4)
+						return false;
+
+					const u32 propSize = (header[3]<<8)+header[2];
+					if (propSize != LZMA_PROPS_SIZE || readInput(header+4, propSize) != propSize)
+						return false;
+
+					LzmaDec_Construct(&Lzma);
+					Started = (LzmaDec_Allocate(&Lzma, header+4, propSize, &lzmaAlloc) == SZ_OK);
+					if (Started)
+						LzmaDec_Init(&Lzma);
+				}
+				break;
+#endif
+			default:
+				Started = false;
+			}
+
+			return Started;
+		}
+
+		//! frees the decompressor
+		void end()
+		{
+			if (!Started)
+				return;
+
+			switch (Method)
+			{
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+			case 8:
+				inflateEnd(&ZStream);
+				break;
+#endif
+#ifdef _IRR_COMPILE_WITH_BZIP2_
+			case 12:
+				BZ2_bzDecompressEnd(&BzStream);
+				break;
+#endif
+#ifdef _IRR_COMPILE_WITH_LZMA_
+			case 14:
+				LzmaDec_Free(&Lzma, &lzmaAlloc);
+				break;
+#endif
+			}
+
+			Started = false;
+		}
+
+		//! copies compressed data which is not decompressed, like headers
+		u32 readInput(u8* dest, u32 size)
+		{
+			u32 done = 0;
+			while (done < size && fillInput())
+			{
+				const u32 amount = core::min_(size - done, InAvail);
+				memcpy(dest + done, InNext, amount);
+				InNext += amount;
+				InAvail -= amount;
+				done += amount;
+			}
+			return done;
+		}
+
+		//! decompresses the next bytes, returns how many were written
+		u32 decompress(u8* dest, u32 size)
+		{
+			u32 done = 0;
+			while (done < size && !Finished && !Failed)
+			{
+				const bool hasInput = fillInput();
+				u32 consumed = 0;
+				u32 produced = 0;
+
+				switch (Method)
+				{
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+				case 8:
+					{
+						ZStream.next_in = (Bytef*)InNext;
+						ZStream.avail_in = InAvail;
+						ZStream.next_out = (Bytef*)(dest + done);
+						ZStream.avail_out = size - done;
+						const int err = inflate(&ZStream, Z_NO_FLUSH);
+						consumed = InAvail - ZStream.avail_in;
+						produced = (size - done) - ZStream.avail_out;
+						if (err == Z_STREAM_END)
+							Finished = true;
+						else if (err != Z_OK && err != Z_BUF_ERROR)
+							Failed = true;
+					}
+					break;
+#endif
+#ifdef _IRR_COMPILE_WITH_BZIP2_
+				case 12:
+					{
+						BzStream.next_in = (char*)InNext;
+						BzStream.avail_in = InAvail;
+						BzStream.next_out = (char*)(dest + done);
+						BzStream.avail_out = size - done;
+						const int err = BZ2_bzDecompress(&BzStream);
+						consumed = InAvail - BzStream.avail_in;
+						produced = (size - done) - BzStream.avail_out;
+						if (err == BZ_STREAM_END)
+							Finished = true;
+						else if (err != BZ_OK)
+							Failed = true;
+					}
+					break;
+#endif
+#ifdef _IRR_COMPILE_WITH_LZMA_
+				case 14:
+					{
+						SizeT destLen = size - done;
+						SizeT srcLen = InAvail;
+						ELzmaStatus status;
+						const SRes err = LzmaDec_DecodeToBuf(&Lzma, dest + done, &destLen,
+								InNext, &srcLen, LZMA_FINISH_ANY, &status);
+						consumed = (u32)srcLen;
+						produced = (u32)destLen;
+						if (err != SZ_OK)
+							Failed = true;
+						else if (status == LZMA_STATUS_FINISHED_WITH_MARK)
+							Finished = true;
+					}
+					break;
+#endif
+				default:
+					Failed = true;
+				}
+
+				InNext += consumed;
+				InAvail -= consumed;
+				done += produced;
+
+				// truncated data
+				if (!hasInput && !produced)
+					Failed = true;
+
+				if (Failed)
+					os::Printer::log("Error decompressing", Filename, ELL_ERROR);
+			}
+
+			return done;
+		}
+
+		IReadFile* File;
+		const u8* Memory;
+		long Offset;
+		u32 CompressedSize;
+		long Size;
+		s16 Method;
+		io::path Filename;
+		long Pos;
+
+		//! compressed data
+		core::array<u8> InBuffer;
+		u32 InRead;
+		const u8* InNext;
+		u32 InAvail;
+
+#ifdef _IRR_COMPILE_WITH_ZLIB_
+		z_stream ZStream;
+#endif
+#ifdef _IRR_COMPILE_WITH_BZIP2_
+		bz_stream BzStream;
+#endif
+#ifdef _IRR_COMPILE_WITH_LZMA_
+		CLzmaDec Lzma;
+#endif
+		bool Started;
+		bool Finished;
+		bool Failed;
+	};
+
+	//! opens a compressed entry, small entries are decompressed into memory at once
+	IReadFile* createDecompressingReadFile(IReadFile* source, long offset, u32 compressedSize,
+			u32 uncompressedSize, s16 method, const io::path& fileName)
+	{
+		CZipStreamReadFile* stream = new CZipStreamReadFile(source, offset,
+				compressedSize, uncompressedSize, method, fileName);
+		if (!stream->isValid())
+		{
+			os::Printer::log("Error decompressing", fileName, ELL_ERROR);
+			stream->drop();
+			return 0;
+		}
+
+		if (uncompressedSize > ZIP_STREAM_MIN_SIZE)
+			return stream;
+
+		// keep small entries in memory, so loaders can parse them in place
+		c8* pBuf = new c8[uncompressedSize];
+		const size_t read = stream->read(pBuf, uncompressedSize);
+		stream->drop();
+
+		if (read != uncompressedSize)
+		{
+			delete [] pBuf;
+			return 0;
+		}
+
+		return new CMemoryReadFile(pBuf, uncompressedSize, fileName, true);
+	}
+}
+
 //! opens a file by index
 IReadFile* CZipReader::createAndOpenFile(u32 index)
 {
@@ -540,11 +914,12 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 		os::Printer::log("Reading encrypted file.");
 		u8 salt[16]={0};
 		const u16 saltSize = (((e.header.Sig & 0x00ff0000) >>16)+1)*4;
-		File->seek(e.Offset);
-		File->read(salt, saltSize);
+		// the archive file is shared with other entries
+		long pos = e.Offset;
+		pos += (long)readSharedFile(File, pos, salt, saltSize);
 		char pwVerification[2];
 		char pwVerificationFile[2];
-		File->read(pwVerification, 2);
+		pos += (long)readSharedFile(File, pos, pwVerification, 2);
 		fcrypt_ctx zctx; // the encryption context
 		int rc = fcrypt_init(
 			(e.header.Sig & 0x00ff0000) >>16,
@@ -563,14 +938,14 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 		u32 c = 0;
 		while ((c+32768)<=decryptedSize)
 		{
-			File->read(decryptedBuf+c, 32768);
+			pos += (long)readSharedFile(File, pos, decryptedBuf+c, 32768);
 			fcrypt_decrypt(
 				decryptedBuf+c, // pointer to the data to decrypt
 				32768,   // how many bytes to decrypt
 				&zctx); // decryption context
 			c+=32768;
 		}
-		File->read(decryptedBuf+c, decryptedSize-c);
+		pos += (long)readSharedFile(File, pos, decryptedBuf+c, decryptedSize-c);
 		fcrypt_decrypt(
 			decryptedBuf+c, // pointer to the data to decrypt
 			decryptedSize-c,   // how many bytes to decrypt
@@ -587,7 +962,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 			delete [] decryptedBuf;
 			return 0;
 		}
-		File->read(fileMAC, 10);
+		readSharedFile(File, pos, fileMAC, 10);
 		if (strncmp(fileMAC, resMAC, 10))
 		{
 			os::Printer::log("Error on encryption check");
@@ -622,146 +997,16 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 		}
 	case 8:
 		{
-  			#ifdef _IRR_COMPILE_WITH_ZLIB_
-
-			const u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			c8* pBuf = new c8[ uncompressedSize ];
-			if (!pBuf)
-			{
-				swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-				if (decrypted)
-					decrypted->drop();
-				return 0;
-			}
-
-			u8 *pcData = decryptedBuf;
-			if (!pcData)
-			{
-				pcData = new u8[decryptedSize];
-				if (!pcData)
-				{
-					swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
-					os::Printer::log( buf, ELL_ERROR);
-					delete [] pBuf;
-					return 0;
-				}
-
-				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
-			}
-
-			// Setup the inflate stream.
-			z_stream stream;
-			s32 err;
-
-			stream.next_in = (Bytef*)pcData;
-			stream.avail_in = (uInt)decryptedSize;
-			stream.next_out = (Bytef*)pBuf;
-			stream.avail_out = uncompressedSize;
-			stream.zalloc = (alloc_func)0;
-			stream.zfree = (free_func)0;
-
-			// Perform inflation. wbits < 0 indicates no zlib header inside the data.
-			err = inflateInit2(&stream, -MAX_WBITS);
-			if (err == Z_OK)
-			{
-				err = inflate(&stream, Z_FINISH);
-				inflateEnd(&stream);
-				if (err == Z_STREAM_END)
-					err = Z_OK;
-				err = Z_OK;
-				inflateEnd(&stream);
-			}
-
-			if (decrypted)
-				decrypted->drop();
-			else
-				delete[] pcData;
-
-			if (err != Z_OK)
-			{
-				swprintf_irr ( buf, 64, L"Error decompressing %s", core::stringw(Files[index].FullName).c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-				delete [] pBuf;
-				return 0;
-			}
-			else
-				return FileSystem->createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
-
+			#ifdef _IRR_COMPILE_WITH_ZLIB_
+			break;
 			#else
 			return 0; // zlib not compiled, we cannot decompress the data.
 			#endif
 		}
 	case 12:
 		{
-  			#ifdef _IRR_COMPILE_WITH_BZIP2_
-
-			const u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			c8* pBuf = new c8[ uncompressedSize ];
-			if (!pBuf)
-			{
-				swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-				if (decrypted)
-					decrypted->drop();
-				return 0;
-			}
-
-			u8 *pcData = decryptedBuf;
-			if (!pcData)
-			{
-				pcData = new u8[decryptedSize];
-				if (!pcData)
-				{
-					swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
-					os::Printer::log( buf, ELL_ERROR);
-					delete [] pBuf;
-					return 0;
-				}
-
-				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
-			}
-
-			bz_stream bz_ctx;
-			memset(&bz_ctx, 0, sizeof(bz_ctx));
-			/* use BZIP2's default memory allocation
-			bz_ctx->bzalloc = NULL;
-			bz_ctx->bzfree  = NULL;
-			bz_ctx->opaque  = NULL;
-			*/
-			int err = BZ2_bzDecompressInit(&bz_ctx, 0, 0); /* decompression */
-			if(err != BZ_OK)
-			{
-				os::Printer::log("bzip2 decompression failed. File cannot be read.", ELL_ERROR);
-				return 0;
-			}
-			bz_ctx.next_in = (char*)pcData;
-			bz_ctx.avail_in = decryptedSize;
-			/* pass all input to decompressor */
-			bz_ctx.next_out = pBuf;
-			bz_ctx.avail_out = uncompressedSize;
-			err = BZ2_bzDecompress(&bz_ctx);
-			err = BZ2_bzDecompressEnd(&bz_ctx);
-
-			if (decrypted)
-				decrypted->drop();
-			else
-				delete[] pcData;
-
-			if (err != BZ_OK)
-			{
-				swprintf_irr ( buf, 64, L"Error decompressing %s", core::stringw(Files[index].FullName).c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-				delete [] pBuf;
-				return 0;
-			}
-			else
-				return FileSystem->createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
-
+			#ifdef _IRR_COMPILE_WITH_BZIP2_
+			break;
 			#else
 			os::Printer::log("bzip2 decompression not supported. File cannot be read.", ELL_ERROR);
 			return 0;
@@ -769,62 +1014,8 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 		}
 	case 14:
 		{
-  			#ifdef _IRR_COMPILE_WITH_LZMA_
-
-			u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
-			c8* pBuf = new c8[ uncompressedSize ];
-			if (!pBuf)
-			{
-				swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
-				os::Printer::log( buf, ELL_ERROR);
-				if (decrypted)
-					decrypted->drop();
-				return 0;
-			}
-
-			u8 *pcData = decryptedBuf;
-			if (!pcData)
-			{
-				pcData = new u8[decryptedSize];
-				if (!pcData)
-				{
-					swprintf_irr ( buf, 64, L"Not enough memory for decompressing %s", core::stringw(Files[index].FullName).c_str() );
-					os::Printer::log( buf, ELL_ERROR);
-					delete [] pBuf;
-					return 0;
-				}
-
-				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
-			}
-
-			ELzmaStatus status;
-			SizeT tmpDstSize = uncompressedSize;
-			SizeT tmpSrcSize = decryptedSize;
-
-			unsigned int propSize = (pcData[3]<<8)+pcData[2];
-			int err = LzmaDecode((Byte*)pBuf, &tmpDstSize,
-					pcData+4+propSize, &tmpSrcSize,
-					pcData+4, propSize,
-					e.header.GeneralBitFlag&0x1?LZMA_FINISH_END:LZMA_FINISH_ANY, &status,
-					&lzmaAlloc);
-			uncompressedSize = tmpDstSize; // may be different to expected value
-
-			if (decrypted)
-				decrypted->drop();
-			else
-				delete[] pcData;
-
-			if (err != SZ_OK)
-			{
-				os::Printer::log( "Error decompressing", Files[index].FullName, ELL_ERROR);
-				delete [] pBuf;
-				return 0;
-			}
-			else
-				return FileSystem->createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
-
+			#ifdef _IRR_COMPILE_WITH_LZMA_
+			break;
 			#else
 			os::Printer::log("lzma decompression not supported. File cannot be read.", ELL_ERROR);
 			return 0;
@@ -840,6 +1031,19 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 		return 0;
 	};
 
+	// compressed entries are decompressed while reading
+	IReadFile* file;
+	if (decrypted)
+	{
+		file = createDecompressingReadFile(decrypted, 0, decryptedSize,
+			e.header.DataDescriptor.UncompressedSize, actualCompressionMethod, Files[index].FullName);
+		decrypted->drop();
+	}
+	else
+		file = createDecompressingReadFile(File, e.Offset, decryptedSize,
+			e.header.DataDescriptor.UncompressedSize, actualCompressionMethod, Files[index].FullName);
+
+	return file;
 }
 
 } // end namespace io
@@ -26,10 +26,17 @@ namespace irr
 		EPID_SM_RENDER_TRANSPARENT,
 		EPID_SM_RENDER_EFFECT,
 		EPID_SM_REGISTER,
+		EPID_SM_LOAD_MESH,
 
 		//! octrees
 		EPID_OC_RENDER,
-		EPID_OC_CALCPOLYS
+		EPID_OC_CALCPOLYS,
+
+		//! video driver
+		EPID_VD_LOAD_TEXTURE,
+
+		//! gui
+		EPID_GUI_DRAW_ALL
     };
 #endif
 } // end namespace irr
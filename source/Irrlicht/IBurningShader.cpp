@@ -31,11 +31,23 @@ namespace video
 		for ( u32 i = 0; i != BURNING_MATERIAL_MAX_TEXTURES; ++i )
 		{
 			IT[i].Texture = 0;
+			IT[i].blockCache = 0;
+			IT[i].blockFormat = 0;
+			IT[i].blockKey = 0;
+			BlockCache[i] = 0;
 		}
 
 		Driver = driver;
 		RenderTarget = 0;
 		ColorMask = COLOR_BRIGHT_WHITE;
+		BandYStart = 0;
+		BandYEnd = 0x7FFFFFFF;
+		PixelsShaded = 0;
+#ifdef SOFTWARE_DRIVER_2_SSE2
+		UseSSE2 = os::Cpu::hasSSE2 ();
+#else
+		UseSSE2 = false;
+#endif
 		DepthBuffer = (CDepthBuffer*) driver->getDepthBuffer ();
 		if ( DepthBuffer )
 			DepthBuffer->grab();
@@ -63,6 +75,8 @@ namespace video
 		{
 			if ( IT[i].Texture )
 				IT[i].Texture->drop();
+
+			delete BlockCache[i];
 		}
 	}
 
@@ -109,8 +123,111 @@ namespace video
 			const core::dimension2d<u32> &dim = it->Texture->getSize();
 			it->textureXMask = s32_to_fixPoint ( dim.Width - 1 ) & FIX_POINT_UNSIGNED_MASK;
 			it->textureYMask = s32_to_fixPoint ( dim.Height - 1 ) & FIX_POINT_UNSIGNED_MASK;
+
+			// compressed levels are sampled as if they were uncompressed
+			const ECOLOR_FORMAT format = it->Texture->getTexture()->getColorFormat();
+			if ( IImage::isCompressedFormat ( format ) )
+			{
+				it->pitchlog2 = s32_log2_s32 ( dim.Width ) + VIDEO_SAMPLE_GRANULARITY;
+				it->blockFormat = format;
+
+				// only called by the driver thread
+				static u32 blockKey = 0;
+				if ( 0 == ++blockKey )
+					++blockKey;
+				it->blockKey = blockKey;
+				bindBlockCache ( stage );
+				return;
+			}
+		}
+
+		it->blockCache = 0;
+	}
+
+
+	//! points the stage at the own block cache, empties it for a different level
+	void IBurningShader::bindBlockCache ( u32 stage )
+	{
+		sTexelBlockCache* cache = BlockCache[stage];
+		if ( 0 == cache )
+		{
+			cache = new sTexelBlockCache;
+			cache->key = 0;
+			BlockCache[stage] = cache;
 		}
+
+		if ( cache->key != IT[stage].blockKey )
+		{
+			cache->key = IT[stage].blockKey;
+			memset ( cache->tag, 0, sizeof ( cache->tag ) );
+		}
+
+		IT[stage].blockCache = cache;
+	}
+
+
+	//! sets the sampling state of a stage without taking ownership of the texture
+	void IBurningShader::setInternalTexture( u32 stage, const sInternalTexture &it )
+	{
+		sInternalTexture *dst = &IT[stage];
+
+		dst->textureXMask = it.textureXMask;
+		dst->textureYMask = it.textureYMask;
+		dst->pitchlog2 = it.pitchlog2;
+		dst->data = it.data;
+		dst->lodLevel = it.lodLevel;
+
+		// the cache of the other shader may be in use by another thread
+		dst->blockFormat = it.blockFormat;
+		dst->blockKey = it.blockKey;
+		if ( it.blockCache )
+			bindBlockCache ( stage );
+		else
+			dst->blockCache = 0;
+	}
+
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	// interpolated w may exceed the vertex w by a few ulps after stepping
+	static const f32 hizBias = 1.f + 1.f / 1024.f;
+
+	//! returns true if a triangle sorted on y is hidden behind the coarse depth
+	bool IBurningShader::hizOccluded ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
+	{
+		if ( 0 == DepthBuffer || 0 == RenderTarget )
+			return false;
+
+		const core::dimension2d<u32>& dim = RenderTarget->getDimension();
+
+		const s32 yStart = core::max_ ( core::ceil32 ( a->Pos.y ), BandYStart, 0 );
+		const s32 yEnd = core::min_ ( core::ceil32 ( c->Pos.y ) - 1, BandYEnd - 1, (s32) dim.Height - 1 );
+
+		const f32 xMin = core::min_ ( a->Pos.x, b->Pos.x, c->Pos.x );
+		const f32 xMax = core::max_ ( a->Pos.x, b->Pos.x, c->Pos.x );
+		const s32 xStart = core::max_ ( core::ceil32 ( xMin ), 0 );
+		const s32 xEnd = core::min_ ( core::ceil32 ( xMax ) - 1, (s32) dim.Width - 1 );
+
+		if ( yStart > yEnd || xStart > xEnd )
+			return false;
+
+		const f32 w = core::max_ ( a->Pos.w, b->Pos.w, c->Pos.w ) * hizBias;
+		return DepthBuffer->isOccluded ( xStart, yStart, xEnd, yEnd, w );
+	}
+
+
+	//! clips a scanline against the coarse depth
+	s32 IBurningShader::hizClipScanline ( s32 y, s32 xStart, s32 &dx, f32 w0, f32 w1 )
+	{
+		s32 first = xStart;
+		s32 last = xStart + dx;
+
+		if ( !DepthBuffer->clipSpan ( y, first, last, core::max_ ( w0, w1 ) * hizBias ) )
+			return -1;
+
+		dx = last - xStart;
+		return first - xStart;
 	}
+#endif
 
 
 } // end namespace video
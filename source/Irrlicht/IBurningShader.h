@@ -17,6 +17,7 @@
 #include "SLight.h"
 #include "SMaterial.h"
 #include "os.h"
+#include "SoftwareDriver2_simd.h"
 
 
 namespace irr
@@ -144,8 +145,42 @@ namespace video
 
 		virtual void setMaterial ( const SBurningShaderMaterial &material ) {};
 
+		//! restrict scanline output to the rows [yStart,yEnd) of the render target
+		/** Used by the tile rasterizer. Edges are still stepped from the
+		triangle top, so the result is identical to an unrestricted draw. */
+		void setScanLineBand ( s32 yStart, s32 yEnd )
+		{
+			BandYStart = yStart;
+			BandYEnd = yEnd;
+		}
+
+		//! returns the sampling state set by the last setTextureParam
+		const sInternalTexture& getInternalTexture ( u32 stage ) const { return IT[stage]; }
+
+		//! sets the sampling state of a stage without taking ownership of the texture
+		void setInternalTexture ( u32 stage, const sInternalTexture &it );
+
+		//! returns the number of pixels shaded since the last call
+		u32 takePixelsShaded ()
+		{
+			const u32 pixels = PixelsShaded;
+			PixelsShaded = 0;
+			return pixels;
+		}
+
 	protected:
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+		//! returns true if a triangle sorted on y is hidden behind the coarse depth
+		/** Only valid for shaders which pass a pixel on w >= z. */
+		bool hizOccluded ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c );
+
+		//! clips a scanline against the coarse depth
+		/** dx is shortened to the last block where the scanline may pass.
+		\return number of hidden leading pixels, -1 if the whole scanline is hidden */
+		s32 hizClipScanline ( s32 y, s32 xStart, s32 &dx, f32 w0, f32 w1 );
+#endif
+
 		CBurningVideoDriver *Driver;
 
 		video::CImage* RenderTarget;
@@ -155,6 +190,21 @@ namespace video
 
 		sInternalTexture IT[ BURNING_MATERIAL_MAX_TEXTURES ];
 
+		//! points the stage at the own block cache, empties it for a different level
+		void bindBlockCache ( u32 stage );
+
+		// decoded blocks of compressed textures, created on first use
+		sTexelBlockCache* BlockCache[ BURNING_MATERIAL_MAX_TEXTURES ];
+
+		s32 BandYStart;
+		s32 BandYEnd;
+
+		// scanline pixels run through the shader, for the frame statistics
+		u32 PixelsShaded;
+
+		// cpu supports the SSE2 span functions
+		bool UseSSE2;
+
 		static const tFixPointu dithermask[ 4 * 4];
 	};
 
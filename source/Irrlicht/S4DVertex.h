@@ -530,14 +530,31 @@ struct SCacheInfo
 	u32 hit;
 };
 
-#define VERTEXCACHE_ELEMENT	16
+#define VERTEXCACHE_ELEMENT	64
 #define VERTEXCACHE_MISS 0xFFFFFFFF
+
+// index lookup, open addressing, at least twice the cache size
+#define VERTEXCACHE_HASH_LOG2	7
+#define VERTEXCACHE_HASH	( 1 << VERTEXCACHE_HASH_LOG2 )
+
+REALINLINE u32 vertexCacheHash ( const u32 index )
+{
+	return ( index * 0x9E3779B1 ) >> ( 32 - VERTEXCACHE_HASH_LOG2 );
+}
+
 struct SVertexCache
 {
 	SVertexCache (): mem ( VERTEXCACHE_ELEMENT * 2, 128 ) {}
 
 	SCacheInfo info[VERTEXCACHE_ELEMENT];
 
+	// source index -> cache slot ( index, hit )
+	SCacheInfo lookup[VERTEXCACHE_HASH];
+
+	// light space normal and vertex of the vertices being filled
+	sVec4 normal[VERTEXCACHE_ELEMENT];
+	sVec4 vertex[VERTEXCACHE_ELEMENT];
+
 
 	// Transformed and lite, clipping state
 	// + Clipped, Projected
@@ -93,6 +93,17 @@
 
 #define SOFTWARE_DRIVER_2_MIPMAPPING_SCALE (16/SOFTWARE_DRIVER_2_MIPMAPPING_MAX)
 
+// SSE2 span functions, used if the cpu supports them. Only with _IRR_COMPILE_WITH_SSE2_
+#if defined ( SOFTWARE_DRIVER_2_32BIT ) && defined ( SOFTWARE_DRIVER_2_BILINEAR ) && defined ( _IRR_COMPILE_WITH_SSE2_ )
+	#define SOFTWARE_DRIVER_2_SSE2
+#endif
+
+// coarse min depth per block, rejects hidden triangles and spans before shading
+#if defined ( SOFTWARE_DRIVER_2_USE_WBUFFER ) && !defined ( NO_SOFTWARE_DRIVER_2_HIERARCHICAL_Z )
+	#define SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	#define SOFTWARE_DRIVER_2_HIZ_BLOCK_LOG2	3
+#endif
+
 #ifndef REALINLINE
 	#ifdef _MSC_VER
 		#define REALINLINE __forceinline
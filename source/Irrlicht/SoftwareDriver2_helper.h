@@ -748,6 +748,23 @@ struct fp24
 
 // ------------------------ Internal Texture -----------------------------
 
+//! decoded 4x4 blocks of a DXT compressed texture level
+/** Direct mapped on the low bits of the block coordinates, so the blocks of
+an 8x8 block area never evict each other. Every shader owns one per stage,
+the rasterizer threads never share them. */
+struct sTexelBlockCache
+{
+	enum { BLOCK_COUNT = 64 };
+
+	//! the texture level the entries belong to
+	u32 key;
+
+	//! block index + 1 of the entries, 0 for empty ones
+	u32 tag[BLOCK_COUNT];
+
+	tVideoSample texel[BLOCK_COUNT][16];
+};
+
 struct sInternalTexture
 {
 	u32 textureXMask;
@@ -758,8 +775,26 @@ struct sInternalTexture
 
 	video::CSoftwareTexture2 *Texture;
 	s32 lodLevel;
+
+	// compressed levels: data points to the blocks, pitchlog2 is the pitch
+	// of the uncompressed level. 0 blockCache for uncompressed levels.
+	sTexelBlockCache *blockCache;
+	u32 blockFormat;
+	u32 blockKey;
 };
 
+//! decodes the texel at a byte offset of the uncompressed level through the block cache
+tVideoSample getTexel_block ( const sInternalTexture * t, const u32 ofs );
+
+//! returns the texel at a byte offset of the level
+REALINLINE tVideoSample getTexel_ofs ( const sInternalTexture * t, const u32 ofs )
+{
+	if ( t->blockCache )
+		return getTexel_block ( t, ofs );
+
+	return *((tVideoSample*)( (u8*) t->data + ofs ));
+}
+
 
 
 // get video sample plain
@@ -771,7 +806,7 @@ inline tVideoSample getTexel_plain ( const sInternalTexture * t, const tFixPoint
 	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
 
 	// texel
-	return *((tVideoSample*)( (u8*) t->data + ofs ));
+	return getTexel_ofs ( t, ofs );
 }
 
 // get video sample to fix
@@ -786,7 +821,7 @@ inline void getTexel_fix ( tFixPoint &r, tFixPoint &g, tFixPoint &b,
 
 	// texel
 	tVideoSample t00;
-	t00 = *((tVideoSample*)( (u8*) t->data + ofs ));
+	t00 = getTexel_ofs ( t, ofs );
 
 	r = (t00 & MASK_R) >> ( SHIFT_R - FIX_POINT_PRE);
 	g = (t00 & MASK_G) << ( FIX_POINT_PRE - SHIFT_G );
@@ -805,7 +840,7 @@ REALINLINE void getTexel_fix ( tFixPoint &a,
 
 	// texel
 	tVideoSample t00;
-	t00 = *((tVideoSample*)( (u8*) t->data + ofs ));
+	t00 = getTexel_ofs ( t, ofs );
 
 	a = (t00 & MASK_A) >> ( SHIFT_A - FIX_POINT_PRE);
 }
@@ -834,7 +869,7 @@ inline void getSample_texture_dither (	tFixPoint &r, tFixPoint &g, tFixPoint &b,
 	ofs |= ( _ntx ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
 
 	// texel
-	const tVideoSample t00 = *((tVideoSample*)( (u8*) t->data + ofs ));
+	const tVideoSample t00 = getTexel_ofs ( t, ofs );
 
 	(tFixPointu &) r =	(t00 & MASK_R) >> ( SHIFT_R - FIX_POINT_PRE);
 	(tFixPointu &) g =	(t00 & MASK_G) << ( FIX_POINT_PRE - SHIFT_G );
@@ -859,7 +894,7 @@ inline void getSample_texture ( tFixPoint &r, tFixPoint &g, tFixPoint &b,
 	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
 
 	// texel
-	const tVideoSample t00 = *((tVideoSample*)( (u8*) t->data + ofs ));
+	const tVideoSample t00 = getTexel_ofs ( t, ofs );
 
 	(tFixPointu &) r =	(t00 & MASK_R) >> ( SHIFT_R - FIX_POINT_PRE);
 	(tFixPointu &) g =	(t00 & MASK_G) << ( FIX_POINT_PRE - SHIFT_G );
@@ -876,7 +911,7 @@ inline void getSample_texture ( tFixPoint &a, tFixPoint &r, tFixPoint &g, tFixPo
 	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
 
 	// texel
-	const tVideoSample t00 = *((tVideoSample*)( (u8*) t->data + ofs ));
+	const tVideoSample t00 = getTexel_ofs ( t, ofs );
 
 	(tFixPointu &)a =	(t00 & MASK_A) >> ( SHIFT_A - FIX_POINT_PRE);
 	(tFixPointu &)r =	(t00 & MASK_R) >> ( SHIFT_R - FIX_POINT_PRE);
@@ -900,7 +935,7 @@ REALINLINE void getSample_linear ( tFixPointu &r, tFixPointu &g, tFixPointu &b,
 
 	// texel
 	tVideoSample t00;
-	t00 = *((tVideoSample*)( (u8*) t->data + ofs ));
+	t00 = getTexel_ofs ( t, ofs );
 
 	r =	(t00 & MASK_R) >> SHIFT_R;
 	g =	(t00 & MASK_G) >> SHIFT_G;
@@ -932,22 +967,22 @@ REALINLINE void getSample_texture ( tFixPoint &r, tFixPoint &g, tFixPoint &b,
 	o2 =   ( (tx) & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
 	o3 =   ( (tx+FIX_POINT_ONE) & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
 
-	t00 = *((tVideoSample*)( (u8*) t->data + (o0 | o2 ) ));
+	t00 = getTexel_ofs ( t, (o0 | o2 ) );
 	r00 =	(t00 & MASK_R) >> SHIFT_R;
 	g00 =	(t00 & MASK_G) >> SHIFT_G;
 	b00 =	(t00 & MASK_B);
 
-	t00 = *((tVideoSample*)( (u8*) t->data + (o0 | o3 ) ));
+	t00 = getTexel_ofs ( t, (o0 | o3 ) );
 	r10 =	(t00 & MASK_R) >> SHIFT_R;
 	g10 =	(t00 & MASK_G) >> SHIFT_G;
 	b10 =	(t00 & MASK_B);
 
-	t00 = *((tVideoSample*)( (u8*) t->data + (o1 | o2 ) ));
+	t00 = getTexel_ofs ( t, (o1 | o2 ) );
 	r01 =	(t00 & MASK_R) >> SHIFT_R;
 	g01 =	(t00 & MASK_G) >> SHIFT_G;
 	b01 =	(t00 & MASK_B);
 
-	t00 = *((tVideoSample*)( (u8*) t->data + (o1 | o3 ) ));
+	t00 = getTexel_ofs ( t, (o1 | o3 ) );
 	r11 =	(t00 & MASK_R) >> SHIFT_R;
 	g11 =	(t00 & MASK_G) >> SHIFT_G;
 	b11 =	(t00 & MASK_B);
@@ -995,7 +1030,7 @@ REALINLINE void getSample_linear ( tFixPointu &a, tFixPointu &r, tFixPointu &g,
 
 	// texel
 	tVideoSample t00;
-	t00 = *((tVideoSample*)( (u8*) t->data + ofs ));
+	t00 = getTexel_ofs ( t, ofs );
 
 	a =	(t00 & MASK_A) >> SHIFT_A;
 	r =	(t00 & MASK_R) >> SHIFT_R;
@@ -0,0 +1,251 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_VIDEO_2_SOFTWARE_SIMD_H_INCLUDED__
+#define __S_VIDEO_2_SOFTWARE_SIMD_H_INCLUDED__
+
+#include "SoftwareDriver2_compile_config.h"
+#include "SoftwareDriver2_helper.h"
+
+/*
+	SSE2 versions of the fixpoint helpers, working on four pixels at once.
+	One pixel per lane. All functions give the same bits as their scalar
+	counterparts in SoftwareDriver2_helper.h, so the span functions can
+	be mixed freely with the scalar tail of a scanline.
+*/
+
+#ifdef SOFTWARE_DRIVER_2_SSE2
+
+#include <emmintrin.h>
+
+namespace irr
+{
+
+namespace video
+{
+
+/*!
+	step packed attributes pixel by pixel and return the attributes of
+	four consecutive pixels. Stepping one pixel at a time keeps the
+	rounding of the scalar interpolation.
+*/
+REALINLINE void step4 ( __m128 &v, const __m128 slope, __m128 &p0, __m128 &p1, __m128 &p2, __m128 &p3 )
+{
+	p0 = v; v = _mm_add_ps ( v, slope );
+	p1 = v; v = _mm_add_ps ( v, slope );
+	p2 = v; v = _mm_add_ps ( v, slope );
+	p3 = v; v = _mm_add_ps ( v, slope );
+}
+
+//! returns lane x of four vectors with two used lanes, (x,y) -> x[4],y[4]
+REALINLINE void transpose2 ( __m128 &x, __m128 &y, const __m128 p0, const __m128 p1, const __m128 p2, const __m128 p3 )
+{
+	const __m128 a = _mm_unpacklo_ps ( p0, p1 );
+	const __m128 b = _mm_unpacklo_ps ( p2, p3 );
+	x = _mm_movelh_ps ( a, b );
+	y = _mm_movehl_ps ( b, a );
+}
+
+//! select a where mask is set, else b
+REALINLINE __m128i select4 ( const __m128i mask, const __m128i a, const __m128i b )
+{
+	return _mm_or_si128 ( _mm_and_si128 ( mask, a ), _mm_andnot_si128 ( mask, b ) );
+}
+
+REALINLINE __m128 select4 ( const __m128 mask, const __m128 a, const __m128 b )
+{
+	return _mm_or_ps ( _mm_and_ps ( mask, a ), _mm_andnot_ps ( mask, b ) );
+}
+
+//! lower 32 bit of the lane wise product, like a scalar s32 or u32 multiply
+REALINLINE __m128i mul32_4 ( const __m128i a, const __m128i b )
+{
+	const __m128i even = _mm_mul_epu32 ( a, b );
+	const __m128i odd = _mm_mul_epu32 ( _mm_srli_epi64 ( a, 32 ), _mm_srli_epi64 ( b, 32 ) );
+	return _mm_unpacklo_epi32 ( _mm_shuffle_epi32 ( even, _MM_SHUFFLE ( 0, 0, 2, 0 ) ),
+								_mm_shuffle_epi32 ( odd, _MM_SHUFFLE ( 0, 0, 2, 0 ) ) );
+}
+
+//! product of lanes holding values in [0;0x7FFF]
+REALINLINE __m128i mul16_4 ( const __m128i a, const __m128i b )
+{
+	return _mm_madd_epi16 ( a, b );
+}
+
+//! imulFix
+REALINLINE __m128i imulFix4 ( const __m128i x, const __m128i y )
+{
+	return _mm_srai_epi32 ( mul32_4 ( x, y ), FIX_POINT_PRE );
+}
+
+//! imulFix_tex4
+REALINLINE __m128i imulFix_tex4_4 ( const __m128i x, const __m128i y )
+{
+	return _mm_srli_epi32 ( mul32_4 ( _mm_srli_epi32 ( x, 2 ), _mm_srli_epi32 ( y, 2 ) ), FIX_POINT_PRE + 2 );
+}
+
+//! clampfix_maxcolor
+REALINLINE __m128i clampfix_maxcolor4 ( const __m128i a )
+{
+	const __m128i maxcolor = _mm_set1_epi32 ( FIXPOINT_COLOR_MAX );
+	return select4 ( _mm_cmplt_epi32 ( a, maxcolor ), a, maxcolor );
+}
+
+//! fix_to_color
+REALINLINE __m128i fix_to_color4 ( const __m128i r, const __m128i g, const __m128i b )
+{
+	const __m128i maxcolor = _mm_set1_epi32 ( FIXPOINT_COLOR_MAX );
+	return _mm_or_si128 (
+			_mm_or_si128 ( _mm_set1_epi32 ( (s32) MASK_A ),
+							_mm_slli_epi32 ( _mm_and_si128 ( r, maxcolor ), SHIFT_R - FIX_POINT_PRE ) ),
+			_mm_or_si128 ( _mm_srli_epi32 ( _mm_and_si128 ( g, maxcolor ), FIX_POINT_PRE - SHIFT_G ),
+							_mm_srli_epi32 ( _mm_and_si128 ( b, maxcolor ), FIX_POINT_PRE - SHIFT_B ) )
+			);
+}
+
+//! tofix ( x, mulby ) for four values
+REALINLINE __m128i tofix4 ( const __m128 x, const __m128 mulby )
+{
+	return _mm_cvttps_epi32 ( _mm_mul_ps ( x, mulby ) );
+}
+
+//! texel offsets of four pixels, like getTexel_plain
+REALINLINE __m128i getTexel_offset4 ( const sInternalTexture * t, const __m128i tx, const __m128i ty )
+{
+	const __m128i o0 = _mm_sll_epi32 ( _mm_srli_epi32 ( _mm_and_si128 ( ty, _mm_set1_epi32 ( t->textureYMask ) ), FIX_POINT_PRE ),
+										_mm_cvtsi32_si128 ( t->pitchlog2 ) );
+	const __m128i o2 = _mm_srli_epi32 ( _mm_and_si128 ( tx, _mm_set1_epi32 ( t->textureXMask ) ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	return _mm_or_si128 ( o0, o2 );
+}
+
+//! getTexel_plain for four pixels
+REALINLINE __m128i getTexel_plain4 ( const sInternalTexture * t, const __m128i tx, const __m128i ty )
+{
+	u32 ofs[4];
+	_mm_storeu_si128 ( (__m128i*) ofs, getTexel_offset4 ( t, tx, ty ) );
+
+	const u8* data = (const u8*) t->data;
+	return _mm_setr_epi32 ( *(const s32*) ( data + ofs[0] ),
+							*(const s32*) ( data + ofs[1] ),
+							*(const s32*) ( data + ofs[2] ),
+							*(const s32*) ( data + ofs[3] )
+						);
+}
+
+//! getTexel_fix for four pixels
+REALINLINE void getTexel_fix4 ( __m128i &r, __m128i &g, __m128i &b,
+								const sInternalTexture * t, const __m128i tx, const __m128i ty
+								)
+{
+	const __m128i t00 = getTexel_plain4 ( t, tx, ty );
+
+	r = _mm_srli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_R ) ), SHIFT_R - FIX_POINT_PRE );
+	g = _mm_slli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_G ) ), FIX_POINT_PRE - SHIFT_G );
+	b = _mm_slli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_B ) ), FIX_POINT_PRE - SHIFT_B );
+}
+
+//! bilinear getSample_texture for four pixels
+REALINLINE void getSample_texture4 ( __m128i &r, __m128i &g, __m128i &b,
+								const sInternalTexture * t, const __m128i tx, const __m128i ty
+								)
+{
+	const __m128i one = _mm_set1_epi32 ( FIX_POINT_ONE );
+	const __m128i xMask = _mm_set1_epi32 ( t->textureXMask );
+	const __m128i yMask = _mm_set1_epi32 ( t->textureYMask );
+	const __m128i pitch = _mm_cvtsi32_si128 ( t->pitchlog2 );
+
+	const __m128i o0 = _mm_sll_epi32 ( _mm_srli_epi32 ( _mm_and_si128 ( ty, yMask ), FIX_POINT_PRE ), pitch );
+	const __m128i o1 = _mm_sll_epi32 ( _mm_srli_epi32 ( _mm_and_si128 ( _mm_add_epi32 ( ty, one ), yMask ), FIX_POINT_PRE ), pitch );
+	const __m128i o2 = _mm_srli_epi32 ( _mm_and_si128 ( tx, xMask ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	const __m128i o3 = _mm_srli_epi32 ( _mm_and_si128 ( _mm_add_epi32 ( tx, one ), xMask ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+
+	u32 ofs[4][4];
+	_mm_storeu_si128 ( (__m128i*) ofs[0], _mm_or_si128 ( o0, o2 ) );
+	_mm_storeu_si128 ( (__m128i*) ofs[1], _mm_or_si128 ( o0, o3 ) );
+	_mm_storeu_si128 ( (__m128i*) ofs[2], _mm_or_si128 ( o1, o2 ) );
+	_mm_storeu_si128 ( (__m128i*) ofs[3], _mm_or_si128 ( o1, o3 ) );
+
+	const u8* data = (const u8*) t->data;
+	__m128i texel[4];
+	for ( u32 i = 0; i != 4; ++i )
+	{
+		texel[i] = _mm_setr_epi32 ( *(const s32*) ( data + ofs[i][0] ),
+									*(const s32*) ( data + ofs[i][1] ),
+									*(const s32*) ( data + ofs[i][2] ),
+									*(const s32*) ( data + ofs[i][3] )
+								);
+	}
+
+	// weights, texel order 00, 10, 01, 11
+	const __m128i fractMask = _mm_set1_epi32 ( FIX_POINT_FRACT_MASK );
+	const __m128i txFract = _mm_and_si128 ( tx, fractMask );
+	const __m128i txFractInv = _mm_sub_epi32 ( one, txFract );
+	const __m128i tyFract = _mm_and_si128 ( ty, fractMask );
+	const __m128i tyFractInv = _mm_sub_epi32 ( one, tyFract );
+
+	__m128i w[4];
+	w[0] = _mm_srli_epi32 ( mul16_4 ( txFractInv, tyFractInv ), FIX_POINT_PRE );
+	w[1] = _mm_srli_epi32 ( mul16_4 ( txFract, tyFractInv ), FIX_POINT_PRE );
+	w[2] = _mm_srli_epi32 ( mul16_4 ( txFractInv, tyFract ), FIX_POINT_PRE );
+	w[3] = _mm_srli_epi32 ( mul16_4 ( txFract, tyFract ), FIX_POINT_PRE );
+
+	const __m128i colorMask = _mm_set1_epi32 ( COLOR_MAX );
+
+	r = _mm_setzero_si128 ();
+	g = _mm_setzero_si128 ();
+	b = _mm_setzero_si128 ();
+	for ( u32 i = 0; i != 4; ++i )
+	{
+		r = _mm_add_epi32 ( r, mul16_4 ( _mm_and_si128 ( _mm_srli_epi32 ( texel[i], SHIFT_R ), colorMask ), w[i] ) );
+		g = _mm_add_epi32 ( g, mul16_4 ( _mm_and_si128 ( _mm_srli_epi32 ( texel[i], SHIFT_G ), colorMask ), w[i] ) );
+		b = _mm_add_epi32 ( b, mul16_4 ( _mm_and_si128 ( texel[i], colorMask ), w[i] ) );
+	}
+}
+
+//! matrix4::transformVect for four vectors, out = x,y,z,w of the four results
+REALINLINE void transformVect4 ( __m128 out[4], const f32 *M, const __m128 x, const __m128 y, const __m128 z )
+{
+	for ( u32 i = 0; i != 4; ++i )
+	{
+		out[i] = _mm_add_ps ( _mm_add_ps ( _mm_add_ps (
+					_mm_mul_ps ( x, _mm_set1_ps ( M[i] ) ),
+					_mm_mul_ps ( y, _mm_set1_ps ( M[i + 4] ) ) ),
+					_mm_mul_ps ( z, _mm_set1_ps ( M[i + 8] ) ) ),
+					_mm_set1_ps ( M[i + 12] ) );
+	}
+}
+
+//! matrix4::rotateVect for four vectors, out = x,y,z of the four results
+REALINLINE void rotateVect4 ( __m128 out[3], const f32 *M, const __m128 x, const __m128 y, const __m128 z )
+{
+	for ( u32 i = 0; i != 3; ++i )
+	{
+		out[i] = _mm_add_ps ( _mm_add_ps (
+					_mm_mul_ps ( x, _mm_set1_ps ( M[i] ) ),
+					_mm_mul_ps ( y, _mm_set1_ps ( M[i + 4] ) ) ),
+					_mm_mul_ps ( z, _mm_set1_ps ( M[i + 8] ) ) );
+	}
+}
+
+//! clip codes of four homogenous vertices, same bits as clipToFrustumTest
+REALINLINE __m128i clipToFrustumTest4 ( const __m128 x, const __m128 y, const __m128 z, const __m128 w )
+{
+	const __m128 sign = _mm_set1_ps ( -0.f );
+	__m128i flag;
+	flag = _mm_and_si128 ( _mm_castps_si128 ( _mm_cmple_ps ( z, w ) ), _mm_set1_epi32 ( 1 ) );
+	flag = _mm_or_si128 ( flag, _mm_and_si128 ( _mm_castps_si128 ( _mm_cmple_ps ( _mm_xor_ps ( z, sign ), w ) ), _mm_set1_epi32 ( 2 ) ) );
+	flag = _mm_or_si128 ( flag, _mm_and_si128 ( _mm_castps_si128 ( _mm_cmple_ps ( x, w ) ), _mm_set1_epi32 ( 4 ) ) );
+	flag = _mm_or_si128 ( flag, _mm_and_si128 ( _mm_castps_si128 ( _mm_cmple_ps ( _mm_xor_ps ( x, sign ), w ) ), _mm_set1_epi32 ( 8 ) ) );
+	flag = _mm_or_si128 ( flag, _mm_and_si128 ( _mm_castps_si128 ( _mm_cmple_ps ( y, w ) ), _mm_set1_epi32 ( 16 ) ) );
+	flag = _mm_or_si128 ( flag, _mm_and_si128 ( _mm_castps_si128 ( _mm_cmple_ps ( _mm_xor_ps ( y, sign ), w ) ), _mm_set1_epi32 ( 32 ) ) );
+	return flag;
+}
+
+} // end namespace video
+} // end namespace irr
+
+#endif // SOFTWARE_DRIVER_2_SSE2
+
+#endif
+
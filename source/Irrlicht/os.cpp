@@ -33,6 +33,14 @@
 	#define bswap_32(X) ( (((X)&0x000000FF)<<24) | (((X)&0xFF000000) >> 24) | (((X)&0x0000FF00) << 8) | (((X) &0x00FF0000) >> 8))
 #endif
 
+#if defined(_IRR_COMPILE_WITH_SSE2_)
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#elif defined(__GNUC__)
+		#include <cpuid.h>
+	#endif
+#endif
+
 namespace irr
 {
 namespace os
@@ -126,6 +134,21 @@ namespace os
 		return GetTickCount();
 	}
 
+	u64 Timer::getRealTimeMicroseconds()
+	{
+		// no affinity workaround here, this is called far too often for it
+		static LARGE_INTEGER frequency = { 0 };
+		if (!frequency.QuadPart && !QueryPerformanceFrequency(&frequency))
+			frequency.QuadPart = -1;
+
+		LARGE_INTEGER nTime;
+		if (frequency.QuadPart > 0 && QueryPerformanceCounter(&nTime))
+			return (u64)(nTime.QuadPart / frequency.QuadPart) * 1000000 +
+				(u64)(nTime.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+
+		return (u64)GetTickCount() * 1000;
+	}
+
 } // end namespace os
 
 
@@ -161,6 +184,18 @@ namespace os
 		gettimeofday(&tv, 0);
 		return (u32)(tv.tv_sec * 1000) + (tv.tv_usec / 1000);
 	}
+
+	u64 Timer::getRealTimeMicroseconds()
+	{
+#if defined(CLOCK_MONOTONIC)
+		timespec ts;
+		if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+			return (u64)ts.tv_sec * 1000000 + (u64)(ts.tv_nsec / 1000);
+#endif
+		timeval tv;
+		gettimeofday(&tv, 0);
+		return (u64)tv.tv_sec * 1000000 + (u64)tv.tv_usec;
+	}
 } // end namespace os
 
 #endif // end linux / windows
@@ -234,6 +269,58 @@ namespace os
 	}
 
 
+	// ------------------------------------------------------
+	// processor features
+
+#if defined(_IRR_COMPILE_WITH_SSE2_)
+	//! returns the edx and ecx feature flags of cpuid function 1
+	static void getCpuFeatureFlags(u32& edx, u32& ecx)
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		edx = (u32)info[3];
+		ecx = (u32)info[2];
+#elif defined(__GNUC__)
+		unsigned int a, b, c, d;
+		if (!__get_cpuid(1, &a, &b, &c, &d))
+			c = d = 0;
+		edx = d;
+		ecx = c;
+#else
+		edx = ecx = 0;
+#endif
+	}
+#endif
+
+	//! returns true if the processor supports SSE2
+	bool Cpu::hasSSE2()
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+		// part of the x86-64 base instruction set
+		return true;
+#elif defined(_IRR_COMPILE_WITH_SSE2_)
+		u32 edx, ecx;
+		getCpuFeatureFlags(edx, ecx);
+		return 0 != (edx & (1 << 26));
+#else
+		return false;
+#endif
+	}
+
+	//! returns true if the processor supports SSSE3
+	bool Cpu::hasSSSE3()
+	{
+#if defined(_IRR_COMPILE_WITH_SSE2_)
+		u32 edx, ecx;
+		getCpuFeatureFlags(edx, ecx);
+		return 0 != (ecx & (1 << 9));
+#else
+		return false;
+#endif
+	}
+
+
 	// ------------------------------------------------------
 	// virtual timer implementation
 
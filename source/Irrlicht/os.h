@@ -74,6 +74,19 @@ namespace os
 	};
 
 
+	//! instruction sets of the processor, for choosing code paths at runtime
+	class Cpu
+	{
+	public:
+
+		//! returns true if the processor supports SSE2
+		static bool hasSSE2();
+
+		//! returns true if the processor supports SSSE3
+		static bool hasSSSE3();
+	};
+
+
 
 
 	class Timer
@@ -113,6 +126,9 @@ namespace os
 		//! returns the current real time in milliseconds
 		static u32 getRealTime();
 
+		//! returns a monotonic real time in microseconds, used for profiling
+		static u64 getRealTimeMicroseconds();
+
 	private:
 
 		static void initVirtualTimer();
@@ -423,6 +423,197 @@ bool testAddRemove(IFileSystem* fs, const io::path& archiveName)
 
 	return true;
 }
+
+// files are found in the first archive containing them, also after the
+// search order was changed
+bool testArchiveOrder(IFileSystem* fs)
+{
+	if ( fs->getFileArchiveCount() )
+	{
+		logTestString("Already mounted archives found\n");
+		return false;
+	}
+
+	bool result = fs->addFileArchive("media/file_with_path.zip", /*bool ignoreCase=*/true, /*bool ignorePaths=*/false);
+	result &= fs->addFileArchive("media/file_with_path", /*bool ignoreCase=*/true, /*bool ignorePaths=*/true);
+	if (!result)
+	{
+		logTestString("Mounting archives failed\n");
+		while (fs->getFileArchiveCount())
+			fs->removeFileArchive(fs->getFileArchiveCount()-1);
+		return false;
+	}
+	const io::path folder = fs->getFileArchive(1)->getFileList()->getPath();
+
+	// case is ignored
+	IReadFile* readFile = fs->createAndOpenFile("TEST/Test.TXT");
+	result &= (readFile && readFile->getFileName().find(folder.c_str()) == -1);
+	if (readFile)
+		readFile->drop();
+
+	// only found by the archive ignoring paths
+	result &= fs->existFile("other/test.txt");
+	result &= !fs->existFile("other/missing.txt");
+
+	result &= fs->moveFileArchive(1, -1);
+	readFile = fs->createAndOpenFile("test/test.txt");
+	result &= (readFile && readFile->getFileName().find(folder.c_str()) == 0);
+	if (readFile)
+		readFile->drop();
+
+	result &= fs->removeFileArchive((u32)0);
+	result &= !fs->existFile("other/test.txt");
+	result &= fs->existFile("mypath/mypath/myfile.txt");
+
+	while (fs->getFileArchiveCount())
+		fs->removeFileArchive(fs->getFileArchiveCount()-1);
+
+	if (!result)
+		logTestString("Files not found in the right archive\n");
+	return result;
+}
+
+// archives not ignoring case are not indexed, but still searched in their place
+bool testArchiveCase(IFileSystem* fs)
+{
+	bool result = fs->addFileArchive("media/file_with_path", /*bool ignoreCase=*/true, /*bool ignorePaths=*/false);
+	result &= fs->addFileArchive("media/file_with_path.zip", /*bool ignoreCase=*/false, /*bool ignorePaths=*/false);
+	if (!result)
+	{
+		logTestString("Mounting archives failed\n");
+		while (fs->getFileArchiveCount())
+			fs->removeFileArchive(fs->getFileArchiveCount()-1);
+		return false;
+	}
+	const io::path folder = fs->getFileArchive(0)->getFileList()->getPath();
+
+	IReadFile* readFile = fs->createAndOpenFile("test/test.txt");
+	result &= (readFile && readFile->getFileName().find(folder.c_str()) == 0);
+	if (readFile)
+		readFile->drop();
+
+	result &= fs->moveFileArchive(1, -1);
+	readFile = fs->createAndOpenFile("test/test.txt");
+	result &= (readFile && readFile->getFileName().find(folder.c_str()) == -1);
+	if (readFile)
+		readFile->drop();
+
+	result &= fs->removeFileArchive((u32)1);
+	result &= fs->existFile("test/test.txt");
+	result &= fs->existFile("mypath/mypath/myfile.txt");
+
+	while (fs->getFileArchiveCount())
+		fs->removeFileArchive(fs->getFileArchiveCount()-1);
+
+	if (!result)
+		logTestString("Files not found in the right case sensitive archive\n");
+	return result;
+}
+
+// uncompressed files in archives in memory are read from the archive memory
+bool testArchiveInMemory(IFileSystem* fs)
+{
+	IReadFile* pak = fs->createAndOpenFile("media/sample_pakfile.pak");
+	if (!pak)
+	{
+		logTestString("Opening archive failed\n");
+		return false;
+	}
+
+	c8* memory = new c8[pak->getSize()];
+	pak->read(memory, pak->getSize());
+	IReadFile* memoryFile = fs->createMemoryReadFile(memory, pak->getSize(), "sample_pakfile.pak", true);
+	pak->drop();
+
+	bool result = fs->addFileArchive(memoryFile);
+	memoryFile->drop();
+
+	IReadFile* readFile = result ? fs->createAndOpenFile("test/test.txt") : 0;
+	result &= (readFile && readFile->getType() == io::ERFT_MAPPED_READ_FILE);
+
+	// the file stays valid without the archive
+	while (fs->getFileArchiveCount())
+		fs->removeFileArchive(fs->getFileArchiveCount()-1);
+
+	if (readFile)
+	{
+		char tmp[13] = {'\0'};
+		result &= (readFile->getSize() == 12);
+		result &= readFile->seek(6);
+		result &= (readFile->read(tmp, 12) == 6);
+		result &= !strcmp(tmp, "world!");
+		result &= !readFile->seek(7, true);
+		result &= (static_cast<IMemoryReadFile*>(readFile)->getBuffer() != 0);
+		readFile->drop();
+	}
+
+	if (!result)
+		logTestString("Reading file from archive in memory failed\n");
+	return result;
+}
+
+// large compressed files are decompressed while reading, also after seeking
+bool testStreamedZip(IFileSystem* fs)
+{
+	if (!fs->addFileArchive("media/lzmadata.zip", /*bool ignoreCase=*/true, /*bool ignorePaths=*/false))
+	{
+		logTestString("Mounting archive failed\n");
+		return false;
+	}
+
+	bool result = true;
+	IReadFile* whole = fs->createAndOpenFile("tahoma10_.xml");
+	IReadFile* readFile = fs->createAndOpenFile("tahoma10_.xml");
+	fs->removeFileArchive(fs->getFileArchiveCount()-1);
+	if (!whole || !readFile)
+	{
+		logTestString("Opening compressed file failed\n");
+		if (whole)
+			whole->drop();
+		if (readFile)
+			readFile->drop();
+		return false;
+	}
+
+	const long size = whole->getSize();
+	result &= (size == 252526);
+	result &= (readFile->getType() != io::ERFT_MEMORY_READ_FILE);
+
+	c8* content = new c8[size];
+	result &= (whole->read(content, size) == (size_t)size);
+	result &= (whole->read(content, 1) == 0);
+	whole->drop();
+
+	const u8 start[] = {0xff, 0xfe, 0x3c, 0x00, 0x3f};
+	result &= !memcmp(content, start, sizeof(start));
+
+	// read in pieces, skip forward and go back
+	c8 tmp[1000];
+	long pos = 0;
+	while (pos < 100000)
+	{
+		result &= (readFile->read(tmp, sizeof(tmp)) == sizeof(tmp));
+		result &= !memcmp(tmp, content+pos, sizeof(tmp));
+		pos += sizeof(tmp);
+	}
+	result &= readFile->seek(200000);
+	result &= (readFile->read(tmp, sizeof(tmp)) == sizeof(tmp));
+	result &= !memcmp(tmp, content+200000, sizeof(tmp));
+	result &= readFile->seek(100);
+	result &= (readFile->read(tmp, sizeof(tmp)) == sizeof(tmp));
+	result &= !memcmp(tmp, content+100, sizeof(tmp));
+	result &= readFile->seek(size-10);
+	result &= (readFile->read(tmp, sizeof(tmp)) == 10);
+	result &= !memcmp(tmp, content+size-10, 10);
+	result &= !readFile->seek(1, true);
+
+	delete [] content;
+	readFile->drop();
+
+	if (!result)
+		logTestString("Reading compressed file failed\n");
+	return result;
+}
 }
 
 
@@ -459,6 +650,13 @@ bool archiveReader()
 //	ret &= testMountFile(fs);
 	logTestString("Testing add/remove with filenames.\n");
 	ret &= testAddRemove(fs, "media/file_with_path.zip");
+	logTestString("Testing archive order.\n");
+	ret &= testArchiveOrder(fs);
+	ret &= testArchiveCase(fs);
+	logTestString("Testing archives in memory.\n");
+	ret &= testArchiveInMemory(fs);
+	logTestString("Testing streamed compressed files.\n");
+	ret &= testStreamedZip(fs);
 
 	device->closeDevice();
 	device->run();
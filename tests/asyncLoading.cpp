@@ -0,0 +1,188 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+	// finishes requests like the frame loop does, until the request is done
+	bool waitForRequest(IrrlichtDevice* device, IAsyncLoadRequest* request)
+	{
+		const u32 start = device->getTimer()->getRealTime();
+		while (request->getState() == EALS_LOADING)
+		{
+			device->getVideoDriver()->beginScene(true, true, video::SColor(255, 0, 0, 0));
+			device->getVideoDriver()->endScene();
+
+			if (device->getTimer()->getRealTime() - start > 20000)
+				return false;
+			device->sleep(1);
+		}
+		return true;
+	}
+}
+
+/** Meshes and textures are loaded on the loader thread of the driver and
+finished on the thread which draws. */
+bool asyncLoading(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if(!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	scene::ISceneManager* smgr = device->getSceneManager();
+	IAsyncLoader* loader = driver->getAsyncLoader();
+
+	bool result = true;
+
+	// texture, created when finished in beginScene
+	IAsyncLoadRequest* texture = driver->createTextureLoadRequest("../media/tools.png");
+	result &= waitForRequest(device, texture);
+	result &= (texture->getState() == EALS_DONE);
+	result &= (texture->getTexture() != 0);
+	result &= (texture->getTexture() == driver->getTexture("../media/tools.png"));
+	result &= (loader->getRequestCount() == 0);
+
+	// loaded textures are done at once
+	IAsyncLoadRequest* again = driver->createTextureLoadRequest("../media/tools.png");
+	result &= (again->getState() == EALS_DONE);
+	result &= (again->getTexture() == texture->getTexture());
+	again->drop();
+	texture->drop();
+
+	// mesh with textures, which are created on this thread while the loader waits
+	const u32 textureCount = driver->getTextureCount();
+	IAsyncLoadRequest* mesh = smgr->createMeshLoadRequest("../media/ninja.b3d");
+	result &= waitForRequest(device, mesh);
+	result &= (mesh->getState() == EALS_DONE);
+	result &= (mesh->getMesh() != 0);
+	result &= (mesh->getMesh() == smgr->getMeshCache()->getMeshByName("../media/ninja.b3d"));
+	result &= (mesh->getMesh() == smgr->getMesh("../media/ninja.b3d"));
+	result &= (driver->getTextureCount() > textureCount);
+	if (mesh->getMesh() && mesh->getMesh()->getMeshBufferCount())
+		result &= (mesh->getMesh()->getMeshBuffer(0)->getMaterial().getTexture(0) != 0);
+	mesh->drop();
+
+	// requests are not finished without a frame budget
+	loader->setFrameBudget(0);
+	IAsyncLoadRequest* failed = smgr->createMeshLoadRequest("../media/nothere.b3d");
+	mesh = smgr->createMeshLoadRequest("../media/sydney.md2");
+
+	// synchronous loading waits for the loader
+	result &= (smgr->getMesh("../media/faerie.md2") != 0);
+
+	device->sleep(50);
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	driver->endScene();
+	result &= (mesh->getState() == EALS_LOADING);
+	result &= (failed->getState() == EALS_LOADING);
+
+	loader->finishAllRequests();
+	result &= (loader->getRequestCount() == 0);
+	result &= (failed->getState() == EALS_FAILED);
+	result &= (failed->getMesh() == 0);
+	result &= (mesh->getState() == EALS_DONE);
+	result &= (mesh->getMesh() == smgr->getMesh("../media/sydney.md2"));
+	failed->drop();
+
+	// scenes of COLLADA files are added to the scene on this thread
+	io::IWriteFile* file = device->getFileSystem()->createAndWriteFile("results/asyncScene.dae");
+	if (file)
+	{
+		const c8 scene[] =
+			"<?xml version=\"1.0\"?>\n"
+			"<COLLADA version=\"1.4.1\">\n"
+			"<library_geometries><geometry id=\"tri\"><mesh>\n"
+			"<source id=\"pos\"><float_array id=\"pa\" count=\"9\">0 0 0 1 0 0 0 1 0</float_array>\n"
+			"<technique_common><accessor source=\"#pa\" count=\"3\" stride=\"3\">"
+			"<param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/><param name=\"Z\" type=\"float\"/>"
+			"</accessor></technique_common></source>\n"
+			"<vertices id=\"verts\"><input semantic=\"POSITION\" source=\"#pos\"/></vertices>\n"
+			"<triangles count=\"1\"><input semantic=\"VERTEX\" source=\"#verts\" offset=\"0\"/><p>0 1 2</p></triangles>\n"
+			"</mesh></geometry></library_geometries>\n"
+			"<library_visual_scenes><visual_scene id=\"scene\">"
+			"<node id=\"tri_node\"><instance_geometry url=\"#tri\"/></node>"
+			"</visual_scene></library_visual_scenes>\n"
+			"<scene><instance_visual_scene url=\"#scene\"/></scene>\n"
+			"</COLLADA>\n";
+		file->write(scene, sizeof(scene) - 1);
+		file->drop();
+
+		smgr->getParameters()->setAttribute(scene::COLLADA_CREATE_SCENE_INSTANCES, true);
+		const u32 nodeCount = smgr->getRootSceneNode()->getChildren().size();
+		IAsyncLoadRequest* colladaScene = smgr->createMeshLoadRequest("results/asyncScene.dae");
+		device->sleep(50);
+		result &= (smgr->getRootSceneNode()->getChildren().size() == nodeCount);
+		loader->finishAllRequests();
+		result &= (colladaScene->getState() == EALS_DONE);
+		result &= (smgr->getRootSceneNode()->getChildren().size() > nodeCount);
+		colladaScene->drop();
+	}
+	else
+		logTestString("Could not write results/asyncScene.dae, skipped the COLLADA scene.\n");
+
+	// entries of an archive are read on both threads at once
+	io::IFileSystem* fs = device->getFileSystem();
+	io::IReadFile* pk3 = fs->createAndOpenFile("../media/map-20kdm2.pk3");
+	if (pk3)
+	{
+		// a limit read file is not in memory, so the entries share its position
+		io::IReadFile* archiveFile = fs->createLimitReadFile("map-20kdm2.pk3", pk3, 0, pk3->getSize());
+		pk3->drop();
+		io::IFileArchive* archive = 0;
+		result &= fs->addFileArchive(archiveFile, true, false, io::EFAT_ZIP, "", &archive);
+		archiveFile->drop();
+
+		core::array<c8> expected;
+		io::IReadFile* bsp = fs->createAndOpenFile("maps/20kdm2.bsp");
+		result &= (bsp != 0);
+		if (bsp)
+		{
+			expected.set_used(bsp->getSize());
+			result &= (bsp->read(expected.pointer(), expected.size()) == expected.size());
+			bsp->drop();
+		}
+
+		IAsyncLoadRequest* levelshot = driver->createTextureLoadRequest("levelshots/20kdm2.tga");
+		IAsyncLoadRequest* lamp = driver->createTextureLoadRequest("models/mapobjects/timlamp/timlamp.tga");
+
+		core::array<c8> data(expected.size());
+		data.set_used(expected.size());
+		for (u32 i = 0; i < 4; ++i)
+		{
+			bsp = fs->createAndOpenFile("maps/20kdm2.bsp");
+			result &= (bsp != 0);
+			if (!bsp)
+				break;
+			result &= (bsp->read(data.pointer(), data.size()) == data.size());
+			result &= (memcmp(data.const_pointer(), expected.const_pointer(), data.size()) == 0);
+			bsp->drop();
+		}
+
+		loader->finishAllRequests();
+		result &= (levelshot->getState() == EALS_DONE && levelshot->getTexture() != 0);
+		result &= (lamp->getState() == EALS_DONE && lamp->getTexture() != 0);
+		levelshot->drop();
+		lamp->drop();
+
+		result &= fs->removeFileArchive(archive);
+	}
+	else
+		logTestString("Could not open ../media/map-20kdm2.pk3, skipped the shared archive.\n");
+
+	// pending requests are finished when the device is dropped
+	IAsyncLoadRequest* pending = smgr->createMeshLoadRequest("../media/dwarf.x");
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	result &= (pending->getState() == EALS_DONE);
+	pending->drop();
+	mesh->drop();
+
+	if (!result)
+		logTestString("Asynchronous loading failed.\n");
+
+	return result;
+}
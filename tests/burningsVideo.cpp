@@ -2,11 +2,292 @@
 // No rights reserved: this software is in the public domain.
 
 #include "testUtils.h"
+#include <string.h>
 
 using namespace irr;
 using namespace scene;
 using namespace video;
 
+namespace
+{
+
+//! renders a small scene with the given number of rasterizer threads
+IImage* renderWithRasterizerThreads(u32 threads)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160,120);
+	params.RasterizerThreads = threads;
+
+	IrrlichtDevice *device = createDeviceEx(params);
+	if (!device)
+		return 0;
+
+	IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager* smgr = device->getSceneManager();
+
+	ISceneNode* node = smgr->addCubeSceneNode(10.f, 0, -1, core::vector3df(0.f, 0.f, 20.f), core::vector3df(30.f, 40.f, 0.f));
+	node->setMaterialTexture(0, driver->getTexture("../media/wall.bmp"));
+	node = smgr->addSphereSceneNode(6.f, 16, 0, -1, core::vector3df(4.f, 2.f, 14.f));
+	node->setMaterialTexture(0, driver->getTexture("../media/fireball.bmp"));
+	node->setMaterialType(video::EMT_TRANSPARENT_ADD_COLOR);
+	node = smgr->addCubeSceneNode(4.f, 0, -1, core::vector3df(-5.f, -3.f, 12.f));
+	node->setMaterialFlag(video::EMF_WIREFRAME, true);
+	smgr->addLightSceneNode(0, core::vector3df(0.f, 20.f, 0.f));
+	smgr->addCameraSceneNode();
+
+	IImage* image = 0;
+	device->run();
+	if (driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(0, 80, 80, 80)))
+	{
+		smgr->drawAll();
+		driver->draw2DRectangle(video::SColor(255, 200, 20, 20), core::recti(4, 4, 20, 12));
+		driver->endScene();
+		image = driver->createScreenShot();
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return image;
+}
+
+//! The tile rasterizer has to produce the same pixels as the serial one
+bool tileRasterizer()
+{
+	IImage* serial = renderWithRasterizerThreads(1);
+	IImage* tiled = renderWithRasterizerThreads(4);
+
+	bool result = serial && tiled &&
+		serial->getImageDataSizeInBytes() == tiled->getImageDataSizeInBytes() &&
+		0 == memcmp(serial->getData(), tiled->getData(), serial->getImageDataSizeInBytes());
+
+	if (!result)
+		logTestString("Tile rasterizer output differs from serial output.\n");
+
+	if (serial)
+		serial->drop();
+	if (tiled)
+		tiled->drop();
+
+	return result;
+}
+
+//! draws a stack of walls, either front to back or back to front
+IImage* renderWallStack(bool frontToBack)
+{
+	IrrlichtDevice *device = createDevice(video::EDT_BURNINGSVIDEO,
+										core::dimension2du(160,120), 32);
+	if (!device)
+		return 0;
+
+	IVideoDriver* driver = device->getVideoDriver();
+	IMesh* cube = device->getSceneManager()->getGeometryCreator()->createCubeMesh(core::vector3df(1.f, 1.f, 1.f));
+
+	SMaterial material;
+	material.setTexture(0, driver->getTexture("../media/wall.bmp"));
+	material.Lighting = false;
+
+	core::matrix4 projection;
+	projection.buildProjectionMatrixPerspectiveFovLH(1.2f, 4.f/3.f, 1.f, 1000.f);
+
+	IImage* image = 0;
+	device->run();
+	if (driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(0, 80, 80, 80)))
+	{
+		driver->setTransform(video::ETS_PROJECTION, projection);
+		driver->setTransform(video::ETS_VIEW, core::matrix4());
+		driver->setMaterial(material);
+
+		// walls are shifted, so every one of them is partly visible
+		for (s32 i = 0; i < 8; ++i)
+		{
+			const s32 wall = frontToBack ? i : 7 - i;
+			core::matrix4 world;
+			world.setTranslation(core::vector3df((wall % 3 - 1) * 3.f, (wall % 2) * 2.f, 10.f + wall * 3.f));
+			world.setScale(core::vector3df(12.f, 8.f, 1.f));
+			driver->setTransform(video::ETS_WORLD, world);
+			driver->drawMeshBuffer(cube->getMeshBuffer(0));
+		}
+		driver->endScene();
+		image = driver->createScreenShot();
+	}
+
+	cube->drop();
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return image;
+}
+
+//! Rejecting hidden geometry early must not change any visible pixel
+bool hierarchicalZ()
+{
+	IImage* backToFront = renderWallStack(false);
+	IImage* frontToBack = renderWallStack(true);
+
+	bool result = backToFront && frontToBack &&
+		backToFront->getImageDataSizeInBytes() == frontToBack->getImageDataSizeInBytes() &&
+		0 == memcmp(backToFront->getData(), frontToBack->getData(), backToFront->getImageDataSizeInBytes());
+
+	if (!result)
+		logTestString("Front to back output differs from back to front output.\n");
+
+	if (backToFront)
+		backToFront->drop();
+	if (frontToBack)
+		frontToBack->drop();
+
+	return result;
+}
+
+//! decodes a DXT1 or DXT5 image the way the specification describes it
+IImage* decodeDXT(IVideoDriver* driver, ECOLOR_FORMAT format, const core::dimension2du& size, const u8* data)
+{
+	IImage* image = driver->createImage(ECF_A8R8G8B8, size);
+	for (u32 by = 0; by < size.Height / 4; ++by)
+	{
+		for (u32 bx = 0; bx < size.Width / 4; ++bx)
+		{
+			const u8* alpha = format == ECF_DXT5 ? data : 0;
+			const u8* color = format == ECF_DXT5 ? data + 8 : data;
+			data += format == ECF_DXT5 ? 16 : 8;
+
+			const u32 e[2] = { (u32)(color[0] | color[1] << 8), (u32)(color[2] | color[3] << 8) };
+			u32 rgb[4][3];
+			for (u32 i = 0; i < 2; ++i)
+			{
+				const u32 r = e[i] >> 11, g = (e[i] >> 5) & 63, b = e[i] & 31;
+				rgb[i][0] = r << 3 | r >> 2;
+				rgb[i][1] = g << 2 | g >> 4;
+				rgb[i][2] = b << 3 | b >> 2;
+			}
+			const bool fourColors = e[0] > e[1] || format == ECF_DXT5;
+			for (u32 c = 0; c < 3; ++c)
+			{
+				rgb[2][c] = fourColors ? (2 * rgb[0][c] + rgb[1][c]) / 3 : (rgb[0][c] + rgb[1][c]) / 2;
+				rgb[3][c] = fourColors ? (rgb[0][c] + 2 * rgb[1][c]) / 3 : 0;
+			}
+
+			u32 a[8] = { 255, 255, 255, 255, 255, 255, 255, 255 };
+			if (alpha)
+			{
+				a[0] = alpha[0];
+				a[1] = alpha[1];
+				for (u32 k = 1; k < 7; ++k)
+					a[k + 1] = a[0] > a[1] ? ((7 - k) * a[0] + k * a[1]) / 7 : k < 5 ? ((5 - k) * a[0] + k * a[1]) / 5 : (k == 5 ? 0 : 255);
+			}
+
+			for (u32 i = 0; i < 16; ++i)
+			{
+				const u32 c = (color[4 + i / 4] >> ((i & 3) * 2)) & 3;
+				u32 alphaIndex = 0;
+				if (alpha)
+				{
+					const u32 bit = 16 + i * 3;
+					alphaIndex = ((alpha[bit / 8] | alpha[bit / 8 + 1] << 8) >> (bit & 7)) & 7;
+				}
+				const u32 texelAlpha = (!fourColors && c == 3) ? 0 : a[alphaIndex];
+				image->setPixel(bx * 4 + (i & 3), by * 4 + i / 4, SColor(texelAlpha, rgb[c][0], rgb[c][1], rgb[c][2]));
+			}
+		}
+	}
+	return image;
+}
+
+//! draws a texture as a screen filling quad and as 2d image
+IImage* renderTexture(IrrlichtDevice* device, ITexture* texture)
+{
+	IVideoDriver* driver = device->getVideoDriver();
+
+	SMaterial material;
+	material.setTexture(0, texture);
+	material.Lighting = false;
+	material.TextureLayer[0].BilinearFilter = false;
+
+	const S3DVertex vertices[4] = {
+		S3DVertex(-1.f, -1.f, 0.5f, 0.f, 0.f, -1.f, SColor(255, 255, 255, 255), 0.f, 1.f),
+		S3DVertex(-1.f, 1.f, 0.5f, 0.f, 0.f, -1.f, SColor(255, 255, 255, 255), 0.f, 0.f),
+		S3DVertex(0.f, 1.f, 0.5f, 0.f, 0.f, -1.f, SColor(255, 255, 255, 255), 1.f, 0.f),
+		S3DVertex(0.f, -1.f, 0.5f, 0.f, 0.f, -1.f, SColor(255, 255, 255, 255), 1.f, 1.f) };
+	const u16 indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+	IImage* image = 0;
+	if (driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(0, 80, 80, 80)))
+	{
+		driver->setTransform(video::ETS_PROJECTION, core::matrix4());
+		driver->setTransform(video::ETS_VIEW, core::matrix4());
+		driver->setTransform(video::ETS_WORLD, core::matrix4());
+		driver->setMaterial(material);
+		driver->drawIndexedTriangleList(vertices, 4, indices, 2);
+		driver->draw2DImage(texture, core::position2di(90, 10));
+		driver->endScene();
+		image = driver->createScreenShot();
+	}
+	return image;
+}
+
+//! DXT textures are sampled from their blocks, giving the pixels of the decoded image
+bool compressedTextures()
+{
+	IrrlichtDevice *device = createDevice(video::EDT_BURNINGSVIDEO,
+										core::dimension2du(160,120), 32);
+	if (!device)
+	{
+		logTestString("Unable to create EDT_BURNINGSVIDEO device\n");
+		return false;
+	}
+
+	IVideoDriver* driver = device->getVideoDriver();
+	driver->setTextureCreationFlag(ETCF_CREATE_MIP_MAPS, false);
+
+	bool result = driver->queryFeature(EVDF_TEXTURE_COMPRESSED_DXT);
+
+	const core::dimension2du size(64, 32);
+	const ECOLOR_FORMAT formats[] = { ECF_DXT1, ECF_DXT5 };
+	for (u32 f = 0; result && f < 2; ++f)
+	{
+		core::array<u8> blocks;
+		blocks.set_used(IImage::getDataSizeFromFormat(formats[f], size.Width, size.Height));
+		u32 seed = 12345;
+		for (u32 i = 0; i < blocks.size(); ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			blocks[i] = (u8)(seed >> 16);
+		}
+
+		IImage* compressed = driver->createImageFromData(formats[f], size, blocks.pointer());
+		IImage* decoded = decodeDXT(driver, formats[f], size, blocks.const_pointer());
+
+		IImage* sampled = renderTexture(device, driver->addTexture("compressed", compressed));
+		IImage* expected = renderTexture(device, driver->addTexture("decoded", decoded));
+
+		result = sampled && expected &&
+			0 == memcmp(sampled->getData(), expected->getData(), sampled->getImageDataSizeInBytes());
+
+		if (!result)
+			logTestString("Sampled DXT texture differs from the decoded image, format %d.\n", formats[f]);
+
+		if (sampled)
+			sampled->drop();
+		if (expected)
+			expected->drop();
+		compressed->drop();
+		decoded->drop();
+		driver->removeAllTextures();
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+} // end anonymous namespace
+
 /** Tests the Burning Video driver */
 bool burningsVideo(void)
 {
@@ -36,5 +317,11 @@ bool burningsVideo(void)
 	device->run();
     device->drop();
 
+	result &= tileRasterizer();
+
+	result &= hierarchicalZ();
+
+	result &= compressedTextures();
+
     return result;
 }
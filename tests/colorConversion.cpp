@@ -0,0 +1,238 @@
+#include "testUtils.h"
+
+using namespace irr;
+using namespace video;
+
+namespace
+{
+	// scalar versions of the conversions, as CColorConverter always did them
+	void referenceConvert(const u8* src, ECOLOR_FORMAT srcFormat, u32 count, u8* dst, ECOLOR_FORMAT dstFormat)
+	{
+		for (u32 i = 0; i < count; ++i)
+		{
+			u32 argb = 0;
+			u16 c16 = 0;
+			switch (srcFormat)
+			{
+			case ECF_A1R5G5B5:
+			case ECF_R5G6B5:
+				memcpy(&c16, src + i * 2, 2);
+				break;
+			case ECF_A8R8G8B8:
+				memcpy(&argb, src + i * 4, 4);
+				break;
+			case ECF_R8G8B8:
+				argb = 0xff000000 | (src[i*3] << 16) | (src[i*3+1] << 8) | src[i*3+2];
+				break;
+			default:
+				break;
+			}
+
+			if (srcFormat == ECF_A1R5G5B5)
+			{
+				switch (dstFormat)
+				{
+				case ECF_A8R8G8B8:
+					argb = A1R5G5B5toA8R8G8B8(c16);
+					memcpy(dst + i * 4, &argb, 4);
+					break;
+				case ECF_R5G6B5:
+					c16 = A1R5G5B5toR5G6B5(c16);
+					memcpy(dst + i * 2, &c16, 2);
+					break;
+				default:
+					break;
+				}
+			}
+			else if (srcFormat == ECF_R5G6B5)
+			{
+				switch (dstFormat)
+				{
+				case ECF_A8R8G8B8:
+					argb = R5G6B5toA8R8G8B8(c16);
+					memcpy(dst + i * 4, &argb, 4);
+					break;
+				case ECF_A1R5G5B5:
+					c16 = R5G6B5toA1R5G5B5(c16);
+					memcpy(dst + i * 2, &c16, 2);
+					break;
+				default:
+					break;
+				}
+			}
+			else
+			{
+				switch (dstFormat)
+				{
+				case ECF_A8R8G8B8:
+					memcpy(dst + i * 4, &argb, 4);
+					break;
+				case ECF_A1R5G5B5:
+					c16 = A8R8G8B8toA1R5G5B5(argb);
+					memcpy(dst + i * 2, &c16, 2);
+					break;
+				case ECF_R5G6B5:
+					c16 = A8R8G8B8toR5G6B5(argb);
+					memcpy(dst + i * 2, &c16, 2);
+					break;
+				case ECF_R8G8B8:
+					dst[i*3] = (argb >> 16) & 0xff;
+					dst[i*3+1] = (argb >> 8) & 0xff;
+					dst[i*3+2] = argb & 0xff;
+					break;
+				default:
+					break;
+				}
+			}
+		}
+	}
+
+	// converts the pixels once at a time and once in pieces of all lengths up
+	// to 41, which start at all alignments, and compares them with the reference
+	bool compareConversion(IVideoDriver* driver, const core::array<u8>& src, ECOLOR_FORMAT srcFormat, ECOLOR_FORMAT dstFormat)
+	{
+		const u32 srcBpp = IImage::getBitsPerPixelFromFormat(srcFormat) / 8;
+		const u32 dstBpp = IImage::getBitsPerPixelFromFormat(dstFormat) / 8;
+		const u32 count = src.size() / srcBpp;
+
+		core::array<u8> expected;
+		expected.set_used(count * dstBpp);
+		referenceConvert(src.const_pointer(), srcFormat, count, expected.pointer(), dstFormat);
+
+		core::array<u8> dst;
+		dst.set_used(count * dstBpp + 1);
+		dst[count * dstBpp] = 0x5a;
+		driver->convertColor(src.const_pointer(), srcFormat, count, dst.pointer(), dstFormat);
+		bool result = (memcmp(dst.const_pointer(), expected.const_pointer(), count * dstBpp) == 0);
+
+		u32 length = 1;
+		for (u32 i = 0; i < count; i += length, length = length % 41 + 1)
+		{
+			const u32 n = core::min_(length, count - i);
+			driver->convertColor(src.const_pointer() + i * srcBpp, srcFormat, n, dst.pointer() + i * dstBpp, dstFormat);
+		}
+		result &= (memcmp(dst.const_pointer(), expected.const_pointer(), count * dstBpp) == 0);
+
+		// nothing written behind the last pixel
+		result &= (dst[count * dstBpp] == 0x5a);
+
+		if (!result)
+			logTestString("Conversion from color format %d to %d differs from the scalar version.\n", srcFormat, dstFormat);
+
+		return result;
+	}
+
+	// all 16 bit colors
+	bool convert16Bit(IVideoDriver* driver)
+	{
+		core::array<u8> src;
+		src.set_used(0x10000 * 2);
+		for (u32 i = 0; i < 0x10000; ++i)
+		{
+			const u16 c = (u16)i;
+			memcpy(src.pointer() + i * 2, &c, 2);
+		}
+
+		bool result = true;
+		result &= compareConversion(driver, src, ECF_A1R5G5B5, ECF_A8R8G8B8);
+		result &= compareConversion(driver, src, ECF_A1R5G5B5, ECF_R5G6B5);
+		result &= compareConversion(driver, src, ECF_R5G6B5, ECF_A8R8G8B8);
+		result &= compareConversion(driver, src, ECF_R5G6B5, ECF_A1R5G5B5);
+		return result;
+	}
+
+	// all 24 bit colors, with an alpha changing from pixel to pixel
+	bool convert32Bit(IVideoDriver* driver)
+	{
+		bool result = true;
+		core::array<u8> argb;
+		core::array<u8> rgb;
+		const u32 blockSize = 0x100000;
+		argb.set_used(blockSize * 4);
+		rgb.set_used(blockSize * 3);
+		for (u32 block = 0; result && block < 0x1000000 / blockSize; ++block)
+		{
+			for (u32 i = 0; i < blockSize; ++i)
+			{
+				const u32 c = block * blockSize + i;
+				const u32 color = c | ((c * 7) << 24);
+				memcpy(argb.pointer() + i * 4, &color, 4);
+				rgb[i*3] = (c >> 16) & 0xff;
+				rgb[i*3+1] = (c >> 8) & 0xff;
+				rgb[i*3+2] = c & 0xff;
+			}
+
+			result &= compareConversion(driver, argb, ECF_A8R8G8B8, ECF_A1R5G5B5);
+			result &= compareConversion(driver, argb, ECF_A8R8G8B8, ECF_R5G6B5);
+			result &= compareConversion(driver, argb, ECF_A8R8G8B8, ECF_R8G8B8);
+			result &= compareConversion(driver, rgb, ECF_R8G8B8, ECF_A8R8G8B8);
+		}
+		return result;
+	}
+
+	// scaling large images runs on several threads, and picks the same pixels
+	bool scaleImage(IVideoDriver* driver)
+	{
+		const core::dimension2du srcSize(1000, 700);
+		IImage* src = driver->createImage(ECF_A8R8G8B8, srcSize);
+		for (u32 y = 0; y < srcSize.Height; ++y)
+			for (u32 x = 0; x < srcSize.Width; ++x)
+				src->setPixel(x, y, SColor(255 - (x & 0xff), x & 0xff, y & 0xff, (x * y) & 0xff));
+
+		bool result = true;
+		const ECOLOR_FORMAT formats[] = { ECF_A8R8G8B8, ECF_R8G8B8, ECF_R5G6B5 };
+		for (u32 f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+		{
+			const core::dimension2du dstSize(777, 555);
+			IImage* dst = driver->createImage(formats[f], dstSize);
+			src->copyToScaling(dst);
+
+			const u32 bpp = dst->getBytesPerPixel();
+			const f32 xStep = (f32)srcSize.Width / (f32)dstSize.Width;
+			const f32 yStep = (f32)srcSize.Height / (f32)dstSize.Height;
+			f32 sy = 0.f;
+			for (u32 y = 0; result && y < dstSize.Height; ++y)
+			{
+				f32 sx = 0.f;
+				for (u32 x = 0; result && x < dstSize.Width; ++x)
+				{
+					const u8* s = (const u8*)src->getData() + ((s32)sy) * src->getPitch() + ((s32)sx) * 4;
+					u8 expected[4];
+					referenceConvert(s, ECF_A8R8G8B8, 1, expected, formats[f]);
+					result &= (memcmp((const u8*)dst->getData() + y * dst->getPitch() + x * bpp, expected, bpp) == 0);
+					sx += xStep;
+				}
+				sy += yStep;
+			}
+			dst->drop();
+
+			if (!result)
+				logTestString("Scaling into color format %d picked the wrong pixels.\n", formats[f]);
+		}
+
+		src->drop();
+		return result;
+	}
+}
+
+/** The SIMD versions of the color conversions give the same bits as the
+scalar ones, for all 16 bit and 24 bit colors. */
+bool colorConversion(void)
+{
+	IrrlichtDevice * device = irr::createDevice(EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IVideoDriver* driver = device->getVideoDriver();
+
+	bool result = convert16Bit(driver);
+	result &= convert32Bit(driver);
+	result &= scaleImage(driver);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,115 @@
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+	// draws a frame and returns its statistics
+	const video::SFrameStats& drawFrame(IrrlichtDevice* device)
+	{
+		device->getVideoDriver()->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		device->getSceneManager()->drawAll();
+		device->getVideoDriver()->endScene();
+		return device->getVideoDriver()->getFrameStatsHistory();
+	}
+}
+
+/** The drivers and the scene manager count what they did in each frame, and
+keep the counters of the last frames in a history. */
+bool frameStats(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if(!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager * smgr = device->getSceneManager();
+
+	IMesh* cube = smgr->getGeometryCreator()->createCubeMesh(vector3df(1.f, 1.f, 1.f));
+	const u32 cubeTriangles = cube->getMeshBuffer(0)->getIndexCount() / 3;
+	smgr->addCameraSceneNode(0, vector3df(0.f, 0.f, -50.f), vector3df(0.f, 0.f, 0.f));
+
+	// one visible node, two nodes behind the camera culled by different methods
+	IMeshSceneNode* visible = smgr->addMeshSceneNode(cube);
+	smgr->addMeshSceneNode(cube, 0, -1, vector3df(0.f, 0.f, -1000.f));
+	IMeshSceneNode* sphereCulled = smgr->addMeshSceneNode(cube, 0, -1, vector3df(0.f, 0.f, -1000.f));
+	sphereCulled->setAutomaticCulling(EAC_FRUSTUM_SPHERE);
+	cube->drop();
+
+	bool result = true;
+
+	result &= (driver->getFrameStatsHistoryCount() == 0);
+
+	video::SFrameStats stats = drawFrame(device);
+	result &= (driver->getFrameStatsHistoryCount() == 1);
+	result &= (stats.NodesVisited == 4);	// camera and mesh nodes
+	result &= (stats.NodesCulledByBox == 1);
+	result &= (stats.NodesCulledByFrustumSphere == 1);
+	result &= (stats.NodesCulledByFrustumBox == 0);
+	result &= (stats.NodesCulledByOcclusionQuery == 0);
+	result &= (stats.NodesDrawnSolid == 1);
+	result &= (stats.NodesDrawnTransparent == 0);
+	result &= (stats.DrawCalls == 1);
+	result &= (stats.PrimitivesDrawn == cubeTriangles);
+	result &= (stats.PrimitivesDrawn == driver->getPrimitiveCountDrawn());
+
+	// the counters are reset for each frame
+	visible->setVisible(false);
+	stats = drawFrame(device);
+	result &= (stats.NodesVisited == 3);
+	result &= (stats.NodesDrawnSolid == 0);
+	result &= (stats.DrawCalls == 0);
+	result &= (driver->getFrameStatsHistory(1).DrawCalls == 1);
+
+	// the history only keeps the last frames, newest first
+	driver->setFrameStatsHistorySize(2);
+	result &= (driver->getFrameStatsHistoryCount() == 0);
+	drawFrame(device);
+	visible->setVisible(true);
+	drawFrame(device);
+	drawFrame(device);
+	result &= (driver->getFrameStatsHistoryCount() == 2);
+	result &= (driver->getFrameStatsHistory(0).DrawCalls == 1);
+	result &= (driver->getFrameStatsHistory(1).DrawCalls == 1);
+	result &= (driver->getFrameStatsHistory(2).DrawCalls == 0);
+	visible->setVisible(false);
+	drawFrame(device);
+	result &= (driver->getFrameStatsHistory(0).DrawCalls == 0);
+	result &= (driver->getFrameStatsHistory(1).DrawCalls == 1);
+
+	// exported as header line and one line per frame, oldest first
+	c8 csv[1024];
+	memset(csv, 0, sizeof(csv));
+	io::IWriteFile* file = device->getFileSystem()->createMemoryWriteFile(csv, sizeof(csv)-1, "frameStats.csv");
+	result &= driver->writeFrameStatsHistory(file);
+	file->drop();
+
+	core::array<core::stringc> lines;
+	core::stringc(csv).split(lines, "\n");
+	result &= (lines.size() == 3);
+	if (lines.size() == 3)
+	{
+		result &= (lines[0].find("FrameTime,RenderTime,NodesVisited,") == 0);
+		core::array<core::stringc> values;
+		lines[1].split(values, ",");
+		result &= (values.size() == 19);
+		if (values.size() == 19)
+			result &= (values[10] == "1");	// DrawCalls of the older frame
+		values.clear();
+		lines[2].split(values, ",");
+		if (values.size() == 19)
+			result &= (values[10] == "0");
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	if (!result)
+		logTestString("Frame statistics are not correct:\n%s\n", csv);
+
+	return result;
+}
@@ -0,0 +1,318 @@
+#include "testUtils.h"
+
+using namespace irr;
+using namespace video;
+
+namespace
+{
+	enum EBlitOperation
+	{
+		BLIT_BLEND,
+		BLIT_BLEND_COLOR,
+		BLIT_COMBINE_COLOR,
+		BLIT_COPY
+	};
+
+	const c8* const BlitOperationNames[] = { "blend", "blend color", "combine color", "copy" };
+
+	// scalar versions of the pixel operations, as the blitter always did them
+	u32 lerp32(u32 d, u32 s, u32 a)
+	{
+		u32 c = 0;
+		for (u32 shift = 0; shift != 32; shift += 8)
+			c |= ((((d >> shift) & 0xff) * (256 - a) + ((s >> shift) & 0xff) * a) >> 8) << shift;
+		return c;
+	}
+
+	u32 mul32(u32 c0, u32 c1)
+	{
+		u32 c = 0;
+		for (u32 shift = 0; shift != 32; shift += 8)
+			c |= ((((c0 >> shift) & 0xff) * ((c1 >> shift) & 0xff)) >> 8) << shift;
+		return c;
+	}
+
+	u32 blend32(u32 d, u32 s)
+	{
+		const u32 alpha = s >> 24;
+		if (alpha == 0)
+			return d;
+		return (lerp32(d, s, alpha + (alpha >> 7)) & 0x00ffffff) | (s & 0xff000000);
+	}
+
+	u32 combine32(u32 d, u32 s)
+	{
+		const u32 alpha = s >> 24;
+		if (alpha == 0)
+			return d;
+		const u32 a = alpha + (alpha >> 7);
+		return (lerp32(d, s, a) & 0x00ffffff) | ((alpha + (((d >> 24) * (256 - a)) >> 8)) << 24);
+	}
+
+	u16 mul16(u16 c0, u16 c1)
+	{
+		u16 c = c0 & c1 & 0x8000;
+		for (u32 shift = 0; shift != 15; shift += 5)
+			c |= ((((c0 >> shift) & 0x1f) * ((c1 >> shift) & 0x1f)) >> 5) << shift;
+		return c;
+	}
+
+	u32 referencePixel(EBlitOperation op, ECOLOR_FORMAT srcFormat, ECOLOR_FORMAT dstFormat, u32 d, u32 s, u32 color)
+	{
+		if (dstFormat == ECF_A1R5G5B5)
+		{
+			if (srcFormat == ECF_A8R8G8B8)
+			{
+				// the 16 bit blitter depends on pre-multiplied color
+				const u32 alpha = (s >> 24) + (s >> 31);
+				return A8R8G8B8toA1R5G5B5(lerp32(0, s | 0xff000000, alpha));
+			}
+			switch (op)
+			{
+			case BLIT_BLEND:
+				return (s & 0x8000) ? (d & 0x8000) | (s & 0x7fff) : (d & 0x7fff);
+			case BLIT_BLEND_COLOR:
+				return (s & 0x8000) ? mul16((u16)s, A8R8G8B8toA1R5G5B5(color)) : d;
+			default:
+				return s;
+			}
+		}
+
+		if (srcFormat == ECF_A1R5G5B5)
+			return A1R5G5B5toA8R8G8B8((u16)s);
+		switch (op)
+		{
+		case BLIT_BLEND:
+			return blend32(d, s);
+		case BLIT_BLEND_COLOR:
+			return blend32(d, mul32(s, color));
+		case BLIT_COMBINE_COLOR:
+			return combine32(d, mul32(s, color));
+		default:
+			return s;
+		}
+	}
+
+	// random pixels, with fully opaque and fully transparent rows
+	IImage* createPattern(IVideoDriver* driver, ECOLOR_FORMAT format, const core::dimension2du& size, u32 seed)
+	{
+		IImage* image = driver->createImage(format, size);
+		u8* data = (u8*)image->getData();
+		for (u32 i = 0; i < image->getImageDataSizeInBytes(); ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			data[i] = (u8)(seed >> 16);
+		}
+
+		if (format == ECF_A8R8G8B8)
+		{
+			for (u32 y = 0; y < size.Height; y += 4)
+			{
+				for (u32 x = 0; x < size.Width; ++x)
+				{
+					data[y * image->getPitch() + x * 4 + 3] = 0xff;
+					if (y + 1 < size.Height)
+						data[(y + 1) * image->getPitch() + x * 4 + 3] = 0;
+				}
+			}
+		}
+		return image;
+	}
+
+	u32 getRaw(const IImage* image, u32 x, u32 y)
+	{
+		u32 c = 0;
+		memcpy(&c, (const u8*)image->getData() + y * image->getPitch() + x * image->getBytesPerPixel(), image->getBytesPerPixel());
+		return c;
+	}
+
+	void setRaw(IImage* image, u32 x, u32 y, u32 c)
+	{
+		memcpy((u8*)image->getData() + y * image->getPitch() + x * image->getBytesPerPixel(), &c, image->getBytesPerPixel());
+	}
+
+	void blit(EBlitOperation op, IImage* src, IImage* dst, const core::position2di& pos, const core::recti& rect, u32 color)
+	{
+		switch (op)
+		{
+		case BLIT_BLEND:
+			src->copyToWithAlpha(dst, pos, rect, SColor(0xffffffff));
+			break;
+		case BLIT_BLEND_COLOR:
+			src->copyToWithAlpha(dst, pos, rect, SColor(color));
+			break;
+		case BLIT_COMBINE_COLOR:
+			src->copyToWithAlpha(dst, pos, rect, SColor(color), 0, true);
+			break;
+		default:
+			src->copyTo(dst, pos, rect);
+			break;
+		}
+	}
+
+	void blitReference(EBlitOperation op, IImage* src, IImage* dst, const core::position2di& pos, const core::recti& rect, u32 color)
+	{
+		for (s32 y = 0; y < rect.getHeight(); ++y)
+			for (s32 x = 0; x < rect.getWidth(); ++x)
+			{
+				const u32 d = getRaw(dst, pos.X + x, pos.Y + y);
+				const u32 s = getRaw(src, rect.UpperLeftCorner.X + x, rect.UpperLeftCorner.Y + y);
+				setRaw(dst, pos.X + x, pos.Y + y, referencePixel(op, src->getColorFormat(), dst->getColorFormat(), d, s, color));
+			}
+	}
+
+	// blits rectangles of all widths up to 41 at all alignments and compares the images with the reference
+	bool compareBlit(IVideoDriver* driver, EBlitOperation op, ECOLOR_FORMAT srcFormat, ECOLOR_FORMAT dstFormat)
+	{
+		const core::dimension2du size(64, 64);
+		IImage* src = createPattern(driver, srcFormat, size, 1);
+		IImage* dst = createPattern(driver, dstFormat, size, 2);
+		IImage* expected = createPattern(driver, dstFormat, size, 2);
+
+		// white would be blended without color
+		const u32 colors[] = { 0xfffefdfc, 0x80ff8040, 0x7f10e0a0, 0x01ffffff };
+		bool result = true;
+		for (u32 width = 2; width <= 41; ++width)
+		{
+			const core::position2di pos(width % 7, width);
+			const core::recti rect(core::position2di(width % 5, 41 - width), core::dimension2di(width, 5));
+			const u32 color = colors[width % 4];
+
+			blit(op, src, dst, pos, rect, color);
+			blitReference(op, src, expected, pos, rect, color);
+		}
+		result &= (memcmp(dst->getData(), expected->getData(), dst->getImageDataSizeInBytes()) == 0);
+
+		if (!result)
+			logTestString("Blitting (%s) from color format %d to %d differs from the scalar version.\n",
+				BlitOperationNames[op], srcFormat, dstFormat);
+
+		src->drop();
+		dst->drop();
+		expected->drop();
+		return result;
+	}
+
+	// logs the pixels per second of the blitter and of the scalar reference
+	void benchmarkBlit(IrrlichtDevice* device, EBlitOperation op, ECOLOR_FORMAT srcFormat, ECOLOR_FORMAT dstFormat)
+	{
+#ifndef _DEBUG	// only meaningful in release
+		IVideoDriver* driver = device->getVideoDriver();
+		ITimer* timer = device->getTimer();
+		const core::dimension2du size(512, 512);
+		IImage* src = createPattern(driver, srcFormat, size, 3);
+		IImage* dst = createPattern(driver, dstFormat, size, 4);
+		const core::recti rect(core::position2di(0, 0), size);
+		const u32 iterations = 20;
+
+		u32 then = timer->getRealTime();
+		for (u32 i = 0; i < iterations; ++i)
+			blit(op, src, dst, core::position2di(0, 0), rect, 0x80ff8040);
+		const u32 blitTime = timer->getRealTime() - then;
+
+		then += blitTime;
+		for (u32 i = 0; i < iterations; ++i)
+			blitReference(op, src, dst, core::position2di(0, 0), rect, 0x80ff8040);
+		const u32 referenceTime = timer->getRealTime() - then;
+
+		const f32 pixels = (f32)(size.getArea() * iterations) / 1000.f;
+		logTestString("Blitting (%s) from color format %d to %d: %.1f Mpixel/s, scalar reference %.1f Mpixel/s\n",
+			BlitOperationNames[op], srcFormat, dstFormat,
+			pixels / core::max_(blitTime, 1u), pixels / core::max_(referenceTime, 1u));
+
+		src->drop();
+		dst->drop();
+#endif
+	}
+
+	bool testBlit(IrrlichtDevice* device, EBlitOperation op, ECOLOR_FORMAT srcFormat, ECOLOR_FORMAT dstFormat)
+	{
+		const bool result = compareBlit(device->getVideoDriver(), op, srcFormat, dstFormat);
+		benchmarkBlit(device, op, srcFormat, dstFormat);
+		return result;
+	}
+
+	// stretching with the bilinear filter of the 2d material gives gradients
+	bool bilinearStretch()
+	{
+		IrrlichtDevice* device = irr::createDevice(EDT_BURNINGSVIDEO, core::dimension2d<u32>(160, 120));
+		if (!device)
+			return true; // driver not supported
+
+		IVideoDriver* driver = device->getVideoDriver();
+		IImage* image = driver->createImage(ECF_A8R8G8B8, core::dimension2du(2, 2));
+		image->setPixel(0, 0, SColor(255, 0, 0, 0));
+		image->setPixel(1, 0, SColor(255, 255, 255, 255));
+		image->setPixel(0, 1, SColor(255, 0, 0, 0));
+		image->setPixel(1, 1, SColor(255, 255, 255, 255));
+		ITexture* texture = driver->addTexture("bilinear", image);
+		image->drop();
+
+		bool result = true;
+		for (u32 filter = 0; filter < 2; ++filter)
+		{
+			driver->getMaterial2D().TextureLayer[0].BilinearFilter = (filter != 0);
+			driver->enableMaterial2D(true);
+
+			driver->beginScene(true, true, SColor(255, 0, 0, 255));
+			driver->draw2DImage(texture, core::recti(0, 0, 64, 8), core::recti(0, 0, 2, 2));
+			driver->endScene();
+
+			IImage* screenshot = driver->createScreenShot();
+			if (!screenshot)
+				continue;
+
+			u32 levels = 0;
+			u32 last = 256;
+			for (u32 x = 0; x < 64; ++x)
+			{
+				const u32 red = screenshot->getPixel(x, 4).getRed();
+				if (red != last)
+					++levels;
+				result &= (last == 256 || red >= last);
+				last = red;
+			}
+			screenshot->drop();
+
+			// two colors without filter, a gradient with it
+			result &= filter ? (levels > 8) : (levels == 2);
+		}
+		driver->enableMaterial2D(false);
+
+		device->closeDevice();
+		device->run();
+		device->drop();
+
+		if (!result)
+			logTestString("Bilinear stretching of 2d images is not correct.\n");
+
+		return result;
+	}
+}
+
+/** The SIMD versions of the software blitters give the same bits as the scalar
+ones. The throughput of both is logged. */
+bool imageBlitting(void)
+{
+	IrrlichtDevice * device = irr::createDevice(EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	bool result = true;
+	result &= testBlit(device, BLIT_BLEND, ECF_A8R8G8B8, ECF_A8R8G8B8);
+	result &= testBlit(device, BLIT_BLEND_COLOR, ECF_A8R8G8B8, ECF_A8R8G8B8);
+	result &= testBlit(device, BLIT_COMBINE_COLOR, ECF_A8R8G8B8, ECF_A8R8G8B8);
+	result &= testBlit(device, BLIT_BLEND, ECF_A1R5G5B5, ECF_A1R5G5B5);
+	result &= testBlit(device, BLIT_BLEND_COLOR, ECF_A1R5G5B5, ECF_A1R5G5B5);
+	result &= testBlit(device, BLIT_COPY, ECF_A8R8G8B8, ECF_A1R5G5B5);
+	result &= testBlit(device, BLIT_COPY, ECF_A1R5G5B5, ECF_A8R8G8B8);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	result &= bilinearStretch();
+
+	return result;
+}
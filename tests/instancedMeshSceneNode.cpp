@@ -0,0 +1,167 @@
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+	// draws a frame, returns the number of triangles drawn
+	u32 drawFrame(IrrlichtDevice* device)
+	{
+		device->getVideoDriver()->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		device->getSceneManager()->drawAll();
+		device->getVideoDriver()->endScene();
+		return device->getVideoDriver()->getPrimitiveCountDrawn();
+	}
+
+	// all instances are drawn, also on drivers without hardware instancing
+	bool instanceCount()
+	{
+		IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+		assert_log(device);
+		if(!device)
+			return false;
+
+		ISceneManager * smgr = device->getSceneManager();
+
+		IMesh* cube = smgr->getGeometryCreator()->createCubeMesh(vector3df(1.f, 1.f, 1.f));
+		const u32 cubeTriangles = cube->getMeshBuffer(0)->getIndexCount() / 3;
+		smgr->addCameraSceneNode(0, vector3df(0.f, 0.f, -50.f), vector3df(0.f, 0.f, 0.f));
+
+		IInstancedMeshSceneNode* node = smgr->addInstancedMeshSceneNode(cube);
+		cube->drop();
+		node->setMaterialFlag(video::EMF_LIGHTING, false);
+
+		bool result = true;
+
+		// nothing to draw without instances
+		result &= (drawFrame(device) == 0);
+
+		matrix4 m;
+		for (u32 i = 0; i < 10; ++i)
+		{
+			m.setTranslation(vector3df((f32)i * 2.f - 9.f, 0.f, 0.f));
+			result &= (node->addInstance(m, video::SColor(255, i*20, 255, 255)) == i);
+		}
+		result &= (node->getInstanceCount() == 10);
+		result &= (drawFrame(device) == 10 * cubeTriangles);
+
+		// box around all instances, relative to the node
+		result &= node->getBoundingBox().MinEdge.equals(vector3df(-9.5f, -0.5f, -0.5f));
+		result &= node->getBoundingBox().MaxEdge.equals(vector3df(9.5f, 0.5f, 0.5f));
+
+		// the last instance takes the place of a removed one
+		node->removeInstance(2);
+		result &= (node->getInstanceCount() == 9);
+		result &= equals(node->getInstanceTransform(2).getTranslation().X, 9.f);
+		result &= (node->getInstanceColor(2) == video::SColor(255, 180, 255, 255));
+		result &= (drawFrame(device) == 9 * cubeTriangles);
+
+		// the box shrinks when the outer instances are moved in or removed
+		m.setTranslation(vector3df(0.f, 0.f, 0.f));
+		node->setInstance(0, m, video::SColor(255, 0, 255, 255));
+		node->removeInstance(2);
+		result &= node->getBoundingBox().MinEdge.equals(vector3df(-7.5f, -0.5f, -0.5f));
+		result &= node->getBoundingBox().MaxEdge.equals(vector3df(7.5f, 0.5f, 0.5f));
+		result &= (drawFrame(device) == 8 * cubeTriangles);
+
+		// instances are moved with the node and culled as a whole, here behind the camera
+		node->setPosition(vector3df(0.f, 0.f, -1000.f));
+		result &= (drawFrame(device) == 0);
+
+		node->setPosition(vector3df(0.f, 0.f, 0.f));
+		node->removeAllInstances();
+		result &= (drawFrame(device) == 0);
+
+		device->closeDevice();
+		device->run();
+		device->drop();
+
+		if (!result)
+			logTestString("Instanced mesh scene node did not draw all instances.\n");
+
+		return result;
+	}
+
+	// instances look the same as separate mesh scene nodes
+	bool compareWithMeshNodes(video::E_DRIVER_TYPE driverType)
+	{
+		IrrlichtDevice * device = irr::createDevice(driverType, dimension2d<u32>(160, 120));
+		if(!device)
+			return true; // driver not supported
+
+		video::IVideoDriver* driver = device->getVideoDriver();
+		ISceneManager * smgr = device->getSceneManager();
+
+		stabilizeScreenBackground(driver);
+		logTestString("Testing driver %ls\n", driver->getName());
+
+		IMesh* cube = smgr->getGeometryCreator()->createCubeMesh(vector3df(4.f, 4.f, 4.f));
+		smgr->addCameraSceneNode(0, vector3df(0.f, 10.f, -30.f), vector3df(0.f, 0.f, 0.f));
+
+		IInstancedMeshSceneNode* node = smgr->addInstancedMeshSceneNode(cube);
+		node->setMaterialFlag(video::EMF_LIGHTING, false);
+		array<IMeshSceneNode*> meshNodes;
+		for (u32 i = 0; i < 4; ++i)
+		{
+			const vector3df pos((f32)i * 6.f - 9.f, 0.f, (f32)(i % 2) * 6.f);
+			matrix4 m;
+			m.setTranslation(pos);
+			m.setRotationDegrees(vector3df(0.f, (f32)i * 30.f, 0.f));
+			node->addInstance(m);
+
+			meshNodes.push_back(smgr->addMeshSceneNode(cube, 0, -1, pos, vector3df(0.f, (f32)i * 30.f, 0.f)));
+			meshNodes[i]->setMaterialFlag(video::EMF_LIGHTING, false);
+			meshNodes[i]->setVisible(false);
+		}
+		cube->drop();
+
+		driver->beginScene(true, true, video::SColor(255, 60, 60, 60));
+		smgr->drawAll();
+		driver->endScene();
+		video::IImage* instanced = driver->createScreenShot();
+
+		node->setVisible(false);
+		for (u32 i = 0; i < meshNodes.size(); ++i)
+			meshNodes[i]->setVisible(true);
+
+		driver->beginScene(true, true, video::SColor(255, 60, 60, 60));
+		smgr->drawAll();
+		driver->endScene();
+		video::IImage* separate = driver->createScreenShot();
+
+		bool result = (instanced && separate);
+		if (result)
+		{
+			const dimension2d<u32> dim = instanced->getDimension();
+			for (u32 y = 0; result && y < dim.Height; ++y)
+				for (u32 x = 0; result && x < dim.Width; ++x)
+					result &= (instanced->getPixel(x, y) == separate->getPixel(x, y));
+		}
+
+		if (instanced)
+			instanced->drop();
+		if (separate)
+			separate->drop();
+
+		device->closeDevice();
+		device->run();
+		device->drop();
+
+		if (!result)
+			logTestString("Instanced mesh scene node differs from mesh scene nodes.\n");
+
+		return result;
+	}
+}
+
+/** Many instances of a mesh are drawn with one instanced draw call per mesh
+buffer, with a per instance loop as fallback. */
+bool instancedMeshSceneNode(void)
+{
+	bool result = instanceCount();
+	TestWithAllDrivers(compareWithMeshNodes);
+
+	return result;
+}
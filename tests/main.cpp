@@ -83,8 +83,23 @@ int main(int argumentCount, char * arguments[])
 	TEST(removeCustomAnimator);
 	TEST(sceneCollisionManager);
 	TEST(sceneNodeAnimator);
+	TEST(solidMaterialSort);
+	TEST(staticMeshBatching);
+	TEST(instancedMeshSceneNode);
 	TEST(meshLoaders);
 	TEST(testTimer);
+	TEST(profiler);
+	TEST(frameStats);
+	TEST(asyncLoading);
+	TEST(colorConversion);
+	TEST(imageBlitting);
+	TEST(mipMaps);
+	TEST(textureMemoryBudget);
+	TEST(skinnedMeshPoses);
+	TEST(skinnedMeshKeys);
+	TEST(skinnedMeshWeights);
+	TEST(triangleSelectorBVH);
+	TEST(sceneNodeTree);
 	TEST(testCoreutil);
 	// software drivers only
 	TEST(softwareDevice);
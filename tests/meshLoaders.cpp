@@ -5,6 +5,94 @@
 
 using namespace irr;
 
+namespace
+{
+	// appends a line to the text of an .obj file
+	void addLine(core::array<c8>& obj, const c8* line)
+	{
+		while (*line)
+			obj.push_back(*line++);
+		obj.push_back('\n');
+	}
+
+	// creates an .obj file of a grid of quads, large enough to be parsed in several chunks
+	void createGridObj(core::array<c8>& obj, u32 size)
+	{
+		c8 line[128];
+		for (u32 y=0; y<size; ++y)
+		{
+			for (u32 x=0; x<size; ++x)
+			{
+				snprintf(line, 128, "v %u.5 %u.25 0.0", x, y);
+				addLine(obj, line);
+				snprintf(line, 128, "vt %f %f", x/(f32)size, y/(f32)size);
+				addLine(obj, line);
+			}
+			// faces between the last two rows, the second half in another group
+			if (y == size/2)
+				addLine(obj, "g second");
+			for (u32 x=1; y>0 && x<size; ++x)
+			{
+				const u32 i = y*size+x+1;
+				snprintf(line, 128, "f %u/%u %u/%u %d/%d %u/%u", i-size-1, i-size-1, i-size, i-size,
+					-(s32)(size-x), -(s32)(size-x), i-1, i-1);
+				addLine(obj, line);
+			}
+		}
+	}
+
+	// loads the .obj file with the given number of threads
+	scene::IAnimatedMesh* loadObj(IrrlichtDevice* device, core::array<c8>& obj, s32 threads, const io::path& name)
+	{
+		scene::ISceneManager* smgr = device->getSceneManager();
+		smgr->getParameters()->setAttribute(scene::OBJ_LOADER_THREADS, threads);
+		io::IReadFile* file = device->getFileSystem()->createMemoryReadFile(obj.pointer(), obj.size(), name);
+		scene::IAnimatedMesh* mesh = smgr->getMesh(file);
+		file->drop();
+		return mesh;
+	}
+
+	// Vertices are shared by face corners with the same indices, and parsing on
+	// several threads gives the same mesh.
+	bool objLoader(IrrlichtDevice* device)
+	{
+		const u32 size = 300;
+		core::array<c8> obj;
+		createGridObj(obj, size);
+
+		scene::IAnimatedMesh* single = loadObj(device, obj, 0, "single.obj");
+		scene::IAnimatedMesh* parallel = loadObj(device, obj, 4, "parallel.obj");
+		if (!single || !parallel)
+			return false;
+
+		bool result = (single->getMeshBufferCount() == 2 && parallel->getMeshBufferCount() == 2);
+		u32 indices = 0;
+		for (u32 b=0; result && b<single->getMeshBufferCount(); ++b)
+		{
+			scene::IMeshBuffer* mb1 = single->getMeshBuffer(b);
+			scene::IMeshBuffer* mb2 = parallel->getMeshBuffer(b);
+			result &= (mb1->getVertexCount() == mb2->getVertexCount());
+			result &= (mb1->getIndexCount() == mb2->getIndexCount());
+			for (u32 i=0; result && i<mb1->getIndexCount(); ++i)
+			{
+				result &= (mb1->getIndices()[i] == mb2->getIndices()[i]);
+				result &= (mb1->getPosition(mb1->getIndices()[i]) == mb2->getPosition(mb2->getIndices()[i]));
+				result &= (mb1->getTCoords(mb1->getIndices()[i]) == mb2->getTCoords(mb2->getIndices()[i]));
+			}
+			indices += mb1->getIndexCount();
+		}
+		result &= (indices == (size-1)*(size-1)*6);
+
+		// each grid point is used once in each group, twice on the row between them
+		result &= (single->getMeshBuffer(0)->getVertexCount() + single->getMeshBuffer(1)->getVertexCount() == size*(size+1));
+
+		if (!result)
+			logTestString("Loading the .obj file on several threads gave a different mesh.\n");
+
+		return result;
+	}
+}
+
 // Tests mesh loading features and the mesh cache.
 /** This won't test render results. Currently, not all mesh loaders are tested. */
 bool meshLoaders(void)
@@ -29,6 +117,8 @@ bool meshLoaders(void)
 		}
 	}
 
+	result &= objLoader(device);
+
 	device->closeDevice();
 	device->run();
 	device->drop();
@@ -0,0 +1,250 @@
+#include "testUtils.h"
+
+using namespace irr;
+using namespace video;
+
+namespace
+{
+	// 2x2 box filter, as it was written down, with the last row and
+	// column repeated for odd sizes
+	IImage* referenceBox(IVideoDriver* driver, IImage* src)
+	{
+		const core::dimension2du srcSize = src->getDimension();
+		const core::dimension2du size(core::max_(srcSize.Width / 2, 1u), core::max_(srcSize.Height / 2, 1u));
+		IImage* dst = driver->createImage(ECF_A8R8G8B8, size);
+		for (u32 y = 0; y < size.Height; ++y)
+		{
+			for (u32 x = 0; x < size.Width; ++x)
+			{
+				const u32 x1 = core::min_(2 * x + 1, srcSize.Width - 1);
+				const u32 y1 = core::min_(2 * y + 1, srcSize.Height - 1);
+				const SColor c[4] = { src->getPixel(2 * x, 2 * y), src->getPixel(x1, 2 * y),
+					src->getPixel(2 * x, y1), src->getPixel(x1, y1) };
+				u32 a = 2, r = 2, g = 2, b = 2;
+				for (u32 i = 0; i < 4; ++i)
+				{
+					a += c[i].getAlpha();
+					r += c[i].getRed();
+					g += c[i].getGreen();
+					b += c[i].getBlue();
+				}
+				dst->setPixel(x, y, SColor(a / 4, r / 4, g / 4, b / 4));
+			}
+		}
+		return dst;
+	}
+
+	IImage* createNoise(IVideoDriver* driver, const core::dimension2du& size)
+	{
+		IImage* image = driver->createImage(ECF_A8R8G8B8, size);
+		u32 seed = size.Width * 31 + size.Height;
+		u32* data = (u32*)image->getData();
+		for (u32 i = 0; i < size.getArea(); ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed ^ (seed >> 15);
+		}
+		return image;
+	}
+
+	// the box filter gives the same pixels as the reference for even, odd and
+	// large sizes, which are filtered on several threads
+	bool boxFilter(IVideoDriver* driver)
+	{
+		const core::dimension2du sizes[] = { core::dimension2du(64, 64), core::dimension2du(37, 21),
+			core::dimension2du(1, 9), core::dimension2du(30, 1), core::dimension2du(1024, 515) };
+
+		bool result = true;
+		for (u32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+		{
+			IImage* src = createNoise(driver, sizes[i]);
+			IImage* expected = referenceBox(driver, src);
+			IImage* dst = driver->createImage(ECF_A8R8G8B8, expected->getDimension());
+			src->copyToMipMap(dst);
+
+			if (memcmp(dst->getData(), expected->getData(), dst->getImageDataSizeInBytes()))
+			{
+				logTestString("Box filtered mip map of %ux%u differs from the reference.\n", sizes[i].Width, sizes[i].Height);
+				result = false;
+			}
+
+			// other formats are converted
+			const u32 count = sizes[i].getArea();
+			const u32 levelCount = expected->getDimension().getArea();
+			IImage* src16 = driver->createImage(ECF_R5G6B5, sizes[i]);
+			driver->convertColor(src->getData(), ECF_A8R8G8B8, count, src16->getData(), ECF_R5G6B5);
+			IImage* src32 = driver->createImage(ECF_A8R8G8B8, sizes[i]);
+			driver->convertColor(src16->getData(), ECF_R5G6B5, count, src32->getData(), ECF_A8R8G8B8);
+			IImage* expected16 = referenceBox(driver, src32);
+			IImage* expected16in16 = driver->createImage(ECF_R5G6B5, expected->getDimension());
+			driver->convertColor(expected16->getData(), ECF_A8R8G8B8, levelCount, expected16in16->getData(), ECF_R5G6B5);
+			IImage* dst16 = driver->createImage(ECF_R5G6B5, expected->getDimension());
+			src16->copyToMipMap(dst16);
+
+			if (memcmp(dst16->getData(), expected16in16->getData(), dst16->getImageDataSizeInBytes()))
+			{
+				logTestString("Box filtered 16 bit mip map of %ux%u differs from the reference.\n", sizes[i].Width, sizes[i].Height);
+				result = false;
+			}
+
+			src->drop();
+			expected->drop();
+			dst->drop();
+			src16->drop();
+			src32->drop();
+			expected16->drop();
+			dst16->drop();
+			expected16in16->drop();
+		}
+		return result;
+	}
+
+	// a uniform image stays the same with every filter
+	bool uniformImage(IVideoDriver* driver)
+	{
+		const SColor color(200, 10, 128, 250);
+		IImage* src = driver->createImage(ECF_A8R8G8B8, core::dimension2du(40, 24));
+		src->fill(color);
+
+		bool result = true;
+		for (u32 f = 0; f < 2; ++f)
+		{
+			for (u32 srgb = 0; srgb < 2; ++srgb)
+			{
+				IImage* dst = driver->createImage(ECF_A8R8G8B8, core::dimension2du(20, 12));
+				src->copyToMipMap(dst, (E_MIP_MAP_FILTER)f, srgb != 0);
+				for (u32 y = 0; y < 12; ++y)
+					for (u32 x = 0; x < 20; ++x)
+						result &= (dst->getPixel(x, y) == color);
+				dst->drop();
+			}
+		}
+
+		if (!result)
+			logTestString("Filtering a uniform image changed its color.\n");
+
+		src->drop();
+		return result;
+	}
+
+	// black and white average to a brighter gray in sRGB, the Kaiser filter
+	// removes a pattern of single pixels just as the box filter does
+	bool linearColors(IVideoDriver* driver)
+	{
+		IImage* src = driver->createImage(ECF_A8R8G8B8, core::dimension2du(32, 32));
+		for (u32 y = 0; y < 32; ++y)
+			for (u32 x = 0; x < 32; ++x)
+				src->setPixel(x, y, ((x + y) & 1) ? SColor(255, 255, 255, 255) : SColor(0, 0, 0, 0));
+
+		IImage* dst = driver->createImage(ECF_A8R8G8B8, core::dimension2du(16, 16));
+
+		src->copyToMipMap(dst, EMMF_BOX, false);
+		bool result = (dst->getPixel(5, 7) == SColor(128, 128, 128, 128));
+
+		src->copyToMipMap(dst, EMMF_BOX, true);
+		result &= (dst->getPixel(5, 7) == SColor(128, 188, 188, 188));
+
+		// the border repeats the last pixels, which breaks the pattern
+		src->copyToMipMap(dst, EMMF_KAISER, false);
+		for (u32 y = 2; y < 14; ++y)
+			for (u32 x = 2; x < 14; ++x)
+				result &= core::equals(dst->getPixel(x, y).getRed(), 128u, 1u);
+
+		if (!result)
+			logTestString("Filtering a checker board gave the wrong gray.\n");
+
+		src->drop();
+		dst->drop();
+		return result;
+	}
+
+	// the levels are set as mip map data, down to 1x1
+	bool mipMapChain(IVideoDriver* driver)
+	{
+		IImage* src = createNoise(driver, core::dimension2du(64, 16));
+		src->createMipMaps();
+
+		bool result = (src->getMipMapsData() != 0);
+
+		const u8* data = (const u8*)src->getMipMapsData();
+		IImage* level = src;
+		level->grab();
+		core::dimension2du size(64, 16);
+		while (result && (size.Width > 1 || size.Height > 1))
+		{
+			size.Width = core::max_(size.Width / 2, 1u);
+			size.Height = core::max_(size.Height / 2, 1u);
+
+			IImage* expected = referenceBox(driver, level);
+			result &= (expected->getDimension() == size);
+			result &= (0 == memcmp(data, expected->getData(), expected->getImageDataSizeInBytes()));
+			data += expected->getImageDataSizeInBytes();
+
+			level->drop();
+			level = expected;
+		}
+		level->drop();
+
+		if (!result)
+			logTestString("Mip map chain is not correct.\n");
+
+		src->drop();
+		return result;
+	}
+
+#ifndef _DEBUG
+	// compares the time with the old box filter for scaling
+	void logThroughput(IVideoDriver* driver, ITimer* timer)
+	{
+		IImage* src = createNoise(driver, core::dimension2du(2048, 2048));
+		IImage* dst = driver->createImage(ECF_A8R8G8B8, core::dimension2du(1024, 1024));
+
+		u32 start = timer->getRealTime();
+		for (u32 i = 0; i < 10; ++i)
+			src->copyToScalingBoxFilter(dst);
+		const u32 scaling = timer->getRealTime() - start;
+
+		start = timer->getRealTime();
+		for (u32 i = 0; i < 10; ++i)
+			src->copyToMipMap(dst);
+		const u32 box = timer->getRealTime() - start;
+
+		start = timer->getRealTime();
+		for (u32 i = 0; i < 10; ++i)
+			src->copyToMipMap(dst, EMMF_KAISER, true);
+		const u32 kaiser = timer->getRealTime() - start;
+
+		logTestString("2048x2048 mip map x10: copyToScalingBoxFilter %ums, box %ums, sRGB Kaiser %ums\n", scaling, box, kaiser);
+
+		src->drop();
+		dst->drop();
+	}
+#endif
+}
+
+/** Mip map levels are filtered with a 2x2 box, exactly, or with a Kaiser
+filter, optionally in linear space for sRGB images. */
+bool mipMaps(void)
+{
+	IrrlichtDevice * device = irr::createDevice(EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IVideoDriver* driver = device->getVideoDriver();
+
+	bool result = boxFilter(driver);
+	result &= uniformImage(driver);
+	result &= linearColors(driver);
+	result &= mipMapChain(driver);
+
+#ifndef _DEBUG
+	logThroughput(driver, device->getTimer());
+#endif
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
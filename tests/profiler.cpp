@@ -0,0 +1,74 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+	// counts how often a string is found in another one
+	u32 countOccurrences(const core::stringc& str, const c8* what)
+	{
+		u32 count = 0;
+		s32 pos = str.find(what);
+		while (pos >= 0)
+		{
+			++count;
+			pos = str.find(what, pos+1);
+		}
+		return count;
+	}
+}
+
+/** Start and stop calls are recorded into a ring buffer and written as
+Chrome trace events. */
+bool profiler(void)
+{
+	IProfiler& profiler = getProfiler();
+	profiler.add(1000, L"outer", L"trace test");
+	profiler.add(1001, L"in\"ner", L"trace test");
+
+	bool result = true;
+
+	profiler.startTrace(3);	// rounded up to 4 events
+	result &= profiler.isTracing();
+	{
+		CProfileScope outer(1000);
+		CProfileScope inner(1001);
+	}
+	result &= (profiler.getTraceEventCount() == 4);
+
+	core::stringc trace;
+	profiler.printTrace(trace);
+	result &= (trace.find("{\"traceEvents\":[") == 0);
+	result &= (countOccurrences(trace, "\"name\":\"outer\",\"cat\":\"trace test\"") == 2);
+	result &= (countOccurrences(trace, "\"name\":\"in\\\"ner\"") == 2);
+	result &= (countOccurrences(trace, "\"ph\":\"B\"") == 2);
+	result &= (countOccurrences(trace, "\"ph\":\"E\"") == 2);
+
+	// the oldest events are overwritten, the stop events without their
+	// start event are left out
+	profiler.start(1001);
+	profiler.stop(1001);
+	result &= (profiler.getTraceEventCount() == 4);
+	trace = "";
+	profiler.printTrace(trace);
+	result &= (countOccurrences(trace, "\"ph\":") == 2);
+	result &= (countOccurrences(trace, "\"name\":\"outer\"") == 0);
+
+	// ids which were never added are not recorded
+	profiler.start(1002);
+	profiler.stop(1002);
+	result &= (profiler.getTraceEventCount() == 4);
+
+	profiler.stopTrace();
+	result &= !profiler.isTracing();
+	profiler.start(1000);
+	profiler.stop(1000);
+	trace = "";
+	profiler.printTrace(trace);
+	result &= (countOccurrences(trace, "\"ph\":") == 2);
+
+	if (!result)
+		logTestString("Profiler trace is not correct:\n%s\n", trace.c_str());
+
+	return result;
+}
@@ -7,6 +7,129 @@ using namespace irr;
 using namespace core;
 using namespace scene;
 
+namespace
+{
+	//! node which records the order in which it is rendered
+	class COrderNode : public ISceneNode
+	{
+	public:
+		COrderNode(ISceneNode* parent, ISceneManager* mgr, s32 id, array<s32>& order)
+			: ISceneNode(parent, mgr, id), Order(order)
+		{
+			setAutomaticCulling(EAC_OFF);
+		}
+
+		virtual void OnRegisterSceneNode()
+		{
+			if (IsVisible)
+				SceneManager->registerNodeForRendering(this, ESNRP_SOLID);
+
+			ISceneNode::OnRegisterSceneNode();
+		}
+
+		virtual void render()
+		{
+			Order.push_back(getID());
+		}
+
+		virtual const aabbox3d<f32>& getBoundingBox() const
+		{
+			return Box;
+		}
+
+	private:
+		array<s32>& Order;
+		aabbox3d<f32> Box;
+	};
+
+	//! animates a scene of many small subtrees and records positions and render order
+	void runTraversalScene(u32 threads, array<vector3df>& positions, array<s32>& order)
+	{
+		IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+		if (!device)
+			return;
+
+		// animators take their start time from the timer
+		device->getTimer()->stop();
+		device->getTimer()->setTime(0);
+
+		ISceneManager * smgr = device->getSceneManager();
+		smgr->getParameters()->setAttribute(PARALLEL_SCENE_TRAVERSAL, (s32)threads);
+		smgr->addCameraSceneNode(0, vector3df(0, 0, -50));
+
+		array<ISceneNode*> nodes;
+		for (s32 i = 0; i < 64; ++i)
+		{
+			ISceneNode* node = smgr->addEmptySceneNode(0, i);
+			node->setPosition(vector3df((f32)i, 0, 0));
+
+			ISceneNodeAnimator* anim = smgr->createFlyCircleAnimator(vector3df(0, (f32)i, 0), 5.f + i, 0.001f * i);
+			node->addAnimator(anim);
+			anim->drop();
+			anim = smgr->createRotationAnimator(vector3df(0, 0.1f * i, 0));
+			node->addAnimator(anim);
+			anim->drop();
+
+			ISceneNode* child = new COrderNode(node, smgr, 1000 + i, order);
+			child->setPosition(vector3df(0, 0, (f32)i));
+			child->drop();
+
+			// every few subtrees deletes itself while being animated
+			if (0 == (i % 7))
+			{
+				anim = smgr->createDeleteAnimator(60);
+				node->addAnimator(anim);
+				anim->drop();
+			}
+			else
+			{
+				nodes.push_back(node);
+				nodes.push_back(child);
+			}
+		}
+
+		for (u32 frame = 0; frame < 4; ++frame)
+		{
+			device->getTimer()->setTime(frame * 40);
+			smgr->drawAll();
+		}
+
+		for (u32 i = 0; i < nodes.size(); ++i)
+			positions.push_back(nodes[i]->getAbsolutePosition());
+
+		device->getTimer()->start();
+		device->closeDevice();
+		device->run();
+		device->drop();
+	}
+}
+
+/** Animating and registering the children of the root node on several
+threads has to give the same positions and render order as a serial traversal. */
+static bool parallelTraversal()
+{
+	array<vector3df> serialPositions, parallelPositions;
+	array<s32> serialOrder, parallelOrder;
+
+	runTraversalScene(1, serialPositions, serialOrder);
+	runTraversalScene(4, parallelPositions, parallelOrder);
+
+	bool result = serialOrder.size() > 0 && serialOrder == parallelOrder
+		&& serialPositions.size() == parallelPositions.size();
+
+	for (u32 i = 0; result && i < serialPositions.size(); ++i)
+		result &= serialPositions[i].equals(parallelPositions[i]);
+
+	if (!result)
+	{
+		logTestString("Parallel scene traversal differs from the serial one.\n");
+		assert_log(false);
+	}
+
+	return result;
+}
+
+
 /** Test functionality of the ISceneNodeAnimator implementations. */
 bool sceneNodeAnimator(void)
 {
@@ -111,6 +234,8 @@ bool sceneNodeAnimator(void)
 		assert_log(false);
 	}
 
+	result &= parallelTraversal();
+
 	return result;
 }
 
@@ -0,0 +1,210 @@
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+	// random number in a range, the same on every run
+	f32 getRandom(f32 low, f32 high, u32& seed)
+	{
+		seed = seed * 1103515245 + 12345;
+		return low + (high - low) * (((seed >> 16) & 0x7fff) / 32767.f);
+	}
+
+	vector3df getPoint(f32 range, u32& seed)
+	{
+		const f32 x = getRandom(-range, range, seed);
+		const f32 y = getRandom(-range, range, seed);
+		const f32 z = getRandom(-range, range, seed);
+		return vector3df(x, y, z);
+	}
+
+	void drawFrame(IrrlichtDevice* device)
+	{
+		device->getVideoDriver()->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		device->getSceneManager()->drawAll();
+		device->getVideoDriver()->endScene();
+	}
+
+	void collectNodes(ISceneNode* node, array<ISceneNode*>& nodes)
+	{
+		ISceneNodeList::ConstIterator it = node->getChildren().begin();
+		for (; it != node->getChildren().end(); ++it)
+		{
+			nodes.push_back(*it);
+			collectNodes(*it, nodes);
+		}
+	}
+
+	// results of all queries, to compare them with and without the tree
+	struct SQueryResults
+	{
+		array<ISceneNode*> Picked;
+		array<ISceneNode*> Hit;
+		array<u32> BoxCounts;
+		array<ISceneNode*> BoxNodes;
+		array<bool> Culled;
+	};
+
+	void runQueries(IrrlichtDevice* device, const array<line3df>& rays,
+		const array<aabbox3df>& boxes, SQueryResults& results)
+	{
+		ISceneManager* smgr = device->getSceneManager();
+		ISceneCollisionManager* collMan = smgr->getSceneCollisionManager();
+
+		for (u32 i = 0; i < rays.size(); ++i)
+		{
+			results.Picked.push_back(collMan->getSceneNodeFromRayBB(rays[i], (i % 3) ? 0 : 2, (i % 2) == 0));
+			SCollisionHit hit;
+			results.Hit.push_back(collMan->getSceneNodeAndCollisionPointFromRay(hit, rays[i]));
+		}
+
+		array<ISceneNode*> found;
+		for (u32 i = 0; i < boxes.size(); ++i)
+		{
+			collMan->getSceneNodesFromBox(boxes[i], found);
+			found.sort();
+			results.BoxCounts.push_back(found.size());
+			for (u32 j = 0; j < found.size(); ++j)
+				results.BoxNodes.push_back(found[j]);
+		}
+
+		array<ISceneNode*> nodes;
+		collectNodes(smgr->getRootSceneNode(), nodes);
+		for (u32 i = 0; i < nodes.size(); ++i)
+			results.Culled.push_back(smgr->isCulled(nodes[i]));
+	}
+
+	template <class T>
+	bool isSame(const array<T>& a, const array<T>& b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (u32 i = 0; i < a.size(); ++i)
+		{
+			if (!(a[i] == b[i]))
+				return false;
+		}
+		return true;
+	}
+
+	// runs all queries without and with the tree
+	bool compareQueries(IrrlichtDevice* device, const array<line3df>& rays, const array<aabbox3df>& boxes)
+	{
+		io::IAttributes* parameters = device->getSceneManager()->getParameters();
+
+		SQueryResults visited;
+		parameters->setAttribute(SCENE_NODE_TREE, false);
+		drawFrame(device);
+		runQueries(device, rays, boxes, visited);
+
+		SQueryResults tree;
+		parameters->setAttribute(SCENE_NODE_TREE, true);
+		drawFrame(device);
+		runQueries(device, rays, boxes, tree);
+
+		bool result = isSame(visited.Picked, tree.Picked);
+		result &= isSame(visited.Hit, tree.Hit);
+		result &= isSame(visited.BoxCounts, tree.BoxCounts);
+		result &= isSame(visited.BoxNodes, tree.BoxNodes);
+		result &= isSame(visited.Culled, tree.Culled);
+		return result;
+	}
+}
+
+/** Picking, box queries and culling find the same nodes with and without the
+tree of the node bounds, also after nodes moved, were hidden or removed. */
+bool sceneNodeTree(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager * smgr = device->getSceneManager();
+	ICameraSceneNode* camera = smgr->addCameraSceneNode(0, vector3df(0.f, 0.f, -300.f), vector3df(0.f, 0.f, 0.f));
+	camera->setFarValue(400.f);
+
+	IMesh* cube = smgr->getGeometryCreator()->createCubeMesh(vector3df(2.f, 2.f, 2.f));
+
+	// nested nodes with all kinds of culling, ids and flags
+	array<ISceneNode*> nodes;
+	u32 seed = 1;
+	for (u32 i = 0; i < 400; ++i)
+	{
+		ISceneNode* parent = (i > 10 && (seed & 0x30000) == 0) ? nodes[seed % nodes.size()] : 0;
+		const vector3df position = getPoint(parent ? 25.f : 500.f, seed);
+		const vector3df rotation = getPoint(180.f, seed);
+		const vector3df scale(getRandom(0.5f, 3.f, seed), getRandom(0.5f, 3.f, seed), getRandom(0.5f, 3.f, seed));
+		IMeshSceneNode* node = smgr->addMeshSceneNode(cube, parent, (i % 2) ? 2 : 1, position, rotation, scale);
+
+		static const u32 culling[4] = { EAC_BOX, EAC_FRUSTUM_BOX, EAC_BOX | EAC_FRUSTUM_SPHERE, EAC_FRUSTUM_SPHERE };
+		node->setAutomaticCulling(culling[i % 4]);
+		node->setVisible((i % 11) != 0);
+		node->setIsDebugObject((i % 13) == 0);
+
+		// the selector uses the transformation of the node it is set for
+		if ((i % 3) == 0)
+		{
+			ITriangleSelector* nodeSelector = smgr->createTriangleSelector(cube, node);
+			node->setTriangleSelector(nodeSelector);
+			nodeSelector->drop();
+		}
+		nodes.push_back(node);
+	}
+
+	array<line3df> rays;
+	array<aabbox3df> boxes;
+	for (u32 i = 0; i < 300; ++i)
+	{
+		const vector3df start = getPoint(600.f, seed);
+		rays.push_back(line3df(start, getPoint(600.f, seed)));
+		const vector3df center = getPoint(500.f, seed);
+		boxes.push_back(aabbox3df(center - vector3df(40.f), center + vector3df(40.f)));
+	}
+
+	bool result = compareQueries(device, rays, boxes);
+
+	// move some nodes and change their visibility
+	for (u32 i = 0; i < nodes.size(); i += 7)
+	{
+		nodes[i]->setPosition(nodes[i]->getPosition() + getPoint(20.f, seed));
+		if ((i % 5) == 0)
+			nodes[i]->setVisible(!nodes[i]->isVisible());
+	}
+	result &= compareQueries(device, rays, boxes);
+
+	// remove nodes with their children while the tree still holds them
+	for (u32 i = 0; i < nodes.size(); i += 17)
+	{
+		if (nodes[i]->getParent() == smgr->getRootSceneNode())
+			nodes[i]->remove();
+	}
+	result &= compareQueries(device, rays, boxes);
+
+	// a node is found at its new place after the next drawAll
+	ISceneCollisionManager* collMan = smgr->getSceneCollisionManager();
+	ISceneNode* moved = smgr->addCubeSceneNode(10.f, 0, -1, vector3df(0.f, 1000.f, 0.f));
+	const line3df oldRay(vector3df(-1000.f, 1000.f, 0.f), vector3df(1000.f, 1000.f, 0.f));
+	const line3df newRay(vector3df(-1000.f, 1100.f, 0.f), vector3df(1000.f, 1100.f, 0.f));
+	drawFrame(device);
+	result &= (collMan->getSceneNodeFromRayBB(oldRay) == moved);
+	result &= (collMan->getSceneNodeFromRayBB(newRay) == 0);
+	moved->setPosition(vector3df(0.f, 1100.f, 0.f));
+	drawFrame(device);
+	result &= (collMan->getSceneNodeFromRayBB(oldRay) == 0);
+	result &= (collMan->getSceneNodeFromRayBB(newRay) == moved);
+
+	cube->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	if (!result)
+		logTestString("The tree of the scene node bounds did not find the same nodes as visiting them.\n");
+
+	return result;
+}
@@ -0,0 +1,137 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+	// a joint moved by evenly spaced position keys and unevenly spaced rotation keys
+	scene::ISkinnedMesh* createAnimatedJoint(scene::ISceneManager* smgr, const f32* rotationFrames, u32 rotationCount)
+	{
+		scene::ISkinnedMesh* mesh = smgr->createSkinnedMesh();
+		scene::ISkinnedMesh::SJoint* joint = mesh->addJoint();
+		joint->Name = "joint";
+
+		for (u32 i = 0; i <= 10; ++i)
+		{
+			scene::ISkinnedMesh::SPositionKey* key = mesh->addPositionKey(joint);
+			key->frame = (f32)i;
+			key->position.set((f32)(i * i), 0.f, (f32)i);
+		}
+		for (u32 i = 0; i < rotationCount; ++i)
+		{
+			scene::ISkinnedMesh::SRotationKey* key = mesh->addRotationKey(joint);
+			key->frame = rotationFrames[i];
+			key->rotation.fromAngleAxis(rotationFrames[i] * 0.2f, core::vector3df(0.f, 1.f, 0.f));
+		}
+		mesh->finalize();
+		return mesh;
+	}
+
+	// linear interpolation between the keys around the frame
+	core::vector3df expectedPosition(f32 frame)
+	{
+		const u32 key = (u32)core::ceil32(frame);
+		if (key == 0)
+			return core::vector3df(0.f, 0.f, 0.f);
+		const core::vector3df a((f32)(key * key), 0.f, (f32)key);
+		const core::vector3df b((f32)((key - 1) * (key - 1)), 0.f, (f32)(key - 1));
+		return a + (b - a) * ((f32)key - frame);
+	}
+}
+
+/** Joints are animated with the same keys whether the frames move on a little,
+jump back and forth, or are past the last key, and when the animation is
+used from another mesh, also after that mesh was dropped. */
+bool skinnedMeshKeys(void)
+{
+	IrrlichtDevice *device = createDevice(video::EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+
+	const f32 rotationFrames[] = { 0.f, 1.f, 5.f, 9.f, 10.f };
+	scene::ISkinnedMesh* mesh = createAnimatedJoint(smgr, rotationFrames, 5);
+	scene::ISkinnedMesh* user = createAnimatedJoint(smgr, rotationFrames, 0);
+	bool result = user->useAnimationFrom(mesh);
+
+	scene::ISkinnedMesh* source = createAnimatedJoint(smgr, rotationFrames, 5);
+	scene::ISkinnedMesh* copy = createAnimatedJoint(smgr, rotationFrames, 0);
+	result &= copy->useAnimationFrom(source);
+	source->drop();
+
+	// finalize only keeps the packed keys
+	const scene::ISkinnedMesh::SJoint* meshJoint = mesh->getAllJoints()[0];
+	result &= meshJoint->PositionKeys.empty() && meshJoint->RotationKeys.empty();
+	core::array<scene::ISkinnedMesh::SPositionKey> positionKeys;
+	core::array<scene::ISkinnedMesh::SScaleKey> scaleKeys;
+	core::array<scene::ISkinnedMesh::SRotationKey> rotationKeys;
+	mesh->getJointKeys(meshJoint, positionKeys, scaleKeys, rotationKeys);
+	result &= (positionKeys.size() == 11 && scaleKeys.size() == 0 && rotationKeys.size() == 5);
+	for (u32 i = 0; result && i < positionKeys.size(); ++i)
+		result &= (positionKeys[i].frame == (f32)i && positionKeys[i].position == core::vector3df((f32)(i * i), 0.f, (f32)i));
+	for (u32 i = 0; result && i < rotationKeys.size(); ++i)
+	{
+		core::quaternion rotation;
+		rotation.fromAngleAxis(rotationFrames[i] * 0.2f, core::vector3df(0.f, 1.f, 0.f));
+		result &= (rotationKeys[i].frame == rotationFrames[i] && rotationKeys[i].rotation.equals(rotation, 0.001f));
+	}
+
+	const f32 frames[] = { 0.25f, 0.5f, 7.5f, 2.25f, 9.9f, 0.f, 10.f, 3.5f, 3.75f, 4.f, 6.f, 1.f };
+	for (u32 i = 0; i < sizeof(frames) / sizeof(frames[0]); ++i)
+	{
+		mesh->animateMesh(frames[i], 1.f);
+		user->animateMesh(frames[i], 1.f);
+		const scene::ISkinnedMesh::SJoint* joint = mesh->getAllJoints()[0];
+
+		result &= joint->Animatedposition.equals(expectedPosition(frames[i]), 0.001f);
+
+		u32 key = 0;
+		while (rotationFrames[key] < frames[i])
+			++key;
+		core::quaternion rotation;
+		rotation.fromAngleAxis(rotationFrames[key] * 0.2f, core::vector3df(0.f, 1.f, 0.f));
+		if (key > 0)
+		{
+			core::quaternion before;
+			before.fromAngleAxis(rotationFrames[key - 1] * 0.2f, core::vector3df(0.f, 1.f, 0.f));
+			const f32 t = (frames[i] - rotationFrames[key]) / (rotationFrames[key - 1] - rotationFrames[key]);
+			rotation.slerp(rotation, before, t);
+		}
+		result &= joint->Animatedrotation.equals(rotation, 0.001f);
+
+		const scene::ISkinnedMesh::SJoint* userJoint = user->getAllJoints()[0];
+		result &= (userJoint->Animatedposition == joint->Animatedposition);
+		result &= (userJoint->Animatedrotation == joint->Animatedrotation);
+
+		copy->animateMesh(frames[i], 1.f);
+		const scene::ISkinnedMesh::SJoint* copyJoint = copy->getAllJoints()[0];
+		result &= (copyJoint->Animatedposition == joint->Animatedposition);
+		result &= (copyJoint->Animatedrotation == joint->Animatedrotation);
+	}
+
+	// past the last key, the last animated values are kept
+	const core::vector3df position = mesh->getAllJoints()[0]->Animatedposition;
+	mesh->animateMesh(12.f, 1.f);
+	result &= (mesh->getAllJoints()[0]->Animatedposition == position);
+
+	// finalizing again keeps the packed keys
+	mesh->finalize();
+	result &= (mesh->getFrameCount() == 11);
+	mesh->animateMesh(7.5f, 1.f);
+	result &= mesh->getAllJoints()[0]->Animatedposition.equals(expectedPosition(7.5f), 0.001f);
+
+	copy->drop();
+	user->drop();
+	mesh->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	if (!result)
+		logTestString("Skinned mesh joints were not animated with the expected keys.\n");
+
+	return result;
+}
@@ -0,0 +1,103 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+	// positions of the vertices of a mesh buffer
+	void getPositions(const scene::IMeshBuffer* mb, core::array<core::vector3df>& positions)
+	{
+		positions.set_used(mb->getVertexCount());
+		for (u32 i = 0; i < mb->getVertexCount(); ++i)
+			positions[i] = mb->getPosition(i);
+	}
+
+	// compares the joint nodes of two scene nodes
+	bool sameJoints(scene::IAnimatedMeshSceneNode* node1, scene::IAnimatedMeshSceneNode* node2)
+	{
+		for (u32 i = 0; i < node1->getJointCount(); ++i)
+		{
+			if (!node1->getJointNode(i)->getAbsolutePosition().equals(node2->getJointNode(i)->getAbsolutePosition()))
+				return false;
+		}
+		return true;
+	}
+}
+
+/** Scene nodes sharing a skinned mesh animate and skin into their own poses,
+and leave the vertices of the shared mesh unchanged. */
+bool skinnedMeshPoses(void)
+{
+	IrrlichtDevice *device = createDevice(video::EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	scene::ISceneManager* smgr = device->getSceneManager();
+
+	scene::ISkinnedMesh* mesh = (scene::ISkinnedMesh*)smgr->getMesh("../media/ninja.b3d");
+	assert_log(mesh);
+	if (!mesh)
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	core::array<core::vector3df> bindPose;
+	getPositions(mesh->getMeshBuffer(0), bindPose);
+
+	const f32 frames[] = { 10.f, 62.f, 62.f };
+	scene::IAnimatedMeshSceneNode* nodes[3];
+	for (u32 i = 0; i < 3; ++i)
+	{
+		nodes[i] = smgr->addAnimatedMeshSceneNode(mesh);
+		nodes[i]->setAnimationSpeed(0.f);
+		nodes[i]->setCurrentFrame(frames[i]);
+	}
+	smgr->addCameraSceneNode(0, core::vector3df(0, 5, -20), core::vector3df(0, 5, 0));
+
+	device->run();
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 60, 60, 60));
+	smgr->drawAll();
+	driver->endScene();
+
+	// the shared mesh is not skinned
+	core::array<core::vector3df> positions;
+	getPositions(mesh->getMeshBuffer(0), positions);
+	bool result = (positions == bindPose);
+
+	// each node has the pose of its own frame
+	result &= (nodes[1]->getBoundingBox() == nodes[2]->getBoundingBox());
+	result &= (nodes[0]->getBoundingBox() != nodes[1]->getBoundingBox());
+	result &= sameJoints(nodes[1], nodes[2]);
+	result &= !sameJoints(nodes[0], nodes[1]);
+
+	// a node leaving the shared frame gets a pose of its own
+	nodes[2]->setCurrentFrame(frames[0]);
+	device->run();
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 60, 60, 60));
+	smgr->drawAll();
+	driver->endScene();
+
+	result &= (nodes[0]->getBoundingBox() == nodes[2]->getBoundingBox());
+	result &= (nodes[1]->getBoundingBox() != nodes[2]->getBoundingBox());
+	result &= sameJoints(nodes[0], nodes[2]);
+	result &= !sameJoints(nodes[1], nodes[2]);
+
+	// same result as skinning the mesh itself
+	mesh->animateMesh(frames[1], 1.f);
+	mesh->skinMesh();
+	result &= (mesh->getBoundingBox() == nodes[1]->getBoundingBox());
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	if (!result)
+		logTestString("Skinned mesh scene nodes did not animate independently of the shared mesh.\n");
+
+	return result;
+}
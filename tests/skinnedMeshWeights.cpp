@@ -0,0 +1,139 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+	// a joint turning and moving away from its start
+	scene::ISkinnedMesh::SJoint* addMovingJoint(scene::ISkinnedMesh* mesh, u32 number)
+	{
+		scene::ISkinnedMesh::SJoint* joint = mesh->addJoint();
+		joint->Name = core::stringc("joint") + core::stringc(number);
+		joint->LocalMatrix.setTranslation(core::vector3df((f32)number, 0.f, 0.f));
+
+		for (u32 i = 0; i <= 10; i += 5)
+		{
+			scene::ISkinnedMesh::SPositionKey* position = mesh->addPositionKey(joint);
+			position->frame = (f32)i;
+			position->position.set((f32)number, (f32)(i * (number + 1)) * 0.1f, 0.f);
+
+			scene::ISkinnedMesh::SRotationKey* rotation = mesh->addRotationKey(joint);
+			rotation->frame = (f32)i;
+			rotation->rotation.fromAngleAxis((f32)(i * (number + 1)) * 0.05f, core::vector3df(0.f, 0.f, 1.f));
+		}
+		return joint;
+	}
+
+	// the blended position of a vertex, accumulated weight by weight
+	core::vector3df referencePosition(const scene::ISkinnedMesh* mesh, u32 vertex, const core::vector3df& staticPos, u32 maxWeights)
+	{
+		core::array<f32> strengths;
+		core::array<const scene::ISkinnedMesh::SJoint*> joints;
+		const core::array<scene::ISkinnedMesh::SJoint*>& allJoints = mesh->getAllJoints();
+		for (u32 i = 0; i < allJoints.size(); ++i)
+		{
+			for (u32 j = 0; j < allJoints[i]->Weights.size(); ++j)
+			{
+				if (allJoints[i]->Weights[j].vertex_id != vertex)
+					continue;
+
+				// strongest first
+				u32 k = 0;
+				while (k < strengths.size() && strengths[k] >= allJoints[i]->Weights[j].strength)
+					++k;
+				strengths.insert(allJoints[i]->Weights[j].strength, k);
+				joints.insert(allJoints[i], k);
+			}
+		}
+
+		f32 total = 0.f;
+		for (u32 i = 0; i < strengths.size() && i < maxWeights; ++i)
+			total += strengths[i];
+
+		core::vector3df position;
+		for (u32 i = 0; i < strengths.size() && i < maxWeights; ++i)
+		{
+			core::matrix4 skin;
+			skin.setbyproduct(joints[i]->GlobalAnimatedMatrix, joints[i]->GlobalInversedMatrix);
+			core::vector3df pulled;
+			skin.transformVect(pulled, staticPos);
+			position += pulled * (strengths[i] / total);
+		}
+		return position;
+	}
+}
+
+/** The per vertex joint tables skin like adding up the pull of every weight.
+Vertices pulled by more than 4 joints keep the 4 strongest ones. */
+bool skinnedMeshWeights(void)
+{
+	IrrlichtDevice *device = createDevice(video::EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	scene::ISkinnedMesh* mesh = device->getSceneManager()->createSkinnedMesh();
+	scene::SSkinMeshBuffer* buffer = mesh->addMeshBuffer();
+
+	// pulled by 1, 2, 4 and 5 joints, the last one by none
+	const u32 jointCounts[] = { 1, 2, 4, 5, 0 };
+	const u32 vertexCount = sizeof(jointCounts) / sizeof(jointCounts[0]);
+	for (u32 i = 0; i < vertexCount; ++i)
+	{
+		buffer->Vertices_Standard.push_back(video::S3DVertex((f32)i, 1.f, 0.5f * (f32)i,
+			0.f, 1.f, 0.f, video::SColor(255, 255, 255, 255), 0.f, 0.f));
+		buffer->Indices.push_back((u16)i);
+	}
+
+	scene::ISkinnedMesh::SJoint* joints[5];
+	for (u32 i = 0; i < 5; ++i)
+		joints[i] = addMovingJoint(mesh, i);
+
+	for (u32 i = 0; i < vertexCount; ++i)
+	{
+		for (u32 j = 0; j < jointCounts[i]; ++j)
+		{
+			scene::ISkinnedMesh::SWeight* weight = mesh->addWeight(joints[(i + j) % 5]);
+			weight->buffer_id = 0;
+			weight->vertex_id = i;
+			weight->strength = 0.5f - 0.1f * (f32)j;
+		}
+	}
+	mesh->finalize();
+
+	core::array<core::vector3df> staticPositions;
+	for (u32 i = 0; i < vertexCount; ++i)
+		staticPositions.push_back(buffer->Vertices_Standard[i].Pos);
+
+	bool result = true;
+	const f32 frames[] = { 2.5f, 7.f, 10.f };
+	for (u32 f = 0; f < sizeof(frames) / sizeof(frames[0]); ++f)
+	{
+		mesh->animateMesh(frames[f], 1.f);
+		mesh->skinMesh();
+
+		for (u32 i = 0; i < vertexCount; ++i)
+		{
+			const core::vector3df& skinned = buffer->Vertices_Standard[i].Pos;
+			if (jointCounts[i] == 0)
+				result &= (skinned == staticPositions[i]);
+			else
+				result &= skinned.equals(referencePosition(mesh, i, staticPositions[i], 4), 0.0001f);
+		}
+
+		// the weakest joint of the vertex pulled by 5 joints is left out
+		const core::vector3df all = referencePosition(mesh, 3, staticPositions[3], 5);
+		result &= !buffer->Vertices_Standard[3].Pos.equals(all, 0.0001f);
+	}
+
+	mesh->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	if (!result)
+		logTestString("Skinned vertices differ from the weights of their joints.\n");
+
+	return result;
+}
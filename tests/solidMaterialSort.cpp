@@ -0,0 +1,59 @@
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+/** Solid mesh buffers of all mesh scene nodes are sorted by material before
+drawing, so alternating materials in the scene graph only need one material
+change per distinct material. */
+bool solidMaterialSort(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if(!device)
+		return false;
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ISceneManager * smgr = device->getSceneManager();
+
+	IMesh* cube = smgr->getGeometryCreator()->createCubeMesh(vector3df(1.f, 1.f, 1.f));
+	smgr->addCameraSceneNode(0, vector3df(0, 0, -100), vector3df(0, 0, 0));
+
+	const u32 nodeCount = 100;
+	for (u32 i = 0; i < nodeCount; ++i)
+	{
+		IMeshSceneNode* node = smgr->addMeshSceneNode(cube, 0, -1,
+			vector3df((f32)(i % 10) * 4.f - 20.f, (f32)(i / 10) * 4.f - 20.f, (f32)i));
+		node->setMaterialFlag(video::EMF_WIREFRAME, (i & 1) != 0);
+		node->setAutomaticCulling(EAC_OFF);
+	}
+	cube->drop();
+
+	bool result = true;
+
+	// two distinct materials, every other buffer can keep the current one
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+	result &= (smgr->getMaterialChangesAvoided() == nodeCount - 2);
+
+	// same with the parts of a parallel traversal merged
+	smgr->getParameters()->setAttribute(PARALLEL_SCENE_TRAVERSAL, 4);
+	driver->beginScene(true, true, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+	result &= (smgr->getMaterialChangesAvoided() == nodeCount - 2);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	if (!result)
+	{
+		logTestString("Solid mesh buffers were not sorted by material.\n");
+		assert_log(false);
+	}
+
+	return result;
+}
@@ -0,0 +1,92 @@
+#include "testUtils.h"
+
+using namespace irr;
+using namespace core;
+using namespace scene;
+
+namespace
+{
+	// draws a frame, returns the number of triangles drawn
+	u32 drawFrame(IrrlichtDevice* device)
+	{
+		device->getVideoDriver()->beginScene(true, true, video::SColor(255, 0, 0, 0));
+		device->getSceneManager()->drawAll();
+		device->getVideoDriver()->endScene();
+		return device->getVideoDriver()->getPrimitiveCountDrawn();
+	}
+}
+
+/** Static mesh scene nodes with equal materials are merged into one batch
+per grid cell. Each triangle has to be drawn exactly once while nodes join
+the batch, move, and are removed. */
+bool staticMeshBatching(void)
+{
+	IrrlichtDevice * device = irr::createDevice(video::EDT_NULL, dimension2d<u32>(160, 120));
+	assert_log(device);
+	if(!device)
+		return false;
+
+	ISceneManager * smgr = device->getSceneManager();
+
+	IMesh* cube = smgr->getGeometryCreator()->createCubeMesh(vector3df(1.f, 1.f, 1.f));
+	const u32 cubeTriangles = cube->getMeshBuffer(0)->getIndexCount() / 3;
+	smgr->addCameraSceneNode(0, vector3df(30.f, 30.f, -100.f), vector3df(30.f, 30.f, 0));
+
+	const u32 nodeCount = 100;
+	array<IMeshSceneNode*> nodes;
+	for (u32 i = 0; i < nodeCount; ++i)
+	{
+		nodes.push_back(smgr->addMeshSceneNode(cube, 0, -1,
+			vector3df((f32)(i % 10) * 4.f + 10.f, (f32)(i / 10) * 4.f + 10.f, 10.f)));
+		nodes[i]->setMaterialFlag(video::EMF_LIGHTING, false);
+	}
+	cube->drop();
+
+	smgr->getParameters()->setAttribute(STATIC_MESH_BATCHING, 1000.f);
+
+	bool result = true;
+
+	// nodes join the batch after a few frames without changes
+	for (u32 frame = 0; frame < 5; ++frame)
+		result &= (drawFrame(device) == nodeCount * cubeTriangles);
+
+	// all nodes are in one cell, so all buffers are in a single batch now
+	result &= (smgr->getMaterialChangesAvoided() == 0);
+
+	// a moved node is taken out of the batch and draws itself
+	nodes[0]->setPosition(vector3df(30.f, 30.f, 20.f));
+	result &= (drawFrame(device) == nodeCount * cubeTriangles);
+	result &= (smgr->getMaterialChangesAvoided() == 1);
+
+	// a removed node is not drawn by the batch anymore
+	nodes[1]->remove();
+	for (u32 frame = 0; frame < 5; ++frame)
+		result &= (drawFrame(device) == (nodeCount - 1) * cubeTriangles);
+
+	// the moved node joined the batch again
+	result &= (smgr->getMaterialChangesAvoided() == 0);
+
+	// same with the parts of a parallel traversal merged
+	smgr->getParameters()->setAttribute(PARALLEL_SCENE_TRAVERSAL, 4);
+	nodes[2]->setMaterialFlag(video::EMF_WIREFRAME, true);
+	for (u32 frame = 0; frame < 5; ++frame)
+		result &= (drawFrame(device) == (nodeCount - 1) * cubeTriangles);
+	result &= (smgr->getMaterialChangesAvoided() == 0);
+
+	// disabling batching draws the nodes again
+	smgr->getParameters()->setAttribute(STATIC_MESH_BATCHING, 0.f);
+	result &= (drawFrame(device) == (nodeCount - 1) * cubeTriangles);
+	result &= (smgr->getMaterialChangesAvoided() == nodeCount - 3);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	if (!result)
+	{
+		logTestString("Static mesh batches were not built correctly.\n");
+		assert_log(false);
+	}
+
+	return result;
+}
@@ -0,0 +1,114 @@
+#include "testUtils.h"
+
+using namespace irr;
+using namespace video;
+
+namespace
+{
+	// gets the textures of a frame like a scene would use them
+	const SFrameStats& drawFrame(IVideoDriver* driver, const c8* const* files, u32 count)
+	{
+		driver->beginScene(true, true, SColor(255, 0, 0, 0));
+		for (u32 i = 0; i < count; ++i)
+			driver->getTexture(files[i]);
+		driver->endScene();
+		return driver->getFrameStatsHistory();
+	}
+}
+
+/** Textures loaded from files are evicted least recently used first when they
+do not fit into the budget, and reloaded when they are used again. */
+bool textureMemoryBudget(void)
+{
+	IrrlichtDevice * device = irr::createDevice(EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	IVideoDriver* driver = device->getVideoDriver();
+
+	// like the texture of the built-in font
+	u64 used = driver->getTextureMemoryUsed();
+
+	const c8* files[] = { "../media/fire.bmp", "../media/fireball.bmp", "../media/wall.bmp" };
+	ITexture* textures[3];
+	for (u32 i = 0; i < 3; ++i)
+		textures[i] = driver->getTexture(files[i]);
+
+	// not loaded from a file, never evicted
+	IImage* image = driver->createImage(ECF_A8R8G8B8, core::dimension2du(64, 64));
+	ITexture* added = driver->addTexture("added", image);
+	image->drop();
+
+	bool result = (textures[0] && textures[1] && textures[2] && added);
+	if (!result)
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	for (u32 i = 0; i < 3; ++i)
+		used += textures[i]->getMemorySize();
+	used += added->getMemorySize();
+	result &= (added->getMemorySize() == 64 * 64 * 4);
+	result &= (driver->getTextureMemoryUsed() == used);
+	result &= (driver->getTextureMemoryBudget() == 0);
+
+	// textures used in the frame are kept, even over the budget
+	driver->setTextureMemoryBudget(1);
+	SFrameStats stats = drawFrame(driver, files, 3);
+	result &= (stats.TexturesEvicted == 0);
+
+	// the textures not used in the frame are evicted until the others fit
+	const u32 textureCount = driver->getTextureCount();
+	const u32 sizes[] = { textures[0]->getMemorySize(), textures[1]->getMemorySize(), textures[2]->getMemorySize() };
+	driver->setTextureMemoryBudget(used - sizes[2]);
+	stats = drawFrame(driver, files, 2);
+	result &= (stats.TexturesEvicted == 1);
+	result &= !textures[0]->isEvicted();
+	result &= !textures[1]->isEvicted();
+	result &= textures[2]->isEvicted();
+	result &= (textures[2]->getMemorySize() == 0);
+	result &= !added->isEvicted();
+	result &= (driver->getTextureMemoryUsed() == used - sizes[2]);
+	result &= (driver->getTextureCount() == textureCount);
+
+	// used again, the same texture is loaded again
+	driver->setTextureMemoryBudget(0);
+	stats = drawFrame(driver, files + 2, 1);
+	result &= (stats.TexturesReloaded == 1);
+	result &= (stats.TexturesEvicted == 0);
+	result &= !textures[2]->isEvicted();
+	result &= (textures[2]->getLastUsedFrame() == textures[1]->getLastUsedFrame() + 1);
+	result &= (driver->getTexture(files[2]) == textures[2]);
+	result &= (driver->getTextureMemoryUsed() == used);
+
+	// the least recently used one goes first
+	driver->setTextureMemoryBudget(used - sizes[1]);
+	stats = drawFrame(driver, files, 1);
+	result &= (stats.TexturesEvicted == 1);
+	result &= textures[1]->isEvicted();
+	result &= !textures[2]->isEvicted();
+	result &= (driver->getTextureMemoryUsed() == used - sizes[1]);
+
+	// reloaded while the loader thread loads another texture from a file
+	driver->setTextureMemoryBudget(0);
+	IAsyncLoadRequest* request = driver->createTextureLoadRequest("../media/terrain-texture.jpg");
+	stats = drawFrame(driver, files + 1, 1);
+	result &= (stats.TexturesReloaded == 1);
+	result &= !textures[1]->isEvicted();
+	driver->getAsyncLoader()->finishAllRequests();
+	result &= (request->getState() == EALS_DONE && request->getTexture() != 0);
+	request->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	if (!result)
+		logTestString("Texture memory budget did not evict or reload the expected textures.\n");
+
+	return result;
+}
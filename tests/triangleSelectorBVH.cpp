@@ -0,0 +1,131 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+	// counts the triangles passed to it
+	class CountCallback : public scene::ITriangleCallback
+	{
+	public:
+		CountCallback() : Count(0) {}
+
+		virtual bool onTriangle(const core::triangle3df& triangle, const scene::SCollisionTriangleRange& info)
+		{
+			++Count;
+			return true;
+		}
+
+		s32 Count;
+	};
+
+	// random point in a box, the same on every run
+	core::vector3df getPoint(const core::aabbox3df& box, u32& seed)
+	{
+		f32 f[3];
+		for (u32 i = 0; i < 3; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			f[i] = ((seed >> 16) & 0x7fff) / 32767.f;
+		}
+		const core::vector3df extent = box.getExtent();
+		return box.MinEdge + core::vector3df(extent.X * f[0], extent.Y * f[1], extent.Z * f[2]);
+	}
+}
+
+/** The BVH selector finds the same nearest hits as the octree selector, also
+in batches and through a meta selector, and the same triangles in a box. */
+bool triangleSelectorBVH(void)
+{
+	IrrlichtDevice *device = createDevice(video::EDT_NULL, core::dimension2d<u32>(160, 120));
+	assert_log(device);
+	if (!device)
+		return false;
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+	device->getFileSystem()->addFileArchive("../media/map-20kdm2.pk3");
+	scene::IAnimatedMesh* levelMesh = smgr->getMesh("20kdm2.bsp");
+	assert_log(levelMesh);
+	if (!levelMesh)
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+
+	scene::ISceneNode* node = smgr->addMeshSceneNode(levelMesh->getMesh(0));
+	node->setPosition(core::vector3df(-1350, -130, -1400));
+	node->setRotation(core::vector3df(0, 30, 0));
+	node->setScale(core::vector3df(1.f, 1.5f, 1.f));
+	node->updateAbsolutePosition();
+
+	scene::ITriangleSelector* octree = smgr->createOctreeTriangleSelector(levelMesh->getMesh(0), node);
+	scene::ITriangleSelector* bvh = smgr->createBVHTriangleSelector(levelMesh->getMesh(0), node);
+	scene::IMetaTriangleSelector* meta = smgr->createMetaTriangleSelector();
+	meta->addTriangleSelector(bvh);
+
+	bool result = bvh->hasHierarchy() && meta->hasHierarchy() && !octree->hasHierarchy();
+	result &= (bvh->getTriangleCount() == octree->getTriangleCount());
+
+	scene::ISceneCollisionManager* collMan = smgr->getSceneCollisionManager();
+	const core::aabbox3df box = node->getTransformedBoundingBox();
+	u32 seed = 1;
+
+	const u32 lineCount = 500;
+	core::array<core::line3df> lines;
+	core::array<bool> expectedHits;
+	bool lineHits[lineCount];
+	u32 hitCount = 0;
+	for (u32 i = 0; i < lineCount; ++i)
+	{
+		const core::line3df line(getPoint(box, seed), getPoint(box, seed));
+		lines.push_back(line);
+
+		scene::SCollisionHit octreeHit;
+		scene::SCollisionHit bvhHit;
+		scene::SCollisionHit metaHit;
+		const bool hit = collMan->getCollisionPoint(octreeHit, line, octree);
+		result &= (collMan->getCollisionPoint(bvhHit, line, bvh) == hit);
+		result &= (collMan->getCollisionPoint(metaHit, line, meta) == hit);
+		expectedHits.push_back(hit);
+		if (!hit)
+			continue;
+
+		++hitCount;
+		result &= bvhHit.Intersection.equals(octreeHit.Intersection, 0.01f);
+		result &= (bvhHit.Node == node);
+		result &= (bvhHit.TriangleSelector == bvh);
+		result &= (metaHit.Intersection == bvhHit.Intersection);
+	}
+	// some lines should hit and some not
+	result &= (hitCount > 0 && hitCount < lineCount);
+
+	result &= (bvh->getLineHits(lines.const_pointer(), lineCount, lineHits) == hitCount);
+	for (u32 i = 0; i < lineCount; ++i)
+		result &= (lineHits[i] == expectedHits[i]);
+
+	// the triangles in a box are passed to the callback like they are returned
+	core::aabbox3df query(getPoint(box, seed));
+	query.addInternalPoint(getPoint(box, seed));
+	core::array<core::triangle3df> triangles;
+	triangles.set_used(bvh->getTriangleCount());
+	s32 count = 0;
+	bvh->getTriangles(triangles.pointer(), triangles.size(), count, query);
+	CountCallback callback;
+	result &= bvh->visitTriangles(callback, query);
+	result &= (count > 0 && callback.Count == count);
+
+	meta->drop();
+	bvh->drop();
+	octree->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	if (!result)
+		logTestString("BVH triangle selector did not find the same triangles as the octree selector.\n");
+
+	return result;
+}